@@ -0,0 +1,139 @@
+/*
+AudioNodeStats.cpp - name the graph's nodes and read their counters.
+
+The node objects live in AudioSense.ino and MusicPlayer.ino; the externs
+here must match their declarations (and their QUAD_SENSE_INPUT /
+DUAL_CODEC_AUDIO guards) exactly.
+*/
+
+#include "AudioNodeStats.h"
+
+#include <Audio.h>
+
+#include "ChimePlayer.h"
+#include "EmergencyLoop.h"
+#include "FadeRamp.h"
+#include "GoertzelBank.h"
+#include "MusicEnvelope.h"
+#include "SdStream.h"
+#include "StemMix.h"
+#include "defines.h"
+
+#if QUAD_SENSE_INPUT
+extern AudioInputI2SQuad audioIn;
+#else
+extern AudioInputI2S audioIn;
+#endif
+extern AudioSynthWaveformSine sine1;
+extern AudioEffectFadeRamp toneRamp;
+extern AudioFilterBiquad notchLeft;
+extern AudioFilterBiquad notchRight;
+extern AudioAnalyzeGoertzelBank senseBank;
+#if QUAD_SENSE_INPUT
+extern AudioFilterBiquad notchLeft2;
+extern AudioFilterBiquad notchRight2;
+extern AudioAnalyzeGoertzelBank senseBank2;
+#endif
+extern AudioRecordQueue tapQueue;
+extern AudioMixer4 mixerSensingOutput;
+extern AudioOutputI2S audioOut;
+
+extern AudioPlaySdStream playSdWav1;
+extern AudioPlayStemSet stemSet;
+extern AudioEffectFadeRamp musicFade;
+extern AudioMixer4 mixerMusicOutput;
+extern AudioPlayChime linkChime;
+extern AudioPlayEmergencyLoop emergencyLoop;
+extern AudioAnalyzeEnvelope musicEnv;
+#if DUAL_CODEC_AUDIO
+extern AudioOutputI2S2 audioOut2;
+#endif
+
+struct NodeRef {
+  const char *name;
+  AudioStream *node;
+};
+
+// Short names: they land on a 21-cell display line and in a JSON frame
+// published for week-long events.
+static const NodeRef nodes[] = {
+    {"in", &audioIn},
+    {"sine", &sine1},
+    {"ramp", &toneRamp},
+    {"notchL", &notchLeft},
+    {"notchR", &notchRight},
+    {"bank", &senseBank},
+#if QUAD_SENSE_INPUT
+    {"notchL2", &notchLeft2},
+    {"notchR2", &notchRight2},
+    {"bank2", &senseBank2},
+#endif
+    {"tap", &tapQueue},
+    {"mixS", &mixerSensingOutput},
+    {"out", &audioOut},
+    {"sd", &playSdWav1},
+    {"stems", &stemSet},
+    {"fade", &musicFade},
+    {"mixM", &mixerMusicOutput},
+    {"chime", &linkChime},
+    {"emerg", &emergencyLoop},
+    {"env", &musicEnv},
+#if DUAL_CODEC_AUDIO
+    {"out2", &audioOut2},
+#endif
+};
+
+#define NODE_COUNT ((int)(sizeof(nodes) / sizeof(nodes[0])))
+
+bool audioNodeStatsCollect(char *json, size_t jsonLen) {
+  size_t pos = 0;
+  int len = snprintf(json, jsonLen, "{\"total\":[%.1f,%.1f]",
+                     (double)AudioProcessorUsage(),
+                     (double)AudioProcessorUsageMax());
+  if (len < 0 || (size_t)len >= jsonLen) {
+    return false;
+  }
+  pos = (size_t)len;
+
+  for (int i = 0; i < NODE_COUNT; i++) {
+    len = snprintf(json + pos, jsonLen - pos, ",\"%s\":[%.1f,%.1f]",
+                   nodes[i].name, (double)nodes[i].node->processorUsage(),
+                   (double)nodes[i].node->processorUsageMax());
+    if (len < 0 || pos + (size_t)len >= jsonLen) {
+      return false;
+    }
+    pos += (size_t)len;
+  }
+  if (pos + 1 >= jsonLen) {
+    return false;
+  }
+  json[pos++] = '}';
+  json[pos] = '\0';
+
+  // Fresh maxima for the next window, aggregate included.
+  for (int i = 0; i < NODE_COUNT; i++) {
+    nodes[i].node->processorUsageMaxReset();
+  }
+  AudioProcessorUsageMaxReset();
+  return true;
+}
+
+void audioNodeStatsBrief(char *out, size_t outLen) {
+  int top = 0, second = -1;
+  for (int i = 1; i < NODE_COUNT; i++) {
+    if (nodes[i].node->processorUsageMax() >
+        nodes[top].node->processorUsageMax()) {
+      second = top;
+      top = i;
+    } else if (second < 0 || nodes[i].node->processorUsageMax() >
+                                 nodes[second].node->processorUsageMax()) {
+      second = i;
+    }
+  }
+  if (second < 0) {
+    second = top;
+  }
+  snprintf(out, outLen, "%s %.1f %s %.1f", nodes[top].name,
+           (double)nodes[top].node->processorUsageMax(), nodes[second].name,
+           (double)nodes[second].node->processorUsageMax());
+}
@@ -0,0 +1,30 @@
+/*
+AudioNodeStats: per-node audio graph CPU telemetry.
+
+AudioProcessorUsage() is one aggregate number for the whole audio
+update, so "the ISR got slower" never said whether the detector bank,
+the SD streamer, or a mixer was responsible. The Audio library already
+counts DWT cycles per AudioStream object on every update (cpu_cycles /
+cpu_cycles_max); this module just gives the anonymous node objects
+names, collects their per-update percentages into one telemetry frame
+(missing_link/audio_cpu, once a minute), and surfaces the worst node on
+the AUDIO diagnostics page. Per-node maxima reset each telemetry window
+so a spike is attributable to when it happened, same as the memory
+churn counter.
+*/
+
+#ifndef AUDIO_NODE_STATS_H
+#define AUDIO_NODE_STATS_H
+
+#include <Arduino.h>
+
+// Fill `json` with {"name":[cpu,max],...} percentages for every node in
+// the graph, then reset the per-node maxima for the next window.
+// Returns false on overflow.
+bool audioNodeStatsCollect(char *json, size_t jsonLen);
+
+// One display line naming the two heaviest nodes by window maximum
+// (non-destructive).
+void audioNodeStatsBrief(char *out, size_t outLen);
+
+#endif // AUDIO_NODE_STATS_H
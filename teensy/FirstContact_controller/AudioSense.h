@@ -7,15 +7,37 @@ AudioSense: The contact sensing and audio mixing logic.
 
 #include <Audio.h>
 
+#include "StatueConfig.h"
+
 // Bundle the state with multi-statue support.
 struct ContactState {
   bool isInitialized;
-  uint8_t wasLinkedMask; // Bitmask of previously connected statues
-  uint8_t isLinkedMask;  // Bitmask of currently connected statues
+  StatueMask wasLinkedMask; // Bitmask of previously connected statues
+  StatueMask isLinkedMask;  // Bitmask of currently connected statues
+
+  // Precomputed transition masks - bits that linked this sense period
+  // and bits that dropped - so consumers read edges here instead of
+  // each re-deriving them from the raw mask pair.
+  StatueMask risingMask;
+  StatueMask fallingMask;
+
+  // Contact quality 0-100 per statue (0 when unlinked). Derived from the
+  // smoothed magnitude relative to the open-circuit noise floor, so the Pi
+  // can modulate LED intensity with grip quality.
+  uint8_t quality[MAX_STATUES];
+
+  // Running link duration per statue in ms (0 while unlinked), from the
+  // monotonic clock: the journal, haptics, and stem engine get their
+  // timing inputs without tracking start times themselves.
+  uint32_t linkMs[MAX_STATUES];
 
   // Check if ANY statue is connected
   bool isLinked() const { return isLinkedMask != 0; }
 
+  // Whether ANY statue was connected last period (the aggregate edge
+  // the music lifecycle runs on, distinct from the per-statue masks).
+  bool wasLinked() const { return wasLinkedMask != 0; }
+
   // Check if specific statue is connected (0-based index)
   bool isLinkedTo(int statueIndex) const {
     return (isLinkedMask & (1 << statueIndex)) != 0;
@@ -23,7 +45,7 @@ struct ContactState {
 
   // Helper method returning whether the state changed.
   bool isUnchanged() const {
-    return isInitialized && isLinkedMask == wasLinkedMask;
+    return isInitialized && risingMask == 0 && fallingMask == 0;
   }
 };
 
@@ -34,6 +56,66 @@ ContactState getContactState();
 void printState(const ContactState &state);
 void audioMusicSetup();
 void setToneEnabled(bool enabled);
+float getEffectiveThreshold(int detectorIndex);
+// Noise-floor access for the FreqRealloc interference monitor.
+float audioSenseNoiseFloor(int detectorIndex);
+float audioSenseThresholdCeiling(int detectorIndex);
+void audioSenseResetNoiseFloor(int detectorIndex);
+// Drive the spare LED pins from the music output envelope; call on the
+// sense cadence.
+void updateMusicLeds();
+// Line-in attenuation feedback against input clipping (ClipGuard.h);
+// call on the sense cadence from loop context (does I2C writes).
+void clipGuardLoop();
+// Boot open-circuit calibration finisher; call on the sense cadence from
+// loop context (does EEPROM writes).
+void audioSenseCalibLoop();
+// True while any detector sits in its threshold hysteresis band (a
+// contact forming or breaking); used by the power governor to ramp up.
+bool audioSenseTransitionActive();
+void configureDetectors();
+void retuneAudioSense();
+// Presence gating: drop (or restore) the detector slot for a peer the
+// broker marks powered-off, reclaiming its share of the audio kernel.
+void setDetectorPresence(int statueIndex, bool online);
+// Runtime frequency announcement from a peer's presence birth: retune
+// that peer's detector slot to the announced emit frequency.
+void audioSensePeerAnnounce(int statueIndex, int freq);
+
+// Music-band rejection on the sense inputs (missing_link/tune,
+// "music_hp_hz"): move the high-pass corner, or 0 to flatten the stage.
+void audioSenseSetMusicHighpass(float cutoffHz);
+// Per-detector input channel mask ("channel_mask", bit per sense
+// channel): drop a noisy electrode pair out of one detector's combine.
+void audioSenseSetChannelMask(int statueIndex, uint8_t mask);
+// TX sine level, driven by the closed-loop controller (TxLevel.ino).
+void audioSenseSetTxAmplitude(float amp);
+
+// Live tuning (missing_link/tune): stage the current threshold tables and
+// loop-side targets for the sense tick to swap in atomically between
+// periods. audioSenseTuneApplied() reports the last sequence applied, so
+// the ack publisher can confirm the swap happened.
+uint32_t audioSenseStageTuning();
+uint32_t audioSenseTuneApplied();
+// Loop-side target for the unlink debounce window (applied via staging).
+extern uint16_t tuneTransitionBufferMs;
+
+// Shadow A/B comparison (missing_link/shadow): run a candidate
+// threshold/debounce configuration in parallel and count divergences.
+void audioSenseShadowEnable(bool enabled);
+void audioSenseShadowSetThreshold(int statueIndex, float threshold);
+void audioSenseShadowSetTransitionMs(uint16_t ms);
+bool audioSenseShadowReport(uint32_t *samples, uint32_t *wouldLink,
+                            uint32_t *wouldMiss);
+
+// Frequency sweep support (FreqSweep.ino)
+void setSenseToneFrequency(int freq);
+void tuneSweepProbe(int freq);
+float readSweepProbe();
+
+// TDM slot gating (TdmSchedule.ino)
+void setToneGate(bool on);
+void setDetectorGate(int detectorIndex, bool gated);
 
 // The audio out shared between the audio sensing and music player.
 extern AudioOutputI2S audioOut;
@@ -5,59 +5,314 @@ AudioSense: The contact sensing and audio mixing logic.
 #include <Audio.h>
 
 #include "AudioSense.h"
+#include "ClipGuard.h"
+#include "ConfigStore.h"
+#include "DutyCycle.h"
+#include "FadeRamp.h"
+#include "FlightRecorder.h"
+#include "GoertzelBank.h"
+#include "LatencyMarkers.h"
+#include "LinkDebounce.h"
+#include "Log.h"
+#include "MemMonitor.h"
+#include "MonoClock.h"
+#include "MusicEnvelope.h"
+#include "PeerLink.h"
+#include "GoertzelTables.h"
+#include "SelfTest.h"
+#include "SignalSnapshot.h"
 #include "StatueConfig.h"
+#include "TdmSchedule.h"
 
 // ------ Audio Contact Defines - Start
 #define LED1_PIN 3
 #define LED2_PIN 4
 #define LED3_PIN 5
-// This is the volume tuned for the sense signal sensitivity.
-#define SIGNAL_AUDIO_VOLUME 0.75
+// Shared-codec gain staging. The headphone volume is the one knob the
+// sense tone and the music share, so it used to sit at a 0.75
+// compromise that cost the music 3 dB. It now runs at the SGTL5000's
+// distortion-free maximum and each path owns its level at its mixer:
+// music at mixerMusicOutput (MusicPlayer.ino), sense at the
+// mixerSensingOutput gain below.
+#define SHARED_CODEC_VOLUME 0.8
+// Threshold carry-over: 0.75 -> 0.8 on the SGTL5000 headphone curve is
+// 6 register steps of 0.5 dB (volume() maps to 128 - n*129; -3.5 dB ->
+// -0.5 dB), so the sense path compensates with 10^(-3.0/20) to keep
+// the on-wire tone amplitude - and every deployed threshold in
+// DEFAULT_CONFIG_JSON - exactly what it was.
+#define SENSE_STAGE_GAIN 0.708
+// With DUAL_CODEC_AUDIO the shield carries only the sense tone, so it
+// runs at the distortion-free maximum with no compensation (that build
+// re-tunes thresholds anyway).
+#define SENSE_ONLY_AUDIO_VOLUME 0.8
 
 // Note: tx_freq is now dynamically set from StatueConfig at runtime
 
 // Per-detector thresholds - each detector uses the threshold of its target statue
 float detectorThresholds[MAX_STATUES - 1];
 
-// Current signal strength for each detector (max of left and right channels)
+// Per-detector hysteresis release ratios (Schmitt trigger): a linked
+// detector releases at threshold * ratio, so magnitude jitter around the
+// trip point cannot flap the link (see STATUE_UNLINK_RATIOS).
+float detectorUnlinkRatios[MAX_STATUES - 1];
+
+// Current signal strength for each detector (max across input channels)
 float detectorSignals[MAX_STATUES - 1] = {0.0};
 
+// Per-channel magnitudes behind that max, for telemetry: a dying hand
+// electrode shows up as one channel sagging long before the combined
+// magnitude drops. Channels 2/3 stay zero without QUAD_SENSE_INPUT.
+float detectorChannelMags[MAX_STATUES - 1][4] = {{0.0}};
+
+// Per-detector input channel masks (bit per sense channel, default all).
+// An electrode pair routed near a noisy run - the music cable, a WLED
+// data line - can be dropped out of one detector's max-combine from the
+// tune topic without rewiring. A single byte, so the sense tick reads it
+// without staging.
+static uint8_t detectorChannelMasks[MAX_STATUES - 1] = {
+    0x0F, 0x0F, 0x0F, 0x0F};
+
+// Adaptive noise floor tracking. Each detector keeps an EWMA of the
+// off-signal magnitude (only updated while its statue is unlinked and the
+// reading is below the configured threshold, so real contact signal never
+// trains the floor). The effective detection threshold becomes
+// noise floor x margin, capped by the configured per-statue threshold, so
+// the config value acts as a ceiling rather than a hand-tuned constant.
+#define NOISE_FLOOR_ALPHA 0.02f // EWMA weight per reading
+#define NOISE_FLOOR_MARGIN 4.0f // Threshold = floor x margin
+#define NOISE_FLOOR_MIN 0.001f  // Lower bound on the effective threshold
+float detectorNoiseFloors[MAX_STATUES - 1] = {0.0};
+
+// Boot open-circuit calibration. A cold boot starts the floors at zero,
+// so the effective thresholds sit at their most sensitive until the EWMA
+// has trained on the site's noise - exactly the window where a noisy site
+// ghost-links. The first seconds after boot are almost always
+// open-circuit, so the sense tick records per-detector magnitude
+// statistics over this window, seeds the floors from the measured
+// baseline, and caches the result in EEPROM (ConfigStore): the next boot
+// starts from measured site noise immediately, and re-calibration is a
+// reboot instead of a laptop session with the sweep rig. A detector that
+// saw contact during the window (peak above the configured ceiling, e.g.
+// a statue rebooting mid-event with people linked) keeps its cached seed.
+#define CALIB_WINDOW_MS 3000
+#define CALIB_MIN_SAMPLES 64
+static bool calibActive = false;
+static uint32_t calibStartMs = 0;
+static float calibSum[MAX_STATUES - 1] = {0.0};
+static float calibPeak[MAX_STATUES - 1] = {0.0};
+static uint16_t calibCount[MAX_STATUES - 1] = {0};
+
+// Per-detector SNR: tone power over residual (out-of-bin) power on the
+// stronger channel. Unlike the raw magnitude, this is comparable across
+// cable lengths (~0.5 dB/kHz attenuation scales signal and noise together).
+float detectorSNRs[MAX_STATUES - 1] = {0.0};
+
+// Strongest guard-bin magnitude per detector (see GoertzelBank.h). A
+// genuine remote tone leaves the guards at the noise floor; clipping or
+// nonlinear skin contact that puts ghost energy on the primary bin fills
+// its intermod family too, so a guard above this fraction of the primary
+// vetoes the detection.
+#define GUARD_VETO_RATIO 0.5f
+float detectorGuardMags[MAX_STATUES - 1] = {0.0};
+
+// Per-detector phase (radians) of the stronger channel. Phase wander flags
+// a degrading cable or hand connection well before magnitude drops below
+// threshold; published on demand via missing_link/diag.
+float detectorPhases[MAX_STATUES - 1] = {0.0};
+
+// Contact quality: smoothed magnitude mapped to 0-100 between the
+// effective threshold (0) and ten times the threshold (100). The smoothing
+// keeps momentary grip changes from flickering the LED modulation.
+#define QUALITY_SMOOTH_ALPHA 0.2f
+#define QUALITY_FULL_SCALE 10.0f // Threshold multiple that maps to 100
+static float smoothedMagnitudes[MAX_STATUES - 1] = {0.0};
+volatile uint8_t latestQuality[MAX_STATUES] = {0};
+
+// Magnitude smoothing stage between the raw window reads and everything
+// downstream. The sliding window refreshes every block, so a
+// single-window noise spike used to land straight on the threshold
+// compare, the display, and the published signals. The fast EWMA settles
+// within two or three sense ticks - well inside the debounce window, so
+// link attack is unaffected - and the debounce, display, telemetry, and
+// the haptics quality chain (QUALITY_SMOOTH_ALPHA above, the slow time
+// constant stacked on this one) all see the same stabilized value.
+#define MAG_FAST_ALPHA 0.4f
+static float detectorFastMags[MAX_STATUES - 1] = {0.0};
+
+// Adaptive integration window. At steady state a detector integrates the
+// full (long) window for precision; the moment its magnitude enters the
+// hysteresis band around the threshold it drops to a short window for fast
+// confirmation, and returns to the long window once the magnitude has been
+// clear of the band for ADAPTIVE_STEADY_MS.
+#define ADAPTIVE_SHORT_WINDOW_MS 15
+#define ADAPTIVE_BAND_LOW 0.5f  // Band lower edge = threshold x 0.5
+#define ADAPTIVE_BAND_HIGH 2.0f // Band upper edge = threshold x 2.0
+#define ADAPTIVE_STEADY_MS 500
+static uint8_t shortWindowSegments = 1;
+static uint8_t longWindowSegments = 1;
+static bool detectorInShortWindow[MAX_STATUES - 1] = {false};
+static unsigned long detectorLastInBandMs[MAX_STATUES - 1] = {0};
+
+// Convert a window length in ms to whole 128-sample segments.
+static uint8_t windowMsToSegments(uint16_t ms) {
+  uint32_t samples = (uint32_t)(ms * AUDIO_SAMPLE_RATE_EXACT / 1000.0f);
+  uint32_t segments = (samples + AUDIO_BLOCK_SAMPLES - 1) / AUDIO_BLOCK_SAMPLES;
+  return (segments < 1) ? 1 : (uint8_t)min(segments, (uint32_t)GOERTZEL_MAX_SEGMENTS);
+}
+
+// Compute the effective threshold for a detector from its adaptive noise
+// floor, bounded below by NOISE_FLOOR_MIN and above by the configured value.
+float getEffectiveThreshold(int detectorIndex) {
+  float adaptive = detectorNoiseFloors[detectorIndex] * NOISE_FLOOR_MARGIN;
+  if (adaptive < NOISE_FLOOR_MIN) {
+    adaptive = NOISE_FLOOR_MIN;
+  }
+  if (adaptive > detectorThresholds[detectorIndex]) {
+    adaptive = detectorThresholds[detectorIndex];
+  }
+  return adaptive;
+}
+
+// Accessors for the FreqRealloc interference monitor: the trained noise
+// floor, the configured threshold ceiling it saturates against, and a
+// reset for when a detector moves to a fresh frequency.
+float audioSenseNoiseFloor(int detectorIndex) {
+  return detectorNoiseFloors[detectorIndex];
+}
+
+float audioSenseThresholdCeiling(int detectorIndex) {
+  return detectorThresholds[detectorIndex];
+}
+
+void audioSenseResetNoiseFloor(int detectorIndex) {
+  detectorNoiseFloors[detectorIndex] = 0.0f;
+}
+
 // The controller for the audio shield.
 AudioControlSGTL5000 audioShield;
 
-// The audio input used for sensing.
+// The audio input used for sensing. With QUAD_SENSE_INPUT a second
+// shield (I2S quad wiring) carries the other hand's electrode pair, so
+// one corroded hand connection no longer kills detection; channels 0/1
+// stay on the first shield either way.
+#if QUAD_SENSE_INPUT
+AudioInputI2SQuad audioIn;
+#else
 AudioInputI2S audioIn;
+#endif
 
 // The sine wave signal generator.
 AudioSynthWaveformSine sine1;
 
-// The input signal detectors - create MAX_STATUES-1 detector pairs to support all configurations
-// We'll only use NUM_STATUES-1 pairs at runtime
-AudioAnalyzeToneDetect left_det_0, right_det_0; // First other statue
-AudioAnalyzeToneDetect left_det_1, right_det_1; // Second other statue
-AudioAnalyzeToneDetect left_det_2, right_det_2; // Third other statue
-AudioAnalyzeToneDetect left_det_3, right_det_3; // Fourth other statue
+// The input signal detector bank. One AudioStream node computes all
+// MAX_STATUES-1 detector frequencies for both channels in a single pass over
+// each audio block, replacing the former eight AudioAnalyzeToneDetect
+// objects (left_det_0..3, right_det_0..3) and their eight patch cords.
+// Only NUM_STATUES-1 detectors are enabled at runtime.
+AudioAnalyzeGoertzelBank senseBank;
 
-// Arrays to hold detector pointers for easier access
-// Size to MAX_STATUES-1 to support all configurations, but only NUM_STATUES-1 will be used
-AudioAnalyzeToneDetect *leftDetectors[MAX_STATUES - 1];
-AudioAnalyzeToneDetect *rightDetectors[MAX_STATUES - 1];
+// Self-echo notch filters. Our own TX tone leaks from the line out back
+// into audioIn at full amplitude and raises the floor every detector sees.
+// A biquad notch at MY_TX_FREQ on each input channel removes the leakage
+// before the detector bank. Configured at runtime in audioSenseSetup()
+// because MY_TX_FREQ comes from StatueConfig.
+#define SELF_ECHO_NOTCH_Q 8.0
+AudioFilterBiquad notchLeft;
+AudioFilterBiquad notchRight;
+#if QUAD_SENSE_INPUT
+AudioFilterBiquad notchLeft2;
+AudioFilterBiquad notchRight2;
+#endif
+
+// Music-band rejection: music coupling back through the statue wiring
+// raises the broadband input level exactly when re-link detection matters
+// most (a song is playing), eating clip headroom and skewing the
+// channel-power SNR estimate. All the sense tones live at or above the
+// 5 kHz detector grid, so a high-pass in the notch biquads' second stage
+// (stage 0 is the self-echo notch) strips the music band at zero extra
+// graph cost. Cutoff is runtime-tunable via missing_link/tune
+// ("music_hp_hz", 0 disables - the stage flattens to pass-through).
+#define MUSIC_HP_CUTOFF_HZ_DEFAULT 4200.0f
+#define MUSIC_HP_Q 0.707f
+static float musicHpCutoffHz = MUSIC_HP_CUTOFF_HZ_DEFAULT;
+
+// Raw block tap for the UDP debug stream (AudioTap.ino). The queue holds
+// pointers to the ISR-filled blocks, so the tap costs nothing on the audio
+// interrupt while it is stopped and one pointer push per block while running.
+AudioRecordQueue tapQueue;
 
 // The mixer to use for audio sensing.
 AudioMixer4 mixerSensingOutput;
 
-// Connect the sine wave generator to sensing mixer.
-AudioConnection patchCordToneOut(sine1, 0, mixerSensingOutput, 0);
+// TX envelope shaper: the tone reaches the sensing mixer through a
+// raised-cosine gain ramp, so gating - TDM slots, the operator tone
+// on/off - is click-free on the hands and puts no transient into peer
+// detectors' debounce state. The sine itself keeps running; only the
+// gain moves. Slot-rate gating uses a ~1-block ramp (small against the
+// 50 ms slots); the operator path can afford a gentler one.
+#define TONE_GATE_RAMP_MS 3
+#define TONE_ENABLE_RAMP_MS 10
+AudioEffectFadeRamp toneRamp(kFadeCurveRaisedCosine);
+AudioConnection patchCordToneOut(sine1, 0, toneRamp, 0);
+AudioConnection patchCordToneRamp(toneRamp, 0, mixerSensingOutput, 0);
+
+// Connect both audio input channels through the notches to the detector bank.
+AudioConnection patchCordNotchL(audioIn, 0, notchLeft, 0);
+AudioConnection patchCordNotchR(audioIn, 1, notchRight, 0);
+AudioConnection patchCordSenseL(notchLeft, 0, senseBank, 0);
+AudioConnection patchCordSenseR(notchRight, 0, senseBank, 1);
 
-// Connect the audio input to all the detectors (MAX_STATUES-1 pairs)
-AudioConnection patchCordL0(audioIn, 0, left_det_0, 0);
-AudioConnection patchCordR0(audioIn, 1, right_det_0, 0);
-AudioConnection patchCordL1(audioIn, 0, left_det_1, 0);
-AudioConnection patchCordR1(audioIn, 1, right_det_1, 0);
-AudioConnection patchCordL2(audioIn, 0, left_det_2, 0);
-AudioConnection patchCordR2(audioIn, 1, right_det_2, 0);
-AudioConnection patchCordL3(audioIn, 0, left_det_3, 0);
-AudioConnection patchCordR3(audioIn, 1, right_det_3, 0);
+#if QUAD_SENSE_INPUT
+// Second electrode pair: its own notches and its own detector bank. Two
+// stereo banks reuse the interleaved two-channel Goertzel kernel as-is
+// instead of widening it to four lanes.
+AudioAnalyzeGoertzelBank senseBank2;
+AudioControlSGTL5000 audioShield2;
+AudioConnection patchCordNotchL2(audioIn, 2, notchLeft2, 0);
+AudioConnection patchCordNotchR2(audioIn, 3, notchRight2, 0);
+AudioConnection patchCordSenseL2(notchLeft2, 0, senseBank2, 0);
+AudioConnection patchCordSenseR2(notchRight2, 0, senseBank2, 1);
+#endif
+
+// Map a 0-3 input channel to its bank (each bank holds two channels).
+#if QUAD_SENSE_INPUT
+static inline AudioAnalyzeGoertzelBank &bankForChannel(int channel) {
+  return channel < 2 ? senseBank : senseBank2;
+}
+#else
+static inline AudioAnalyzeGoertzelBank &bankForChannel(int channel) {
+  (void)channel;
+  return senseBank;
+}
+#endif
+
+// Tap the raw (pre-notch) left input for the UDP debug stream.
+AudioConnection patchCordTap(audioIn, 0, tapQueue, 0);
+
+// Clip monitors on the raw input channels (ClipGuard.h): a railed block
+// freezes the debounce (see getStableLinkedMask) and drives the line-in
+// attenuation feedback loop (clipGuardLoop).
+AudioAnalyzeClip clipLeft;
+AudioAnalyzeClip clipRight;
+AudioConnection patchCordClipL(audioIn, 0, clipLeft, 0);
+AudioConnection patchCordClipR(audioIn, 1, clipRight, 0);
+#if QUAD_SENSE_INPUT
+AudioAnalyzeClip clipLeft2;
+AudioAnalyzeClip clipRight2;
+AudioConnection patchCordClipL2(audioIn, 2, clipLeft2, 0);
+AudioConnection patchCordClipR2(audioIn, 3, clipRight2, 0);
+#endif
+
+// True while any input channel is railed (or was within the hold
+// window). Safe in the sense timer context; reads volatile bytes.
+static bool senseInputClipped() {
+#if QUAD_SENSE_INPUT
+  return clipLeft.clipped() || clipRight.clipped() || clipLeft2.clipped() ||
+         clipRight2.clipped();
+#else
+  return clipLeft.clipped() || clipRight.clipped();
+#endif
+}
 
 // This audio output is shared between the audio sensing and the music player.
 AudioOutputI2S audioOut;
@@ -67,77 +322,545 @@ AudioConnection patchCordMOL(mixerSensingOutput, 0, audioOut, 0);
 
 elapsedMillis since_main = 0;
 uint16_t main_period_ms = 150; // Default value, will be updated via config
+
+// Unlink debounce. The static copy is what the sense tick reads;
+// tuneTransitionBufferMs is the loop-side target, picked up at the next
+// staged tuning apply (see the live-tuning handoff below). With the
+// Schmitt hysteresis handling magnitude jitter, the buffer only has to
+// cover genuine momentary breaks, so 30 ms replaces the old 100 ms.
+#define TRANSITION_BUFFER_MS_DEFAULT 30
+uint16_t tuneTransitionBufferMs = TRANSITION_BUFFER_MS_DEFAULT;
+static uint16_t transitionBufferMs = TRANSITION_BUFFER_MS_DEFAULT;
+
+// The detector read/debounce state machine runs on a hardware timer so the
+// sense cadence no longer wobbles with loop() time (OLED I2C transfers,
+// MQTT work). loop() consumes the latest mask through a single volatile
+// byte, which is naturally atomic on the Cortex-M7 - no lock needed.
+#define SENSE_TIMER_PERIOD_US 5000
+IntervalTimer senseTimer;
+volatile StatueMask latestLinkedMask = 0;
 // ------ Audio Contact Defines - End
 
 // Contact Sense Start
 //
+// Program (or flatten) the music-band high-pass in stage 1 of every
+// input biquad. The Teensy biquad has no per-stage bypass, so "off"
+// writes identity coefficients - same five MACs, unity response.
+static void applyMusicHighpass() {
+  if (musicHpCutoffHz > 0.0f) {
+    notchLeft.setHighpass(1, musicHpCutoffHz, MUSIC_HP_Q);
+    notchRight.setHighpass(1, musicHpCutoffHz, MUSIC_HP_Q);
+#if QUAD_SENSE_INPUT
+    notchLeft2.setHighpass(1, musicHpCutoffHz, MUSIC_HP_Q);
+    notchRight2.setHighpass(1, musicHpCutoffHz, MUSIC_HP_Q);
+#endif
+  } else {
+    static const double kIdentity[5] = {1.0, 0.0, 0.0, 0.0, 0.0};
+    notchLeft.setCoefficients(1, kIdentity);
+    notchRight.setCoefficients(1, kIdentity);
+#if QUAD_SENSE_INPUT
+    notchLeft2.setCoefficients(1, kIdentity);
+    notchRight2.setCoefficients(1, kIdentity);
+#endif
+  }
+}
+
+void audioSenseSetMusicHighpass(float cutoffHz) {
+  // Keep the corner below the detector grid with margin; 0 disables.
+  if (cutoffHz > 0.0f) {
+    cutoffHz = constrain(cutoffHz, 1000.0f, 4800.0f);
+  } else {
+    cutoffHz = 0.0f;
+  }
+  musicHpCutoffHz = cutoffHz;
+  AudioNoInterrupts();
+  applyMusicHighpass();
+  AudioInterrupts();
+}
+
+void audioSenseSetChannelMask(int statueIndex, uint8_t mask) {
+  if (statueIndex < 0 || statueIndex >= NUM_STATUES ||
+      statueIndex == MY_STATUE_INDEX) {
+    return;
+  }
+  int detectorIndex =
+      (statueIndex < MY_STATUE_INDEX) ? statueIndex : statueIndex - 1;
+  // Single byte, naturally atomic against the sense tick.
+  detectorChannelMasks[detectorIndex] = mask & 0x0F;
+}
+
+// Audio pool size in 128-sample blocks. No longer guesswork: the graph
+// has one block in flight per connection edge at worst (24 edges in the
+// quad build), plus TAP_BLOCKS_PER_PACKET queued by the audio tap while
+// it runs, plus the SD streamer's double buffer - and the per-phase
+// high-water marks in missing_link/memory (MemMonitor) police the
+// remaining margin so the constant can keep tracking measurement.
+#define AUDIO_POOL_BLOCKS (QUAD_SENSE_INPUT ? 40 : 34)
+
 void audioSenseSetup() {
-  // NOTE: Increased for multiple detectors
-  AudioMemory(30);
+  // NOTE: The single-pass detector bank no longer queues a block per
+  // detector object, but keep headroom for the music player, the mixers,
+  // and the UDP audio tap queue (which buffers whole blocks while running).
+  AudioMemory(AUDIO_POOL_BLOCKS);
+  memAudioPoolSetup(AUDIO_POOL_BLOCKS);
 
   // Add debug output for statue identity
   Serial.printf("Configuring Statue %c (%s)\n", THIS_STATUE_ID, MY_STATUE_NAME);
   Serial.printf("  TX Frequency: %d Hz\n", MY_TX_FREQ);
   Serial.println("  RX Frequencies:");
 
-  // Initialize detector arrays for all MAX_STATUES-1 pairs
-  leftDetectors[0] = &left_det_0;
-  rightDetectors[0] = &right_det_0;
-  if (MAX_STATUES > 2) {
-    leftDetectors[1] = &left_det_1;
-    rightDetectors[1] = &right_det_1;
-  }
-  if (MAX_STATUES > 3) {
-    leftDetectors[2] = &left_det_2;
-    rightDetectors[2] = &right_det_2;
-  }
-  if (MAX_STATUES > 4) {
-    leftDetectors[3] = &left_det_3;
-    rightDetectors[3] = &right_det_3;
-  }
-
   // Configure the tone detectors with the frequency and number
   // of cycles to match.  These numbers were picked for match
   // times of approx 30 ms.  Longer times are more precise.
 
   // Enable the audio shield and set the output volume.
-  // NOTE: This volume is shared between mixers, so is important not just for
-  // the music volume but also the signal sensitivity.
   audioShield.enable();
-  // TODO: Can we just set the gain of the mixer instead of the audio shield?
-  // Then we can play music at full volume.
-  audioShield.volume(SIGNAL_AUDIO_VOLUME);
+#if DUAL_CODEC_AUDIO
+  // Music is on its own DAC (I2S2, see MusicPlayer.ino), so the shield
+  // volume only sets the sense amplitude: run it at maximum.
+  audioShield.volume(SENSE_ONLY_AUDIO_VOLUME);
+#else
+  // Shared codec: volume at the distortion-free maximum for the music,
+  // with the sense path compensated at its mixer so the tone amplitude
+  // the electrodes see is unchanged (see SENSE_STAGE_GAIN).
+  audioShield.volume(SHARED_CODEC_VOLUME);
+  mixerSensingOutput.gain(0, SENSE_STAGE_GAIN);
+#endif
+#if QUAD_SENSE_INPUT
+  // The second shield (CTRL pads cut for the alternate I2C address) only
+  // receives; its volume never touches the sense amplitude.
+  audioShield2.setAddress(HIGH);
+  audioShield2.enable();
+#endif
+
+  configureDetectors();
 
+  pinMode(LED1_PIN, OUTPUT);
+  pinMode(LED2_PIN, OUTPUT);
+  pinMode(LED3_PIN, OUTPUT);
+
+  // Configure sine generator to transmit THIS statue's frequency, and
+  // notch our own tone out of the sense input so the TX leakage does not
+  // raise the noise floor the detectors (and the adaptive thresholds) see.
+  AudioNoInterrupts(); // disable audio library momentarily
+  // Snap TX onto the coefficient grid so it matches what the peers'
+  // detectors (tuned from the same table) are listening for.
+  sine1.frequency(goertzelSnapFreq(MY_TX_FREQ));
+  sine1.amplitude(1.0);
+  notchLeft.setNotch(0, MY_TX_FREQ, SELF_ECHO_NOTCH_Q);
+  notchRight.setNotch(0, MY_TX_FREQ, SELF_ECHO_NOTCH_Q);
+#if QUAD_SENSE_INPUT
+  notchLeft2.setNotch(0, MY_TX_FREQ, SELF_ECHO_NOTCH_Q);
+  notchRight2.setNotch(0, MY_TX_FREQ, SELF_ECHO_NOTCH_Q);
+#endif
+  applyMusicHighpass();
+  AudioInterrupts(); // enable, tone will start
+  Serial.printf("  Self-echo notch at %d Hz (Q=%.0f)\n", MY_TX_FREQ,
+                (double)SELF_ECHO_NOTCH_Q);
+  Serial.printf("  Music-band high-pass at %.0f Hz\n",
+                (double)musicHpCutoffHz);
+
+  // Prove the analog path (codec alive, output-to-input loopback) before
+  // the calibration window opens, so the probe tone never trains the
+  // floors. A failure is loud on serial/MQTT but does not stop boot:
+  // a statue with a flaky shield should still try to run.
+  selfTestRun();
+
+  // Seed the adaptive floors from the last calibration pass, then start
+  // a fresh one; audioSenseCalibLoop() finishes it once the window ends.
+  float calibSeeds[MAX_STATUES - 1];
+  if (calibCacheLoad(calibSeeds, MAX_STATUES - 1)) {
+    for (int i = 0; i < MAX_STATUES - 1; i++) {
+      detectorNoiseFloors[i] = calibSeeds[i];
+    }
+    Serial.println("  Noise floors seeded from cached calibration");
+  }
+  calibStartMs = millis();
+  calibActive = true;
+
+  // Run the detector read/debounce at a fixed cadence, decoupled from
+  // loop() jitter. 224 per the priority map in IsrTrace.cpp: below the
+  // audio update, and matched by the haptic timer because every
+  // IntervalTimer shares the one PIT interrupt.
+  senseTimer.priority(224);
+  senseTimer.begin(senseTimerTick, SENSE_TIMER_PERIOD_US);
+}
+
+// Finish the boot calibration window: seed the floors from the measured
+// open-circuit baselines and persist them. Loop context (taskSense) -
+// EEPROM writes do not belong in the sense tick.
+void audioSenseCalibLoop() {
+  if (!calibActive || millis() - calibStartMs < CALIB_WINDOW_MS) {
+    return;
+  }
+  calibActive = false;
+
+  float floors[MAX_STATUES - 1];
+  for (int i = 0; i < MAX_STATUES - 1; i++) {
+    floors[i] = detectorNoiseFloors[i]; // Cached seed stands by default
+    if (calibCount[i] >= CALIB_MIN_SAMPLES &&
+        calibPeak[i] < detectorThresholds[i]) {
+      floors[i] = calibSum[i] / calibCount[i];
+      detectorNoiseFloors[i] = floors[i];
+    }
+  }
+  calibCacheSave(floors, MAX_STATUES - 1);
+
+  Serial.print("Calibration: open-circuit baselines");
+  for (int i = 0; i < MAX_STATUES - 1; i++) {
+    Serial.printf(" %.4f", (double)floors[i]);
+  }
+  Serial.println();
+}
+
+// ---- Live tuning handoff (missing_link/tune) ----
+// Loop context fills the shadow block and bumps tuneSeq last; the sense
+// tick copies the block in before running the state machine, so a tick
+// sees either the old parameters or the new ones, never a mix.
+static float stagedThresholds[MAX_STATUES - 1];
+static float stagedUnlinkRatios[MAX_STATUES - 1];
+static uint16_t stagedTransitionMs = TRANSITION_BUFFER_MS_DEFAULT;
+static volatile uint32_t tuneSeq = 0;
+static volatile uint32_t tuneAppliedSeq = 0;
+
+// Recompute the shadow block from the current threshold tables and the
+// loop-side targets, then hand it to the sense tick. Returns the
+// sequence number the apply will carry.
+uint32_t audioSenseStageTuning() {
+  int detectorIndex = 0;
+  for (int statue_idx = 0; statue_idx < NUM_STATUES; statue_idx++) {
+    if (statue_idx != MY_STATUE_INDEX) {
+      stagedThresholds[detectorIndex] =
+          pairThreshold(MY_STATUE_INDEX, statue_idx);
+      stagedUnlinkRatios[detectorIndex] = STATUE_UNLINK_RATIOS[statue_idx];
+      detectorIndex++;
+    }
+  }
+  stagedTransitionMs = tuneTransitionBufferMs;
+  tuneSeq = tuneSeq + 1; // Written last: the tick only copies after this
+  return tuneSeq;
+}
+
+// Sequence number of the last tuning block the sense tick applied.
+uint32_t audioSenseTuneApplied() { return tuneAppliedSeq; }
+
+// ---- Shadow A/B detector comparison (missing_link/shadow) ----
+// A candidate threshold/debounce configuration runs in parallel on the
+// same magnitudes as production, never acting on its output. The
+// divergence counters show what the candidate would have changed under
+// a day of real traffic before it is flipped live via missing_link/tune.
+static bool shadowEnabled = false;
+static float shadowThresholds[MAX_STATUES - 1];
+static uint16_t shadowTransitionMs = TRANSITION_BUFFER_MS_DEFAULT;
+static LinkDebounce shadowDebounce;
+static volatile uint32_t shadowSamples = 0;
+static volatile uint32_t shadowWouldLink = 0; // Shadow linked, production not
+static volatile uint32_t shadowWouldMiss = 0; // Production linked, shadow not
+
+void audioSenseShadowEnable(bool enabled) {
+  if (enabled && !shadowEnabled) {
+    // Start the candidate from the production configuration; overrides
+    // arrive afterwards. Tears from these loop-context writes are
+    // harmless - the shadow never drives anything.
+    for (int i = 0; i < MAX_STATUES - 1; i++) {
+      shadowThresholds[i] = detectorThresholds[i];
+    }
+    shadowDebounce = LinkDebounce();
+    shadowSamples = 0;
+    shadowWouldLink = 0;
+    shadowWouldMiss = 0;
+  }
+  shadowEnabled = enabled;
+}
+
+void audioSenseShadowSetThreshold(int statueIndex, float threshold) {
+  if (statueIndex == MY_STATUE_INDEX || statueIndex < 0 ||
+      statueIndex >= NUM_STATUES) {
+    return;
+  }
+  int detectorIndex =
+      (statueIndex < MY_STATUE_INDEX) ? statueIndex : statueIndex - 1;
+  shadowThresholds[detectorIndex] = threshold;
+}
+
+void audioSenseShadowSetTransitionMs(uint16_t ms) { shadowTransitionMs = ms; }
+
+// Snapshot and reset the divergence counters. Returns false when the
+// shadow is not running.
+bool audioSenseShadowReport(uint32_t *samples, uint32_t *wouldLink,
+                            uint32_t *wouldMiss) {
+  if (!shadowEnabled) {
+    return false;
+  }
+  *samples = shadowSamples;
+  *wouldLink = shadowWouldLink;
+  *wouldMiss = shadowWouldMiss;
+  shadowSamples = 0;
+  shadowWouldLink = 0;
+  shadowWouldMiss = 0;
+  return true;
+}
+
+// Timer ISR: swap in any staged tuning block, switch TDM gates if a slot
+// boundary passed, then run the debounce state machine and publish the
+// stable mask through the lock-free snapshot byte.
+void senseTimerTick() {
+  if (tuneAppliedSeq != tuneSeq) {
+    for (int i = 0; i < MAX_STATUES - 1; i++) {
+      detectorThresholds[i] = stagedThresholds[i];
+      detectorUnlinkRatios[i] = stagedUnlinkRatios[i];
+    }
+    transitionBufferMs = stagedTransitionMs;
+    tuneAppliedSeq = tuneSeq;
+  }
+  tdmTick();
+  dutyCycleTick();
+  latestLinkedMask = getStableLinkedMask();
+  // Flight recorder: one compact record per tick while armed (no-op
+  // otherwise; the SD flush happens from the scheduler task).
+  flightRecorderCapture(detectorSignals, latestLinkedMask);
+}
+
+// Configure (or restore) each detector for its statue's frequency. Called
+// from audioSenseSetup() and again after a frequency sweep ends.
+// Peers the broker has marked powered-off (missing_link/presence). Their
+// detector slots are dropped from the single-pass kernel entirely.
+static StatueMask peerOfflineMask = 0;
+
+// Drop one detector slot (primary and guards) out of the audio kernel.
+static void disableDetectorSlot(int detectorIndex) {
+  senseBank.disable(detectorIndex);
+#if QUAD_SENSE_INPUT
+  senseBank2.disable(detectorIndex);
+#endif
+  for (int g = 0; g < GOERTZEL_GUARDS_PER_DET; g++) {
+    uint8_t bin = goertzelGuardBin(detectorIndex, g);
+    senseBank.disable(bin);
+#if QUAD_SENSE_INPUT
+    senseBank2.disable(bin);
+#endif
+  }
+}
+
+// Tune one detector slot (primary, window shape, guard bins) for its
+// statue. A slot whose peer is marked offline is configured and then
+// immediately dropped, so presence-return only has to re-run this.
+static void configureDetectorSlot(int detectorIndex, int statue_idx) {
   const int sample_time_ms = main_period_ms / 2;
+  int freq = STATUE_FREQUENCIES[statue_idx];
+  int cycles = sample_time_ms * freq / 1000;
+  senseBank.frequency(detectorIndex, freq, cycles);
+#if QUAD_SENSE_INPUT
+  senseBank2.frequency(detectorIndex, freq, cycles);
+#endif
+  // Hann-weight every window: rectangular sidelobes are only ~13 dB
+  // down, so the short adaptive window picks up the neighboring statue
+  // frequencies; Hann keeps them ~30 dB down at the cost of a wider
+  // main lobe the tone grid already has room for.
+  senseBank.setHannWindow(detectorIndex, true);
+#if QUAD_SENSE_INPUT
+  senseBank2.setHannWindow(detectorIndex, true);
+#endif
+
+  // Guard bins at the third-order intermod products of our own tone
+  // with this remote tone: nonlinearity that lands ghost energy on
+  // the primary bin necessarily populates these, while a genuine
+  // tone does not. Products outside the coefficient grid (rare with
+  // the default frequency plan) leave that guard disabled.
+  int guardFreqs[GOERTZEL_GUARDS_PER_DET] = {2 * freq - MY_TX_FREQ,
+                                             2 * MY_TX_FREQ - freq};
+  for (int g = 0; g < GOERTZEL_GUARDS_PER_DET; g++) {
+    uint8_t bin = goertzelGuardBin(detectorIndex, g);
+    int guardFreq = guardFreqs[g];
+    if (guardFreq >= GOERTZEL_GRID_MIN_HZ &&
+        guardFreq <= GOERTZEL_GRID_MIN_HZ +
+                         (GOERTZEL_GRID_COUNT - 1) * GOERTZEL_GRID_STEP_HZ) {
+      int guardCycles = sample_time_ms * guardFreq / 1000;
+      senseBank.frequency(bin, guardFreq, guardCycles);
+      senseBank.setHannWindow(bin, true);
+#if QUAD_SENSE_INPUT
+      senseBank2.frequency(bin, guardFreq, guardCycles);
+      senseBank2.setHannWindow(bin, true);
+#endif
+    } else {
+      senseBank.disable(bin);
+#if QUAD_SENSE_INPUT
+      senseBank2.disable(bin);
+#endif
+    }
+  }
+  detectorInShortWindow[detectorIndex] = false;
+
+  if (peerOfflineMask & (StatueMask)(1 << statue_idx)) {
+    disableDetectorSlot(detectorIndex);
+  }
+}
+
+void configureDetectors() {
+  const int sample_time_ms = main_period_ms / 2;
+
+  // Precompute the two adaptive window lengths in segments. All detectors
+  // start in the long (precise) window.
+  shortWindowSegments = windowMsToSegments(ADAPTIVE_SHORT_WINDOW_MS);
+  longWindowSegments = windowMsToSegments(sample_time_ms);
 
-  // Configure each detector for the appropriate frequency
   int detectorIndex = 0;
   for (int statue_idx = 0; statue_idx < NUM_STATUES; statue_idx++) {
     if (statue_idx != MY_STATUE_INDEX) {
-      int freq = STATUE_FREQUENCIES[statue_idx];
-      int cycles = sample_time_ms * freq / 1000;
-      leftDetectors[detectorIndex]->frequency(freq, cycles);
-      rightDetectors[detectorIndex]->frequency(freq, cycles);
+      configureDetectorSlot(detectorIndex, statue_idx);
 
       // Initialize threshold for this detector (will be set from StatueConfig)
       detectorThresholds[detectorIndex] = 0.01; // Default
+      detectorUnlinkRatios[detectorIndex] = UNLINK_RATIO_DEFAULT;
 
       Serial.printf("    Detector %d: %s at %dHz, threshold %.4f\n",
-                    detectorIndex, STATUE_NAMES[statue_idx], freq,
+                    detectorIndex, STATUE_NAMES[statue_idx],
+                    STATUE_FREQUENCIES[statue_idx],
                     detectorThresholds[detectorIndex]);
       detectorIndex++;
     }
   }
+}
 
-  pinMode(LED1_PIN, OUTPUT);
-  pinMode(LED2_PIN, OUTPUT);
-  pinMode(LED3_PIN, OUTPUT);
+// Presence gating (missing_link/presence/<peer>): a powered-off peer
+// cannot transmit, so its detector slot is pure wasted ISR time - worse,
+// an open bin tracking noise trains that slot's floor on whatever the
+// site radiates at the dead statue's frequency. Dropped slots rejoin the
+// kernel the moment the broker flips the peer back online.
+void setDetectorPresence(int statueIndex, bool online) {
+  if (statueIndex < 0 || statueIndex >= NUM_STATUES ||
+      statueIndex == MY_STATUE_INDEX) {
+    return;
+  }
+  StatueMask bit = (StatueMask)(1 << statueIndex);
+  bool wasOffline = (peerOfflineMask & bit) != 0;
+  if (online != wasOffline) {
+    return; // No change
+  }
+  peerOfflineMask = online ? (peerOfflineMask & ~bit) : (peerOfflineMask | bit);
 
-  // Configure sine generator to transmit THIS statue's frequency
-  AudioNoInterrupts(); // disable audio library momentarily
-  sine1.frequency(MY_TX_FREQ);
-  sine1.amplitude(1.0);
-  AudioInterrupts(); // enable, tone will start
+  int detectorIndex = 0;
+  for (int statue_idx = 0; statue_idx < NUM_STATUES; statue_idx++) {
+    if (statue_idx != MY_STATUE_INDEX) {
+      if (statue_idx == statueIndex) {
+        if (online) {
+          configureDetectorSlot(detectorIndex, statue_idx);
+        } else {
+          disableDetectorSlot(detectorIndex);
+        }
+      }
+      detectorIndex++;
+    }
+  }
+  Serial.printf("Detector gating: %s %s\n", STATUE_NAMES[statueIndex],
+                online ? "online, slot re-enabled" : "offline, slot dropped");
+}
+
+// Runtime frequency announcement: a peer's presence birth carries its
+// emit frequency, so a peer flashed with a different plan - or a fresh
+// statue taking over a registry slot - retunes our detector the moment
+// it powers on, with no config push or reflash here. The retune is the
+// same coefficient-table path the realloc protocol uses; the floor
+// trained at the old frequency means nothing at the new one.
+void audioSensePeerAnnounce(int statueIndex, int freq) {
+  if (statueIndex < 0 || statueIndex >= NUM_STATUES ||
+      statueIndex == MY_STATUE_INDEX) {
+    return;
+  }
+  const int maxHz =
+      GOERTZEL_GRID_MIN_HZ + (GOERTZEL_GRID_COUNT - 1) * GOERTZEL_GRID_STEP_HZ;
+  if (freq < GOERTZEL_GRID_MIN_HZ || freq > maxHz ||
+      STATUE_FREQUENCIES[statueIndex] == freq) {
+    return;
+  }
+  STATUE_FREQUENCIES[statueIndex] = freq;
+  int detectorIndex =
+      (statueIndex < MY_STATUE_INDEX) ? statueIndex : statueIndex - 1;
+  AudioNoInterrupts();
+  configureDetectorSlot(detectorIndex, statueIndex);
+  AudioInterrupts();
+  audioSenseResetNoiseFloor(detectorIndex);
+  Serial.printf("Discovery: %s announced %d Hz, detector retuned\n",
+                STATUE_NAMES[statueIndex], freq);
+}
+
+bool audioSenseTransitionActive() {
+  for (int i = 0; i < MAX_STATUES - 1; i++) {
+    if (detectorInShortWindow[i]) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Retune the whole sense chain (TX sine, self-echo notches, detectors,
+// thresholds) to the current StatueConfig. Needed because the network
+// supervisor may resolve the real statue identity after audioSenseSetup()
+// already ran with the defaults.
+void retuneAudioSense() {
+  AudioNoInterrupts();
+  sine1.frequency(goertzelSnapFreq(MY_TX_FREQ));
+  notchLeft.setNotch(0, MY_TX_FREQ, SELF_ECHO_NOTCH_Q);
+  notchRight.setNotch(0, MY_TX_FREQ, SELF_ECHO_NOTCH_Q);
+#if QUAD_SENSE_INPUT
+  notchLeft2.setNotch(0, MY_TX_FREQ, SELF_ECHO_NOTCH_Q);
+  notchRight2.setNotch(0, MY_TX_FREQ, SELF_ECHO_NOTCH_Q);
+#endif
+  configureDetectors();
+  AudioInterrupts();
+  updateDetectorThresholds();
+  Serial.printf("Audio sense retuned: TX %d Hz (%s)\n", MY_TX_FREQ,
+                MY_STATUE_NAME);
+}
+
+// --- TDM gating (see TdmSchedule.ino) ---
+
+// Gate the tone for TDM slots through the raised-cosine ramp rather
+// than a hard amplitude switch, so slot edges are spectrally clean.
+// Quiet (no serial) because this switches at slot rate;
+// setToneEnabled() remains the operator-facing on/off with logging.
+void setToneGate(bool on) {
+  toneRamp.fadeTo(on ? 1.0f : 0.0f, TONE_GATE_RAMP_MS);
+}
+
+// Gate a detector's integration window for TDM slots. Guards gate with
+// their primary: they should only integrate while the primary does.
+void setDetectorGate(int detectorIndex, bool gated) {
+  senseBank.setGate(detectorIndex, gated);
+#if QUAD_SENSE_INPUT
+  senseBank2.setGate(detectorIndex, gated);
+#endif
+  for (int g = 0; g < GOERTZEL_GUARDS_PER_DET; g++) {
+    uint8_t bin = goertzelGuardBin(detectorIndex, g);
+    senseBank.setGate(bin, gated);
+#if QUAD_SENSE_INPUT
+    senseBank2.setGate(bin, gated);
+#endif
+  }
+}
+
+// --- Frequency sweep support (see FreqSweep.ino) ---
+
+// Point the sense tone generator at an arbitrary frequency (sweep TX side).
+void setSenseToneFrequency(int freq) {
+  AudioNoInterrupts();
+  sine1.frequency(freq);
+  AudioInterrupts();
+}
+
+// Retune detector 0 as a short-window probe at the given frequency
+// (sweep RX side). configureDetectors() restores normal operation.
+void tuneSweepProbe(int freq) {
+  int cycles = ADAPTIVE_SHORT_WINDOW_MS * freq / 1000;
+  senseBank.frequency(0, freq, cycles);
+  // Same window as the real detectors, so sweep readings match what
+  // detection will actually see at each candidate frequency.
+  senseBank.setHannWindow(0, true);
+}
+
+// Read the probe magnitude (max of both channels).
+float readSweepProbe() {
+  return max(senseBank.read(0, 0), senseBank.read(0, 1));
 }
 
 // Control the tone generator on/off via MQTT
@@ -146,20 +869,21 @@ void setToneEnabled(bool enabled) {
 
   if (toneEnabled != enabled) {
     toneEnabled = enabled;
-    AudioNoInterrupts();
-    // sine1.amplitude(enabled ? 1.0 : 0.0);
-    if (enabled) {
-      patchCordToneOut.connect();
-    } else {
-      patchCordToneOut.disconnect();
-    }
-    AudioInterrupts();
+    // Ramp instead of the old patch-cord connect/disconnect, which put
+    // a click on the hands and a transient into peer detectors.
+    toneRamp.fadeTo(enabled ? 1.0f : 0.0f, TONE_ENABLE_RAMP_MS);
 
     Serial.print("Tone generator ");
     Serial.println(enabled ? "enabled" : "disabled");
   }
 }
 
+// Closed-loop TX level (TxLevel.ino). Scales the sine itself; on/off
+// gating still goes through toneRamp, so the two never fight.
+void audioSenseSetTxAmplitude(float amp) {
+  sine1.amplitude(constrain(amp, 0.0f, 1.0f));
+}
+
 void debugPrintAudioSense(float l1, float r1) {
 #ifdef DEBUG_PRINT
   Serial.print("Detecting ");
@@ -172,7 +896,6 @@ void debugPrintAudioSense(float l1, float r1) {
 #endif
 }
 
-#define TRANSITION_BUFFER_MS 100
 
 void printTransition(bool buffering, bool stableIsLinked,
                      bool candidateIsLinked) {
@@ -188,37 +911,181 @@ void printTransition(bool buffering, bool stableIsLinked,
     Serial.println(" while buffering...");
   } else {
     Serial.print(" after buffering for ");
-    Serial.print(TRANSITION_BUFFER_MS);
+    Serial.print(transitionBufferMs);
     Serial.println("ms.");
   }
 }
 
+/*
+  Local link cue: the fastest feedback the installation gives. The full
+  touch-to-light loop runs Teensy -> mosquitto -> Pi -> WLED; these
+  writes happen in the sense timer context the instant the debouncer
+  commits a transition, so the statue acknowledges contact within the
+  same sense period. The cue owns the LED pins for its hold window, then
+  the music meter (updateMusicLeds) takes them back.
+*/
+#define LINK_CUE_HOLD_MS 250
+
+static volatile uint64_t linkCueUntilUs = 0;
+
+static void triggerLinkCue(bool linked) {
+  // All three full-on for a link, dark for an unlink; three PWM
+  // register writes, well under a microsecond.
+  uint16_t duty = linked ? 1023 : 0;
+  analogWrite(LED1_PIN, duty);
+  analogWrite(LED2_PIN, duty);
+  analogWrite(LED3_PIN, duty);
+  linkCueUntilUs = monoNowUs() + LINK_CUE_HOLD_MS * 1000ull;
+}
+
 // Get the linked state bitmask, buffering over ~100ms for stable readings.
-uint8_t getStableLinkedMask() {
-  // Send signal
-  sine1.amplitude(1.0);
+StatueMask getStableLinkedMask() {
+  // (The old per-call sine1.amplitude(1.0) reassert is gone: amplitude
+  // is fixed at setup and all gating goes through toneRamp, which the
+  // TDM and duty-cycle schedulers own.)
 
-  // Static state for buffering per statue
-  // Use MAX_STATUES for array size to support all configurations
-  static uint8_t stableLinkedMask = 0;
-  static unsigned long bufferStartTime[MAX_STATUES] = {0};
-  static bool buffering[MAX_STATUES] = {false};
+  // The debounce state machine itself is pure (LinkDebounce.h, covered
+  // by tests/debounce_spec.cpp); this function feeds it thresholded
+  // readings and the wall clock.
+  static LinkDebounce debounce;
 
-  uint8_t candidateLinkedMask = 0;
+  // Overload hold: a clipped input makes every magnitude this pass
+  // garbage, so freeze the debounce and the noise-floor training through
+  // flagged blocks instead of letting a rail event fake an unlink.
+  // clipGuardLoop() steps the input attenuation down from loop context.
+  bool inputClipped = senseInputClipped();
+
+  StatueMask candidateLinkedMask = 0;
 
   // Check all detectors
   int detectorIndex = 0;
   for (int statue_idx = 0; statue_idx < NUM_STATUES; statue_idx++) {
     if (statue_idx != MY_STATUE_INDEX) {
-      float left = leftDetectors[detectorIndex]->read();
-      float right = rightDetectors[detectorIndex]->read();
+      // Read every electrode channel and combine by taking the strongest:
+      // with the redundant pair fitted, a corroded connection on one hand
+      // just drops that channel out of the max.
+      float *mags = detectorChannelMags[detectorIndex];
+      mags[0] = senseBank.read(detectorIndex, 0);
+      mags[1] = senseBank.read(detectorIndex, 1);
+#if QUAD_SENSE_INPUT
+      mags[2] = senseBank2.read(detectorIndex, 0);
+      mags[3] = senseBank2.read(detectorIndex, 1);
+      const int senseChannels = 4;
+#else
+      const int senseChannels = 2;
+#endif
+      // Masked-out channels stay in the telemetry but never drive the
+      // decision. An empty mask degrades to channel 0 rather than a
+      // detector that can never link.
+      uint8_t chanMask = detectorChannelMasks[detectorIndex];
+      int strongerChannel = -1;
+      for (int ch = 0; ch < senseChannels; ch++) {
+        if (!(chanMask & (1 << ch))) {
+          continue;
+        }
+        if (strongerChannel < 0 || mags[ch] > mags[strongerChannel]) {
+          strongerChannel = ch;
+        }
+      }
+      if (strongerChannel < 0) {
+        strongerChannel = 0;
+      }
 
       // Store the maximum signal strength for display
-      detectorSignals[detectorIndex] = max(left, right);
+      // Smoothing stage (see MAG_FAST_ALPHA above): the spike-resistant
+      // value is what everything downstream reads.
+      float rawMagnitude = mags[strongerChannel];
+      detectorFastMags[detectorIndex] +=
+          MAG_FAST_ALPHA * (rawMagnitude - detectorFastMags[detectorIndex]);
+      detectorSignals[detectorIndex] = detectorFastMags[detectorIndex];
+
+      // Derive SNR: tone power (magnitude is sine amplitude, power m^2/2)
+      // over the residual channel power once the tone is removed.
+      detectorPhases[detectorIndex] = bankForChannel(strongerChannel)
+                                          .readPhase(detectorIndex,
+                                                     strongerChannel & 1);
+      float tonePower = detectorSignals[detectorIndex] *
+                        detectorSignals[detectorIndex] * 0.5f;
+      float noisePower =
+          bankForChannel(strongerChannel).channelPower(strongerChannel & 1) -
+          tonePower;
+      if (noisePower < 1e-9f) {
+        noisePower = 1e-9f;
+      }
+      detectorSNRs[detectorIndex] = tonePower / noisePower;
 
-      // Use detector-specific threshold instead of global thresh
-      float detectorThresh = detectorThresholds[detectorIndex];
-      bool isDetected = left > detectorThresh || right > detectorThresh;
+      // Train the noise floor only on off-signal readings: statue unlinked
+      // and the magnitude below the configured (ceiling) threshold.
+      bool stableLinked = debounce.isLinked(statue_idx);
+      float magnitude = detectorSignals[detectorIndex];
+      if (!inputClipped && !stableLinked &&
+          magnitude < detectorThresholds[detectorIndex]) {
+        detectorNoiseFloors[detectorIndex] +=
+            NOISE_FLOOR_ALPHA * (magnitude - detectorNoiseFloors[detectorIndex]);
+      }
+
+      // Boot calibration statistics (see audioSenseCalibLoop).
+      if (calibActive && !inputClipped) {
+        calibSum[detectorIndex] += magnitude;
+        if (magnitude > calibPeak[detectorIndex]) {
+          calibPeak[detectorIndex] = magnitude;
+        }
+        calibCount[detectorIndex]++;
+      }
+
+      // Use the adaptive per-detector threshold (noise floor x margin).
+      // Schmitt trigger: a linked detector holds until the magnitude
+      // falls below threshold * ratio, an unlinked one trips at the full
+      // threshold, so jitter around one trip point cannot flap the link.
+      float detectorThresh = getEffectiveThreshold(detectorIndex);
+      bool isDetected =
+          magnitude > (stableLinked
+                           ? detectorThresh * detectorUnlinkRatios[detectorIndex]
+                           : detectorThresh);
+
+      // Harmonic guard veto: if the intermod guard bins carry a sizable
+      // fraction of the primary magnitude, the "tone" is a nonlinearity
+      // product, not a link. An established link is not torn down by the
+      // guards - intermod on top of a genuine strong signal is expected.
+      float guardMag = 0.0f;
+      for (int g = 0; g < GOERTZEL_GUARDS_PER_DET; g++) {
+        uint8_t bin = goertzelGuardBin(detectorIndex, g);
+        guardMag = max(guardMag, max(senseBank.read(bin, 0),
+                                     senseBank.read(bin, 1)));
+#if QUAD_SENSE_INPUT
+        guardMag = max(guardMag, max(senseBank2.read(bin, 0),
+                                     senseBank2.read(bin, 1)));
+#endif
+      }
+      detectorGuardMags[detectorIndex] = guardMag;
+      if (isDetected && !stableLinked &&
+          guardMag > magnitude * GUARD_VETO_RATIO) {
+        isDetected = false;
+      }
+
+      // Adaptive window: drop to the short window while the magnitude sits
+      // in the hysteresis band around the threshold (a transition in
+      // progress), return to the long window once clear for a while.
+      bool inBand = magnitude > detectorThresh * ADAPTIVE_BAND_LOW &&
+                    magnitude < detectorThresh * ADAPTIVE_BAND_HIGH;
+      if (inBand) {
+        detectorLastInBandMs[detectorIndex] = millis();
+        if (!detectorInShortWindow[detectorIndex]) {
+          detectorInShortWindow[detectorIndex] = true;
+          senseBank.setWindowSegments(detectorIndex, shortWindowSegments);
+#if QUAD_SENSE_INPUT
+          senseBank2.setWindowSegments(detectorIndex, shortWindowSegments);
+#endif
+        }
+      } else if (detectorInShortWindow[detectorIndex] &&
+                 millis() - detectorLastInBandMs[detectorIndex] >=
+                     ADAPTIVE_STEADY_MS) {
+        detectorInShortWindow[detectorIndex] = false;
+        senseBank.setWindowSegments(detectorIndex, longWindowSegments);
+#if QUAD_SENSE_INPUT
+        senseBank2.setWindowSegments(detectorIndex, longWindowSegments);
+#endif
+      }
       if (isDetected) {
         candidateLinkedMask |= (1 << statue_idx);
       }
@@ -226,57 +1093,198 @@ uint8_t getStableLinkedMask() {
 // Debug output for each detector
 #ifdef DEBUG_PRINT
       if (isDetected) {
-        Serial.printf("Detected %s: L=%.3f R=%.3f\n", STATUE_NAMES[statue_idx],
-                      left, right);
+        Serial.printf("Detected %s: mag=%.3f ch=%d\n",
+                      STATUE_NAMES[statue_idx], magnitude, strongerChannel);
       }
 #endif
 
-      // Handle buffering for this specific statue
-      bool wasLinked = (stableLinkedMask & (1 << statue_idx)) != 0;
-      bool nowLinked = (candidateLinkedMask & (1 << statue_idx)) != 0;
-
-      if (!wasLinked && nowLinked) {
-        // Immediate transition to Linked for quick contact latency
-        stableLinkedMask |= (1 << statue_idx);
-        buffering[statue_idx] = false;
-        Serial.printf("Link detected: %s\n", STATUE_NAMES[statue_idx]);
-      } else if (wasLinked && !nowLinked) {
-        // Buffer transition to Unlinked
-        if (!buffering[statue_idx]) {
-          buffering[statue_idx] = true;
-          bufferStartTime[statue_idx] = millis();
-        } else if (millis() - bufferStartTime[statue_idx] >=
-                   TRANSITION_BUFFER_MS) {
-          // Finished buffering, unlink
-          stableLinkedMask &= ~(1 << statue_idx);
-          buffering[statue_idx] = false;
-          Serial.printf("Link lost: %s\n", STATUE_NAMES[statue_idx]);
-        }
+      // Update contact quality: smoothed magnitude mapped between the
+      // effective threshold and QUALITY_FULL_SCALE times it.
+      smoothedMagnitudes[detectorIndex] +=
+          QUALITY_SMOOTH_ALPHA *
+          (magnitude - smoothedMagnitudes[detectorIndex]);
+      if (isDetected) {
+        float span = detectorThresh * (QUALITY_FULL_SCALE - 1.0f);
+        float q = (smoothedMagnitudes[detectorIndex] - detectorThresh) / span;
+        latestQuality[statue_idx] =
+            (uint8_t)constrain(q * 100.0f, 0.0f, 100.0f);
       } else {
-        // No transition needed
-        buffering[statue_idx] = false;
+        latestQuality[statue_idx] = 0;
+      }
+
+      // A clipped pass carries no usable detection information: hold
+      // both debouncers exactly where they are.
+      if (inputClipped) {
+        detectorIndex++;
+        continue;
+      }
+
+      // Shadow candidate: same magnitudes, candidate threshold and
+      // debounce window, output observed but never acted on.
+      if (shadowEnabled) {
+        bool shadowDetected = magnitude > shadowThresholds[detectorIndex];
+        shadowDebounce.update(statue_idx, shadowDetected, monoNowMs(),
+                              shadowTransitionMs);
+      }
+
+      // Debounce: immediate link, buffered unlink (LinkDebounce.h).
+      LinkDebounceEvent event = debounce.update(
+          statue_idx, isDetected, monoNowMs(), transitionBufferMs);
+      if (event == LINK_ESTABLISHED) {
+        LOG_INFO("link detected: %s", STATUE_NAMES[statue_idx]);
+        // Local acknowledgment straight from the sense context: the
+        // LEDs confirm contact within this sense period while the WLED
+        // scene follows over MQTT.
+        triggerLinkCue(true);
+      } else if (event == LINK_LOST) {
+        LOG_INFO("link lost: %s", STATUE_NAMES[statue_idx]);
+        triggerLinkCue(false);
       }
 
       detectorIndex++;
     }
   }
 
-  return stableLinkedMask;
+  // Tally shadow divergence once per tick: bits only the candidate set
+  // (would-have-linked) and bits only production holds (would-have-missed).
+  if (shadowEnabled) {
+    uint16_t onlyShadow = shadowDebounce.stableMask & ~debounce.stableMask;
+    uint16_t onlyProd = debounce.stableMask & ~shadowDebounce.stableMask;
+    shadowWouldLink = shadowWouldLink + __builtin_popcount(onlyShadow);
+    shadowWouldMiss = shadowWouldMiss + __builtin_popcount(onlyProd);
+    shadowSamples = shadowSamples + 1;
+  }
+
+  // Publish a consistent snapshot of the per-detector data for the display
+  // and MQTT readers. They copy this instead of pulling the live arrays.
+  SignalSnapshot snapshot;
+  for (int i = 0; i < MAX_STATUES - 1; i++) {
+    snapshot.signals[i] = detectorSignals[i];
+    snapshot.floors[i] = detectorNoiseFloors[i];
+    snapshot.snrs[i] = detectorSNRs[i];
+    snapshot.thresholds[i] = getEffectiveThreshold(i);
+    for (int ch = 0; ch < 4; ch++) {
+      snapshot.channelMags[i][ch] = detectorChannelMags[i][ch];
+    }
+  }
+  updateSignalSnapshot(snapshot);
+
+  // Scope marker: one edge the instant the debounced mask commits a
+  // change - the point a scope pairs with the physical contact edge
+  // (LatencyMarkers.h; compiles out unless the instrumentation build).
+  static StatueMask lastMarkedMask = 0;
+  if ((StatueMask)debounce.stableMask != lastMarkedMask) {
+    lastMarkedMask = (StatueMask)debounce.stableMask;
+    latencyMarkCommit();
+  }
+
+  return (StatueMask)debounce.stableMask;
 }
 
 // Static state variables.
 bool isInitialized = false;
-uint8_t wasLinkedMask = 0;
+StatueMask wasLinkedMask = 0;
 
 // This function gets the contact state with multi-statue support.
+// Called from loop(); reads the snapshot maintained by the sense timer.
+/*
+  updateMusicLeds() - drive the spare LED pins from the music envelope.
+      - VU-style bands: LED1 tracks the envelope directly, LED2 and LED3
+        light progressively on louder passages, so the trio reads as a
+        meter pulsing with the beat (MusicEnvelope.h).
+      - Three PWM register writes per call; sampled on the sense cadence.
+*/
+void updateMusicLeds() {
+  // Yield to a link cue still inside its hold window. The 64-bit
+  // deadline is ISR-written; copy it with interrupts masked to avoid a
+  // torn 32-bit half-read.
+  noInterrupts();
+  uint64_t cueUntil = linkCueUntilUs;
+  interrupts();
+  if (monoNowUs() < cueUntil) {
+    return;
+  }
+  float level = musicEnvelopeLevel();
+  analogWrite(LED1_PIN, (int)(level * 1023));
+  analogWrite(LED2_PIN,
+              level > 0.35f ? (int)((level - 0.35f) / 0.65f * 1023) : 0);
+  analogWrite(LED3_PIN,
+              level > 0.65f ? (int)((level - 0.65f) / 0.35f * 1023) : 0);
+}
+
+/*
+  clipGuardLoop() - line-in attenuation feedback (ClipGuard.h).
+      - Clipping steps the SGTL5000 line-in level toward its least
+        sensitive setting (one step per holdoff window).
+      - A long clean stretch steps it back toward the default so a
+        transient overload does not permanently cost sensitivity.
+      - Runs from the sense task in loop context: the level change is an
+        I2C write and must never happen inside the sense timer ISR.
+*/
+#define CLIP_LINEIN_DEFAULT 5 // Library default (1.33 V p-p full scale)
+#define CLIP_ATTEN_HOLDOFF_MS 500
+#define CLIP_RECOVER_MS 60000
+
+void clipGuardLoop() {
+  static int lineInLevel = CLIP_LINEIN_DEFAULT;
+  static uint64_t lastStepUs = 0;
+  static uint64_t lastClipUs = 0;
+
+  uint64_t now = monoNowUs();
+  if (senseInputClipped()) {
+    lastClipUs = now;
+    if (lineInLevel > 0 &&
+        now - lastStepUs >= CLIP_ATTEN_HOLDOFF_MS * 1000ull) {
+      lineInLevel--;
+      audioShield.lineInLevel(lineInLevel);
+      lastStepUs = now;
+      LOG_WARN("input clipping: line-in level stepped to %d", lineInLevel);
+    }
+  } else if (lineInLevel < CLIP_LINEIN_DEFAULT &&
+             now - lastClipUs >= CLIP_RECOVER_MS * 1000ull &&
+             now - lastStepUs >= CLIP_RECOVER_MS * 1000ull) {
+    lineInLevel++;
+    audioShield.lineInLevel(lineInLevel);
+    lastStepUs = now;
+    LOG_INFO("input clean: line-in level restored to %d", lineInLevel);
+  }
+}
+
 ContactState getContactState() {
   ContactState state;
 
-  // Get the current linked mask
-  state.isLinkedMask = getStableLinkedMask();
+  // Get the current linked mask from the timer-maintained snapshot,
+  // plus any peer that claims a link to us on the peer channel: link if
+  // either side detects, unlink once both sides (and the claim) clear.
+  // Our multicast frames always carry the raw detector mask, so two
+  // statues adopting each other's claims cannot latch a phantom link.
+  state.isLinkedMask = latestLinkedMask | peerLinkClaimedMask();
+
+  // Copy the per-statue contact quality (0 for unlinked statues)
+  for (int i = 0; i < MAX_STATUES; i++) {
+    state.quality[i] = state.isLinkedTo(i) ? latestQuality[i] : 0;
+  }
   state.wasLinkedMask = wasLinkedMask;
   state.isInitialized = isInitialized;
 
+  // Edges and durations, computed once here so no consumer re-derives
+  // them. Start times persist across calls; a bit rising (re)stamps its
+  // statue, a clear bit zeroes the running duration.
+  static uint32_t linkStartMs[MAX_STATUES] = {0};
+  state.risingMask = (StatueMask)(state.isLinkedMask & ~wasLinkedMask);
+  state.fallingMask = (StatueMask)(wasLinkedMask & ~state.isLinkedMask);
+  uint32_t nowMs = (uint32_t)monoNowMs();
+  for (int i = 0; i < MAX_STATUES; i++) {
+    if (state.isLinkedTo(i)) {
+      if (state.risingMask & (1 << i)) {
+        linkStartMs[i] = nowMs;
+      }
+      state.linkMs[i] = nowMs - linkStartMs[i];
+    } else {
+      state.linkMs[i] = 0;
+    }
+  }
+
   // Update our persistent state for next call.
   isInitialized = true;
   wasLinkedMask = state.isLinkedMask;
@@ -0,0 +1,34 @@
+/*
+AudioTap: Raw audio block streaming over UDP for offline spectrum analysis.
+
+Debug aid for on-site detection problems: copies raw 128-sample blocks from
+the sensing input into an AudioRecordQueue (the queue hands out pointers to
+the ISR-filled blocks, so nothing is copied on the audio interrupt) and
+streams them over UDP to a laptop for real spectrograms against production
+hardware. The signal path is untouched; the tap is just one more patch cord
+off audioIn.
+
+Started and stopped via missing_link/tap/cmd (addressed per statue):
+  {"statue": "eros", "enabled": true, "ip": "192.168.4.50", "port": 9990}
+
+Packet format (little-endian, matching the Teensy):
+  uint32 seq, uint8 statue index, uint8 block count, uint16 samples/block,
+  then block count * samples/block int16 samples from the left input.
+*/
+
+#ifndef AUDIO_TAP_H
+#define AUDIO_TAP_H
+
+#include <Arduino.h>
+
+// Start streaming to ip:port. Returns false if the IP does not parse.
+bool startAudioTap(const char *ip, uint16_t port);
+
+void stopAudioTap();
+
+bool isAudioTapActive();
+
+// Drain queued blocks into UDP packets; called from the main loop.
+void tapLoop();
+
+#endif // AUDIO_TAP_H
@@ -0,0 +1,90 @@
+/*
+AudioTap: Raw audio block streaming over UDP.
+*/
+
+#include "AudioTap.h"
+#include "Networking.h"
+#include "StatueConfig.h"
+
+#include <Audio.h>
+
+// The record queue patched to audioIn in AudioSense.ino. Left channel only:
+// that is the channel the detectors read.
+extern AudioRecordQueue tapQueue;
+
+// Blocks per UDP packet: 4 * 128 int16 samples = 1024 bytes of payload,
+// which keeps the packet under the MTU and the packet rate near 86/s.
+#define TAP_BLOCKS_PER_PACKET 4
+
+// Per-loop cap so a backlog (e.g. after a long OLED transfer) cannot hold
+// the main loop hostage.
+#define TAP_MAX_PACKETS_PER_LOOP 4
+
+static bool tapActive = false;
+static IPAddress tapDest;
+static uint16_t tapPort = 0;
+static uint32_t tapSeq = 0;
+
+bool isAudioTapActive() { return tapActive; }
+
+bool startAudioTap(const char *ip, uint16_t port) {
+  IPAddress dest;
+  if (!dest.fromString(ip)) {
+    Serial.printf("Audio tap: bad destination IP '%s'\n", ip);
+    return false;
+  }
+
+  tapDest = dest;
+  tapPort = port;
+  tapSeq = 0;
+  tapQueue.begin();
+  tapActive = true;
+  Serial.printf("Audio tap started -> %s:%u\n", ip, port);
+  return true;
+}
+
+void stopAudioTap() {
+  if (!tapActive) {
+    return;
+  }
+  tapActive = false;
+  tapQueue.end();
+  tapQueue.clear();
+  Serial.println("Audio tap stopped");
+}
+
+void tapLoop() {
+  if (!tapActive) {
+    return;
+  }
+
+  EthernetUDP &udp = getUdp();
+
+  for (int packets = 0; packets < TAP_MAX_PACKETS_PER_LOOP; packets++) {
+    if (tapQueue.available() < TAP_BLOCKS_PER_PACKET) {
+      return;
+    }
+
+    // 8-byte header, then the raw samples written straight from the queue's
+    // block buffers into the packet (no intermediate copy on our side).
+    uint8_t header[8];
+    header[0] = tapSeq & 0xFF;
+    header[1] = (tapSeq >> 8) & 0xFF;
+    header[2] = (tapSeq >> 16) & 0xFF;
+    header[3] = (tapSeq >> 24) & 0xFF;
+    header[4] = (uint8_t)MY_STATUE_INDEX;
+    header[5] = TAP_BLOCKS_PER_PACKET;
+    header[6] = AUDIO_BLOCK_SAMPLES & 0xFF;
+    header[7] = (AUDIO_BLOCK_SAMPLES >> 8) & 0xFF;
+
+    udp.beginPacket(tapDest, tapPort);
+    udp.write(header, sizeof(header));
+    for (int b = 0; b < TAP_BLOCKS_PER_PACKET; b++) {
+      int16_t *buffer = tapQueue.readBuffer();
+      udp.write((const uint8_t *)buffer, AUDIO_BLOCK_SAMPLES * sizeof(int16_t));
+      tapQueue.freeBuffer();
+    }
+    udp.endPacket();
+    tapSeq++;
+  }
+}
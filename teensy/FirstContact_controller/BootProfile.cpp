@@ -0,0 +1,84 @@
+/*
+BootProfile.cpp - stage table and the end-of-setup budget check.
+
+millis() resolution is plenty here: the stages of interest run tens to
+thousands of milliseconds, and the point is the breakdown and the
+trend, not microsecond precision.
+
+Boot-only code, so all FLASHMEM - it never earns ITCM (placement notes
+in MemMonitor.h).
+*/
+
+#include "BootProfile.h"
+
+#include "Log.h"
+
+struct BootStage {
+  const char *name;
+  uint32_t budgetMs;
+  uint32_t startMs;
+  uint32_t elapsedMs;
+};
+
+static BootStage stages[BOOT_PROFILE_MAX_STAGES];
+static int stageCount = 0;
+static uint32_t totalMs = 0;
+static bool finished = false;
+
+FLASHMEM static void closeCurrentStage() {
+  if (stageCount > 0 && stages[stageCount - 1].elapsedMs == 0) {
+    BootStage &s = stages[stageCount - 1];
+    s.elapsedMs = millis() - s.startMs;
+    if (s.elapsedMs == 0) {
+      s.elapsedMs = 1; // Keep "closed" distinguishable from "open"
+    }
+  }
+}
+
+FLASHMEM void bootStage(const char *name, uint32_t budgetMs) {
+  closeCurrentStage();
+  if (stageCount >= BOOT_PROFILE_MAX_STAGES) {
+    return;
+  }
+  BootStage &s = stages[stageCount++];
+  s.name = name;
+  s.budgetMs = budgetMs;
+  s.startMs = millis();
+  s.elapsedMs = 0;
+}
+
+FLASHMEM void bootProfileFinish() {
+  closeCurrentStage();
+  totalMs = millis();
+  finished = true;
+
+  Serial.printf("Boot complete in %lu ms\n", (unsigned long)totalMs);
+  for (int i = 0; i < stageCount; i++) {
+    Serial.printf("  %-8s %5lu ms\n", stages[i].name,
+                  (unsigned long)stages[i].elapsedMs);
+    if (stages[i].budgetMs != 0 && stages[i].elapsedMs > stages[i].budgetMs) {
+      LOG_WARN("boot stage %s over budget: %lu ms (budget %lu)",
+               stages[i].name, (unsigned long)stages[i].elapsedMs,
+               (unsigned long)stages[i].budgetMs);
+    }
+  }
+}
+
+FLASHMEM bool bootProfileCollect(char *json, size_t jsonLen) {
+  if (!finished || stageCount == 0) {
+    return false;
+  }
+
+  size_t pos = 0;
+  pos += snprintf(json + pos, jsonLen - pos, "{\"total_ms\":%lu,\"stages\":{",
+                  (unsigned long)totalMs);
+  for (int i = 0; i < stageCount && pos < jsonLen; i++) {
+    pos += snprintf(json + pos, jsonLen - pos, "%s\"%s\":%lu",
+                    (i > 0) ? "," : "", stages[i].name,
+                    (unsigned long)stages[i].elapsedMs);
+  }
+  if (pos < jsonLen) {
+    pos += snprintf(json + pos, jsonLen - pos, "}}");
+  }
+  return pos < jsonLen;
+}
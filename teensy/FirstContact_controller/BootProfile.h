@@ -0,0 +1,33 @@
+/*
+BootProfile: per-stage boot timing with a budget report.
+
+Boot serializes network, audio, display, and SD bring-up and none of it
+was ever measured - cold-boot time after a power blip is recovery time
+for the whole statue, and a regression hides easily in an "it feels
+slow" report. setup() brackets each stage with bootStage(); the
+elapsed time per stage is kept with a budget, over-budget stages get a
+LOG_WARN at the end of setup(), and the full breakdown publishes once
+on missing_link/boot at the first MQTT connect (see publishBootReport
+in Messaging.ino).
+*/
+
+#ifndef BOOT_PROFILE_H
+#define BOOT_PROFILE_H
+
+#include <Arduino.h>
+
+#define BOOT_PROFILE_MAX_STAGES 10
+
+// Start timing a stage; implicitly closes the previous one. Budget in
+// milliseconds; 0 disables the budget check for the stage.
+void bootStage(const char *name, uint32_t budgetMs);
+
+// Close the last stage, record the boot total, and LOG_WARN any stage
+// that ran over its budget. Call at the end of setup().
+void bootProfileFinish();
+
+// Fill `json` with {"total_ms":N,"stages":{...}}. Non-destructive;
+// returns false when nothing was recorded or the buffer is too small.
+bool bootProfileCollect(char *json, size_t jsonLen);
+
+#endif // BOOT_PROFILE_H
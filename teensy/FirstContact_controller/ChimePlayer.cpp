@@ -0,0 +1,82 @@
+/*
+ChimePlayer.cpp - Compile-time synthesized link chime.
+
+The chime is a two-partial bell (a fifth apart, the higher partial decaying
+faster) with a short attack ramp so it starts click-free. It is generated
+entirely by the compiler with the same constexpr trig the Goertzel tables
+use and stored in flash (~16 KB), so there is no asset to manage on the SD
+card and nothing to load at boot.
+*/
+
+#include "ChimePlayer.h"
+#include "GoertzelTables.h"
+
+// ~180 ms at 44.1 kHz; the tail is already decayed to silence by then.
+#define CHIME_SAMPLE_COUNT 7938
+
+// Attack ramp length (samples). One audio block is enough to avoid a click.
+#define CHIME_ATTACK_SAMPLES 128
+
+namespace {
+
+struct ChimeTable {
+  int16_t v[CHIME_SAMPLE_COUNT];
+};
+
+constexpr ChimeTable makeChimeTable() {
+  ChimeTable t{};
+  // Fundamental and a fifth above it, out of the sensing band (the tones
+  // live at 5-20 kHz; the chime is musical, not a detector input).
+  const double inc1 = 2.0 * goertzel_ct::kPi * 880.0 / 44100.0;
+  const double inc2 = 2.0 * goertzel_ct::kPi * 1318.5 / 44100.0;
+  double phase1 = 0.0;
+  double phase2 = 0.0;
+  double amp1 = 0.60;  // Partial levels; sum stays below full scale
+  double amp2 = 0.35;
+  const double decay1 = 0.99950; // ~ -60 dB over the table length
+  const double decay2 = 0.99920; // Higher partial dies faster, bell-like
+  for (int i = 0; i < CHIME_SAMPLE_COUNT; i++) {
+    double s = amp1 * goertzel_ct::sinTaylor(phase1) +
+               amp2 * goertzel_ct::sinTaylor(phase2);
+    if (i < CHIME_ATTACK_SAMPLES) {
+      s *= (double)i / CHIME_ATTACK_SAMPLES;
+    }
+    t.v[i] = (int16_t)(s * 32767.0);
+    phase1 = goertzel_ct::wrap(phase1 + inc1);
+    phase2 = goertzel_ct::wrap(phase2 + inc2);
+    amp1 *= decay1;
+    amp2 *= decay2;
+  }
+  return t;
+}
+
+const ChimeTable CHIME_TABLE PROGMEM = makeChimeTable();
+
+} // namespace
+
+void AudioPlayChime::trigger() {
+  __disable_irq();
+  pos = 0;
+  playing = true;
+  __enable_irq();
+}
+
+void AudioPlayChime::update(void) {
+  if (!playing) {
+    return;
+  }
+  audio_block_t *block = allocate();
+  if (!block) {
+    return;
+  }
+  uint32_t p = pos;
+  for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+    block->data[i] = (p < CHIME_SAMPLE_COUNT) ? CHIME_TABLE.v[p++] : 0;
+  }
+  pos = p;
+  if (p >= CHIME_SAMPLE_COUNT) {
+    playing = false;
+  }
+  transmit(block);
+  release(block);
+}
@@ -0,0 +1,41 @@
+/*
+ChimePlayer: One-shot flash-resident sample player for the link chime.
+
+The active song streams from SD, so even with the RAM intro path the first
+audible confirmation of a link trails the touch by the state-machine and
+buffer-priming latency. This player holds a short PCM chime in program
+flash - synthesized at compile time, no asset file, no SD involvement -
+and plays it straight into the music mixer when trigger() is called from
+the link-transition branch in playMusic(). Worst-case latency from
+trigger() to sound is one audio block period (~2.9 ms).
+
+Modeled on the Audio library's AudioPlayMemory, minus the format header:
+the table is known int16 mono at the native 44.1 kHz rate.
+*/
+
+#ifndef CHIME_PLAYER_H
+#define CHIME_PLAYER_H
+
+#include <Arduino.h>
+#include <Audio.h>
+
+class AudioPlayChime : public AudioStream {
+public:
+  AudioPlayChime() : AudioStream(0, NULL) {
+    pos = 0;
+    playing = false;
+  }
+
+  // Start (or restart) the chime from the top. Safe to call from loop();
+  // the audio update picks it up on its next pass.
+  void trigger();
+  bool isPlaying() { return playing; }
+
+  virtual void update(void);
+
+private:
+  volatile uint32_t pos;
+  volatile bool playing;
+};
+
+#endif // CHIME_PLAYER_H
@@ -0,0 +1,31 @@
+/*
+ClipGuard.cpp - per-block clip counter implementation.
+*/
+
+#include "ClipGuard.h"
+
+void AudioAnalyzeClip::update(void) {
+  audio_block_t *block = receiveReadOnly();
+  if (block == NULL) {
+    if (streak > 0) {
+      streak = streak - 1;
+    }
+    return;
+  }
+
+  int railed = 0;
+  for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+    int32_t s = block->data[i];
+    if (s >= CLIP_SAMPLE_LEVEL || s <= -CLIP_SAMPLE_LEVEL) {
+      railed++;
+    }
+  }
+  release(block);
+
+  if (railed >= CLIP_SAMPLES_PER_BLOCK) {
+    streak = CLIP_HOLD_BLOCKS;
+    totalClipped = totalClipped + 1;
+  } else if (streak > 0) {
+    streak = streak - 1;
+  }
+}
@@ -0,0 +1,50 @@
+/*
+ClipGuard: per-block clip detection on the sensing input.
+
+A hand grounded to a generator chassis can rail the line input, and a
+clipped block makes the Goertzel magnitudes garbage - they typically
+DROP while contact is solid, faking an unlink. This analyze node counts
+near-full-scale samples per block inside the audio update and holds a
+"clipped" flag for a few blocks after the last hit. AudioSense.ino
+freezes the debounce and noise-floor training while the flag is up and
+steps the SGTL5000 line-in attenuation down from loop context (see
+clipGuardLoop()).
+*/
+
+#ifndef CLIP_GUARD_H
+#define CLIP_GUARD_H
+
+#include <Audio.h>
+
+// |sample| at or above this counts as railed (full scale is 32767; the
+// margin rides through codec DC offset).
+#define CLIP_SAMPLE_LEVEL 32700
+// Railed samples per block before the block is flagged - a lone spike is
+// not an overload.
+#define CLIP_SAMPLES_PER_BLOCK 4
+// Blocks the flag holds after the last clipped block (~12 ms), covering
+// the detector windows that ingested the garbage.
+#define CLIP_HOLD_BLOCKS 4
+
+class AudioAnalyzeClip : public AudioStream {
+public:
+  AudioAnalyzeClip() : AudioStream(1, inputQueueArray) {
+    streak = 0;
+    totalClipped = 0;
+  }
+
+  // True while the current or a recent block clipped.
+  bool clipped() { return streak > 0; }
+
+  // Lifetime count of clipped blocks (for telemetry).
+  uint32_t clipBlocks() { return totalClipped; }
+
+  virtual void update(void);
+
+private:
+  audio_block_t *inputQueueArray[1];
+  volatile uint8_t streak;
+  volatile uint32_t totalClipped;
+};
+
+#endif // CLIP_GUARD_H
@@ -0,0 +1,278 @@
+/*
+ConfigStore.cpp - EEPROM-backed binary config cache implementation.
+
+Everything here is a boot-time load or a rare save, so it is all
+FLASHMEM: code this cold has no business occupying ITCM, which comes
+out of the same FlexRAM banks DTCM needs (placement notes in
+MemMonitor.h).
+*/
+
+#include "ConfigStore.h"
+#include "StatueConfig.h"
+
+#include <EEPROM.h>
+
+// EEPROM layout: StoredConfig (~100 bytes) at 0, hostname cache at 128,
+// DHCP lease cache at 192, fault record at 256 (FaultDump.cpp),
+// calibration baselines at 384, counter ring at 512-1472
+// (CounterStore.cpp). The calibration cache originally sat at 256 too,
+// overlapping the fault record: a crash clobbered the baselines and a
+// recalibration corrupted a pending crash record. Moving it costs one
+// recalibration pass on the first boot after this change.
+#define CONFIG_STORE_ADDR 0
+#define CONFIG_STORE_MAGIC 0x4D4C4347 // "MLCG" - Missing Link ConfiG
+#define HOSTNAME_CACHE_ADDR 128
+#define HOSTNAME_CACHE_MAGIC 0x4D4C484E // "MLHN" - Missing Link HostName
+#define LEASE_CACHE_ADDR 192
+#define LEASE_CACHE_MAGIC 0x4D4C4C53 // "MLLS" - Missing Link LeaSe
+#define CALIB_CACHE_ADDR 384
+#define CALIB_CACHE_MAGIC 0x4D4C4342 // "MLCB" - Missing Link CaliBration
+
+// Fixed little-endian layout; crc covers every byte before it.
+struct __attribute__((packed)) StoredConfig {
+  uint32_t magic;
+  uint16_t layoutVersion;
+  int32_t frequencies[MAX_STATUES];
+  float thresholds[MAX_STATUES];
+  char names[MAX_STATUES][10];
+  uint8_t ringId; // Ring membership (v2); must survive cached boots so
+                  // the board subscribes under its own ring's topics
+  uint32_t crc;
+};
+
+static bool loadedFromStore = false;
+
+// Standard CRC32 (reflected, poly 0xEDB88320), bitwise - this runs once
+// per boot and once per config push, so table-free is fine.
+static uint32_t crc32(const uint8_t *data, size_t length) {
+  uint32_t crc = 0xFFFFFFFF;
+  for (size_t i = 0; i < length; i++) {
+    crc ^= data[i];
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+    }
+  }
+  return ~crc;
+}
+
+static void fillFromGlobals(StoredConfig &stored) {
+  memset(&stored, 0, sizeof(stored));
+  stored.magic = CONFIG_STORE_MAGIC;
+  stored.layoutVersion = CONFIG_STORE_LAYOUT_VERSION;
+  for (int i = 0; i < MAX_STATUES; i++) {
+    stored.frequencies[i] = STATUE_FREQUENCIES[i];
+    stored.thresholds[i] = STATUE_THRESHOLDS[i];
+    memcpy(stored.names[i], STATUE_NAMES[i], sizeof(stored.names[i]));
+  }
+  stored.ringId = (uint8_t)MY_RING_ID;
+  stored.crc = crc32((const uint8_t *)&stored,
+                     sizeof(stored) - sizeof(stored.crc));
+}
+
+FLASHMEM bool configStoreLoad() {
+  StoredConfig stored;
+  EEPROM.get(CONFIG_STORE_ADDR, stored);
+
+  if (stored.magic != CONFIG_STORE_MAGIC) {
+    Serial.println("ConfigStore: no cached config (first boot)");
+    return false;
+  }
+  if (stored.layoutVersion != CONFIG_STORE_LAYOUT_VERSION) {
+    Serial.printf("ConfigStore: layout v%u != v%u, ignoring cache\n",
+                  stored.layoutVersion, CONFIG_STORE_LAYOUT_VERSION);
+    return false;
+  }
+  if (stored.crc != crc32((const uint8_t *)&stored,
+                          sizeof(stored) - sizeof(stored.crc))) {
+    Serial.println("ConfigStore: CRC mismatch, ignoring cache");
+    return false;
+  }
+
+  for (int i = 0; i < MAX_STATUES; i++) {
+    STATUE_FREQUENCIES[i] = stored.frequencies[i];
+    STATUE_THRESHOLDS[i] = stored.thresholds[i];
+    memcpy(STATUE_NAMES[i], stored.names[i], sizeof(stored.names[i]));
+    STATUE_NAMES[i][9] = '\0';
+  }
+  if (stored.ringId >= 1) {
+    MY_RING_ID = stored.ringId;
+  }
+  loadedFromStore = true;
+  Serial.println("ConfigStore: loaded cached config from EEPROM");
+  return true;
+}
+
+FLASHMEM void configStoreSave() {
+  StoredConfig stored;
+  fillFromGlobals(stored);
+
+  // Read-compare before writing: config pushes usually change nothing,
+  // and the emulated EEPROM has a finite write budget.
+  StoredConfig current;
+  EEPROM.get(CONFIG_STORE_ADDR, current);
+  if (memcmp(&stored, &current, sizeof(stored)) == 0) {
+    return;
+  }
+  EEPROM.put(CONFIG_STORE_ADDR, stored);
+  Serial.println("ConfigStore: cached config written to EEPROM");
+}
+
+bool configLoadedFromStore() {
+  return loadedFromStore;
+}
+
+// Hostname cache: same magic+CRC discipline as StoredConfig, in its own
+// slot so a config layout bump doesn't invalidate the cached identity.
+struct __attribute__((packed)) StoredHostname {
+  uint32_t magic;
+  char name[HOSTNAME_CACHE_MAX];
+  uint32_t crc;
+};
+
+FLASHMEM bool hostnameCacheLoad(char *out, size_t outLen) {
+  StoredHostname stored;
+  EEPROM.get(HOSTNAME_CACHE_ADDR, stored);
+
+  if (stored.magic != HOSTNAME_CACHE_MAGIC) {
+    return false;
+  }
+  if (stored.crc != crc32((const uint8_t *)&stored,
+                          sizeof(stored) - sizeof(stored.crc))) {
+    Serial.println("ConfigStore: hostname cache CRC mismatch, ignoring");
+    return false;
+  }
+  stored.name[HOSTNAME_CACHE_MAX - 1] = '\0';
+  strlcpy(out, stored.name, outLen);
+  return out[0] != '\0';
+}
+
+// DHCP lease cache: raw octets rather than IPAddress so the layout is a
+// fixed 20 bytes regardless of the class internals.
+struct __attribute__((packed)) StoredLease {
+  uint32_t magic;
+  uint8_t ip[4];
+  uint8_t mask[4];
+  uint8_t gw[4];
+  uint8_t dns[4];
+  uint32_t crc;
+};
+
+FLASHMEM bool leaseCacheLoad(IPAddress &ip, IPAddress &mask, IPAddress &gw,
+                             IPAddress &dns) {
+  StoredLease stored;
+  EEPROM.get(LEASE_CACHE_ADDR, stored);
+
+  if (stored.magic != LEASE_CACHE_MAGIC) {
+    return false;
+  }
+  if (stored.crc != crc32((const uint8_t *)&stored,
+                          sizeof(stored) - sizeof(stored.crc))) {
+    Serial.println("ConfigStore: lease cache CRC mismatch, ignoring");
+    return false;
+  }
+  ip = IPAddress(stored.ip[0], stored.ip[1], stored.ip[2], stored.ip[3]);
+  mask = IPAddress(stored.mask[0], stored.mask[1], stored.mask[2],
+                   stored.mask[3]);
+  gw = IPAddress(stored.gw[0], stored.gw[1], stored.gw[2], stored.gw[3]);
+  dns = IPAddress(stored.dns[0], stored.dns[1], stored.dns[2], stored.dns[3]);
+  return ip != IPAddress((uint32_t)0);
+}
+
+FLASHMEM void leaseCacheSave(IPAddress ip, IPAddress mask, IPAddress gw,
+                             IPAddress dns) {
+  StoredLease stored;
+  memset(&stored, 0, sizeof(stored));
+  stored.magic = LEASE_CACHE_MAGIC;
+  for (int i = 0; i < 4; i++) {
+    stored.ip[i] = ip[i];
+    stored.mask[i] = mask[i];
+    stored.gw[i] = gw[i];
+    stored.dns[i] = dns[i];
+  }
+  stored.crc = crc32((const uint8_t *)&stored,
+                     sizeof(stored) - sizeof(stored.crc));
+
+  StoredLease current;
+  EEPROM.get(LEASE_CACHE_ADDR, current);
+  if (memcmp(&stored, &current, sizeof(stored)) == 0) {
+    return;
+  }
+  EEPROM.put(LEASE_CACHE_ADDR, stored);
+  Serial.print("ConfigStore: cached DHCP lease ");
+  Serial.println(ip);
+}
+
+FLASHMEM void hostnameCacheSave(const char *name) {
+  StoredHostname stored;
+  memset(&stored, 0, sizeof(stored));
+  stored.magic = HOSTNAME_CACHE_MAGIC;
+  strlcpy(stored.name, name, sizeof(stored.name));
+  stored.crc = crc32((const uint8_t *)&stored,
+                     sizeof(stored) - sizeof(stored.crc));
+
+  StoredHostname current;
+  EEPROM.get(HOSTNAME_CACHE_ADDR, current);
+  if (memcmp(&stored, &current, sizeof(stored)) == 0) {
+    return;
+  }
+  EEPROM.put(HOSTNAME_CACHE_ADDR, stored);
+  Serial.printf("ConfigStore: cached hostname '%s' to EEPROM\n", stored.name);
+}
+
+// Calibration cache: per-detector open-circuit baselines from the boot
+// calibration pass (AudioSense). Keyed to the statue index so a card
+// moved between statues recalibrates instead of inheriting the floors
+// measured at another pedestal.
+struct __attribute__((packed)) StoredCalib {
+  uint32_t magic;
+  uint8_t statueIndex;
+  uint8_t count;
+  float floors[MAX_STATUES - 1];
+  uint32_t crc;
+};
+
+FLASHMEM bool calibCacheLoad(float *floors, int count) {
+  StoredCalib stored;
+  EEPROM.get(CALIB_CACHE_ADDR, stored);
+
+  if (stored.magic != CALIB_CACHE_MAGIC) {
+    return false;
+  }
+  if (stored.crc != crc32((const uint8_t *)&stored,
+                          sizeof(stored) - sizeof(stored.crc))) {
+    Serial.println("ConfigStore: calibration cache CRC mismatch, ignoring");
+    return false;
+  }
+  if (stored.statueIndex != (uint8_t)MY_STATUE_INDEX ||
+      stored.count != (uint8_t)count) {
+    return false;
+  }
+  for (int i = 0; i < count; i++) {
+    floors[i] = stored.floors[i];
+  }
+  return true;
+}
+
+FLASHMEM void calibCacheSave(const float *floors, int count) {
+  if (count > MAX_STATUES - 1) {
+    count = MAX_STATUES - 1;
+  }
+  StoredCalib stored;
+  memset(&stored, 0, sizeof(stored));
+  stored.magic = CALIB_CACHE_MAGIC;
+  stored.statueIndex = (uint8_t)MY_STATUE_INDEX;
+  stored.count = (uint8_t)count;
+  for (int i = 0; i < count; i++) {
+    stored.floors[i] = floors[i];
+  }
+  stored.crc = crc32((const uint8_t *)&stored,
+                     sizeof(stored) - sizeof(stored.crc));
+
+  StoredCalib current;
+  EEPROM.get(CALIB_CACHE_ADDR, current);
+  if (memcmp(&stored, &current, sizeof(stored)) == 0) {
+    return;
+  }
+  EEPROM.put(CALIB_CACHE_ADDR, stored);
+  Serial.println("ConfigStore: cached calibration baselines to EEPROM");
+}
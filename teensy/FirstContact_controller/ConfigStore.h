@@ -0,0 +1,64 @@
+/*
+ConfigStore: Versioned binary config cache in EEPROM.
+
+Boot used to parse DEFAULT_CONFIG_JSON from PROGMEM twice - once in
+initStatueConfig() and again through loadDefaultConfig() -> parseConfig()
+- each pass allocating a heap buffer and a 2 KB JSON document just to
+recover the same five frequencies, names, and thresholds. The parsed
+result is now cached in the Teensy's emulated EEPROM as a fixed binary
+struct with a magic word, layout version, and CRC32. A valid cache loads
+directly into the StatueConfig globals with no parsing or allocation;
+JSON parsing only runs when the cache is absent or stale (first boot,
+layout change) or when the controller pushes new config over MQTT, and
+the result is written back so the next boot is parse-free again.
+
+The statue's own identity (index, transmit frequency) is still derived
+from the hostname at boot - it is a property of which board this is, not
+of the config table - so a cached card can move between statues.
+*/
+
+#ifndef CONFIG_STORE_H
+#define CONFIG_STORE_H
+
+#include <Arduino.h>
+
+// Bump when the StoredConfig layout changes; stale caches are ignored and
+// rewritten from the next JSON parse. v2 added the ring id.
+#define CONFIG_STORE_LAYOUT_VERSION 2
+
+// Load the cached config into the StatueConfig arrays. Returns false when
+// the cache is missing, the wrong layout, or fails its CRC.
+bool configStoreLoad();
+
+// Write the current StatueConfig arrays back to EEPROM. Skips the write
+// when the stored copy already matches (EEPROM wear).
+void configStoreSave();
+
+// True when this boot's config came from the EEPROM cache (so the JSON
+// default-config parse can be skipped entirely).
+bool configLoadedFromStore();
+
+// Last-known hostname from reverse DNS, cached in its own EEPROM slot so
+// boot can proceed with the cached identity while the live PTR lookup
+// confirms it in the background (see pollReverseDns in Networking.ino).
+#define HOSTNAME_CACHE_MAX 32
+bool hostnameCacheLoad(char *out, size_t outLen);
+void hostnameCacheSave(const char *name);
+
+// Last DHCP lease (IP, mask, gateway, DNS server), cached so boot can
+// bring the interface up on the previous assignment in milliseconds
+// instead of waiting out a fresh DHCP exchange. dnsmasq hands each statue
+// the same static assignment every time, so the cache is almost always
+// right; the supervisor falls back to real DHCP if it proves stale.
+bool leaseCacheLoad(IPAddress &ip, IPAddress &mask, IPAddress &gw,
+                    IPAddress &dns);
+void leaseCacheSave(IPAddress ip, IPAddress mask, IPAddress gw,
+                    IPAddress dns);
+
+// Open-circuit calibration baselines from the boot pass (one float per
+// detector slot, see AudioSense). Keyed to the statue index, so a card
+// moved between statues recalibrates instead of inheriting floors.
+bool calibCacheLoad(float *floors, int count);
+void calibCacheSave(const float *floors, int count);
+
+#endif // CONFIG_STORE_H
@@ -0,0 +1,153 @@
+/*
+CounterStore.cpp - RAM accumulation and the EEPROM ring commit.
+
+Ring layout: COUNTER_RING_SLOTS fixed-size records starting at
+COUNTER_RING_ADDR (after the regions listed in ConfigStore.cpp). A
+commit writes the next slot with seq+1 and the CRC last in the record,
+so a power cut mid-write leaves a bad CRC in one slot and the previous
+slot still restores. The commit itself is EEPROM.put from loop context
+(or the watchdog warning interrupt, which FaultDump already set the
+precedent for - the emulation functions do not sleep).
+*/
+
+#include "CounterStore.h"
+
+#include "Watchdog.h"
+
+#include <EEPROM.h>
+
+// After ConfigStore's regions and the fault record (see the layout
+// comment in ConfigStore.cpp). 24 slots x 40 bytes ends at 1472.
+#define COUNTER_RING_ADDR 512
+#define COUNTER_RING_SLOTS 24
+#define COUNTER_RING_MAGIC 0x4D4C4354 // "MLCT" - Missing Link CounTers
+
+// Dirty commits no more often than this; the watchdog warning and an
+// explicit counterStoreCommit() bypass the cadence, not the dirty check.
+#define COUNTER_COMMIT_INTERVAL_MS (10UL * 60UL * 1000UL)
+
+// Live state sampled from the sketch translation unit.
+extern unsigned long int contactCount;       // Display.ino
+extern volatile StatueMask latestLinkedMask; // AudioSense.ino
+
+struct __attribute__((packed)) StoredCounters {
+  uint32_t magic;
+  uint32_t seq;
+  uint32_t contacts;
+  uint32_t uptimeSec;
+  uint32_t linkSec[MAX_STATUES];
+  uint32_t crc;
+};
+
+// RAM accumulators; uptime/linkSec tick in counterStoreLoop, contacts
+// is read straight from the display counter at commit time.
+static uint32_t uptimeSec = 0;
+static uint32_t linkSec[MAX_STATUES];
+static uint32_t lastSeq = 0;
+static int lastSlot = -1; // Slot holding lastSeq; -1 = empty ring
+static StoredCounters lastCommitted;
+static unsigned long lastCommitMs = 0;
+
+// Standard CRC32 (reflected, poly 0xEDB88320), bitwise - 40 bytes a
+// few times an hour.
+static uint32_t crc32(const uint8_t *data, size_t length) {
+  uint32_t crc = 0xFFFFFFFF;
+  for (size_t i = 0; i < length; i++) {
+    crc ^= data[i];
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+    }
+  }
+  return ~crc;
+}
+
+static bool slotValid(const StoredCounters &rec) {
+  return rec.magic == COUNTER_RING_MAGIC &&
+         rec.crc == crc32((const uint8_t *)&rec,
+                          sizeof(rec) - sizeof(rec.crc));
+}
+
+// Boot-only: FLASHMEM (placement notes in MemMonitor.h).
+FLASHMEM void counterStoreSetup() {
+  // A hang about to trip the watchdog commits whatever accumulated.
+  watchdogSetWarningHandler(counterStoreCommit);
+
+  StoredCounters rec;
+  for (int i = 0; i < COUNTER_RING_SLOTS; i++) {
+    EEPROM.get(COUNTER_RING_ADDR + i * (int)sizeof(StoredCounters), rec);
+    if (slotValid(rec) && (lastSlot < 0 || (int32_t)(rec.seq - lastSeq) > 0)) {
+      lastSeq = rec.seq;
+      lastSlot = i;
+      lastCommitted = rec;
+    }
+  }
+  if (lastSlot < 0) {
+    memset(&lastCommitted, 0, sizeof(lastCommitted));
+    Serial.println("CounterStore: empty ring, counters start at zero");
+    return;
+  }
+
+  contactCount = lastCommitted.contacts;
+  uptimeSec = lastCommitted.uptimeSec;
+  for (int i = 0; i < MAX_STATUES; i++) {
+    linkSec[i] = lastCommitted.linkSec[i];
+  }
+  Serial.printf("CounterStore: restored seq %lu (contacts %lu, %lu h up)\n",
+                (unsigned long)lastSeq, (unsigned long)contactCount,
+                (unsigned long)(uptimeSec / 3600));
+}
+
+void counterStoreCommit() {
+  StoredCounters rec;
+  memset(&rec, 0, sizeof(rec));
+  rec.magic = COUNTER_RING_MAGIC;
+  rec.seq = lastSeq + 1;
+  rec.contacts = (uint32_t)contactCount;
+  rec.uptimeSec = uptimeSec;
+  for (int i = 0; i < MAX_STATUES; i++) {
+    rec.linkSec[i] = linkSec[i];
+  }
+
+  // Nothing moved since the last commit: skip the write (uptime ticks
+  // every second, so in practice this only catches back-to-back
+  // commits, e.g. a watchdog warning right after the cadence fired).
+  if (lastSlot >= 0 && rec.contacts == lastCommitted.contacts &&
+      rec.uptimeSec == lastCommitted.uptimeSec &&
+      memcmp(rec.linkSec, lastCommitted.linkSec, sizeof(rec.linkSec)) == 0) {
+    lastCommitMs = millis();
+    return;
+  }
+  rec.crc = crc32((const uint8_t *)&rec, sizeof(rec) - sizeof(rec.crc));
+
+  int slot = (lastSlot + 1) % COUNTER_RING_SLOTS;
+  EEPROM.put(COUNTER_RING_ADDR + slot * (int)sizeof(StoredCounters), rec);
+  lastSeq = rec.seq;
+  lastSlot = slot;
+  lastCommitted = rec;
+  lastCommitMs = millis();
+}
+
+void counterStoreLoop() {
+  // One tick per scheduled second. The task period is the timebase;
+  // scheduler jitter at 1000 ms is noise against a season of hours.
+  uptimeSec++;
+  StatueMask mask = latestLinkedMask;
+  for (int i = 0; i < MAX_STATUES; i++) {
+    if (i != MY_STATUE_INDEX && (mask & (1u << i)) != 0) {
+      linkSec[i]++;
+    }
+  }
+
+  if (millis() - lastCommitMs >= COUNTER_COMMIT_INTERVAL_MS) {
+    counterStoreCommit();
+  }
+}
+
+uint32_t counterStoreUptimeSec() { return uptimeSec; }
+
+uint32_t counterStoreLinkSec(int statueIndex) {
+  if (statueIndex < 0 || statueIndex >= MAX_STATUES) {
+    return 0;
+  }
+  return linkSec[statueIndex];
+}
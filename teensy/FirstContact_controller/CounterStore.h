@@ -0,0 +1,50 @@
+/*
+CounterStore: season-lifetime interaction counters in a wear-leveled
+EEPROM ring.
+
+The contact counter on the display used to start over at every power
+cycle (the WarmState snapshot only survives warm resets - OCRAM is
+gone after a power cut), and writing EEPROM per contact would burn
+through the emulation's write budget in weeks at show-floor contact
+rates. The counters now accumulate in RAM and commit to EEPROM on a
+slow cadence, and only when something changed: a handful of flash
+writes per hour against tens of contacts per minute.
+
+Commits rotate through a multi-slot ring, each record carrying a
+sequence number and CRC; boot restores the highest valid sequence, so
+a power cut mid-write costs one commit interval of counts, never the
+season total. (The Teensy 4 EEPROM emulation append-logs writes in
+flash underneath as well - the ring multiplies that budget rather
+than replacing it.) The watchdog's pre-reset warning interrupt forces
+a commit, so a hang loses seconds, not the cadence interval.
+
+Tracked: total contacts (the display counter), powered seconds, and
+linked seconds per peer statue.
+*/
+
+#ifndef COUNTER_STORE_H
+#define COUNTER_STORE_H
+
+#include "StatueConfig.h"
+
+#include <Arduino.h>
+
+// Restore the newest valid ring slot. Call before warmStateSetup() so
+// a warm snapshot (strictly newer) can overwrite the contact counter.
+void counterStoreSetup();
+
+// 1 Hz scheduler task: accumulate uptime/link seconds and commit the
+// ring slot when dirty and the cadence interval has elapsed.
+void counterStoreLoop();
+
+// Commit immediately if anything changed. Safe from the watchdog
+// warning interrupt; also the shutdown path for anything that knows
+// the power is about to go.
+void counterStoreCommit();
+
+// Season totals for telemetry: powered seconds and per-statue linked
+// seconds (indexed like STATUE_NAMES; our own slot stays zero).
+uint32_t counterStoreUptimeSec();
+uint32_t counterStoreLinkSec(int statueIndex);
+
+#endif // COUNTER_STORE_H
@@ -25,6 +25,16 @@ Display: Printing to the small OLED display on the teensy.
 
 extern Adafruit_SSD1306 display;
 
+// Rotating diagnostics pages. STATUS is the normal statue layout; the
+// others surface the perf counters without attaching a laptop.
+#define DISPLAY_PAGE_STATUS 0
+#define DISPLAY_PAGE_AUDIO 1
+#define DISPLAY_PAGE_NETWORK 2
+#define DISPLAY_PAGE_STORAGE 3
+#define DISPLAY_PAGE_TASKS 4
+#define DISPLAY_PAGE_MEMORY 5
+#define DISPLAY_PAGE_COUNT 6
+
 // Display function prototypes
 void displaySetup();
 void displaySplashScreen();
@@ -37,5 +47,8 @@ void displaySignals();
 void displayTimeCount();
 void displayState(ContactState state);
 void displayActivityStatus(bool isLinked);
+void displayLoop();
+void displaySetPage(int page);
+void displayNextPage();
 
 #endif // DISPLAY_H
@@ -2,18 +2,96 @@
 Display: Printing to the small OLED display on the teensy.
 */
 
+#include "AudioNodeStats.h"
 #include "Display.h"
+#include "EventBus.h"
+#include "Log.h"
+#include "MonoClock.h"
+#include "Networking.h"
+#include "SignalSnapshot.h"
 #include "StatueConfig.h"
+#include "MemMonitor.h"
+#include "StorageStats.h"
+#include "TaskScheduler.h"
 
 // External reference to detector thresholds array from AudioSense.ino
 extern float detectorThresholds[MAX_STATUES - 1];
 
-// External reference to detector signal strengths from AudioSense.ino
-extern float detectorSignals[MAX_STATUES - 1];
-
 // Create the OLED display object using Wire2 (as in original code).
 Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire2, OLED_RESET);
 
+// One display flush per tick, aligned with the 100 ms widget throttles.
+#define DISPLAY_FLUSH_PERIOD_MS 100
+
+// Character cells per status line: 128 px wide / 6 px per 5x7 glyph.
+#define DISPLAY_LINE_CELLS 21
+
+// Display bring-up is deferred until after audio sensing starts (see
+// setup() ordering in FirstContact_controller.ino); status text pushed at
+// the panel before then is buffered here and replayed once it is up.
+static bool displayReady = false;
+static char pendingStatus[64];
+
+// Active page (DISPLAY_PAGE_*). The status widgets only draw while their
+// page is up; the diagnostics pages render from the scheduler tick.
+static int currentPage = DISPLAY_PAGE_STATUS;
+
+// Per-row text caches for the diagnostics pages (rows y = 0, 8, ... 56).
+static char diagLast[8][DISPLAY_LINE_CELLS + 1];
+
+// Text last drawn on the THR and SIG status lines, for cell-level
+// diffing; file scope so a page switch can invalidate them.
+static char lastThrLine[DISPLAY_LINE_CELLS + 1];
+static char lastSigLine[DISPLAY_LINE_CELLS + 1];
+
+/*
+  displayLineDiff() - redraw only the character cells that changed.
+      - The SIG/THR lines reformat at up to 10 Hz but most digits are
+        stable frame to frame. Each widget keeps the text it last drew;
+        this compares the new string cell by cell and erases/redraws only
+        the differing 6x8 cells, so render cost (and the dirty window the
+        frame scheduler flushes) is proportional to what actually changed.
+*/
+static void displayLineDiff(int16_t y, const char *text,
+                            char last[DISPLAY_LINE_CELLS + 1]) {
+  display.setTextSize(1);
+  display.setTextColor(SSD1306_WHITE);
+  for (int i = 0; i < DISPLAY_LINE_CELLS; i++) {
+    char c = *text ? *text : ' ';
+    if (*text)
+      text++;
+    if (c == last[i]) {
+      continue;
+    }
+    int16_t x = i * 6;
+    display.fillRect(x, y, 6, 8, SSD1306_BLACK);
+    if (c != ' ') {
+      display.drawChar(x, y, c, SSD1306_WHITE, SSD1306_WHITE, 1);
+    }
+    last[i] = c;
+  }
+}
+
+/*
+  Shared offscreen strip for composing one 8-pixel status row. Widgets
+  that rewrite a whole line compose into this canvas (clear + text stays
+  out of the live buffer) and blit it in with display.drawCanvas1(),
+  which transposes the strip byte-at-a-time instead of going through
+  drawPixel. The panel-shadow diff in the driver then drops any rows
+  whose pixels did not actually change, so repainting every pass is
+  cheap.
+*/
+static GFXcanvas1 rowStrip(SCREEN_WIDTH, 8);
+
+// Reset the strip for a fresh row of size-1 white text.
+static void beginRowStrip() {
+  rowStrip.fillScreen(0);
+  rowStrip.setTextSize(1);
+  rowStrip.setTextColor(1);
+  rowStrip.setTextWrap(false); // A strip is one row; clip, don't wrap
+  rowStrip.setCursor(0, 0);
+}
+
 // Cumulative count of contacts.
 // NOTE: Briefly un-linking and re-contacting has different behavior under the
 // hood, though still counts as a new contact for this counter.
@@ -22,6 +100,9 @@ unsigned long int contactCount = 0;
 void displayTimeCount() {
   static bool isInitialized = false;
 
+  if (!displayReady || currentPage != DISPLAY_PAGE_STATUS)
+    return;
+
 #define STRING_BUFFER_LEN 128
   char str[STRING_BUFFER_LEN];
 
@@ -53,19 +134,14 @@ void displayTimeCount() {
 
   secondsLapse = millsLapse / 1000;
 
-  //display.clearDisplay();
-  display.fillRect(0, 54, 128, 10, SSD1306_BLACK);
-  //display.display();
-
-  display.setTextColor(SSD1306_WHITE); // Draw white text
-  display.setTextSize(1);
-  display.setCursor(0, 55);
   sprintf(str, "%07lu    %02lu:%02lu:%02lu", contactCount, secondsLapse / 3600,
           (secondsLapse % 3600) / 60, (secondsLapse % 3600) % 60);
 
-  display.printf(str);
-
-  display.display();
+  // Compose offscreen and blit; the driver's shadow diff skips the I2C
+  // when the formatted text comes out identical (most 100 ms passes).
+  beginRowStrip();
+  rowStrip.print(str);
+  display.drawCanvas1(0, 56, rowStrip);
 }
 
 /*
@@ -74,6 +150,9 @@ void displayTimeCount() {
       - It only publishes changes to state
 */
 void displayState(ContactState state) {
+  if (!displayReady || currentPage != DISPLAY_PAGE_STATUS) {
+    return;
+  }
   if (state.isUnchanged()) {
     return;
   }
@@ -102,21 +181,25 @@ void displayState(ContactState state) {
     }
   }
 
-  display.display();
 }
 
 void displayHostname(char *hostname) {
+  if (!displayReady || currentPage != DISPLAY_PAGE_STATUS) {
+    return;
+  }
   // Append hostname to the statue info on line 0
   display.setCursor(70, 0); // Position after statue name
   display.print(F(" "));
   display.print(hostname);
-  display.display();
 }
 
 void displayFrequencies(void) {
-  // Display RX frequencies on line 2 (y=10) in kHz
-  display.fillRect(0, 10, 128, 10, SSD1306_BLACK); // Clear line 2
-  display.setCursor(0, 10);
+  if (!displayReady || currentPage != DISPLAY_PAGE_STATUS) {
+    return;
+  }
+  // Display RX frequencies on line 2 (y=8, page-aligned) in kHz
+  display.fillRect(0, 8, 128, 8, SSD1306_BLACK); // Clear line 2
+  display.setCursor(0, 8);
   display.setTextSize(1);
   display.setTextColor(SSD1306_WHITE);
 
@@ -133,22 +216,17 @@ void displayFrequencies(void) {
     }
   }
 
-  display.display();
 }
 
 void displayThresholds(void) {
-  // Display detector thresholds on line 3 (y=20)
-  display.fillRect(0, 20, 128, 10, SSD1306_BLACK); // Clear line 3
-  display.setCursor(0, 20);
-  display.setTextSize(1);
-  display.setTextColor(SSD1306_WHITE);
-
-  // Show detector thresholds
-  display.print(F("THR:"));
-  for (int i = 0; i < NUM_STATUES - 1; i++) {
-    if (i > 0)
-      display.print(F("/"));
-
+  if (!displayReady || currentPage != DISPLAY_PAGE_STATUS) {
+    return;
+  }
+  // Format the thresholds line, then let displayLineDiff redraw only the
+  // cells that changed on line 3 (y=16, page-aligned).
+  char line[DISPLAY_LINE_CELLS + 8];
+  size_t pos = snprintf(line, sizeof(line), "THR:");
+  for (int i = 0; i < NUM_STATUES - 1 && pos < sizeof(line); i++) {
     // Determine precision dynamically: use 3 decimals if third decimal is non-zero
     int value_3dec = (int)(detectorThresholds[i] * 1000 + 0.5);
     int precision = (value_3dec % 10 != 0) ? 3 : 2;
@@ -156,28 +234,17 @@ void displayThresholds(void) {
 
     // Format as .XX or .XXX (no leading zero) to save space
     int value_int = (int)(detectorThresholds[i] * multiplier + 0.5); // Round to nearest
-    display.print(F("."));
-
-    // Print leading zeros based on precision
-    if (precision == 2) {
-      if (value_int < 10) {
-        display.print(F("0"));
-      }
-    } else { // 3 decimals
-      if (value_int < 100) {
-        display.print(F("0"));
-      }
-      if (value_int < 10) {
-        display.print(F("0"));
-      }
-    }
-    display.print(value_int);
+    pos += snprintf(line + pos, sizeof(line) - pos, "%s.%0*d",
+                    (i > 0) ? "/" : "", precision, value_int);
   }
 
-  display.display();
+  displayLineDiff(16, line, lastThrLine);
 }
 
 void displaySignals(void) {
+  if (!displayReady || currentPage != DISPLAY_PAGE_STATUS) {
+    return;
+  }
   // Throttle updates to ~100ms to avoid flicker
   static unsigned long lastUpdateMs = 0;
   unsigned long currentMs = millis();
@@ -186,146 +253,101 @@ void displaySignals(void) {
   }
   lastUpdateMs = currentMs;
 
-  // Display detector signal strengths on line 4 (y=30)
-  display.fillRect(0, 30, 128, 10, SSD1306_BLACK); // Clear line 4
-  display.setCursor(0, 30);
-  display.setTextSize(1);
-  display.setTextColor(SSD1306_WHITE);
-
-  // Show detector signals
-  display.print(F("SIG:"));
-  for (int i = 0; i < NUM_STATUES - 1; i++) {
-    if (i > 0)
-      display.print(F("/"));
-
-    // Determine precision dynamically based on threshold: use 3 decimals if third decimal is non-zero
-    int value_3dec = (int)(detectorThresholds[i] * 1000 + 0.5);
-    int precision = (value_3dec % 10 != 0) ? 3 : 2;
-    int multiplier = (precision == 2) ? 100 : 1000;
-
-    // Format as .XX or .XXX (no leading zero) to save space
-    int value_int = (int)(detectorSignals[i] * multiplier + 0.5); // Round to nearest
-    display.print(F("."));
-
-    // Print leading zeros based on precision
-    if (precision == 2) {
-      if (value_int < 10) {
-        display.print(F("0"));
-      }
-    } else { // 3 decimals
-      if (value_int < 100) {
-        display.print(F("0"));
-      }
-      if (value_int < 10) {
-        display.print(F("0"));
-      }
-    }
-    display.print(value_int);
+  // Copy one consistent snapshot rather than reading the live arrays.
+  SignalSnapshot snapshot;
+  readSignalSnapshot(snapshot);
+
+  // Format the signals line with the shared compact formatter, then let
+  // displayLineDiff redraw only the changed cells on line 4 (y=24,
+  // page-aligned).
+  char line[DISPLAY_LINE_CELLS + 8];
+  size_t pos = snprintf(line, sizeof(line), "SIG:");
+  for (int i = 0; i < NUM_STATUES - 1 && pos < sizeof(line); i++) {
+    char valueStr[8];
+    formatSignalCompact(valueStr, sizeof(valueStr), snapshot.signals[i],
+                        detectorThresholds[i]);
+    pos += snprintf(line + pos, sizeof(line) - pos, "%s%s",
+                    (i > 0) ? "/" : "", valueStr);
   }
 
-  display.display();
+  displayLineDiff(24, line, lastSigLine);
 }
 
 /*
- * displayActivityStatus() - display a wandering eye and show any acitivy
- */
+  displayActivityStatus() - idle "alive" indicator on hardware scroll.
+      - The old implementation redrew a bouncing 10x10 block up to 32
+        times a second, making the idle animation one of the largest I2C
+        consumers on the board. The SSD1306 can animate by itself: the
+        block is seeded into the band once, waits one flush for it to
+        reach the glass, and then the controller's horizontal scroll
+        walks it across (wrapping at the edge) with zero bus bytes per
+        frame. The MCU only talks to the panel again to stop the scroll
+        when a link forms or the page changes; stopScrollRegion() marks
+        the band dirty so the next flush repaints it from the buffer.
+      - The band is pages 5-6 (rows 40-55): the same area the LINK line
+        uses, and nothing else draws there while the statue is idle.
+*/
 void displayActivityStatus(bool isLinked) {
-  long unsigned mod;
-
-#define ACTIVITY_BAR_FRACTIONS 32
-
-  static bool isInitialized = false;
-
-  unsigned long int mills;
-  static unsigned long time;
-  static unsigned long deltaTime = 0;
-  static bool direction = true;
-
-  unsigned int Xposition;
-  static unsigned int Xposition_last = 0;
-
-  // Only display during idle time
-  if (isLinked) {
-    isInitialized = false;
+#define ACTIVITY_PAGE_FIRST 5
+#define ACTIVITY_PAGE_LAST 6
+// Datasheet interval code 7: step every 2 panel frames, a brisk crawl
+// in the same ballpark as the old 32-steps-per-second bounce.
+#define ACTIVITY_SCROLL_INTERVAL 7
+
+  static bool scrolling = false;
+  static bool seeded = false;
+
+  if (!displayReady || currentPage != DISPLAY_PAGE_STATUS || isLinked) {
+    if (scrolling) {
+      display.stopScrollRegion();
+      scrolling = false;
+    }
+    seeded = false;
     return;
   }
 
-  if (!isInitialized) {
-    time = millis();
-    isInitialized = true;
+  if (scrolling) {
+    return; // The panel is animating by itself
   }
 
-  mills = millis();
-
-  // Handle wrap-around
-  if (time > mills)
-    time = mills;
-
-  deltaTime = (mills - time) % 1000;
-
-  mod = deltaTime % (1000 / ACTIVITY_BAR_FRACTIONS);
-  if (mod != 0)
+  if (!seeded) {
+    // Seed the band: clear it and place the block at the left edge.
+    display.fillRect(0, ACTIVITY_PAGE_FIRST * 8, SCREEN_WIDTH, 16,
+                     SSD1306_BLACK);
+    display.fillRect(0, 40, 10, 10, SSD1306_WHITE);
+    seeded = true;
     return;
-
-  unsigned int x_unscaled;
-  unsigned int x_scaled;
-
-  x_unscaled = deltaTime / ACTIVITY_BAR_FRACTIONS;
-  x_scaled = x_unscaled * 128 / ACTIVITY_BAR_FRACTIONS;
-
-  if (direction) {
-    Xposition = x_scaled;
-  } else {
-    Xposition = 124 - x_scaled;
   }
 
-#ifdef ACTIVITY_DEBUG_ENABLE
-  printf("Direction:%s time:%u delta_t:%u x_unscaled:%u Xpos:%u\n",
-         direction ? "F" : "B", time, deltaTime, x_unscaled, Xposition);
-#endif
-  /*
-    Clear the  previous activity block
-  */
-  display.setTextColor(SSD1306_WHITE);
-
-  display.fillRect(Xposition_last, 40, 10, 10, SSD1306_BLACK);
-
-  /*
-    Draw a small box on the line position it based on the fraction of a second
-  */
-
-  display.fillRect(Xposition, 40, 10, 10, SSD1306_WHITE); // New Block
-  display.display();
-
-  /* Flip the direction */
-  if (x_unscaled == (ACTIVITY_BAR_FRACTIONS - 1)) {
-    direction = direction ? false : true;
-  }
-
-  Xposition_last = Xposition;
-
-#if 0
-  {
-    display.setTextSize(1);             // Normal 1:1 pixel scale
-    display.setCursor(0,55);
-    display.println(F(__DATE__ "  " __TIME__));
+  // Start the scroll only once the seed has reached the glass: the
+  // scroll shifts the panel's RAM, so anything still queued for the band
+  // would land in a moving frame.
+  if (!display.displayIdle()) {
+    return;
   }
-#endif
+  display.startScrollRegion(ACTIVITY_PAGE_FIRST, ACTIVITY_PAGE_LAST, false,
+                            ACTIVITY_SCROLL_INTERVAL);
+  scrolling = true;
 }
 
 void displayNetworkStatus(const char string[]) {
-  display.setTextColor(SSD1306_WHITE);
-  display.fillRect(0, 10, 128, 10, SSD1306_BLACK); // Erase line 2 only
-
-  display.setCursor(0, 10);
-  display.print(string);
+  if (!displayReady) {
+    // Keep the most recent status for replay from displaySetup().
+    snprintf(pendingStatus, sizeof(pendingStatus), "%s", string);
+    return;
+  }
+  if (currentPage != DISPLAY_PAGE_STATUS) {
+    return;
+  }
+  // Line 2 only; composed offscreen, blitted in one pass.
+  beginRowStrip();
+  rowStrip.print(string);
 
   // Add TX frequency after IP address on same line
-  display.print(F(" TX:"));
-  display.print(MY_TX_FREQ / 1000.0, 1);
-  display.print(F("k"));
-
-  display.display();
+  rowStrip.print(F(" TX:"));
+  rowStrip.print(MY_TX_FREQ / 1000.0, 1);
+  rowStrip.print(F("k"));
+  display.drawCanvas1(0, 8, rowStrip);
 }
 
 void displaySplashScreen(void) {
@@ -343,7 +365,9 @@ void displaySplashScreen(void) {
   display.println(F("STANDALONE MODE"));
 #else
   display.print(F("IP:"));
-  display.print(getLocalIp());
+  char ipBuf[16];
+  getLocalIp(ipBuf, sizeof(ipBuf));
+  display.print(ipBuf);
 #endif
 
   display.setTextSize(1);              // Normal 1:1 pixel scale
@@ -356,6 +380,9 @@ void displaySplashScreen(void) {
 }
 
 void displayUpdateStatueInfo(char *hostname) {
+  if (!displayReady || currentPage != DISPLAY_PAGE_STATUS) {
+    return;
+  }
   // Display compact format: "B: elektra TX:12k" on line 0
   display.fillRect(0, 0, 128, 10, SSD1306_BLACK); // Clear entire line 0
   display.setTextSize(1);
@@ -367,11 +394,314 @@ void displayUpdateStatueInfo(char *hostname) {
   display.print(F(" TX:"));
   display.print(MY_TX_FREQ / 1000.0, 1);
   display.print(F("k"));
-  display.display();
+}
+
+/*
+  renderDiagnosticsPage() - draw the active non-status page.
+      - Runs at the frame scheduler tick. Every line goes through
+        displayLineDiff, so a counter that did not move costs nothing and
+        page content repaints incrementally rather than via clearDisplay
+        plus a full redraw.
+*/
+static void renderDiagnosticsPage() {
+  char line[DISPLAY_LINE_CELLS + 8];
+
+  switch (currentPage) {
+  case DISPLAY_PAGE_AUDIO:
+    displayLineDiff(0, "AUDIO/DSP", diagLast[0]);
+    snprintf(line, sizeof(line), "CPU %.1f%% mx %.1f%%",
+             (double)AudioProcessorUsage(), (double)AudioProcessorUsageMax());
+    displayLineDiff(8, line, diagLast[1]);
+    snprintf(line, sizeof(line), "MEM %d mx %d", AudioMemoryUsage(),
+             AudioMemoryUsageMax());
+    displayLineDiff(16, line, diagLast[2]);
+    // The two heaviest graph nodes this window (AudioNodeStats.h), so
+    // "CPU is up" comes with a culprit attached.
+    audioNodeStatsBrief(line, sizeof(line));
+    displayLineDiff(24, line, diagLast[3]);
+    break;
+
+  case DISPLAY_PAGE_NETWORK: {
+    displayLineDiff(0, "NETWORK", diagLast[0]);
+    IPAddress ip = Ethernet.localIP();
+    snprintf(line, sizeof(line), "IP %u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+    displayLineDiff(8, line, diagLast[1]);
+    networkStatsBrief(line, sizeof(line));
+    displayLineDiff(16, line, diagLast[2]);
+    break;
+  }
+
+  case DISPLAY_PAGE_STORAGE:
+    displayLineDiff(0, "SD STORAGE", diagLast[0]);
+    storageStatsBrief(line, sizeof(line));
+    displayLineDiff(8, line, diagLast[1]);
+    break;
+
+  case DISPLAY_PAGE_TASKS: {
+    displayLineDiff(0, "TASKS p50/mx/ov us", diagLast[0]);
+    int rows = schedulerTaskCount();
+    if (rows > 7) {
+      rows = 7; // Header plus seven 8-px rows fill the panel.
+    }
+    for (int i = 0; i < rows; i++) {
+      if (schedulerTaskBrief(i, line, sizeof(line))) {
+        displayLineDiff(8 * (i + 1), line, diagLast[i + 1]);
+      }
+    }
+    break;
+  }
+
+  case DISPLAY_PAGE_MEMORY:
+    displayLineDiff(0, "MEMORY", diagLast[0]);
+    memHeapBrief(line, sizeof(line));
+    displayLineDiff(8, line, diagLast[1]);
+    memStackBrief(line, sizeof(line));
+    displayLineDiff(16, line, diagLast[2]);
+    break;
+
+  default:
+    break;
+  }
+}
+
+/*
+  displaySetPage() - switch the visible page.
+      - The buffer is cleared and every line cache invalidated; the
+        following scheduler ticks repaint the new page through the dirty
+        tracker and the chunked async transfer, so a switch never does a
+        synchronous full-frame push.
+*/
+void displaySetPage(int page) {
+  if (!displayReady) {
+    return;
+  }
+  if (page < 0 || page >= DISPLAY_PAGE_COUNT || page == currentPage) {
+    return;
+  }
+  currentPage = page;
+  display.clearDisplay();
+  memset(diagLast, 0, sizeof(diagLast));
+  memset(lastThrLine, 0, sizeof(lastThrLine));
+  memset(lastSigLine, 0, sizeof(lastSigLine));
+  if (currentPage == DISPLAY_PAGE_STATUS) {
+    // Repaint the furniture the per-loop widgets don't redraw themselves.
+    displayUpdateStatueInfo(getHostname());
+    displayFrequencies();
+    displayThresholds();
+  }
+  Serial.printf("Display: page %d\n", currentPage);
+}
+
+void displayNextPage() {
+  displaySetPage((currentPage + 1) % DISPLAY_PAGE_COUNT);
+}
+
+/*
+  I2C bus fault recovery. A static zap to the enclosure can wedge the
+  SSD1306 mid-transfer with SDA held low; from then on every
+  transmission burns the full Wire2 timeout and the loop cadence
+  collapses from milliseconds to tens of milliseconds per pass. The
+  driver now reports transmission status (lastWireStatus); a streak of
+  failures triggers the classic 9-clock recovery - clock SCL until the
+  panel releases the bit it is holding, then issue a STOP - followed by
+  a panel reinit and full repaint. If the bus stays dead after a few
+  rounds the display is disabled outright and the failure goes out on
+  missing_link/log: the OLED is cosmetic and must never tax the touch
+  path.
+*/
+// Wire2 pins on the Teensy 4.1.
+#define DISPLAY_SCL2_PIN 24
+#define DISPLAY_SDA2_PIN 25
+// Consecutive failed transmissions before recovery runs. The pump sends
+// one chunk per pass, so a genuinely wedged bus trips this well inside
+// a second; a single NACK blip never does.
+#define DISPLAY_FAULT_STREAK 8
+#define DISPLAY_RECOVERY_MAX 3
+// A clean minute after the last fault forgives past recovery rounds.
+#define DISPLAY_FAULT_FORGET_MS 60000
+
+static uint8_t wireErrorStreak = 0;
+static uint8_t recoveryRounds = 0;
+static unsigned long lastFaultMs = 0;
+
+// 9-clock bus recovery: with Wire2 parked, clock SCL (open-drain) until
+// the device stops holding SDA low, then a STOP edge so its bus state
+// machine is back at idle. Returns true when SDA reads released.
+static bool displayBusUnwedge() {
+  Wire2.end();
+  pinMode(DISPLAY_SDA2_PIN, INPUT_PULLUP);
+  pinMode(DISPLAY_SCL2_PIN, OUTPUT_OPENDRAIN);
+  digitalWriteFast(DISPLAY_SCL2_PIN, HIGH);
+  delayMicroseconds(5);
+  for (int i = 0; i < 9 && digitalReadFast(DISPLAY_SDA2_PIN) == LOW; i++) {
+    digitalWriteFast(DISPLAY_SCL2_PIN, LOW);
+    delayMicroseconds(5);
+    digitalWriteFast(DISPLAY_SCL2_PIN, HIGH);
+    delayMicroseconds(5);
+  }
+  bool released = digitalReadFast(DISPLAY_SDA2_PIN) == HIGH;
+  // STOP condition: SDA low-to-high while SCL is high.
+  pinMode(DISPLAY_SDA2_PIN, OUTPUT_OPENDRAIN);
+  digitalWriteFast(DISPLAY_SDA2_PIN, LOW);
+  delayMicroseconds(5);
+  digitalWriteFast(DISPLAY_SDA2_PIN, HIGH);
+  delayMicroseconds(5);
+  Wire2.begin();
+  return released;
+}
+
+// One recovery round: unwedge the wires, re-run the panel init
+// sequence, repaint from scratch (the panel's RAM and addressing state
+// are unknown after a fault). Gives up into display-disabled mode
+// after DISPLAY_RECOVERY_MAX failed rounds.
+static void displayRecover() {
+  display.displayAbort();
+  recoveryRounds++;
+  bool released = displayBusUnwedge();
+  bool ok = released &&
+            display.begin(SSD1306_SWITCHCAPVCC, SCREEN_ADDRESS, true, false) &&
+            display.lastWireStatus() == 0;
+  if (ok) {
+    display.clearDisplay();
+    display.invalidateShadow();
+    memset(diagLast, 0, sizeof(diagLast));
+    memset(lastThrLine, 0, sizeof(lastThrLine));
+    memset(lastSigLine, 0, sizeof(lastSigLine));
+    if (currentPage == DISPLAY_PAGE_STATUS) {
+      displayUpdateStatueInfo(getHostname());
+      displayFrequencies();
+      displayThresholds();
+    }
+    LOG_WARN("Display: I2C bus recovered (round %u)", recoveryRounds);
+    return;
+  }
+  if (recoveryRounds >= DISPLAY_RECOVERY_MAX) {
+    displayReady = false;
+    LOG_ERROR("Display: bus dead after %u recovery rounds; display off",
+              recoveryRounds);
+  } else {
+    LOG_WARN("Display: recovery round %u failed (SDA %s)", recoveryRounds,
+             released ? "released" : "held low");
+  }
+}
+
+// Error accounting, called once per displayLoop() pass: one failed
+// transmission is a blip, a streak is a wedged bus.
+static void displayFaultCheck() {
+  uint8_t status = display.lastWireStatus();
+  unsigned long now = millis();
+  if (status != 0) {
+    lastFaultMs = now;
+    if (++wireErrorStreak >= DISPLAY_FAULT_STREAK) {
+      wireErrorStreak = 0;
+      displayRecover();
+    }
+    return;
+  }
+  wireErrorStreak = 0;
+  if (recoveryRounds != 0 && now - lastFaultMs >= DISPLAY_FAULT_FORGET_MS) {
+    recoveryRounds = 0;
+  }
+}
+
+/*
+  displayLoop() - frame scheduler: the single flush point for the display.
+      - The widgets above only draw into the buffer; the driver tracks the
+        dirty window they touch. Once per DISPLAY_FLUSH_PERIOD_MS tick this
+        starts one async transfer covering everything drawn since the last
+        flush, collapsing what used to be several per-widget transfers per
+        loop iteration into at most one.
+      - Each call also sends at most one Wire-buffer-sized I2C chunk of the
+        in-flight transfer, so the display never costs the touch-sensing
+        path more than a fraction of a millisecond per loop pass.
+*/
+void displayLoop() {
+  static elapsedMillis sinceFlush = 0;
+
+  if (!displayReady) {
+    return;
+  }
+
+  display.displayPump();
+
+  if (sinceFlush >= DISPLAY_FLUSH_PERIOD_MS) {
+    if (currentPage != DISPLAY_PAGE_STATUS) {
+      renderDiagnosticsPage();
+    }
+    if (!display.displayBusy()) {
+      display.displayRegionAsync();
+      sinceFlush = 0;
+    }
+  }
+
+  displayFaultCheck();
+}
+
+/*
+  I2C speed profiles for the OLED, fastest first. The SSD1306 supports
+  1 MHz fast-mode-plus, which cuts a full-frame push from ~23 ms to
+  ~9 ms; whether a given panel/cable actually sustains it is checked by
+  timing a real full-frame transfer rather than assumed.
+*/
+struct DisplayBusProfile {
+  const char *name;
+  uint32_t hz;
+};
+static const DisplayBusProfile DISPLAY_BUS_PROFILES[] = {
+    {"fm+", 1000000UL},
+    {"fast", 400000UL},
+};
+
+/*
+  displaySelectBusProfile() - pick the fastest sustained I2C profile.
+      - Times a forced full-frame push at each profile and computes the
+        effective bus rate (9 bits on the wire per payload byte). A rate
+        below ~60% of the programmed clock is the signature of clock
+        stretching or a marginal bus - protocol overhead alone never
+        costs that much - so the profile is rejected and the next one
+        tried. The measured numbers are logged either way; they are the
+        hard data for any future OLED-to-SPI debate.
+*/
+static void displaySelectBusProfile() {
+  const size_t numProfiles =
+      sizeof(DISPLAY_BUS_PROFILES) / sizeof(DISPLAY_BUS_PROFILES[0]);
+  for (size_t i = 0; i < numProfiles; i++) {
+    const DisplayBusProfile &p = DISPLAY_BUS_PROFILES[i];
+    display.setBusClock(p.hz);
+    display.invalidateShadow();
+    display.display(); // Full frame, timed by the driver
+
+    uint32_t us = display.lastTransferMicros();
+    uint32_t bytes = display.lastTransferBytes();
+    if (us == 0 || bytes == 0) {
+      continue;
+    }
+    uint32_t effectiveHz = (uint32_t)((uint64_t)bytes * 9 * 1000000 / us);
+    Serial.printf("Display: profile %s: %lu B in %lu us, effective %lu kHz "
+                  "(bus %lu kHz)\n",
+                  p.name, (unsigned long)bytes, (unsigned long)us,
+                  (unsigned long)(effectiveHz / 1000),
+                  (unsigned long)(p.hz / 1000));
+    if (effectiveHz >= p.hz / 10 * 6 || i == numProfiles - 1) {
+      Serial.printf("Display: using I2C profile %s\n", p.name);
+      return;
+    }
+    Serial.printf("Display: profile %s not sustained, stepping down\n",
+                  p.name);
+  }
+}
+
+// EVENT_CONFIG_APPLIED subscriber: repaint the thresholds line after a
+// config/tune pass. Deferred delivery; displayThresholds() guards on
+// readiness and the active page itself.
+static void displayOnConfigApplied(const Event &event) {
+  (void)event;
+  displayThresholds();
 }
 
 void displaySetup() {
   Wire2.begin();
+  eventBusSubscribe(EVENT_CONFIG_APPLIED, displayOnConfigApplied);
 
   // SSD1306_SWITCHCAPVCC = generate display voltage from 3.3V internally
   if (!display.begin(SSD1306_SWITCHCAPVCC, SCREEN_ADDRESS)) {
@@ -379,6 +709,10 @@ void displaySetup() {
     //for(;;); // Don't proceed, loop forever
   }
 
+  // Settle on a bus speed before any real drawing; the trial pushes just
+  // repaint the splash buffer begin() leaves behind.
+  displaySelectBusProfile();
+
   // Show initial display buffer contents on the screen --
   // the library initializes this with an Adafruit splash screen.
   //display.display();
@@ -397,6 +731,12 @@ void displaySetup() {
 
   displaySplashScreen();
 
+  // The panel is live; replay any status buffered during early boot.
+  displayReady = true;
+  if (pendingStatus[0] != '\0') {
+    displayNetworkStatus(pendingStatus);
+  }
+
   // display.display() is NOT necessary after every single drawing command,
   // unless that's what you want...rather, you can batch up a bunch of
   // drawing operations and then update the screen all at once by calling
@@ -0,0 +1,95 @@
+/*
+DmaBuffer.cpp - the DMAMEM arena and the cache maintenance itself.
+
+Maintenance cheat sheet (the whole point of centralizing this):
+  CPU -> device: arm_dcache_flush_delete. The flush writes our dirty
+      lines to memory so the device reads what we wrote; the delete
+      drops the lines so our next read after the transfer refetches
+      instead of hitting stale cache. Flush alone is a latent bug for
+      device-write buffers, delete alone loses CPU writes.
+  device -> CPU: arm_dcache_delete. Invalidate only - any line we still
+      held would otherwise satisfy reads with pre-transfer data. There
+      must be nothing dirty to lose here; giveToDevice() guaranteed
+      that at handoff.
+Both run on whole cache lines, which the carve-out allocator's
+alignment and size rounding make safe by construction.
+*/
+
+#include "DmaBuffer.h"
+
+#include "Log.h"
+
+#define DMA_POISON_BYTE 0xA5
+
+// The dedicated arena. DMAMEM is not zeroed at startup; buffers hand
+// out whatever was there, like malloc.
+DMAMEM __attribute__((aligned(DMA_CACHE_LINE)))
+static uint8_t dmaPool[DMA_POOL_BYTES];
+
+static size_t poolCarved = 0;
+
+DmaBuffer DmaBuffer::allocate(size_t bytes) {
+  DmaBuffer b;
+  size_t rounded =
+      (bytes + DMA_CACHE_LINE - 1) & ~(size_t)(DMA_CACHE_LINE - 1);
+  if (rounded == 0 || poolCarved + rounded > DMA_POOL_BYTES) {
+    LOG_ERROR("DmaBuffer: pool spent (%u of %u carved, want %u)",
+              (unsigned)poolCarved, (unsigned)DMA_POOL_BYTES,
+              (unsigned)rounded);
+    return b;
+  }
+  b.buf = &dmaPool[poolCarved];
+  b.len = rounded;
+  poolCarved += rounded;
+  return b;
+}
+
+void DmaBuffer::giveToDevice(bool deviceWrites) {
+  if (buf == nullptr || own == DMA_OWNER_DEVICE) {
+    return;
+  }
+#if DMA_BUFFER_DEBUG
+  if (deviceWrites) {
+    // Anyone reading before takeFromDevice() sees the pattern, and the
+    // take side can tell a transfer that never happened.
+    memset(buf, DMA_POISON_BYTE, len);
+    poisoned = true;
+  }
+#else
+  (void)deviceWrites;
+#endif
+  arm_dcache_flush_delete(buf, len);
+  own = DMA_OWNER_DEVICE;
+}
+
+void DmaBuffer::takeFromDevice() {
+  if (buf == nullptr || own == DMA_OWNER_CPU) {
+    return;
+  }
+  arm_dcache_delete(buf, len);
+  own = DMA_OWNER_CPU;
+#if DMA_BUFFER_DEBUG
+  if (poisoned) {
+    poisoned = false;
+    size_t i = 0;
+    while (i < len && buf[i] == DMA_POISON_BYTE) {
+      i++;
+    }
+    if (i == len) {
+      LOG_WARN("DmaBuffer: device wrote nothing into a %u-byte buffer",
+               (unsigned)len);
+    }
+  }
+#endif
+}
+
+uint8_t *DmaBuffer::data() {
+#if DMA_BUFFER_DEBUG
+  if (own == DMA_OWNER_DEVICE) {
+    LOG_ERROR("DmaBuffer: CPU access while device-owned");
+  }
+#endif
+  return buf;
+}
+
+size_t dmaPoolUsed() { return poolCarved; }
@@ -0,0 +1,88 @@
+/*
+DmaBuffer: cache-coherent DMA buffer pool and ownership transfer.
+
+The M7's data cache makes every raw DMA path a coherency problem: the
+device reads through physical memory while the CPU reads and writes
+through cache lines, so a transfer needs 32-byte-aligned buffers and
+the right clean/invalidate at each handoff. Scattering ad hoc
+arm_dcache_* calls per feature is how heisenbugs get written, so every
+new raw-DMA path goes through this one audited layer instead: aligned
+carve-out allocation from a dedicated DMAMEM pool, and explicit
+ownership transfer that performs the correct maintenance per
+direction. (The current SD, Wire, and Ethernet paths ride libraries
+that do their own maintenance internally; this layer is for the DMA
+engines we drive ourselves.)
+
+Ownership protocol: a buffer starts CPU-owned. giveToDevice() writes
+back and drops its cache lines, then marks it device-owned; the CPU
+must not touch it until takeFromDevice(), which invalidates so reads
+see the device's bytes instead of stale cache. With DMA_BUFFER_DEBUG
+on, a buffer the device will write into is poisoned before the
+handoff - a CPU read that cheats the protocol sees the pattern, and
+takeFromDevice() warns if the device never overwrote it at all.
+
+Allocation is carve-only (no free), from setup/loop context: DMA
+buffers in this codebase live for the life of the boot, and a free
+list would just be fragmentation with extra steps. The pool's usage
+rides the memory telemetry via dmaPoolUsed().
+*/
+
+#ifndef DMA_BUFFER_H
+#define DMA_BUFFER_H
+
+#include <Arduino.h>
+
+// Debug builds only: poison device-write buffers at handoff and check
+// the protocol in data(). Costs a memset per transfer; never on in
+// production images.
+#define DMA_BUFFER_DEBUG false
+
+// Dedicated DMAMEM arena. Sized for headroom over nothing yet carved:
+// grow it alongside the first consumers, with the memmap report as the
+// budget check.
+#define DMA_POOL_BYTES (16u * 1024u)
+
+// M7 data cache line; alignment and size granularity for every buffer,
+// so maintenance on one buffer can never touch a neighbor's lines.
+#define DMA_CACHE_LINE 32u
+
+enum DmaOwner : uint8_t {
+  DMA_OWNER_CPU = 0,
+  DMA_OWNER_DEVICE,
+};
+
+class DmaBuffer {
+public:
+  // Carve `bytes` (rounded up to whole cache lines) from the pool.
+  // Returns an invalid buffer (valid() false) when the pool is spent.
+  // Loop/setup context only; not ISR-safe.
+  static DmaBuffer allocate(size_t bytes);
+
+  // CPU -> device. `deviceWrites` declares the transfer direction so
+  // the debug poisoning knows whether the contents still matter.
+  void giveToDevice(bool deviceWrites);
+
+  // Device -> CPU, after the transfer completes.
+  void takeFromDevice();
+
+  // CPU-side access; checked against the ownership protocol in debug
+  // builds (a device-owned buffer logs and returns the pointer anyway,
+  // because the caller is already wrong and a NULL would just move the
+  // crash).
+  uint8_t *data();
+
+  size_t size() const { return len; }
+  bool valid() const { return buf != nullptr; }
+  uint8_t owner() const { return own; }
+
+private:
+  uint8_t *buf = nullptr;
+  size_t len = 0;
+  uint8_t own = DMA_OWNER_CPU;
+  bool poisoned = false;
+};
+
+// Bytes carved from the pool so far, for the memory telemetry.
+size_t dmaPoolUsed();
+
+#endif // DMA_BUFFER_H
@@ -0,0 +1,39 @@
+/*
+DutyCycle: Optional duty-cycled tone transmission.
+
+Continuous TX at full amplitude is wasted output power and amplifier
+heat whenever nobody is touching the statues - which at 5 AM is all
+night. In duty-cycle mode every statue transmits only during a shared
+on-window each period and every detector integrates only inside that
+window (minus a guard for the raised-cosine TX ramps), so the duty
+drops to ~30% with no detection impact: detectors never integrate over
+silence.
+
+Windows are aligned across statues by the SNTP-disciplined shared
+clock (NetClock), not a beacon - phase is sharedClockMs() modulo the
+period, so statues agree to within the clock's millisecond accuracy.
+If the clock loses sync the statue falls back to continuous
+transmission; wrong-phase windows would read as broken links, and
+continuous TX is always detection-safe.
+
+The config rides in missing_link/config/response alongside tdm:
+  "duty": {"enabled": true, "period_ms": 100, "on_ms": 30}
+TDM takes precedence when both are enabled; its slot gating is already
+a duty cycle.
+*/
+
+#ifndef DUTY_CYCLE_H
+#define DUTY_CYCLE_H
+
+#include <Arduino.h>
+
+// Configure (or disable) duty cycling from a parsed config push.
+void dutyCycleConfigure(bool enabled, int periodMs, int onMs);
+
+// Advance the window state machine; called from the sense timer tick so
+// the gates switch with timer (not loop) jitter.
+void dutyCycleTick();
+
+bool isDutyCycleEnabled();
+
+#endif // DUTY_CYCLE_H
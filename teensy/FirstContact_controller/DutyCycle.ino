@@ -0,0 +1,98 @@
+/*
+DutyCycle: duty-cycled tone transmission state machine.
+*/
+
+#include "AudioSense.h"
+#include "DutyCycle.h"
+#include "NetClock.h"
+#include "StatueConfig.h"
+#include "TdmSchedule.h"
+
+// Guard on each side of the detector window so the raised-cosine TX
+// ramp (TONE_GATE_RAMP_MS, see AudioSense.ino) is fully settled while
+// detectors integrate. TX runs [0, on + 2*guard); detectors integrate
+// [guard, guard + on).
+#define DUTY_GUARD_MS 5
+
+static bool dutyEnabled = false;
+static int dutyPeriodMs = 100;
+static int dutyOnMs = 30;
+
+// Current gate states, to apply changes only on edges.
+static bool dutyTxOn = true;
+static bool dutyDetOpen = true;
+static bool dutyFallback = false; // Continuous because the clock unsynced
+
+// Open the TX gate and every detector gate (continuous operation).
+static void dutyReopenAll() {
+  setToneGate(true);
+  for (int i = 0; i < NUM_STATUES - 1; i++) {
+    setDetectorGate(i, false);
+  }
+  dutyTxOn = true;
+  dutyDetOpen = true;
+}
+
+bool isDutyCycleEnabled() { return dutyEnabled; }
+
+void dutyCycleConfigure(bool enabled, int periodMs, int onMs) {
+  bool wasEnabled = dutyEnabled;
+
+  if (periodMs > 0) {
+    dutyPeriodMs = periodMs;
+  }
+  if (onMs > 0) {
+    dutyOnMs = onMs;
+  }
+  // The window plus both guards must fit the period with some off time
+  // left, or the cycle degenerates to continuous anyway.
+  if (dutyOnMs + 2 * DUTY_GUARD_MS >= dutyPeriodMs) {
+    Serial.printf("Duty: on %d + guards do not fit period %d; disabled\n",
+                  dutyOnMs, dutyPeriodMs);
+    enabled = false;
+  }
+  dutyEnabled = enabled;
+
+  if (enabled && !wasEnabled) {
+    dutyFallback = false;
+    Serial.printf("Duty cycle enabled: %d ms on / %d ms period (%d%%)\n",
+                  dutyOnMs, dutyPeriodMs,
+                  (dutyOnMs + 2 * DUTY_GUARD_MS) * 100 / dutyPeriodMs);
+  } else if (!enabled && wasEnabled) {
+    dutyReopenAll();
+    Serial.println("Duty cycle disabled: continuous transmission restored");
+  }
+}
+
+void dutyCycleTick() {
+  if (!dutyEnabled || isTdmEnabled()) {
+    return;
+  }
+
+  // Clock-sync fallback: without the shared clock the statues cannot
+  // agree on window phase, and a wrong-phase window reads as a broken
+  // link. Continuous TX is always detection-safe.
+  if (!netClockSynced()) {
+    if (!dutyFallback) {
+      dutyReopenAll();
+      dutyFallback = true;
+    }
+    return;
+  }
+  dutyFallback = false;
+
+  int phase = (int)(sharedClockMs() % (uint64_t)dutyPeriodMs);
+  bool txOn = phase < dutyOnMs + 2 * DUTY_GUARD_MS;
+  bool detOpen = phase >= DUTY_GUARD_MS && phase < DUTY_GUARD_MS + dutyOnMs;
+
+  if (txOn != dutyTxOn) {
+    dutyTxOn = txOn;
+    setToneGate(txOn);
+  }
+  if (detOpen != dutyDetOpen) {
+    dutyDetOpen = detOpen;
+    for (int i = 0; i < NUM_STATUES - 1; i++) {
+      setDetectorGate(i, !detOpen);
+    }
+  }
+}
@@ -0,0 +1,76 @@
+/*
+EmergencyLoop.cpp - Compile-time synthesized degraded-mode drone.
+
+Two low partials a fifth apart (110 / 165 Hz, well below the 5-20 kHz
+sensing band) under a slow one-cycle-per-loop amplitude swell so the
+drone breathes instead of sitting static. The table is one second at
+44.1 kHz (~86 KB of flash); every partial and the swell complete a whole
+number of cycles over the table, so the loop point is seamless.
+*/
+
+#include "EmergencyLoop.h"
+#include "GoertzelTables.h"
+
+// One second at 44.1 kHz: 110 Hz and 165 Hz land on exact cycle counts.
+#define LOOP_SAMPLE_COUNT 44100
+
+namespace {
+
+struct LoopTable {
+  int16_t v[LOOP_SAMPLE_COUNT];
+};
+
+constexpr LoopTable makeLoopTable() {
+  LoopTable t{};
+  const double inc1 = 2.0 * goertzel_ct::kPi * 110.0 / 44100.0;
+  const double inc2 = 2.0 * goertzel_ct::kPi * 165.0 / 44100.0;
+  const double incSwell = 2.0 * goertzel_ct::kPi / LOOP_SAMPLE_COUNT;
+  double phase1 = 0.0;
+  double phase2 = 0.0;
+  double phaseSwell = 0.0;
+  for (int i = 0; i < LOOP_SAMPLE_COUNT; i++) {
+    // Quiet by design: this is presence, not a performance.
+    double swell = 0.75 + 0.25 * goertzel_ct::sinTaylor(phaseSwell);
+    double s = swell * (0.60 * goertzel_ct::sinTaylor(phase1) +
+                        0.35 * goertzel_ct::sinTaylor(phase2)) *
+               0.25;
+    t.v[i] = (int16_t)(s * 32767.0);
+    phase1 = goertzel_ct::wrap(phase1 + inc1);
+    phase2 = goertzel_ct::wrap(phase2 + inc2);
+    phaseSwell = goertzel_ct::wrap(phaseSwell + incSwell);
+  }
+  return t;
+}
+
+const LoopTable LOOP_TABLE PROGMEM = makeLoopTable();
+
+} // namespace
+
+void AudioPlayEmergencyLoop::start() {
+  __disable_irq();
+  pos = 0;
+  playing = true;
+  __enable_irq();
+}
+
+void AudioPlayEmergencyLoop::stop() { playing = false; }
+
+void AudioPlayEmergencyLoop::update(void) {
+  if (!playing) {
+    return;
+  }
+  audio_block_t *block = allocate();
+  if (!block) {
+    return;
+  }
+  uint32_t p = pos;
+  for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+    block->data[i] = LOOP_TABLE.v[p];
+    if (++p >= LOOP_SAMPLE_COUNT) {
+      p = 0;
+    }
+  }
+  pos = p;
+  transmit(block);
+  release(block);
+}
@@ -0,0 +1,41 @@
+/*
+EmergencyLoop: Looping flash-resident drone for SD-less degraded mode.
+
+When the SD card will not mount (vibration-loosened, corroded, died
+mid-event) the statue still senses, networks, and lights, but has no
+dormant audio at all - it reads as dead to visitors. This player holds a
+short seamless ambient loop in program flash - synthesized at compile
+time like the link chime, no asset file, no SD involvement - and plays
+it into the music mixer until the mount supervisor gets the card back.
+
+Modeled on AudioPlayChime (ChimePlayer.h), plus looping: the table holds
+a whole number of cycles of every partial, so the wrap is click-free.
+*/
+
+#ifndef EMERGENCY_LOOP_H
+#define EMERGENCY_LOOP_H
+
+#include <Arduino.h>
+#include <Audio.h>
+
+class AudioPlayEmergencyLoop : public AudioStream {
+public:
+  AudioPlayEmergencyLoop() : AudioStream(0, NULL) {
+    pos = 0;
+    playing = false;
+  }
+
+  // Start the loop from the top / stop it. Safe to call from loop();
+  // the audio update picks the flag up on its next pass.
+  void start();
+  void stop();
+  bool isPlaying() { return playing; }
+
+  virtual void update(void);
+
+private:
+  volatile uint32_t pos;
+  volatile bool playing;
+};
+
+#endif // EMERGENCY_LOOP_H
@@ -0,0 +1,89 @@
+/*
+EventBus implementation. See EventBus.h for the module rationale.
+
+The queue holds one copy per published event regardless of subscriber
+count; eventBusDrain() fans each copy out to the deferred subscribers.
+Publish can run from ISR context, so the ring indexes are updated under
+a short interrupt mask; drain copies the event out before delivering so
+handlers run with interrupts enabled.
+*/
+
+#include "EventBus.h"
+
+#define EVENT_BUS_MAX_SUBS 8 // Per delivery mode, across all types
+#define EVENT_BUS_QUEUE_LEN 16
+
+struct Subscriber {
+  uint8_t type;
+  EventHandler fn;
+};
+
+static Subscriber deferredSubs[EVENT_BUS_MAX_SUBS];
+static int numDeferred = 0;
+static Subscriber immediateSubs[EVENT_BUS_MAX_SUBS];
+static int numImmediate = 0;
+
+static Event pending[EVENT_BUS_QUEUE_LEN];
+static volatile uint8_t pendingHead = 0; // Next slot to write
+static volatile uint8_t pendingTail = 0; // Next slot to read
+static volatile uint32_t pendingDropped = 0;
+
+static bool addSubscriber(Subscriber *table, int *count, EventType type,
+                          EventHandler fn) {
+  if (*count >= EVENT_BUS_MAX_SUBS || fn == NULL) {
+    return false;
+  }
+  table[*count].type = type;
+  table[*count].fn = fn;
+  (*count)++;
+  return true;
+}
+
+bool eventBusSubscribe(EventType type, EventHandler fn) {
+  return addSubscriber(deferredSubs, &numDeferred, type, fn);
+}
+
+bool eventBusSubscribeImmediate(EventType type, EventHandler fn) {
+  return addSubscriber(immediateSubs, &numImmediate, type, fn);
+}
+
+void eventBusPublish(const Event &event) {
+  for (int i = 0; i < numImmediate; i++) {
+    if (immediateSubs[i].type == event.type) {
+      immediateSubs[i].fn(event);
+    }
+  }
+
+  noInterrupts();
+  uint8_t next = (uint8_t)((pendingHead + 1) % EVENT_BUS_QUEUE_LEN);
+  if (next == pendingTail) {
+    // Full; dropping the new event keeps the queued history intact.
+    pendingDropped++;
+    interrupts();
+    return;
+  }
+  pending[pendingHead] = event;
+  pendingHead = next;
+  interrupts();
+}
+
+void eventBusDrain() {
+  for (;;) {
+    noInterrupts();
+    if (pendingTail == pendingHead) {
+      interrupts();
+      return;
+    }
+    Event event = pending[pendingTail];
+    pendingTail = (uint8_t)((pendingTail + 1) % EVENT_BUS_QUEUE_LEN);
+    interrupts();
+
+    for (int i = 0; i < numDeferred; i++) {
+      if (deferredSubs[i].type == event.type) {
+        deferredSubs[i].fn(event);
+      }
+    }
+  }
+}
+
+uint32_t eventBusDropped() { return pendingDropped; }
@@ -0,0 +1,66 @@
+/*
+EventBus: lightweight publish/subscribe between firmware modules.
+
+Module coupling used to be extern globals and direct cross-calls: the
+sense task called every consumer in turn, and StatueConfig reached into
+the display to repaint thresholds. Each new consumer added another
+touch point on the hot path. Producers now fire one event - link
+change, config applied - and consumers register for it at their own
+delivery mode: immediate subscribers run inside eventBusPublish() in
+the producer's context, deferred ones run from the events scheduler
+task, which is what moves consumer work off the sense cadence.
+
+Subscriber tables and the pending queue are fixed-size arrays - no
+heap, no iteration cost beyond the registered handlers. Callbacks are
+plain function pointers, the same convention as TaskScheduler's TaskFn.
+*/
+
+#ifndef EVENT_BUS_H
+#define EVENT_BUS_H
+
+#include <Arduino.h>
+
+#include "StatueConfig.h"
+
+// Event types carried on the bus.
+enum EventType : uint8_t {
+  EVENT_LINK_CHANGE,    // Stable link mask changed (payload: link)
+  EVENT_CONFIG_APPLIED, // Detector thresholds/ratios re-applied
+  EVENT_TYPE_COUNT
+};
+
+// One event. The payload union keeps delivery copy-by-value cheap; a
+// queued event is self-contained, so consumers never chase state that
+// may have moved on by the time they run.
+struct Event {
+  uint8_t type; // EventType
+  union {
+    struct {
+      uint8_t mask;                 // Link bitmask after the change
+      uint8_t changed;              // Bits that flipped
+      uint8_t quality[MAX_STATUES]; // Contact quality at the change
+    } link;
+  } u;
+};
+
+typedef void (*EventHandler)(const Event &event);
+
+// Register `fn` for `type`. Deferred subscribers run from the events
+// scheduler task (eventBusDrain). Returns false when the table is full.
+bool eventBusSubscribe(EventType type, EventHandler fn);
+
+// As above, but `fn` runs inside eventBusPublish() in the producer's
+// context - possibly an ISR - and must be correspondingly cheap.
+bool eventBusSubscribeImmediate(EventType type, EventHandler fn);
+
+// Fire an event: immediate subscribers now, one queued copy for the
+// deferred ones. Safe from ISR context (queue indexes are guarded).
+void eventBusPublish(const Event &event);
+
+// Scheduler task: deliver queued events to deferred subscribers.
+void eventBusDrain();
+
+// Events dropped on a full queue since boot, for diagnostics.
+uint32_t eventBusDropped();
+
+#endif // EVENT_BUS_H
@@ -0,0 +1,171 @@
+/*
+EventJournal.cpp - the ring, the append-only file, and the tail reader.
+
+Unlike the flight recorder's ring this one has a single thread on both
+ends: journalOnLinkChange() runs from the events task and journalLoop()
+from its own task, both in loop context, so plain indices are enough.
+The batching still matters - each flush is one multi-sector SDIO burst
+instead of a 20-byte write per handshake.
+*/
+
+#include "EventJournal.h"
+
+#include <SD.h>
+
+#include "Log.h"
+#include "MusicPlayer.h"
+#include "NetClock.h"
+#include "SdArbiter.h"
+
+#define JOURNAL_FILE "EVENTS.BIN"
+// ~204 records per 4 KB burst.
+#define JOURNAL_BATCH_RECORDS (4096 / sizeof(JournalRecord))
+#define JOURNAL_RING_SIZE 256
+// Flush a partial batch once its oldest record has waited this long.
+#define JOURNAL_FLUSH_LATENCY_MS 60000
+
+static JournalRecord ring[JOURNAL_RING_SIZE];
+static uint16_t ringHead = 0;
+static uint16_t ringTail = 0;
+static uint32_t ringDropped = 0;
+static unsigned long oldestPendingMs = 0;
+
+static File journalFile;
+static bool journalOpen = false;
+static uint32_t nextSeq = 0;
+static uint32_t bootLinks = 0;
+static uint32_t bootUnlinks = 0;
+
+static void appendEvent(uint8_t type, uint8_t statue, uint8_t mask,
+                        uint8_t quality) {
+  uint16_t next = (uint16_t)((ringHead + 1) % JOURNAL_RING_SIZE);
+  if (next == ringTail) {
+    ringDropped++;
+    return;
+  }
+  JournalRecord &rec = ring[ringHead];
+  rec.seq = nextSeq++;
+  rec.epochMs = sharedClockMs();
+  rec.uptimeMs = millis();
+  rec.type = type;
+  rec.statue = statue;
+  rec.mask = mask;
+  rec.quality = quality;
+  if (ringHead == ringTail) {
+    oldestPendingMs = millis();
+  }
+  ringHead = next;
+}
+
+void journalOnLinkChange(const Event &event) {
+  for (int statue_idx = 0; statue_idx < NUM_STATUES; statue_idx++) {
+    if (!(event.u.link.changed & (1 << statue_idx))) {
+      continue;
+    }
+    bool linked = (event.u.link.mask & (1 << statue_idx)) != 0;
+    appendEvent(linked ? JOURNAL_EVENT_LINK : JOURNAL_EVENT_UNLINK,
+                statue_idx, event.u.link.mask,
+                event.u.link.quality[statue_idx]);
+    if (linked) {
+      bootLinks++;
+    } else {
+      bootUnlinks++;
+    }
+  }
+}
+
+static uint16_t pendingCount() {
+  return (uint16_t)((ringHead + JOURNAL_RING_SIZE - ringTail) %
+                    JOURNAL_RING_SIZE);
+}
+
+// Append everything pending as one burst.
+static void flushPending() {
+  static JournalRecord batch[JOURNAL_BATCH_RECORDS];
+  while (ringTail != ringHead) {
+    uint16_t count = 0;
+    while (count < JOURNAL_BATCH_RECORDS && ringTail != ringHead) {
+      batch[count++] = ring[ringTail];
+      ringTail = (uint16_t)((ringTail + 1) % JOURNAL_RING_SIZE);
+    }
+    journalFile.write((const uint8_t *)batch, count * sizeof(JournalRecord));
+  }
+  journalFile.flush();
+}
+
+void journalLoop() {
+  if (!journalOpen) {
+    if (!musicReady()) {
+      return;
+    }
+    // Plain append-only open, deliberately not preallocated like the
+    // flight recorder's file: the record count (and with it sequence
+    // continuity across boots) rides on the file size, which a
+    // preallocation would falsify. The journal grows ~32 bytes per
+    // visitor interaction; seek cost never matters here.
+    journalFile = SD.open(JOURNAL_FILE, FILE_WRITE);
+    if (!journalFile) {
+      return; // Retried next pass; the ring keeps buffering meanwhile
+    }
+    journalFile.seek(journalFile.size());
+    // Sequence numbers continue across boots from the file's record
+    // count, so gaps in a pulled history mean dropped records, not
+    // restarts.
+    uint32_t onDisk = journalFile.size() / sizeof(JournalRecord);
+    if (onDisk > nextSeq) {
+      // Renumber anything journaled before the card mounted.
+      for (uint16_t i = ringTail; i != ringHead;
+           i = (uint16_t)((i + 1) % JOURNAL_RING_SIZE)) {
+        ring[i].seq += onDisk;
+      }
+      nextSeq += onDisk;
+    }
+    journalOpen = true;
+    LOG_INFO("journal: %lu events on card", (unsigned long)onDisk);
+  }
+
+  uint16_t pending = pendingCount();
+  if (pending == 0) {
+    return;
+  }
+  if (pending >= JOURNAL_BATCH_RECORDS ||
+      millis() - oldestPendingMs >= JOURNAL_FLUSH_LATENCY_MS) {
+    // Card access goes through the arbiter (SdArbiter.h); a denied pass
+    // just leaves the batch in the ring for the next one.
+    if (sdIoBegin(SD_IO_JOURNAL)) {
+      flushPending();
+      sdIoEnd(SD_IO_JOURNAL);
+    }
+  }
+}
+
+uint32_t journalNextSeq() { return nextSeq; }
+uint32_t journalBootLinks() { return bootLinks; }
+uint32_t journalBootUnlinks() { return bootUnlinks; }
+
+int journalReadTail(JournalRecord *out, int maxCount) {
+  if (!journalOpen) {
+    return 0;
+  }
+  flushPending(); // Make the file authoritative before reading it back
+
+  uint32_t total = journalFile.size() / sizeof(JournalRecord);
+  uint32_t count = (uint32_t)maxCount < total ? (uint32_t)maxCount : total;
+  if (count == 0) {
+    return 0;
+  }
+
+  File reader = SD.open(JOURNAL_FILE);
+  if (!reader) {
+    return 0;
+  }
+  reader.seek((total - count) * sizeof(JournalRecord));
+  int got = 0;
+  while (got < (int)count &&
+         reader.read(&out[got], sizeof(JournalRecord)) ==
+             sizeof(JournalRecord)) {
+    got++;
+  }
+  reader.close();
+  return got;
+}
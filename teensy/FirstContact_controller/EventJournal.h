@@ -0,0 +1,62 @@
+/*
+EventJournal: persistent link/unlink log for interaction analytics.
+
+contactCount on the OLED was the only record of visitor interaction, and
+it died at power-off (grant reporting meant photographing the display).
+The journal appends every link and unlink - sequence number, shared
+wall-clock time, statue, mask, and contact quality - to a RAM ring, and
+a scheduler task flushes whole batches to an append-only file on the SD
+card, so counts survive power cycles and the Pi can pull event history
+over MQTT (missing_link/journal) instead of someone climbing up with a
+camera.
+
+Events are rare compared to the 4 KB batch size, so a partial batch is
+also flushed once its oldest record has waited a minute - the journal
+loses at most the last minute of events on a hard power cut.
+*/
+
+#ifndef EVENT_JOURNAL_H
+#define EVENT_JOURNAL_H
+
+#include <Arduino.h>
+
+#include "AudioSense.h"
+#include "EventBus.h"
+
+#define JOURNAL_EVENT_UNLINK 0
+#define JOURNAL_EVENT_LINK 1
+
+// One record per link or unlink edge. epochMs is the SNTP-disciplined
+// shared clock (0 when a statue booted without the Pi), uptimeMs the
+// local millis() for ordering within a boot either way.
+struct __attribute__((packed)) JournalRecord {
+  uint32_t seq;
+  uint64_t epochMs;
+  uint32_t uptimeMs;
+  uint8_t type;    // JOURNAL_EVENT_*
+  uint8_t statue;  // Statue index of the far end
+  uint8_t mask;    // Link mask after the edge
+  uint8_t quality; // Contact quality (0-100) at the edge
+};
+
+// EVENT_LINK_CHANGE subscriber: records one record per flipped bit in
+// the event's change mask. Registered on the bus at setup; runs from
+// the events task, off the sense path.
+void journalOnLinkChange(const Event &event);
+
+// Scheduler task: open the journal file once the card is mounted and
+// flush batched records.
+void journalLoop();
+
+// Lifetime totals for the stats reply: next sequence number (== events
+// ever journaled, file included) and this boot's link/unlink counts.
+uint32_t journalNextSeq();
+uint32_t journalBootLinks();
+uint32_t journalBootUnlinks();
+
+// Copy the most recent `maxCount` records (pending ones flushed first)
+// into `out`, oldest first. Returns the number copied; 0 before the SD
+// card is mounted.
+int journalReadTail(JournalRecord *out, int maxCount);
+
+#endif // EVENT_JOURNAL_H
@@ -0,0 +1,113 @@
+/*
+FadeRamp.cpp - Audio-rate gain ramp implementation.
+*/
+
+#include "FadeRamp.h"
+#include "GoertzelTables.h"
+
+// Precomputed equal-power fade curve: FADE_CURVE[i] = sin(pi/2 * i/N).
+// Built at compile time with the same constexpr trig as the Goertzel
+// coefficient table, so there is no runtime table generation.
+#define FADE_CURVE_STEPS 256
+
+namespace {
+
+struct FadeCurve {
+  float v[FADE_CURVE_STEPS + 1];
+};
+
+constexpr FadeCurve makeFadeCurve() {
+  FadeCurve curve{};
+  for (int i = 0; i <= FADE_CURVE_STEPS; i++) {
+    curve.v[i] = (float)goertzel_ct::sinTaylor(goertzel_ct::kPi / 2.0 *
+                                               (double)i / FADE_CURVE_STEPS);
+  }
+  return curve;
+}
+
+// Raised-cosine curve: RC_CURVE[i] = (1 - cos(pi * i/N)) / 2. Continuous
+// in value and slope at both ends, so gating a pure tone through it puts
+// essentially no energy outside the tone's own bin.
+constexpr FadeCurve makeRaisedCosineCurve() {
+  FadeCurve curve{};
+  for (int i = 0; i <= FADE_CURVE_STEPS; i++) {
+    curve.v[i] = (float)((1.0 - goertzel_ct::cosTaylor(
+                                    goertzel_ct::kPi * (double)i /
+                                    FADE_CURVE_STEPS)) /
+                         2.0);
+  }
+  return curve;
+}
+
+constexpr FadeCurve FADE_CURVE PROGMEM = makeFadeCurve();
+constexpr FadeCurve RC_CURVE PROGMEM = makeRaisedCosineCurve();
+
+} // namespace
+
+void AudioEffectFadeRamp::setGain(float gain) {
+  __disable_irq();
+  currentGain = gain;
+  startGain = gain;
+  targetGain = gain;
+  rampBlocksLeft = 0;
+  rampBlocksTotal = 0;
+  __enable_irq();
+}
+
+void AudioEffectFadeRamp::fadeTo(float target, uint32_t ms) {
+  // Whole blocks: one step every AUDIO_BLOCK_SAMPLES samples (~2.9 ms).
+  uint32_t blocks = (uint32_t)(ms * AUDIO_SAMPLE_RATE_EXACT /
+                               (1000.0f * AUDIO_BLOCK_SAMPLES));
+  if (blocks < 1) {
+    blocks = 1;
+  }
+  __disable_irq();
+  startGain = currentGain;
+  targetGain = target;
+  rampBlocksTotal = blocks;
+  rampBlocksLeft = blocks;
+  __enable_irq();
+}
+
+void AudioEffectFadeRamp::update(void) {
+  audio_block_t *block = receiveWritable();
+  if (!block) {
+    return;
+  }
+
+  float g0 = currentGain;
+  float g1 = g0;
+
+  if (rampBlocksLeft > 0) {
+    rampBlocksLeft--;
+    // Progress 0..1 along the ramp, mapped through the instance's curve.
+    float t = (float)(rampBlocksTotal - rampBlocksLeft) / rampBlocksTotal;
+    const FadeCurve &shape =
+        (curveType == kFadeCurveRaisedCosine) ? RC_CURVE : FADE_CURVE;
+    float curve = shape.v[(int)(t * FADE_CURVE_STEPS)];
+    g1 = startGain + (targetGain - startGain) * curve;
+    if (rampBlocksLeft == 0) {
+      g1 = targetGain;
+    }
+  }
+
+  if (g0 == 1.0f && g1 == 1.0f) {
+    // Unity passthrough: nothing to multiply.
+    transmit(block);
+    release(block);
+    return;
+  }
+
+  // Per-sample linear interpolation between the block-start and block-end
+  // gains removes any step at block boundaries.
+  float gain = g0;
+  float step = (g1 - g0) / AUDIO_BLOCK_SAMPLES;
+  for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+    block->data[i] = (int16_t)(block->data[i] * gain);
+    gain += step;
+  }
+
+  currentGain = g1;
+  transmit(block);
+  release(block);
+}
@@ -0,0 +1,66 @@
+/*
+FadeRamp: Audio-rate gain ramp node for fades and transitions.
+
+updateFadedVolume() used to recompute a float fraction in loop() and poke
+mixerMusicOutput.gain(), so fade smoothness depended on loop cadence and a
+stalled loop produced audible zipper steps. This node sits between the SD
+streamer and the music mixer and steps the gain inside the audio update:
+one table lookup per block along a precomputed equal-power sine curve, with
+per-sample linear interpolation across the block, so fades are glitch-free
+no matter what loop() is doing.
+
+With a single SD streamer the active-to-idle "crossfade" is a fade-out,
+song switch, fade-in sequence (there is no second source to overlap);
+fadeOut()/fadeIn() plus fading() give MusicPlayer.ino the pieces.
+*/
+
+#ifndef FADE_RAMP_H
+#define FADE_RAMP_H
+
+#include <Audio.h>
+
+// Ramp curve shapes. Equal-power suits the music fade-out/fade-in
+// sequence; raised-cosine is the spectrally tight choice for gating a
+// pure tone on and off (no discontinuity in value or slope, so gating
+// puts no click on the hands and no transient into peer detectors).
+enum FadeCurveType : uint8_t {
+  kFadeCurveEqualPower,   // sin(pi/2 * t)
+  kFadeCurveRaisedCosine, // (1 - cos(pi * t)) / 2
+};
+
+class AudioEffectFadeRamp : public AudioStream {
+public:
+  AudioEffectFadeRamp(FadeCurveType curve = kFadeCurveEqualPower)
+      : AudioStream(1, inputQueueArray) {
+    currentGain = 1.0f;
+    startGain = 1.0f;
+    targetGain = 1.0f;
+    rampBlocksTotal = 0;
+    rampBlocksLeft = 0;
+    curveType = curve;
+  }
+
+  // Jump to a gain immediately (cancels any ramp in progress).
+  void setGain(float gain);
+
+  // Ramp from the current gain to `target` over `ms` milliseconds.
+  void fadeTo(float target, uint32_t ms);
+  void fadeIn(uint32_t ms) { fadeTo(1.0f, ms); }
+  void fadeOut(uint32_t ms) { fadeTo(0.0f, ms); }
+
+  // True while a ramp is still in progress.
+  bool fading() { return rampBlocksLeft > 0; }
+
+  virtual void update(void);
+
+private:
+  audio_block_t *inputQueueArray[1];
+  volatile float currentGain; // Gain at the end of the last block
+  volatile float startGain;   // Gain when the current ramp began
+  volatile float targetGain;
+  volatile uint32_t rampBlocksTotal;
+  volatile uint32_t rampBlocksLeft;
+  FadeCurveType curveType;
+};
+
+#endif // FADE_RAMP_H
@@ -0,0 +1,137 @@
+/*
+FaultDump.cpp - fault vector install, capture, and EEPROM persistence.
+
+Capture path: the naked handler picks the active stack (MSP or PSP per
+EXC_RETURN bit 2) and hands the exception frame to faultCapture(),
+which copies the stacked PC/LR/PSR, the fault status registers, and
+FAULT_DUMP_STACK_WORDS words above the frame into a record, writes it
+to EEPROM, and requests a system reset. Interrupts are already masked
+at fault priority, so the EEPROM write runs uncontended; if the write
+itself faults we are no worse off than before - the chip resets either
+way (the watchdog from Watchdog.cpp backstops a wedged handler).
+*/
+
+#include "FaultDump.h"
+
+#include <avr/eeprom.h>
+
+// EEPROM slot in the layout documented in ConfigStore.cpp (config at 0,
+// hostname at 128, lease at 192, this record at 256, calibration at
+// 384, counter ring at 512).
+#define FAULT_DUMP_ADDR 256
+#define FAULT_DUMP_MAGIC 0x4D4C4654 // "MLFT" - Missing Link FaulT
+
+struct __attribute__((packed)) FaultRecord {
+  uint32_t magic;
+  uint32_t cfsr; // Configurable Fault Status (MemManage/Bus/Usage)
+  uint32_t hfsr; // HardFault Status
+  uint32_t pc;   // Stacked return address - the faulting instruction
+  uint32_t lr;   // Stacked link register - the caller
+  uint32_t sp;   // Stack pointer at the exception frame
+  uint32_t psr;  // Stacked program status
+  uint32_t faultAddr; // MMFAR/BFAR when the fault has a valid address
+  uint32_t stack[FAULT_DUMP_STACK_WORDS];
+};
+
+// Record loaded from EEPROM at boot, when a previous crash left one.
+static FaultRecord pendingRecord;
+static bool pending = false;
+
+extern "C" void faultCapture(uint32_t *frame) {
+  FaultRecord rec;
+  rec.magic = FAULT_DUMP_MAGIC;
+  rec.cfsr = SCB_CFSR;
+  rec.hfsr = SCB_HFSR;
+  // Frame layout fixed by the architecture: r0-r3, r12, lr, pc, psr.
+  rec.lr = frame[5];
+  rec.pc = frame[6];
+  rec.psr = frame[7];
+  rec.sp = (uint32_t)frame;
+  // MMFAR and BFAR share validity bits in CFSR (MMARVALID/BFARVALID).
+  if (rec.cfsr & 0x80) {
+    rec.faultAddr = SCB_MMFAR;
+  } else if (rec.cfsr & 0x8000) {
+    rec.faultAddr = SCB_BFAR;
+  } else {
+    rec.faultAddr = 0;
+  }
+  for (int i = 0; i < FAULT_DUMP_STACK_WORDS; i++) {
+    rec.stack[i] = frame[8 + i];
+  }
+
+  eeprom_write_block(&rec, (void *)FAULT_DUMP_ADDR, sizeof(rec));
+
+  // SYSRESETREQ: reboot now; the record is safe in flash.
+  SCB_AIRCR = 0x05FA0004;
+  while (true) {
+    // Reset is asynchronous; never return into the faulting context.
+  }
+}
+
+static void __attribute__((naked)) faultHandler() {
+  asm volatile("tst lr, #4\n"
+               "ite eq\n"
+               "mrseq r0, msp\n"
+               "mrsne r0, psp\n"
+               "b faultCapture\n");
+}
+
+// Boot-only: FLASHMEM. The fault handlers themselves stay in ITCM -
+// they must run even if the flash cache is in a bad state.
+FLASHMEM void faultDumpSetup() {
+  // Previous boot's record, if any. It stays in EEPROM until collected
+  // so a power cycle before the next MQTT connect doesn't lose it.
+  eeprom_read_block(&pendingRecord, (const void *)FAULT_DUMP_ADDR,
+                    sizeof(pendingRecord));
+  pending = (pendingRecord.magic == FAULT_DUMP_MAGIC);
+  if (pending) {
+    Serial.printf("FaultDump: crash last boot, pc=0x%08lX cfsr=0x%08lX\n",
+                  (unsigned long)pendingRecord.pc,
+                  (unsigned long)pendingRecord.cfsr);
+  }
+
+  // Route the fault vectors at our handler and split MemManage/Bus/Usage
+  // out of HardFault so CFSR says which one fired.
+  _VectorsRam[3] = faultHandler; // HardFault
+  _VectorsRam[4] = faultHandler; // MemManage
+  _VectorsRam[5] = faultHandler; // BusFault
+  _VectorsRam[6] = faultHandler; // UsageFault
+  SCB_SHCSR |= (1u << 16) | (1u << 17) | (1u << 18); // MEM|BUS|USG FAULTENA
+}
+
+bool faultDumpPending() { return pending; }
+
+bool faultDumpCollect(char *json, size_t jsonLen) {
+  if (!pending) {
+    return false;
+  }
+
+  size_t pos = 0;
+  pos += snprintf(json + pos, jsonLen - pos,
+                  "{\"pc\":\"0x%08lX\",\"lr\":\"0x%08lX\",\"sp\":\"0x%08lX\","
+                  "\"cfsr\":\"0x%08lX\",\"hfsr\":\"0x%08lX\","
+                  "\"addr\":\"0x%08lX\",\"stack\":[",
+                  (unsigned long)pendingRecord.pc,
+                  (unsigned long)pendingRecord.lr,
+                  (unsigned long)pendingRecord.sp,
+                  (unsigned long)pendingRecord.cfsr,
+                  (unsigned long)pendingRecord.hfsr,
+                  (unsigned long)pendingRecord.faultAddr);
+  for (int i = 0; i < FAULT_DUMP_STACK_WORDS && pos < jsonLen; i++) {
+    pos += snprintf(json + pos, jsonLen - pos, "%s\"0x%08lX\"",
+                    (i > 0) ? "," : "",
+                    (unsigned long)pendingRecord.stack[i]);
+  }
+  if (pos < jsonLen) {
+    pos += snprintf(json + pos, jsonLen - pos, "]}");
+  }
+  if (pos >= jsonLen) {
+    return false;
+  }
+
+  // Delivered: clear the magic so the next boot doesn't re-report.
+  uint32_t zero = 0;
+  eeprom_write_block(&zero, (void *)FAULT_DUMP_ADDR, sizeof(zero));
+  pending = false;
+  return true;
+}
@@ -0,0 +1,35 @@
+/*
+FaultDump: hard-fault capture with an EEPROM-persisted crash record.
+
+A statue that hard-faulted used to just reboot and take the evidence
+with it. The fault handlers installed here snapshot the stacked PC/LR,
+the fault status registers, and a short stack window into EEPROM before
+resetting, and the record goes out on missing_link/fault at the next
+MQTT connect (see publishFaultReport in Messaging.ino) - a field crash
+becomes an actionable report instead of a mystery reboot.
+
+The record lives in EEPROM rather than RAM so it survives the reset and
+any power loss between the crash and the next broker connection.
+*/
+
+#ifndef FAULT_DUMP_H
+#define FAULT_DUMP_H
+
+#include <Arduino.h>
+
+// Stacked words captured from the faulting stack pointer.
+#define FAULT_DUMP_STACK_WORDS 8
+
+// Install the HardFault/MemManage/BusFault/UsageFault handlers and load
+// any record a previous boot's crash left in EEPROM. Call early in
+// setup().
+void faultDumpSetup();
+
+// True when a crash record from a previous boot is waiting to publish.
+bool faultDumpPending();
+
+// Format the pending record as a JSON object and clear it from EEPROM.
+// Returns false when nothing is pending or the buffer is too small.
+bool faultDumpCollect(char *json, size_t jsonLen);
+
+#endif // FAULT_DUMP_H
@@ -0,0 +1,271 @@
+/*
+FaultInject.cpp - the fault injectors and their stopwatches.
+
+Link: the PHY is put into power-down over MDIO (BMCR bit 11), which is
+a cable pull as far as the rest of the stack can tell - the QNEthernet
+driver's own poll sees BMSR report no link and takes the netif down,
+the MQTT socket stalls, and the reconnect backoff plus broker failover
+(Messaging.ino) have to bring the session back once the PHY
+renegotiates. The verdict splits detection in two: link_down_ms is the
+driver noticing, mqtt_down_ms is PubSubClient noticing (keepalive
+bound - the number the reconnect design actually rides on).
+
+SD: sdIoBegin (SdArbiter.cpp) denies every class, playback included,
+for the stall window, so the playback underrun and starvation paths
+get exercised for real. Detect is the first denial, recover the first
+grant after expiry; the streak counters in missing_link/storage
+corroborate from the other side.
+
+Wedge: a busy spin inside this task. The scheduler feeds the watchdog
+once per pass, so a spin past WATCHDOG_TIMEOUT_S resets the statue
+with this task's stage marker in the fault record - that half of the
+verdict arrives via missing_link/fault and the boot report after the
+reset. Shorter spins report the measured stall here and show up in the
+task overrun stats.
+
+Config: a deliberately corrupt document is pushed straight through the
+registered config handler (mqttInjectInbound, Messaging.ino); the
+verdict is the parse-and-reject time and whether the live threshold
+survived untouched.
+*/
+
+#include "FaultInject.h"
+
+#if FAULT_INJECT
+
+#include "Log.h"
+#include "Messaging.h"
+#include "Networking.h"
+#include "StatueConfig.h"
+#include "Watchdog.h"
+
+#include <ArduinoJson.h>
+
+// PHY register access exported by QNEthernet's Teensy 4.1 driver
+// (driver_teensy41.c). Blocking MDIO, loop context only.
+extern "C" {
+uint16_t mdio_read(uint16_t regaddr);
+void mdio_write(uint16_t regaddr, uint16_t data);
+}
+
+#define PHY_BMCR 0x00
+#define PHY_BMCR_POWER_DOWN (1u << 11)
+
+#define FAULT_MS_DEFAULT 5000
+#define FAULT_MS_MAX 60000
+
+// An experiment that hasn't recovered this long after its restore is
+// reported as failed rather than pending forever.
+#define FAULT_RECOVERY_TIMEOUT_MS 120000
+
+enum FaultKind : uint8_t {
+  FAULT_NONE = 0,
+  FAULT_LINK,
+  FAULT_SD,
+};
+
+static uint8_t activeFault = FAULT_NONE;
+static unsigned long injectMs = 0;
+static unsigned long restoreAtMs = 0;
+static unsigned long restoredMs = 0; // Link: when the PHY was re-enabled
+
+// Stopwatches, 0 = not yet observed.
+static unsigned long linkDownMs = 0;
+static unsigned long mqttDownMs = 0;
+static unsigned long linkUpMs = 0;
+static unsigned long sdDetectMs = 0;
+static unsigned long sdRecoverMs = 0;
+
+// Wedge request; performed on the next loop pass so the command
+// handler itself returns promptly.
+static unsigned long wedgeReqMs = 0;
+
+static void publishReport(const char *json) {
+  char jsonMsg[256];
+  snprintf(jsonMsg, sizeof(jsonMsg), "{\"statue\":\"%s\",%s}",
+           MY_STATUE_NAME_LC, json);
+  client.publish(ringTopic("missing_link/fault/report"), jsonMsg);
+}
+
+static void startLinkFault(unsigned long ms) {
+  injectMs = millis();
+  restoreAtMs = injectMs + ms;
+  restoredMs = linkDownMs = mqttDownMs = linkUpMs = 0;
+  activeFault = FAULT_LINK;
+  LOG_WARN("faultinject: link down for %lu ms", ms);
+  mdio_write(PHY_BMCR, mdio_read(PHY_BMCR) | PHY_BMCR_POWER_DOWN);
+}
+
+static void startSdFault(unsigned long ms) {
+  injectMs = millis();
+  restoreAtMs = injectMs + ms;
+  sdDetectMs = sdRecoverMs = 0;
+  activeFault = FAULT_SD;
+  LOG_WARN("faultinject: SD stalled for %lu ms", ms);
+}
+
+static void runConfigFault() {
+  float before = teensyConfig.threshold;
+  // Truncated mid-key with a non-numeric threshold: both the parser and
+  // the type conversion get a chance to let garbage through.
+  static const char corrupt[] =
+      "{\"statues\": {\"eros\": {\"threshold\": \"***\", \"emi";
+  long us = mqttInjectInbound("missing_link/config/response", corrupt,
+                              sizeof(corrupt) - 1);
+  bool kept = teensyConfig.threshold == before;
+  char json[96];
+  snprintf(json, sizeof(json),
+           "\"fault\":\"config\",\"reject_us\":%ld,\"threshold_kept\":%s", us,
+           kept ? "true" : "false");
+  publishReport(json);
+  if (!kept) {
+    LOG_ERROR("faultinject: corrupt config changed the live threshold");
+  }
+}
+
+static void runWedge() {
+  unsigned long ms = wedgeReqMs;
+  wedgeReqMs = 0;
+  LOG_WARN("faultinject: wedging %lu ms (watchdog resets at %d s)", ms,
+           WATCHDOG_TIMEOUT_S);
+  unsigned long t0 = millis();
+  while (millis() - t0 < ms) {
+    // Busy spin, no yield: the scheduler never gets a pass to feed the
+    // watchdog, exactly like a task stuck in a loop.
+  }
+  char json[64];
+  snprintf(json, sizeof(json), "\"fault\":\"wedge\",\"stall_ms\":%lu",
+           millis() - t0);
+  publishReport(json);
+}
+
+static void stepLinkFault() {
+  unsigned long now = millis();
+  if (linkDownMs == 0 && !Ethernet.linkState()) {
+    linkDownMs = now;
+  }
+  if (mqttDownMs == 0 && !client.connected()) {
+    mqttDownMs = now;
+  }
+  if (restoredMs == 0) {
+    if ((long)(now - restoreAtMs) >= 0) {
+      mdio_write(PHY_BMCR, mdio_read(PHY_BMCR) & (uint16_t)~PHY_BMCR_POWER_DOWN);
+      restoredMs = now;
+    }
+    return;
+  }
+  if (linkUpMs == 0 && Ethernet.linkState()) {
+    linkUpMs = now;
+  }
+
+  bool recovered = linkUpMs != 0 && client.connected();
+  bool gaveUp = now - restoredMs > FAULT_RECOVERY_TIMEOUT_MS;
+  if (!recovered && !gaveUp) {
+    return;
+  }
+  char json[192];
+  // Down stopwatches count from injection, up stopwatches from the
+  // restore; mqtt_down_ms 0 means the session rode out the fault.
+  snprintf(json, sizeof(json),
+           "\"fault\":\"link\",\"held_ms\":%lu,\"link_down_ms\":%lu,"
+           "\"mqtt_down_ms\":%lu,\"link_up_ms\":%lu,\"mqtt_up_ms\":%lu,"
+           "\"recovered\":%s",
+           restoredMs - injectMs, linkDownMs ? linkDownMs - injectMs : 0,
+           mqttDownMs ? mqttDownMs - injectMs : 0,
+           linkUpMs ? linkUpMs - restoredMs : 0,
+           recovered ? now - restoredMs : 0, recovered ? "true" : "false");
+  activeFault = FAULT_NONE;
+  publishReport(json);
+  if (!recovered) {
+    LOG_ERROR("faultinject: MQTT not back %lu s after link restore",
+              FAULT_RECOVERY_TIMEOUT_MS / 1000);
+  }
+}
+
+static void stepSdFault() {
+  unsigned long now = millis();
+  if ((long)(now - restoreAtMs) < 0) {
+    return; // Stall still in force; the arbiter hooks do the timing
+  }
+  bool recovered = sdRecoverMs != 0;
+  bool gaveUp = now - restoreAtMs > FAULT_RECOVERY_TIMEOUT_MS;
+  if (!recovered && !gaveUp) {
+    return; // No consumer has asked for the card yet
+  }
+  char json[160];
+  snprintf(json, sizeof(json),
+           "\"fault\":\"sd\",\"held_ms\":%lu,\"detect_ms\":%lu,"
+           "\"recover_ms\":%lu,\"recovered\":%s",
+           restoreAtMs - injectMs, sdDetectMs ? sdDetectMs - injectMs : 0,
+           recovered ? sdRecoverMs - restoreAtMs : 0,
+           recovered ? "true" : "false");
+  activeFault = FAULT_NONE;
+  publishReport(json);
+}
+
+void faultInjectCommand(const char *payload, unsigned int length) {
+  StaticJsonDocument<128> doc;
+  if (deserializeJson(doc, payload, length) != DeserializationError::Ok) {
+    return;
+  }
+  const char *target = doc["statue"] | "";
+  if (target[0] != '\0' && strcasecmp(target, MY_STATUE_NAME) != 0) {
+    return; // Addressed to another statue; no target hits everyone
+  }
+  unsigned long ms = doc["ms"] | (unsigned long)FAULT_MS_DEFAULT;
+  if (ms > FAULT_MS_MAX) {
+    ms = FAULT_MS_MAX;
+  }
+  const char *fault = doc["fault"] | "";
+  if (activeFault != FAULT_NONE) {
+    LOG_WARN("faultinject: '%s' ignored, experiment in flight", fault);
+    return;
+  }
+  if (strcmp(fault, "link") == 0) {
+    startLinkFault(ms);
+  } else if (strcmp(fault, "sd") == 0) {
+    startSdFault(ms);
+  } else if (strcmp(fault, "wedge") == 0) {
+    wedgeReqMs = ms;
+  } else if (strcmp(fault, "config") == 0) {
+    runConfigFault();
+  } else {
+    LOG_WARN("faultinject: unknown fault '%s'", fault);
+  }
+}
+
+void faultInjectLoop() {
+  if (wedgeReqMs != 0) {
+    runWedge();
+    return;
+  }
+  switch (activeFault) {
+  case FAULT_LINK:
+    stepLinkFault();
+    break;
+  case FAULT_SD:
+    stepSdFault();
+    break;
+  default:
+    break;
+  }
+}
+
+bool faultInjectSdStalled() {
+  return activeFault == FAULT_SD && (long)(millis() - restoreAtMs) < 0;
+}
+
+void faultInjectNoteSdDenied() {
+  if (activeFault == FAULT_SD && sdDetectMs == 0) {
+    sdDetectMs = millis();
+  }
+}
+
+void faultInjectNoteSdGranted() {
+  if (activeFault == FAULT_SD && sdRecoverMs == 0 &&
+      (long)(millis() - restoreAtMs) >= 0) {
+    sdRecoverMs = millis();
+  }
+}
+
+#endif // FAULT_INJECT
@@ -0,0 +1,37 @@
+/*
+FaultInject.h - MQTT-commanded fault injection with measured recovery.
+
+Compiled in only when FAULT_INJECT (defines.h) is true: an adversarial
+test build that injects the failures the resilience features claim to
+survive - a dead Ethernet link, a stalled SD card, a wedged task, a
+corrupt config payload - and measures time-to-detect and time-to-recover
+for each, so every resilience claim ships with a number instead of a
+hope. Commands arrive on missing_link/fault/cmd; verdicts publish on
+missing_link/fault/report. Every fault is self-restoring on a deadline
+carried in the inject command, because the link fault takes MQTT down
+with it and a restore command could never arrive.
+*/
+
+#ifndef FAULT_INJECT_H
+#define FAULT_INJECT_H
+
+#include "defines.h"
+
+#include <Arduino.h>
+
+// MQTT command handler body: {"fault":"link"|"sd"|"wedge"|"config"}
+// with optional "ms" duration and "statue" targeting.
+void faultInjectCommand(const char *payload, unsigned int length);
+
+// Scheduler task: steps the active experiment (stopwatches, scheduled
+// restore) and publishes the verdict once recovery is observed.
+void faultInjectLoop();
+
+// SdArbiter hooks. Stalled() is true while the injected SD stall is in
+// force (every class denied); the note calls timestamp the first denial
+// (detect) and the first real grant after expiry (recover).
+bool faultInjectSdStalled();
+void faultInjectNoteSdDenied();
+void faultInjectNoteSdGranted();
+
+#endif // FAULT_INJECT_H
@@ -0,0 +1,163 @@
+/*
+FilePublish.cpp - the chunk pump.
+
+Each pass is one self-contained publish: read a chunk through the
+arbiter, then beginPublish()/write()/endPublish() in the same pass -
+the client's packet buffer is shared with everything else, so a publish
+may never straddle passes. A failed begin or end (socket backpressure,
+broker gone) leaves the offset where it was and the same chunk retries
+next pass; a failed read aborts the transfer with an error meta so the
+Pi is not left waiting.
+*/
+
+#include "FilePublish.h"
+
+#include <SD.h>
+#include <stdarg.h>
+
+#include "Log.h"
+#include "Messaging.h"
+#include "MusicPlayer.h"
+#include "SdArbiter.h"
+#include "StatueConfig.h"
+
+// 2 KB per pass: big enough to amortize the seek, small enough that a
+// chunk read plus the socket write stays well inside a pass.
+#define FILE_PUB_CHUNK 2048
+
+static FsFile pubFile;
+static bool pubActive = false;
+static char pubName[48];
+static char metaTopic[48];
+static char dataTopic[48];
+static uint32_t pubSize = 0;
+static uint32_t pubOffset = 0;
+static uint32_t pubCrc = 0;
+static bool chunkLoaded = false; // Chunk read but not yet accepted
+static uint32_t chunkLen = 0;
+
+DMAMEM static uint8_t chunkBuf[FILE_PUB_CHUNK];
+
+// Bitwise CRC-32/ISO-HDLC (zlib-compatible), no table: ~8 cycles per
+// bit is nothing next to the SD read it trails.
+static uint32_t crc32Update(uint32_t crc, const uint8_t *data, size_t len) {
+  crc = ~crc;
+  for (size_t i = 0; i < len; i++) {
+    crc ^= data[i];
+    for (int b = 0; b < 8; b++) {
+      crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+    }
+  }
+  return ~crc;
+}
+
+static void publishMeta(const char *fmt, ...) {
+  char json[160];
+  va_list args;
+  va_start(args, fmt);
+  vsnprintf(json, sizeof(json), fmt, args);
+  va_end(args);
+  client.publish(metaTopic, json);
+}
+
+bool filePublishStart(const char *name) {
+  if (pubActive) {
+    LOG_WARN("filepub: transfer of %s still running", pubName);
+    return false;
+  }
+  if (!musicReady()) {
+    LOG_WARN("filepub: card not mounted");
+    return false;
+  }
+  pubFile = SD.sdfs.open(name, O_RDONLY);
+  if (!pubFile.isOpen()) {
+    LOG_WARN("filepub: cannot open %s", name);
+    return false;
+  }
+  strlcpy(pubName, name, sizeof(pubName));
+  // Topics are reused across many chunk publishes, so the ring scoping
+  // happens once here rather than per packet.
+  char unscoped[48];
+  snprintf(unscoped, sizeof(unscoped), "missing_link/file/%s/meta",
+           MY_STATUE_NAME_LC);
+  strlcpy(metaTopic, ringTopic(unscoped), sizeof(metaTopic));
+  snprintf(unscoped, sizeof(unscoped), "missing_link/file/%s/data",
+           MY_STATUE_NAME_LC);
+  strlcpy(dataTopic, ringTopic(unscoped), sizeof(dataTopic));
+  pubSize = (uint32_t)pubFile.fileSize();
+  pubOffset = 0;
+  pubCrc = 0;
+  chunkLoaded = false;
+  pubActive = true;
+  publishMeta("{\"name\":\"%s\",\"size\":%lu,\"chunk\":%d}", pubName,
+              (unsigned long)pubSize, FILE_PUB_CHUNK);
+  LOG_INFO("filepub: streaming %s (%lu bytes)", pubName,
+           (unsigned long)pubSize);
+  return true;
+}
+
+bool filePublishActive() { return pubActive; }
+
+static void finishTransfer(bool ok) {
+  pubFile.close();
+  pubActive = false;
+  if (ok) {
+    publishMeta("{\"name\":\"%s\",\"done\":true,\"bytes\":%lu,\"crc32\":%lu}",
+                pubName, (unsigned long)pubOffset, (unsigned long)pubCrc);
+    LOG_INFO("filepub: %s done, crc32 %08lx", pubName, (unsigned long)pubCrc);
+  } else {
+    publishMeta("{\"name\":\"%s\",\"error\":\"read\",\"bytes\":%lu}", pubName,
+                (unsigned long)pubOffset);
+    LOG_WARN("filepub: %s aborted at %lu", pubName, (unsigned long)pubOffset);
+  }
+}
+
+void filePublishLoop() {
+  if (!pubActive) {
+    return;
+  }
+  if (pubOffset >= pubSize) {
+    finishTransfer(true);
+    return;
+  }
+  if (!client.connected()) {
+    return; // Hold position; the transfer resumes with the session
+  }
+
+  // Read the next chunk, unless a publish failure left one loaded.
+  if (!chunkLoaded) {
+    // Lowest priority: a post-event pull must never delay live SD work.
+    if (!sdIoBegin(SD_IO_SYNC)) {
+      return;
+    }
+    uint32_t want = pubSize - pubOffset;
+    if (want > FILE_PUB_CHUNK) {
+      want = FILE_PUB_CHUNK;
+    }
+    bool ok = pubFile.seekSet(pubOffset) &&
+              pubFile.read(chunkBuf, want) == (int)want;
+    sdIoEnd(SD_IO_SYNC);
+    if (!ok) {
+      finishTransfer(false);
+      return;
+    }
+    chunkLen = want;
+    chunkLoaded = true;
+  }
+
+  // One packet: offset header plus the chunk, assembled and sent inside
+  // this pass (the packet buffer is shared; see beginPublish()).
+  uint32_t offsetHeader = pubOffset;
+  if (!client.beginPublish(dataTopic, sizeof(offsetHeader) + chunkLen,
+                           false)) {
+    return; // Retry the loaded chunk next pass
+  }
+  client.write((const uint8_t *)&offsetHeader, sizeof(offsetHeader));
+  client.write(chunkBuf, chunkLen);
+  if (client.endPublish() != 1) {
+    return; // Socket backpressure; retry the loaded chunk next pass
+  }
+  pubCrc = crc32Update(pubCrc, chunkBuf, chunkLen);
+  pubOffset += chunkLen;
+  chunkLoaded = false;
+}
@@ -0,0 +1,39 @@
+/*
+FilePublish: stream a file off the SD card through the MQTT connection.
+
+Retrieving the event journal or a flight trace used to mean pulling the
+card - five ladder climbs after every show. This service streams any
+file on the card to the Pi in bounded chunks: one chunk per scheduler
+pass, read through the arbiter at the lowest priority and published
+with beginPublish()/write()/endPublish() so a chunk larger than the
+client buffer still goes out in one packet. A transfer rides alongside
+normal traffic at roughly 100 KB/s without ever holding the loop for
+more than one chunk.
+
+Protocol, all under the per-statue prefix missing_link/file/<statue>:
+  .../meta   JSON:  {"name":...,"size":N,"chunk":N} at start,
+             {"name":...,"done":true,"bytes":N,"crc32":N} at the end
+             ("error" instead of "done" on a failed read).
+  .../data   Binary: a packed u32 file offset, then the chunk bytes.
+The offset header plus the final crc32 (CRC-32/ISO-HDLC, same as zlib)
+let the Pi detect loss and verify the reassembled file.
+
+Commands arrive on missing_link/file/cmd (see handleFileCmd in
+Messaging.ino); one transfer at a time per statue.
+*/
+
+#ifndef FILE_PUBLISH_H
+#define FILE_PUBLISH_H
+
+#include <Arduino.h>
+
+// Start streaming the named file. False if a transfer is already
+// running, the card is not mounted, or the file cannot be opened.
+bool filePublishStart(const char *name);
+
+// Scheduler task: publish one chunk per pass while a transfer runs.
+void filePublishLoop();
+
+bool filePublishActive();
+
+#endif // FILE_PUBLISH_H
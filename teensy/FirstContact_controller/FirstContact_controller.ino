@@ -83,32 +83,238 @@ I found it helpful to wire one of the buttons to the two pin contacts for conven
 */
 
 #include "AudioSense.h"
+#include "AudioTap.h"
+#include "BootProfile.h"
+#include "CounterStore.h"
 #include "Display.h"
+#include "EventBus.h"
+#include "EventJournal.h"
+#include "FaultDump.h"
+#include "FaultInject.h"
+#include "FilePublish.h"
+#include "FlightRecorder.h"
+#include "FreqRealloc.h"
+#include "FreqSweep.h"
 #include "Haptics.h"
+#include "IsrTrace.h"
+#include "LatencyMarkers.h"
+#include "Log.h"
+#include "MemMonitor.h"
 #include "Messaging.h"
+#include "MonoClock.h"
 #include "MusicPlayer.h"
+#include "MusicSync.h"
+#include "NetClock.h"
 #include "Networking.h"
+#include "OrphanMode.h"
+#include "OtaUpdate.h"
+#include "PeerLink.h"
+#include "PowerGovernor.h"
+#include "SdBench.h"
+#include "SongSync.h"
+#include "TaskScheduler.h"
+#include "TxLevel.h"
+#include "WarmState.h"
+#include "Watchdog.h"
 #include "defines.h"
 
-// Timing for periodic signal monitoring
-elapsedMillis sinceSignalPublish = 0;
-const uint16_t signal_publish_period_ms = 100;
+// Task cadences (see TaskScheduler.h). Budgets are tripwires: a run over
+// budget increments the task's overrun counter in missing_link/tasks.
+#define SENSE_PERIOD_MS 6        // ~150 Hz touch sensing
+#define SIGNAL_PUBLISH_PERIOD_MS 100 // 10 Hz signal monitoring (ceiling)
+#define TELEMETRY_PERIOD_MS 60000    // SD/network/scheduler health
+#define LOG_DRAIN_PERIOD_MS 50       // Log ring drain to USB serial/MQTT
 
-void setup() {
-  // Display Setup
-  displaySetup();
+/*
+  Touch sensing and everything that reacts to a state change. Publishing
+  the state stays on this cadence - touch-to-LED latency is the number
+  the installation lives by - as do music, haptics, and the state-driven
+  display widgets (which only draw into the buffer; the display task
+  flushes).
+*/
+static void taskSense() {
+  // Retrieve the current contact state.
+  ContactState state = getContactState();
+
+#if !STANDALONE_MODE
+  // Publish the state to the MQTT broker to update LEDs.
+  if (networkReady()) {
+    publishState(state);
+  }
+#endif
+  // Update the music if the state changed or current song has ended.
+  playMusic(state);
+  // Print any changed state to the serial console for debugging.
+  printState(state);
+
+  // Update the display with the current state.
+  displayState(state);
+  // During idle time, animate something to show we are alive.
+  displayActivityStatus(state.isLinked());
+
+  // Drive haptics based on state
+  driveHaptics(state);
+
+  // Pulse the local LEDs with the music envelope.
+  updateMusicLeds();
+
+  // Step the line-in attenuation if the sense input is clipping.
+  clipGuardLoop();
+
+  // Close out the boot calibration window once it elapses.
+  audioSenseCalibLoop();
+
+  // Attribute the audio pool's current block usage to the graph
+  // configuration we are in, for the per-phase high-water telemetry.
+  {
+    int links = __builtin_popcount((unsigned)state.isLinkedMask);
+    uint8_t poolCfg = AUDIO_POOL_DORMANT;
+    if (musicFading()) {
+      poolCfg = AUDIO_POOL_FADING;
+    } else if (links >= 2) {
+      poolCfg = AUDIO_POOL_MULTI;
+    } else if (links == 1 || musicPlaying()) {
+      poolCfg = AUDIO_POOL_LINKED;
+    }
+    memAudioPoolSample(poolCfg);
+  }
+
+  // Fire one link-change event for the bus consumers (journal, and
+  // whoever registers next); they run from the events task, off this
+  // hot path.
+  if (state.isInitialized && !state.isUnchanged()) {
+    Event ev;
+    ev.type = EVENT_LINK_CHANGE;
+    ev.u.link.mask = (uint8_t)state.isLinkedMask;
+    ev.u.link.changed = (uint8_t)(state.risingMask | state.fallingMask);
+    memcpy(ev.u.link.quality, state.quality, sizeof(ev.u.link.quality));
+    eventBusPublish(ev);
+  }
+}
+
+/*
+  Display upkeep: the periodic widgets (which throttle themselves) and
+  the frame scheduler/chunk pump. Runs every pass so the chunked I2C
+  transfer drains promptly; the actual flush ticks at 10 Hz inside
+  displayLoop().
+*/
+static void taskDisplay() {
+  displayTimeCount();
+  displaySignals();
+  displayLoop();
+}
+
+#if !STANDALONE_MODE
+// Network servicing: converge the supervisor, then the per-protocol
+// loops. Runs every pass; each sub-loop is non-blocking.
+static void taskNetwork() {
+  netSupervisorLoop();
+  if (!networkReady()) {
+    return;
+  }
+  mqttLoop();
+  orphanModeLoop();
+  pollReverseDns();
+  sweepLoop();
+  tapLoop();
+  peerLinkLoop();
+  netClockLoop();
+  otaLoop();
+  songSyncLoop();
+  musicSyncLoop();
+  if (networkReady()) {
+    publishSdBenchReport(); // One-shot when a bench verdict is waiting
+  }
+}
+
+/*
+  Periodic signal-level monitoring, rate-adapted to what the sensing
+  layer sees. The fixed 10 Hz cadence was ~430k messages of unchanging
+  noise-floor data per statue overnight; the task now runs the scheduler
+  period as a ceiling and publishes every tenth pass (1 Hz) while all
+  detectors sit in the noise floor, snapping back to full rate the
+  moment any detector enters its hysteresis band or a link exists - the
+  same transition signal the power governor ramps the clock on. Full
+  rate holds for a few seconds past the last activity so the tail of a
+  break is captured at 10 Hz, not 1 Hz.
+*/
+#define SIGNAL_PUBLISH_IDLE_DIVISOR 10 // 1 Hz while nothing is happening
+#define SIGNAL_FAST_HOLD_MS 5000
+
+static void taskPublishSignals() {
+  extern volatile StatueMask latestLinkedMask; // AudioSense.ino
+  static uint8_t idleSkips = 0;
+  static unsigned long lastActiveMs = 0;
+
+  if (!networkReady()) {
+    return;
+  }
+  unsigned long now = millis();
+  if (latestLinkedMask != 0 || audioSenseTransitionActive()) {
+    lastActiveMs = now;
+  }
+  bool fast = lastActiveMs != 0 && now - lastActiveMs < SIGNAL_FAST_HOLD_MS;
+  if (!fast && ++idleSkips < SIGNAL_PUBLISH_IDLE_DIVISOR) {
+    return;
+  }
+  idleSkips = 0;
+  publishSignals();
+}
+
+// Once a minute: SD read latency, lwIP counters, and the scheduler's own
+// per-task overrun stats.
+static void taskTelemetry() {
+  if (!networkReady()) {
+    return;
+  }
+  publishStorageStats();
+  publishNetworkStats();
+  publishTaskStats();
+  publishMemoryStats();
+  publishAudioNodeStats();
+  publishIsrStats();
+  publishShadowStats();
+}
+#endif
 
+void setup() {
   Serial.printf("_______FIRST CONTACT_______ ");
   Serial.printf("%s %sd \n", __DATE__, __TIME__);
 
+  // Arm the hardware watchdog before anything that can block. A hang
+  // anywhere below (SD mount retries included) now resets the statue in
+  // seconds instead of wedging it until someone climbs a ladder.
+  bootStage("guards", 100);
+  watchdogSetup();
+
+  // Install the fault handlers and pick up any crash record the previous
+  // boot left in EEPROM; it publishes on missing_link/fault at the first
+  // MQTT connect.
+  faultDumpSetup();
+
+  // Paint the stack guard while the stack is still shallow, so the
+  // high-water mark in the memory telemetry covers the whole run.
+  memMonitorSetup();
+
+  // Scope instrumentation pins (LatencyMarkers.h); a no-op unless the
+  // LATENCY_MARKERS build. Before the audio graph starts toggling them.
+  latencyMarkersSetup();
+
+  // Season counters from the EEPROM ring; before the warm snapshot so
+  // a warm reset's (strictly newer) contact count wins the restore.
+  counterStoreSetup();
+
+  // Restore any warm-reset snapshot (contact counter now; playlist state
+  // once the SD manifest is up).
+  warmStateSetup();
+
 #if !STANDALONE_MODE
-  // TCP/IP Setup
+  // TCP/IP Setup. Non-blocking: this only kicks off DHCP. The supervisor
+  // in loop() finishes bring-up (including initMqtt) in the background so
+  // sensing and music start even when the Pi is still booting.
   Serial.printf("_______Init Ethernet_______\n");
+  bootStage("ethernet", 500);
   initEthernet();
-
-  // MQTT Setup
-  Serial.printf("_______Init MQTT Publisher_______\n");
-  initMqtt();
 #else
   Serial.println("*** STANDALONE MODE - Network/MQTT Disabled ***");
 #endif
@@ -116,61 +322,96 @@ void setup() {
   // Allow the hardware to sort itself out
   // delay(1500); XXX
 
+  // Music Player Setup. Only configures the SD SPI pins: the mount, the
+  // manifest scan, and any retries run from the sdmount scheduler task,
+  // overlapped with everything below. Card problems cost music, never
+  // sensing.
+  Serial.printf("_______Audio Music Init________\n");
+  bootStage("music", 100);
+  musicPlayerSetup();
+
   // Audio Sense Setup
   Serial.printf("_______Audio Memory/Sense Init________\n");
+  bootStage("sense", 1500); // Includes the ~200 ms loopback self-test
   audioSenseSetup();
 
-  // Music Player Setup
-  Serial.printf("_______Audio Music Init________\n");
-  musicPlayerSetup();
+  // Display Setup. Deliberately after sensing is live: the panel is
+  // cosmetic, and deferring Wire2/SSD1306/splash bring-up gets the statue
+  // sensing that much sooner after a power blip. Status messages pushed
+  // at the display before this point were buffered and replay here.
+  bootStage("display", 500);
+  displaySetup();
 
   // Haptic Setup
+  bootStage("haptics", 200);
   initHaptics();
 
-#if !STANDALONE_MODE
-  // Update display with correct statue identity after config is loaded.
-  // displayUpdateStatueInfo now shows: "B: elektra TX:12k" (compact format)
-  displayUpdateStatueInfo(getHostname());
+  // Interrupt priority map + ISR tracer. Last: every vector it wraps
+  // (audio update, eDMA, PIT, Ethernet MAC) has been attached by now.
+  bootStage("isr", 100);
+  isrTraceSetup();
 
-  displayFrequencies();
-  displayThresholds();
-  displaySignals();
-#endif
-}
-
-void loop() {
+  // Task registry. Sensing gets a guaranteed cadence; everything else is
+  // periodic or yields per pass. Budgets in microseconds.
+  schedulerAddTask("sense", taskSense, SENSE_PERIOD_MS, 3000);
 #if !STANDALONE_MODE
-  // Make sure we're connected to MQTT broker.
-  mqttLoop();
-
-  // Periodically publish signal levels for monitoring
-  if (sinceSignalPublish >= signal_publish_period_ms) {
-    publishSignals();
-    sinceSignalPublish = 0;
-  }
+  schedulerAddTask("net", taskNetwork, 0, 2000);
+  // Deferred MQTT handlers (Messaging.ino): the net task's socket reads
+  // only queue messages; the heavy parses run here, a bounded slice per
+  // pass. No budget - a config document parse is a legitimate long pass.
+  schedulerAddTask("mqttin", mqttInboundLoop, 5, 0);
+  schedulerAddTask("signals", taskPublishSignals, SIGNAL_PUBLISH_PERIOD_MS,
+                   1000);
+  schedulerAddTask("telemetry", taskTelemetry, TELEMETRY_PERIOD_MS, 5000);
 #endif
-
-  // Retrieve the current contact state.
-  ContactState state = getContactState();
-
+  schedulerAddTask("display", taskDisplay, 0, 2000);
+  schedulerAddTask("log", logDrain, LOG_DRAIN_PERIOD_MS, 2000);
+  // No budget: a legitimate SD.begin attempt runs long, and the task
+  // goes quiet once the card is mounted.
+  schedulerAddTask("sdmount", musicMountLoop, 100, 0);
+  // No budget: the 4 KB trace flush is a legitimate long write.
+  schedulerAddTask("flight", flightRecorderLoop, 20, 0);
+  // No budget for the same reason: the batched event flush is one burst.
+  schedulerAddTask("journal", journalLoop, 100, 0);
+  // SD benchmark sweep: one burst per pass, lowest arbiter priority;
+  // idle (and free) unless missing_link/bench/cmd starts a run.
+  schedulerAddTask("sdbench", sdBenchLoop, 20, 0);
+  // File streaming to the Pi (FilePublish.h): one chunk per pass at the
+  // lowest arbiter priority; idle unless missing_link/file/cmd asked.
+  // No budget - a chunk read plus its socket write is one long pass.
+  schedulerAddTask("filepub", filePublishLoop, 20, 0);
+  // Bus consumers batch here, off the sense cadence. Link edges are
+  // rare; 20 ms keeps journal timestamps honest without a hot task.
+  eventBusSubscribe(EVENT_LINK_CHANGE, journalOnLinkChange);
+  schedulerAddTask("events", eventBusDrain, 20, 1000);
+  // Clock scaling: ramp-up is checked every 50 ms so a forming contact
+  // never waits on the idle clock for long; the sense task itself runs
+  // identically at either clock.
+  schedulerAddTask("power", powerGovernorLoop, 50, 1000);
+  schedulerAddTask("warm", warmStateLoop, 1000, 1000);
+  // 1 Hz accumulation; the EEPROM commit inside is rare (cadenced) but
+  // legitimate when it happens, hence no budget.
+  schedulerAddTask("counters", counterStoreLoop, 1000, 0);
 #if !STANDALONE_MODE
-  // Publish the state to the MQTT broker to update LEDs.
-  publishState(state);
+  // Interference watch and frequency reallocation; the retune itself is
+  // table lookups but runs off this task, hence the loose budget.
+  schedulerAddTask("freq", freqReallocLoop, 500, 0);
+  schedulerAddTask("txlevel", txLevelLoop, 100, 0);
+#if FAULT_INJECT
+  // Test builds only: fault experiment stopwatches and scheduled
+  // restores. No budget - the wedge fault is a deliberate long pass; a
+  // wedge past the watchdog timeout resets with this task's id in the
+  // stage marker, which is the evidence that path works.
+  schedulerAddTask("fault", faultInjectLoop, 50, 0);
+#endif
 #endif
-  // Update the music if the state changed or current song has ended.
-  playMusic(state);
-  // Print any changed state to the serial console for debugging.
-  printState(state);
 
-  // Update the display with the current state.
-  displayState(state);
-  // During idle time, animate something to show we are alive.
-  displayActivityStatus(state.isLinked());
-  // Update the count and time at the bottom of the display.
-  displayTimeCount();
-  // Update signal strength display (throttled internally to ~100ms)
-  displaySignals();
+  // The statue identity display refresh happens when the network
+  // supervisor reaches READY (see netSupervisorLoop in Networking.ino).
 
-  // Drive haptics based on state
-  driveHaptics(state);
+  // Close the stage table and flag any over-budget stage; the breakdown
+  // publishes on missing_link/boot at the first MQTT connect.
+  bootProfileFinish();
 }
+
+void loop() { schedulerRun(); }
@@ -0,0 +1,101 @@
+/*
+FixedString: stack-allocated bounded string building.
+
+Arduino String turned up on steady-state paths - the reverse DNS helpers,
+getLocalIp(), the config parse - and each use is at least one heap
+allocation on a device targeting week-long uptime, with fragmentation as
+the failure mode. This type is a fixed-capacity character buffer with
+bounded append: no heap, no surprises, and a truncated build reports
+itself through ok() instead of silently corrupting (the same contract as
+JsonWriter). MemMonitor's heap-churn window is the watchdog: with these
+adopted, steady-state churn in missing_link/memory should sit at zero.
+*/
+
+#ifndef FIXED_STRING_H
+#define FIXED_STRING_H
+
+#include <Arduino.h>
+
+#include <stdarg.h>
+
+// Case-insensitive C-string compare, shared by the config and hostname
+// matching paths (avoids constructing a String just to compare).
+inline bool strEqualsIgnoreCase(const char *a, const char *b) {
+  while (*a && *b) {
+    if (tolower((unsigned char)*a) != tolower((unsigned char)*b)) {
+      return false;
+    }
+    a++;
+    b++;
+  }
+  return *a == *b;
+}
+
+template <size_t N> class FixedString {
+public:
+  FixedString() { clear(); }
+  explicit FixedString(const char *s) {
+    clear();
+    append(s);
+  }
+
+  void clear() {
+    len = 0;
+    buf[0] = '\0';
+    truncated = false;
+  }
+
+  bool append(const char *s) {
+    while (*s) {
+      if (!append(*s++)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool append(char c) {
+    if (len + 1 >= N) {
+      truncated = true;
+      return false;
+    }
+    buf[len++] = c;
+    buf[len] = '\0';
+    return true;
+  }
+
+  // printf-style bounded append; truncation sets the failed state like
+  // any other overflowing append.
+  bool appendFormat(const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    int wrote = vsnprintf(buf + len, N - len, fmt, args);
+    va_end(args);
+    if (wrote < 0 || (size_t)wrote >= N - len) {
+      truncated = true;
+      buf[len] = '\0'; // Drop the partial write
+      return false;
+    }
+    len += wrote;
+    return true;
+  }
+
+  const char *c_str() const { return buf; }
+  size_t length() const { return len; }
+  bool empty() const { return len == 0; }
+
+  // False once any append was truncated; the content is then incomplete.
+  bool ok() const { return !truncated; }
+
+  bool equals(const char *s) const { return strcmp(buf, s) == 0; }
+  bool equalsIgnoreCase(const char *s) const {
+    return strEqualsIgnoreCase(buf, s);
+  }
+
+private:
+  char buf[N];
+  size_t len;
+  bool truncated;
+};
+
+#endif // FIXED_STRING_H
@@ -0,0 +1,237 @@
+/*
+FlightRecorder.cpp - the ring, the circular file, and the replayer.
+
+Ring handoff mirrors the Log ring: the sense tick is the only writer of
+head, the flush task the only reader advancing tail, so no lock is
+needed. The file has no header; records carry monotonic timestamps, so
+the replayer finds the wrap point by looking for the one backwards jump.
+*/
+
+#include "FlightRecorder.h"
+
+#include <SD.h>
+
+#include "AudioSense.h"
+#include "LinkDebounce.h"
+#include "Log.h"
+#include "MusicPlayer.h"
+#include "SdArbiter.h"
+
+#define FLIGHT_FILE "FLIGHT.BIN"
+// ~48 minutes of trace at the 5 ms sense tick (14 B * 200/s = 2.8 KB/s).
+#define FLIGHT_FILE_MAX (8UL * 1024 * 1024)
+// Flush in ~4 KB batches so each write is one multi-sector burst.
+#define FLIGHT_FLUSH_RECORDS 288
+// Ring of ~1.4 s of slack between tick and flush task.
+#define FLIGHT_RING_SIZE 512
+// Replay records per scheduler pass; keeps each slice well under a ms.
+#define FLIGHT_REPLAY_SLICE 256
+
+extern float detectorThresholds[MAX_STATUES - 1]; // AudioSense.ino
+extern uint16_t tuneTransitionBufferMs;           // AudioSense.ino
+
+// DMAMEM (OCRAM): ~7 KB of trace ring. The sense tick writes one record
+// per pass - a cached-OCRAM store, nowhere near worth DTCM (placement
+// notes in MemMonitor.h). Head/tail indices stay in DTCM above the
+// startup's bss clear; the ring body needs no zeroing.
+DMAMEM static FlightRecord ring[FLIGHT_RING_SIZE];
+static volatile uint16_t ringHead = 0; // Written by the sense tick only
+static volatile uint16_t ringTail = 0; // Written by the flush task only
+static volatile uint32_t ringDropped = 0;
+static volatile bool recording = false;
+
+static FsFile flightFile;
+static uint32_t fileOffset = 0;
+
+// Replay state machine, advanced a slice at a time by the loop task.
+static bool replaying = false;
+static File replayFile;
+static uint32_t replayRemaining = 0;
+static LinkDebounce replayDebounce;
+static uint32_t replayRecords = 0;
+static uint32_t replayDivergent = 0;
+static uint32_t replayTransitions = 0;
+static uint32_t replayLastMs = 0;
+
+void flightRecorderSetEnabled(bool enabled) {
+  if (enabled == recording) {
+    return;
+  }
+  if (enabled) {
+    if (!musicReady()) {
+      LOG_WARN("recorder: SD not mounted");
+      return;
+    }
+    SD.remove(FLIGHT_FILE);
+    // Open through the SdFat layer so the circular file can be
+    // preallocated as one contiguous run: the wrap seek and every
+    // batch write become arithmetic instead of cluster-chain walks.
+    // If the card is too full to preallocate, recording still works,
+    // just with chained allocation.
+    flightFile = SD.sdfs.open(FLIGHT_FILE, O_RDWR | O_CREAT | O_TRUNC);
+    if (!flightFile.isOpen()) {
+      LOG_WARN("recorder: cannot open " FLIGHT_FILE);
+      return;
+    }
+    if (!flightFile.preAllocate(FLIGHT_FILE_MAX)) {
+      LOG_WARN("recorder: preallocation failed; trace may fragment");
+    }
+    fileOffset = 0;
+    ringHead = ringTail = 0;
+    ringDropped = 0;
+    recording = true;
+    LOG_INFO("recorder: armed");
+  } else {
+    recording = false;
+    if (flightFile.isOpen()) {
+      // No truncate on close: after a wrap the write cursor sits
+      // mid-file, and the reserved tail is reclaimed by the remove()
+      // on the next arming anyway.
+      flightFile.close();
+    }
+    LOG_INFO("recorder: disarmed (%lu dropped)", (unsigned long)ringDropped);
+  }
+}
+
+bool flightRecorderEnabled() { return recording; }
+
+void flightRecorderCapture(const float *signals, StatueMask mask) {
+  if (!recording) {
+    return;
+  }
+  uint16_t next = (uint16_t)((ringHead + 1) % FLIGHT_RING_SIZE);
+  if (next == ringTail) {
+    ringDropped = ringDropped + 1; // Flush task is behind; never block
+    return;
+  }
+  FlightRecord &rec = ring[ringHead];
+  rec.ms = millis();
+  for (int i = 0; i < MAX_STATUES - 1; i++) {
+    float m = signals[i];
+    if (m < 0.0f) {
+      m = 0.0f;
+    } else if (m > 1.0f) {
+      m = 1.0f;
+    }
+    rec.mag[i] = (uint16_t)(m * 65535.0f);
+  }
+  rec.mask = (uint8_t)mask;
+  rec.flags = 0;
+  ringHead = next;
+}
+
+// Copy a batch out of the ring and write it as one burst, wrapping the
+// file at its fixed size.
+static void flushBatch() {
+  static FlightRecord batch[FLIGHT_FLUSH_RECORDS];
+  uint16_t count = 0;
+  while (count < FLIGHT_FLUSH_RECORDS && ringTail != ringHead) {
+    batch[count++] = ring[ringTail];
+    ringTail = (uint16_t)((ringTail + 1) % FLIGHT_RING_SIZE);
+  }
+  if (count == 0) {
+    return;
+  }
+  size_t bytes = count * sizeof(FlightRecord);
+  if (fileOffset + bytes > FLIGHT_FILE_MAX) {
+    fileOffset = 0; // Wrap: oldest records get overwritten
+  }
+  flightFile.seekSet(fileOffset);
+  flightFile.write((const uint8_t *)batch, bytes);
+  flightFile.sync();
+  fileOffset += bytes;
+}
+
+// Run one slice of the replay: thresholded magnitudes through a fresh
+// debounce instance, counting where its mask disagrees with the recorded
+// one.
+static void replaySlice() {
+  FlightRecord rec;
+  for (int n = 0; n < FLIGHT_REPLAY_SLICE && replayRemaining > 0; n++) {
+    if (replayFile.read(&rec, sizeof(rec)) != sizeof(rec)) {
+      replayRemaining = 0;
+      break;
+    }
+    replayRemaining -= sizeof(rec);
+
+    // Records wrap at the circular-file boundary; a backwards timestamp
+    // jump marks the seam. Reset the debounce rather than feeding it a
+    // discontinuity.
+    if (replayRecords > 0 && rec.ms < replayLastMs) {
+      replayDebounce = LinkDebounce();
+    }
+    replayLastMs = rec.ms;
+
+    int detectorIndex = 0;
+    for (int statue_idx = 0; statue_idx < NUM_STATUES; statue_idx++) {
+      if (statue_idx == MY_STATUE_INDEX) {
+        continue;
+      }
+      float mag = rec.mag[detectorIndex] / 65535.0f;
+      bool detected = mag > detectorThresholds[detectorIndex];
+      LinkDebounceEvent event = replayDebounce.update(
+          statue_idx, detected, rec.ms, tuneTransitionBufferMs);
+      if (event != LINK_NO_CHANGE) {
+        replayTransitions++;
+      }
+      detectorIndex++;
+    }
+    if ((uint8_t)replayDebounce.stableMask != rec.mask) {
+      replayDivergent++;
+    }
+    replayRecords++;
+  }
+
+  if (replayRemaining == 0) {
+    replayFile.close();
+    replaying = false;
+    LOG_INFO("replay: %lu records, %lu transitions, %lu divergent",
+             (unsigned long)replayRecords, (unsigned long)replayTransitions,
+             (unsigned long)replayDivergent);
+  }
+}
+
+void flightRecorderStartReplay() {
+  if (replaying) {
+    return;
+  }
+  if (recording) {
+    flightRecorderSetEnabled(false); // Finish the trace first
+  }
+  replayFile = SD.open(FLIGHT_FILE);
+  if (!replayFile) {
+    LOG_WARN("replay: no " FLIGHT_FILE " on card");
+    return;
+  }
+  replayRemaining = replayFile.size() - (replayFile.size() % sizeof(FlightRecord));
+  replayDebounce = LinkDebounce();
+  replayRecords = replayDivergent = replayTransitions = 0;
+  replayLastMs = 0;
+  replaying = true;
+  LOG_INFO("replay: %lu bytes", (unsigned long)replayRemaining);
+}
+
+void flightRecorderLoop() {
+  if (replaying) {
+    // Replay reads the card too; same arbitration as the flush below.
+    if (sdIoBegin(SD_IO_RECORDER)) {
+      replaySlice();
+      sdIoEnd(SD_IO_RECORDER);
+    }
+    return;
+  }
+  if (!recording) {
+    return;
+  }
+  // Flush once a full batch is waiting so each write is one 4 KB burst.
+  // The arbiter (SdArbiter.h) can hold the batch for a pass while the
+  // streamer or the journal has the card; the ring keeps buffering.
+  uint16_t pending =
+      (uint16_t)((ringHead + FLIGHT_RING_SIZE - ringTail) % FLIGHT_RING_SIZE);
+  if (pending >= FLIGHT_FLUSH_RECORDS) {
+    if (sdIoBegin(SD_IO_RECORDER)) {
+      flushBatch();
+      sdIoEnd(SD_IO_RECORDER);
+    }
+  }
+}
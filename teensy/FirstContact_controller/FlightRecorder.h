@@ -0,0 +1,50 @@
+/*
+FlightRecorder: signal trace record-and-replay on the SD card.
+
+Intermittent false links happen once an hour and are gone before anyone
+reaches the OLED. When recording is armed (missing_link/recorder), every
+sense tick appends a compact binary record - timestamp, per-detector
+magnitude, stable link mask - to a RAM ring, and a scheduler task flushes
+whole batches into a fixed-size circular file on the SD card from loop
+context, the same context as the music streamer's fillLoop(), so the two
+card users never preempt each other.
+
+Replay feeds the recorded magnitudes back through the same LinkDebounce
+logic the sense tick runs, chunked across scheduler passes, and reports
+where the re-run diverges from what was recorded - so a 2 AM glitch
+becomes a bench reproduction the next morning.
+*/
+
+#ifndef FLIGHT_RECORDER_H
+#define FLIGHT_RECORDER_H
+
+#include <Arduino.h>
+
+#include "StatueConfig.h"
+
+// One record per sense tick while armed. Magnitudes are Q16 fractions of
+// full scale (the detectors read 0.0-1.0), halving the float size.
+struct __attribute__((packed)) FlightRecord {
+  uint32_t ms;                  // millis() at capture
+  uint16_t mag[MAX_STATUES - 1]; // Detector magnitudes, 65535 = 1.0
+  uint8_t mask;                 // Stable link mask at capture
+  uint8_t flags;                // Reserved
+};
+
+// Arm or disarm recording. Arming truncates the previous trace.
+void flightRecorderSetEnabled(bool enabled);
+bool flightRecorderEnabled();
+
+// ISR context (sense tick): append one record. Drops (and counts) when
+// the ring is full rather than ever blocking the tick.
+void flightRecorderCapture(const float *signals, StatueMask mask);
+
+// Scheduler task: flush batched records to the circular file, or advance
+// an in-progress replay by one slice.
+void flightRecorderLoop();
+
+// Start replaying the recorded trace through the debounce logic with the
+// CURRENT thresholds; progress and the divergence summary go to the log.
+void flightRecorderStartReplay();
+
+#endif // FLIGHT_RECORDER_H
@@ -0,0 +1,33 @@
+/*
+FreqRealloc: MQTT-coordinated dynamic frequency reallocation.
+
+When a band goes bad on-site (LED dimmer hash at 10 kHz was the unSCruz
+nightmare), fixing it used to mean editing the config and rebooting every
+statue. This module watches each detector's trained noise floor; when the
+floor has eaten the detection headroom for a confirmation interval, the
+statue proposes moving the affected frequency on missing_link/freq, the
+peers acknowledge, and the proposer commits a switch time on the shared
+clock - every statue retunes within the same millisecond (the
+compile-time coefficient tables make retuning a lookup) and the link
+debounce rides over the switch.
+
+The commit is published retained, so a statue that missed the exchange
+(rebooting, brief cable drop) picks the current plan up the moment it
+resubscribes. A config push from the Pi still overrides everything: it
+rewrites STATUE_FREQUENCIES and retunes, and the monitor starts over
+from there.
+*/
+
+#ifndef FREQ_REALLOC_H
+#define FREQ_REALLOC_H
+
+#include <Arduino.h>
+
+// Scheduler task: the interference monitor, the proposal state machine,
+// and the armed switch. Runs every 500 ms.
+void freqReallocLoop();
+
+// missing_link/freq handler, wired into the Messaging dispatch table.
+void handleFreqMsg(const char *payload, unsigned int length);
+
+#endif // FREQ_REALLOC_H
@@ -0,0 +1,326 @@
+/*
+FreqRealloc: interference monitor and reallocation protocol.
+
+Protocol on missing_link/freq (single topic, action field, like touch):
+  propose: {"action":"propose","from":"eros","statue":"elektra",
+            "freq":13831,"seq":3,"switch_ms":123456}
+  ack:     {"action":"ack","from":"ariel","seq":3}
+  commit:  {"action":"commit","statue":"elektra","freq":13831,
+            "seq":3,"switch_ms":123456}  (retained)
+
+The proposer commits once every peer has acked, or at the ack timeout
+with at least half of them - a statue that misses the exchange entirely
+is re-synced by the retained commit when it resubscribes, so a single
+dead statue cannot pin the ensemble to a jammed frequency.
+*/
+
+#include <ArduinoJson.h>
+
+#include "AudioSense.h"
+#include "FreqRealloc.h"
+#include "GoertzelTables.h"
+#include "Messaging.h"
+#include "NetClock.h"
+#include "StatueConfig.h"
+
+// A detector counts as jammed while its trained noise floor exceeds this
+// fraction of the configured threshold ceiling: the floor x margin
+// effective threshold has saturated and detection headroom is gone.
+#define INTERFERENCE_FLOOR_RATIO 0.5f
+
+// The floor must stay saturated this long before we propose. Interference
+// that comes and goes (someone keying a radio) is not worth a retune.
+#define INTERFERENCE_CONFIRM_MS 10000
+
+// How long the proposer waits for acks before deciding with what it has.
+#define FREQ_ACK_TIMEOUT_MS 1500
+
+// Lead time between commit and the synchronized switch, enough for the
+// commit to reach every statue with margin on the event LAN.
+#define FREQ_SWITCH_LEAD_MS 1500
+
+// Minimum pause between proposals from this statue, so a band-wide noise
+// source (broken dimmer sweeping the spectrum) cannot trigger a storm.
+#define FREQ_PROPOSE_COOLDOWN_MS 30000
+
+// Replacement slots keep this distance from every other statue frequency
+// and from the pairwise third-order intermod products the guard bins
+// watch (GoertzelBank.h), so a move never lands on a predicted ghost.
+#define FREQ_MIN_SEPARATION_HZ 800
+#define FREQ_IMD_SEPARATION_HZ 300
+
+// And this distance from the jammed frequency itself: on-site noise
+// sources (dimmers, switching supplies) are band-limited but not narrow.
+#define FREQ_JAM_CLEARANCE_HZ 1500
+
+// Per-detector interference onset (0 = not currently saturated).
+static uint32_t interferenceSinceMs[MAX_STATUES - 1] = {0};
+static uint32_t lastProposalMs = 0;
+
+// In-flight proposal (proposer role).
+static bool proposePending = false;
+static uint8_t proposeStatue = 0;
+static int proposeFreq = 0;
+static uint32_t proposeSeq = 0;
+static uint32_t proposeSentMs = 0;
+static StatueMask proposeAckMask = 0;
+
+// Armed switch (all roles). Applied when the shared clock reaches
+// switchAtMs; an already-past time (retained replay) applies immediately.
+static bool switchPending = false;
+static uint8_t switchStatue = 0;
+static int switchFreq = 0;
+static uint64_t switchAtMs = 0;
+static uint32_t lastAppliedSeq = 0;
+
+static int statueIndexByName(const char *name) {
+  for (int i = 0; i < NUM_STATUES; i++) {
+    if (strcasecmp(name, STATUE_NAMES[i]) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+// Statue index a detector slot listens for (detectors skip our own slot).
+static uint8_t statueForDetector(int detectorIndex) {
+  int det = 0;
+  for (int statue_idx = 0; statue_idx < NUM_STATUES; statue_idx++) {
+    if (statue_idx != MY_STATUE_INDEX) {
+      if (det == detectorIndex) {
+        return (uint8_t)statue_idx;
+      }
+      det++;
+    }
+  }
+  return 0;
+}
+
+// True if `freq` keeps clear of every statue staying put and of the
+// third-order intermod products between them.
+static bool slotIsClear(int freq, uint8_t movingStatue) {
+  for (int a = 0; a < NUM_STATUES; a++) {
+    if (a == movingStatue) {
+      continue;
+    }
+    if (abs(freq - STATUE_FREQUENCIES[a]) < FREQ_MIN_SEPARATION_HZ) {
+      return false;
+    }
+    for (int b = 0; b < NUM_STATUES; b++) {
+      if (b == movingStatue || b == a) {
+        continue;
+      }
+      int imd = 2 * STATUE_FREQUENCIES[a] - STATUE_FREQUENCIES[b];
+      if (abs(freq - imd) < FREQ_IMD_SEPARATION_HZ) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Pick a replacement slot for `statue`. The scan walks the coefficient
+// grid bottom-up in a prime-ish stride (lower frequencies lose less to
+// the ~0.5 dB/kHz cable attenuation, the odd stride dodges harmonic
+// ratios with the survivors). We cannot hear the noise at the candidate
+// without a sweep, so the pick only guarantees separation; if the new
+// slot turns out noisy too, the monitor simply moves it again.
+static int pickReplacementFreq(uint8_t statue) {
+  const int jammed = STATUE_FREQUENCIES[statue];
+  const int maxHz =
+      GOERTZEL_GRID_MIN_HZ + (GOERTZEL_GRID_COUNT - 1) * GOERTZEL_GRID_STEP_HZ;
+  for (int f = 9001; f <= maxHz; f += 347) {
+    if (abs(f - jammed) < FREQ_JAM_CLEARANCE_HZ) {
+      continue;
+    }
+    if (slotIsClear(f, statue)) {
+      return f;
+    }
+  }
+  return -1;
+}
+
+// Retune to the armed plan. Every statue runs this at the same shared
+// clock millisecond; the retune itself is coefficient-table lookups, so
+// the detection gap is well inside the link debounce window.
+static void applySwitch() {
+  STATUE_FREQUENCIES[switchStatue] = switchFreq;
+  if (switchStatue == (uint8_t)MY_STATUE_INDEX) {
+    MY_TX_FREQ = switchFreq;
+  }
+  retuneAudioSense();
+
+  // The floor trained at the old frequency means nothing at the new one.
+  int det = 0;
+  for (int statue_idx = 0; statue_idx < NUM_STATUES; statue_idx++) {
+    if (statue_idx != MY_STATUE_INDEX) {
+      if (statue_idx == switchStatue) {
+        audioSenseResetNoiseFloor(det);
+        interferenceSinceMs[det] = 0;
+      }
+      det++;
+    }
+  }
+
+  switchPending = false;
+  Serial.printf("Freq realloc: %s now at %d Hz\n", STATUE_NAMES[switchStatue],
+                switchFreq);
+}
+
+static void sendCommit() {
+  char json[192];
+  snprintf(json, sizeof(json),
+           "{\"action\":\"commit\",\"statue\":\"%s\",\"freq\":%d,"
+           "\"seq\":%lu,\"switch_ms\":%lu}",
+           STATUE_NAMES_LC[proposeStatue], proposeFreq,
+           (unsigned long)proposeSeq, (unsigned long)switchAtMs);
+  client.publish(ringTopic("missing_link/freq"), (const uint8_t *)json, strlen(json),
+                 true);
+
+  // Arm our own switch directly; the echoed commit is deduped by seq.
+  switchPending = true;
+  switchStatue = proposeStatue;
+  switchFreq = proposeFreq;
+  lastAppliedSeq = proposeSeq;
+  proposePending = false;
+  lastProposalMs = millis();
+}
+
+static void sendProposal(uint8_t statue) {
+  int freq = pickReplacementFreq(statue);
+  if (freq < 0) {
+    Serial.printf("Freq realloc: no clear slot for %s; staying put\n",
+                  STATUE_NAMES[statue]);
+    lastProposalMs = millis(); // Cooldown anyway; the band is just full
+    return;
+  }
+
+  proposePending = true;
+  proposeStatue = statue;
+  proposeFreq = freq;
+  proposeSeq = (uint32_t)millis() ^ ((uint32_t)MY_STATUE_INDEX << 28);
+  proposeSentMs = millis();
+  proposeAckMask = 0;
+  switchAtMs = netClockSynced() ? sharedClockMs() + FREQ_SWITCH_LEAD_MS : 0;
+
+  char json[224];
+  snprintf(json, sizeof(json),
+           "{\"action\":\"propose\",\"from\":\"%s\",\"statue\":\"%s\","
+           "\"freq\":%d,\"seq\":%lu,\"switch_ms\":%lu}",
+           MY_STATUE_NAME_LC, STATUE_NAMES_LC[statue], freq,
+           (unsigned long)proposeSeq, (unsigned long)switchAtMs);
+  client.publish(ringTopic("missing_link/freq"), json);
+  Serial.printf("Freq realloc: proposing %s %d -> %d Hz\n",
+                STATUE_NAMES[statue], STATUE_FREQUENCIES[statue], freq);
+}
+
+void handleFreqMsg(const char *payload, unsigned int length) {
+  StaticJsonDocument<256> doc;
+  if (deserializeJson(doc, payload, length) != DeserializationError::Ok) {
+    return;
+  }
+  const char *action = doc["action"] | "";
+
+  if (strcmp(action, "propose") == 0) {
+    const char *from = doc["from"] | "";
+    if (strcasecmp(from, MY_STATUE_NAME) == 0) {
+      return; // Our own proposal echoed back
+    }
+    char json[96];
+    snprintf(json, sizeof(json), "{\"action\":\"ack\",\"from\":\"%s\",\"seq\":%lu}",
+             MY_STATUE_NAME_LC, (unsigned long)(doc["seq"] | 0ul));
+    client.publish(ringTopic("missing_link/freq"), json);
+
+  } else if (strcmp(action, "ack") == 0) {
+    if (!proposePending || (uint32_t)(doc["seq"] | 0ul) != proposeSeq) {
+      return;
+    }
+    int idx = statueIndexByName(doc["from"] | "");
+    if (idx >= 0) {
+      proposeAckMask |= (StatueMask)(1 << idx);
+    }
+
+  } else if (strcmp(action, "commit") == 0) {
+    uint32_t seq = doc["seq"] | 0ul;
+    if (seq == lastAppliedSeq) {
+      return; // Our own commit echoed, or a retained replay already applied
+    }
+    int idx = statueIndexByName(doc["statue"] | "");
+    int freq = doc["freq"] | 0;
+    const int maxHz = GOERTZEL_GRID_MIN_HZ +
+                      (GOERTZEL_GRID_COUNT - 1) * GOERTZEL_GRID_STEP_HZ;
+    if (idx < 0 || freq < GOERTZEL_GRID_MIN_HZ || freq > maxHz) {
+      return;
+    }
+    lastAppliedSeq = seq;
+    if (STATUE_FREQUENCIES[idx] == freq) {
+      return; // Already on this plan (retained replay after reconnect)
+    }
+    switchPending = true;
+    switchStatue = (uint8_t)idx;
+    switchFreq = freq;
+    switchAtMs = doc["switch_ms"] | 0ul;
+    proposePending = false; // A concurrent commit wins over our proposal
+  }
+}
+
+void freqReallocLoop() {
+  // Armed switch first: fire at the shared-clock time, or immediately
+  // when the clock is unsynced or the time is already past (retained
+  // replay) - late alone beats wrong-frequency forever.
+  if (switchPending &&
+      (!netClockSynced() || sharedClockMs() >= switchAtMs)) {
+    applySwitch();
+  }
+
+  if (proposePending) {
+    StatueMask expected = 0;
+    for (int i = 0; i < NUM_STATUES; i++) {
+      if (i != MY_STATUE_INDEX) {
+        expected |= (StatueMask)(1 << i);
+      }
+    }
+    int ackCount = __builtin_popcount(proposeAckMask);
+    if (proposeAckMask == expected) {
+      sendCommit();
+    } else if (millis() - proposeSentMs > FREQ_ACK_TIMEOUT_MS) {
+      if (2 * ackCount >= NUM_STATUES - 1) {
+        // Enough of the ensemble heard us; the retained commit re-syncs
+        // whoever is missing when it comes back.
+        sendCommit();
+      } else {
+        Serial.printf("Freq realloc: proposal timed out (%d acks)\n",
+                      ackCount);
+        proposePending = false;
+        lastProposalMs = millis();
+      }
+    }
+    return; // One proposal in flight at a time
+  }
+  if (switchPending) {
+    return; // Do not re-diagnose mid-switch
+  }
+
+  // Interference monitor: a saturated noise floor on an unlinked detector
+  // means the band is jammed (contact signal never trains the floor).
+  uint32_t now = millis();
+  ContactState state = getContactState();
+  for (int det = 0; det < NUM_STATUES - 1; det++) {
+    uint8_t statue = statueForDetector(det);
+    bool jammed = !state.isLinkedTo(statue) &&
+                  audioSenseNoiseFloor(det) >
+                      audioSenseThresholdCeiling(det) * INTERFERENCE_FLOOR_RATIO;
+    if (!jammed) {
+      interferenceSinceMs[det] = 0;
+      continue;
+    }
+    if (interferenceSinceMs[det] == 0) {
+      interferenceSinceMs[det] = now;
+    } else if (now - interferenceSinceMs[det] >= INTERFERENCE_CONFIRM_MS &&
+               (lastProposalMs == 0 ||
+                now - lastProposalMs >= FREQ_PROPOSE_COOLDOWN_MS)) {
+      sendProposal(statue);
+      return;
+    }
+  }
+}
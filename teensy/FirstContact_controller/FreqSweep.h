@@ -0,0 +1,35 @@
+/*
+FreqSweep: On-device frequency sweep self-test.
+
+Replaces the laptop + USB dongle `make freq-sweep` workflow with an in-situ
+sweep through the real hands, cables, and SGTL5000 front end. One statue is
+told (over MQTT) to step its sense tone through a frequency range; for each
+step it announces the frequency on missing_link/sweep/step, peer statues
+retune a probe detector to that frequency, and after the dwell they publish
+their received magnitude on missing_link/sweep/report. The result is an
+attenuation-vs-frequency table per statue pair, collected on the Pi.
+
+Sweep command payload (missing_link/sweep/cmd, addressed by "statue"):
+  {"statue":"eros","start":5000,"stop":20000,"step":250,"dwell_ms":200}
+*/
+
+#ifndef FREQ_SWEEP_H
+#define FREQ_SWEEP_H
+
+#include <Arduino.h>
+
+// TX side: start sweeping our own tone through [startHz, stopHz].
+void startFrequencySweep(int startHz, int stopHz, int stepHz, int dwellMs);
+void stopFrequencySweep();
+
+// RX side: handle a peer's step announcement / sweep end.
+void handleSweepStep(const char *fromStatue, int freq);
+void handleSweepEnd();
+
+// Drive the sweep state machine; called from loop().
+void sweepLoop();
+
+// True while this statue is transmitting a sweep or probing a peer's.
+bool isSweepActive();
+
+#endif // FREQ_SWEEP_H
@@ -0,0 +1,119 @@
+/*
+FreqSweep: On-device frequency sweep self-test state machine.
+*/
+
+#include "AudioSense.h"
+#include "FreqSweep.h"
+#include "Messaging.h"
+#include "StatueConfig.h"
+
+// Sweep state. TX and RX roles are mutually exclusive: the sweeping statue
+// steps its tone, everyone else probes.
+static bool txActive = false;
+static bool rxActive = false;
+static int sweepStartHz = 0;
+static int sweepStopHz = 0;
+static int sweepStepHz = 0;
+static int sweepDwellMs = 0;
+static int sweepCurrentHz = 0;
+static unsigned long sweepStepStartMs = 0;
+static char sweepPeer[10] = ""; // Statue currently sweeping (RX side)
+static int probeFreq = 0;       // Frequency we are probing (RX side)
+
+bool isSweepActive() { return txActive || rxActive; }
+
+void startFrequencySweep(int startHz, int stopHz, int stepHz, int dwellMs) {
+  if (stepHz <= 0 || stopHz <= startHz) {
+    Serial.println("Sweep: rejected bad range");
+    return;
+  }
+  txActive = true;
+  rxActive = false;
+  sweepStartHz = startHz;
+  sweepStopHz = stopHz;
+  sweepStepHz = stepHz;
+  sweepDwellMs = dwellMs > 0 ? dwellMs : 200;
+  sweepCurrentHz = startHz;
+  sweepStepStartMs = 0; // Force the first step immediately
+  Serial.printf("Sweep: TX %d-%d Hz, step %d, dwell %d ms\n", startHz, stopHz,
+                stepHz, sweepDwellMs);
+}
+
+void stopFrequencySweep() {
+  if (txActive) {
+    // Tell the peers to restore their detectors, then restore our tone.
+    client.publish(ringTopic("missing_link/sweep/end"), MY_STATUE_NAME);
+    setSenseToneFrequency(MY_TX_FREQ);
+    txActive = false;
+    Serial.println("Sweep: TX finished, tone restored");
+  }
+}
+
+void handleSweepStep(const char *fromStatue, int freq) {
+  // Ignore our own step announcements.
+  if (strcasecmp(fromStatue, MY_STATUE_NAME) == 0) {
+    return;
+  }
+  rxActive = true;
+  // Store lowercased once; the per-step report publisher reads it as-is.
+  size_t n = 0;
+  for (; fromStatue[n] != '\0' && n < sizeof(sweepPeer) - 1; n++) {
+    sweepPeer[n] = (char)tolower((unsigned char)fromStatue[n]);
+  }
+  sweepPeer[n] = '\0';
+  probeFreq = freq;
+  tuneSweepProbe(freq);
+  // Report after the probe window has filled; reuse the dwell pacing by
+  // timestamping here and publishing from sweepLoop().
+  sweepStepStartMs = millis();
+}
+
+void handleSweepEnd() {
+  if (rxActive) {
+    rxActive = false;
+    probeFreq = 0;
+    // Restore the normal detector bank and its configured thresholds.
+    configureDetectors();
+    updateDetectorThresholds();
+    Serial.println("Sweep: RX finished, detectors restored");
+  }
+}
+
+// Publish one RX measurement for the current probe frequency.
+static void publishSweepReport() {
+  char jsonMsg[128];
+  snprintf(jsonMsg, sizeof(jsonMsg),
+           "{\"from\":\"%s\",\"at\":\"%s\",\"freq\":%d,\"magnitude\":%.4f}",
+           sweepPeer, MY_STATUE_NAME_LC, probeFreq, readSweepProbe());
+  client.publish(ringTopic("missing_link/sweep/report"), jsonMsg);
+}
+
+void sweepLoop() {
+  unsigned long now = millis();
+
+  if (txActive) {
+    if (sweepStepStartMs != 0 && now - sweepStepStartMs < (unsigned long)sweepDwellMs) {
+      return;
+    }
+    if (sweepCurrentHz > sweepStopHz) {
+      stopFrequencySweep();
+      return;
+    }
+
+    // Advance the tone and announce the step so peers can retune.
+    setSenseToneFrequency(sweepCurrentHz);
+    char jsonMsg[96];
+    snprintf(jsonMsg, sizeof(jsonMsg), "{\"statue\":\"%s\",\"freq\":%d}",
+             MY_STATUE_NAME_LC, sweepCurrentHz);
+    client.publish(ringTopic("missing_link/sweep/step"), jsonMsg);
+
+    sweepStepStartMs = now;
+    sweepCurrentHz += sweepStepHz;
+  } else if (rxActive && probeFreq != 0) {
+    // Let the probe window fill for ~half the dwell before reporting.
+    if (now - sweepStepStartMs >= 100) {
+      publishSweepReport();
+      probeFreq = 0; // One report per step
+    }
+  }
+}
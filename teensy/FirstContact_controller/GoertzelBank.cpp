@@ -0,0 +1,436 @@
+/*
+GoertzelBank.cpp - Single-pass multi-frequency Goertzel implementation
+
+Fixed-point kernel notes:
+  - The recurrence q0 = coeff*q1 - q2 + x is serial in each channel, so the
+    dual 16x16 SMLAD form does not apply across samples. Instead the
+    coefficient multiply uses SMULWB (32x16 -> top 32 bits, single cycle on
+    the M7), and the independent left/right chains are interleaved so both
+    can be in flight in the dual-issue pipeline.
+  - Samples are scaled from Q15 into Q1.30/2^GUARD_BITS before accumulation.
+    With GUARD_BITS = 9 a full-scale tone cannot overflow int32 over one
+    128-sample segment.
+
+Sliding-window notes:
+  - Each 128-sample segment produces a complex bin value via the standard
+    Goertzel extraction (re = q1 - q2*cos, im = q2*sin). The full-window bin
+    is the twiddle-rotated sum of the last `segments` segment bins:
+        X_window = sum_p X_seg[p] * W^p,  W = e^(-j*2*pi*f*128/fs)
+    with p counted from the oldest segment. The combine runs once per block
+    per detector (a few dozen complex MACs), so the per-sample cost of the
+    kernel is unchanged while a fresh full-window magnitude appears every
+    block instead of every sample_time_ms.
+
+Hann weighting notes:
+  - Weighting happens in the combine, not the kernel: each segment's complex
+    contribution is scaled by a Hann coefficient for its position in the
+    window, evaluated at the segment's center so the end segments are not
+    zeroed out on short windows. This is the true Hann window quantized to
+    128-sample steps - the approximation error falls off with window length
+    and is irrelevant next to the ~30 dB the weighting buys over
+    rectangular's -13 dB sidelobes.
+  - Normalization divides by the weight sum instead of the segment count, so
+    a full-scale on-bin tone still reads the same magnitude under either
+    window and the configured thresholds need no retuning.
+
+Decimation notes:
+  - Low bins (<= GOERTZEL_DIV2_MAX_HZ) run on a shared decimate-by-2 stream:
+    the halfband FIR from GoertzelTables.h filters the block once per
+    channel (six multiplies per output thanks to symmetry and the zero odd
+    taps), and the decimated kernel then advances those bins over 64 samples
+    instead of 128. Break-even against the full-rate kernel is about three
+    decimated bins; a low transmit pair with its guard family enables six.
+  - A decimated segment still spans one block of wall time, and the fs/2
+    twiddle over 64 samples equals the full-rate twiddle over 128, so the
+    segment ring and window combine are shared untouched. finishSegment only
+    normalizes by the segment's own sample count and applies the per-bin
+    droop compensation baked into the decimated table.
+  - Aliasing: images of the decimated slice land at 13250-17050 Hz, where
+    the halfband is 20-68 dB down; the statue tones that actually live there
+    fold in at least 35 dB below a genuine contact. Energy folded onto a
+    guard bin is vetoed, not trusted, so the residue is harmless there too.
+*/
+
+#include "GoertzelBank.h"
+#include "GoertzelTables.h"
+#include "LatencyMarkers.h"
+
+#include <math.h>
+#include <string.h>
+
+// Headroom so the Q1.30 accumulators cannot overflow over one segment.
+#define GUARD_BITS 9
+
+static_assert(GOERTZEL_HB_HIST == GOERTZEL_HB_TAPS - 1,
+              "halfband history length must match the tap table");
+
+// coeff*q1 with coeff in Q14: SMULWB computes (q1 * coeff) >> 16, so shift
+// back up by 2 to restore the Q14 scaling.
+static inline int32_t coeffMul(int32_t q1, int16_t coeffQ14) {
+#if defined(__ARM_ARCH_7EM__)
+  return ((int32_t)__SMULWB((uint32_t)q1, (uint32_t)(uint16_t)coeffQ14)) << 2;
+#else
+  // Host/simulation fallback: plain 64-bit multiply.
+  return (int32_t)(((int64_t)q1 * coeffQ14) >> 14);
+#endif
+}
+
+// Rebuild a detector's combine weights for a window of `segments` segments.
+// Runs at (re)configure time, never per sample, so runtime trig is fine
+// here - unlike the kernel coefficients there is no cross-statue
+// quantization to cancel. Called before the segment ring is reset, so a
+// torn read from the audio ISR at worst smears one block that the reset
+// discards anyway.
+void AudioAnalyzeGoertzelBank::buildWindow(GoertzelDetector &d,
+                                           uint8_t segments) {
+  float sum = 0.0f;
+  for (int p = 0; p < segments; p++) {
+    float w = 1.0f;
+    if (d.hann) {
+      // Hann evaluated at the segment center: w = 0.5*(1 - cos(2*pi*x)).
+      float x = ((float)p + 0.5f) / (float)segments;
+      w = 0.5f * (1.0f - cosf(2.0f * (float)M_PI * x));
+    }
+    d.winWeight[p] = w;
+    sum += w;
+  }
+  d.winSum = sum;
+}
+
+void AudioAnalyzeGoertzelBank::frequency(uint8_t det, float freq,
+                                         uint16_t cycles) {
+  if (det >= GOERTZEL_NUM_BINS) {
+    return;
+  }
+  GoertzelDetector &d = detectors[det];
+
+  // Same length derivation as AudioAnalyzeToneDetect (an integer number of
+  // cycles of the target frequency), then rounded to whole blocks for the
+  // segment ring.
+  uint32_t length = (uint32_t)(cycles * AUDIO_SAMPLE_RATE_EXACT / freq + 0.5f);
+  uint32_t segments = (length + AUDIO_BLOCK_SAMPLES / 2) / AUDIO_BLOCK_SAMPLES;
+  if (segments < 1) {
+    segments = 1;
+  }
+  if (segments > GOERTZEL_MAX_SEGMENTS) {
+    segments = GOERTZEL_MAX_SEGMENTS;
+  }
+
+  // All coefficients come from the compile-time tables: re-tuning after a
+  // config push is a lookup, no trig on the hot path. The tone generators
+  // snap to the same grid, so the quantization cancels between statues.
+  // Low bins take the fs/2 table and run on the decimated stream.
+  int idx = goertzelGridIndex(freq);
+  bool decimated = (idx < GOERTZEL_DIV2_COUNT && freq <= GOERTZEL_DIV2_MAX_HZ);
+  const GoertzelCoeffs &coeffs = decimated
+                                     ? GOERTZEL_DIV2_TABLE.entries[idx].c
+                                     : GOERTZEL_TABLE.entries[idx];
+  float magScale = decimated ? GOERTZEL_DIV2_TABLE.entries[idx].gain : 1.0f;
+
+  buildWindow(d, segments);
+
+  __disable_irq();
+  d.coeff = coeffs.coeff;
+  d.coeffQ14 = coeffs.coeffQ14;
+  d.cosTheta = coeffs.cosTheta;
+  d.sinTheta = coeffs.sinTheta;
+  d.rotRe = coeffs.rotRe;
+  d.rotIm = coeffs.rotIm;
+  d.segSamples = decimated ? GOERTZEL_DIV2_SAMPLES : AUDIO_BLOCK_SAMPLES;
+  d.magScale = magScale;
+  d.segments = segments;
+  d.segIndex = 0;
+  d.left.q1 = d.left.q2 = 0;
+  d.right.q1 = d.right.q2 = 0;
+  for (int p = 0; p < GOERTZEL_MAX_SEGMENTS; p++) {
+    d.left.segRe[p] = d.left.segIm[p] = 0.0f;
+    d.right.segRe[p] = d.right.segIm[p] = 0.0f;
+  }
+  d.enabled = true;
+  __enable_irq();
+}
+
+float AudioAnalyzeGoertzelBank::read(uint8_t det, uint8_t channel) {
+  if (det >= GOERTZEL_NUM_BINS || !detectors[det].enabled) {
+    return 0.0f;
+  }
+  __disable_irq();
+  float out =
+      (channel == 0) ? detectors[det].outLeft : detectors[det].outRight;
+  __enable_irq();
+  return out;
+}
+
+float AudioAnalyzeGoertzelBank::readPhase(uint8_t det, uint8_t channel) {
+  if (det >= GOERTZEL_NUM_BINS || !detectors[det].enabled) {
+    return 0.0f;
+  }
+  __disable_irq();
+  float phase =
+      (channel == 0) ? detectors[det].phaseLeft : detectors[det].phaseRight;
+  __enable_irq();
+  return phase;
+}
+
+float AudioAnalyzeGoertzelBank::channelPower(uint8_t channel) {
+  return (channel < 2) ? avgPower[channel] : 0.0f;
+}
+
+void AudioAnalyzeGoertzelBank::setGate(uint8_t det, bool gated) {
+  if (det >= GOERTZEL_NUM_BINS) {
+    return;
+  }
+  detectors[det].gated = gated;
+}
+
+void AudioAnalyzeGoertzelBank::setWindowSegments(uint8_t det,
+                                                 uint8_t segments) {
+  if (det >= GOERTZEL_NUM_BINS || !detectors[det].enabled) {
+    return;
+  }
+  if (segments < 1) {
+    segments = 1;
+  }
+  if (segments > GOERTZEL_MAX_SEGMENTS) {
+    segments = GOERTZEL_MAX_SEGMENTS;
+  }
+  GoertzelDetector &d = detectors[det];
+  if (d.segments == segments) {
+    return;
+  }
+
+  buildWindow(d, segments);
+
+  // Restart the ring: changing the modulo mid-stream would scramble the
+  // oldest-first twiddle ordering. The window refills within `segments`
+  // blocks (a few ms for the short window).
+  __disable_irq();
+  d.segments = segments;
+  d.segIndex = 0;
+  for (int p = 0; p < GOERTZEL_MAX_SEGMENTS; p++) {
+    d.left.segRe[p] = d.left.segIm[p] = 0.0f;
+    d.right.segRe[p] = d.right.segIm[p] = 0.0f;
+  }
+  __enable_irq();
+}
+
+void AudioAnalyzeGoertzelBank::setHannWindow(uint8_t det, bool enabled) {
+  if (det >= GOERTZEL_NUM_BINS || !detectors[det].enabled) {
+    return;
+  }
+  GoertzelDetector &d = detectors[det];
+  if (d.hann == enabled) {
+    return;
+  }
+  d.hann = enabled;
+  buildWindow(d, d.segments);
+
+  // Restart the ring: re-weighting segments accumulated under the old
+  // window would skew the magnitude until they age out.
+  __disable_irq();
+  d.segIndex = 0;
+  for (int p = 0; p < GOERTZEL_MAX_SEGMENTS; p++) {
+    d.left.segRe[p] = d.left.segIm[p] = 0.0f;
+    d.right.segRe[p] = d.right.segIm[p] = 0.0f;
+  }
+  __enable_irq();
+}
+
+void AudioAnalyzeGoertzelBank::disable(uint8_t det) {
+  if (det >= GOERTZEL_NUM_BINS) {
+    return;
+  }
+  detectors[det].enabled = false;
+}
+
+// A 128-sample segment is complete: extract its complex bin value into the
+// ring, then rotate-and-sum the ring into the full-window magnitude. Float
+// is fine here; this runs once per block, not per sample.
+//
+// FASTRUN here and on update(): ITCM is already the Teensy 4 default, but
+// the placement pass moves cold code to flash (FLASHMEM), so the audio
+// kernels carry the explicit annotation that they must never follow.
+FASTRUN void AudioAnalyzeGoertzelBank::finishSegment(GoertzelDetector &d) {
+  // Undo the input scaling: samples entered as Q15 << (15 - GUARD_BITS).
+  const float unscale = 1.0f / (float)(1 << (15 - GUARD_BITS));
+
+  GoertzelChannel *channels[2] = {&d.left, &d.right};
+  float outs[2];
+  float phases[2];
+
+  for (int c = 0; c < 2; c++) {
+    GoertzelChannel &ch = *channels[c];
+
+    // Standard Goertzel complex extraction for this segment.
+    float q1 = (float)ch.q1 * unscale;
+    float q2 = (float)ch.q2 * unscale;
+    ch.segRe[d.segIndex] = q1 - q2 * d.cosTheta;
+    ch.segIm[d.segIndex] = q2 * d.sinTheta;
+    ch.q1 = ch.q2 = 0;
+
+    // Combine the last `segments` segments, oldest first, advancing the
+    // twiddle by one segment each step and scaling each segment by its
+    // window weight (all 1.0 for the rectangular window).
+    float sumRe = 0.0f, sumIm = 0.0f;
+    float wRe = 1.0f, wIm = 0.0f;
+    int p = (d.segIndex + 1) % d.segments; // Oldest slot in the ring
+    for (int n = 0; n < d.segments; n++) {
+      float win = d.winWeight[n];
+      sumRe += (ch.segRe[p] * wRe - ch.segIm[p] * wIm) * win;
+      sumIm += (ch.segRe[p] * wIm + ch.segIm[p] * wRe) * win;
+      float tmp = wRe * d.rotRe - wIm * d.rotIm;
+      wIm = wRe * d.rotIm + wIm * d.rotRe;
+      wRe = tmp;
+      p = (p + 1) % d.segments;
+    }
+
+    // Normalization matches AudioAnalyzeToneDetect: magnitude relative to a
+    // full-scale sine integrated over the whole window. The weight sum is
+    // the effective window length (in this bin's own sample rate), so the
+    // windowed magnitude stays on the same 0-1 scale as the rectangular
+    // one; magScale folds the halfband droop back out for decimated bins.
+    float windowLen = d.winSum * (float)d.segSamples;
+    float scale = 2.0f * d.magScale / (32767.0f * windowLen);
+    outs[c] = sqrtf(sumRe * sumRe + sumIm * sumIm) * scale;
+    phases[c] = atan2f(sumIm, sumRe);
+  }
+
+  d.outLeft = outs[0];
+  d.outRight = outs[1];
+  d.phaseLeft = phases[0];
+  d.phaseRight = phases[1];
+  d.segIndex = (d.segIndex + 1) % d.segments;
+}
+
+FASTRUN void AudioAnalyzeGoertzelBank::update(void) {
+  audio_block_t *blockLeft = receiveReadOnly(0);
+  audio_block_t *blockRight = receiveReadOnly(1);
+  if (!blockLeft || !blockRight) {
+    if (blockLeft)
+      release(blockLeft);
+    if (blockRight)
+      release(blockRight);
+    return;
+  }
+
+  // One pass over the block: the outer loop walks samples, the inner loop
+  // advances every enabled accumulator for both channels. This keeps each
+  // sample in registers while all detectors consume it, instead of walking
+  // the block once per AudioAnalyzeToneDetect object.
+  uint64_t energyLeft = 0, energyRight = 0;
+
+  for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+    int32_t rawLeft = (int32_t)blockLeft->data[i];
+    int32_t rawRight = (int32_t)blockRight->data[i];
+    int32_t sampleLeft = rawLeft << (15 - GUARD_BITS);
+    int32_t sampleRight = rawRight << (15 - GUARD_BITS);
+
+    // Total block energy feeds the per-channel power estimate for SNR.
+    energyLeft += (uint64_t)((int64_t)rawLeft * rawLeft);
+    energyRight += (uint64_t)((int64_t)rawRight * rawRight);
+
+    for (int det = 0; det < GOERTZEL_NUM_BINS; det++) {
+      GoertzelDetector &d = detectors[det];
+      if (!d.enabled || d.gated || d.segSamples != AUDIO_BLOCK_SAMPLES) {
+        continue;
+      }
+
+      // Interleave the two independent recurrences for dual-issue overlap.
+      int32_t q0L = coeffMul(d.left.q1, d.coeffQ14) - d.left.q2 + sampleLeft;
+      int32_t q0R = coeffMul(d.right.q1, d.coeffQ14) - d.right.q2 + sampleRight;
+      d.left.q2 = d.left.q1;
+      d.right.q2 = d.right.q1;
+      d.left.q1 = q0L;
+      d.right.q1 = q0R;
+    }
+  }
+
+  // Second pass for the low bins: halfband-filter the block down to fs/2,
+  // then advance their recurrences over the 64 decimated samples. The
+  // filter (and its history) only runs while a decimated bin is live.
+  bool anyDecimated = false;
+  for (int det = 0; det < GOERTZEL_NUM_BINS; det++) {
+    GoertzelDetector &d = detectors[det];
+    if (d.enabled && !d.gated && d.segSamples == GOERTZEL_DIV2_SAMPLES) {
+      anyDecimated = true;
+      break;
+    }
+  }
+
+  if (anyDecimated) {
+    // Contiguous view of history + this block, so the filter never wraps.
+    int16_t ext[2][GOERTZEL_HB_HIST + AUDIO_BLOCK_SAMPLES];
+    memcpy(ext[0], dcmHist[0], sizeof(dcmHist[0]));
+    memcpy(ext[1], dcmHist[1], sizeof(dcmHist[1]));
+    memcpy(&ext[0][GOERTZEL_HB_HIST], blockLeft->data,
+           AUDIO_BLOCK_SAMPLES * sizeof(int16_t));
+    memcpy(&ext[1][GOERTZEL_HB_HIST], blockRight->data,
+           AUDIO_BLOCK_SAMPLES * sizeof(int16_t));
+
+    int32_t dec[2][GOERTZEL_DIV2_SAMPLES];
+    const int center = (GOERTZEL_HB_TAPS - 1) / 2;
+    for (int c = 0; c < 2; c++) {
+      for (int m = 0; m < GOERTZEL_DIV2_SAMPLES; m++) {
+        const int16_t *x = &ext[c][2 * m + center];
+        int32_t acc = (int32_t)GOERTZEL_HB_Q15[center] * x[0];
+        acc += (int32_t)GOERTZEL_HB_Q15[center - 1] *
+               ((int32_t)x[-1] + x[1]);
+        acc += (int32_t)GOERTZEL_HB_Q15[center - 3] *
+               ((int32_t)x[-3] + x[3]);
+        acc += (int32_t)GOERTZEL_HB_Q15[center - 5] *
+               ((int32_t)x[-5] + x[5]);
+        acc += (int32_t)GOERTZEL_HB_Q15[center - 7] *
+               ((int32_t)x[-7] + x[7]);
+        acc += (int32_t)GOERTZEL_HB_Q15[center - 9] *
+               ((int32_t)x[-9] + x[9]);
+        // Q15 product back to sample scale (>> 15), then up into the
+        // kernel's Q1.30/2^GUARD_BITS input scaling (<< 15 - GUARD_BITS).
+        dec[c][m] = acc >> GUARD_BITS;
+      }
+      memcpy(dcmHist[c], &ext[c][AUDIO_BLOCK_SAMPLES],
+             sizeof(dcmHist[c]));
+    }
+
+    for (int i = 0; i < GOERTZEL_DIV2_SAMPLES; i++) {
+      int32_t sampleLeft = dec[0][i];
+      int32_t sampleRight = dec[1][i];
+
+      for (int det = 0; det < GOERTZEL_NUM_BINS; det++) {
+        GoertzelDetector &d = detectors[det];
+        if (!d.enabled || d.gated || d.segSamples != GOERTZEL_DIV2_SAMPLES) {
+          continue;
+        }
+        int32_t q0L = coeffMul(d.left.q1, d.coeffQ14) - d.left.q2 + sampleLeft;
+        int32_t q0R =
+            coeffMul(d.right.q1, d.coeffQ14) - d.right.q2 + sampleRight;
+        d.left.q2 = d.left.q1;
+        d.right.q2 = d.right.q1;
+        d.left.q1 = q0L;
+        d.right.q1 = q0R;
+      }
+    }
+  }
+
+  // Fold this block's mean-square power (normalized so full scale = 1.0)
+  // into the smoothed per-channel estimate. The 1/16 EWMA weight averages
+  // over roughly the same span as the detector windows.
+  const float powerScale =
+      1.0f / ((float)AUDIO_BLOCK_SAMPLES * 32767.0f * 32767.0f);
+  avgPower[0] += ((float)energyLeft * powerScale - avgPower[0]) * 0.0625f;
+  avgPower[1] += ((float)energyRight * powerScale - avgPower[1]) * 0.0625f;
+
+  // A segment is exactly one block, so every enabled (and ungated) detector
+  // finishes its segment here and refreshes the sliding-window magnitude.
+  for (int det = 0; det < GOERTZEL_NUM_BINS; det++) {
+    if (detectors[det].enabled && !detectors[det].gated) {
+      finishSegment(detectors[det]);
+    }
+  }
+
+  // Scope marker: fresh window magnitudes exist as of this edge
+  // (LatencyMarkers.h; compiles out unless the instrumentation build).
+  latencyMarkWindow();
+
+  release(blockLeft);
+  release(blockRight);
+}
@@ -0,0 +1,189 @@
+/*
+GoertzelBank: A single-pass multi-frequency tone detector.
+
+The stock AudioAnalyzeToneDetect computes one frequency per object, so the
+previous detector bank (left_det_0..3, right_det_0..3) walked every
+128-sample audio block eight times through the Audio library update chain.
+This node consumes the stereo sense input once per block and accumulates all
+detector frequencies for both channels in one interleaved pass, cutting the
+per-block ISR cost to a single update().
+
+The inner loop is a fixed-point kernel: the Goertzel coefficient is Q14 and
+the accumulators are Q1.30, multiplied with the Cortex-M7 SMULWB 32x16 DSP
+instruction. The left and right channel recurrences are interleaved so the
+dual-issue pipeline can overlap the two independent chains.
+
+Sliding window: instead of integrating one long window and restarting (a
+fresh magnitude only every sample_time_ms), each 128-sample block is
+Goertzel-analyzed on its own and the complex block results are combined
+with precomputed twiddle rotations into the full-window DFT bin. The window
+slides forward one block at a time, so a valid full-window magnitude is
+available every block (~2.9 ms) while frequency selectivity still comes
+from the configured window length.
+
+Hann weighting: a rectangular window's sidelobes are only ~13 dB down, so
+with short windows a strong adjacent statue tone leaks measurable energy
+into a neighboring bin. With Hann weighting enabled the sliding-window
+combine scales each segment's complex contribution by a precomputed Hann
+coefficient for its position in the window. Weighting at segment (not
+sample) granularity keeps the slide-by-one-block property and adds zero
+cost to the per-sample kernel; it approximates the true Hann response to
+within the 128-sample step, which for the configured window lengths still
+buys roughly 30 dB of sidelobe suppression for ~1.5x main-lobe widening.
+
+Guard bins: the bank carries extra detector slots behind the per-statue
+primaries, tuned by AudioSense to the predicted third-order intermod
+products of this statue's own tone with each remote tone. A genuine remote
+tone leaves those bins at the noise floor; clipping or nonlinear skin
+contact that lands ghost energy on a primary bin necessarily populates its
+intermod family too, so guard energy tracking the primary vetoes the link
+decision. Guards are ordinary detectors in the same single-pass kernel -
+disabled ones (products outside the 5-20 kHz grid) cost one branch per
+sample.
+
+Decimating front end: bins below half the Nyquist band (<= 8800 Hz, where
+the low guard products land) do not need the full 44.1 kHz rate. The bank
+runs those on a decimate-by-2 stream: one shared halfband FIR per channel
+produces 64 samples per block, and the low bins' recurrences advance 64
+times instead of 128, halving their per-sample kernel cost. The fs/2
+twiddle over 64 samples equals the full-rate twiddle over 128, so
+decimated and full-rate bins share the same segment ring and window
+combine; only the per-segment normalization differs. The filter runs only
+while at least one decimated bin is enabled, so the default all-high-band
+tuning pays nothing for the path.
+
+The read() interface matches AudioAnalyzeToneDetect: it returns the
+normalized magnitude (0.0 - 1.0) of the current sliding window.
+*/
+
+#ifndef GOERTZEL_BANK_H
+#define GOERTZEL_BANK_H
+
+#include <Arduino.h>
+#include <AudioStream.h>
+
+#include "StatueConfig.h"
+
+// Maximum number of 128-sample segments in a sliding window. 64 segments is
+// ~186 ms at 44.1 kHz, comfortably above the configured sample times.
+#define GOERTZEL_MAX_SEGMENTS 64
+
+// Harmonic guard bins per primary detector (the two third-order intermod
+// products 2*f_remote - f_tx and 2*f_tx - f_remote).
+#define GOERTZEL_GUARDS_PER_DET 2
+
+// Total bins: the per-statue primaries first, then their guard bins.
+#define GOERTZEL_NUM_BINS ((MAX_STATUES - 1) * (1 + GOERTZEL_GUARDS_PER_DET))
+
+// Bin index of guard `g` for primary detector `det`.
+inline uint8_t goertzelGuardBin(uint8_t det, uint8_t g) {
+  return (uint8_t)((MAX_STATUES - 1) + det * GOERTZEL_GUARDS_PER_DET + g);
+}
+
+// Samples per segment on the decimate-by-2 stream.
+#define GOERTZEL_DIV2_SAMPLES (AUDIO_BLOCK_SAMPLES / 2)
+
+// Halfband filter history carried across blocks (GOERTZEL_HB_TAPS - 1;
+// checked against the tap table in GoertzelBank.cpp).
+#define GOERTZEL_HB_HIST 18
+
+// One Goertzel accumulator pair (q1/q2) for one channel, Q1.30 fixed point.
+struct GoertzelChannel {
+  int32_t q1;
+  int32_t q2;
+  // Ring of per-segment complex bin values for the sliding window combine.
+  float segRe[GOERTZEL_MAX_SEGMENTS];
+  float segIm[GOERTZEL_MAX_SEGMENTS];
+};
+
+struct GoertzelDetector {
+  int16_t coeffQ14;      // 2*cos(2*pi*freq/fs) in Q14 (range -2..2)
+  float coeff;           // Same coefficient in float, for the extraction step
+  float cosTheta;        // cos/sin of the per-sample phase increment,
+  float sinTheta;        //   used to extract the complex bin value
+  float rotRe;           // Per-segment twiddle e^(-j*theta*128) for the
+  float rotIm;           //   sliding-window combine
+  GoertzelChannel left;  // Running accumulators + segment ring, left channel
+  GoertzelChannel right; // Running accumulators + segment ring, right channel
+  uint8_t segments;      // Window length in segments
+  uint8_t segIndex;      // Next write slot in the segment rings
+  uint8_t segSamples;    // Samples per segment: 128 full rate, 64 decimated
+  float magScale;        // Extra magnitude scale (halfband droop comp.)
+  // Per-segment combine weights (oldest first) and their sum, rebuilt when
+  // the window length or shape changes. All 1.0 for a rectangular window.
+  float winWeight[GOERTZEL_MAX_SEGMENTS];
+  float winSum;
+  float outLeft;         // Magnitude of the current sliding window
+  float outRight;
+  float phaseLeft;       // Phase (radians) of the current sliding window
+  float phaseRight;
+  bool enabled;
+  bool gated; // TDM: when true, samples are ignored and the window freezes
+  bool hann;  // Hann-weight the sliding-window combine (else rectangular)
+};
+
+class AudioAnalyzeGoertzelBank : public AudioStream {
+public:
+  AudioAnalyzeGoertzelBank() : AudioStream(2, inputQueueArray) {
+    for (int i = 0; i < GOERTZEL_NUM_BINS; i++) {
+      detectors[i].enabled = false;
+      detectors[i].gated = false;
+      detectors[i].outLeft = 0.0f;
+      detectors[i].outRight = 0.0f;
+      detectors[i].hann = false;
+      detectors[i].segSamples = AUDIO_BLOCK_SAMPLES;
+      detectors[i].magScale = 1.0f;
+    }
+  }
+
+  // Configure detector `det` just like AudioAnalyzeToneDetect::frequency().
+  // The window length (from `cycles`) is rounded to whole 128-sample blocks.
+  void frequency(uint8_t det, float freq, uint16_t cycles);
+
+  // Read the current sliding-window magnitude for detector `det`.
+  // Channel 0 is left (ring input), channel 1 is right.
+  float read(uint8_t det, uint8_t channel);
+
+  // Mean-square input power of a channel (EWMA over blocks), normalized so
+  // a full-scale sine reads 0.5. Used to derive per-detector SNR.
+  float channelPower(uint8_t channel);
+
+  // Read the phase (radians, -pi..pi) of the current sliding window. The
+  // combine already produces full I/Q, so this costs one atan2 per window.
+  // Phase wander is an earlier indicator of a failing hand connection than
+  // the magnitude crossing a threshold.
+  float readPhase(uint8_t det, uint8_t channel);
+
+  // TDM slot gating: while gated, a detector ignores input and freezes its
+  // window so integration only accumulates during the target statue's
+  // transmit slot.
+  void setGate(uint8_t det, bool gated);
+
+  // Change the sliding-window length (in 128-sample segments) without
+  // touching the coefficient. The segment ring restarts, so the magnitude
+  // is valid again after `segments` blocks. Used by the adaptive
+  // integration logic to trade selectivity for confirmation speed.
+  void setWindowSegments(uint8_t det, uint8_t segments);
+
+  // Switch a detector between the rectangular and Hann-weighted window.
+  // The segment ring restarts on a change, same as setWindowSegments().
+  void setHannWindow(uint8_t det, bool enabled);
+
+  // Drop a bin out of the kernel entirely (read() returns 0). Used for
+  // guard bins whose intermod product falls outside the detector grid.
+  void disable(uint8_t det);
+
+  virtual void update(void);
+
+private:
+  void finishSegment(GoertzelDetector &d);
+  static void buildWindow(GoertzelDetector &d, uint8_t segments);
+
+  GoertzelDetector detectors[GOERTZEL_NUM_BINS];
+  float avgPower[2] = {0.0f, 0.0f}; // Smoothed mean-square power per channel
+  // Halfband filter state: the last taps-1 input samples per channel.
+  int16_t dcmHist[2][GOERTZEL_HB_HIST] = {};
+  audio_block_t *inputQueueArray[2];
+};
+
+#endif // GOERTZEL_BANK_H
@@ -0,0 +1,188 @@
+/*
+GoertzelTables: Compile-time Goertzel coefficient tables.
+
+Detector re-tuning used to re-derive coefficients with float trig at
+runtime (five libm calls per detector) on the setup/parseConfig() path.
+This header precomputes every coefficient the detectors can need - Q14 and
+float Goertzel coefficients, the per-sample cos/sin for I/Q extraction, and
+the per-block twiddle for the sliding-window combine - over a 10 Hz grid
+covering the 5-20 kHz band we operate in, as one constexpr table evaluated
+entirely by the compiler and stored in flash.
+
+Both the transmit tone and the detectors snap to the same grid, so the
+quantization (max 5 Hz) cancels between statues: everyone derives their
+frequencies from the same STATUE_FREQUENCIES config.
+
+A second, smaller table covers the low end of the band (5000-8800 Hz) at
+the half sample rate for the decimate-by-2 front end in GoertzelBank: the
+Goertzel recurrence there advances 64 times per block instead of 128, so
+its coefficients derive from theta' = 2*pi*f/22050. The per-block twiddle
+is numerically identical to the full-rate one (theta'*64 == theta*128),
+which is what lets decimated and full-rate bins share the same sliding
+window bookkeeping. Each entry also carries the reciprocal of the
+anti-alias filter's passband gain at that frequency, so decimated
+magnitudes stay on the same 0-1 scale despite the halfband's ~0.9 dB of
+edge droop.
+*/
+
+#ifndef GOERTZEL_TABLES_H
+#define GOERTZEL_TABLES_H
+
+#include <Arduino.h>
+
+#define GOERTZEL_GRID_MIN_HZ 5000
+#define GOERTZEL_GRID_STEP_HZ 10
+#define GOERTZEL_GRID_COUNT 1501 // 5000..20000 Hz inclusive
+
+// Bins at or below this frequency run on the decimate-by-2 stream. The cap
+// sits below the halfband's transition region so every decimated bin keeps
+// >= 20 dB of image rejection, and the images of the decimated slice
+// (13250-17050 Hz) attenuate the nearest real statue tones by >= 35 dB.
+#define GOERTZEL_DIV2_MAX_HZ 8800
+#define GOERTZEL_DIV2_COUNT 381 // 5000..8800 Hz inclusive, same 10 Hz step
+
+// Halfband anti-alias FIR for the decimator (Kaiser beta=6, Q15). Odd taps
+// are zero except the center, so each output costs six multiplies with the
+// symmetric pairs pre-added. -0.9 dB at 8800 Hz (compensated per bin via
+// the gain column below), -20 dB at 13230 Hz, -63 dB at 16 kHz.
+#define GOERTZEL_HB_TAPS 19
+constexpr int16_t GOERTZEL_HB_Q15[GOERTZEL_HB_TAPS] = {
+    62, 0, -321, 0, 1007, 0, -2703, 0, 10147, 16383,
+    10147, 0, -2703, 0, 1007, 0, -321, 0, 62};
+
+// One grid entry: everything frequency() needs without touching libm.
+struct GoertzelCoeffs {
+  float coeff;    // 2*cos(2*pi*f/fs)
+  int16_t coeffQ14;
+  float cosTheta; // cos/sin of the per-sample phase increment
+  float sinTheta;
+  float rotRe;    // Per-block (128-sample) twiddle e^(-j*theta*128)
+  float rotIm;
+};
+
+// Compile-time trig. The compiler evaluates these once per table entry; the
+// Taylor series after range reduction is accurate to well below the float
+// precision we store.
+namespace goertzel_ct {
+
+constexpr double kPi = 3.14159265358979323846;
+
+constexpr double wrap(double x) {
+  while (x > kPi)
+    x -= 2.0 * kPi;
+  while (x < -kPi)
+    x += 2.0 * kPi;
+  return x;
+}
+
+constexpr double cosTaylor(double x) {
+  x = wrap(x);
+  double term = 1.0, sum = 1.0;
+  for (int i = 1; i <= 12; i++) {
+    term *= -x * x / ((2.0 * i - 1.0) * (2.0 * i));
+    sum += term;
+  }
+  return sum;
+}
+
+constexpr double sinTaylor(double x) {
+  x = wrap(x);
+  double term = x, sum = x;
+  for (int i = 1; i <= 12; i++) {
+    term *= -x * x / ((2.0 * i) * (2.0 * i + 1.0));
+    sum += term;
+  }
+  return sum;
+}
+
+// The halfband's frequency response at full-rate theta (linear phase, so
+// the magnitude is the real cosine sum around the center tap).
+constexpr double hbGain(double theta) {
+  constexpr int center = (GOERTZEL_HB_TAPS - 1) / 2;
+  double h = (double)GOERTZEL_HB_Q15[center];
+  for (int k = 1; k <= center; k++) {
+    h += 2.0 * (double)GOERTZEL_HB_Q15[center - k] * cosTaylor(k * theta);
+  }
+  return h / 32768.0;
+}
+
+struct Table {
+  GoertzelCoeffs entries[GOERTZEL_GRID_COUNT];
+};
+
+constexpr Table makeTable() {
+  Table t{};
+  for (int i = 0; i < GOERTZEL_GRID_COUNT; i++) {
+    double freq = GOERTZEL_GRID_MIN_HZ + (double)i * GOERTZEL_GRID_STEP_HZ;
+    double theta = 2.0 * kPi * freq / 44100.0; // AUDIO_SAMPLE_RATE_EXACT
+    double thetaSeg = theta * 128.0;           // AUDIO_BLOCK_SAMPLES
+    double c = cosTaylor(theta);
+    t.entries[i].coeff = (float)(2.0 * c);
+    t.entries[i].coeffQ14 = (int16_t)(2.0 * c * 16384.0 + (c >= 0 ? 0.5 : -0.5));
+    t.entries[i].cosTheta = (float)c;
+    t.entries[i].sinTheta = (float)sinTaylor(theta);
+    t.entries[i].rotRe = (float)cosTaylor(thetaSeg);
+    t.entries[i].rotIm = (float)(-sinTaylor(thetaSeg));
+  }
+  return t;
+}
+
+// One decimated-grid entry: the fs/2 coefficients plus the droop
+// compensation for the anti-alias filter at this frequency.
+struct Div2Coeffs {
+  GoertzelCoeffs c;
+  float gain; // 1/|H(f)| of the halfband, applied to the magnitude
+};
+
+struct Div2Table {
+  Div2Coeffs entries[GOERTZEL_DIV2_COUNT];
+};
+
+constexpr Div2Table makeDiv2Table() {
+  Div2Table t{};
+  for (int i = 0; i < GOERTZEL_DIV2_COUNT; i++) {
+    double freq = GOERTZEL_GRID_MIN_HZ + (double)i * GOERTZEL_GRID_STEP_HZ;
+    double theta = 2.0 * kPi * freq / 22050.0; // Half the sample rate
+    double thetaSeg = theta * 64.0;            // == full-rate theta * 128
+    double c = cosTaylor(theta);
+    t.entries[i].c.coeff = (float)(2.0 * c);
+    t.entries[i].c.coeffQ14 =
+        (int16_t)(2.0 * c * 16384.0 + (c >= 0 ? 0.5 : -0.5));
+    t.entries[i].c.cosTheta = (float)c;
+    t.entries[i].c.sinTheta = (float)sinTaylor(theta);
+    t.entries[i].c.rotRe = (float)cosTaylor(thetaSeg);
+    t.entries[i].c.rotIm = (float)(-sinTaylor(thetaSeg));
+    t.entries[i].gain = (float)(1.0 / hbGain(2.0 * kPi * freq / 44100.0));
+  }
+  return t;
+}
+
+} // namespace goertzel_ct
+
+// The table lives in flash; on the Teensy 4.1 flash is memory mapped so
+// entries are read directly.
+constexpr goertzel_ct::Table GOERTZEL_TABLE PROGMEM = goertzel_ct::makeTable();
+constexpr goertzel_ct::Div2Table GOERTZEL_DIV2_TABLE PROGMEM =
+    goertzel_ct::makeDiv2Table();
+
+// Nearest grid index for a frequency, clamped to the table range.
+inline int goertzelGridIndex(float freq) {
+  int idx = (int)((freq - GOERTZEL_GRID_MIN_HZ) / GOERTZEL_GRID_STEP_HZ + 0.5f);
+  if (idx < 0)
+    idx = 0;
+  if (idx >= GOERTZEL_GRID_COUNT)
+    idx = GOERTZEL_GRID_COUNT - 1;
+  return idx;
+}
+
+// The grid frequency for an index (what the snapped tone actually is).
+inline float goertzelGridFreq(int idx) {
+  return (float)(GOERTZEL_GRID_MIN_HZ + idx * GOERTZEL_GRID_STEP_HZ);
+}
+
+// Snap an arbitrary frequency onto the grid.
+inline float goertzelSnapFreq(float freq) {
+  return goertzelGridFreq(goertzelGridIndex(freq));
+}
+
+#endif // GOERTZEL_TABLES_H
@@ -8,7 +8,19 @@
 #define HAPTIC_MOTOR_RESOLUTION 10 // 10-bit resolution i.e. 0-1023
 #define HAPTIC_MOTOR_DUTY_CYCLE_VALUE 512
 
+// Envelope patterns (tables in Haptics.ino). Steps advance from a timer
+// ISR, so pattern playback costs loop() nothing.
+typedef enum {
+  HAPTIC_PATTERN_NONE,      // Motor off
+  HAPTIC_PATTERN_SWELL,     // Ramp up and out - the link celebration
+  HAPTIC_PATTERN_HEARTBEAT, // Lub-dub loop - sustained link
+  HAPTIC_PATTERN_PULSES,    // Short pulse train - notifications
+  HAPTIC_PATTERN_MUSIC,     // Duty follows the music envelope
+} HapticPattern;
+
 void initHaptics();
 void driveHaptics(const ContactState& state);
+// Start a pattern; `loop` repeats it until the next hapticPlay or Off.
+void hapticPlay(HapticPattern pattern, bool loop);
 void hapticMotorOn();
 void hapticMotorOff();
@@ -1,46 +1,189 @@
+/*
+Haptics: envelope-driven motor patterns stepped from a timer ISR.
+
+The motor used to be binary: full duty for a fixed 500 ms on link, with
+the on/off edges landing at loop() cadence. Patterns are now envelope
+tables - duty values stepped every HAPTIC_TICK_MS by an IntervalTimer -
+so ramps and rhythms play with ISR timing regardless of what loop() is
+doing, and driveHaptics() only selects which pattern plays on a link
+transition. Each ISR tick is one table read and one PWM register write.
+*/
+
 #include "Haptics.h"
+#include "MusicEnvelope.h"
+#include "MusicPlayer.h"
+#include "StatueConfig.h"
 #include <Arduino.h>
 
-// Haptic motor on-duration constant (ms)
-const unsigned long HAPTIC_MOTOR_ON_DURATION_MS = 500;
+// Live per-statue contact quality and link mask from the sense path
+// (AudioSense.ino). Both are written there and read here in the ISR;
+// single-byte reads are atomic, so no locking is needed.
+extern volatile uint8_t latestQuality[MAX_STATUES];
+extern volatile StatueMask latestLinkedMask;
+
+// Envelope step period. 20 ms is fine-grained enough for ramps the hand
+// can feel and keeps the tables short.
+#define HAPTIC_TICK_MS 20
+
+// Duty envelopes, 10-bit (0-1023), one entry per tick.
+
+// Swell: ramp up, hold, ramp out - a ~600 ms "connection made" bloom.
+static const uint16_t swellSteps[] = {
+    96,  192, 320, 448, 576, 704, 832, 928, 1000, 1023, 1023, 1023,
+    1023, 1023, 960, 896, 800, 704, 608, 512,  416,  320, 224, 128,
+    64,   0};
+
+// Heartbeat: lub, gap, dub, long gap (~1 s cycle when looped).
+static const uint16_t heartbeatSteps[] = {
+    900, 900, 900, 0,   0,   0,   640, 640, 640, 0,
+    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    0,   0,   0,   0,   0};
+
+// Pulses: three short taps.
+static const uint16_t pulseSteps[] = {768, 768, 0, 0, 768, 768,
+                                      0,   0,   768, 768, 0, 0};
+
+struct HapticEnvelope {
+  const uint16_t *steps;
+  uint8_t count;
+};
+
+// Indexed by HapticPattern; NONE holds a single zero entry. MUSIC also
+// holds one entry - its duty comes from the envelope follower each tick,
+// not from a table.
+static const uint16_t offStep[] = {0};
+static const HapticEnvelope envelopes[] = {
+    {offStep, 1},
+    {swellSteps, sizeof(swellSteps) / sizeof(swellSteps[0])},
+    {heartbeatSteps, sizeof(heartbeatSteps) / sizeof(heartbeatSteps[0])},
+    {pulseSteps, sizeof(pulseSteps) / sizeof(pulseSteps[0])},
+    {offStep, 1},
+};
+
+// Player state, owned by the ISR once a pattern starts. `next` hands a
+// new selection from loop context to the ISR without stopping it mid-step.
+static IntervalTimer hapticTimer;
+static volatile HapticPattern activePattern = HAPTIC_PATTERN_NONE;
+static volatile HapticPattern nextPattern = HAPTIC_PATTERN_NONE;
+static volatile bool nextLoop = false;
+static volatile bool patternLoop = false;
+static volatile bool patternPending = false;
+static volatile uint8_t stepIndex = 0;
+
+// Strongest linked statue's contact quality (0-100), already smoothed
+// on the sense path. Zero when nothing is linked.
+static uint8_t linkedGripQuality() {
+  StatueMask mask = latestLinkedMask;
+  uint8_t best = 0;
+  for (int i = 0; i < MAX_STATUES; i++) {
+    if ((mask & (1 << i)) && latestQuality[i] > best) {
+      best = latestQuality[i];
+    }
+  }
+  return best;
+}
 
-// Timer variables for haptic motor auto-off
-static unsigned long hapticTimerStart = 0;
-static bool hapticTimerActive = false;
+// Sustained-link intensity floor: even a weak grip stays feelable.
+#define HAPTIC_MIN_INTENSITY_PCT 30
+
+// Music-follow floor duty: quiet passages pulse gently instead of
+// cutting the motor dead.
+#define HAPTIC_MUSIC_MIN_DUTY 120
+
+// ISR: advance the active envelope by one step.
+static void hapticTick() {
+  if (patternPending) {
+    activePattern = nextPattern;
+    patternLoop = nextLoop;
+    stepIndex = 0;
+    patternPending = false;
+  }
+
+  const HapticEnvelope &env = envelopes[activePattern];
+  if (stepIndex >= env.count) {
+    if (patternLoop) {
+      stepIndex = 0;
+    } else {
+      // One-shot finished: park at off.
+      activePattern = HAPTIC_PATTERN_NONE;
+      stepIndex = 0;
+      analogWrite(HAPTIC_MOTOR_PIN, 0);
+      return;
+    }
+  }
+  uint16_t duty = env.steps[stepIndex];
+  if (activePattern == HAPTIC_PATTERN_MUSIC) {
+    // Beat-synced pulse: the motor follows the music output envelope
+    // (MusicEnvelope.h), with a floor so quiet passages stay feelable.
+    float level = musicEnvelopeLevel();
+    duty = (uint16_t)(HAPTIC_MUSIC_MIN_DUTY +
+                      level * (1023 - HAPTIC_MUSIC_MIN_DUTY));
+  } else if (activePattern == HAPTIC_PATTERN_HEARTBEAT) {
+    // Scale the sustained-link heartbeat by grip quality, so intensity
+    // tracks the strongest linked signal with sense-period latency -
+    // the swell celebration stays full strength.
+    uint32_t pct = HAPTIC_MIN_INTENSITY_PCT +
+                   ((100 - HAPTIC_MIN_INTENSITY_PCT) *
+                    (uint32_t)linkedGripQuality()) /
+                       100;
+    duty = (uint16_t)((duty * pct) / 100);
+  }
+  analogWrite(HAPTIC_MOTOR_PIN, duty);
+  stepIndex++;
+}
 
 void initHaptics() {
   analogWriteFrequency(HAPTIC_MOTOR_PIN, HAPTIC_MOTOR_FREQUENCY);
   analogWriteResolution(HAPTIC_MOTOR_RESOLUTION);
   pinMode(HAPTIC_MOTOR_PIN, OUTPUT);
+  analogWrite(HAPTIC_MOTOR_PIN, 0);
+  hapticTimer.begin(hapticTick, HAPTIC_TICK_MS * 1000);
+  // 224 per the priority map in IsrTrace.cpp. All IntervalTimers share
+  // one PIT interrupt at the highest priority any of them requested,
+  // so the old 192 here quietly hoisted the sense tick above the audio
+  // update (208) as well - this must match the sense timer's request.
+  hapticTimer.priority(224);
 }
 
-void hapticMotorOn() {
-  analogWrite(HAPTIC_MOTOR_PIN, HAPTIC_MOTOR_DUTY_CYCLE_VALUE);
-  hapticTimerStart = millis();
-  hapticTimerActive = true;
+void hapticPlay(HapticPattern pattern, bool loop) {
+  nextPattern = pattern;
+  nextLoop = loop;
+  patternPending = true;
 }
 
-void hapticMotorOff() {
-  analogWrite(HAPTIC_MOTOR_PIN, 0);
-  hapticTimerActive = false;
-}
+// Legacy direct controls, kept for tests and the simple callers: they
+// route through the pattern engine so the ISR stays the single writer
+// of the PWM duty.
+void hapticMotorOn() { hapticPlay(HAPTIC_PATTERN_SWELL, false); }
 
-// Check if the timer has expired and turn off motor if needed.
-void handleHapticTimer() {
-  if (hapticTimerActive && (millis() - hapticTimerStart >= HAPTIC_MOTOR_ON_DURATION_MS)) {
-    hapticMotorOff();
-  }
-}
+void hapticMotorOff() { hapticPlay(HAPTIC_PATTERN_NONE, false); }
 
 void driveHaptics(const ContactState& state) {
-  handleHapticTimer();
   if (state.isUnchanged()) {
-    return; // No change in state to report.
+    // Settle in once the link swell has played out: follow the music
+    // envelope while the active song plays, heartbeat otherwise.
+    if (state.isLinked() && activePattern == HAPTIC_PATTERN_NONE &&
+        !patternPending) {
+      hapticPlay(musicPlaying() ? HAPTIC_PATTERN_MUSIC
+                                : HAPTIC_PATTERN_HEARTBEAT,
+                 true);
+    } else if (state.isLinked() && !patternPending) {
+      // Swap between the two sustained patterns if playback state moved
+      // under us (song gap, SD hiccup, card pulled).
+      if (activePattern == HAPTIC_PATTERN_HEARTBEAT && musicPlaying()) {
+        hapticPlay(HAPTIC_PATTERN_MUSIC, true);
+      } else if (activePattern == HAPTIC_PATTERN_MUSIC && !musicPlaying()) {
+        hapticPlay(HAPTIC_PATTERN_HEARTBEAT, true);
+      }
+    }
+    return;
   }
 
   if (state.isLinked()) {
-    hapticMotorOn();
+    // Celebrate the new link with the swell, then settle into the
+    // heartbeat for as long as the chain holds.
+    hapticPlay(HAPTIC_PATTERN_SWELL, false);
   } else {
-    hapticMotorOff();
+    hapticPlay(HAPTIC_PATTERN_NONE, false);
   }
 }
@@ -0,0 +1,95 @@
+/*
+ImaAdpcm.cpp - IMA ADPCM block decoder implementation.
+*/
+
+#include "ImaAdpcm.h"
+
+static const int8_t INDEX_TABLE[16] = {-1, -1, -1, -1, 2, 4, 6, 8,
+                                       -1, -1, -1, -1, 2, 4, 6, 8};
+
+static const int16_t STEP_TABLE[89] = {
+    7,     8,     9,     10,    11,    12,    13,    14,    16,    17,
+    19,    21,    23,    25,    28,    31,    34,    37,    41,    45,
+    50,    55,    60,    66,    73,    80,    88,    97,    107,   118,
+    130,   143,   157,   173,   190,   209,   230,   253,   279,   307,
+    337,   371,   408,   449,   494,   544,   598,   658,   724,   796,
+    876,   963,   1060,  1166,  1282,  1411,  1552,  1707,  1878,  2066,
+    2272,  2499,  2749,  3024,  3327,  3660,  4026,  4428,  4871,  5358,
+    5894,  6484,  7132,  7845,  8630,  9493,  10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767};
+
+struct ChannelState {
+  int32_t predictor;
+  int32_t index;
+};
+
+static inline int16_t decodeNibble(ChannelState &ch, uint8_t nibble) {
+  int32_t step = STEP_TABLE[ch.index];
+
+  // diff = (nibble + 0.5) * step / 4, computed without multiply.
+  int32_t diff = step >> 3;
+  if (nibble & 4)
+    diff += step;
+  if (nibble & 2)
+    diff += step >> 1;
+  if (nibble & 1)
+    diff += step >> 2;
+  if (nibble & 8) {
+    ch.predictor -= diff;
+  } else {
+    ch.predictor += diff;
+  }
+
+  if (ch.predictor > 32767)
+    ch.predictor = 32767;
+  else if (ch.predictor < -32768)
+    ch.predictor = -32768;
+
+  ch.index += INDEX_TABLE[nibble];
+  if (ch.index < 0)
+    ch.index = 0;
+  else if (ch.index > 88)
+    ch.index = 88;
+
+  return (int16_t)ch.predictor;
+}
+
+// FASTRUN: runs inside the audio update when an ADPCM song is streaming;
+// pinned to ITCM alongside the Goertzel kernels (see GoertzelBank.cpp).
+FASTRUN uint16_t imaAdpcmDecodeBlock(const uint8_t *src, uint16_t blockAlign,
+                                     uint8_t channels, int16_t *outLeft,
+                                     int16_t *outRight) {
+  ChannelState state[2];
+  int16_t *out[2] = {outLeft, outRight};
+  uint16_t samples = imaAdpcmSamplesPerBlock(blockAlign, channels);
+
+  // Per-channel block headers carry the first sample and step index.
+  for (uint8_t c = 0; c < channels; c++) {
+    state[c].predictor = (int16_t)(src[0] | (src[1] << 8));
+    state[c].index = src[2];
+    if (state[c].index > 88) {
+      state[c].index = 88;
+    }
+    out[c][0] = (int16_t)state[c].predictor;
+    src += 4;
+  }
+
+  // Nibble data: 4-byte (8-sample) groups per channel, interleaved.
+  uint16_t decoded = 1;
+  while (decoded < samples) {
+    for (uint8_t c = 0; c < channels; c++) {
+      uint16_t pos = decoded;
+      for (int b = 0; b < 4; b++) {
+        uint8_t byte = *src++;
+        if (pos < samples) {
+          out[c][pos++] = decodeNibble(state[c], byte & 0x0F);
+        }
+        if (pos < samples) {
+          out[c][pos++] = decodeNibble(state[c], byte >> 4);
+        }
+      }
+    }
+    decoded += 8;
+  }
+  return samples;
+}
@@ -0,0 +1,33 @@
+/*
+ImaAdpcm: Fixed-point IMA ADPCM (WAV format tag 0x11) block decoder.
+
+Uncompressed 16-bit stereo WAV pulls ~176 KB/s from the SD card
+continuously; 4-bit IMA ADPCM cuts that ~4x, and the decode is a handful
+of integer operations per sample - nothing for the Cortex-M7. The SD bus
+is the bottleneck in this system, not CPU.
+
+IMA WAV block layout: a 4-byte header per channel (int16 predictor,
+uint8 step index, reserved), then nibble data interleaved in 4-byte
+per-channel groups. Encode assets with e.g.:
+  ffmpeg -i in.wav -acodec adpcm_ima_wav out.wav
+*/
+
+#ifndef IMA_ADPCM_H
+#define IMA_ADPCM_H
+
+#include <Arduino.h>
+
+// Samples per channel in one block of `blockAlign` bytes.
+static inline uint16_t imaAdpcmSamplesPerBlock(uint16_t blockAlign,
+                                               uint8_t channels) {
+  return (blockAlign - 4 * channels) / channels * 2 + 1;
+}
+
+// Decode one block into per-channel PCM. For mono, outRight may equal
+// outLeft's buffer or be filled identically by the caller; this decoder
+// writes only outLeft for mono. Returns samples per channel decoded.
+uint16_t imaAdpcmDecodeBlock(const uint8_t *src, uint16_t blockAlign,
+                             uint8_t channels, int16_t *outLeft,
+                             int16_t *outRight);
+
+#endif // IMA_ADPCM_H
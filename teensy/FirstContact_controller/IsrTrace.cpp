@@ -0,0 +1,152 @@
+/*
+IsrTrace.cpp - see IsrTrace.h for why this exists.
+
+Priority map (lower value = more urgent; the imxrt NVIC uses steps of
+16). Applied in isrTraceSetup(); the PIT entry is set where the
+IntervalTimers start, since the core computes the shared priority from
+their requests:
+
+  128  eDMA completion     pointer-swap handlers that feed the audio
+                           update; missing one slips a whole block
+  208  audio update        library default, re-asserted here so a
+                           future default change cannot undo the map
+  224  PIT (sense+haptic)  below audio: a late sense tick is jitter in
+                           a 5 ms cadence, a late audio block is a pop
+  240  Ethernet MAC        lwIP work drains from loop(); nothing about
+                           an rx burst is more urgent than sound
+
+Tracing interposes on the vector table: the installed handler is saved,
+attachInterruptVector() swaps in a trampoline that timestamps with the
+DWT cycle counter around the saved handler (same clock the task
+scheduler times with). The preemption counter uses a single
+active-slot byte, saved and restored across the nested call, so each
+handler charges only its victim. Ethernet needs one wrinkle: a driver
+restart reattaches the raw ISR over the trampoline, so the collect
+pass re-interposes - tracing loses at most one window across a cable
+bounce, and the saved vector is refreshed at that point.
+*/
+
+#include "IsrTrace.h"
+
+#include <stdio.h>
+
+#define ISR_SLOT_NONE 0xFF
+enum { ISR_SLOT_SW = 0, ISR_SLOT_DMA, ISR_SLOT_PIT, ISR_SLOT_ENET,
+       ISR_SLOT_COUNT };
+static const char *const SLOT_NAMES[ISR_SLOT_COUNT] = {"sw", "dma", "pit",
+                                                       "enet"};
+
+struct IsrStat {
+  // Stats window, reset by isrTraceStatsCollect().
+  volatile uint32_t runs;
+  volatile uint32_t maxUs;
+  volatile uint32_t totalUs;
+  volatile uint32_t preempted;
+};
+
+static IsrStat stats[ISR_SLOT_COUNT];
+// Slot currently executing, ISR_SLOT_NONE at thread level. Saved and
+// restored by each trampoline, so nesting unwinds correctly.
+static volatile uint8_t activeSlot = ISR_SLOT_NONE;
+static void (*savedVec[NVIC_NUM_INTERRUPTS])(void);
+
+template <int IRQ, int SLOT> static void tracedIsr() {
+  uint32_t startCycles = ARM_DWT_CYCCNT;
+  uint8_t prev = activeSlot;
+  if (prev != ISR_SLOT_NONE) {
+    stats[prev].preempted++;
+  }
+  activeSlot = (uint8_t)SLOT;
+  savedVec[IRQ]();
+  activeSlot = prev;
+  uint32_t us = (ARM_DWT_CYCCNT - startCycles) / (F_CPU_ACTUAL / 1000000);
+  IsrStat &s = stats[SLOT];
+  s.runs++;
+  s.totalUs += us;
+  if (us > s.maxUs) {
+    s.maxUs = us;
+  }
+}
+
+// Interpose on one vector. Idempotent: re-wrapping an already-wrapped
+// vector is a no-op, and re-wrapping after a library reattached its raw
+// handler refreshes the saved vector first.
+static void wrapIrq(int irq, void (*trampoline)(void)) {
+  void (*current)(void) = _VectorsRam[irq + 16];
+  if (current == trampoline) {
+    return;
+  }
+  savedVec[irq] = current;
+  attachInterruptVector((IRQ_NUMBER_t)irq, trampoline);
+}
+
+// All sixteen eDMA completion vectors share the "dma" slot; the audio
+// input/output channels are the only heavy users, and per-channel
+// attribution is not worth sixteen telemetry rows.
+template <int CH> static void wrapDmaChannels() {
+  wrapIrq(IRQ_DMA_CH0 + CH, tracedIsr<IRQ_DMA_CH0 + CH, ISR_SLOT_DMA>);
+  wrapDmaChannels<CH - 1>();
+}
+template <> void wrapDmaChannels<-1>() {}
+
+// Boot-only: FLASHMEM; the trampolines above stay in ITCM.
+FLASHMEM void isrTraceSetup() {
+  wrapIrq(IRQ_SOFTWARE, tracedIsr<IRQ_SOFTWARE, ISR_SLOT_SW>);
+  wrapIrq(IRQ_PIT, tracedIsr<IRQ_PIT, ISR_SLOT_PIT>);
+  wrapIrq(IRQ_ENET, tracedIsr<IRQ_ENET, ISR_SLOT_ENET>);
+  wrapDmaChannels<15>();
+
+  // Apply the priority map (table above). PIT is left to the
+  // IntervalTimer call sites; DMA stays at the core default of 128.
+  NVIC_SET_PRIORITY(IRQ_SOFTWARE, 208);
+  NVIC_SET_PRIORITY(IRQ_ENET, 240);
+
+  Serial.printf("IsrTrace: vectors wrapped; enet=%lu sw=%lu pit=%lu\n",
+                (unsigned long)NVIC_GET_PRIORITY(IRQ_ENET),
+                (unsigned long)NVIC_GET_PRIORITY(IRQ_SOFTWARE),
+                (unsigned long)NVIC_GET_PRIORITY(IRQ_PIT));
+}
+
+bool isrTraceStatsCollect(char *json, size_t jsonLen) {
+  // A driver restart (cable bounce) reattaches the raw Ethernet ISR
+  // over the trampoline; quietly take the vector back each window.
+  wrapIrq(IRQ_ENET, tracedIsr<IRQ_ENET, ISR_SLOT_ENET>);
+
+  // Snapshot-and-reset with interrupts held off so a window never
+  // splits a handler's count from its time. Four slots; microseconds.
+  uint32_t runs[ISR_SLOT_COUNT], maxUs[ISR_SLOT_COUNT];
+  uint32_t totalUs[ISR_SLOT_COUNT], preempted[ISR_SLOT_COUNT];
+  __disable_irq();
+  for (int i = 0; i < ISR_SLOT_COUNT; i++) {
+    runs[i] = stats[i].runs;
+    maxUs[i] = stats[i].maxUs;
+    totalUs[i] = stats[i].totalUs;
+    preempted[i] = stats[i].preempted;
+    stats[i].runs = 0;
+    stats[i].maxUs = 0;
+    stats[i].totalUs = 0;
+    stats[i].preempted = 0;
+  }
+  __enable_irq();
+
+  size_t pos = 0;
+  bool any = false;
+  pos += snprintf(json + pos, jsonLen - pos, "{");
+  for (int i = 0; i < ISR_SLOT_COUNT && pos < jsonLen; i++) {
+    if (runs[i] == 0) {
+      continue;
+    }
+    any = true;
+    pos += snprintf(json + pos, jsonLen - pos,
+                    "%s\"%s\":{\"n\":%lu,\"max_us\":%lu,\"avg_us\":%lu,"
+                    "\"pre\":%lu}",
+                    (pos > 1) ? "," : "", SLOT_NAMES[i], (unsigned long)runs[i],
+                    (unsigned long)maxUs[i],
+                    (unsigned long)(totalUs[i] / runs[i]),
+                    (unsigned long)preempted[i]);
+  }
+  if (pos < jsonLen) {
+    pos += snprintf(json + pos, jsonLen - pos, "}");
+  }
+  return any && pos < jsonLen;
+}
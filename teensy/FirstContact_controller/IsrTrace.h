@@ -0,0 +1,39 @@
+/*
+IsrTrace: interrupt priority map and per-ISR occupancy tracer.
+
+The controller's interrupt behavior used to be whatever the library
+defaults added up to, and the audit found two of them wrong for us:
+QNEthernet leaves the Ethernet MAC interrupt at the NVIC default
+(128), which preempts the audio update (208) - an rx burst during an
+MQTT storm lands inside audio block rendering, which is the audible
+tic. And on the Teensy 4 every IntervalTimer shares one PIT interrupt
+at the highest priority any of them requested, so the haptic tick
+asking for 192 silently hoisted the sense tick above audio too,
+despite both call sites believing audio preempted them.
+
+isrTraceSetup() applies an explicit priority map (see IsrTrace.cpp)
+and interposes cycle-counter-timed trampolines on the key vectors:
+the audio update software interrupt, the eDMA completion channels
+that feed it, the shared PIT timer interrupt (sense + haptic ticks),
+and the Ethernet MAC. Each window the tracer reports per-ISR run
+count, max and mean time-in-handler, and how often the handler was
+itself preempted - time-in-handler is exactly the delay the ISR
+imposes on everything below it, which is the number the priority map
+is designed around. The display's I2C traffic is polled by the Wire
+library, so there is no I2C vector to trace.
+*/
+
+#ifndef ISR_TRACE_H
+#define ISR_TRACE_H
+
+#include <Arduino.h>
+
+// Install the trampolines and apply the priority map. Call at the end
+// of setup(), after every library that attaches a vector has run.
+void isrTraceSetup();
+
+// Fill `json` with the per-ISR stats object and reset the window.
+// Returns false when nothing fired or the buffer is too small.
+bool isrTraceStatsCollect(char *json, size_t jsonLen);
+
+#endif // ISR_TRACE_H
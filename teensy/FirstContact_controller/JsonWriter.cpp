@@ -0,0 +1,142 @@
+/*
+JsonWriter.cpp - Fixed-buffer JSON writer implementation.
+*/
+
+#include "JsonWriter.h"
+
+JsonWriter::JsonWriter(char *buffer, size_t capacity) {
+  buf = buffer;
+  cap = capacity;
+  len = 0;
+  depth = 0;
+  afterKey = false;
+  overflow = (capacity == 0);
+  if (!overflow) {
+    buf[0] = '\0';
+  }
+}
+
+void JsonWriter::rawChar(char c) {
+  if (overflow || len + 1 >= cap) {
+    overflow = true;
+    return;
+  }
+  buf[len++] = c;
+  buf[len] = '\0';
+}
+
+void JsonWriter::raw(const char *s) {
+  while (*s != '\0' && !overflow) {
+    rawChar(*s++);
+  }
+}
+
+// Emit the separating comma when this is not the first value at the
+// current nesting level (a value following a key never takes one).
+void JsonWriter::beforeValue() {
+  if (afterKey) {
+    afterKey = false;
+    return;
+  }
+  if (depth > 0 && hasValue[depth - 1]) {
+    rawChar(',');
+  }
+  if (depth > 0) {
+    hasValue[depth - 1] = true;
+  }
+}
+
+void JsonWriter::beginObject() {
+  beforeValue();
+  if (depth >= JSON_WRITER_MAX_DEPTH) {
+    overflow = true;
+    return;
+  }
+  rawChar('{');
+  hasValue[depth++] = false;
+}
+
+void JsonWriter::endObject() {
+  rawChar('}');
+  if (depth > 0) {
+    depth--;
+  }
+}
+
+void JsonWriter::beginArray() {
+  beforeValue();
+  if (depth >= JSON_WRITER_MAX_DEPTH) {
+    overflow = true;
+    return;
+  }
+  rawChar('[');
+  hasValue[depth++] = false;
+}
+
+void JsonWriter::endArray() {
+  rawChar(']');
+  if (depth > 0) {
+    depth--;
+  }
+}
+
+void JsonWriter::key(const char *name) {
+  beforeValue();
+  rawChar('"');
+  raw(name);
+  raw("\":");
+  afterKey = true;
+}
+
+void JsonWriter::add(const char *value) {
+  beforeValue();
+  rawChar('"');
+  raw(value);
+  rawChar('"');
+}
+
+void JsonWriter::add(float value, uint8_t decimals) {
+  beforeValue();
+  // NaN would produce invalid JSON; signals can be NaN before the first
+  // detector pass completes.
+  if (isnan(value)) {
+    value = 0.0;
+  }
+  char num[20];
+  snprintf(num, sizeof(num), "%.*f", decimals, (double)value);
+  raw(num);
+}
+
+void JsonWriter::add(uint32_t value) {
+  beforeValue();
+  char num[12];
+  snprintf(num, sizeof(num), "%lu", (unsigned long)value);
+  raw(num);
+}
+
+void JsonWriter::add(uint64_t value) {
+  beforeValue();
+  char num[24];
+  snprintf(num, sizeof(num), "%llu", (unsigned long long)value);
+  raw(num);
+}
+
+void JsonWriter::kv(const char *name, const char *value) {
+  key(name);
+  add(value);
+}
+
+void JsonWriter::kv(const char *name, float value, uint8_t decimals) {
+  key(name);
+  add(value, decimals);
+}
+
+void JsonWriter::kv(const char *name, uint32_t value) {
+  key(name);
+  add(value);
+}
+
+void JsonWriter::kv(const char *name, uint64_t value) {
+  key(name);
+  add(value);
+}
@@ -0,0 +1,67 @@
+/*
+JsonWriter: Append-only JSON serialization into a caller-owned buffer.
+
+publishState() and publishSignals() used to assemble messages from Arduino
+String temporaries (String(STATUE_NAMES[i]) + toLowerCase() per entry) and
+repeated strcat passes over stack buffers - heap allocations at 10 Hz on a
+device that runs for week-long events, with fragmentation as the failure
+mode. This writer appends straight into one fixed buffer with comma and
+nesting bookkeeping handled internally, so steady-state publishing makes
+zero allocations and touches each output byte once.
+
+Overflow never writes past the buffer: the writer goes into a failed state
+and ok() reports it, so a truncated message is dropped rather than sent.
+*/
+
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <Arduino.h>
+
+// Deepest object/array nesting the publishers use (with headroom).
+#define JSON_WRITER_MAX_DEPTH 8
+
+class JsonWriter {
+public:
+  JsonWriter(char *buffer, size_t capacity);
+
+  void beginObject();
+  void endObject();
+  void beginArray();
+  void endArray();
+
+  // Emit "name": inside an object; the next value attaches to it.
+  void key(const char *name);
+
+  // Values (string values are quoted; no escaping - our payloads are
+  // statue names and numbers, never user text).
+  void add(const char *value);
+  void add(float value, uint8_t decimals);
+  void add(uint32_t value);
+  void add(uint64_t value);
+
+  // key() + add() in one call.
+  void kv(const char *name, const char *value);
+  void kv(const char *name, float value, uint8_t decimals);
+  void kv(const char *name, uint32_t value);
+  void kv(const char *name, uint64_t value);
+
+  // False if the buffer overflowed; the content is then incomplete and
+  // must not be published.
+  bool ok() { return !overflow; }
+
+private:
+  void raw(const char *s);
+  void rawChar(char c);
+  void beforeValue();
+
+  char *buf;
+  size_t cap;
+  size_t len;
+  uint8_t depth;
+  bool hasValue[JSON_WRITER_MAX_DEPTH]; // A value was emitted at this level
+  bool afterKey;                        // Next value follows a key()
+  bool overflow;
+};
+
+#endif // JSON_WRITER_H
@@ -0,0 +1,71 @@
+/*
+LatencyMarkers.h - GPIO edge markers for oscilloscope latency measurement.
+
+Every latency number the firmware reports comes from software
+timestamps, which can see neither the analog front end nor the WLED
+side. With LATENCY_MARKERS on, three otherwise-unused pins toggle at
+the pipeline's commit points, so a scope across a statue pair (plus a
+photodiode on the LEDs) measures true touch-to-light latency with
+microsecond resolution - ground truth for the software numbers:
+
+  pin 30  window:  every detector-bank update pass refreshed the
+          sliding-window magnitudes (audio ISR) - the sampling grid
+          the detection decision rides on.
+  pin 31  commit:  the debounced stable link mask changed
+          (getStableLinkedMask, sense timer ISR).
+  pin 32  publish: a missing_link/contact event was pushed onto the
+          MQTT socket (drainPublishQueue, loop context).
+
+Markers toggle rather than pulse: every event is one clean edge, the
+scope triggers on either slope, and the hot-path cost is a single pin
+write. The pins are plain GPIO on the Teensy 4.1 with nothing else
+mapped to them (29 is the haptic driver; the quad-sense build uses 6/8
+for the second I2S input, not 30-32).
+
+The enable flag lives here rather than defines.h so this header stays
+freestanding for the sketches that include the Goertzel kernel sources
+directly (Kernel_Bench).
+*/
+
+#ifndef LATENCY_MARKERS_H
+#define LATENCY_MARKERS_H
+
+#include <Arduino.h>
+
+// Instrumentation builds only; never true on a production image (the
+// edges are harmless on unconnected pins, just pointless).
+#define LATENCY_MARKERS false
+
+#define LATENCY_PIN_WINDOW 30
+#define LATENCY_PIN_COMMIT 31
+#define LATENCY_PIN_PUBLISH 32
+
+#if LATENCY_MARKERS
+
+static inline void latencyMarkersSetup() {
+  pinMode(LATENCY_PIN_WINDOW, OUTPUT);
+  pinMode(LATENCY_PIN_COMMIT, OUTPUT);
+  pinMode(LATENCY_PIN_PUBLISH, OUTPUT);
+}
+
+// ISR-safe: digitalToggleFast on a constant pin is one register write.
+static inline void latencyMarkWindow() {
+  digitalToggleFast(LATENCY_PIN_WINDOW);
+}
+static inline void latencyMarkCommit() {
+  digitalToggleFast(LATENCY_PIN_COMMIT);
+}
+static inline void latencyMarkPublish() {
+  digitalToggleFast(LATENCY_PIN_PUBLISH);
+}
+
+#else
+
+static inline void latencyMarkersSetup() {}
+static inline void latencyMarkWindow() {}
+static inline void latencyMarkCommit() {}
+static inline void latencyMarkPublish() {}
+
+#endif // LATENCY_MARKERS
+
+#endif // LATENCY_MARKERS_H
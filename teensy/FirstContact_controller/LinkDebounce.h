@@ -0,0 +1,72 @@
+/*
+LinkDebounce: the pure link/unlink debounce state machine.
+
+Extracted from getStableLinkedMask() so the logic compiles on a PC with
+a scripted clock and signal traces (see tests/debounce_spec.cpp). The
+policy is asymmetric by design: a detection links immediately (contact
+latency is the number the installation lives by), while an unlink must
+hold for the buffer window so a momentary grip slip does not drop the
+chain. No Arduino dependencies - the caller supplies the clock.
+*/
+
+#ifndef LINK_DEBOUNCE_H
+#define LINK_DEBOUNCE_H
+
+#include <stdint.h>
+
+// Statue slots the debouncer tracks; sized past any planned installation
+// (the firmware uses the first MAX_STATUES entries).
+#define LINK_DEBOUNCE_MAX 16
+
+// Outcome of one update() for one statue.
+enum LinkDebounceEvent {
+  LINK_NO_CHANGE,
+  LINK_ESTABLISHED,
+  LINK_LOST,
+};
+
+struct LinkDebounce {
+  uint16_t stableMask = 0; // Debounced link bitmask, one bit per statue
+  uint64_t bufferStartMs[LINK_DEBOUNCE_MAX] = {};
+  bool buffering[LINK_DEBOUNCE_MAX] = {};
+
+  // Feed one thresholded reading for one statue. `nowMs` is the caller's
+  // clock (the firmware passes monoNowMs(), which never wraps);
+  // `unlinkBufferMs` is how long a dropout must persist before the link
+  // is declared lost.
+  LinkDebounceEvent update(int statueIndex, bool detected, uint64_t nowMs,
+                           uint16_t unlinkBufferMs) {
+    bool wasLinked = (stableMask & (1u << statueIndex)) != 0;
+
+    if (!wasLinked && detected) {
+      // Immediate transition to linked for quick contact latency.
+      stableMask |= (1u << statueIndex);
+      buffering[statueIndex] = false;
+      return LINK_ESTABLISHED;
+    }
+
+    if (wasLinked && !detected) {
+      // Buffer the transition to unlinked.
+      if (!buffering[statueIndex]) {
+        buffering[statueIndex] = true;
+        bufferStartMs[statueIndex] = nowMs;
+      } else if (nowMs - bufferStartMs[statueIndex] >= unlinkBufferMs) {
+        stableMask &= ~(1u << statueIndex);
+        buffering[statueIndex] = false;
+        return LINK_LOST;
+      }
+      return LINK_NO_CHANGE;
+    }
+
+    // Steady state (including a re-detection that cancels a pending
+    // unlink).
+    buffering[statueIndex] = false;
+    return LINK_NO_CHANGE;
+  }
+
+  bool isLinked(int statueIndex) const {
+    return (stableMask & (1u << statueIndex)) != 0;
+  }
+};
+
+#endif // LINK_DEBOUNCE_H
@@ -0,0 +1,178 @@
+/*
+Log.cpp - fixed-record ring buffer and the opportunistic drain.
+
+The ring is a plain array of records guarded by a brief interrupt-off
+section around the index update and record copy - cheap enough for the
+sensing path and safe if a log call ever lands in interrupt context.
+The drain never blocks: a line goes to USB serial only when the port
+reports room for all of it, and MQTT forwarding rides the normal
+publish path while connected.
+*/
+
+#include "Log.h"
+
+#include "Messaging.h"
+#include "MonoClock.h"
+#include "Networking.h"
+#include "StatueConfig.h"
+
+#include <ArduinoJson.h>
+#include <stdarg.h>
+
+#define LOG_RING_SIZE 64 // Records; 64 x ~80 B = ~5 KB of RAM1
+
+struct LogRecord {
+  uint64_t us; // monoNowUs() at logWrite; the sinks derive ms from it
+  uint8_t level;
+  char msg[LOG_MSG_MAX];
+};
+
+static LogRecord ring[LOG_RING_SIZE];
+static uint32_t head = 0; // Next slot to write
+static uint32_t tail = 0; // Next slot to drain
+static uint32_t count = 0;
+static uint32_t dropCount = 0;
+
+static const char levelTags[] = {'E', 'W', 'I', 'D'};
+
+// --- UDP log sink ---
+// Fire-and-forget datagrams to the monitoring PC, so field debugging
+// does not mean a USB cable on a ladder. Every drained record goes out
+// regardless of level (the receiver filters); the sequence number
+// advances even for records the rate limiter withholds, so a gap on
+// the wire is visible as exactly that. Target defaults to the
+// long-declared UDP_LOG_PC_IP in Networking.ino; the enable command
+// can point it anywhere.
+#define LOG_UDP_PORT 5140
+#define LOG_UDP_MAX_PER_SEC 50
+
+extern IPAddress UDP_LOG_PC_IP; // Networking.ino
+
+static EthernetUDP logUdp;
+static bool logUdpEnabled = false;
+static IPAddress logUdpIp;
+static uint16_t logUdpPort = LOG_UDP_PORT;
+static uint32_t logUdpSeq = 0;
+static uint32_t logUdpWindowStartMs = 0;
+static uint16_t logUdpWindowSent = 0;
+
+void logUdpCommand(const char *payload, unsigned int length) {
+  StaticJsonDocument<128> doc;
+  if (deserializeJson(doc, payload, length) != DeserializationError::Ok) {
+    return;
+  }
+  const char *ip = doc["ip"] | "";
+  if (ip[0] != '\0') {
+    logUdpIp.fromString(ip);
+  } else if ((uint32_t)logUdpIp == 0) {
+    logUdpIp = UDP_LOG_PC_IP;
+  }
+  logUdpPort = doc["port"] | logUdpPort;
+  logUdpEnabled = doc["enable"] | false;
+  LOG_INFO("UDP log sink %s (%u.%u.%u.%u:%u)",
+           logUdpEnabled ? "on" : "off", logUdpIp[0], logUdpIp[1],
+           logUdpIp[2], logUdpIp[3], logUdpPort);
+}
+
+// Send one record; drops silently past the per-second cap.
+static void logUdpSend(const LogRecord &rec) {
+  uint32_t seq = logUdpSeq++;
+  uint32_t now = millis();
+  if (now - logUdpWindowStartMs >= 1000) {
+    logUdpWindowStartMs = now;
+    logUdpWindowSent = 0;
+  }
+  if (logUdpWindowSent >= LOG_UDP_MAX_PER_SEC) {
+    return;
+  }
+  logUdpWindowSent++;
+  char dgram[LOG_MSG_MAX + 64];
+  int n = snprintf(dgram, sizeof(dgram), "%s %lu %c %llu %s",
+                   MY_STATUE_NAME_LC, (unsigned long)seq,
+                   levelTags[rec.level & 3], (unsigned long long)rec.us,
+                   rec.msg);
+  logUdp.beginPacket(logUdpIp, logUdpPort);
+  logUdp.write((const uint8_t *)dgram, (size_t)n);
+  logUdp.endPacket();
+}
+
+void logWrite(uint8_t level, const char *fmt, ...) {
+  // Format outside the critical section; only the copy-in is guarded.
+  LogRecord rec;
+  rec.us = monoNowUs();
+  rec.level = level;
+  va_list args;
+  va_start(args, fmt);
+  vsnprintf(rec.msg, sizeof(rec.msg), fmt, args);
+  va_end(args);
+
+  noInterrupts();
+  if (count >= LOG_RING_SIZE) {
+    dropCount++;
+    interrupts();
+    return;
+  }
+  ring[head] = rec;
+  head = (head + 1) % LOG_RING_SIZE;
+  count++;
+  interrupts();
+}
+
+// Cap per drain call so a backlog cannot blow the log task's budget.
+#define LOG_DRAIN_MAX_PER_CALL 8
+
+void logDrain() {
+  for (int sent = 0; sent < LOG_DRAIN_MAX_PER_CALL; sent++) {
+    noInterrupts();
+    if (count == 0) {
+      interrupts();
+      break;
+    }
+    LogRecord rec = ring[tail];
+    uint32_t drops = dropCount;
+    interrupts();
+
+    // Line formatted once, shared by the serial and MQTT sinks.
+    uint32_t recMs = (uint32_t)(rec.us / 1000);
+    char line[LOG_MSG_MAX + 24];
+    int lineLen = snprintf(line, sizeof(line), "[%c %lu.%03lu] %s\n",
+                           levelTags[rec.level & 3],
+                           (unsigned long)(recMs / 1000),
+                           (unsigned long)(recMs % 1000), rec.msg);
+
+    // USB serial: only when the port can take the whole line now.
+    // Otherwise leave the record in the ring and come back next tick.
+    if (Serial && Serial.availableForWrite() < lineLen) {
+      break;
+    }
+    if (Serial) {
+      Serial.write(line, lineLen);
+    }
+
+    if (rec.level <= LOG_MQTT_LEVEL && networkReady() && client.connected()) {
+      char jsonMsg[LOG_MSG_MAX + 64];
+      snprintf(jsonMsg, sizeof(jsonMsg),
+               "{\"statue\":\"%s\",\"lvl\":\"%c\",\"ms\":%lu,\"msg\":\"%s\"}",
+               MY_STATUE_NAME_LC, levelTags[rec.level & 3],
+               (unsigned long)recMs, rec.msg);
+      client.publish(ringTopic("missing_link/log"), jsonMsg);
+    }
+
+    if (logUdpEnabled && networkReady()) {
+      logUdpSend(rec);
+    }
+
+    noInterrupts();
+    tail = (tail + 1) % LOG_RING_SIZE;
+    count--;
+    // Report drops in-band once there is room again.
+    if (drops != 0 && count < LOG_RING_SIZE) {
+      dropCount = 0;
+    }
+    interrupts();
+    if (drops != 0) {
+      logWrite(LOG_LEVEL_WARN, "log ring overflow: %lu records dropped",
+               (unsigned long)drops);
+    }
+  }
+}
@@ -0,0 +1,80 @@
+/*
+Log: leveled, ring-buffered logging for the hot paths.
+
+Serial.print on the sensing path goes straight at USB, and USB serial
+blocks when no host is attached or its buffers fill - unbounded latency
+injected exactly where the 6 ms sensing cadence lives. The LOG_* macros
+instead format into a fixed-size record in a RAM ring buffer (a few
+microseconds, deterministic, never blocks) and a low-priority scheduler
+task drains the ring to USB serial only as fast as the port will take
+it without blocking. Records at LOG_MQTT_LEVEL or above are also
+forwarded on missing_link/log when the network is up, so field warnings
+reach the Pi without a laptop on a ladder. An optional UDP sink
+(logUdpCommand below) streams every record to a monitoring PC as
+fire-and-forget datagrams for full-verbosity tetherless debugging.
+
+When the ring fills, new records are dropped and counted; the drop
+count is reported in-band when space returns. Setup-time prints and the
+interactive status display stay on Serial directly - boot order and
+USB-attached debugging want the immediacy, and nothing there is on a
+latency-critical path.
+*/
+
+#ifndef LOG_H
+#define LOG_H
+
+#include <Arduino.h>
+
+#define LOG_LEVEL_ERROR 0
+#define LOG_LEVEL_WARN 1
+#define LOG_LEVEL_INFO 2
+#define LOG_LEVEL_DEBUG 3
+
+// Compile-time floor: records below this level compile to nothing.
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+// Records at this level or above are also published on missing_link/log.
+#ifndef LOG_MQTT_LEVEL
+#define LOG_MQTT_LEVEL LOG_LEVEL_WARN
+#endif
+
+// Payload text per record; longer messages are truncated.
+#define LOG_MSG_MAX 64
+
+// Enqueue one record. Use the macros below, not this directly.
+void logWrite(uint8_t level, const char *fmt, ...)
+    __attribute__((format(printf, 2, 3)));
+
+// Drain pending records to USB serial (and MQTT for warnings and up).
+// Registered as the low-priority "log" scheduler task.
+void logDrain();
+
+// UDP log sink control, registered on missing_link/log/udp:
+// {"enable":true,"ip":"192.168.4.50","port":5140}. With the sink on,
+// every drained record also goes out as a fire-and-forget datagram
+// ("<statue> <seq> <lvl> <us> <msg>") to the monitoring PC -
+// microsecond-scale send cost, all five statues on one laptop, no
+// serial tether. Omitted fields keep their previous values; the target
+// defaults to UDP_LOG_PC_IP.
+void logUdpCommand(const char *payload, unsigned int length);
+
+#define LOG_ERROR(...) logWrite(LOG_LEVEL_ERROR, __VA_ARGS__)
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN(...) logWrite(LOG_LEVEL_WARN, __VA_ARGS__)
+#else
+#define LOG_WARN(...)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(...) logWrite(LOG_LEVEL_INFO, __VA_ARGS__)
+#else
+#define LOG_INFO(...)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) logWrite(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...)
+#endif
+
+#endif // LOG_H
@@ -0,0 +1,178 @@
+/*
+MemMonitor.cpp - allocator sampling, largest-block probe, stack paint.
+
+Heap numbers come from two places: mallinfo() covers the arena newlib
+has already claimed (used vs free inside it), and _heap_end - __brkval
+is the OCRAM the allocator has not claimed yet. The largest-block probe
+binary-searches malloc/free once per telemetry window - a handful of
+transient allocations a minute, nothing on any hot path. Stack headroom
+is the classic paint: the gap between the end of .bss and the stack is
+filled with a pattern at boot and scanned from the bottom later; the
+first overwritten byte marks the deepest excursion so far.
+*/
+
+#include "MemMonitor.h"
+
+#include <Audio.h>
+#include <malloc.h>
+
+#include "DmaBuffer.h"
+#include "Log.h"
+#include "ScratchArena.h"
+
+// Teensy 4 linker symbols: unclaimed heap above __brkval, DTCM layout
+// for the stack guard region.
+extern char _heap_end[], *__brkval;
+extern char _ebss[];
+
+#define STACK_PAINT 0xA5
+// Keep well clear of the live stack when painting at boot.
+#define STACK_PAINT_MARGIN 1024
+
+static char *paintLow = NULL;
+static char *paintHigh = NULL;
+
+// Allocated-bytes reading at the end of the previous window, for the
+// churn delta.
+static int32_t lastUsedBytes = 0;
+
+// Audio pool tracking: the configured pool size (0 until AudioSense
+// registers it), per-configuration high-water marks, and the one-shot
+// margin warning. Keep at least this many blocks between the lifetime
+// high-water and the pool before calling the pool right-sized.
+#define AUDIO_POOL_WARN_MARGIN 4
+
+static int audioPoolBlocks = 0;
+static uint16_t audioPoolHw[AUDIO_POOL_CONFIGS] = {0};
+static bool audioPoolWarned = false;
+
+void memAudioPoolSetup(int poolBlocks) { audioPoolBlocks = poolBlocks; }
+
+void memAudioPoolSample(uint8_t cfg) {
+  if (cfg >= AUDIO_POOL_CONFIGS) {
+    return;
+  }
+  uint16_t use = (uint16_t)AudioMemoryUsage();
+  if (use > audioPoolHw[cfg]) {
+    audioPoolHw[cfg] = use;
+  }
+  if (!audioPoolWarned && audioPoolBlocks > 0 &&
+      AudioMemoryUsageMax() > audioPoolBlocks - AUDIO_POOL_WARN_MARGIN) {
+    audioPoolWarned = true;
+    LOG_WARN("Audio pool margin low: max %d of %d blocks",
+             AudioMemoryUsageMax(), audioPoolBlocks);
+  }
+}
+
+FLASHMEM void memMonitorSetup() {
+  // Paint from the end of .bss up to a safe margin below the current
+  // stack pointer. Anything between is stack the program has not used.
+  char *sp = (char *)__builtin_frame_address(0);
+  paintLow = _ebss;
+  paintHigh = sp - STACK_PAINT_MARGIN;
+  if (paintHigh > paintLow) {
+    memset(paintLow, STACK_PAINT, paintHigh - paintLow);
+  }
+  lastUsedBytes = (int32_t)mallinfo().uordblks;
+  Serial.printf("MemMonitor: painted %ld bytes of stack guard\n",
+                (long)(paintHigh - paintLow));
+}
+
+// Bytes of painted guard still untouched - the stack headroom floor.
+static uint32_t stackHeadroom() {
+  if (paintLow == NULL || paintHigh <= paintLow) {
+    return 0;
+  }
+  char *p = paintLow;
+  while (p < paintHigh && *p == (char)STACK_PAINT) {
+    p++;
+  }
+  return (uint32_t)(p - paintLow);
+}
+
+// Largest single block malloc will hand out right now, by binary search.
+// Transient allocations only; runs once per telemetry window.
+static uint32_t largestFreeBlock(uint32_t ceiling) {
+  uint32_t lo = 0;
+  uint32_t hi = ceiling;
+  while (hi - lo > 64) {
+    uint32_t mid = lo + (hi - lo) / 2;
+    void *p = malloc(mid);
+    if (p != NULL) {
+      free(p);
+      lo = mid;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+bool memMonitorCollect(char *json, size_t jsonLen) {
+  struct mallinfo mi = mallinfo();
+  uint32_t unclaimed = (uint32_t)(_heap_end - __brkval);
+  uint32_t freeTotal = unclaimed + (uint32_t)mi.fordblks;
+  uint32_t largest = largestFreeBlock(freeTotal);
+  int32_t used = (int32_t)mi.uordblks;
+  int32_t churn = used - lastUsedBytes;
+  lastUsedBytes = used;
+
+  int len = snprintf(
+      json, jsonLen,
+      "{\"free\":%lu,\"largest\":%lu,\"used\":%ld,\"churn\":%ld,"
+      "\"stack_free\":%lu,\"audio_mx\":%d,\"audio_pool\":%d,"
+      "\"audio_hw\":[%u,%u,%u,%u],\"dma_pool\":%lu,\"scratch_hw\":%lu}",
+      (unsigned long)freeTotal, (unsigned long)largest, (long)used,
+      (long)churn, (unsigned long)stackHeadroom(), AudioMemoryUsageMax(),
+      audioPoolBlocks, audioPoolHw[AUDIO_POOL_DORMANT],
+      audioPoolHw[AUDIO_POOL_LINKED], audioPoolHw[AUDIO_POOL_MULTI],
+      audioPoolHw[AUDIO_POOL_FADING], (unsigned long)dmaPoolUsed(),
+      (unsigned long)scratchHighWater());
+  return len > 0 && (size_t)len < jsonLen;
+}
+
+void memHeapBrief(char *out, size_t outLen) {
+  struct mallinfo mi = mallinfo();
+  uint32_t freeTotal = (uint32_t)(_heap_end - __brkval) + (uint32_t)mi.fordblks;
+  snprintf(out, outLen, "HEAP %luk free u:%luk", (unsigned long)(freeTotal / 1024),
+           (unsigned long)((uint32_t)mi.uordblks / 1024));
+}
+
+void memStackBrief(char *out, size_t outLen) {
+  snprintf(out, outLen, "STK %lu AUDmx %d", (unsigned long)stackHeadroom(),
+           AudioMemoryUsageMax());
+}
+
+uint32_t memFreeBytes() {
+  return (uint32_t)(_heap_end - __brkval) + (uint32_t)mallinfo().fordblks;
+}
+
+// Link-map audit (see the placement notes in MemMonitor.h). The
+// addresses of these symbols are the values; _itcm_block_count and
+// _flashimagelen are absolute symbols, not objects.
+extern char _stext[], _etext[], _sdata[], _heap_start[];
+extern char _itcm_block_count[], _flashimagelen[];
+extern char _extram_start[], _extram_end[];
+
+#define FLEXRAM_TOTAL (512u * 1024u)
+#define ITCM_BANK_BYTES 32768u
+
+bool memMapCollect(char *json, size_t jsonLen) {
+  uint32_t itcmUsed = (uint32_t)(_etext - _stext);
+  uint32_t itcmTotal = (uint32_t)_itcm_block_count * ITCM_BANK_BYTES;
+  uint32_t dtcmTotal = FLEXRAM_TOTAL - itcmTotal;
+  uint32_t dtcmStatic = (uint32_t)(_ebss - _sdata);
+  // OCRAM statics are the DMAMEM section; the heap claims the rest.
+  uint32_t ocramStatic = (uint32_t)(_heap_start - (char *)0x20200000);
+  uint32_t heapTotal = (uint32_t)(_heap_end - _heap_start);
+  int len = snprintf(
+      json, jsonLen,
+      "{\"itcm\":%lu,\"itcm_total\":%lu,\"dtcm\":%lu,\"dtcm_total\":%lu,"
+      "\"dmamem\":%lu,\"heap\":%lu,\"flash\":%lu,\"psram\":%lu}",
+      (unsigned long)itcmUsed, (unsigned long)itcmTotal,
+      (unsigned long)dtcmStatic, (unsigned long)dtcmTotal,
+      (unsigned long)ocramStatic, (unsigned long)heapTotal,
+      (unsigned long)(uint32_t)_flashimagelen,
+      (unsigned long)(uint32_t)(_extram_end - _extram_start));
+  return len > 0 && (size_t)len < jsonLen;
+}
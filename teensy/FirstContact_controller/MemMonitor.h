@@ -0,0 +1,71 @@
+/*
+MemMonitor: heap, fragmentation, and stack high-water telemetry.
+
+The heap profile over a multi-day burn was unknown: String temporaries
+in the config path and per-parse allocations churn the allocator, and
+fragmentation would only announce itself as a freeze at 3 AM. This
+module samples the newlib allocator (mallinfo plus the unclaimed sbrk
+region), probes the largest allocatable block, tracks the allocated-
+bytes delta per telemetry window as a churn signal, and reports the
+stack high-water mark from a painted guard region. The numbers ride
+the minute telemetry as missing_link/memory and show on the MEM
+diagnostics display page, so a fragmentation trend is visible days
+before it becomes an outage.
+
+Placement notes (i.MX RT1062): FlexRAM's 512 KB splits into ITCM and
+DTCM in 32 KB banks at link time, sized by how much code asks for
+ITCM; OCRAM (the DMAMEM section plus the heap) is slower and
+cache-mediated. The Teensy default puts every function in ITCM, so the
+deliberate architecture is subtractive: the hot kernels carry explicit
+FASTRUN (GoertzelBank.cpp, ImaAdpcm.cpp) as a guarantee, cold
+boot/rare-path code is FLASHMEM so it stops costing ITCM banks that
+could be DTCM, and bulk buffers (SD double buffer, MQTT queues, flight
+ring) are DMAMEM. memMapCollect() below reports what the linker
+actually did, so the per-region budgets are auditable from telemetry
+instead of a .map file on someone's laptop.
+*/
+
+#ifndef MEM_MONITOR_H
+#define MEM_MONITOR_H
+
+#include <Arduino.h>
+
+// Paint the unused stack region so the high-water mark is measurable.
+// Call early in setup(), before anything recurses deeply.
+void memMonitorSetup();
+
+// Fill `json` with a JSON object of heap/stack/audio-memory stats and
+// reset the per-window churn counter. Returns false on overflow.
+bool memMonitorCollect(char *json, size_t jsonLen);
+
+// One-line summaries for the diagnostics display page (non-destructive).
+void memHeapBrief(char *out, size_t outLen);
+void memStackBrief(char *out, size_t outLen);
+
+// Total free heap right now (allocator free lists plus unclaimed sbrk
+// region). Cheap and non-destructive, for the telemetry superframe.
+uint32_t memFreeBytes();
+
+// Fill `json` with the link-map audit: per-region sizes (ITCM used and
+// bank total, DTCM statics and total, OCRAM statics, heap span, flash
+// image, PSRAM if fitted) from the linker symbols. Static after link,
+// so it publishes once per boot (missing_link/memmap).
+bool memMapCollect(char *json, size_t jsonLen);
+
+// Audio pool instrumentation. The AudioMemory() pool size was guesswork;
+// these per-graph-configuration high-water marks (sampled from the sense
+// task, a variable read) show what each phase of an event cycle actually
+// queues, so the pool constant in AudioSense.ino can track the measured
+// worst case instead. A warning fires once if the lifetime high-water
+// ever erodes the configured margin.
+enum AudioPoolConfig : uint8_t {
+  AUDIO_POOL_DORMANT = 0, // No links, music idle
+  AUDIO_POOL_LINKED,      // One link and/or music playing
+  AUDIO_POOL_MULTI,       // Two or more simultaneous links
+  AUDIO_POOL_FADING,      // Fade-out / idle-out in progress
+  AUDIO_POOL_CONFIGS
+};
+void memAudioPoolSetup(int poolBlocks);
+void memAudioPoolSample(uint8_t cfg);
+
+#endif // MEM_MONITOR_H
@@ -6,6 +6,7 @@ Messaging: MQTT, state publishing, and LED state logic.
 #define MESSAGING_H
 
 #include "AudioSense.h"
+#include "SignalSnapshot.h"
 #include <Arduino.h>
 #include <PubSubClient.h>
 
@@ -16,13 +17,13 @@ struct TeensyConfig {
 
   // Informational fields from Pi config
   int emitFreq;            // Transmit frequency (read-only, for verification)
-  String detectStatues[4]; // List of detectable statues (informational)
+  char detectStatues[4][12]; // List of detectable statues (informational)
 
   // Constructor with defaults
   TeensyConfig() : threshold(0.01), emitFreq(0) {
     // Initialize detect array as empty
     for (int i = 0; i < 4; i++) {
-      detectStatues[i] = "";
+      detectStatues[i][0] = '\0';
     }
   }
 };
@@ -37,12 +38,40 @@ void applyConfig();
 void parseConfig(const char *json, unsigned int length);
 
 // MQTT callbacks and helper functions
-void mqttSubCallback(char *topic, byte *payload, unsigned int length);
 void reconnect();
 void mqttLoop();
+void mqttInboundLoop();
 void initMqtt();
 void publishState(ContactState state);
 void publishSignals();
+void publishDiagnostics();
+void publishStorageStats();
+void publishSdBenchReport();
+void publishNetworkStats();
+void publishTaskStats();
+void publishMemoryStats();
+void publishMemMapReport();
+void publishAudioNodeStats();
+void publishIsrStats();
+void publishShadowStats();
+void publishWatchdogReport();
+void publishFaultReport();
+void publishSdMountFault(int attempts);
+void publishBootReport();
+void publishTelemetryFrame(const SignalSnapshot &snapshot);
+void publishTelemetrySchema();
+
+// Remap a missing_link topic onto this board's ring (MY_RING_ID,
+// StatueConfig.h): identity on ring 1, missing_linkN root on ring N>=2.
+// The returned pointer is valid until the next call - pass it straight
+// into publish/subscribe, never store it.
+const char *ringTopic(const char *topic);
+
+// Fault-injection builds only (FAULT_INJECT, defines.h): push a payload
+// through the dispatch table exactly as the receive path would and
+// return the handler's wall time in microseconds (-1: unknown topic).
+long mqttInjectInbound(const char *topic, const char *payload,
+                       unsigned int length);
 // LED functions removed - now handled by Pi controller
 // bool setInactiveLedState();
 // bool setActiveLedState();
@@ -1,92 +1,1270 @@
 #include "AudioSense.h"
+#include "AudioTap.h"
+#include "BootProfile.h"
+#include "ConfigStore.h"
+#include "Display.h"
+#include "EventJournal.h"
+#include "FaultDump.h"
+#include "FaultInject.h"
+#include "FilePublish.h"
+#include "FixedString.h"
+#include "FlightRecorder.h"
+#include "DutyCycle.h"
+#include "FreqRealloc.h"
+#include "FreqSweep.h"
+#include "Haptics.h"
+#include "IsrTrace.h"
+#include "JsonWriter.h"
+#include "LatencyMarkers.h"
+#include "Log.h"
+#include "MemMonitor.h"
 #include "Messaging.h"
+#include "NetClock.h"
 #include "Networking.h"
+#include "PeerLink.h"
+#include "PowerGovernor.h"
+#include "AudioNodeStats.h"
+#include "SdArbiter.h"
+#include "SdBench.h"
+#include "SelfTest.h"
+#include "SignalSnapshot.h"
 #include "StatueConfig.h"
+#include "StorageStats.h"
+#include "TaskScheduler.h"
+#include "TdmSchedule.h"
+#include "TelemetrySpool.h"
+#include "TxLevel.h"
+#include "Watchdog.h"
 #include "defines.h"
 #include <ArduinoJson.h>
 #include <math.h>
 
-// External function from StatueConfig.cpp
-extern int getStatueIndex(const char *name);
-
 // Use accessor to get the EthernetClient instance
 PubSubClient client(getEthClient());
 
 // Global configuration instance
 TeensyConfig teensyConfig;
 
-// Track last config request time
-unsigned long lastConfigRequestMs = 0;
-const unsigned long CONFIG_REQUEST_INTERVAL_MS =
-    60000; // Request config every 60 seconds
+/*
+  Topic dispatch table. The subscribe callback used to rebuild the tone-control
+  topic string (String + toLowerCase + snprintf) on every message and walk
+  an if/strcmp chain that grew with each new topic. The registry below is
+  built once in initMqtt(): precomputed topic strings with their hashes
+  mapped to handler functions, so per-message dispatch is a hash compare
+  per entry (strcmp only on the matching hash) with zero allocation. The
+  same table drives the subscriptions after connect, so adding a topic is
+  one registerTopic() line.
+*/
+// Sized with headroom over the current registrations (20 shared + tone
+// + retained config + NUM_STATUES-1 presence + the fault-injection
+// build's command topic = 27): registerTopic() drops overflow with only
+// a serial message, so running the table full costs a silent topic.
+#define MAX_TOPIC_HANDLERS 30
+#define TOPIC_NAME_MAX 40
+
+typedef void (*TopicHandler)(const char *payload, unsigned int length);
+
+struct TopicEntry {
+  char topic[TOPIC_NAME_MAX];
+  uint32_t hash;
+  TopicHandler handler;
+  bool inlineDispatch; // Run inside client.loop() instead of deferring
+};
+
+static TopicEntry topicTable[MAX_TOPIC_HANDLERS];
+static int topicCount = 0;
+
+// djb2 - cheap and collision-free over our handful of fixed topics (the
+// strcmp on a hash match makes a collision harmless anyway).
+static uint32_t topicHash(const char *s) {
+  uint32_t h = 5381;
+  while (*s != '\0') {
+    h = ((h << 5) + h) + (uint8_t)*s++;
+  }
+  return h;
+}
+
+/*
+  Ring scoping for multi-installation sites (see MY_RING_ID in
+  StatueConfig.h). Every topic in the codebase is written against the
+  missing_link root; this remaps it onto the board's ring at the two
+  chokepoints - registration (which covers subscription and dispatch)
+  and the publish calls - so ring 1 stays byte-identical on the wire
+  and ring N>=2 moves wholesale under missing_linkN. The returned
+  pointer is valid until the next call: pass it straight into
+  publish/subscribe, never store it. (The wled/{statue} topics are
+  deliberately unscoped - the rings' statue names differ, and the LED
+  controllers are addressed per statue.)
+*/
+const char *ringTopic(const char *topic) {
+  if (MY_RING_ID <= 1 || strncmp(topic, "missing_link/", 13) != 0) {
+    return topic;
+  }
+  static char scoped[TOPIC_NAME_MAX + 8];
+  snprintf(scoped, sizeof(scoped), "missing_link%d/%s", MY_RING_ID,
+           topic + 13);
+  return scoped;
+}
+
+static void registerTopic(const char *topic, TopicHandler handler) {
+  if (topicCount >= MAX_TOPIC_HANDLERS) {
+    Serial.printf("Topic table full; cannot register %s\n", topic);
+    return;
+  }
+  TopicEntry &entry = topicTable[topicCount++];
+  // Own-ring scoping here covers both the subscription and the inbound
+  // hash dispatch: the other ring's traffic never reaches this board.
+  strlcpy(entry.topic, ringTopic(topic), sizeof(entry.topic));
+  entry.hash = topicHash(entry.topic);
+  entry.handler = handler;
+  entry.inlineDispatch = false;
+}
+
+// For the few handlers that timestamp on arrival (time sync, latency
+// pong): deferral would fold queue latency into their measurements, so
+// they keep running synchronously. Only cheap handlers qualify.
+static void registerTopicInline(const char *topic, TopicHandler handler) {
+  registerTopic(topic, handler);
+  topicTable[topicCount - 1].inlineDispatch = true;
+}
+
+// ------ Per-topic handlers (payload is NUL-terminated) ------
+
+static void handleConfigResponse(const char *payload, unsigned int length) {
+  Serial.println("Received configuration from controller");
+  parseConfig(payload, length);
+}
+
+// Version of the last configuration applied. Retained replays and
+// duplicates carry an equal or older version and are skipped without the
+// 2 KB document parse.
+static uint32_t lastConfigVersion = 0;
+
+// Cheap version probe: find "version": N without a full JSON parse.
+// Returns -1 when the document carries no version (legacy config).
+static long extractConfigVersion(const char *payload) {
+  const char *v = strstr(payload, "\"version\"");
+  if (v == NULL) {
+    return -1;
+  }
+  v = strchr(v + 9, ':');
+  if (v == NULL) {
+    return -1;
+  }
+  return atol(v + 1);
+}
+
+// Retained per-statue config (missing_link/config/<name>). The broker
+// replays it on every subscribe, so the version gate keeps steady-state
+// parse work at zero.
+static void handleRetainedConfig(const char *payload, unsigned int length) {
+  long version = extractConfigVersion(payload);
+  if (version >= 0 && (uint32_t)version <= lastConfigVersion) {
+    return; // Already applied this version
+  }
+  Serial.println("Applying retained configuration");
+  parseConfig(payload, length);
+  if (version > 0) {
+    lastConfigVersion = (uint32_t)version;
+  }
+}
+
+// Small config deltas ({"version":N,"statue":"eros","threshold":0.02})
+// bypass full-document parsing so a threshold tweak applies in
+// milliseconds.
+static void handleConfigDelta(const char *payload, unsigned int length) {
+  StaticJsonDocument<128> doc;
+  if (deserializeJson(doc, payload, length) != DeserializationError::Ok) {
+    return;
+  }
+  int idx = getStatueIndex(doc["statue"] | "");
+  if (idx < 0 || idx >= MAX_STATUES) {
+    return;
+  }
+  if (doc.containsKey("threshold")) {
+    float newThreshold =
+        constrain(doc["threshold"].as<float>(), 0.001, 1.0);
+    if (STATUE_THRESHOLDS[idx] != newThreshold) {
+      Serial.printf("Delta: %s threshold -> %.4f\n", STATUE_NAMES[idx],
+                    (double)newThreshold);
+      STATUE_THRESHOLDS[idx] = newThreshold;
+      updateDetectorThresholds();
+    }
+  }
+  long version = doc["version"] | -1;
+  if (version > 0) {
+    lastConfigVersion = (uint32_t)version;
+  }
+}
+
+/*
+  Live tuning service (missing_link/tune). One parameter per message:
+    {"param":"threshold","statue":"elektra","value":0.02}
+    {"param":"pair_threshold","statue":"eros","target":"elektra","value":0.02}
+    {"param":"unlink_ratio","statue":"elektra","value":0.7}
+    {"param":"transition_buffer_ms","value":150}
+    {"param":"main_period_ms","value":100}
+    {"param":"music_hp_hz","value":4200}          // 0 disables
+    {"param":"channel_mask","statue":"elektra","value":3}
+    {"param":"resume_fade_ms","value":400}
+    {"param":"fade_out_ms","value":1500}
+    {"param":"unlink_grace_ms","value":300}       // 0 disables
+  Sense-path parameters are staged into a shadow block and swapped in by
+  the sense tick between periods (see audioSenseStageTuning), so the hot
+  path never reads a half-updated value; the ack on missing_link/tune/ack
+  publishes only after the tick reports the swap, giving the operator
+  sub-second confirmation instead of the 60 s config cycle. An optional
+  "only" field names one statue when a board-local parameter should not
+  apply installation-wide.
+*/
+extern uint16_t resumeFadeMs; // MusicPlayer.ino
+extern uint16_t fadeOutMs;    // MusicPlayer.ino
+extern uint16_t unlinkGraceMs; // MusicPlayer.ino
+extern uint16_t main_period_ms; // AudioSense.ino
+
+// Ack bookkeeping: staged applies acknowledge once the sense tick has
+// consumed their sequence number; immediate applies acknowledge with
+// seq 0 on the next mqttLoop pass.
+static bool tuneAckPending = false;
+static uint32_t tuneAckSeq = 0;
+static char tuneAckParam[24];
+static float tuneAckValue = 0.0f;
+
+static void handleTuneCmd(const char *payload, unsigned int length) {
+  StaticJsonDocument<192> doc;
+  if (deserializeJson(doc, payload, length) != DeserializationError::Ok) {
+    return;
+  }
+  const char *only = doc["only"] | "";
+  if (only[0] != '\0' && strcasecmp(only, MY_STATUE_NAME) != 0) {
+    return; // Addressed to another statue
+  }
+  const char *param = doc["param"] | "";
+  float value = doc["value"] | 0.0f;
+  uint32_t seq = 0;
+
+  if (strcmp(param, "threshold") == 0) {
+    int idx = getStatueIndex(doc["statue"] | "");
+    if (idx < 0) {
+      return;
+    }
+    STATUE_THRESHOLDS[idx] = constrain(value, 0.001, 1.0);
+    seq = audioSenseStageTuning();
+  } else if (strcmp(param, "pair_threshold") == 0) {
+    int idx = getStatueIndex(doc["statue"] | "");
+    int target = getStatueIndex(doc["target"] | "");
+    if (idx < 0 || target < 0 || idx == target) {
+      return;
+    }
+    STATUE_PAIR_THRESHOLDS[idx][target] = constrain(value, 0.001, 1.0);
+    seq = audioSenseStageTuning();
+  } else if (strcmp(param, "unlink_ratio") == 0) {
+    int idx = getStatueIndex(doc["statue"] | "");
+    if (idx < 0) {
+      return;
+    }
+    STATUE_UNLINK_RATIOS[idx] = constrain(value, 0.3f, 1.0f);
+    seq = audioSenseStageTuning();
+  } else if (strcmp(param, "transition_buffer_ms") == 0) {
+    tuneTransitionBufferMs = (uint16_t)constrain(value, 0.0f, 5000.0f);
+    seq = audioSenseStageTuning();
+  } else if (strcmp(param, "main_period_ms") == 0) {
+    // Structural: the detector windows must be rebuilt, which already
+    // runs under AudioNoInterrupts in retuneAudioSense().
+    main_period_ms = (uint16_t)constrain(value, 20.0f, 1000.0f);
+    retuneAudioSense();
+  } else if (strcmp(param, "music_hp_hz") == 0) {
+    // Structural: rewrites biquad coefficients under AudioNoInterrupts.
+    audioSenseSetMusicHighpass(value);
+  } else if (strcmp(param, "channel_mask") == 0) {
+    int idx = getStatueIndex(doc["statue"] | "");
+    if (idx < 0) {
+      return;
+    }
+    audioSenseSetChannelMask(idx, (uint8_t)value);
+  } else if (strcmp(param, "resume_fade_ms") == 0) {
+    resumeFadeMs = (uint16_t)constrain(value, 0.0f, 10000.0f);
+  } else if (strcmp(param, "fade_out_ms") == 0) {
+    fadeOutMs = (uint16_t)constrain(value, 0.0f, 10000.0f);
+  } else if (strcmp(param, "unlink_grace_ms") == 0) {
+    unlinkGraceMs = (uint16_t)constrain(value, 0.0f, 5000.0f);
+  } else {
+    LOG_WARN("tune: unknown param %s", param);
+    return;
+  }
+
+  strlcpy(tuneAckParam, param, sizeof(tuneAckParam));
+  tuneAckValue = value;
+  tuneAckSeq = seq;
+  tuneAckPending = true;
+}
+
+// Publish the ack once the staged block (if any) has been swapped in.
+static void pollTuneAck() {
+  if (!tuneAckPending ||
+      (tuneAckSeq != 0 && audioSenseTuneApplied() < tuneAckSeq)) {
+    return;
+  }
+  char payload[128];
+  JsonWriter json(payload, sizeof(payload));
+  json.beginObject();
+  json.kv("statue", MY_STATUE_NAME_LC);
+  json.kv("param", tuneAckParam);
+  json.kv("value", tuneAckValue, 4);
+  json.kv("ms", (uint32_t)millis());
+  json.endObject();
+  client.publish(ringTopic("missing_link/tune/ack"), payload);
+  tuneAckPending = false;
+}
+
+// Flight recorder control: {"record":true|false} arms/disarms the trace,
+// {"replay":true} re-runs the recorded trace through the debounce logic
+// (summary lands in the log / missing_link/log).
+static void handleRecorderCmd(const char *payload, unsigned int length) {
+  StaticJsonDocument<96> doc;
+  if (deserializeJson(doc, payload, length) != DeserializationError::Ok) {
+    return;
+  }
+  if (doc.containsKey("record")) {
+    flightRecorderSetEnabled(doc["record"].as<bool>());
+  }
+  if (doc["replay"] | false) {
+    flightRecorderStartReplay();
+  }
+}
+
+// On-device SD benchmark control: {"run":true} starts the block-size
+// sweep (SdBench.h); the verdict publishes on missing_link/bench.
+static void handleBenchCmd(const char *payload, unsigned int length) {
+  StaticJsonDocument<64> doc;
+  if (deserializeJson(doc, payload, length) != DeserializationError::Ok) {
+    return;
+  }
+  if (doc["run"] | false) {
+    sdBenchStart();
+  }
+}
 
-void mqttSubCallback(char *topic, byte *payload, unsigned int length) {
-  Serial.print("\nmqttSubCallback() Message arrived [");
-  Serial.print(topic);
-  Serial.print("] ");
+// Shadow A/B comparison control: {"enabled":true} starts the candidate
+// from the production configuration; optional "statue"+"threshold" and
+// "transition_buffer_ms" override it. Divergence counts ride the
+// telemetry cycle on missing_link/shadow/stats.
+static void handleShadowCmd(const char *payload, unsigned int length) {
+  StaticJsonDocument<128> doc;
+  if (deserializeJson(doc, payload, length) != DeserializationError::Ok) {
+    return;
+  }
+  if (doc.containsKey("enabled")) {
+    audioSenseShadowEnable(doc["enabled"].as<bool>());
+  }
+  if (doc.containsKey("statue") && doc.containsKey("threshold")) {
+    audioSenseShadowSetThreshold(getStatueIndex(doc["statue"] | ""),
+                                 doc["threshold"].as<float>());
+  }
+  if (doc.containsKey("transition_buffer_ms")) {
+    audioSenseShadowSetTransitionMs(doc["transition_buffer_ms"].as<int>());
+  }
+}
+
+// Publish the lifetime interaction counters for grant reporting:
+// total events ever journaled plus this boot's link/unlink counts.
+static void publishJournalStats() {
+  char jsonMsg[192];
+  JsonWriter json(jsonMsg, sizeof(jsonMsg));
+  json.beginObject();
+  json.kv("statue", MY_STATUE_NAME_LC);
+  json.kv("events", journalNextSeq());
+  json.kv("boot_links", journalBootLinks());
+  json.kv("boot_unlinks", journalBootUnlinks());
+  json.endObject();
+  client.publish(ringTopic("missing_link/journal/stats"), jsonMsg);
+}
 
-  // Convert payload to string for easier processing
-  char payloadStr[length + 1];
-  for (unsigned int i = 0; i < length; i++) {
-    payloadStr[i] = (char)payload[i];
-    Serial.print((char)payload[i]);
+// Publish the most recent `count` journal records, oldest first, in
+// batches small enough for the 1024-byte client buffer.
+#define JOURNAL_PULL_MAX 32
+#define JOURNAL_EVENTS_PER_MSG 6
+static void publishJournalEvents(int count) {
+  static JournalRecord records[JOURNAL_PULL_MAX];
+  if (count > JOURNAL_PULL_MAX) {
+    count = JOURNAL_PULL_MAX;
   }
-  payloadStr[length] = '\0';
-  Serial.println();
+  int got = journalReadTail(records, count);
+  for (int start = 0; start < got; start += JOURNAL_EVENTS_PER_MSG) {
+    char jsonMsg[768];
+    JsonWriter json(jsonMsg, sizeof(jsonMsg));
+    json.beginObject();
+    json.kv("statue", MY_STATUE_NAME_LC);
+    json.key("events");
+    json.beginArray();
+    for (int i = start; i < got && i < start + JOURNAL_EVENTS_PER_MSG; i++) {
+      const JournalRecord &rec = records[i];
+      json.beginObject();
+      json.kv("seq", rec.seq);
+      json.kv("t", rec.epochMs);
+      json.kv("up", rec.uptimeMs);
+      json.kv("ev", rec.type == JOURNAL_EVENT_LINK ? "link" : "unlink");
+      json.kv("with", STATUE_NAMES_LC[rec.statue]);
+      json.kv("mask", (uint32_t)rec.mask);
+      json.kv("q", (uint32_t)rec.quality);
+      json.endObject();
+    }
+    json.endArray();
+    json.endObject();
+    if (json.ok()) {
+      client.publish(ringTopic("missing_link/journal/events"), jsonMsg);
+    }
+  }
+}
 
-  // Check if this is a configuration response
-  if (strcmp(topic, "missing_link/config/response") == 0) {
-    Serial.println("Received configuration from controller");
-    parseConfig(payloadStr, length);
+// Event journal retrieval: {"last":N} publishes the most recent N events
+// on missing_link/journal/events; anything else (including {}) publishes
+// the lifetime counters on missing_link/journal/stats.
+static void handleJournalCmd(const char *payload, unsigned int length) {
+  StaticJsonDocument<96> doc;
+  if (deserializeJson(doc, payload, length) != DeserializationError::Ok) {
     return;
   }
+  int last = doc["last"] | 0;
+  if (last > 0) {
+    publishJournalEvents(last);
+  } else {
+    publishJournalStats();
+  }
+}
 
-  // Build expected tone control topic for this statue
-  char toneTopic[32];
-  String statueName = String(MY_STATUE_NAME);
-  statueName.toLowerCase();
-  snprintf(toneTopic, sizeof(toneTopic), "statue/%s/tone", statueName.c_str());
+// Pi-orchestrated haptic cue: {"statue":"eros"} fires the notification
+// pulse train; an optional "pattern" picks another envelope, with
+// "loop" for the repeating ones. The payload is a handful of bytes, so
+// the small stack document keeps the inline dispatch path cheap - the
+// cue lands within the same mqttLoop() pass that read it, and the
+// pattern engine steps from its timer ISR after that.
+static void handleHapticCmd(const char *payload, unsigned int length) {
+  StaticJsonDocument<96> doc;
+  if (deserializeJson(doc, payload, length) != DeserializationError::Ok) {
+    return;
+  }
+  const char *target = doc["statue"] | "";
+  if (strcasecmp(target, MY_STATUE_NAME) != 0) {
+    return; // Cue addressed to another statue
+  }
+  const char *pattern = doc["pattern"] | "pulses";
+  bool loop = doc["loop"] | false;
+  if (strcmp(pattern, "swell") == 0) {
+    hapticPlay(HAPTIC_PATTERN_SWELL, loop);
+  } else if (strcmp(pattern, "heartbeat") == 0) {
+    hapticPlay(HAPTIC_PATTERN_HEARTBEAT, loop);
+  } else if (strcmp(pattern, "none") == 0) {
+    hapticPlay(HAPTIC_PATTERN_NONE, false);
+  } else {
+    hapticPlay(HAPTIC_PATTERN_PULSES, loop);
+  }
+}
 
-  // Check if this is a tone control message for this statue
-  if (strcmp(topic, toneTopic) == 0) {
-    if (strcmp(payloadStr, "ON") == 0) {
-      setToneEnabled(true);
-    } else if (strcmp(payloadStr, "OFF") == 0) {
-      setToneEnabled(false);
+// File retrieval (FilePublish.h): {"statue":"eros","file":"EVENTS.BIN"}
+// streams the named file to the Pi in chunks. Addressed like the sweep
+// command - every statue sees the topic, only the named one answers.
+static void handleFileCmd(const char *payload, unsigned int length) {
+  StaticJsonDocument<128> doc;
+  if (deserializeJson(doc, payload, length) != DeserializationError::Ok) {
+    return;
+  }
+  const char *target = doc["statue"] | "";
+  if (strcasecmp(target, MY_STATUE_NAME) != 0) {
+    return;
+  }
+  const char *file = doc["file"] | "";
+  if (file[0] != '\0') {
+    filePublishStart(file);
+  }
+}
+
+// On-demand I/Q diagnostics (phase + magnitude per detector)
+static void handleDiagRequest(const char *payload, unsigned int length) {
+  (void)payload;
+  (void)length;
+  publishDiagnostics();
+}
+
+static void handleSweepCmd(const char *payload, unsigned int length) {
+  StaticJsonDocument<192> doc;
+  if (deserializeJson(doc, payload, length) == DeserializationError::Ok) {
+    // Only the addressed statue transmits; everyone else probes on the
+    // step announcements.
+    const char *target = doc["statue"] | "";
+    if (strcasecmp(target, MY_STATUE_NAME) == 0) {
+      startFrequencySweep(doc["start"] | 5000, doc["stop"] | 20000,
+                          doc["step"] | 250, doc["dwell_ms"] | 200);
+    }
+  }
+}
+
+static void handleSweepStepMsg(const char *payload, unsigned int length) {
+  StaticJsonDocument<128> doc;
+  if (deserializeJson(doc, payload, length) == DeserializationError::Ok) {
+    handleSweepStep(doc["statue"] | "", doc["freq"] | 0);
+  }
+}
+
+static void handleSweepEndMsg(const char *payload, unsigned int length) {
+  (void)payload;
+  (void)length;
+  handleSweepEnd();
+}
+
+// TDM slot epoch alignment beacon from the Pi
+static void handleTdmSync(const char *payload, unsigned int length) {
+  (void)payload;
+  (void)length;
+  tdmSyncBeacon();
+}
+
+// Raw audio UDP tap control (only the addressed statue streams)
+static void handleTapCmd(const char *payload, unsigned int length) {
+  StaticJsonDocument<192> doc;
+  if (deserializeJson(doc, payload, length) == DeserializationError::Ok) {
+    const char *target = doc["statue"] | "";
+    if (strcasecmp(target, MY_STATUE_NAME) != 0) {
+      return;
+    }
+    if (doc["enabled"] | false) {
+      startAudioTap(doc["ip"] | "", doc["port"] | 9990);
     } else {
-      Serial.print("Unknown tone command: ");
-      Serial.println(payloadStr);
+      stopAudioTap();
     }
   }
 }
 
+/*
+  MQTT round-trip latency probe. Touch-to-LED latency is the number the
+  installation lives or dies by, and the broker leg had no measurement.
+  Once a second we publish a timestamped ping on missing_link/ping; the Pi
+  reflects it on missing_link/pong, and the round trip lands in a log2
+  histogram (bucket n covers up to 2^n us). Once a minute the histogram is
+  summarized as p50/p99/max on missing_link/latency, so when the Pi's
+  WLED fan-out gets slow the broker leg shows separately from sensing.
+*/
+#define PING_INTERVAL_MS 1000
+#define LATENCY_REPORT_INTERVAL_MS 60000
+#define LATENCY_BUCKETS 24 // Bucket n: RTT <= 2^n us; 24 covers ~16 s
+
+static uint32_t latencyBuckets[LATENCY_BUCKETS];
+static uint32_t latencyCount = 0;
+static uint32_t latencyMaxUs = 0;
+static uint32_t pingSeq = 0;
+
+static void sendLatencyPing() {
+  char payload[96];
+  JsonWriter json(payload, sizeof(payload));
+  json.beginObject();
+  json.kv("statue", MY_STATUE_NAME_LC);
+  json.kv("seq", pingSeq++);
+  json.kv("us", (uint32_t)micros());
+  json.endObject();
+  client.publish(ringTopic("missing_link/ping"), payload);
+}
+
+// Reflected ping from the Pi; only our own echoes count.
+static void handlePong(const char *payload, unsigned int length) {
+  StaticJsonDocument<128> doc;
+  if (deserializeJson(doc, payload, length) != DeserializationError::Ok) {
+    return;
+  }
+  if (strcmp(doc["statue"] | "", MY_STATUE_NAME_LC) != 0) {
+    return;
+  }
+  uint32_t rtt = micros() - (doc["us"] | 0UL);
+  int bucket = 0;
+  while ((1UL << bucket) < rtt && bucket < LATENCY_BUCKETS - 1) {
+    bucket++;
+  }
+  latencyBuckets[bucket]++;
+  latencyCount++;
+  if (rtt > latencyMaxUs) {
+    latencyMaxUs = rtt;
+  }
+}
+
+// Smallest bucket bound covering `rank` samples.
+static uint32_t latencyPercentile(uint32_t rank) {
+  uint32_t cumulative = 0;
+  for (int i = 0; i < LATENCY_BUCKETS; i++) {
+    cumulative += latencyBuckets[i];
+    if (cumulative >= rank) {
+      return 1UL << i;
+    }
+  }
+  return latencyMaxUs;
+}
+
+static void publishLatencyStats() {
+  if (latencyCount == 0) {
+    return;
+  }
+  char payload[160];
+  JsonWriter json(payload, sizeof(payload));
+  json.beginObject();
+  json.kv("statue", MY_STATUE_NAME_LC);
+  json.kv("count", latencyCount);
+  json.kv("p50_us", latencyPercentile((latencyCount + 1) / 2));
+  json.kv("p99_us", latencyPercentile((latencyCount * 99 + 99) / 100));
+  json.kv("max_us", latencyMaxUs);
+  json.endObject();
+  client.publish(ringTopic("missing_link/latency"), payload);
+
+  memset(latencyBuckets, 0, sizeof(latencyBuckets));
+  latencyCount = 0;
+  latencyMaxUs = 0;
+}
+
+// On-screen diagnostics page control: {"page": "status"|"audio"|
+// "network"|"storage"|"next"}, optionally addressed to one statue.
+static void handleDisplayCmd(const char *payload, unsigned int length) {
+  StaticJsonDocument<128> doc;
+  if (deserializeJson(doc, payload, length) != DeserializationError::Ok) {
+    return;
+  }
+  const char *target = doc["statue"] | "";
+  if (target[0] != '\0' && strcasecmp(target, MY_STATUE_NAME) != 0) {
+    return;
+  }
+  const char *page = doc["page"] | "";
+  if (strcmp(page, "next") == 0) {
+    displayNextPage();
+  } else if (strcmp(page, "status") == 0) {
+    displaySetPage(DISPLAY_PAGE_STATUS);
+  } else if (strcmp(page, "audio") == 0) {
+    displaySetPage(DISPLAY_PAGE_AUDIO);
+  } else if (strcmp(page, "network") == 0) {
+    displaySetPage(DISPLAY_PAGE_NETWORK);
+  } else if (strcmp(page, "storage") == 0) {
+    displaySetPage(DISPLAY_PAGE_STORAGE);
+  } else if (strcmp(page, "tasks") == 0) {
+    displaySetPage(DISPLAY_PAGE_TASKS);
+  } else if (strcmp(page, "memory") == 0) {
+    displaySetPage(DISPLAY_PAGE_MEMORY);
+  }
+}
+
+// Tone control for this statue (statue/<name>/tone)
+static void handleToneCmd(const char *payload, unsigned int length) {
+  (void)length;
+  if (strcmp(payload, "ON") == 0) {
+    setToneEnabled(true);
+  } else if (strcmp(payload, "OFF") == 0) {
+    setToneEnabled(false);
+  } else {
+    Serial.print("Unknown tone command: ");
+    Serial.println(payload);
+  }
+}
+
+// Peer presence (missing_link/presence/<peer>): the broker's retained
+// birth/will messages. A peer flipping offline drops its detector slot
+// out of the audio kernel; the birth message restores it and, since it
+// carries the peer's emit frequency, retunes the slot if the announced
+// plan differs from ours. The filter skips the boot breakdown the birth
+// payload carries.
+//
+// peerSeenMask records every peer that has ever appeared on a presence
+// topic this session, online or offline. Once the retained replay after
+// the first connect has had its grace window, slots of peers that never
+// announced are dropped (discoveryTrimLoop): detector time goes only to
+// statues that actually exist on this site, and a trimmed peer rejoins
+// the moment its birth message arrives. Before the first broker session
+// every slot stays armed, so sensing still works with the Pi down.
+#define PRESENCE_DISCOVERY_MS 5000
+static StatueMask peerSeenMask = 0;
+static uint32_t discoveryStartMs = 0; // 0 = no broker session yet
+static bool discoveryTrimmed = false;
+
+static void handlePeerPresence(const char *payload, unsigned int length) {
+  StaticJsonDocument<64> filter;
+  filter["statue"] = true;
+  filter["online"] = true;
+  filter["freq"] = true;
+  StaticJsonDocument<192> doc;
+  if (deserializeJson(doc, payload, length,
+                      DeserializationOption::Filter(filter)) !=
+      DeserializationError::Ok) {
+    return;
+  }
+  const char *name = doc["statue"] | "";
+  bool online = doc["online"] | true;
+  int freq = doc["freq"] | 0;
+  for (int i = 0; i < NUM_STATUES; i++) {
+    if (strcasecmp(name, STATUE_NAMES[i]) == 0) {
+      peerSeenMask |= (StatueMask)(1 << i);
+      // Frequency first: a re-enable below reads the frequency table.
+      if (online && freq > 0) {
+        audioSensePeerAnnounce(i, freq);
+      }
+      setDetectorPresence(i, online);
+      return;
+    }
+  }
+}
+
+// Drop the detector slots of peers that never announced, once the
+// retained presence replay has had time to arrive. One-shot per boot;
+// a late arrival re-enables through handlePeerPresence as usual.
+static void discoveryTrimLoop() {
+  if (discoveryTrimmed || discoveryStartMs == 0 ||
+      millis() - discoveryStartMs < PRESENCE_DISCOVERY_MS) {
+    return;
+  }
+  discoveryTrimmed = true;
+  for (int i = 0; i < NUM_STATUES; i++) {
+    if (i == MY_STATUE_INDEX || (peerSeenMask & (StatueMask)(1 << i))) {
+      continue;
+    }
+    Serial.printf("Discovery: %s never announced; dropping its slot\n",
+                  STATUE_NAMES[i]);
+    setDetectorPresence(i, false);
+  }
+}
+
+// Build the registry. Called once from initMqtt(), after the statue
+// identity (and so the lowercase name) is known.
+static void registerTopicHandlers() {
+  registerTopic("missing_link/config/response", handleConfigResponse);
+  registerTopic("missing_link/config/delta", handleConfigDelta);
+  registerTopic("missing_link/diag/request", handleDiagRequest);
+  registerTopic("missing_link/sweep/cmd", handleSweepCmd);
+  registerTopic("missing_link/sweep/step", handleSweepStepMsg);
+  registerTopic("missing_link/sweep/end", handleSweepEndMsg);
+  // Inline: the sync beat is timestamped on arrival (TdmSchedule.ino);
+  // a deferred dispatch would add queue latency to the slot clock.
+  registerTopicInline("missing_link/tdm/sync", handleTdmSync);
+  registerTopic("missing_link/tap/cmd", handleTapCmd);
+  // Inline: a haptic cue is a timing cue; the handler is a tiny parse
+  // and a pattern start, so it skips the deferred queue.
+  registerTopicInline("missing_link/haptic", handleHapticCmd);
+  registerTopic("missing_link/tune", handleTuneCmd);
+  registerTopic("missing_link/recorder", handleRecorderCmd);
+  registerTopic("missing_link/bench/cmd", handleBenchCmd);
+  registerTopic("missing_link/shadow", handleShadowCmd);
+  registerTopic("missing_link/journal", handleJournalCmd);
+  registerTopic("missing_link/file/cmd", handleFileCmd);
+  // Inline: the pong closes a round-trip measurement; queue latency
+  // would count against the broker leg.
+  registerTopicInline("missing_link/pong", handlePong);
+  registerTopic("missing_link/display", handleDisplayCmd);
+  registerTopic("missing_link/freq", handleFreqMsg);
+  // Peers' receive reports feed the TX amplitude loop (TxLevel.ino).
+  registerTopic("missing_link/signals", handleSignalsReport);
+  // Toggle the UDP log sink for tetherless field debugging (Log.h).
+  registerTopic("missing_link/log/udp", logUdpCommand);
+#if FAULT_INJECT
+  // Fault-injection build only: inject a link/SD/wedge/config fault and
+  // measure detection and recovery (FaultInject.h).
+  registerTopic("missing_link/fault/cmd", faultInjectCommand);
+#endif
+
+  // The statue-specific topics are formatted once, here, instead of on
+  // every incoming message.
+  char topic[TOPIC_NAME_MAX];
+  snprintf(topic, sizeof(topic), "statue/%s/tone", MY_STATUE_NAME_LC);
+  registerTopic(topic, handleToneCmd);
+
+  // Retained per-statue config: the broker replays the current document
+  // on subscribe, so a reconnect re-syncs config with no request cycle.
+  snprintf(topic, sizeof(topic), "missing_link/config/%s", MY_STATUE_NAME_LC);
+  registerTopic(topic, handleRetainedConfig);
+
+  // Every peer's presence topic, for detector gating. The broker replays
+  // the retained state on subscribe, so a reconnect re-syncs the mask.
+  for (int i = 0; i < NUM_STATUES; i++) {
+    if (i == MY_STATUE_INDEX) {
+      continue;
+    }
+    snprintf(topic, sizeof(topic), "missing_link/presence/%s",
+             STATUE_NAMES_LC[i]);
+    registerTopic(topic, handlePeerPresence);
+  }
+}
+
+/*
+  Zero-copy receive path (see PubSubClient::setSliceCallback). The library
+  NUL-terminates the payload inside its own receive buffer and hands the
+  dispatcher a view into it, so the per-message stack copy of every
+  payload is gone - for 1 KB config documents that was the largest single
+  copy on the receive path. The resolver maps the topic string to its
+  dispatch-table index once per message.
+*/
+static uint16_t resolveTopicId(const char *topic) {
+  uint32_t hash = topicHash(topic);
+  for (int i = 0; i < topicCount; i++) {
+    if (topicTable[i].hash == hash && strcmp(topicTable[i].topic, topic) == 0) {
+      return (uint16_t)i;
+    }
+  }
+  Serial.print("No handler for topic: ");
+  Serial.println(topic);
+  return MQTT_TOPIC_ID_NONE;
+}
+
+/*
+  Deferred dispatch. The slice callback runs inside client.loop()'s
+  socket read path, so a heavy handler - parseConfig()'s 2 KB document
+  parse is the worst - used to block further reads and everything after
+  mqttLoop() in the pass. The callback now just copies the message into
+  the ring below and the "mqttin" scheduler task dispatches from it with
+  a per-pass budget, so mqttLoop()'s cost no longer depends on which
+  handlers fired. The copy gives back some of the zero-copy win above,
+  but only on the deferred path, and a bounded loop is worth one memcpy.
+  Handlers registered with registerTopicInline() still run here.
+*/
+#define INBOUND_QUEUE_SIZE 4
+#define INBOUND_MAX_PAYLOAD 1024 // Matches the client's receive buffer
+#define INBOUND_MAX_DISPATCH_PER_PASS 2
+
+struct QueuedInbound {
+  uint16_t topicId;
+  uint16_t length;
+  char payload[INBOUND_MAX_PAYLOAD];
+};
+
+// DMAMEM (OCRAM): ~4 KB of queue payloads touched a few times per
+// message from loop context - bulk buffers like this don't earn DTCM
+// (placement notes in MemMonitor.h).
+DMAMEM static QueuedInbound inboundQueue[INBOUND_QUEUE_SIZE];
+static uint8_t inboundHead = 0;
+static uint8_t inboundCount = 0;
+static uint32_t inboundDropped = 0;
+
+static void dispatchMqttMessage(uint16_t topicId, const char *payload,
+                                uint16_t length) {
+  if (topicId == MQTT_TOPIC_ID_NONE) {
+    return; // resolveTopicId already logged the miss
+  }
+  if (topicTable[topicId].inlineDispatch) {
+    topicTable[topicId].handler(payload, length);
+    return;
+  }
+  if (inboundCount == INBOUND_QUEUE_SIZE || length >= INBOUND_MAX_PAYLOAD) {
+    // Newest-dropped, unlike the outbound ring: a queued config document
+    // must not be displaced by whatever arrives behind it.
+    inboundDropped++;
+    Serial.printf("Inbound queue full; dropped [%s] (%lu total)\n",
+                  topicTable[topicId].topic, (unsigned long)inboundDropped);
+    return;
+  }
+  QueuedInbound &slot =
+      inboundQueue[(inboundHead + inboundCount) % INBOUND_QUEUE_SIZE];
+  slot.topicId = topicId;
+  slot.length = length;
+  memcpy(slot.payload, payload, length);
+  slot.payload[length] = '\0'; // Handlers rely on NUL termination
+  inboundCount++;
+}
+
+// Scheduler task: dispatch a bounded slice of the inbound queue.
+void mqttInboundLoop() {
+  int dispatched = 0;
+  while (inboundCount > 0 && dispatched < INBOUND_MAX_DISPATCH_PER_PASS) {
+    QueuedInbound &slot = inboundQueue[inboundHead];
+    Serial.printf("\nMessage arrived [%s] %.*s\n",
+                  topicTable[slot.topicId].topic, (int)slot.length,
+                  slot.payload);
+    topicTable[slot.topicId].handler(slot.payload, slot.length);
+    inboundHead = (inboundHead + 1) % INBOUND_QUEUE_SIZE;
+    inboundCount--;
+    dispatched++;
+  }
+}
+
+#if FAULT_INJECT
+// Fault-injection build hook (FaultInject.cpp): run a payload through
+// the registered handler synchronously, bypassing the inbound queue so
+// the stopwatch covers exactly the parse-and-apply cost.
+long mqttInjectInbound(const char *topic, const char *payload,
+                       unsigned int length) {
+  uint16_t id = resolveTopicId(topic);
+  if (id == MQTT_TOPIC_ID_NONE) {
+    return -1;
+  }
+  unsigned long startUs = micros();
+  topicTable[id].handler(payload, length);
+  return (long)(micros() - startUs);
+}
+#endif
+
+// Non-blocking reconnect backoff. reconnect() used to spin with
+// delay(5000) until the broker answered, freezing contact sensing, music,
+// and haptics for the whole outage; now it makes at most one connection
+// attempt per call and mqttLoop() keeps stepping it while everything else
+// runs at full rate. The retry interval doubles per failure (1 s .. 30 s)
+// so a long broker outage doesn't hammer the network.
+#define MQTT_RETRY_MIN_MS 1000
+#define MQTT_RETRY_MAX_MS 30000
+static unsigned long lastConnectAttemptMs = 0;
+static unsigned long connectRetryMs = MQTT_RETRY_MIN_MS;
+
+// Double the retry interval after a failed attempt, up to the cap.
+static void bumpConnectBackoff() {
+  connectRetryMs *= 2;
+  if (connectRetryMs > MQTT_RETRY_MAX_MS) {
+    connectRetryMs = MQTT_RETRY_MAX_MS;
+  }
+}
+
+/*
+  Broker failover (see BROKER_CANDIDATES in Networking.ino). After a few
+  failed attempts against the active broker the supervisor advances to
+  the next candidate with the backoff reset, so a dead primary is
+  abandoned in a couple of seconds and a full scan of the list takes
+  single-digit seconds, forever, until something answers. While
+  connected to a non-primary broker, a background probe opens a bare
+  TCP connection to the primary every FAILBACK_PROBE_INTERVAL_MS; the
+  moment it accepts, the client drops the backup and reconnects to the
+  primary (which also restores OTA, song sync, and NTP to the Pi that
+  owns them). A true parallel probe of all candidates would need a
+  socket per candidate for a path that runs a handful of times per
+  event; sequential with a short per-candidate dwell hits the same
+  seconds-scale failover.
+*/
+#define MQTT_FAILOVER_AFTER_FAILURES 2
+#define FAILBACK_PROBE_INTERVAL_MS 30000
+#define FAILBACK_PROBE_TIMEOUT_MS 2000
+
+static uint8_t connectFailures = 0;
+
+// Shared failure path for both the immediate-fail and CONNACK-poll-fail
+// branches of reconnect().
+static void noteConnectFailure() {
+  bumpConnectBackoff();
+  if (++connectFailures < MQTT_FAILOVER_AFTER_FAILURES ||
+      brokerCandidateCount() < 2) {
+    return;
+  }
+  connectFailures = 0;
+  connectRetryMs = MQTT_RETRY_MIN_MS;
+  setActiveBroker((activeBrokerIndex() + 1) % brokerCandidateCount());
+  client.setServer(getServer(), 1883);
+}
+
+// Background fail-back probe; runs from mqttLoop() while connected to a
+// non-primary broker.
+static void failBackLoop() {
+  static EthernetClient probe;
+  static bool probing = false;
+  static unsigned long probeStartMs = 0;
+  static unsigned long lastProbeMs = 0;
+
+  if (activeBrokerIndex() == 0) {
+    return;
+  }
+  unsigned long now = millis();
+  if (!probing) {
+    if (lastProbeMs != 0 && now - lastProbeMs < FAILBACK_PROBE_INTERVAL_MS) {
+      return;
+    }
+    lastProbeMs = now;
+    probeStartMs = now;
+    probing = probe.connectNoWait(brokerCandidate(0), 1883);
+    return;
+  }
+  if (probe.connected()) {
+    probe.stop();
+    probing = false;
+    Serial.println("Broker: primary is back; failing back");
+    client.disconnect();
+    setActiveBroker(0);
+    client.setServer(getServer(), 1883);
+    connectFailures = 0;
+    connectRetryMs = MQTT_RETRY_MIN_MS;
+  } else if (!probe.connecting() ||
+             now - probeStartMs >= FAILBACK_PROBE_TIMEOUT_MS) {
+    probe.stop();
+    probing = false; // Still down; next interval retries
+  }
+}
+
+// ---- Presence (missing_link/presence/<statue>) ----
+// The broker holds a retained last-will registered at connect time: when
+// a statue loses power or the cable, the keepalive window expires and
+// the broker itself flips the topic to offline - the controller reacts
+// within ~1.5x the keepalive instead of timing out missed signal frames
+// while it keeps cueing WLED for a dead statue. The matching retained
+// birth message flips it back online and carries the boot breakdown.
+#define MQTT_PRESENCE_KEEPALIVE_S 5
+static char presenceTopic[48];
+static char presenceWill[64];
+
+// Socket timeout for the MQTT client. The vendored default (15 s) is
+// sized for WAN links; on the single-switch event LAN the RTT is
+// sub-millisecond, so 2 s is generous while cutting the worst-case
+// readPacket() stall and dead-connection detection by ~7x.
+#define MQTT_SOCKET_TIMEOUT_S 2
+
+// Build the will topic/payload once the statue identity is known; the
+// connect path reuses them on every attempt. Ring-scoped at build time:
+// the will topic is handed to the broker at CONNECT, so publish-time
+// remapping never sees it.
+static void buildPresenceWill() {
+  snprintf(presenceTopic, sizeof(presenceTopic), "%s/%s",
+           ringTopic("missing_link/presence"), MY_STATUE_NAME_LC);
+  snprintf(presenceWill, sizeof(presenceWill),
+           "{\"statue\":\"%s\",\"online\":false}", MY_STATUE_NAME_LC);
+}
+
+// Retained birth message; republished on every reconnect so the topic
+// always reflects the live session.
+static void publishPresenceBirth() {
+  char bootJson[256];
+  if (!bootProfileCollect(bootJson, sizeof(bootJson))) {
+    strcpy(bootJson, "{}");
+  }
+
+  // The birth doubles as the discovery announcement: the emit frequency
+  // lets peers build and retune their detector slots from what is
+  // actually on the air (see handlePeerPresence).
+  char jsonMsg[384];
+  snprintf(jsonMsg, sizeof(jsonMsg),
+           "{\"statue\":\"%s\",\"online\":true,\"freq\":%d,\"uptime_s\":%lu,"
+           "\"boot\":%s}",
+           MY_STATUE_NAME_LC, MY_TX_FREQ, (unsigned long)(millis() / 1000),
+           bootJson);
+  client.publish(presenceTopic, (const uint8_t *)jsonMsg, strlen(jsonMsg),
+                 true);
+}
+
+// Set on every (re)connect: the next superframe ships all sections and
+// a signals keyframe, because the outage may have swallowed the last
+// on-change publishes and the Pi's delta base with them (see
+// publishTelemetryFrame).
+static bool telemResync = true;
+
+// Post-CONNACK setup: subscriptions and the initial config request.
+static void onMqttConnected() {
+  Serial.println("MQTT connected");
+  connectRetryMs = MQTT_RETRY_MIN_MS;
+  connectFailures = 0;
+  if (activeBrokerIndex() != 0) {
+    Serial.printf("MQTT: on backup broker %d; fail-back probing primary\n",
+                  activeBrokerIndex());
+  }
+
+  // Subscribe to everything in the dispatch registry; the same table
+  // routes the incoming messages.
+  for (int i = 0; i < topicCount; i++) {
+    client.subscribe(topicTable[i].topic);
+    Serial.print("Subscribed to: ");
+    Serial.println(topicTable[i].topic);
+  }
+
+  // Request configuration after connecting
+  requestConfig();
+
+  // If the watchdog reset us last boot, say which stage hung. Once per
+  // boot - reconnects don't repeat an already-delivered report.
+  publishWatchdogReport();
+
+  // Same for a persisted crash record: deliver it, then clear it.
+  publishFaultReport();
+
+  // Boot-stage breakdown from this boot, once.
+  publishBootReport();
+
+  // Where the linker actually put everything (once per boot).
+  publishMemMapReport();
+
+  // Flip the retained presence topic online (pairs with the last-will
+  // registered at connect).
+  publishPresenceBirth();
+
+  // First broker session: open the discovery grace window. The retained
+  // presence replay lands within it; discoveryTrimLoop() then drops the
+  // slots of peers that never announced.
+  if (discoveryStartMs == 0) {
+    discoveryStartMs = millis();
+  }
+
+  // Retained decoder schema for the binary telemetry frame, published
+  // from flash (zero RAM; see TELEM_SCHEMA_JSON), and a full-section
+  // resync for the first frame after the outage.
+  publishTelemetrySchema();
+  telemResync = true;
+}
+
 void reconnect() {
-  while (!client.connected()) {
-    Serial.print("Attempting MQTT connection...");
-    if (client.connect(getHostname())) {
-      Serial.println("connected");
-
-      // Subscribe to configuration response topic
-      client.subscribe("missing_link/config/response");
-      Serial.println("Subscribed to: missing_link/config/response");
-
-      // Subscribe to statue-specific tone control topic
-      char toneTopic[32];
-      String statueName = String(MY_STATUE_NAME);
-      statueName.toLowerCase();
-      snprintf(toneTopic, sizeof(toneTopic), "statue/%s/tone",
-               statueName.c_str());
-      client.subscribe(toneTopic);
-      Serial.print("Subscribed to: ");
-      Serial.println(toneTopic);
-
-      // Request configuration after connecting
-      requestConfig();
+  // A handshake is already in flight: step it and finish the subscriptions
+  // when the CONNACK arrives. connectAsyncPoll() never blocks.
+  if (client.state() == MQTT_CONNECT_IN_PROGRESS) {
+    if (client.connectAsyncPoll()) {
+      onMqttConnected();
+    } else if (client.state() != MQTT_CONNECT_IN_PROGRESS) {
+      Serial.printf("MQTT connect failed, rc=%d, retry in %lu ms\n",
+                    client.state(), connectRetryMs);
+      noteConnectFailure();
+    }
+    return;
+  }
+
+  // Back off between attempts; everything outside this function keeps
+  // running while we wait.
+  unsigned long now = millis();
+  if (lastConnectAttemptMs != 0 &&
+      now - lastConnectAttemptMs < connectRetryMs) {
+    return;
+  }
+  lastConnectAttemptMs = now;
+
+  Serial.println("Attempting MQTT connection...");
+  // connectAsync() opens the socket and sends CONNECT without waiting for
+  // the broker's CONNACK; the poll branch above completes the handshake.
+  // The CONNECT registers the retained offline will so the broker
+  // announces our death without any controller-side timeout heuristic.
+  if (!client.connectAsync(getHostname(), presenceTopic, 0, true,
+                           presenceWill)) {
+    Serial.printf("MQTT connect failed, rc=%d, retry in %lu ms\n",
+                  client.state(), connectRetryMs);
+    noteConnectFailure();
+  } else {
+    // The socket is freshly opened: disable Nagle before any traffic that
+    // matters rides it (see tuneMqttSocket in Networking.ino).
+    tuneMqttSocket();
+  }
+}
+
+/*
+  Outbound publish queue. publishState() and publishSignals() used to push
+  synchronously through client.publish(); during link storms publishes
+  failed against socket backpressure and were dropped silently. The
+  publishers now enqueue, and drainPublishQueue() sends from mqttLoop():
+    - Contact events go through a FIFO ring in order and are retried until
+      the socket accepts them - a link event is never lost.
+    - Signal frames are latest-wins: an unsent frame is replaced by the
+      next one, since only the newest telemetry matters.
+  Sends per drain are capped to bound the worst-case loop time.
+
+  Behind the RAM ring sits the SD spool (TelemetrySpool.h) for broker
+  outages longer than eight events - a Pi reboot takes a minute or two
+  and a busy chain can produce dozens of link events in that window.
+  When the ring is full the oldest event spills onto the card instead of
+  being dropped, and signal frames (normally latest-wins) are sampled
+  into the spool during the outage so the record keeps some telemetry
+  texture. The drain replays the spool first - its frames predate
+  everything in the ring - and each frame carries the shared-clock "ts"
+  it was built with, so the Pi sees the true event times, not the
+  replay times.
+*/
+#define PUBLISH_QUEUE_SIZE 8
+#define PUBLISH_MAX_PAYLOAD 384
+#define PUBLISH_MAX_SENDS_PER_DRAIN 4
+
+struct QueuedPublish {
+  const char *topic; // Static topic string (never owned)
+  char payload[PUBLISH_MAX_PAYLOAD];
+};
+
+// During an outage, spool one signals frame at most this often.
+#define SPOOL_TELEMETRY_INTERVAL_MS 5000
+
+// DMAMEM: same placement call as the inbound queue above.
+DMAMEM static QueuedPublish eventQueue[PUBLISH_QUEUE_SIZE];
+static uint8_t eventHead = 0;
+static uint8_t eventCount = 0;
+static uint32_t eventsDropped = 0;
+static uint32_t framesSpooled = 0;
+static uint32_t framesReplayed = 0;
+
+#if QUAD_SENSE_INPUT
+DMAMEM static char telemetryFrame[768]; // The signals frame grows a channels map
+#else
+DMAMEM static char telemetryFrame[512];
+#endif
+static const char *telemetryTopic = nullptr; // nullptr = slot empty
+
+// Ordered, reliable: queued behind earlier events and retried on failure.
+static void enqueueEvent(const char *topic, const char *payload) {
+  if (eventCount == PUBLISH_QUEUE_SIZE) {
+    // Full only if the broker has been unreachable for many events.
+    // Spill the oldest to the SD spool so the record survives the
+    // outage; only if the spool itself refuses (card not up, cap hit,
+    // arbiter busy) does the old drop-oldest behavior apply.
+    QueuedPublish &oldest = eventQueue[eventHead];
+    if (spoolAppend(oldest.topic, oldest.payload)) {
+      framesSpooled++;
     } else {
-      Serial.print("failed, rc=");
-      Serial.print(client.state());
-      Serial.println(" try again in 5 seconds");
-      delay(5000);
+      eventsDropped++;
+      Serial.printf("Publish queue full; dropped oldest (%lu total)\n",
+                    eventsDropped);
+    }
+    eventHead = (eventHead + 1) % PUBLISH_QUEUE_SIZE;
+    eventCount--;
+  }
+  QueuedPublish &slot =
+      eventQueue[(eventHead + eventCount) % PUBLISH_QUEUE_SIZE];
+  slot.topic = topic;
+  strlcpy(slot.payload, payload, sizeof(slot.payload));
+  eventCount++;
+}
+
+// Latest-wins: an unsent frame is superseded, not queued behind. During
+// a broker outage a sampled subset is also spooled - latest-wins would
+// otherwise leave the whole outage with a single frame of telemetry.
+static void enqueueCoalesced(const char *topic, const char *payload) {
+  if (!client.connected()) {
+    static unsigned long lastSpooledMs = 0;
+    unsigned long now = millis();
+    if (now - lastSpooledMs >= SPOOL_TELEMETRY_INTERVAL_MS) {
+      if (spoolAppend(topic, payload)) {
+        framesSpooled++;
+        lastSpooledMs = now;
+      }
+    }
+  }
+  strlcpy(telemetryFrame, payload, sizeof(telemetryFrame));
+  telemetryTopic = topic;
+}
+
+static void drainPublishQueue() {
+  int sends = 0;
+  // Spooled backlog first: everything on the card predates everything in
+  // the RAM ring, so this order replays the outage chronologically. The
+  // per-drain cap paces the replay so a minute of backlog does not stall
+  // a live link event for more than one pass.
+  while (!spoolEmpty() && sends < PUBLISH_MAX_SENDS_PER_DRAIN) {
+    char topic[SPOOL_TOPIC_MAX];
+    char payload[SPOOL_PAYLOAD_MAX];
+    if (!spoolPeek(topic, sizeof(topic), payload, sizeof(payload))) {
+      break; // Card busy this pass; the record stays spooled
+    }
+    if (!client.publish(ringTopic(topic), payload)) {
+      return; // Socket backpressure - retry the same record next pass
+    }
+    spoolPop();
+    framesReplayed++;
+    sends++;
+  }
+  // Then ordered events; stop at the first failure and retry next pass.
+  while (eventCount > 0 && sends < PUBLISH_MAX_SENDS_PER_DRAIN) {
+    QueuedPublish &slot = eventQueue[eventHead];
+    if (!client.publish(ringTopic(slot.topic), slot.payload)) {
+      return; // Socket backpressure - leave the queue intact
+    }
+#if LATENCY_MARKERS
+    // Scope marker: the contact event is written to the socket on this
+    // edge; the TCP push follows at the flushOutgoing below.
+    if (strcmp(slot.topic, "missing_link/contact") == 0) {
+      latencyMarkPublish();
+    }
+#endif
+    eventHead = (eventHead + 1) % PUBLISH_QUEUE_SIZE;
+    eventCount--;
+    sends++;
+  }
+  if (sends > 0) {
+    // Events are latency-critical (link/unlink drives the lights); push
+    // them onto the wire now rather than letting the stack coalesce.
+    client.flushOutgoing();
+  }
+  // Then the newest telemetry frame, if one is pending.
+  if (telemetryTopic != nullptr && sends < PUBLISH_MAX_SENDS_PER_DRAIN) {
+    if (client.publish(ringTopic(telemetryTopic), telemetryFrame)) {
+      telemetryTopic = nullptr;
     }
   }
 }
@@ -94,23 +1272,66 @@ void reconnect() {
 void mqttLoop() {
   if (!client.connected()) {
     reconnect();
+    if (!client.connected()) {
+      // Still down; skip the publish/config work until the next attempt.
+      return;
+    }
   }
   client.loop();
 
-  // Periodically request configuration
-  unsigned long currentMs = millis();
-  if (currentMs - lastConfigRequestMs > CONFIG_REQUEST_INTERVAL_MS) {
-    requestConfig();
-    lastConfigRequestMs = currentMs;
+  // While riding a backup broker, keep probing the primary (no-op on
+  // the primary).
+  failBackLoop();
+
+  // Send whatever the publishers queued since the last pass.
+  drainPublishQueue();
+
+  // Acknowledge any tuning update the sense tick has finished applying.
+  pollTuneAck();
+
+  // One-shot: trim detector slots for peers that never announced.
+  discoveryTrimLoop();
+
+  // Broker-leg latency probe: ping every second, summarize every minute.
+  unsigned long now = millis();
+  static unsigned long lastPingMs = 0;
+  static unsigned long lastLatencyReportMs = 0;
+  if (now - lastPingMs >= PING_INTERVAL_MS) {
+    sendLatencyPing();
+    lastPingMs = now;
   }
+  if (now - lastLatencyReportMs >= LATENCY_REPORT_INTERVAL_MS) {
+    publishLatencyStats();
+    lastLatencyReportMs = now;
+  }
+
+  // No periodic config re-request: the retained per-statue config topic
+  // replays on subscribe and pushes updates, and deltas cover the rest.
+  // The one-shot request in onMqttConnected() stays for controllers that
+  // predate the retained topic.
 }
 
 void initMqtt() {
   // Load default configuration from program memory first
   loadDefaultConfig();
 
+  // Build the topic dispatch registry (needs the statue identity from the
+  // config load above for the tone topic).
+  registerTopicHandlers();
+
   client.setServer(getServer(), 1883);
-  client.setCallback(mqttSubCallback);
+  client.setSliceCallback(resolveTopicId, dispatchMqttMessage);
+
+  // Short keepalive so the broker notices a dead statue fast; mqttLoop()
+  // runs every pass, so the extra PINGREQs are the only cost. The will
+  // built here is registered on every connect attempt.
+  client.setKeepAlive(MQTT_PRESENCE_KEEPALIVE_S);
+  buildPresenceWill();
+
+  // LAN-sized socket timeout (see MQTT_SOCKET_TIMEOUT_S above); the
+  // compiled-in 15 s default would bound partial-packet reads and async
+  // connect polling at WAN scale.
+  client.setSocketTimeout(MQTT_SOCKET_TIMEOUT_S);
 
   // Increase buffer size to handle config messages (~650 bytes)
   // Default is 256 bytes which is too small
@@ -128,60 +1349,468 @@ void publishState(ContactState state) {
     return;
   }
 
-  // Build JSON message with current detection state
-  char jsonMsg[256];
-  char emittersList[128] = "[";
-  bool first = true;
+  // Build JSON message with current detection state. The writer appends
+  // into the stack buffer and the names are precomputed lowercase, so this
+  // path performs no allocations (see JsonWriter.h).
+  char jsonMsg[384];
+  JsonWriter json(jsonMsg, sizeof(jsonMsg));
+  json.beginObject();
+  json.kv("detector", MY_STATUE_NAME_LC);
+
+  // Shared-clock timestamp (ms since Unix epoch) so the controller can
+  // order and latency-account events across statues; omitted until the
+  // SNTP sync has landed.
+  if (netClockSynced()) {
+    json.kv("ts", sharedClockMs());
+  }
 
-  // Build list of currently detected statues
+  // List of currently detected statues
+  json.key("emitters");
+  json.beginArray();
   for (int statue_idx = 0; statue_idx < NUM_STATUES; statue_idx++) {
     if (statue_idx == MY_STATUE_INDEX)
       continue;
+    if (state.isLinkedTo(statue_idx)) {
+      json.add(STATUE_NAMES_LC[statue_idx]);
+    }
+  }
+  json.endArray();
 
+  // Contact quality (0-100) per linked statue
+  json.key("quality");
+  json.beginObject();
+  for (int statue_idx = 0; statue_idx < NUM_STATUES; statue_idx++) {
+    if (statue_idx == MY_STATUE_INDEX)
+      continue;
     if (state.isLinkedTo(statue_idx)) {
-      if (!first) {
-        strcat(emittersList, ",");
-      }
-      strcat(emittersList, "\"");
+      json.kv(STATUE_NAMES_LC[statue_idx], (uint32_t)state.quality[statue_idx]);
+    }
+  }
+  json.endObject();
+  json.endObject();
 
-      // Convert statue name to lowercase
-      String emitterName = String(STATUE_NAMES[statue_idx]);
-      emitterName.toLowerCase();
-      strcat(emittersList, emitterName.c_str());
+  if (!json.ok()) {
+    LOG_WARN("detection state JSON overflowed; not published");
+    return;
+  }
+
+  // Queue for missing_link/contact; the drain in mqttLoop() retries until
+  // the socket accepts it, so link events survive broker hiccups.
+  enqueueEvent("missing_link/contact", jsonMsg);
+  LOG_DEBUG("queued %s", jsonMsg);
+}
 
-      strcat(emittersList, "\"");
-      first = false;
+void publishSignals() {
+  // Copy one consistent snapshot of the per-detector data rather than
+  // reading the live arrays the sense timer is writing.
+  SignalSnapshot snapshot;
+  readSignalSnapshot(snapshot);
+
+  // Build JSON message with current signal levels for all detectors. This
+  // fires at 10 Hz for week-long events, so it uses the zero-allocation
+  // writer and precomputed lowercase names (see JsonWriter.h); the add()
+  // overload sanitizes any NaN to 0.
+#if QUAD_SENSE_INPUT
+  char jsonMsg[768]; // Headroom for the per-channel section below
+#else
+  char jsonMsg[512];
+#endif
+  JsonWriter json(jsonMsg, sizeof(jsonMsg));
+  json.beginObject();
+  json.kv("detector", MY_STATUE_NAME_LC);
+
+  // Shared-clock timestamp, same as the contact frames: a frame replayed
+  // from the spool after a broker outage still dates itself correctly.
+  if (netClockSynced()) {
+    json.kv("ts", sharedClockMs());
+  }
+
+  // Raw signal magnitudes
+  json.key("signals");
+  json.beginObject();
+  int detectorIndex = 0;
+  for (int statue_idx = 0; statue_idx < NUM_STATUES; statue_idx++) {
+    if (statue_idx == MY_STATUE_INDEX)
+      continue;
+    json.kv(STATUE_NAMES_LC[statue_idx], snapshot.signals[detectorIndex], 3);
+    detectorIndex++;
+  }
+  json.endObject();
+
+  // The adaptive noise floors so convergence can be watched live
+  json.key("floors");
+  json.beginObject();
+  detectorIndex = 0;
+  for (int statue_idx = 0; statue_idx < NUM_STATUES; statue_idx++) {
+    if (statue_idx == MY_STATUE_INDEX)
+      continue;
+    json.kv(STATUE_NAMES_LC[statue_idx], snapshot.floors[detectorIndex], 4);
+    detectorIndex++;
+  }
+  json.endObject();
+
+  // The SNR ratios (cable-length-independent, unlike raw magnitude)
+  json.key("snr");
+  json.beginObject();
+  detectorIndex = 0;
+  for (int statue_idx = 0; statue_idx < NUM_STATUES; statue_idx++) {
+    if (statue_idx == MY_STATUE_INDEX)
+      continue;
+    json.kv(STATUE_NAMES_LC[statue_idx], snapshot.snrs[detectorIndex], 1);
+    detectorIndex++;
+  }
+  json.endObject();
+
+#if QUAD_SENSE_INPUT
+  // Per-channel magnitudes behind each max, so a sagging hand electrode
+  // is visible from the Pi before redundancy quietly masks it.
+  json.key("channels");
+  json.beginObject();
+  detectorIndex = 0;
+  for (int statue_idx = 0; statue_idx < NUM_STATUES; statue_idx++) {
+    if (statue_idx == MY_STATUE_INDEX)
+      continue;
+    json.key(STATUE_NAMES_LC[statue_idx]);
+    json.beginArray();
+    for (int ch = 0; ch < 4; ch++) {
+      json.add(snapshot.channelMags[detectorIndex][ch], 3);
     }
+    json.endArray();
+    detectorIndex++;
   }
-  strcat(emittersList, "]");
+  json.endObject();
+#endif
+
+  // This statue's threshold from the global array
+  json.kv("threshold", STATUE_THRESHOLDS[MY_STATUE_INDEX], 3);
+
+  // The closed-loop TX level, so the optimization is observable.
+  json.kv("tx_amp", txLevelAmplitude(), 2);
+  json.endObject();
+
+  if (!json.ok()) {
+    return;
+  }
+
+  // Queue for missing_link/signals, latest-wins (no debug output - too
+  // verbose at this rate)
+  enqueueCoalesced("missing_link/signals", jsonMsg);
+
+  // Binary twin of the frame above, for the controller's migration off
+  // JSON telemetry.
+  publishTelemetryFrame(snapshot);
+}
+
+/*
+  publishTelemetryFrame() - Sectioned binary superframe on missing_link/telem
+      - v4 of the binary frame: a fixed header plus optional sections,
+        flagged in a section mask and appended in mask-bit order
+      - Signals ride every frame, delta-encoded: a full u16 keyframe every
+        TELEM_KEYFRAME_INTERVAL frames (and forced on reconnect, or when a
+        delta overflows), otherwise packed 4-bit or 8-bit deltas against
+        the last keyframe - between interaction bursts the section is 5
+        bytes instead of 10, and because deltas reference the keyframe
+        rather than the previous frame, a lost delta frame corrupts
+        nothing: the decoder resynchronizes from the section sequence at
+        the next keyframe
+      - State, CPU, memory, and network sections are appended only when
+        their content changed, so one 10 Hz message carries what used to
+        take separate publishes without paying their steady-state bytes
+      - Each section has its own sequence number, bumped only when the
+        section ships, so the controller can detect loss per section
+        instead of per frame
+      - Published alongside the JSON during migration; the JSON frames go
+        away once the controller consumes this one
+*/
+#define TELEM_FRAME_VERSION 4
 
-  // Get detector name (this statue)
-  String detectorName = String(MY_STATUE_NAME);
-  detectorName.toLowerCase();
+// Full-signals keyframe cadence: every 32 frames (~3 s at the 10 Hz
+// ceiling) bounds how long a decoder that lost a keyframe stays blind.
+#define TELEM_KEYFRAME_INTERVAL 32
 
-  // Format complete JSON message
-  snprintf(jsonMsg, sizeof(jsonMsg), "{\"detector\":\"%s\",\"emitters\":%s}",
-           detectorName.c_str(), emittersList);
+// Signals section encodings (the mode byte).
+#define TELEM_SIG_KEYFRAME 0 // Absolute u16 per detector
+#define TELEM_SIG_DELTA8 1   // i8 per detector, vs the last keyframe
+#define TELEM_SIG_DELTA4 2   // Packed i4 per detector, vs the last keyframe
 
-  // Publish to missing_link/contact topic
-  if (client.publish("missing_link/contact", jsonMsg)) {
-    Serial.print("Published: ");
-    Serial.println(jsonMsg);
+// Section mask bits, in the order sections are appended.
+#define TELEM_SEC_SIGNALS 0x01
+#define TELEM_SEC_STATE 0x02
+#define TELEM_SEC_CPU 0x04
+#define TELEM_SEC_MEMORY 0x08
+#define TELEM_SEC_NETWORK 0x10
+#define TELEM_SEC_ENET 0x20
+
+/*
+  Self-describing schema for the binary frame, retained on the broker so
+  the controller decodes v3 without a hardcoded struct mirror. The blob
+  is flash-resident and goes out through publish_P()'s chunked path, so
+  it costs zero RAM no matter how detailed it grows - the pattern to
+  copy for any future canned payload (WLED fallback scenes, self-test
+  fixtures) rather than `const char[]` in RAM plus publish().
+
+  Keep in lockstep with the packed structs in publishTelemetryFrame();
+  array widths track MAX_STATUES. All fields little-endian.
+*/
+static const char TELEM_SCHEMA_JSON[] PROGMEM =
+    "{\"version\":4,\"topic\":\"missing_link/telem\",\"endian\":\"little\","
+    "\"header\":[[\"version\",\"u8\"],[\"statue_id\",\"u8\"],"
+    "[\"frame_seq\",\"u16\"],[\"uptime_sec\",\"u32\"],"
+    "[\"section_mask\",\"u8\"]],"
+    "\"sections\":{"
+    "\"signals\":{\"bit\":1,\"fields\":[[\"seq\",\"u16\"],[\"mode\",\"u8\"]],"
+    "\"modes\":{\"0\":[[\"signals\",\"u16[4]\"]],"
+    "\"1\":[[\"delta\",\"i8[4]\"]],\"2\":[[\"delta\",\"i4[4]\"]]},"
+    "\"delta_base\":\"last mode-0 keyframe\",\"keyframe_interval\":32,"
+    "\"scale\":{\"signals\":65535}},"
+    "\"state\":{\"bit\":2,\"fields\":[[\"seq\",\"u16\"],"
+    "[\"link_mask\",\"u8\"],[\"quality\",\"u8[5]\"]]},"
+    "\"cpu\":{\"bit\":4,\"fields\":[[\"seq\",\"u16\"],"
+    "[\"cpu_percent\",\"u8\"],[\"temp_c\",\"i8\"],[\"clock_mhz\",\"u16\"]]},"
+    "\"memory\":{\"bit\":8,\"fields\":[[\"seq\",\"u16\"],"
+    "[\"free_bytes\",\"u32\"]]},"
+    "\"network\":{\"bit\":16,\"fields\":[[\"seq\",\"u16\"],[\"rx\",\"u32\"],"
+    "[\"tx\",\"u32\"],[\"drop\",\"u32\"],[\"rexmit\",\"u32\"]]},"
+    "\"enet\":{\"bit\":32,\"fields\":[[\"seq\",\"u16\"],[\"irqs\",\"u32\"],"
+    "[\"mac_drop\",\"u32\"],[\"tx_stalls\",\"u32\"],"
+    "[\"ring_high_water\",\"u8\"]]}}}";
+
+// Retained schema publish, straight from flash. Called on every connect:
+// a rebooted broker without persistence would otherwise lose it.
+void publishTelemetrySchema() {
+  client.publish_P(ringTopic("missing_link/telem/schema"), TELEM_SCHEMA_JSON, true);
+}
+
+void publishTelemetryFrame(const SignalSnapshot &snapshot) {
+  extern volatile StatueMask latestLinkedMask; // AudioSense.ino
+  extern volatile uint8_t latestQuality[MAX_STATUES]; // AudioSense.ino
+
+  struct __attribute__((packed)) SuperHeader {
+    uint8_t version;  // TELEM_FRAME_VERSION
+    uint8_t statueId; // MY_STATUE_INDEX
+    uint16_t frameSeq; // Wraps; gaps = lost frames
+    uint32_t uptimeSec;
+    uint8_t sectionMask; // TELEM_SEC_* bits present after the header
+  };
+  struct __attribute__((packed)) SecSignalsHdr {
+    uint16_t seq;
+    uint8_t mode; // TELEM_SIG_*; the payload layout follows from it
+  };
+  struct __attribute__((packed)) SecState {
+    uint16_t seq;
+    uint8_t linkMask; // Current stable link bitmask
+    uint8_t quality[MAX_STATUES];
+  };
+  struct __attribute__((packed)) SecCpu {
+    uint16_t seq;
+    uint8_t cpuPercent; // Audio library processor usage
+    int8_t tempC;       // Die temperature (tempmon), for enclosure trends
+    uint16_t clockMhz;  // Core clock under the power governor
+  };
+  struct __attribute__((packed)) SecMemory {
+    uint16_t seq;
+    uint32_t freeBytes;
+  };
+  struct __attribute__((packed)) SecNetwork {
+    uint16_t seq;
+    uint32_t rx;
+    uint32_t tx;
+    uint32_t drop;
+    uint32_t rexmit;
+  };
+  struct __attribute__((packed)) SecEnet {
+    uint16_t seq;
+    uint32_t irqs;     // Ethernet ISR invocations
+    uint32_t macDrop;  // Frames dropped below lwIP (MAC/DMA level)
+    uint32_t txStalls; // TX attempts that found no free descriptor
+    uint8_t ringHighWater; // Most RX descriptors occupied at once
+  };
+
+  static uint16_t frameSeq = 0;
+  static uint16_t sectionSeq[6] = {0}; // Indexed by mask bit position
+  static SecState lastState;
+  static SecCpu lastCpu;
+  static uint32_t lastFreeKb = 0;
+  static SecNetwork lastNet;
+  static SecEnet lastEnet;
+  // The delta base: signal values as of the last keyframe.
+  static uint16_t sigKey[MAX_STATUES - 1] = {0};
+  static uint8_t framesSinceKey = 0;
+
+  uint8_t frame[sizeof(SuperHeader) + sizeof(SecSignalsHdr) +
+                sizeof(uint16_t) * (MAX_STATUES - 1) + sizeof(SecState) +
+                sizeof(SecCpu) + sizeof(SecMemory) + sizeof(SecNetwork) +
+                sizeof(SecEnet)];
+  size_t used = sizeof(SuperHeader);
+  uint8_t sectionMask = 0;
+
+  // Signals: every frame, delta-coded against the last keyframe.
+  // Keyframes go out on resync, on the TELEM_KEYFRAME_INTERVAL schedule,
+  // and whenever a delta would overflow the 8-bit range - so delta
+  // frames reconstruct the exact u16 values, never an approximation.
+  uint16_t cur[MAX_STATUES - 1];
+  int32_t maxAbsDelta = 0;
+  for (int i = 0; i < MAX_STATUES - 1; i++) {
+    float level = snapshot.signals[i];
+    if (isnan(level) || level < 0.0) {
+      level = 0.0;
+    }
+    if (level > 1.0) {
+      level = 1.0;
+    }
+    cur[i] = (uint16_t)(level * 65535.0);
+    int32_t d = (int32_t)cur[i] - (int32_t)sigKey[i];
+    if (d < 0) {
+      d = -d;
+    }
+    if (d > maxAbsDelta) {
+      maxAbsDelta = d;
+    }
+  }
+
+  SecSignalsHdr sig;
+  sig.seq = ++sectionSeq[0];
+  if (telemResync || framesSinceKey >= TELEM_KEYFRAME_INTERVAL ||
+      maxAbsDelta > 127) {
+    sig.mode = TELEM_SIG_KEYFRAME;
+    memcpy(sigKey, cur, sizeof(sigKey));
+    framesSinceKey = 0;
+    memcpy(frame + used, &sig, sizeof(sig));
+    used += sizeof(sig);
+    memcpy(frame + used, cur, sizeof(cur));
+    used += sizeof(cur);
   } else {
-    Serial.println("Failed to publish detection state");
+    framesSinceKey++;
+    sig.mode = maxAbsDelta <= 7 ? TELEM_SIG_DELTA4 : TELEM_SIG_DELTA8;
+    memcpy(frame + used, &sig, sizeof(sig));
+    used += sizeof(sig);
+    if (sig.mode == TELEM_SIG_DELTA4) {
+      // Two detectors per byte, even index in the low nibble, two's
+      // complement in 4 bits.
+      for (int i = 0; i < MAX_STATUES - 1; i += 2) {
+        uint8_t lo = (uint8_t)((cur[i] - sigKey[i]) & 0x0F);
+        uint8_t hi = i + 1 < MAX_STATUES - 1
+                         ? (uint8_t)((cur[i + 1] - sigKey[i + 1]) & 0x0F)
+                         : 0;
+        frame[used++] = (uint8_t)(lo | (hi << 4));
+      }
+    } else {
+      for (int i = 0; i < MAX_STATUES - 1; i++) {
+        frame[used++] = (uint8_t)((cur[i] - sigKey[i]) & 0xFF);
+      }
+    }
   }
+  sectionMask |= TELEM_SEC_SIGNALS;
+
+  // State: link mask and contact quality, on change.
+  SecState st;
+  st.linkMask = latestLinkedMask;
+  for (int i = 0; i < MAX_STATUES; i++) {
+    st.quality[i] = latestQuality[i];
+  }
+  if (telemResync || st.linkMask != lastState.linkMask ||
+      memcmp(st.quality, lastState.quality, sizeof(st.quality)) != 0) {
+    st.seq = ++sectionSeq[1];
+    lastState = st;
+    memcpy(frame + used, &st, sizeof(st));
+    used += sizeof(st);
+    sectionMask |= TELEM_SEC_STATE;
+  }
+
+  // CPU: processor usage, die temperature, governed clock, on change.
+  SecCpu cpu;
+  float usage = AudioProcessorUsage();
+  cpu.cpuPercent =
+      (uint8_t)(usage > 100.0 ? 100 : (usage < 0.0 ? 0 : usage));
+  float temp = tempmonGetTemp();
+  cpu.tempC = (int8_t)(temp > 127.0f ? 127 : (temp < -128.0f ? -128 : temp));
+  cpu.clockMhz = powerCurrentMhz();
+  if (telemResync || cpu.cpuPercent != lastCpu.cpuPercent ||
+      cpu.tempC != lastCpu.tempC || cpu.clockMhz != lastCpu.clockMhz) {
+    cpu.seq = ++sectionSeq[2];
+    lastCpu = cpu;
+    memcpy(frame + used, &cpu, sizeof(cpu));
+    used += sizeof(cpu);
+    sectionMask |= TELEM_SEC_CPU;
+  }
+
+  // Memory: free heap, on change at 1 KB granularity so allocator
+  // jitter does not ship the section every frame.
+  SecMemory mem;
+  mem.freeBytes = memFreeBytes();
+  if (telemResync || mem.freeBytes / 1024 != lastFreeKb) {
+    mem.seq = ++sectionSeq[3];
+    lastFreeKb = mem.freeBytes / 1024;
+    memcpy(frame + used, &mem, sizeof(mem));
+    used += sizeof(mem);
+    sectionMask |= TELEM_SEC_MEMORY;
+  }
+
+  // Network: lwIP counters, on change (lifetime totals, so any traffic
+  // since the last frame ships it; an idle network costs nothing).
+  SecNetwork net;
+  if (networkCountersSample(&net.rx, &net.tx, &net.drop, &net.rexmit)) {
+    if (telemResync || net.rx != lastNet.rx || net.tx != lastNet.tx ||
+        net.drop != lastNet.drop || net.rexmit != lastNet.rexmit) {
+      net.seq = ++sectionSeq[4];
+      lastNet = net;
+      memcpy(frame + used, &net, sizeof(net));
+      used += sizeof(net);
+      sectionMask |= TELEM_SEC_NETWORK;
+    }
+  }
+
+  // Ethernet driver: MAC/DMA-level counters, on change. Separates DMA
+  // pressure (ring high-water, overruns, TX stalls) from stack-level
+  // drops so audio dropouts can be pinned to - or cleared of - Ethernet.
+  {
+    SecEnet enet;
+    uint32_t ringHw;
+    enetDriverStatsSample(&enet.irqs, &enet.macDrop, &enet.txStalls, &ringHw);
+    enet.ringHighWater = (uint8_t)min(ringHw, (uint32_t)255);
+    if (telemResync || enet.irqs != lastEnet.irqs ||
+        enet.macDrop != lastEnet.macDrop ||
+        enet.txStalls != lastEnet.txStalls ||
+        enet.ringHighWater != lastEnet.ringHighWater) {
+      enet.seq = ++sectionSeq[5];
+      lastEnet = enet;
+      memcpy(frame + used, &enet, sizeof(enet));
+      used += sizeof(enet);
+      sectionMask |= TELEM_SEC_ENET;
+    }
+  }
+
+  SuperHeader header;
+  header.version = TELEM_FRAME_VERSION;
+  header.statueId = (uint8_t)MY_STATUE_INDEX;
+  header.frameSeq = frameSeq++;
+  header.uptimeSec = millis() / 1000;
+  header.sectionMask = sectionMask;
+  memcpy(frame, &header, sizeof(header));
+  telemResync = false;
+
+  // ~14 bytes steady state (header + 4-bit signal deltas), 73 worst
+  // case (keyframe + every section); sent directly rather than through
+  // the text queue (binary payload, and at this size coalescing buys
+  // nothing).
+  client.publish(ringTopic("missing_link/telem"), frame, used);
 }
 
-void publishSignals() {
-  // External reference to signal levels from AudioSense.ino
-  extern float detectorSignals[MAX_STATUES - 1];
+/*
+  publishDiagnostics() - On-demand I/Q diagnostics dump
+      - Triggered by missing_link/diag/request
+      - Reports per-detector magnitude and phase (radians) so cable/hand
+        degradation shows up as phase wander before magnitude drops
+*/
+void publishDiagnostics() {
+  extern float detectorPhases[MAX_STATUES - 1];
 
-  // Build JSON message with current signal levels for all detectors
-  char jsonMsg[256];
-  char signalsJson[128];
+  SignalSnapshot snapshot;
+  readSignalSnapshot(snapshot);
 
-  // Start building the signals object
-  strcpy(signalsJson, "{");
+  char jsonMsg[384];
+  char detectorsJson[256];
+  strcpy(detectorsJson, "{");
   bool first = true;
 
   int detectorIndex = 0;
@@ -190,45 +1819,310 @@ void publishSignals() {
       continue;
 
     if (!first) {
-      strcat(signalsJson, ",");
+      strcat(detectorsJson, ",");
     }
 
-    // Convert statue name to lowercase
-    String statueName = String(STATUE_NAMES[statue_idx]);
-    statueName.toLowerCase();
-
-    // Get signal level and sanitize NaN values
-    float signalLevel = detectorSignals[detectorIndex];
-    if (isnan(signalLevel)) {
-      signalLevel = 0.0;
-    }
-
-    // Add "statuename": level entry
-    char entry[32];
-    snprintf(entry, sizeof(entry), "\"%s\":%.3f", statueName.c_str(),
-             signalLevel);
-    strcat(signalsJson, entry);
+    char entry[64];
+    snprintf(entry, sizeof(entry), "\"%s\":{\"mag\":%.4f,\"phase\":%.3f}",
+             STATUE_NAMES_LC[statue_idx], snapshot.signals[detectorIndex],
+             detectorPhases[detectorIndex]);
+    strcat(detectorsJson, entry);
 
     first = false;
     detectorIndex++;
   }
-  strcat(signalsJson, "}");
+  strcat(detectorsJson, "}");
+
+  snprintf(jsonMsg, sizeof(jsonMsg),
+           "{\"detector\":\"%s\",\"detectors\":%s}", MY_STATUE_NAME_LC,
+           detectorsJson);
+  client.publish(ringTopic("missing_link/diag/response"), jsonMsg);
+}
 
-  // Get detector name (this statue)
-  String detectorName = String(MY_STATUE_NAME);
-  detectorName.toLowerCase();
+/*
+  publishStorageStats() - SD health telemetry (StorageStats.h)
+      - Called once a minute from loop()
+      - Skips the publish when the window saw no SD activity
+*/
+void publishStorageStats() {
+  char statsJson[256];
+  if (!storageStatsCollect(statsJson, sizeof(statsJson))) {
+    return;
+  }
 
-  // Get this statue's threshold from the global array
-  float myThreshold = STATUE_THRESHOLDS[MY_STATUE_INDEX];
+  // Arbitration counters (SdArbiter.h) ride in the same frame; "{}"
+  // when the window saw no contention worth reporting.
+  char ioJson[256];
+  if (!sdIoStatsCollect(ioJson, sizeof(ioJson))) {
+    strcpy(ioJson, "{}");
+  }
 
-  // Format complete JSON message with threshold
+  // Store-and-forward counters (TelemetrySpool.h): frames spilled to
+  // the card, replayed after reconnect, and lost despite the spool.
+  char spoolJson[96];
+  snprintf(spoolJson, sizeof(spoolJson),
+           "{\"spooled\":%lu,\"replayed\":%lu,\"dropped\":%lu}",
+           (unsigned long)framesSpooled, (unsigned long)framesReplayed,
+           (unsigned long)spoolDropped());
+
+  char jsonMsg[640];
   snprintf(jsonMsg, sizeof(jsonMsg),
-           "{\"detector\":\"%s\",\"signals\":%s,\"threshold\":%.3f}",
-           detectorName.c_str(), signalsJson, myThreshold);
+           "{\"statue\":\"%s\",\"sd\":%s,\"io\":%s,\"spool\":%s}",
+           MY_STATUE_NAME_LC, statsJson, ioJson, spoolJson);
+  client.publish(ringTopic("missing_link/storage"), jsonMsg);
+}
+
+// One-shot SD benchmark verdict (SdBench.h): publishes whenever a boot
+// check or a sweep has finished since the last call.
+void publishSdBenchReport() {
+  if (!client.connected()) {
+    return; // Keep the report pending until the broker is reachable
+  }
+  char benchJson[320];
+  if (!sdBenchCollect(benchJson, sizeof(benchJson))) {
+    return;
+  }
+  char jsonMsg[400];
+  snprintf(jsonMsg, sizeof(jsonMsg), "{\"statue\":\"%s\",\"bench\":%s}",
+           MY_STATUE_NAME_LC, benchJson);
+  client.publish(ringTopic("missing_link/bench"), jsonMsg);
+}
+
+// Wrap the lwIP/link counters from Networking.ino with the statue name,
+// same shape as the storage frame above.
+void publishNetworkStats() {
+  char statsJson[256];
+  if (!networkStatsCollect(statsJson, sizeof(statsJson))) {
+    return;
+  }
+
+  // Peer-channel loss/NACK counters (PeerLink.h) ride along when the
+  // channel has seen loss; a clean channel stays out of the frame.
+  char peerJson[128];
+  bool havePeer = peerLinkStatsCollect(peerJson, sizeof(peerJson));
+
+  char jsonMsg[448];
+  if (havePeer) {
+    snprintf(jsonMsg, sizeof(jsonMsg),
+             "{\"statue\":\"%s\",\"net\":%s,\"peer\":%s}", MY_STATUE_NAME_LC,
+             statsJson, peerJson);
+  } else {
+    snprintf(jsonMsg, sizeof(jsonMsg), "{\"statue\":\"%s\",\"net\":%s}",
+             MY_STATUE_NAME_LC, statsJson);
+  }
+  client.publish(ringTopic("missing_link/network"), jsonMsg);
+}
+
+/*
+  publishTaskStats() - scheduler health telemetry (TaskScheduler.h)
+      - Called once a minute from the telemetry task
+      - Skips the publish when no task ran in the window
+*/
+void publishTaskStats() {
+  char statsJson[512];
+  if (!schedulerStatsCollect(statsJson, sizeof(statsJson))) {
+    return;
+  }
 
-  // Publish to missing_link/signals topic (no debug output - too verbose at
-  // 2Hz)
-  client.publish("missing_link/signals", jsonMsg);
+  char jsonMsg[576];
+  snprintf(jsonMsg, sizeof(jsonMsg), "{\"statue\":\"%s\",\"tasks\":%s}",
+           MY_STATUE_NAME_LC, statsJson);
+  client.publish(ringTopic("missing_link/tasks"), jsonMsg);
+}
+
+/*
+  publishIsrStats() - per-ISR occupancy and preemption counts (IsrTrace.h)
+      - Called once a minute from the telemetry task
+      - Counters reset each window; skipped when nothing fired
+*/
+void publishIsrStats() {
+  char statsJson[256];
+  if (!isrTraceStatsCollect(statsJson, sizeof(statsJson))) {
+    return;
+  }
+
+  char jsonMsg[320];
+  snprintf(jsonMsg, sizeof(jsonMsg), "{\"statue\":\"%s\",\"isr\":%s}",
+           MY_STATUE_NAME_LC, statsJson);
+  client.publish(ringTopic("missing_link/isr"), jsonMsg);
+}
+
+/*
+  publishBootReport() - per-stage boot timing (BootProfile.h)
+      - Published once per boot from onMqttConnected()
+      - Budget overruns were already flagged via LOG_WARN at the end of
+        setup(); this is the raw breakdown for trend tracking
+*/
+void publishBootReport() {
+  static bool reported = false;
+  if (reported) {
+    return;
+  }
+
+  char bootJson[256];
+  if (!bootProfileCollect(bootJson, sizeof(bootJson))) {
+    return;
+  }
+  reported = true;
+
+  // The hardware self-test result rides along (SelfTest.h); a statue
+  // that booted with a dead codec announces it here, not as a mystery.
+  char selfTestJson[128];
+  if (!selfTestCollect(selfTestJson, sizeof(selfTestJson))) {
+    strlcpy(selfTestJson, "null", sizeof(selfTestJson));
+  }
+
+  char jsonMsg[448];
+  snprintf(jsonMsg, sizeof(jsonMsg),
+           "{\"statue\":\"%s\",\"boot\":%s,\"selftest\":%s}",
+           MY_STATUE_NAME_LC, bootJson, selfTestJson);
+  client.publish(ringTopic("missing_link/boot"), jsonMsg);
+}
+
+/*
+  publishMemMapReport() - link-map region audit (MemMonitor.h)
+      - Published once per boot from onMqttConnected(); the numbers are
+        fixed at link time, so this is one frame per firmware image
+      - The per-region budgets (ITCM banks, DTCM statics, DMAMEM) are
+        checked from the broker log instead of a .map file
+*/
+void publishMemMapReport() {
+  static bool reported = false;
+  if (reported) {
+    return;
+  }
+  char mapJson[256];
+  if (!memMapCollect(mapJson, sizeof(mapJson))) {
+    return;
+  }
+  reported = true;
+  char jsonMsg[320];
+  snprintf(jsonMsg, sizeof(jsonMsg), "{\"statue\":\"%s\",\"map\":%s}",
+           MY_STATUE_NAME_LC, mapJson);
+  client.publish(ringTopic("missing_link/memmap"), jsonMsg);
+}
+
+/*
+  publishAudioNodeStats() - per-node audio graph CPU (AudioNodeStats.h)
+      - Called once a minute from the telemetry task
+      - Per-node maxima reset each window, so a spike dates itself
+*/
+void publishAudioNodeStats() {
+  char statsJson[448];
+  if (!audioNodeStatsCollect(statsJson, sizeof(statsJson))) {
+    return;
+  }
+
+  char jsonMsg[512];
+  snprintf(jsonMsg, sizeof(jsonMsg), "{\"statue\":\"%s\",\"nodes\":%s}",
+           MY_STATUE_NAME_LC, statsJson);
+  client.publish(ringTopic("missing_link/audio_cpu"), jsonMsg);
+}
+
+/*
+  publishMemoryStats() - heap/stack health telemetry (MemMonitor.h)
+      - Called once a minute from the telemetry task
+      - The churn field resets each window; everything else is a sample
+*/
+void publishMemoryStats() {
+  char statsJson[192];
+  if (!memMonitorCollect(statsJson, sizeof(statsJson))) {
+    return;
+  }
+
+  char jsonMsg[256];
+  snprintf(jsonMsg, sizeof(jsonMsg), "{\"statue\":\"%s\",\"mem\":%s}",
+           MY_STATUE_NAME_LC, statsJson);
+  client.publish(ringTopic("missing_link/memory"), jsonMsg);
+}
+
+// Shadow divergence counters, published (and reset) once a minute while
+// a candidate configuration is burning in.
+void publishShadowStats() {
+  uint32_t samples, wouldLink, wouldMiss;
+  if (!audioSenseShadowReport(&samples, &wouldLink, &wouldMiss)) {
+    return;
+  }
+  char statsJson[128];
+  JsonWriter json(statsJson, sizeof(statsJson));
+  json.beginObject();
+  json.kv("statue", MY_STATUE_NAME_LC);
+  json.kv("samples", samples);
+  json.kv("would_link", wouldLink);
+  json.kv("would_miss", wouldMiss);
+  json.endObject();
+  client.publish(ringTopic("missing_link/shadow/stats"), statsJson);
+}
+
+/*
+  publishWatchdogReport() - post-reset hang attribution (Watchdog.h)
+      - Published once per boot from onMqttConnected(), and only when the
+        previous boot ended in a watchdog reset
+      - The stage id maps back to a scheduler task name; "setup" and
+        "idle" cover hangs outside a task run
+*/
+void publishWatchdogReport() {
+  static bool reported = false;
+  int stage = watchdogResetStage();
+  if (reported || stage < 0) {
+    return;
+  }
+  reported = true;
+
+  const char *name;
+  if (stage == WATCHDOG_STAGE_SETUP) {
+    name = "setup";
+  } else if (stage == WATCHDOG_STAGE_IDLE) {
+    name = "idle";
+  } else {
+    name = schedulerTaskName(stage);
+    if (name == NULL) {
+      name = "unknown";
+    }
+  }
+
+  char jsonMsg[128];
+  snprintf(jsonMsg, sizeof(jsonMsg),
+           "{\"statue\":\"%s\",\"stage\":\"%s\",\"stage_id\":%d}",
+           MY_STATUE_NAME_LC, name, stage);
+  client.publish(ringTopic("missing_link/watchdog"), jsonMsg);
+  Serial.printf("Watchdog report published: hung in %s\n", name);
+}
+
+/*
+  publishFaultReport() - persisted crash record delivery (FaultDump.h)
+      - Published from onMqttConnected() when a previous boot's fault
+        handler left a record in EEPROM
+      - faultDumpCollect() clears the record once it is formatted, so a
+        report is delivered exactly once
+*/
+void publishFaultReport() {
+  if (!faultDumpPending()) {
+    return;
+  }
+
+  char dumpJson[384];
+  if (!faultDumpCollect(dumpJson, sizeof(dumpJson))) {
+    return;
+  }
+
+  char jsonMsg[448];
+  snprintf(jsonMsg, sizeof(jsonMsg), "{\"statue\":\"%s\",\"fault\":%s}",
+           MY_STATUE_NAME_LC, dumpJson);
+  client.publish(ringTopic("missing_link/fault"), jsonMsg);
+  Serial.println("Fault report published");
+}
+
+// SD mount failure announcement (MusicPlayer.ino's mount supervisor).
+// Rides the event queue so a failure during boot, before MQTT is up,
+// still gets delivered on the first connect.
+void publishSdMountFault(int attempts) {
+  char jsonMsg[128];
+  snprintf(jsonMsg, sizeof(jsonMsg),
+           "{\"statue\":\"%s\",\"fault\":{\"type\":\"sd_mount\","
+           "\"attempts\":%d}}",
+           MY_STATUE_NAME_LC, attempts);
+  enqueueEvent("missing_link/fault", jsonMsg);
 }
 
 // Load default configuration from program memory
@@ -242,82 +2136,155 @@ void loadDefaultConfig() {
         "WARNING: Failed to identify statue by hostname, using defaults");
   }
 
-  // Now load the threshold configuration using the same JSON
-  // Get the length of the PROGMEM string
-  size_t len = strlen_P(DEFAULT_CONFIG_JSON);
-
-  // Allocate buffer in RAM and copy from PROGMEM
-  char *jsonBuffer = new char[len + 1];
-  strcpy_P(jsonBuffer, DEFAULT_CONFIG_JSON);
+  // When the config came from the EEPROM cache, the arrays are already
+  // populated and the detector thresholds applied - skip the second parse
+  // of the same document entirely.
+  if (configLoadedFromStore()) {
+    Serial.println("Config loaded from EEPROM cache; skipping JSON parse");
+    return;
+  }
 
+  // Now load the threshold configuration using the same JSON. Flash is
+  // memory-mapped on the Teensy 4, so the parser reads the PROGMEM
+  // string in place - no heap copy.
   Serial.println("Loading threshold configuration from program memory...");
-  parseConfig(jsonBuffer, len);
-
-  // Clean up allocated memory
-  delete[] jsonBuffer;
+  parseConfig(DEFAULT_CONFIG_JSON, strlen_P(DEFAULT_CONFIG_JSON));
 }
 
 // Request configuration from controller
 void requestConfig() {
   if (client.connected()) {
     Serial.println("Requesting configuration from controller...");
-    client.publish("missing_link/config/request", "true");
+    client.publish(ringTopic("missing_link/config/request"), "true");
   }
 }
 
 // Parse configuration JSON and update TeensyConfig
 void parseConfig(const char *json, unsigned int length) {
-  // Use static allocation for better memory management
-  StaticJsonDocument<2048> doc;
-
-  DeserializationError error = deserializeJson(doc, json, length);
+  // Filtered parse: only the schema keys below survive into the
+  // document, so unknown or future fields cost nothing and the pool
+  // holds the per-statue scalars instead of the whole payload. That
+  // halves the former 2 KB document and keeps the transient bounded as
+  // the statue count grows.
+  StaticJsonDocument<192> filter;
+  filter["tdm"] = true;
+  filter["duty"] = true;
+  JsonObject perStatue = filter.createNestedObject("*");
+  perStatue["emit"] = true;
+  perStatue["threshold"] = true;
+  perStatue["unlink_ratio"] = true;
+  perStatue["detect"] = true;
+  perStatue["thresholds"] = true;
+
+  StaticJsonDocument<1024> doc;
+  DeserializationError error =
+      deserializeJson(doc, json, length, DeserializationOption::Filter(filter));
   if (error) {
-    Serial.print("Failed to parse config JSON: ");
-    Serial.println(error.c_str());
+    LOG_WARN("failed to parse config JSON: %s", error.c_str());
     return;
   }
 
   // Get this Teensy's hostname from reverse DNS
-  String myHostname = String(getHostname());
-  Serial.print("My hostname: ");
-  Serial.println(myHostname);
+  const char *myHostname = getHostname();
+  LOG_INFO("config parse for hostname %s", myHostname);
+
+  // Optional TDM scheduling block (absent means TDM stays off)
+  if (doc.containsKey("tdm")) {
+    JsonObject tdmConfig = doc["tdm"];
+    int slotOfStatue[MAX_STATUES] = {0, 1, 2, 3, 4};
+    int numSlots = NUM_STATUES;
+    if (tdmConfig.containsKey("slots")) {
+      int maxSlot = 0;
+      for (JsonPair slotKv : tdmConfig["slots"].as<JsonObject>()) {
+        int idx = getStatueIndex(slotKv.key().c_str());
+        if (idx >= 0 && idx < MAX_STATUES) {
+          slotOfStatue[idx] = slotKv.value().as<int>();
+          if (slotOfStatue[idx] > maxSlot) {
+            maxSlot = slotOfStatue[idx];
+          }
+        }
+      }
+      numSlots = maxSlot + 1;
+    }
+    tdmConfigure(tdmConfig["enabled"] | false, tdmConfig["slot_ms"] | 50,
+                 slotOfStatue, numSlots);
+  }
+
+  // Optional duty-cycle block (absent means continuous transmission)
+  if (doc.containsKey("duty")) {
+    JsonObject dutyConfig = doc["duty"];
+    dutyCycleConfigure(dutyConfig["enabled"] | false,
+                       dutyConfig["period_ms"] | 100,
+                       dutyConfig["on_ms"] | 30);
+  }
 
   // First, update all statue thresholds from the full configuration
   // This allows each detector to use the appropriate target statue's threshold
   bool thresholdsChanged = false;
   for (JsonPair kv : doc.as<JsonObject>()) {
-    String statueName = kv.key().c_str();
+    const char *statueName = kv.key().c_str();
     JsonObject statueConfig = kv.value();
 
-    int idx = getStatueIndex(statueName.c_str());
+    int idx = getStatueIndex(statueName);
     if (idx >= 0 && idx < MAX_STATUES &&
         statueConfig.containsKey("threshold")) {
       float newThreshold =
           constrain(statueConfig["threshold"].as<float>(), 0.001, 1.0);
       if (STATUE_THRESHOLDS[idx] != newThreshold) {
-        Serial.print("  ");
-        Serial.print(STATUE_NAMES[idx]);
-        Serial.print(" threshold: ");
-        Serial.print(STATUE_THRESHOLDS[idx], 4);
-        Serial.print(" -> ");
-        Serial.println(newThreshold, 4);
+        LOG_INFO("%s threshold: %.4f -> %.4f", STATUE_NAMES[idx],
+                 (double)STATUE_THRESHOLDS[idx], (double)newThreshold);
         STATUE_THRESHOLDS[idx] = newThreshold;
         thresholdsChanged = true;
       }
     }
+
+    // Optional hysteresis release ratio: once linked, the detector
+    // releases at threshold * ratio (see STATUE_UNLINK_RATIOS).
+    if (idx >= 0 && idx < MAX_STATUES &&
+        statueConfig.containsKey("unlink_ratio")) {
+      float newRatio =
+          constrain(statueConfig["unlink_ratio"].as<float>(), 0.3, 1.0);
+      if (STATUE_UNLINK_RATIOS[idx] != newRatio) {
+        LOG_INFO("%s unlink_ratio: %.2f -> %.2f", STATUE_NAMES[idx],
+                 (double)STATUE_UNLINK_RATIOS[idx], (double)newRatio);
+        STATUE_UNLINK_RATIOS[idx] = newRatio;
+        thresholdsChanged = true;
+      }
+    }
+
+    // Optional per-pair overrides: "thresholds": {"elektra": 0.02, ...}
+    // gives the threshold THIS statue (the outer key) uses when
+    // detecting each named peer, so short cables can run tighter than
+    // the peer's scalar tuned for its longest run.
+    if (idx >= 0 && idx < MAX_STATUES &&
+        statueConfig.containsKey("thresholds")) {
+      for (JsonPair pairKv : statueConfig["thresholds"].as<JsonObject>()) {
+        int target = getStatueIndex(pairKv.key().c_str());
+        if (target < 0 || target >= MAX_STATUES || target == idx) {
+          continue;
+        }
+        float pairValue =
+            constrain(pairKv.value().as<float>(), 0.001, 1.0);
+        if (STATUE_PAIR_THRESHOLDS[idx][target] != pairValue) {
+          LOG_INFO("%s->%s threshold: %.4f", STATUE_NAMES[idx],
+                   STATUE_NAMES[target], (double)pairValue);
+          STATUE_PAIR_THRESHOLDS[idx][target] = pairValue;
+          thresholdsChanged = true;
+        }
+      }
+    }
   }
 
   // Now find our specific configuration by hostname
   bool configFound = false;
   for (JsonPair kv : doc.as<JsonObject>()) {
-    String statueName = kv.key().c_str();
+    const char *statueName = kv.key().c_str();
     JsonObject statueConfig = kv.value();
 
     // Match statue name (JSON key) against hostname (case-insensitive)
-    if (statueName.equalsIgnoreCase(myHostname)) {
-      Serial.print("Found configuration for ");
-      Serial.print(statueName);
-      Serial.println(" (matched by hostname)");
+    if (strEqualsIgnoreCase(statueName, myHostname)) {
+      LOG_INFO("found configuration for %s (matched by hostname)",
+               statueName);
 
       configFound = true;
 
@@ -325,33 +2292,27 @@ void parseConfig(const char *json, unsigned int length) {
       if (statueConfig.containsKey("threshold")) {
         float newThreshold = statueConfig["threshold"];
         teensyConfig.threshold = constrain(newThreshold, 0.001, 1.0);
-        Serial.print("  My threshold: ");
-        Serial.println(teensyConfig.threshold, 4);
+        LOG_INFO("my threshold: %.4f", (double)teensyConfig.threshold);
       }
 
       // Store informational fields
       if (statueConfig.containsKey("emit")) {
         teensyConfig.emitFreq = statueConfig["emit"];
-        Serial.print("  Emit frequency: ");
-        Serial.print(teensyConfig.emitFreq);
-        Serial.println(" Hz");
+        LOG_INFO("emit frequency: %d Hz", teensyConfig.emitFreq);
       }
 
       // Store detect array (informational)
       if (statueConfig.containsKey("detect")) {
         JsonArray detectArray = statueConfig["detect"];
         int idx = 0;
-        Serial.print("  Detects: ");
         for (JsonVariant v : detectArray) {
           if (idx < 4) {
-            teensyConfig.detectStatues[idx] = v.as<String>();
-            if (idx > 0)
-              Serial.print(", ");
-            Serial.print(teensyConfig.detectStatues[idx]);
+            strlcpy(teensyConfig.detectStatues[idx], v.as<const char *>(),
+                    sizeof(teensyConfig.detectStatues[idx]));
             idx++;
           }
         }
-        Serial.println();
+        LOG_INFO("detect list: %d statues", idx);
       }
 
       // Apply the configuration
@@ -361,13 +2322,15 @@ void parseConfig(const char *json, unsigned int length) {
   }
 
   if (!configFound) {
-    Serial.println("No configuration found matching this Teensy's hostname");
-    Serial.println("Using default threshold values");
+    LOG_WARN("no configuration matched this hostname; using defaults");
   }
 
   // Update detector thresholds based on all parsed statue thresholds
   // Each detector will use the threshold of its target statue
   updateDetectorThresholds();
+
+  // Re-cache the applied config so the next boot skips the JSON parse.
+  configStoreSave();
 }
 
 // Apply configuration changes to the system
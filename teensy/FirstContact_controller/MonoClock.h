@@ -0,0 +1,59 @@
+/*
+MonoClock: monotonic 64-bit microsecond clock.
+
+Timing state was tracked ad hoc with 32-bit millis() values - fade and
+idle-out timers in MusicPlayer.ino, the debounce buffer clocks, and an
+explicit wrap-around hack in displayActivityStatus() - and the 49.7-day
+millis() wrap lands exactly inside a long burn. This module extends the
+cycle-counter-backed micros() (ARM_DWT_CYCCNT on the Teensy 4) to 64
+bits, so subtraction is always safe and every subsystem gets microsecond
+resolution for free. The extension core is pure and host-tested
+(tests/monoclock_spec.cpp); the firmware side lives in MonoClock.ino.
+*/
+
+#ifndef MONO_CLOCK_H
+#define MONO_CLOCK_H
+
+#include <stdint.h>
+
+// Pure 32-to-64-bit extension core. extend() must run at least once per
+// wrap period of the source counter (micros(): ~71 minutes) to catch
+// every rollover; the 5 ms sense tick clears that by four orders of
+// magnitude.
+struct MonoClock64 {
+  uint32_t lastLow = 0;
+  uint64_t high = 0;
+
+  uint64_t extend(uint32_t low) {
+    if (low < lastLow) {
+      high += (1ull << 32);
+    }
+    lastLow = low;
+    return high | low;
+  }
+};
+
+// Stopwatch: elapsed time since start(). Wrap-free because the 64-bit
+// clock never wraps within hardware lifetime (~584,000 years).
+struct MonoStopwatch {
+  uint64_t startUs = 0;
+
+  void start(uint64_t nowUs) { startUs = nowUs; }
+  uint64_t elapsedUs(uint64_t nowUs) const { return nowUs - startUs; }
+  uint64_t elapsedMs(uint64_t nowUs) const { return (nowUs - startUs) / 1000; }
+};
+
+// Deadline: a fixed point in the future, set once and polled.
+struct MonoDeadline {
+  uint64_t dueUs = 0;
+
+  void set(uint64_t nowUs, uint64_t delayUs) { dueUs = nowUs + delayUs; }
+  bool expired(uint64_t nowUs) const { return nowUs >= dueUs; }
+};
+
+// Firmware-side clock reads (MonoClock.ino). Safe from both loop and
+// the sense timer context.
+uint64_t monoNowUs();
+uint64_t monoNowMs();
+
+#endif // MONO_CLOCK_H
@@ -0,0 +1,25 @@
+/*
+MonoClock firmware side (see MonoClock.h).
+
+micros() on the Teensy 4 reads the DWT cycle counter scaled by F_CPU, so
+it is already monotonic and jitter-free; all this adds is the 64-bit
+extension. The extension core mutates shared state, and callers span the
+loop and the sense timer ISR, so the read runs inside a short
+interrupt-disable window - two loads and a compare, well under a
+microsecond.
+*/
+
+#include <Arduino.h>
+
+#include "MonoClock.h"
+
+static MonoClock64 monoCore;
+
+uint64_t monoNowUs() {
+  noInterrupts();
+  uint64_t now = monoCore.extend(micros());
+  interrupts();
+  return now;
+}
+
+uint64_t monoNowMs() { return monoNowUs() / 1000; }
@@ -0,0 +1,31 @@
+/*
+MusicEnvelope.cpp - per-block envelope follower implementation.
+*/
+
+#include "MusicEnvelope.h"
+
+// One-pole smoothing factors per audio block (~2.9 ms). Attack tracks a
+// beat onset within a couple of blocks; release rides out the decay so
+// the pulse breathes instead of flickering (~100 ms fall).
+#define ENV_ATTACK_ALPHA 0.5f
+#define ENV_RELEASE_ALPHA 0.03f
+
+void AudioAnalyzeEnvelope::update(void) {
+  audio_block_t *block = receiveReadOnly();
+  if (block == NULL) {
+    // Upstream idle: decay toward silence at the release rate.
+    env = env * (1.0f - ENV_RELEASE_ALPHA);
+    return;
+  }
+
+  uint32_t sum = 0;
+  for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+    int32_t s = block->data[i];
+    sum += (uint32_t)(s < 0 ? -s : s);
+  }
+  release(block);
+
+  float levelNow = (float)sum / (AUDIO_BLOCK_SAMPLES * 32768.0f);
+  float alpha = (levelNow > env) ? ENV_ATTACK_ALPHA : ENV_RELEASE_ALPHA;
+  env = env + alpha * (levelNow - env);
+}
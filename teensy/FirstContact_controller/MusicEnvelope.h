@@ -0,0 +1,37 @@
+/*
+MusicEnvelope: Envelope-follower tap on the music output.
+
+The haptic motor and the spare LED pins were static while music played;
+anything music-reactive would have needed loop-path buffer reads. This
+analyze node hangs off mixerMusicOutput in the audio graph and computes
+a smoothed amplitude per block inside the audio update: one mean-|x|
+pass over the read-only input block and a one-pole attack/release
+smoother - no extra buffer copies, no FFT, no loop-path cost. level()
+is a single volatile float the haptic tick ISR and the LED drive sample
+at will, with latency bounded by one audio block (~2.9 ms).
+*/
+
+#ifndef MUSIC_ENVELOPE_H
+#define MUSIC_ENVELOPE_H
+
+#include <Audio.h>
+
+class AudioAnalyzeEnvelope : public AudioStream {
+public:
+  AudioAnalyzeEnvelope() : AudioStream(1, inputQueueArray) { env = 0.0f; }
+
+  // Smoothed amplitude, 0.0-1.0, as of the last audio block.
+  float level() { return env; }
+
+  virtual void update(void);
+
+private:
+  audio_block_t *inputQueueArray[1];
+  volatile float env;
+};
+
+// The music-output follower's current level (MusicPlayer.ino owns the
+// node). Safe to call from ISRs; reads one volatile float.
+float musicEnvelopeLevel();
+
+#endif // MUSIC_ENVELOPE_H
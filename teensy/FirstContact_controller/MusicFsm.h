@@ -0,0 +1,129 @@
+/*
+MusicFsm: table-driven music lifecycle transitions.
+
+The transition handling in playMusic() grew into a thicket: link and
+unlink edges, the momentary-unlink grace window, fade-out/resume, and
+the fade/idle-out outcomes all interleaved through if-ladders over
+isFading, unlinkGraceArmed, and the sampled MusicState. Every new
+feature multiplied the corner cases, and none of it could be exercised
+off-hardware as a whole.
+
+This file makes the lifecycle explicit. The machine has four states -
+dormant, linked, grace, fading - and each row of MUSIC_FSM_TABLE is one
+transition: (state, event, guard) -> (next state, action mask). The
+actions are requests back to the caller (trigger the chime, start the
+fade ramp, advance a playlist, ...); the table itself never touches
+hardware, so it compiles on the host and the specs can script whole
+event traces through it. evalMusicState() (MusicStateMachine.h) stays
+the pure timer layer underneath: its decisions become events here.
+
+A (state, event) pair with no matching row is a deliberate no-op - for
+example a fade timeout that lands after a re-link already pulled the
+machine back to linked is simply dropped.
+
+Host-side coverage: tests/src/music_fsm_spec.cpp scripts the traces,
+and tests/src/bench_fsm.cpp measures the per-event transition cost.
+*/
+
+#ifndef MUSIC_FSM_H
+#define MUSIC_FSM_H
+
+#include <stdint.h>
+
+typedef enum {
+  MF_DORMANT, // Unlinked: idle songs rotate (or one loops)
+  MF_LINKED,  // Linked: the active song plays
+  MF_GRACE,   // Momentary unlink being absorbed; playback untouched
+  MF_FADING,  // Real unlink: fade-out ramp running
+} MusicFsmState;
+
+typedef enum {
+  MF_EV_LINK,          // Contact state went unlinked -> linked
+  MF_EV_UNLINK,        // Contact state went linked -> unlinked
+  MF_EV_GRACE_TIMEOUT, // Grace window expired with the link still down
+  MF_EV_FADE_TIMEOUT,  // MUSIC_STATE_FADE_TIMEOUT from the timer layer
+  MF_EV_FADE_FINISHED, // MUSIC_STATE_FADE_FINISHED: song ran out mid-fade
+  MF_EV_SONG_END,      // MUSIC_STATE_FINISHED: song ran out in playback
+  MF_EV_IDLE_OUT,      // Post-fade idle-out timer fired
+} MusicFsmEvent;
+
+// Action mask a transition returns; the caller executes these in the
+// order listed here (chime before stop, switch-to-dormant before the
+// playlist advance).
+#define MF_ACT_CHIME 0x01          // Trigger the flash-resident link chime
+#define MF_ACT_ARM_GRACE 0x02      // Start the momentary-unlink grace timer
+#define MF_ACT_FADE_OUT 0x04       // Start the fade-out ramp
+#define MF_ACT_RESUME 0x08         // Cancel a running fade at full volume
+#define MF_ACT_STOP 0x10           // Stop the (idle) song so the active one starts
+#define MF_ACT_SWITCH_DORMANT 0x20 // Fade complete: record resume point, go idle
+#define MF_ACT_QUEUE_ACTIVE 0x40   // Advance the active playlist index
+#define MF_ACT_QUEUE_IDLE 0x80     // Advance the idle playlist index
+
+// Guard a row can require. The grace guard is evaluated by the caller
+// (grace enabled and music actually playing) and passed into the step.
+typedef enum {
+  MF_GUARD_NONE,
+  MF_GUARD_GRACE_OK, // Row applies only when the grace window may arm
+  MF_GUARD_NO_GRACE, // Complement: grace disabled or nothing playing
+} MusicFsmGuard;
+
+struct MusicFsmRow {
+  uint8_t state;   // MusicFsmState this row fires from
+  uint8_t event;   // MusicFsmEvent it consumes
+  uint8_t guard;   // MusicFsmGuard that must hold
+  uint8_t next;    // MusicFsmState it lands in
+  uint8_t actions; // MF_ACT_* mask for the caller
+};
+
+static const MusicFsmRow MUSIC_FSM_TABLE[] = {
+    // Dormant: a link brings the chime and swaps idle for active.
+    {MF_DORMANT, MF_EV_LINK, MF_GUARD_NONE, MF_LINKED,
+     MF_ACT_CHIME | MF_ACT_STOP},
+    {MF_DORMANT, MF_EV_SONG_END, MF_GUARD_NONE, MF_DORMANT, MF_ACT_QUEUE_IDLE},
+    {MF_DORMANT, MF_EV_IDLE_OUT, MF_GUARD_NONE, MF_DORMANT,
+     MF_ACT_QUEUE_ACTIVE},
+    // Linked: a short break arms the grace window, otherwise fade out.
+    {MF_LINKED, MF_EV_UNLINK, MF_GUARD_GRACE_OK, MF_GRACE, MF_ACT_ARM_GRACE},
+    {MF_LINKED, MF_EV_UNLINK, MF_GUARD_NO_GRACE, MF_FADING, MF_ACT_FADE_OUT},
+    {MF_LINKED, MF_EV_SONG_END, MF_GUARD_NONE, MF_LINKED, MF_ACT_QUEUE_ACTIVE},
+    // Grace: the break was absorbed (no chime - the chain never audibly
+    // broke) or it was real after all. A song ending here means there is
+    // no playback left to protect, so the window collapses to dormant.
+    {MF_GRACE, MF_EV_LINK, MF_GUARD_NONE, MF_LINKED, 0},
+    {MF_GRACE, MF_EV_GRACE_TIMEOUT, MF_GUARD_NONE, MF_FADING, MF_ACT_FADE_OUT},
+    {MF_GRACE, MF_EV_SONG_END, MF_GUARD_NONE, MF_DORMANT, MF_ACT_QUEUE_IDLE},
+    // Fading: a re-link rescues the song at full volume; otherwise the
+    // fade runs out by timer or by the song ending first.
+    {MF_FADING, MF_EV_LINK, MF_GUARD_NONE, MF_LINKED,
+     MF_ACT_CHIME | MF_ACT_RESUME},
+    {MF_FADING, MF_EV_FADE_TIMEOUT, MF_GUARD_NONE, MF_DORMANT,
+     MF_ACT_SWITCH_DORMANT},
+    {MF_FADING, MF_EV_FADE_FINISHED, MF_GUARD_NONE, MF_DORMANT,
+     MF_ACT_SWITCH_DORMANT | MF_ACT_QUEUE_ACTIVE},
+};
+
+#define MUSIC_FSM_ROWS \
+  ((int)(sizeof(MUSIC_FSM_TABLE) / sizeof(MUSIC_FSM_TABLE[0])))
+
+// Feed one event through the table. Advances `state` and returns the
+// action mask of the matching row, or 0 when no row applies.
+inline uint8_t musicFsmStep(uint8_t &state, MusicFsmEvent event,
+                            bool graceOk) {
+  for (int i = 0; i < MUSIC_FSM_ROWS; i++) {
+    const MusicFsmRow &row = MUSIC_FSM_TABLE[i];
+    if (row.state != state || row.event != event) {
+      continue;
+    }
+    if (row.guard == MF_GUARD_GRACE_OK && !graceOk) {
+      continue;
+    }
+    if (row.guard == MF_GUARD_NO_GRACE && graceOk) {
+      continue;
+    }
+    state = row.next;
+    return row.actions;
+  }
+  return 0;
+}
+
+#endif // MUSIC_FSM_H
@@ -6,26 +6,23 @@ MusicPlayer: Logic for playing songs.
 #define MUSIC_PLAYER_H
 
 #include "AudioSense.h"
+#include "MusicStateMachine.h"
+#include "SongManifest.h"
 #include <Audio.h>
 
-typedef enum {
-  MUSIC_STATE_NOT_STARTED,    // No music has started yet.
-  MUSIC_STATE_PLAYING,        // Music is playing at normal volume.
-  MUSIC_STATE_FADING,         // Music is fading (was: paused) at lower volume.
-  MUSIC_STATE_FADE_TIMEOUT,   // Music was fading but timeout occurred.
-  MUSIC_STATE_RECENT_CONNECTION_IDLE_OUT,   // new: waiting 30s idle-out
-  MUSIC_STATE_FADE_FINISHED,  // Music was fading and finished.
-  MUSIC_STATE_FINISHED        // A song has finished playing.
-} MusicState;
-
 // Function prototypes for Music Player
 MusicState getMusicState(ContactState state);
 void musicPlayerSetup();
+void musicMountLoop();
+bool musicReady();
+bool musicPlaying();
+bool musicFading();
 void fadeMusic();
 void resumeMusic();
 void stopMusic();
 void advanceToNextSong();
-const char *getCurrentSong(bool isLinked);
+const SongInfo *getCurrentSong(bool isLinked);
+const SongInfo *getNextSong(bool isLinked);
 void playMusic(ContactState state);
 void setMusicVolume(float volume);
 
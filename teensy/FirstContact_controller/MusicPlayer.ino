@@ -3,7 +3,22 @@ MusicPlayer: Logic for playing songs.
 */
 
 #include "AudioSense.h"
+#include "ChimePlayer.h"
+#include "EmergencyLoop.h"
+#include "FadeRamp.h"
+#include "Log.h"
+#include "MonoClock.h"
+#include "MusicEnvelope.h"
+#include "MusicFsm.h"
 #include "MusicPlayer.h"
+#include "MusicSync.h"
+#include "NetClock.h"
+#include "SdBench.h"
+#include "SdStream.h"
+#include "SongCache.h"
+#include "SongManifest.h"
+#include "StemMix.h"
+#include "WarmState.h"
 
 #include <Audio.h>
 #include <SD.h>
@@ -20,25 +35,9 @@ MusicPlayer: Logic for playing songs.
 #define SDCARD_MOSI_PIN 11 // not actually used
 #define SDCARD_SCK_PIN 13  // not actually used
 
-// Active songs array.
-const char *contactSongs[] = {
-    "Missing Link unSCruz active 1 Remi Wolf Polo Pan Hello.wav",
-    "Missing Link unSCruz active 2 MarchForth Gospel A.wav",
-    "Missing Link unSCruz active 3 Saint Motel My Type A.wav",
-    "Missing Link unSCruz active 4 Seth Lakeman Lady of the Sea 2.wav",
-    "Missing Link unSCruz active 5 Jacques Greene Another Girl.wav",
-    "Missing Link unSCruz active 6 Chrome Sparks Goddess.wav",
-    "Missing Link unSCruz active 7 Jet Are You Gonna Be.wav",
-    "Missing Link unSCruz active 8 M83 Midnight City Prydz.wav",
-    "Missing Link unSCruz active 9 Flume The Difference.wav",
-    "Missing Link unSCruz active 10 Doldinger Bastian.wav",
-    "Missing Link unSCruz active 11 Yung Bae Straight Up.wav",
-    "Missing Link unSCruz active 12 Purple Disco All My Life.wav",
-};
-
-// Dormant songs array.
-const char *idleSongs[] = {"Missing Link dormant Eros.wav",
-                           "Missing Link dormant Electra.wav"};
+// The playlists come from the boot-time SD manifest (SongManifest.h):
+// files named "*active*.wav" are contact songs, "*dormant*.wav" are idle
+// songs. New WAVs dropped on the card appear without a firmware rebuild.
 
 // Current song index
 unsigned int currentSongIndex = 0;
@@ -46,56 +45,238 @@ unsigned int currentIdleSongIndex = 0;
 
 // Rename isPaused to isFading and pauseStartTime to fadeStartTime
 bool isFading;
-unsigned long fadeStartTime;
+MonoStopwatch fadeWatch; // Started when a fade-out begins (MonoClock.h)
 
-#define NUM_CONTACT_SONGS (sizeof(contactSongs) / sizeof(contactSongs[0]))
-#define NUM_IDLE_SONGS (sizeof(idleSongs) / sizeof(idleSongs[0]))
 #define PLAYING_MUSIC_VOLUME 1.0
 #define FADE_MUSIC_INIT_VOLUME 0.15
 #define PAUSE_TIMEOUT_MS 2000
+
+// Fade durations, live-tunable via missing_link/tune. The fade-out ramp
+// defaults to the pause timeout so the ramp reaches silence exactly when
+// the pause window closes.
+uint16_t fadeOutMs = PAUSE_TIMEOUT_MS;
+uint16_t resumeFadeMs = 250;
+
+// Momentary-unlink grace: an unlink shorter than this is absorbed with
+// playback untouched - no fade ramp, no resume, no SD churn. Distinct
+// from the detection-side debounce, which stays fast for LEDs/haptics;
+// this only delays the *music* reaction. Live-tunable; 0 disables.
+#define UNLINK_GRACE_MS_DEFAULT 300
+uint16_t unlinkGraceMs = UNLINK_GRACE_MS_DEFAULT;
+static MonoDeadline unlinkGrace; // Running grace window
+
+// Lifecycle position, advanced one event at a time through the
+// transition table in MusicFsm.h. MF_GRACE doubles as "grace window
+// armed" - there is no separate flag.
+static uint8_t musicFsmState = MF_DORMANT;
 #define IDLE_OUT_TIMEOUT_MS 10000 // new 10s idle-out
 
-static unsigned long idleOutStartTime = 0;    // new
+// A re-link within this window resumes the faded song where it stopped
+// instead of restarting it from the top.
+#define RESUME_WINDOW_MS 30000
+
+// Follower-side ensemble sync (MusicSync.ino): how often to compare our
+// position against the leader's cue, and the drift past which we jump.
+// The pipeline has no varispeed, so correction is a block-aligned reseek;
+// crystal mismatch between statues is ppm-level and should never reach
+// the threshold within one song.
+#define MUSIC_SYNC_CHECK_MS 1000
+#define MUSIC_SYNC_RESEEK_MS 150
+
+static MonoStopwatch idleOutWatch;            // new
 static bool idleOutTimerStarted = false;      // new
 
-// The wav player interface.
-AudioPlaySdWav playSdWav1;
+// Playback position recorded when a fade-out completes (manifest entries
+// are stable, so the song is remembered by pointer).
+static const SongInfo *resumeSong = nullptr;
+static uint32_t resumeOffset = 0;
+static MonoDeadline resumeWindow; // Resume only before this deadline
+
+// The wav player interface. AudioPlaySdStream prefetches into a double
+// buffer from the main loop (see SdStream.h), so the audio update only
+// touches RAM and SD latency from MQTT/display stalls cannot drop audio.
+AudioPlaySdStream playSdWav1;
+// The fade engine: gain ramps step inside the audio update along a
+// precomputed curve (see FadeRamp.h), so fades stay smooth regardless of
+// loop() cadence.
+AudioEffectFadeRamp musicFade;
 // The music mixer, used to adjust music volume before sending to audio output.
 AudioMixer4 mixerMusicOutput;
-// Have them both go to the right mixer.
-AudioConnection patchCord11(playSdWav1, 0, mixerMusicOutput, 2);
+// Flash-resident "connection made" chime: fires within one audio block of
+// a link event, long before the SD-streamed active song is audible.
+AudioPlayChime linkChime;
+// Streamer -> fade engine -> music mixer.
+AudioConnection patchCord11(playSdWav1, 0, musicFade, 0);
+AudioConnection patchCord12(musicFade, 0, mixerMusicOutput, 2);
+// The chime mixes in on its own channel so it rides over the song.
+AudioConnection patchCord13(linkChime, 0, mixerMusicOutput, 3);
+// Stem layers for the active song: more statues in the chain bring more
+// parts in (see StemMix.h). Their own channel keeps the layer ramps
+// independent of the base song's fade engine.
+AudioPlayStemSet stemSet;
+AudioConnection patchCord10(stemSet, 0, mixerMusicOutput, 0);
+// Degraded-mode drone for when the SD card is gone (EmergencyLoop.h);
+// its own channel so the mount supervisor can gate it independently.
+AudioPlayEmergencyLoop emergencyLoop;
+AudioConnection patchCord14(emergencyLoop, 0, mixerMusicOutput, 1);
+// Envelope follower on the mixed music output: smoothed amplitude for
+// the beat-synced haptics and LEDs (see MusicEnvelope.h). An analyze
+// node is pure fan-out - no copy on the music path.
+AudioAnalyzeEnvelope musicEnv;
+AudioConnection patchCordEnv(mixerMusicOutput, 0, musicEnv, 0);
+#if DUAL_CODEC_AUDIO
+// Music gets its own codec on the second I2S peripheral: full level with
+// no shared-headroom compromise against the sense tone, and the per-I2S
+// update load is split. The I2S2 DAC has no volume register, so level
+// control stays digital in the mixer gains (which is where it already
+// lives - see setMusicVolume()).
+AudioOutputI2S2 audioOut2;
+AudioConnection patchCordMOR(mixerMusicOutput, 0, audioOut2, 0);
+AudioConnection patchCordMOR2(mixerMusicOutput, 0, audioOut2, 1);
+#else
 // Left channel (music player) plays on the right audio out channel.
 AudioConnection patchCordMOR(mixerMusicOutput, 0, audioOut, 1);
+#endif
+
+// SD mount supervisor state. setup() only configures the SPI pins; the
+// first SD.begin attempt (and any retries) happen from the scheduler via
+// musicMountLoop(), so tone transmission and sensing are live before any
+// card I/O. A missing or dying card degrades to a silent statue that
+// still senses, instead of the old infinite retry loop in setup().
+#define MUSIC_MOUNT_RETRY_MS 500
+#define MUSIC_MOUNT_SLOW_RETRY_MS 5000
+#define MUSIC_MOUNT_WARN_ATTEMPTS 10
+
+static bool musicMounted = false;
+static int mountAttempts = 0;
+static elapsedMillis sinceMountAttempt = MUSIC_MOUNT_RETRY_MS;
 
 void musicPlayerSetup() {
   // Setup the SPI driver for MicroSd Card
   // Our project uses the on board MicroSd, NOT the AudioShield's MicroSd slot
   SPI.setMOSI(SDCARD_MOSI_PIN);
   SPI.setSCK(SDCARD_SCK_PIN);
-  if (!(SD.begin(SDCARD_CS_PIN))) {
-    while (1) {
-      Serial.println("Unable to access the SD card");
-      delay(500);
+  // Mounting continues in musicMountLoop(); nothing below here blocks.
+}
+
+// Playback offset carried over from a warm reset (WarmState.h), applied
+// to the first song start after the manifest is up.
+static uint32_t warmResumeOffset = 0;
+
+// Restore playlist positions from a warm-reset snapshot. The indices are
+// clamped against the freshly scanned manifest in case the card changed
+// across the reset.
+static void applyWarmMusicState() {
+  WarmState ws;
+  if (!warmStateGet(&ws)) {
+    return;
+  }
+  if (activeSongCount() > 0) {
+    currentSongIndex = ws.songIndex % activeSongCount();
+  }
+  if (idleSongCount() > 0) {
+    currentIdleSongIndex = ws.idleSongIndex % idleSongCount();
+  }
+  warmResumeOffset = ws.playbackOffset;
+  LOG_INFO("warm restart: songs %u/%u, resume at byte %lu", currentSongIndex,
+           currentIdleSongIndex, (unsigned long)warmResumeOffset);
+}
+
+void musicMountLoop() {
+  if (musicMounted) {
+    return;
+  }
+  uint32_t retryMs = (mountAttempts >= MUSIC_MOUNT_WARN_ATTEMPTS)
+                         ? MUSIC_MOUNT_SLOW_RETRY_MS
+                         : MUSIC_MOUNT_RETRY_MS;
+  if (sinceMountAttempt < retryMs) {
+    return;
+  }
+  sinceMountAttempt = 0;
+  mountAttempts++;
+
+  if (!SD.begin(SDCARD_CS_PIN)) {
+    if (mountAttempts == MUSIC_MOUNT_WARN_ATTEMPTS) {
+      LOG_WARN("SD mount failed %d times; retrying every %d ms",
+               mountAttempts, MUSIC_MOUNT_SLOW_RETRY_MS);
+      // Enter degraded mode: announce it on the fault topic and bring
+      // up the flash-resident drone so the statue does not read as
+      // dead. Sensing, networking, haptics, and LEDs are untouched.
+      publishSdMountFault(mountAttempts);
+      mixerMusicOutput.gain(1, 0.8);
+      emergencyLoop.start();
+      LOG_WARN("degraded mode: flash-resident loop until SD returns");
     }
+    return;
+  }
+
+  // SD.begin() rides Teensyduino's SdFat underneath (SD.sdfs), so exFAT
+  // cards mount the same as FAT32 - no 32 GB ceiling. exFAT also marks
+  // unfragmented files "no FAT chain", making every mid-file seek
+  // arithmetic; the manifest scan below flags files that are not.
+  uint8_t fatType = SD.sdfs.fatType();
+  LOG_INFO("SD volume: %s", fatType == FAT_TYPE_EXFAT ? "exFAT"
+                            : fatType == FAT_TYPE_FAT32 ? "FAT32"
+                                                        : "FAT16");
+
+  // Scan the card once and cache per-file metadata so starting a song
+  // never walks the directory or parses a header again.
+  buildSongManifest();
+
+  // Queue the dormant songs for background promotion into PSRAM.
+  songCacheInit();
+
+  // Quick throughput/latency verdict on this card against the pipeline's
+  // worst-case demand (SdBench.h): a donated card that cannot keep up is
+  // flagged here, in the setup log, not as Saturday-night dropouts.
+  sdBenchBootCheck();
+
+  // Link chime level (mixer channel 3, independent of the music gain).
+  mixerMusicOutput.gain(3, 0.6);
+
+  // Pick the playlists back up where a warm reset left them.
+  applyWarmMusicState();
+
+  // Promotion back to SD playback: kill the degraded-mode drone; the
+  // normal playMusic() path takes over from the next sense pass.
+  if (emergencyLoop.isPlaying()) {
+    emergencyLoop.stop();
+    LOG_INFO("SD recovered; leaving degraded mode");
   }
+
+  musicMounted = true;
+  LOG_INFO("SD mounted on attempt %d", mountAttempts);
 }
 
+bool musicReady() { return musicMounted; }
+
+bool musicPlaying() { return playSdWav1.isPlaying(); }
+
+// Passive fade-state read for the audio pool attribution; unlike
+// getMusicState() it never touches the fade/idle-out timers.
+bool musicFading() { return isFading; }
+
+float musicEnvelopeLevel() { return musicEnv.level(); }
+
 void fadeMusic() {
   if (!isFading && playSdWav1.isPlaying()) {
     isFading = true;
-    fadeStartTime = millis(); // Record when fading started
+    fadeWatch.start(monoNowUs()); // Record when fading started
+    // Duck to the fade start level, then ramp to silence in the audio
+    // update; the state machine timing below is unchanged.
+    musicFade.setGain(FADE_MUSIC_INIT_VOLUME);
+    musicFade.fadeOut(fadeOutMs);
     Serial.println("Music fading (ramping down volume)");
   }
 }
 
 void resumeMusic() {
   if (isFading && playSdWav1.isPlaying()) {
-    // Restore volume
-    // TODO: ramp volume back up?
-    setMusicVolume(PLAYING_MUSIC_VOLUME);
+    // Ramp back up to full volume instead of jumping.
+    musicFade.fadeIn(resumeFadeMs);
 
     isFading = false;
-    Serial.println("Music resumed (volume restored)");
+    Serial.println("Music resumed (volume ramping up)");
   } else {
     Serial.println("Music is not fading or not playing");
   }
@@ -108,27 +289,71 @@ void stopMusic() {
 }
 void queueNextActiveSong() {
   Serial.println("Song finished. Advancing to next active song.");
-  currentSongIndex = (currentSongIndex + 1) % NUM_CONTACT_SONGS;
-  Serial.print("Next active song will be: ");
-  Serial.println(contactSongs[currentSongIndex]);
+  if (activeSongCount() > 0) {
+    currentSongIndex = (currentSongIndex + 1) % activeSongCount();
+    Serial.print("Next active song will be: ");
+    Serial.println(activeSong(currentSongIndex)->filename);
+  }
 }
 
 void queueNextIdleSong() {
   Serial.println("Idle song finished. Looping to next idle song.");
-  currentIdleSongIndex = (currentIdleSongIndex + 1) % NUM_IDLE_SONGS;
-  Serial.print("Next idle song will be: ");
-  Serial.println(idleSongs[currentIdleSongIndex]);
+  if (idleSongCount() > 0) {
+    currentIdleSongIndex = (currentIdleSongIndex + 1) % idleSongCount();
+    Serial.print("Next idle song will be: ");
+    Serial.println(idleSong(currentIdleSongIndex)->filename);
+  }
 }
 
-// Helper function to get the current song to play.
-const char *getCurrentSong(bool isLinked) {
+// Helper function to get the current song to play (null if the card has no
+// songs of that category).
+const SongInfo *getCurrentSong(bool isLinked) {
   if (isLinked) {
-    return contactSongs[currentSongIndex];
+    return activeSong(currentSongIndex);
   } else {
-    return idleSongs[currentIdleSongIndex];
+    return idleSong(currentIdleSongIndex);
   }
 }
 
+// Helper function to get the song that should follow the current one.
+const SongInfo *getNextSong(bool isLinked) {
+  if (isLinked) {
+    return activeSong(currentSongIndex + 1);
+  } else {
+    return idleSong(currentIdleSongIndex + 1);
+  }
+}
+
+// Cue arithmetic for MusicSync (MusicSync.ino). Playback consumes
+// source bytes at blockAlign * rate / samplesPerBlock per second (PCM16
+// stereo: ~176 bytes/ms). The rate that matters is the file's own sample
+// rate: a 44.1 kHz file is consumed at the graph rate, and a 48 kHz file
+// is consumed at 48k frames per wall-clock second by the streamer's
+// resampler - either way source bytes map to elapsed time through
+// song.sampleRate.
+static uint32_t songBytesPerSec(const SongInfo &song) {
+  return (uint32_t)((float)song.blockAlign * (float)song.sampleRate /
+                    (float)song.samplesPerBlock);
+}
+
+static uint32_t songBytesToMs(const SongInfo &song, uint32_t bytes) {
+  return (uint32_t)((uint64_t)bytes * 1000 / songBytesPerSec(song));
+}
+
+// The data-chunk offset this statue should be at right now, given the
+// leader's shared-clock anchor for the song's byte 0.
+static uint32_t cueOffsetBytes(const SongInfo &song, uint64_t anchorEpochMs) {
+  uint64_t now = sharedClockMs();
+  if (now <= anchorEpochMs) {
+    return 0; // Cue not started yet (or clock skew): start at the top
+  }
+  uint64_t offset = (now - anchorEpochMs) * songBytesPerSec(song) / 1000;
+  if (offset >= song.dataLength) {
+    return 0; // Leader's song already ended; it will re-anchor
+  }
+  return (uint32_t)(offset - offset % song.blockAlign);
+}
+
 // Helper function to determine the current state of music playback
 MusicState getMusicState(ContactState state) {
   if (!state.isInitialized) {
@@ -142,7 +367,7 @@ MusicState getMusicState(ContactState state) {
 
   if (isFading) {
     // still within the fading window?
-    if (millis() - fadeStartTime <= PAUSE_TIMEOUT_MS) {
+    if (fadeWatch.elapsedMs(monoNowUs()) <= PAUSE_TIMEOUT_MS) {
       // if playback stopped while fading, treat as finished
       if (!playSdWav1.isPlaying()) {
         return MUSIC_STATE_FADE_FINISHED;
@@ -152,14 +377,14 @@ MusicState getMusicState(ContactState state) {
     // Fading has timed out → start idle-out timer.
     if (!idleOutTimerStarted) {
       idleOutTimerStarted = true;
-      idleOutStartTime = millis();
+      idleOutWatch.start(monoNowUs());
     }
     return MUSIC_STATE_FADE_TIMEOUT;
   }
 
   // once pause-timeout was set, after 30 s of idle play, enter idle-out
   if (idleOutTimerStarted
-      && (millis() - idleOutStartTime >= IDLE_OUT_TIMEOUT_MS)
+      && (idleOutWatch.elapsedMs(monoNowUs()) >= IDLE_OUT_TIMEOUT_MS)
     ) {
     // Reset the idle out timer, to take action (e.g. queue next song) only once.
     idleOutTimerStarted = false;
@@ -172,89 +397,217 @@ MusicState getMusicState(ContactState state) {
   return MUSIC_STATE_PLAYING;
 }
 
-// New helper: updates volume based on fade logic during fade.
-void updateFadedVolume(bool isLinked) {
-  // TODO: Move this logic into ContactState for sharing with lights?
-  // Check if we are fading and not linked. If we're linked, it means
-  // we're in the process of resuming a song.
-  if (isFading && !isLinked && playSdWav1.isPlaying()) {
-    unsigned long elapsed = millis() - fadeStartTime;
-    float fraction = elapsed / (float)PAUSE_TIMEOUT_MS;
-    if (fraction > 1.0)
-      fraction = 1.0;
-    float newVolume = FADE_MUSIC_INIT_VOLUME * (1.0 - fraction);
-    setMusicVolume(newVolume);
-
-    // Print the volume only if it has changed significantly.
-    // This is to avoid flooding the serial output with too many messages.
-    static int lastSigVolume = -1;
-    int currentSig = (int)(newVolume * 10);
-    if (currentSig != lastSigVolume) {
-      lastSigVolume = currentSig;
-      Serial.print("Fading volume to ");
-      Serial.println(newVolume);
-    }
-  }
-}
-
 static void handleFadeComplete() {
+  // Remember where the active song stopped so a quick re-link picks it up
+  // mid-track. position() is 0 when the song already ran out, in which
+  // case there is nothing to resume.
+  const SongInfo *faded = activeSong(currentSongIndex);
+  uint32_t fadedAt = playSdWav1.position();
+  if (faded != nullptr && fadedAt > 0) {
+    resumeSong = faded;
+    resumeOffset = fadedAt;
+    resumeWindow.set(monoNowUs(), RESUME_WINDOW_MS * 1000ull);
+  }
   stopMusic();
   queueNextIdleSong();
   // Reset isFading since we're stopping the song.
   isFading = false;
-  // Also reset the volume to the default.
-  setMusicVolume(PLAYING_MUSIC_VOLUME);
+  // Also reset the fade gain so the next (idle) song starts at full level.
+  musicFade.setGain(PLAYING_MUSIC_VOLUME);
 }
 
-/* Play Audio Based On State */
-void playMusic(ContactState state) {
-  MusicState musicState = getMusicState(state);
-
-  // State transition: Connected -> Disconnected.
-  bool wasLinked = (state.wasLinkedMask != 0);
-  if (wasLinked && !state.isLinked()) {
+// Execute the action mask a transition-table row returned (MusicFsm.h).
+// The table decides, this touches the hardware; order matches the mask
+// documentation (chime before stop, dormant switch before the queue).
+static void runMusicActions(uint8_t actions, MusicState musicState) {
+  if (actions & MF_ACT_CHIME) {
+    // Immediate audible confirmation from flash; the streamed active
+    // song follows once the start block below picks it up.
+    linkChime.trigger();
+  }
+  if (actions & MF_ACT_ARM_GRACE) {
+    // Sweaty-hand micro-break: give the link a moment to come back
+    // before touching playback at all.
+    unlinkGrace.set(monoNowUs(), (uint64_t)unlinkGraceMs * 1000);
+  }
+  if (actions & MF_ACT_FADE_OUT) {
     fadeMusic();
   }
-  // State transition: Disconnected -> Connected.
-  else if (!wasLinked && state.isLinked()) {
-    if (musicState == MUSIC_STATE_FADING) {
-      // If we were fading (previous disconnect), resume playback
-      Serial.println("Resuming faded music");
-      resumeMusic();
-    } else if (musicState == MUSIC_STATE_PLAYING) {
-      // If we weren't fading, stop any currently playing song.
-      // This is expected to be the idle song.
+  if (actions & MF_ACT_RESUME) {
+    Serial.println("Resuming faded music");
+    resumeMusic();
+  }
+  if (actions & MF_ACT_STOP) {
+    // Stop the currently playing (idle) song so the active one starts.
+    // Between songs there is nothing to stop and the chime stands alone.
+    if (musicState == MUSIC_STATE_PLAYING) {
       Serial.println("Stopping current song to play contact song");
       stopMusic();
     }
   }
+  if (actions & MF_ACT_SWITCH_DORMANT) {
+    Serial.println("Fade complete. Switching to dormant music.");
+    handleFadeComplete();
+  }
+  if (actions & MF_ACT_QUEUE_ACTIVE) {
+    queueNextActiveSong();
+  }
+  if (actions & MF_ACT_QUEUE_IDLE) {
+    queueNextIdleSong();
+  }
+}
+
+/* Play Audio Based On State */
+void playMusic(ContactState state) {
+  // Nothing to do until the mount supervisor has the card up and the
+  // manifest built; the chime is flash-resident and handled elsewhere.
+  if (!musicMounted) {
+    return;
+  }
+
+  // Keep the streamer's double buffer topped up before anything else; this
+  // is the only place SD reads happen during playback.
+  playSdWav1.fillLoop();
+
+  // Advance background PSRAM promotion by one slice.
+  songCacheLoop();
+
+  // Stem housekeeping: pick up finished promotions and keep the layers
+  // aligned with the base song. The chain-size update sits below the
+  // transition handling so the unlink grace window covers it too.
+  stemSet.refreshCache();
+  if (playSdWav1.isPlaying() && !isFading) {
+    stemSet.syncTo(playSdWav1.position());
+  }
+
+  // Gapless transition bookkeeping: when the streamer has chained into the
+  // preloaded song, advance the matching playlist index. isPlaying() never
+  // drops across the boundary, so the FINISHED path below does not fire.
+  if (playSdWav1.consumedPreload()) {
+    if (state.isLinked()) {
+      queueNextActiveSong();
+    } else {
+      queueNextIdleSong();
+    }
+    const SongInfo *nowPlaying = getCurrentSong(state.isLinked());
+    if (nowPlaying != nullptr) {
+      songCacheTouch(*nowPlaying);
+      applySongGain(*nowPlaying);
+      stemSet.setSong(nowPlaying);
+      // Leader: re-anchor the ensemble cue on the gapless transition so
+      // followers advance with us instead of drifting a full song out.
+      if (state.isLinked() && musicSyncIsLeader() && netClockSynced()) {
+        musicSyncAnchor(currentSongIndex,
+                        sharedClockMs() -
+                            songBytesToMs(*nowPlaying, playSdWav1.position()));
+      }
+    }
+  }
+
+  // While a song plays, keep its successor preopened and prebuffered so the
+  // transition is sample-accurate. A stop() discards any stale preload.
+  // A looping dormant track has no successor - don't hold a file open for
+  // one all night.
+  if (playSdWav1.isPlaying() && !isFading && !playSdWav1.isLooping() &&
+      !playSdWav1.hasPreload()) {
+    const SongInfo *next = getNextSong(state.isLinked());
+    if (next != nullptr) {
+      playSdWav1.preload(*next);
+    }
+  }
+
+  // Follower drift check: once a second, compare our position against
+  // the leader's cue. A different song means the ensemble moved on (or
+  // we linked first with our own pick) - switch to it; the same song
+  // with drift past the audible threshold gets a block-aligned reseek.
+  static MonoDeadline syncCheck;
+  if (playSdWav1.isPlaying() && state.isLinked() && !isFading &&
+      activeSongCount() > 0 && syncCheck.expired(monoNowUs())) {
+    syncCheck.set(monoNowUs(), MUSIC_SYNC_CHECK_MS * 1000ull);
+    unsigned int cueIndex;
+    uint64_t cueAnchor;
+    if (musicSyncCue(&cueIndex, &cueAnchor)) {
+      unsigned int leaderIndex = cueIndex % activeSongCount();
+      const SongInfo *leaderSong = activeSong(leaderIndex);
+      uint32_t expected = cueOffsetBytes(*leaderSong, cueAnchor);
+      if (leaderIndex != currentSongIndex) {
+        Serial.printf("MusicSync: switching to ensemble song at byte %lu\n",
+                      (unsigned long)expected);
+        currentSongIndex = leaderIndex;
+        if (playSdWav1.play(*leaderSong, expected)) {
+          songCacheTouch(*leaderSong);
+          applySongGain(*leaderSong);
+          stemSet.setSong(leaderSong);
+        }
+      } else {
+        int64_t deltaBytes =
+            (int64_t)playSdWav1.position() - (int64_t)expected;
+        int32_t driftMs = (int32_t)(deltaBytes * 1000 /
+                                    (int64_t)songBytesPerSec(*leaderSong));
+        musicSyncReportDrift(driftMs);
+        if (expected > 0 && (driftMs > MUSIC_SYNC_RESEEK_MS ||
+                             driftMs < -MUSIC_SYNC_RESEEK_MS)) {
+          Serial.printf("MusicSync: drift %ld ms, reseeking\n",
+                        (long)driftMs);
+          playSdWav1.play(*leaderSong, expected);
+        }
+      }
+    }
+  }
+
+  MusicState musicState = getMusicState(state);
+
+  // Lifecycle transitions: turn the sampled contact edges, the grace
+  // timer, and the timer-layer outcomes into events for the transition
+  // table (MusicFsm.h), then execute whatever actions the rows return.
+  // Link edges go first so a fade timeout that lands on the same pass as
+  // a re-link finds the machine already back in MF_LINKED and is dropped.
+  if (state.wasLinked() && !state.isLinked()) {
+    bool graceOk = unlinkGraceMs > 0 && musicState == MUSIC_STATE_PLAYING;
+    runMusicActions(musicFsmStep(musicFsmState, MF_EV_UNLINK, graceOk),
+                    musicState);
+  } else if (!state.wasLinked() && state.isLinked()) {
+    runMusicActions(musicFsmStep(musicFsmState, MF_EV_LINK, false),
+                    musicState);
+  }
 
-  // Handle fade timeout and finished states.
+  // Grace window ran out with the link still down: a real unlink.
+  if (musicFsmState == MF_GRACE && !state.isLinked() &&
+      unlinkGrace.expired(monoNowUs())) {
+    runMusicActions(musicFsmStep(musicFsmState, MF_EV_GRACE_TIMEOUT, false),
+                    musicState);
+  }
+
+  // Chain-size estimate (direct links plus us) for the stem layers. Held
+  // during the grace window so an absorbed micro-break does not wobble
+  // the layer gains either.
+  if (musicFsmState != MF_GRACE) {
+    stemSet.setChainSize(
+        state.isLinked() ? __builtin_popcount((unsigned)state.isLinkedMask) + 1
+                         : 1);
+  }
+
+  // Timer-layer outcomes (fade windows, idle-out, song end) as events.
   switch (musicState) {
   case MUSIC_STATE_RECENT_CONNECTION_IDLE_OUT:
     Serial.println("Recent connection idled out. Queuing next active song.");
-    queueNextActiveSong();
+    runMusicActions(musicFsmStep(musicFsmState, MF_EV_IDLE_OUT, false),
+                    musicState);
     break;
   case MUSIC_STATE_FADE_TIMEOUT:
-    Serial.println("Fade timed out. Switching to dormant music.");
-    handleFadeComplete();
+    runMusicActions(musicFsmStep(musicFsmState, MF_EV_FADE_TIMEOUT, false),
+                    musicState);
     break;
   case MUSIC_STATE_FADE_FINISHED:
-    Serial.println("Song finished while fading. Stopping and switching to dormant.");
-    handleFadeComplete();
-    // Queue the next active song, because the song finished.
-    queueNextActiveSong();
+    runMusicActions(musicFsmStep(musicFsmState, MF_EV_FADE_FINISHED, false),
+                    musicState);
     break;
   case MUSIC_STATE_FINISHED:
-    if (state.isLinked()) {
-      queueNextActiveSong();
-    } else {
-      queueNextIdleSong();
-    }
+    runMusicActions(musicFsmStep(musicFsmState, MF_EV_SONG_END, false),
+                    musicState);
     break;
   case MUSIC_STATE_FADING:
-    // Update the faded volume based on the elapsed time.
-    updateFadedVolume(state.isLinked());
+    // The gain ramp runs inside the audio update; nothing to do here.
     break;
   default:
     // No action needed for other states.
@@ -263,18 +616,88 @@ void playMusic(ContactState state) {
 
   // Nothing is playing - start the appropriate song.
   if (!playSdWav1.isPlaying()) {
-    // Start the appropriate song.
-    Serial.print("Starting song: ");
-    const char *songToPlay = getCurrentSong(state.isLinked());
-    Serial.println(songToPlay);
-    if (!playSdWav1.play(songToPlay)) {
+    const SongInfo *songToPlay = getCurrentSong(state.isLinked());
+    if (songToPlay == nullptr) {
+      // No songs of this category on the card; buildSongManifest() already
+      // logged the scan results at boot.
+      return;
+    }
+    bool started;
+    uint32_t startOffset = 0;
+    unsigned int cueIndex;
+    uint64_t cueAnchor;
+    if (state.isLinked() && activeSongCount() > 0 &&
+        musicSyncCue(&cueIndex, &cueAnchor)) {
+      // Follower in an ensemble: join the leader's song at the
+      // cue-derived position instead of picking our own.
+      currentSongIndex = cueIndex % activeSongCount();
+      songToPlay = activeSong(currentSongIndex);
+      startOffset = cueOffsetBytes(*songToPlay, cueAnchor);
+      Serial.printf("Joining ensemble at byte %lu: %s\n",
+                    (unsigned long)startOffset, songToPlay->filename);
+      started = playSdWav1.play(*songToPlay, startOffset);
+    } else if (state.isLinked() && songToPlay == resumeSong &&
+               !resumeWindow.expired(monoNowUs())) {
+      // Re-link shortly after a fade-out: continue the same song from the
+      // recorded offset instead of restarting it.
+      Serial.printf("Resuming song at byte %lu: %s\n",
+                    (unsigned long)resumeOffset, songToPlay->filename);
+      startOffset = resumeOffset;
+      started = playSdWav1.play(*songToPlay, resumeOffset);
+    } else if (warmResumeOffset != 0) {
+      // First start after a warm reset: continue mid-song instead of
+      // audibly restarting the playlist.
+      Serial.printf("Warm resume at byte %lu: %s\n",
+                    (unsigned long)warmResumeOffset, songToPlay->filename);
+      startOffset = warmResumeOffset;
+      started = playSdWav1.play(*songToPlay, warmResumeOffset);
+    } else {
+      Serial.print("Starting song: ");
+      Serial.println(songToPlay->filename);
+      started = playSdWav1.play(*songToPlay);
+    }
+    // One shot either way; a stale offset must not affect a later start.
+    resumeSong = nullptr;
+    warmResumeOffset = 0;
+    if (!started) {
       Serial.print("Error playing: ");
-      Serial.println(songToPlay);
+      Serial.println(songToPlay->filename);
+    } else {
+      // Refresh cache recency / queue this song for PSRAM promotion.
+      songCacheTouch(*songToPlay);
+      applySongGain(*songToPlay);
+      stemSet.setSong(songToPlay);
+      stemSet.syncTo(startOffset);
+      // Dormant tracks with smpl loop points hold one seamless loop
+      // instead of restarting with a gap every few minutes all night.
+      playSdWav1.setLooping(!state.isLinked() &&
+                            songToPlay->loopEndBytes != 0);
+      // Leader in an ensemble: anchor the cue at this start so linked
+      // followers play the same bytes at the same shared-clock time.
+      if (state.isLinked() && musicSyncIsLeader() && netClockSynced()) {
+        musicSyncAnchor(currentSongIndex,
+                        sharedClockMs() -
+                            songBytesToMs(*songToPlay, startOffset));
+      }
     }
   }
 }
 
+// Loudness normalization gain of the song now playing (from the table
+// built at boot; see loadLoudnessTable() in SongManifest.cpp).
+static float currentSongGain = 1.0;
+
 void setMusicVolume(float volume) {
-  // Adjust the gain on the music output mixer channel (channel 2)
-  mixerMusicOutput.gain(2, volume);
+  // Adjust the gain on the music output mixer channel (channel 2),
+  // folding in the current song's loudness normalization.
+  mixerMusicOutput.gain(2, volume * currentSongGain);
+  // The stem layers (channel 0) are mastered against the base song, so
+  // they track the same level and the blend holds at any volume.
+  mixerMusicOutput.gain(0, volume * currentSongGain);
+}
+
+// Apply a song's normalization gain; called whenever a new song starts.
+static void applySongGain(const SongInfo &song) {
+  currentSongGain = song.gain;
+  setMusicVolume(PLAYING_MUSIC_VOLUME);
 }
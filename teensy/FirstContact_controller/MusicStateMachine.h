@@ -0,0 +1,79 @@
+/*
+MusicStateMachine: the pure music playback state decision.
+
+Extracted from getMusicState() so the fade/idle-out timing logic
+compiles on a PC with a simulated clock (see tests/music_state_spec.cpp).
+evalMusicState() reads a sampled snapshot of the player and returns the
+state plus the timer bookkeeping the caller must apply - the statics
+(isFading, the idle-out timer) stay with the hardware wrapper in
+MusicPlayer.ino.
+*/
+
+#ifndef MUSIC_STATE_MACHINE_H
+#define MUSIC_STATE_MACHINE_H
+
+typedef enum {
+  MUSIC_STATE_NOT_STARTED,    // No music has started yet.
+  MUSIC_STATE_PLAYING,        // Music is playing at normal volume.
+  MUSIC_STATE_FADING,         // Music is fading (was: paused) at lower volume.
+  MUSIC_STATE_FADE_TIMEOUT,   // Music was fading but timeout occurred.
+  MUSIC_STATE_RECENT_CONNECTION_IDLE_OUT,   // new: waiting 30s idle-out
+  MUSIC_STATE_FADE_FINISHED,  // Music was fading and finished.
+  MUSIC_STATE_FINISHED        // A song has finished playing.
+} MusicState;
+
+// Everything the decision reads, sampled by the caller.
+struct MusicStateInputs {
+  bool initialized;         // ContactState has seen at least one update
+  bool fading;              // A fade-out is in progress
+  bool playing;             // The SD streamer reports playback
+  bool idleOutTimerStarted; // The post-fade idle-out timer is running
+  unsigned long nowMs;
+  unsigned long fadeStartMs;    // When the fade-out began
+  unsigned long idleOutStartMs; // When the idle-out timer began
+  unsigned long pauseTimeoutMs; // Fade window length
+  unsigned long idleOutTimeoutMs;
+};
+
+// The state plus timer side effects for the caller to apply.
+struct MusicStateDecision {
+  MusicState state;
+  bool startIdleOutTimer; // Begin the idle-out timer at nowMs
+  bool stopIdleOutTimer;  // Idle-out fired; reset so it acts only once
+};
+
+inline MusicStateDecision evalMusicState(const MusicStateInputs &in) {
+  MusicStateDecision out = {MUSIC_STATE_NOT_STARTED, false, false};
+
+  if (!in.initialized) {
+    return out;
+  }
+
+  if (in.fading) {
+    // Still within the fading window?
+    if (in.nowMs - in.fadeStartMs <= in.pauseTimeoutMs) {
+      // If playback stopped while fading, treat as finished.
+      out.state = in.playing ? MUSIC_STATE_FADING : MUSIC_STATE_FADE_FINISHED;
+      return out;
+    }
+    // Fading has timed out -> start the idle-out timer.
+    if (!in.idleOutTimerStarted) {
+      out.startIdleOutTimer = true;
+    }
+    out.state = MUSIC_STATE_FADE_TIMEOUT;
+    return out;
+  }
+
+  // Once the fade timed out, after the idle window enter idle-out (once).
+  if (in.idleOutTimerStarted &&
+      in.nowMs - in.idleOutStartMs >= in.idleOutTimeoutMs) {
+    out.stopIdleOutTimer = true;
+    out.state = MUSIC_STATE_RECENT_CONNECTION_IDLE_OUT;
+    return out;
+  }
+
+  out.state = in.playing ? MUSIC_STATE_PLAYING : MUSIC_STATE_FINISHED;
+  return out;
+}
+
+#endif // MUSIC_STATE_MACHINE_H
@@ -0,0 +1,39 @@
+/*
+MusicSync: shared-clock cue protocol for ensemble playback.
+*/
+
+#ifndef MUSIC_SYNC_H
+#define MUSIC_SYNC_H
+
+#include <Arduino.h>
+
+// Public so the mDNS announcement in Networking.ino can advertise it.
+#define MUSIC_SYNC_PORT 5809
+
+// Join the multicast group. Call once the network is up and the statue
+// identity is known.
+void initMusicSync();
+
+// Receive peer cues and send the leader heartbeat; call from loop()
+// while the network is ready.
+void musicSyncLoop();
+
+// True when this statue is the cue leader: linked, with no linked peer
+// of lower index.
+bool musicSyncIsLeader();
+
+// Leader side: anchor the cue for the active song now playing.
+// `anchorEpochMs` is the shared-clock time at which byte 0 of the song's
+// data chunk (notionally) played; it is rebroadcast until re-anchored.
+void musicSyncAnchor(unsigned int songIndex, uint64_t anchorEpochMs);
+
+// Follower side: latest fresh cue from a lower-indexed linked leader.
+// Returns false when leader, unlinked, clock-unsynced, or no cue heard.
+bool musicSyncCue(unsigned int *songIndex, uint64_t *anchorEpochMs);
+
+// Follower drift accounting (for telemetry and the reseek decision in
+// MusicPlayer.ino). Positive = this statue is ahead of the leader.
+void musicSyncReportDrift(int32_t driftMs);
+int32_t musicSyncDriftMs();
+
+#endif // MUSIC_SYNC_H
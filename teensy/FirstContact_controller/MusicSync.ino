@@ -0,0 +1,167 @@
+/*
+  MusicSync: shared-clock cue protocol for ensemble playback.
+
+  When two statues link, each used to start its own copy of the active
+  song from its own clock, and 50 ft apart the phasing was audible within
+  a minute. The statue with the lowest index in a link is the cue leader:
+  it multicasts (song index, shared-clock anchor of the song's byte 0) at
+  1 Hz plus immediately on each (re)anchor. Followers join the leader's
+  song at the cue-derived offset and reseek if they drift past the
+  audible threshold (see the follower logic in MusicPlayer.ino). The
+  anchor rides sharedClockMs() (NetClock.ino), so the cue is meaningful
+  across statues to about a millisecond.
+
+  Same transport shape as PeerLink.ino: a tiny fixed frame on its own
+  multicast socket, version-checked, latest-wins.
+*/
+
+#include "MusicSync.h"
+#include "MusicPlayer.h"
+#include "NetClock.h"
+#include "Networking.h"
+#include "PeerLink.h"
+#include "StatueConfig.h"
+
+#define MUSIC_SYNC_PERIOD_MS 1000
+#define MUSIC_SYNC_STALE_MS 3500
+#define MUSIC_SYNC_VERSION 1
+
+static const IPAddress MUSIC_SYNC_GROUP(239, 255, 58, 9);
+
+// Written by the sense timer ISR (see AudioSense.ino).
+extern volatile StatueMask latestLinkedMask;
+
+// Fixed little-endian layout; peers (and the Pi, if it ever wants to
+// observe the ensemble) parse this directly.
+struct __attribute__((packed)) MusicSyncFrame {
+  uint8_t version;
+  uint8_t statueId;  // 0..MAX_STATUES-1
+  uint8_t songIndex; // Index into the active playlist
+  uint8_t reserved;
+  uint64_t anchorEpochMs; // sharedClockMs() at the song's byte 0
+  uint16_t seq;           // Wraps; lets consumers detect loss
+};
+
+static EthernetUDP syncUdp;
+static bool syncUp = false;
+static uint16_t txSeq = 0;
+
+// The cue this leader is broadcasting (valid while anchored).
+static bool anchored = false;
+static unsigned int anchorSongIndex = 0;
+static uint64_t anchorMs = 0;
+static unsigned long lastSendMs = 0;
+
+// Latest cue heard from a lower-indexed statue.
+static bool cueHeard = false;
+static uint8_t cueLeaderId = 0;
+static unsigned int cueSongIndex = 0;
+static uint64_t cueAnchorMs = 0;
+static unsigned long cueSeenMs = 0;
+
+static int32_t lastDriftMs = 0;
+
+void initMusicSync() {
+  if (!syncUdp.beginMulticast(MUSIC_SYNC_GROUP, MUSIC_SYNC_PORT)) {
+    Serial.println("MusicSync: multicast join failed");
+    return;
+  }
+  syncUp = true;
+  Serial.printf("MusicSync: joined %u.%u.%u.%u:%u as statue %d\n",
+                MUSIC_SYNC_GROUP[0], MUSIC_SYNC_GROUP[1], MUSIC_SYNC_GROUP[2],
+                MUSIC_SYNC_GROUP[3], MUSIC_SYNC_PORT, MY_STATUE_INDEX);
+}
+
+bool musicSyncIsLeader() {
+  // The consensus view (raw detection plus peer claims) so both ends of
+  // an asymmetric link agree on who leads.
+  uint8_t mask = latestLinkedMask | peerLinkClaimedMask();
+  if (mask == 0) {
+    return false; // Not linked: no ensemble, no leader
+  }
+  // Leader iff no linked peer has a lower index than ours.
+  return (mask & ((1u << MY_STATUE_INDEX) - 1)) == 0;
+}
+
+static void sendCue() {
+  MusicSyncFrame frame;
+  frame.version = MUSIC_SYNC_VERSION;
+  frame.statueId = (uint8_t)MY_STATUE_INDEX;
+  frame.songIndex = (uint8_t)anchorSongIndex;
+  frame.reserved = 0;
+  frame.anchorEpochMs = anchorMs;
+  frame.seq = txSeq++;
+
+  syncUdp.beginPacket(MUSIC_SYNC_GROUP, MUSIC_SYNC_PORT);
+  syncUdp.write((const uint8_t *)&frame, sizeof(frame));
+  syncUdp.endPacket();
+  lastSendMs = millis();
+}
+
+void musicSyncAnchor(unsigned int songIndex, uint64_t anchorEpochMs) {
+  anchorSongIndex = songIndex;
+  anchorMs = anchorEpochMs;
+  anchored = true;
+  if (syncUp && musicSyncIsLeader()) {
+    sendCue(); // Followers react within one loop pass, not one beat
+  }
+}
+
+static void receiveCues() {
+  int size;
+  while ((size = syncUdp.parsePacket()) > 0) {
+    if (size != (int)sizeof(MusicSyncFrame)) {
+      continue; // Not ours; parsePacket() discards the rest
+    }
+    MusicSyncFrame frame;
+    syncUdp.read((uint8_t *)&frame, sizeof(frame));
+    if (frame.version != MUSIC_SYNC_VERSION ||
+        frame.statueId >= (uint8_t)MY_STATUE_INDEX) {
+      continue; // Bad frame, our own echo, or a higher-indexed statue
+    }
+    if (!cueHeard || frame.songIndex != cueSongIndex ||
+        frame.anchorEpochMs != cueAnchorMs) {
+      Serial.printf("MusicSync: cue from %s, song %u\n",
+                    STATUE_NAMES_LC[frame.statueId], frame.songIndex);
+    }
+    cueHeard = true;
+    cueLeaderId = frame.statueId;
+    cueSongIndex = frame.songIndex;
+    cueAnchorMs = frame.anchorEpochMs;
+    cueSeenMs = millis();
+  }
+}
+
+void musicSyncLoop() {
+  if (!syncUp) {
+    return;
+  }
+  receiveCues();
+
+  // Leader heartbeat: rebroadcast the anchor so a statue that joins the
+  // chain mid-song (or missed a frame) still converges within a beat.
+  if (anchored && musicSyncIsLeader() && musicPlaying() &&
+      netClockSynced() &&
+      millis() - lastSendMs >= MUSIC_SYNC_PERIOD_MS) {
+    sendCue();
+  }
+}
+
+bool musicSyncCue(unsigned int *songIndex, uint64_t *anchorEpochMs) {
+  if (!syncUp || !cueHeard || !netClockSynced() || musicSyncIsLeader()) {
+    return false;
+  }
+  // Only follow a leader we are actually linked to, and only while the
+  // cue is fresh (a silent leader means the ensemble broke up).
+  if (((latestLinkedMask | peerLinkClaimedMask()) & (1u << cueLeaderId)) == 0 ||
+      millis() - cueSeenMs > MUSIC_SYNC_STALE_MS) {
+    return false;
+  }
+  *songIndex = cueSongIndex;
+  *anchorEpochMs = cueAnchorMs;
+  return true;
+}
+
+void musicSyncReportDrift(int32_t driftMs) { lastDriftMs = driftMs; }
+
+int32_t musicSyncDriftMs() { return lastDriftMs; }
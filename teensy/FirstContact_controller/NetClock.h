@@ -0,0 +1,24 @@
+/*
+NetClock: SNTP-disciplined shared clock for cross-statue correlation.
+*/
+
+#ifndef NET_CLOCK_H
+#define NET_CLOCK_H
+
+#include <Arduino.h>
+
+// Start the SNTP exchange against the Pi. Call once the network is up.
+void initNetClock();
+
+// Step the sync state machine; call from loop() while the network is
+// ready. Resyncs every 64 s.
+void netClockLoop();
+
+// True once at least one SNTP response has disciplined the clock.
+bool netClockSynced();
+
+// Shared wall-clock time in milliseconds since the Unix epoch, or 0 when
+// not yet synced. Millisecond-accurate across statues on the event LAN.
+uint64_t sharedClockMs();
+
+#endif // NET_CLOCK_H
@@ -0,0 +1,112 @@
+/*
+  NetClock: SNTP-disciplined shared clock.
+
+  Contact events used to carry no timestamp - they arrived at the Pi in
+  broker order, and when two statues disagreed about a link there was no
+  way to reconstruct who saw what first. Each statue now disciplines a
+  millisecond clock against the Pi (192.168.4.1, which already serves the
+  whole 192.168.4.x subnet), and publishState() stamps every contact
+  event with it, enabling end-to-end latency accounting and conflict
+  resolution in the controller.
+
+  lwIP's SNTP app is not part of the vendored QNEthernet build, so the
+  48-byte SNTP v4 exchange is hand-rolled over UDP in the same spirit as
+  the DNS PTR machinery in Networking.ino. The server transmit timestamp
+  plus half the measured round trip estimates "now"; after the first sync
+  the offset is slewed halfway toward each new estimate so one delayed
+  packet cannot yank the clock.
+*/
+
+#include "NetClock.h"
+#include "Networking.h"
+
+#define NTP_PORT 123
+#define NTP_LOCAL_PORT 8123
+#define NTP_SYNC_PERIOD_MS 64000
+#define NTP_RETRY_MS 3000
+// Seconds between the NTP epoch (1900) and the Unix epoch (1970).
+#define NTP_UNIX_OFFSET 2208988800UL
+
+static EthernetUDP ntpUdp;
+static bool ntpStarted = false;
+static bool ntpSynced = false;
+static bool ntpPending = false;
+static unsigned long ntpSentAtMs = 0;
+static int64_t clockOffsetMs = 0; // sharedClockMs() - millis()
+
+static void sendNtpRequest() {
+  uint8_t pkt[48] = {0};
+  pkt[0] = 0x23; // LI=0, VN=4, Mode=3 (client)
+  ntpUdp.beginPacket(getServer(), NTP_PORT);
+  ntpUdp.write(pkt, sizeof(pkt));
+  ntpUdp.endPacket();
+  ntpPending = true;
+  ntpSentAtMs = millis();
+}
+
+static void handleNtpResponse() {
+  uint8_t pkt[48];
+  int len = ntpUdp.read(pkt, sizeof(pkt));
+  if (len < 48 || (pkt[0] & 0x07) != 4) {
+    return; // Short packet or not a server reply
+  }
+  unsigned long now = millis();
+  uint32_t rttMs = now - ntpSentAtMs;
+
+  // Transmit timestamp: seconds + 32-bit fraction, NTP epoch.
+  uint32_t secs = ((uint32_t)pkt[40] << 24) | ((uint32_t)pkt[41] << 16) |
+                  ((uint32_t)pkt[42] << 8) | pkt[43];
+  uint32_t frac = ((uint32_t)pkt[44] << 24) | ((uint32_t)pkt[45] << 16) |
+                  ((uint32_t)pkt[46] << 8) | pkt[47];
+  if (secs == 0) {
+    return; // Server not synced yet
+  }
+  uint64_t serverMs = (uint64_t)(secs - NTP_UNIX_OFFSET) * 1000ULL +
+                      (((uint64_t)frac * 1000ULL) >> 32);
+  uint64_t estNowMs = serverMs + rttMs / 2;
+  int64_t newOffset = (int64_t)estNowMs - (int64_t)now;
+
+  if (ntpSynced) {
+    int32_t driftMs = (int32_t)(newOffset - clockOffsetMs);
+    clockOffsetMs += driftMs / 2;
+    if (driftMs > 5 || driftMs < -5) {
+      Serial.printf("NetClock: drift %ld ms (rtt %lu ms)\n", (long)driftMs,
+                    (unsigned long)rttMs);
+    }
+  } else {
+    clockOffsetMs = newOffset;
+    ntpSynced = true;
+    Serial.printf("NetClock: synced (rtt %lu ms)\n", (unsigned long)rttMs);
+  }
+  ntpPending = false;
+}
+
+void initNetClock() {
+  ntpUdp.begin(NTP_LOCAL_PORT);
+  ntpStarted = true;
+  sendNtpRequest();
+}
+
+void netClockLoop() {
+  if (!ntpStarted) {
+    return;
+  }
+  if (ntpPending) {
+    if (ntpUdp.parsePacket() > 0) {
+      handleNtpResponse();
+    } else if (millis() - ntpSentAtMs > NTP_RETRY_MS) {
+      sendNtpRequest(); // Lost in transit; ask again
+    }
+  } else if (millis() - ntpSentAtMs >= NTP_SYNC_PERIOD_MS) {
+    sendNtpRequest();
+  }
+}
+
+bool netClockSynced() { return ntpSynced; }
+
+uint64_t sharedClockMs() {
+  if (!ntpSynced) {
+    return 0;
+  }
+  return (uint64_t)((int64_t)millis() + clockOffsetMs);
+}
@@ -14,17 +14,50 @@ using namespace qindesign::network;
 
 // Network-related helper functions
 void initEthernet();
-String reverseDnsLookup(IPAddress ip);
-char *stringToCharArray(String str);
-int buildDnsPtrQuery(byte *buffer, int buflen, const String &reverseName);
-String parsePtrResponse(byte *buffer, int buflen, int queryLength);
+// Step the network bring-up state machine (DHCP -> hostname -> MQTT);
+// call from loop(). Non-blocking.
+void netSupervisorLoop();
+// True once bring-up has finished and MQTT has been initialized.
+bool networkReady();
+// Step the background reverse DNS lookup; call from loop(). No-op once
+// the cached hostname has been confirmed, corrected, or given up on.
+void pollReverseDns();
+int buildDnsPtrQuery(byte *buffer, int buflen, const char *reverseName);
 
-// Replace printLocalIp declaration with getLocalIp
-String getLocalIp();
+// Fill `buf` with the dotted-quad local IP (no heap).
+void getLocalIp(char *buf, size_t buflen);
 
 // Networking accessors for Messaging.ino
 IPAddress getServer();
+
+// Broker failover list (see BROKER_CANDIDATES in Networking.ino).
+// getServer() always reports the active candidate.
+int brokerCandidateCount();
+IPAddress brokerCandidate(int index);
+int activeBrokerIndex();
+void setActiveBroker(int index);
 char* getHostname();
 EthernetClient& getEthClient();
+EthernetUDP& getUdp();
+
+// Apply TCP_NODELAY to the MQTT socket and log the effective socket
+// settings. Call after each (re)connect; no-op while disconnected.
+void tuneMqttSocket();
+
+// Fill `json` with the lwIP/link health counters (see Networking.ino).
+// Returns false when stats are compiled out or the buffer is too small.
+bool networkStatsCollect(char *json, size_t jsonLen);
+void networkStatsBrief(char *out, size_t outLen);
+
+// Raw lwIP counter sample for the telemetry superframe. Returns false
+// when stats are compiled out; rexmit is 0 without TCP_STATS.
+bool networkCountersSample(uint32_t *rx, uint32_t *tx, uint32_t *drop,
+                           uint32_t *rexmit);
+
+// Ethernet driver (MAC/DMA-level) counter sample: ISR invocations, frames
+// dropped below lwIP, TX descriptor stalls, and the RX ring high-water
+// mark. Lifetime totals except the high-water mark, which is a maximum.
+void enetDriverStatsSample(uint32_t *irqs, uint32_t *rxDropped,
+                           uint32_t *txStalls, uint32_t *ringHighWater);
 
 #endif // NETWORKING_H
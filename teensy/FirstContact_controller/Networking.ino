@@ -2,14 +2,27 @@
 Networking: The ethernet, DNS, and MQTT WLED messaging logic.
 */
 
+#include "ConfigStore.h"
+#include "FixedString.h"
+#include "JsonWriter.h"
 #include "Networking.h"
+#include "PeerLink.h"
+#include "ScratchArena.h"
+#include "StatueConfig.h"
 #include "defines.h"
 
+#include "lwip/memp.h"
+#include "lwip/stats.h"
+#include "qnethernet/lwip_driver.h"
+
 //using namespace qindesign::network;
 
 // --- UDP and DNS Setup ---
 EthernetUDP udp;
 const unsigned int DNS_PORT = 53;
+// Classic UDP DNS message ceiling; the PTR query and response scratch
+// allocations both use it.
+#define DNS_PACKET_MAX 512
 
 byte mac[] = {0x92, 0xAD, 0xBE, 0xEF, 0xFE, 0xED};
 #if !(USING_DHCP)
@@ -17,41 +30,47 @@ IPAddress NETWORK_IP(192, 168, 1, 48);
 IPAddress NETWORK_MASK(255, 255, 255, 0);
 IPAddress NETWORK_GATEWAY(192, 168, 1, 20);
 IPAddress NETWORK_DNS(192, 168, 1, 20);
-IPAddress UDP_LOG_PC_IP(192, 168, 1, 50);
 #endif
-IPAddress server(192, 168, 4, 1); // MQTT Broker (Raspberry PI)
-
-char *hostname = 0; // Filled by reverse DNS lookup
+// Default target for the UDP log sink (Log.cpp); the enable command on
+// missing_link/log/udp can point it anywhere, so this just names the
+// usual monitoring laptop.
+IPAddress UDP_LOG_PC_IP(192, 168, 1, 50);
+/*
+  MQTT broker candidates, in preference order. The address used to be a
+  single hardcoded IP; when the primary Pi died mid-event, every statue
+  sat in its reconnect loop until reflashed. The supervisor in
+  Messaging.ino walks this list after repeated failures and probes the
+  primary in the background for fail-back; getServer() always reports
+  the active entry, so NTP, OTA, and song sync follow the failover.
+*/
+IPAddress BROKER_CANDIDATES[] = {
+    IPAddress(192, 168, 4, 1), // Primary Pi
+    IPAddress(192, 168, 4, 2), // Backup Pi (cold spare, same services)
+    IPAddress(192, 168, 4, 9), // Show laptop running mosquitto
+};
+const int BROKER_CANDIDATE_COUNT =
+    (int)(sizeof(BROKER_CANDIDATES) / sizeof(BROKER_CANDIDATES[0]));
+static int activeBrokerIdx = 0;
+
+// The adopted identity. Points into hostnameStorage once set; nothing is
+// heap-allocated (the old stringToCharArray() helper is gone).
+static char hostnameStorage[HOSTNAME_CACHE_MAX];
+char *hostname = 0;
 EthernetClient ethClient;
 
 // --- DNS Helper Functions ---
 
-/*
-stringToCharArray(String str):
-
-Explanation and Important Considerations:
-  - Takes an Arduino String and returns a dynamically allocated char array.
-  - Caller must eventually delete[] the returned pointer.
-*/
-char *stringToCharArray(String str) {
-  if (str.length() == 0) {
-    return nullptr;
-  }
-  char *charArray = new char[str.length() + 1];
-  if (charArray == nullptr) {
-    return nullptr;
-  }
-  str.toCharArray(charArray, str.length() + 1);
-  return charArray;
+static void setHostname(const char *name) {
+  strlcpy(hostnameStorage, name, sizeof(hostnameStorage));
+  hostname = hostnameStorage;
 }
 
 /*
   DNS Server declaration: now declared without initialization.
 */
 IPAddress dnsServer;
-byte responseBuffer[512];
 
-int buildDnsPtrQuery(byte *buffer, int buflen, const String &reverseName) {
+int buildDnsPtrQuery(byte *buffer, int buflen, const char *reverseName) {
   uint16_t id = random(0, 65535);
   buffer[0] = (id >> 8) & 0xFF;
   buffer[1] = id & 0xFF;
@@ -61,23 +80,20 @@ int buildDnsPtrQuery(byte *buffer, int buflen, const String &reverseName) {
   buffer[5] = 0x01; // QDCOUNT = 1
   for (int i = 6; i < 12; i++)
     buffer[i] = 0;
-  int pos = 12, start = 0;
-  while (true) {
-    int dotIndex = reverseName.indexOf('.', start);
-    String label;
-    if (dotIndex == -1) {
-      label = reverseName.substring(start);
-    } else {
-      label = reverseName.substring(start, dotIndex);
-    }
-    int labelLen = label.length();
+  // Encode each dot-separated label in place: length byte, then the
+  // label characters (no substring temporaries).
+  int pos = 12;
+  const char *label = reverseName;
+  while (*label) {
+    const char *dot = strchr(label, '.');
+    int labelLen = dot ? (int)(dot - label) : (int)strlen(label);
     buffer[pos++] = labelLen;
     for (int i = 0; i < labelLen; i++) {
-      buffer[pos++] = label.charAt(i);
+      buffer[pos++] = label[i];
     }
-    if (dotIndex == -1)
+    if (!dot)
       break;
-    start = dotIndex + 1;
+    label = dot + 1;
   }
   buffer[pos++] = 0x00; // Terminate QNAME
   buffer[pos++] = 0x00;
@@ -87,8 +103,12 @@ int buildDnsPtrQuery(byte *buffer, int buflen, const String &reverseName) {
   return pos;
 }
 
-String parsePtrResponse(byte *buffer, int buflen, int queryLength) {
-  String result = "";
+// Decode the PTR answer name into `out` (empty on no answer or
+// truncation). The incremental `result += char` String build this
+// replaces reallocated on nearly every appended character.
+bool parsePtrResponse(byte *buffer, int buflen, int queryLength,
+                      FixedString<HOSTNAME_CACHE_MAX> &out) {
+  out.clear();
   int offset = queryLength + 12; // Skip header and query
   while (offset < buflen) {
     if ((buffer[offset] & 0xC0) == 0xC0) {
@@ -100,11 +120,11 @@ String parsePtrResponse(byte *buffer, int buflen, int queryLength) {
         if (length == 0)
           break;
         for (int i = 1; i <= length; i++) {
-          result += (char)buffer[tempOffset + i];
+          out.append((char)buffer[tempOffset + i]);
         }
         tempOffset += length + 1;
         if (buffer[tempOffset] != 0) {
-          result += ".";
+          out.append('.');
         }
       }
       break;
@@ -113,68 +133,253 @@ String parsePtrResponse(byte *buffer, int buflen, int queryLength) {
       if (length == 0)
         break;
       for (int i = 1; i <= length; i++) {
-        result += (char)buffer[offset + i];
+        out.append((char)buffer[offset + i]);
       }
       offset += length + 1;
       if (buffer[offset] != 0 && (buffer[offset] & 0xC0) != 0xC0)
-        result += ".";
+        out.append('.');
     }
   }
-  return result;
+  if (!out.ok()) {
+    out.clear(); // A truncated hostname is worse than none
+  }
+  return !out.empty();
 }
 
-String reverseDnsLookup(IPAddress ip) {
-  String reverseName = String(ip[3]) + "." + String(ip[2]) + "." +
-                       String(ip[1]) + "." + String(ip[0]) + ".in-addr.arpa";
-  byte queryBuffer[512];
-  int queryLength =
-      buildDnsPtrQuery(queryBuffer, sizeof(queryBuffer), reverseName);
+/*
+  Asynchronous reverse DNS. The old reverseDnsLookup() busy-waited up to
+  2000 ms for the PTR response on the critical boot path, and a missed
+  response returned the literal "Timeout" which then broke statue
+  identification. The lookup is now fire-and-poll with retry: boot
+  proceeds immediately with the hostname cached in EEPROM (see
+  ConfigStore.h), and pollReverseDns() - stepped from loop() - confirms
+  or corrects the cached identity. Only a first boot with an empty cache
+  still waits for the answer.
+
+  The result is held as a cache entry, not forever: re-resolution
+  repeats when the answer's TTL expires (clamped below), so a dnsmasq
+  rebuild that reassigns names converges without a manual reboot. A
+  changed answer must repeat on the next round before it is adopted -
+  one flaky response must not re-identify a statue - and adoption is a
+  deliberate reset once the statue is idle, since the MQTT topic
+  registry, the retained will, and the detector tables are all built
+  from the identity at boot.
+*/
+#define PTR_RETRY_MS 2000
+#define PTR_MAX_ATTEMPTS 5
+
+// TTL clamp: a 0-TTL answer must not busy-loop queries, and a huge TTL
+// must not pin a stale identity for days. 0 next-due means "no
+// re-resolution scheduled yet".
+#define PTR_TTL_MIN_S 60
+#define PTR_TTL_MAX_S 3600
+#define PTR_TTL_DEFAULT_S 600
+
+static char cachedHostname[HOSTNAME_CACHE_MAX];
+static int ptrQueryLength = 0;
+static bool ptrPending = false; // A query is outstanding
+static bool ptrSettled = false; // This round confirmed, corrected, or gave up
+static unsigned long ptrSentAt = 0;
+static uint8_t ptrAttempts = 0;
+static unsigned long ptrNextDueMs = 0; // TTL-driven re-resolution deadline
+static uint8_t ptrChangeStreak = 0;    // Consecutive rounds with a new name
+static bool identityRebootPending = false;
+
+static void sendPtrQuery() {
+  IPAddress ip = Ethernet.localIP();
+  FixedString<32> reverseName;
+  reverseName.appendFormat("%u.%u.%u.%u.in-addr.arpa", ip[3], ip[2], ip[1],
+                           ip[0]);
+  // The query packet only lives until endPacket(); build it in scratch
+  // instead of burning 512 bytes of this call chain's stack.
+  ScratchFrame frame;
+  byte *queryBuffer = (byte *)scratchAlloc(DNS_PACKET_MAX);
+  if (queryBuffer == NULL) {
+    return;
+  }
+  ptrQueryLength =
+      buildDnsPtrQuery(queryBuffer, DNS_PACKET_MAX, reverseName.c_str());
   dnsServer = Ethernet.dnsServerIP();
   udp.beginPacket(dnsServer, DNS_PORT);
-  udp.write(queryBuffer, queryLength);
+  udp.write(queryBuffer, ptrQueryLength);
   udp.endPacket();
-  unsigned long startTime = millis();
-  while (millis() - startTime < 2000) {
+  ptrPending = true;
+  ptrSentAt = millis();
+  ptrAttempts++;
+}
+
+// TTL of the first answer record, for the re-resolution schedule. The
+// +12 skip in parsePtrResponse assumes a 2-byte compressed owner name;
+// under the same assumption the 4-byte TTL sits at answer offset 6.
+static uint32_t parsePtrAnswerTtl(const byte *buffer, int buflen,
+                                  int queryLength) {
+  int off = queryLength + 6;
+  if (off + 4 > buflen) {
+    return 0;
+  }
+  return ((uint32_t)buffer[off] << 24) | ((uint32_t)buffer[off + 1] << 16) |
+         ((uint32_t)buffer[off + 2] << 8) | (uint32_t)buffer[off + 3];
+}
+
+// Close a resolution round and schedule the next one per the TTL.
+static void scheduleNextResolution(uint32_t ttlS) {
+  if (ttlS < PTR_TTL_MIN_S) {
+    ttlS = (ttlS == 0) ? PTR_TTL_DEFAULT_S : PTR_TTL_MIN_S;
+  }
+  if (ttlS > PTR_TTL_MAX_S) {
+    ttlS = PTR_TTL_MAX_S;
+  }
+  ptrPending = false;
+  ptrSettled = true;
+  ptrNextDueMs = millis() + ttlS * 1000UL;
+}
+
+// Apply a PTR answer: adopt it when we have no identity yet, otherwise
+// confirm the cached identity or - after the change repeats on the next
+// round - correct the cache and schedule the identity reboot.
+static void handlePtrAnswer(const char *name, uint32_t ttlS) {
+  scheduleNextResolution(ttlS);
+  if (hostname == 0) {
+    setHostname(name);
+    hostnameCacheSave(hostname);
+    return;
+  }
+  if (strcmp(name, hostname) != 0) {
+    ptrChangeStreak++;
+    if (ptrChangeStreak < 2) {
+      Serial.printf("Reverse DNS says '%s' but identity is '%s'; waiting "
+                    "for the next round to confirm\n",
+                    name, hostname);
+      return;
+    }
+    Serial.printf("Reverse DNS says '%s' twice; cache updated, rebooting "
+                  "to adopt once idle\n",
+                  name);
+    hostnameCacheSave(name);
+    identityRebootPending = true;
+  } else {
+    ptrChangeStreak = 0;
+    Serial.printf("Reverse DNS confirmed hostname '%s'\n", hostname);
+  }
+}
+
+void pollReverseDns() {
+  // A confirmed identity change reboots into the corrected cache - the
+  // topic registry, will, and detector tables all rebuild from it - but
+  // never mid-interaction.
+  if (identityRebootPending) {
+    extern volatile StatueMask latestLinkedMask; // AudioSense.ino
+    if (latestLinkedMask == 0) {
+      Serial.println("Adopting new identity: resetting");
+      Serial.flush();
+      SCB_AIRCR = 0x05FA0004; // System reset
+    }
+    return;
+  }
+  if (ptrSettled) {
+    // Idle until the TTL runs out, then open a fresh round.
+    if (ptrNextDueMs == 0 || (long)(millis() - ptrNextDueMs) < 0) {
+      return;
+    }
+    ptrSettled = false;
+    ptrAttempts = 0;
+    sendPtrQuery();
+    return;
+  }
+  if (ptrPending) {
     int packetSize = udp.parsePacket();
-    if (packetSize > 0) {
-      int len = udp.read(responseBuffer, sizeof(responseBuffer));
-      String hostname = parsePtrResponse(responseBuffer, len, queryLength);
-      return hostname;
+    if (packetSize > 0 && udp.remotePort() == DNS_PORT) {
+      // The response only matters inside this block; scratch instead of
+      // the file-scope static that used to park 512 bytes forever.
+      ScratchFrame frame;
+      byte *responseBuffer = (byte *)scratchAlloc(DNS_PACKET_MAX);
+      if (responseBuffer == NULL) {
+        return;
+      }
+      int len = udp.read(responseBuffer, DNS_PACKET_MAX);
+      FixedString<HOSTNAME_CACHE_MAX> name;
+      if (parsePtrResponse(responseBuffer, len, ptrQueryLength, name)) {
+        handlePtrAnswer(name.c_str(),
+                        parsePtrAnswerTtl(responseBuffer, len, ptrQueryLength));
+        return;
+      }
+    }
+  }
+  if (millis() - ptrSentAt >= PTR_RETRY_MS) {
+    if (ptrAttempts >= PTR_MAX_ATTEMPTS) {
+      Serial.println("Reverse DNS gave up; keeping cached identity");
+      scheduleNextResolution(PTR_TTL_DEFAULT_S);
+      return;
     }
+    sendPtrQuery();
   }
-  return String("Timeout");
 }
 
 // --- Ethernet Setup ---
 
+/*
+  Connection supervisor. initEthernet() used to block setup() behind a
+  `goto networkErrorRetry` loop with waitForLocalIP(5000) and delay(5000),
+  so a statue powered up before the Pi sat dark and silent until DHCP
+  answered. Bring-up is now a non-blocking state machine: initEthernet()
+  just kicks off DHCP and registers the link-state callback, and
+  netSupervisorLoop() - stepped from loop() - walks LINK_DOWN ->
+  DHCP_WAIT -> HOSTNAME -> START_SERVICES -> READY while contact sensing
+  and standalone music run from the first loop() pass. initMqtt() runs
+  once the hostname is known, since the topic registry needs the statue
+  identity.
+*/
+enum NetState {
+  NET_LINK_DOWN,      // No cable / link not up yet
+  NET_DHCP_WAIT,      // Link up, waiting for a DHCP address
+  NET_HOSTNAME,       // Address up, resolving identity (first boot only)
+  NET_START_SERVICES, // One-shot: MQTT init and display refresh
+  NET_READY,          // Steady state; MQTT reconnect handles outages
+};
+static NetState netState = NET_LINK_DOWN;
+static bool mqttInitialized = false;
+
+// Cached-lease bring-up (see leaseCacheLoad in ConfigStore.h): true while
+// running on the EEPROM lease before the broker has confirmed it works.
+#define LEASE_VALIDATE_MS 15000
+static bool usingCachedLease = false;
+static unsigned long readyAtMs = 0;
+
+// Cable events since boot, for the network health frame below.
+static uint32_t linkFlaps = 0;
+
+bool networkReady() { return netState == NET_READY; }
+
 void initEthernet() {
-networkErrorRetry: // Entry point if we fail to initialize network
-
-  bool networkError = false;
-
-#if USE_QN_ETHERNET
-  Serial.println(F("=========== USE_QN_ETHERNET ==========="));
-// Alternate TCP/IP stacks will not be supported with my code
-#elif USE_NATIVE_ETHERNET
-#error
-  Serial.println(F("======== USE_NATIVE_ETHERNET ========"));
-#elif USE_ETHERNET_GENERIC
-#error
-  Serial.println(F("======== USE_ETHERNET_GENERIC ========"));
-#else
-#error
-  Serial.println(F("========= NO NETWORK TYPE DEFINED =========="));
-#endif
+  // Log cable events as they happen; the state machine below reacts on
+  // its next pass.
+  Ethernet.onLinkState([](bool state) {
+    Serial.printf("Ethernet link %s\n", state ? "UP" : "DOWN");
+    if (!state) {
+      linkFlaps++;
+      displayNetworkStatus("CHECK ETHERNET CABLE");
+    }
+  });
 
 #if USING_DHCP
-
-  // Start the Ethernet connection, using DHCP
-  Serial.print("Initialize Ethernet using DHCP => ");
-  displayNetworkStatus("DHCP Waiting...");
-
-  Ethernet.begin();
-  // give the Ethernet shield minimum 1 sec for DHCP and 2 secs for staticP to initialize:
-  // delay(1000);  XXX 3
+  IPAddress leaseIp, leaseMask, leaseGw, leaseDns;
+  if (leaseCacheLoad(leaseIp, leaseMask, leaseGw, leaseDns)) {
+    // Bring the interface up on the previous lease in milliseconds -
+    // dnsmasq hands out the same static assignment every time, so this is
+    // almost always right, and it matters when a statue brownouts
+    // mid-event. NET_READY falls back to a real DHCP exchange if the
+    // broker never answers on the cached addresses.
+    Serial.print("Initialize Ethernet using cached lease => ");
+    Serial.println(leaseIp);
+    displayNetworkStatus("Cached lease...");
+    Ethernet.begin(leaseIp, leaseMask, leaseGw, leaseDns);
+    usingCachedLease = true;
+  } else {
+    // Start the Ethernet connection, using DHCP
+    Serial.println("Initialize Ethernet using DHCP => ");
+    displayNetworkStatus("DHCP Waiting...");
+    Ethernet.begin();
+  }
 #else
   // Start the Ethernet connection, using static IP
   Serial.print("Initialize Ethernet using STATIC IP => ");
@@ -185,70 +390,273 @@ networkErrorRetry: // Entry point if we fail to initialize network
   Ethernet.begin(NETWORK_IP, NETWORK_MASK, NETWORK_GATEWAY, NETWORK_DNS);
 #endif
 
-  if (!Ethernet.waitForLocalIP(5000)) {
-    networkError = true;
-
-    Serial.println("Failed to configure Ethernet");
-    displayNetworkStatus("** Network Failed **");
+  netState = NET_DHCP_WAIT;
+}
 
-    if (!Ethernet.linkStatus()) {
-      displayNetworkStatus("CHECK ETHERNET CABLE");
-      Serial.println("Ethernet cable is not connected.");
-      delay(5000);
+void netSupervisorLoop() {
+  switch (netState) {
+  case NET_LINK_DOWN:
+    if (Ethernet.linkState()) {
+      netState = NET_DHCP_WAIT;
     }
-  } else {
-    networkError = false;
+    break;
 
+  case NET_DHCP_WAIT: {
     IPAddress ipAddress = Ethernet.localIP();
-
+    if (ipAddress == IPAddress((uint32_t)0)) {
+      break; // Still waiting; DHCP retries internally
+    }
     char ipString[128];
     sprintf(ipString, "%d.%d.%d.%d", ipAddress[0], ipAddress[1], ipAddress[2],
             ipAddress[3]);
-
     displayNetworkStatus(ipString);
-
     Serial.print("IP Address = ");
-    Serial.println(Ethernet.localIP());
+    Serial.println(ipAddress);
+
+#if USING_DHCP
+    // A real DHCP exchange just completed: remember the lease so the next
+    // boot skips the wait entirely.
+    if (!usingCachedLease) {
+      leaseCacheSave(ipAddress, Ethernet.subnetMask(), Ethernet.gatewayIP(),
+                     Ethernet.dnsServerIP());
+    }
+#endif
+
+    // Start UDP on a specific local port (use any free port, here 12345)
+    Serial.println(F("======== Begin UDP ============"));
+    udp.begin(12345);
+
+    Serial.println(F("======== Reverse DNS Lookup ============"));
+    if (hostnameCacheLoad(cachedHostname, sizeof(cachedHostname))) {
+      // Boot with the cached identity right away; the lookup keeps
+      // running in the background and only updates the cache.
+      hostname = cachedHostname;
+      sendPtrQuery();
+      netState = NET_START_SERVICES;
+    } else {
+      // First boot with an empty cache: statue identification needs the
+      // hostname before MQTT can start.
+      sendPtrQuery();
+      netState = NET_HOSTNAME;
+    }
+    break;
   }
 
-  if (networkError == true)
-    goto networkErrorRetry;
+  case NET_HOSTNAME:
+    pollReverseDns();
+    if (ptrSettled) {
+      if (hostname == 0) {
+        Serial.println("WARNING: reverse DNS failed; using 'unknown'");
+        setHostname("unknown");
+      }
+      netState = NET_START_SERVICES;
+    }
+    break;
+
+  case NET_START_SERVICES:
+    Serial.printf("Hostname:");
+    Serial.println(hostname);
+
+    if (!mqttInitialized) {
+      Serial.printf("_______Init MQTT Publisher_______\n");
+      initMqtt();
+      mqttInitialized = true;
+
+      // audioSenseSetup() ran with the default identity while the network
+      // converged; retune now that config has loaded.
+      retuneAudioSense();
+
+      // Statue-to-statue link channel (needs the identity for its frames).
+      initPeerLink();
+
+      // Shared clock for cross-statue event correlation.
+      initNetClock();
+
+      // Firmware upload listener (accepts from the Pi only).
+      initOta();
+
+      // Song upload listener (also Pi-only).
+      initSongSync();
+
+      // Ensemble playback cue channel (statue-to-statue).
+      initMusicSync();
+
+      // Announce ourselves over mDNS so bench setups without the Pi (and
+      // its dnsmasq) can still reach the statue at <hostname>.local, and
+      // advertise the peer-link channel for discovery tools. QNEthernet's
+      // MDNS only announces - it cannot browse - so the broker address
+      // stays configured and first-boot identity still comes from the
+      // PTR lookup above.
+      if (MDNS.begin(hostname)) {
+        MDNS.addService("_missing-link", "_udp", PEER_LINK_PORT);
+        Serial.printf("mDNS: announcing %s.local\n", hostname);
+      } else {
+        Serial.println("mDNS: announce failed");
+      }
+    }
 
-  // DNS Port
-  // Start UDP on a specific local port (use any free port, here 12345)
-  Serial.println(F("======== Begin UDP ============"));
+    // Refresh the display with the resolved identity.
+    displayUpdateStatueInfo(hostname);
+    displayFrequencies();
+    displayThresholds();
+    readyAtMs = millis();
+    netState = NET_READY;
+    break;
+
+  case NET_READY:
+    // Cable pulls and broker outages are handled by MQTT's reconnect
+    // backoff; DHCP renewal is internal to QNEthernet.
+    if (usingCachedLease) {
+      if (client.connected()) {
+        // The broker answered on the cached addresses: the lease holds.
+        Serial.println("Cached lease validated (broker reachable)");
+        usingCachedLease = false;
+      } else if (millis() - readyAtMs > LEASE_VALIDATE_MS) {
+        // The Pi never answered - the cached lease has gone stale (e.g.
+        // the subnet changed). Do the real DHCP exchange after all; the
+        // fresh lease is cached when NET_DHCP_WAIT sees it.
+        Serial.println("Cached lease looks stale; falling back to DHCP");
+        usingCachedLease = false;
+        displayNetworkStatus("DHCP Waiting...");
+        Ethernet.begin();
+        netState = NET_DHCP_WAIT;
+      }
+    }
+    break;
+  }
+}
 
-  udp.begin(12345);
+void getLocalIp(char *buf, size_t buflen) {
+  IPAddress ip = Ethernet.localIP();
+  snprintf(buf, buflen, "%u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+}
 
-  Serial.println(F("======== Reverse DNS Lookup ============"));
+// Networking accessors for Messaging.ino
+IPAddress getServer() { return BROKER_CANDIDATES[activeBrokerIdx]; }
 
-  String Hostname = reverseDnsLookup(Ethernet.localIP());
+int brokerCandidateCount() { return BROKER_CANDIDATE_COUNT; }
 
-  Serial.printf("Hostname:");
-  Serial.print(Hostname);
+IPAddress brokerCandidate(int index) { return BROKER_CANDIDATES[index]; }
 
-  hostname = stringToCharArray(Hostname);
+int activeBrokerIndex() { return activeBrokerIdx; }
 
-  //displayHostname(hostname);
+void setActiveBroker(int index) {
+  if (index < 0 || index >= BROKER_CANDIDATE_COUNT ||
+      index == activeBrokerIdx) {
+    return;
+  }
+  activeBrokerIdx = index;
+  IPAddress ip = BROKER_CANDIDATES[index];
+  Serial.printf("Broker: switching to candidate %d (%u.%u.%u.%u)\n", index,
+                ip[0], ip[1], ip[2], ip[3]);
+}
 
-  // Display TX/RX frequencies on line 2
-  displayFrequencies();
+char *getHostname() { return hostname; }
+
+EthernetClient &getEthClient() { return ethClient; }
 
-  /* The data was allocated, but we will not delete it since we may need to print again */
-  /* Remove this commment to delete the allocated string *
-  delete[] hostname;
-  */
+/*
+  Socket tuning for the MQTT connection. A link event rides a single small
+  TCP segment, and with Nagle enabled its interaction with the broker's
+  delayed ACKs can hold that segment back 40-200 ms - catastrophic for
+  touch-to-light latency. Called after each (re)connect so the settings
+  apply to the fresh socket, and the effective values are logged so a
+  production capture can verify them. Buffer sizes are compile-time lwIP
+  options (see QNEthernet's lwipopts.h), logged here for the same reason.
+*/
+/*
+  Network health telemetry. When the event network gets flaky we could
+  not tell whether drops happened at the Teensy, the switch, or the Pi.
+  lwIP tracks link counters, TCP retransmits, and pbuf pool pressure
+  (LWIP_STATS, enabled in the vendored lwipopts.h); this packages them
+  with the link-flap count from the onLinkState callback so audio
+  dropouts can be correlated with network pressure in the broker logs.
+  Counters are lifetime totals - the Pi graphs the deltas.
+*/
+bool networkStatsCollect(char *json, size_t jsonLen) {
+#if LWIP_STATS
+  JsonWriter out(json, jsonLen);
+  out.beginObject();
+  out.kv("rx", (uint32_t)lwip_stats.link.recv);
+  out.kv("tx", (uint32_t)lwip_stats.link.xmit);
+  out.kv("drop", (uint32_t)lwip_stats.link.drop);
+  out.kv("err", (uint32_t)lwip_stats.link.err);
+#if TCP_STATS
+  out.kv("rexmit", (uint32_t)lwip_stats.tcp.rexmit);
+#endif
+#if MEMP_STATS
+  out.kv("pbuf_used", (uint32_t)lwip_stats.memp[MEMP_PBUF_POOL]->used);
+  out.kv("pbuf_max", (uint32_t)lwip_stats.memp[MEMP_PBUF_POOL]->max);
+  out.kv("pbuf_err", (uint32_t)lwip_stats.memp[MEMP_PBUF_POOL]->err);
+#endif
+  // MAC/DMA-level counters from the Ethernet driver, below lwIP's view.
+  struct DriverStats ds;
+  driver_get_stats(&ds);
+  out.kv("irqs", ds.irqCount);
+  out.kv("mac_drop", ds.rxDropped);
+  out.kv("tx_stall", ds.txStalls);
+  out.kv("ring_hw", ds.rxRingHighWater);
+  out.kv("flaps", linkFlaps);
+  out.endObject();
+  return out.ok();
+#else
+  (void)json;
+  (void)jsonLen;
+  return false;
+#endif
 }
 
-String getLocalIp() {
-  IPAddress ip = Ethernet.localIP();
-  return String(ip[0]) + "." + String(ip[1]) + "." + String(ip[2]) + "." +
-         String(ip[3]);
+bool networkCountersSample(uint32_t *rx, uint32_t *tx, uint32_t *drop,
+                           uint32_t *rexmit) {
+#if LWIP_STATS
+  *rx = (uint32_t)lwip_stats.link.recv;
+  *tx = (uint32_t)lwip_stats.link.xmit;
+  *drop = (uint32_t)(lwip_stats.link.drop + lwip_stats.link.err);
+#if TCP_STATS
+  *rexmit = (uint32_t)lwip_stats.tcp.rexmit;
+#else
+  *rexmit = 0;
+#endif
+  return true;
+#else
+  (void)rx;
+  (void)tx;
+  (void)drop;
+  (void)rexmit;
+  return false;
+#endif
 }
 
-// Networking accessors for Messaging.ino
-IPAddress getServer() { return server; }
+void enetDriverStatsSample(uint32_t *irqs, uint32_t *rxDropped,
+                           uint32_t *txStalls, uint32_t *ringHighWater) {
+  struct DriverStats ds;
+  driver_get_stats(&ds);
+  *irqs = ds.irqCount;
+  *rxDropped = ds.rxDropped;
+  *txStalls = ds.txStalls;
+  *ringHighWater = ds.rxRingHighWater;
+}
 
-char *getHostname() { return hostname; }
+// One-line network health summary for the on-screen diagnostics page.
+void networkStatsBrief(char *out, size_t outLen) {
+#if LWIP_STATS
+  snprintf(out, outLen, "RX:%lu ER:%lu FL:%lu",
+           (unsigned long)lwip_stats.link.recv,
+           (unsigned long)(lwip_stats.link.drop + lwip_stats.link.err),
+           (unsigned long)linkFlaps);
+#else
+  snprintf(out, outLen, "stats off");
+#endif
+}
 
-EthernetClient &getEthClient() { return ethClient; }
+void tuneMqttSocket() {
+  if (!ethClient.connected()) {
+    return;
+  }
+  ethClient.setNoDelay(true);
+  Serial.printf("MQTT socket: TCP_NODELAY %s, send buffer %d B, window %d B\n",
+                ethClient.isNoDelay() ? "on" : "off", (int)TCP_SND_BUF,
+                (int)TCP_WND);
+}
+
+EthernetUDP &getUdp() { return udp; }
@@ -0,0 +1,30 @@
+/*
+OrphanMode: autonomous lights when the Pi controller disappears.
+
+Most of the experience already survives a dead broker: sensing, music,
+haptics, the OLED, and the peer UDP channel (including the link
+agreement rule) are all local. What cliffs is the lights - the Pi
+drives the WLED boards from missing_link/contact, so a mid-event Pi
+failure leaves every statue artistically dead while the music plays on.
+
+After a sustained broker outage (long enough for the failover scan in
+Messaging.ino to have walked the whole candidate list a few times) the
+statue goes orphan: it drives its own WLED board directly over the
+HTTP JSON API with canned active/dormant scenes keyed off the local
+link state. The moment any broker accepts a connection the statue
+stops driving lights and the Pi's orchestration takes back over - the
+next contact event reasserts whatever scene the controller wants.
+*/
+
+#ifndef ORPHAN_MODE_H
+#define ORPHAN_MODE_H
+
+#include <Arduino.h>
+
+// Supervisor + HTTP pump; call from the network task every pass.
+void orphanModeLoop();
+
+// True while the statue is driving its own lights.
+bool orphanModeActive();
+
+#endif // ORPHAN_MODE_H
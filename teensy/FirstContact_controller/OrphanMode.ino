@@ -0,0 +1,149 @@
+/*
+  OrphanMode: direct WLED drive during broker outages (see OrphanMode.h).
+
+  The WLED boards hold static DHCP reservations, so their addresses
+  survive the Pi that assigned them; each statue only ever drives its
+  own board. The HTTP POST runs as a small non-blocking state machine -
+  connectNoWait, send when the socket opens, drop without reading the
+  response - so a dead or rebooting WLED board costs a timeout, never a
+  stall. Scenes are the controller's own active/dormant looks (colors
+  per statue), resent on link-state change and refreshed every few
+  seconds in case the board power-cycled mid-outage.
+*/
+
+#include "Messaging.h"
+#include "Networking.h"
+#include "OrphanMode.h"
+#include "StatueConfig.h"
+
+// Sustained-loss threshold: two-plus full failover scans of the broker
+// candidate list with nothing answering.
+#define ORPHAN_AFTER_MS 20000
+// Scene refresh while orphaned, in case the WLED board rebooted.
+#define ORPHAN_REFRESH_MS 10000
+#define ORPHAN_HTTP_TIMEOUT_MS 500
+
+// Static DHCP reservations for the per-statue WLED boards, indexed like
+// STATUE_NAMES. Kept next to the statue identity rather than fetched
+// from config: orphan mode exists precisely for when config is gone.
+static const IPAddress WLED_ADDRS[MAX_STATUES] = {
+    IPAddress(192, 168, 4, 21), // eros
+    IPAddress(192, 168, 4, 22), // elektra
+    IPAddress(192, 168, 4, 23), // sophia
+    IPAddress(192, 168, 4, 24), // ultimo
+    IPAddress(192, 168, 4, 25), // ariel
+};
+
+// Per-statue active colors (primary, secondary, primary), matching the
+// controller's palette so the orphan look is the show look.
+static const char *const ACTIVE_COLS[MAX_STATUES] = {
+    "[255,0,100],[225,0,255],[255,0,100]", // eros
+    "[0,25,255],[0,200,255],[0,25,255]",   // elektra
+    "[255,180,0],[255,80,0],[255,180,0]",  // sophia
+    "[0,255,90],[140,255,0],[0,255,90]",   // ultimo
+    "[0,220,255],[255,255,255],[0,220,255]", // ariel
+};
+
+// Written by the sense timer ISR (see AudioSense.ino).
+extern volatile StatueMask latestLinkedMask;
+
+static bool orphaned = false;
+static unsigned long lastConnectedMs = 0;
+static bool lastSentLinked = false;
+static bool sceneSentOnce = false;
+static unsigned long lastSceneMs = 0;
+
+// HTTP pump state.
+static EthernetClient wledClient;
+static bool httpInFlight = false;
+static unsigned long httpStartMs = 0;
+static char httpBody[224];
+
+bool orphanModeActive() { return orphaned; }
+
+// Kick off one POST of the scene for the given link state. The request
+// is assembled into httpBody now and written once the socket opens.
+static void sendScene(bool linked) {
+  if (httpInFlight) {
+    return; // Previous request still draining; the refresh covers us
+  }
+  if (linked) {
+    snprintf(httpBody, sizeof(httpBody),
+             "{\"tt\":0,\"seg\":[{\"id\":0,\"on\":true,\"bri\":255,"
+             "\"col\":[%s],\"fx\":72,\"pal\":3}]}",
+             ACTIVE_COLS[MY_STATUE_INDEX]);
+  } else {
+    snprintf(httpBody, sizeof(httpBody),
+             "{\"tt\":0,\"seg\":[{\"id\":0,\"on\":true,\"bri\":255,"
+             "\"col\":[[255,255,255],[0,0,0],[0,0,0]],"
+             "\"fx\":42,\"pal\":3}]}");
+  }
+  if (!wledClient.connectNoWait(WLED_ADDRS[MY_STATUE_INDEX], 80)) {
+    return; // Next refresh retries
+  }
+  httpInFlight = true;
+  httpStartMs = millis();
+  lastSentLinked = linked;
+  sceneSentOnce = true;
+  lastSceneMs = millis();
+}
+
+// Step the in-flight request: write it once connected, then hang up.
+// The response is irrelevant - WLED applies the state either way.
+static void httpPump() {
+  if (!httpInFlight) {
+    return;
+  }
+  unsigned long now = millis();
+  if (wledClient.connected()) {
+    char header[128];
+    snprintf(header, sizeof(header),
+             "POST /json/state HTTP/1.1\r\nHost: wled\r\n"
+             "Content-Type: application/json\r\nContent-Length: %d\r\n"
+             "Connection: close\r\n\r\n",
+             (int)strlen(httpBody));
+    wledClient.write((const uint8_t *)header, strlen(header));
+    wledClient.write((const uint8_t *)httpBody, strlen(httpBody));
+    wledClient.flush();
+    wledClient.stop();
+    httpInFlight = false;
+  } else if (!wledClient.connecting() ||
+             now - httpStartMs >= ORPHAN_HTTP_TIMEOUT_MS) {
+    wledClient.stop();
+    httpInFlight = false;
+  }
+}
+
+void orphanModeLoop() {
+  unsigned long now = millis();
+
+  if (client.connected()) {
+    lastConnectedMs = now;
+    if (orphaned) {
+      // Orchestration is back; stop driving lights and let the Pi
+      // reassert its scene on the next contact event.
+      orphaned = false;
+      sceneSentOnce = false;
+      Serial.println("OrphanMode: broker back; rejoining orchestration");
+    }
+    return;
+  }
+
+  if (!orphaned) {
+    // lastConnectedMs stays 0 when the Pi was dead from boot; the
+    // threshold then counts from power-on, which is the right call.
+    if (now - lastConnectedMs < ORPHAN_AFTER_MS) {
+      return;
+    }
+    orphaned = true;
+    Serial.println("OrphanMode: broker lost; driving lights locally");
+  }
+
+  httpPump();
+
+  bool linked = latestLinkedMask != 0;
+  if (!sceneSentOnce || linked != lastSentLinked ||
+      now - lastSceneMs >= ORPHAN_REFRESH_MS) {
+    sendScene(linked);
+  }
+}
@@ -0,0 +1,17 @@
+/*
+OtaUpdate: firmware update over Ethernet into the Teensy 4.1 upper flash.
+*/
+
+#ifndef OTA_UPDATE_H
+#define OTA_UPDATE_H
+
+#include <Arduino.h>
+
+// Start listening for firmware uploads. Call once the network is up.
+void initOta();
+
+// Service an in-progress upload; call from loop() while the network is
+// ready. Applies the image and reboots after a verified upload.
+void otaLoop();
+
+#endif // OTA_UPDATE_H
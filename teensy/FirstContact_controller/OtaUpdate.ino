@@ -0,0 +1,233 @@
+/*
+  OtaUpdate: firmware update over Ethernet.
+
+  Reflashing five statues means climbing scaffolding with a laptop and a
+  USB cable, so firmware iteration during an event was effectively
+  impossible. This module listens on a TCP port for a firmware image,
+  stages it in the upper half of the Teensy 4.1's 8 MB flash, verifies it
+  against the CRC32 in the upload header, and only then copies it over
+  the running image from a RAM-resident routine and reboots. A failed or
+  interrupted upload leaves the running firmware untouched.
+
+  Upload protocol (one TCP connection from the Pi):
+    16-byte header: magic "MLOT", image length, CRC32 of the image,
+    reserved word - all little-endian - followed by the raw image bytes.
+  The statue answers "OK\n" after verification or "ERR\n" on any failure.
+  Uploads are only accepted from the Pi's address.
+
+  The flash primitives are the RAM-resident helpers the Teensy core uses
+  for EEPROM emulation; the final copy loop must also run from RAM since
+  it overwrites the flash it would otherwise execute from.
+*/
+
+#include "Networking.h"
+#include "OtaUpdate.h"
+
+// Teensy 4.1 flash geometry: 8 MB mapped at 0x60000000, 4 KB sectors.
+#define OTA_FLASH_BASE 0x60000000u
+#define OTA_FLASH_SIZE 0x800000u
+#define OTA_STAGE_OFFSET 0x400000u // Upper half holds the staged image
+#define OTA_SECTOR_SIZE 4096u
+#define OTA_MAX_IMAGE (OTA_FLASH_SIZE - OTA_STAGE_OFFSET)
+
+#define OTA_PORT 5810
+#define OTA_MAGIC 0x4D4C4F54u // "MLOT" - Missing Link OTa
+#define OTA_STALL_TIMEOUT_MS 10000
+
+// RAM-resident flash helpers from the Teensy core (eeprom.c).
+extern "C" {
+void eepromemu_flash_write(void *addr, const void *data, int len);
+void eepromemu_flash_erase_sector(void *addr);
+}
+
+struct __attribute__((packed)) OtaHeader {
+  uint32_t magic;
+  uint32_t length;
+  uint32_t crc;
+  uint32_t reserved;
+};
+
+static EthernetServer otaServer(OTA_PORT);
+static EthernetClient otaClient;
+static bool otaStarted = false;
+static bool uploadActive = false;
+static OtaHeader header;
+static uint32_t headerReceived = 0;
+static uint32_t imageReceived = 0;
+static unsigned long lastDataMs = 0;
+
+// Sector staging buffer: bytes accumulate here and are programmed to the
+// staging area one erased sector at a time.
+static uint8_t sectorBuf[OTA_SECTOR_SIZE];
+static uint32_t sectorFill = 0;
+
+// Same reflected CRC32 as the EEPROM config cache; duplicated here
+// because ConfigStore keeps its copy private to its translation unit.
+static uint32_t otaCrc32(const uint8_t *data, size_t length) {
+  uint32_t crc = 0xFFFFFFFF;
+  for (size_t i = 0; i < length; i++) {
+    crc ^= data[i];
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+    }
+  }
+  return ~crc;
+}
+
+void initOta() {
+  otaServer.begin();
+  otaStarted = true;
+  Serial.printf("OTA: listening on port %d\n", OTA_PORT);
+}
+
+static void abortUpload(const char *why) {
+  Serial.printf("OTA: aborted (%s) after %lu bytes\n", why,
+                (unsigned long)imageReceived);
+  if (otaClient) {
+    otaClient.print("ERR\n");
+    otaClient.stop();
+  }
+  uploadActive = false;
+}
+
+// Erase and program one staged sector at the given image offset.
+static void programStagedSector(uint32_t imageOffset) {
+  void *dst = (void *)(OTA_FLASH_BASE + OTA_STAGE_OFFSET + imageOffset);
+  eepromemu_flash_erase_sector(dst);
+  eepromemu_flash_write(dst, sectorBuf, sectorFill);
+  sectorFill = 0;
+}
+
+/*
+  Copy the verified image from the staging area over the running firmware
+  and reboot. FASTRUN places this in ITCM: once the first sector of the
+  live image is erased there is no flash to execute from, so everything
+  here - including the core's flash helpers, which are RAM-resident for
+  the same reason - must run from RAM with interrupts off. There is no
+  return from this function.
+*/
+FASTRUN static void applyStagedImage(uint32_t length) {
+  __disable_irq();
+  const uint8_t *src = (const uint8_t *)(OTA_FLASH_BASE + OTA_STAGE_OFFSET);
+  for (uint32_t off = 0; off < length; off += OTA_SECTOR_SIZE) {
+    uint32_t chunk = length - off;
+    if (chunk > OTA_SECTOR_SIZE) {
+      chunk = OTA_SECTOR_SIZE;
+    }
+    eepromemu_flash_erase_sector((void *)(OTA_FLASH_BASE + off));
+    eepromemu_flash_write((void *)(OTA_FLASH_BASE + off),
+                          (const void *)(src + off), chunk);
+  }
+  SCB_AIRCR = 0x05FA0004; // System reset
+  while (true) {
+  }
+}
+
+static void finishUpload() {
+  if (sectorFill > 0) {
+    programStagedSector(imageReceived - sectorFill);
+  }
+
+  // Verify the staged image straight out of memory-mapped flash.
+  const uint8_t *staged = (const uint8_t *)(OTA_FLASH_BASE + OTA_STAGE_OFFSET);
+  uint32_t crc = otaCrc32(staged, header.length);
+  if (crc != header.crc) {
+    Serial.printf("OTA: CRC mismatch (got %08lx, want %08lx)\n",
+                  (unsigned long)crc, (unsigned long)header.crc);
+    abortUpload("bad CRC");
+    return;
+  }
+
+  Serial.printf("OTA: image verified (%lu bytes); applying and rebooting\n",
+                (unsigned long)header.length);
+  otaClient.print("OK\n");
+  otaClient.flush();
+  otaClient.stop();
+  delay(100); // Let the ACK leave before interrupts go away
+  applyStagedImage(header.length);
+}
+
+void otaLoop() {
+  if (!otaStarted) {
+    return;
+  }
+
+  if (!uploadActive) {
+    EthernetClient incoming = otaServer.accept();
+    if (!incoming) {
+      return;
+    }
+    if (incoming.remoteIP() != getServer()) {
+      // Firmware only comes from the Pi.
+      Serial.print("OTA: rejected upload from ");
+      Serial.println(incoming.remoteIP());
+      incoming.stop();
+      return;
+    }
+    otaClient = incoming;
+    uploadActive = true;
+    headerReceived = 0;
+    imageReceived = 0;
+    sectorFill = 0;
+    lastDataMs = millis();
+    Serial.println("OTA: upload started");
+    return;
+  }
+
+  if (!otaClient.connected()) {
+    abortUpload("connection dropped");
+    return;
+  }
+
+  int avail = otaClient.available();
+  if (avail <= 0) {
+    if (millis() - lastDataMs > OTA_STALL_TIMEOUT_MS) {
+      abortUpload("stalled");
+    }
+    return;
+  }
+  lastDataMs = millis();
+
+  // Header first.
+  if (headerReceived < sizeof(header)) {
+    uint8_t *dst = (uint8_t *)&header;
+    int got = otaClient.read(dst + headerReceived,
+                             sizeof(header) - headerReceived);
+    if (got <= 0) {
+      return;
+    }
+    headerReceived += got;
+    if (headerReceived < sizeof(header)) {
+      return;
+    }
+    if (header.magic != OTA_MAGIC || header.length == 0 ||
+        header.length > OTA_MAX_IMAGE) {
+      abortUpload("bad header");
+      return;
+    }
+    Serial.printf("OTA: receiving %lu bytes\n", (unsigned long)header.length);
+    return;
+  }
+
+  // Then image bytes, staged one sector at a time.
+  while (otaClient.available() > 0 && imageReceived < header.length) {
+    int want = OTA_SECTOR_SIZE - sectorFill;
+    uint32_t remaining = header.length - imageReceived;
+    if ((uint32_t)want > remaining) {
+      want = remaining;
+    }
+    int got = otaClient.read(sectorBuf + sectorFill, want);
+    if (got <= 0) {
+      break;
+    }
+    sectorFill += got;
+    imageReceived += got;
+    if (sectorFill == OTA_SECTOR_SIZE) {
+      programStagedSector(imageReceived - sectorFill);
+    }
+  }
+
+  if (imageReceived >= header.length) {
+    finishUpload();
+  }
+}
@@ -0,0 +1,36 @@
+/*
+PeerLink: Direct statue-to-statue UDP link-event channel.
+*/
+
+#ifndef PEER_LINK_H
+#define PEER_LINK_H
+
+#include <Arduino.h>
+
+// Public so the mDNS announcement in Networking.ino can advertise it.
+#define PEER_LINK_PORT 5808
+
+// Join the multicast group and start broadcasting. Call once the network
+// is up and the statue identity is known.
+void initPeerLink();
+
+// Send the periodic/event frames and consume peer frames; call from
+// loop() while the network is ready.
+void peerLinkLoop();
+
+// Last link mask heard from the given statue, or 0 when nothing has been
+// heard within the staleness window.
+uint8_t peerLinkMask(int statueIndex);
+
+// Agreement rule for detection asymmetry: bit per statue that currently
+// claims a link to US on the peer channel. A claim counts as a link even
+// when our own detector sits below threshold (detection is physically
+// bidirectional), so both ends of an asymmetric link act consistently
+// without waiting for the Pi to reconcile.
+uint8_t peerLinkClaimedMask();
+
+// Loss/NACK counters for the missing_link/network frame; false while
+// the channel has seen no loss worth reporting.
+bool peerLinkStatsCollect(char *json, size_t jsonLen);
+
+#endif // PEER_LINK_H
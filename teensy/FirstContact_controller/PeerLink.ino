@@ -0,0 +1,321 @@
+/*
+  PeerLink: direct statue-to-statue UDP link-event channel.
+
+  A link event normally travels Teensy -> mosquitto -> Pi controller ->
+  WLED, and the broker hop is pure added latency for information the peer
+  statue also needs (both ends of a link react). Each statue therefore
+  multicasts a tiny frame - protocol version, statue id, link mask,
+  sequence number - at a fixed 10 Hz, plus an immediate send the moment
+  its mask changes. Peer statues and the Pi consume link events with one
+  network hop; MQTT remains the reliable/ordered path for contact events
+  and the config channel.
+
+  The channel rides a raw lwIP UDP PCB rather than an EthernetUDP
+  socket: EthernetUDP queues every datagram through a heap-backed packet
+  buffer that parsePacket() then copies out of on the next loop pass.
+  With a receive callback registered via udp_recv(), the fixed-layout
+  frame is validated and parsed straight out of the arriving pbuf when
+  the network stack processes it - no intermediate buffer, no polling,
+  and a peer's mask lands in peerMasks[] without waiting for
+  peerLinkLoop() to come around.
+*/
+
+#include "Networking.h"
+#include "PeerLink.h"
+#include "StatueConfig.h"
+
+#include "lwip/igmp.h"
+#include "lwip/udp.h"
+
+#define PEER_LINK_PERIOD_MS 100
+#define PEER_LINK_STALE_MS 1000
+#define PEER_LINK_VERSION 2
+
+/*
+  NACK reliability layer (v2). The channel is full-state - every frame
+  carries the sender's whole mask - so any received frame heals all
+  prior loss, and a retransmit of old frames would be pointless. What a
+  state channel cannot self-heal is silence: lose a few heartbeats in a
+  burst and the staleness cutoff zeroes the peer's mask at 1 s, which
+  downstream reads as an unlink that never happened. A receiver that
+  has heard a peer but then gets nothing for PEER_NACK_PROBE_MS now
+  multicasts a NACK naming it; the sender answers with an immediate
+  state frame, so a loss burst resolves in about one LAN round trip
+  instead of tripping the stale cutoff. The sender's history ring
+  tells it whether the silent stretch hid a mask change - the event the
+  requester actually missed - and counts those separately from plain
+  heartbeat loss. The common case stays one unacknowledged datagram;
+  sequence gaps observed at arrival just feed the loss counters.
+*/
+#define PEER_FLAG_NACK 0x01
+// Covers >1.5 s of outage at the heartbeat rate - far beyond any gap a
+// NACK will realistically name.
+#define PEER_LINK_HISTORY 16
+// Probe after 2.5 silent beats: late enough that one lost heartbeat
+// never probes, early enough to beat the 1 s stale cutoff comfortably.
+#define PEER_NACK_PROBE_MS 250
+// One NACK-triggered resend per window, against NACK storms when the
+// same loss burst hits several receivers at once.
+#define PEER_NACK_RESEND_MIN_MS 5
+
+static const IPAddress PEER_LINK_GROUP(239, 255, 58, 8);
+
+// Written by the sense timer ISR (see AudioSense.ino).
+extern volatile StatueMask latestLinkedMask;
+
+// Fixed little-endian layout; the Pi and peers parse this directly.
+// For a NACK (flags & PEER_FLAG_NACK): statueId is the requester,
+// linkMask carries the id of the statue being asked to resend, and seq
+// is the last sequence number the requester heard from it.
+struct __attribute__((packed)) PeerLinkFrame {
+  uint8_t version;
+  uint8_t statueId; // 0..MAX_STATUES-1
+  uint8_t linkMask; // Bit per peer statue, same encoding as telemetry
+  uint8_t flags;    // PEER_FLAG_* (was reserved in v1)
+  uint16_t seq; // Wraps; lets consumers detect loss
+};
+
+static struct udp_pcb *peerPcb = NULL;
+static ip_addr_t peerGroupAddr;
+static bool peerLinkUp = false;
+static uint16_t txSeq = 0;
+static uint8_t lastSentMask = 0;
+static unsigned long lastSendMs = 0;
+
+// Last frame heard from each peer. Written from the receive callback
+// (network-stack context), read from loop context; all fields are
+// single-word stores, so readers see whole values.
+static volatile uint8_t peerMasks[MAX_STATUES];
+static volatile uint16_t peerSeq[MAX_STATUES];
+static volatile unsigned long peerSeenMs[MAX_STATUES];
+static bool peerHeard[MAX_STATUES];     // Gap/silence detection baseline
+static bool probeArmed[MAX_STATUES];    // One probe per silence episode
+static uint32_t lostFrames = 0;         // Sequence-gap frames observed
+
+// Send history: (seq, mask) of the last PEER_LINK_HISTORY frames, so a
+// NACK answer can tell whether the requester's silent stretch hid a
+// mask change. Indexed by seq % PEER_LINK_HISTORY; the stored seq is
+// the slot key.
+struct SendHistoryEntry {
+  uint16_t seq;
+  uint8_t mask;
+};
+static SendHistoryEntry sendHistory[PEER_LINK_HISTORY];
+static unsigned long lastNackResendMs = 0;
+static uint32_t nacksSent = 0;
+static uint32_t nackResends = 0;
+static uint32_t nackChangesMissed = 0;
+
+static void sendFrame();
+static void sendNack(uint8_t targetId, uint16_t lastSeenSeq);
+
+// A peer asked for a resend after losing track of us: answer with the
+// current state (rate-limited), and check the history across the range
+// it names - a mask change in there is the event it actually missed.
+static void handleNack(uint16_t lastSeenSeq) {
+  unsigned long now = millis();
+  if (now - lastNackResendMs < PEER_NACK_RESEND_MIN_MS) {
+    return; // Another receiver's NACK already triggered the resend
+  }
+  bool changed = false;
+  const SendHistoryEntry &base = sendHistory[lastSeenSeq % PEER_LINK_HISTORY];
+  if (base.seq != lastSeenSeq) {
+    changed = true; // Fell off the history ring; assume the worst
+  } else {
+    for (uint16_t s = (uint16_t)(lastSeenSeq + 1); s != txSeq;
+         s = (uint16_t)(s + 1)) {
+      const SendHistoryEntry &e = sendHistory[s % PEER_LINK_HISTORY];
+      if (e.seq != s || e.mask != base.mask) {
+        changed = true;
+        break;
+      }
+    }
+  }
+  if (changed) {
+    nackChangesMissed++;
+    Serial.printf("PeerLink: NACK resend covered a mask change (%lu total)\n",
+                  (unsigned long)nackChangesMissed);
+  }
+  lastNackResendMs = now;
+  nackResends++;
+  sendFrame();
+}
+
+// Receive callback, invoked by lwIP as soon as the stack processes the
+// datagram. The frame is parsed in place from the pbuf payload; a peer
+// frame always fits the first (and only) pbuf.
+static void peerLinkRecv(void *arg, struct udp_pcb *pcb, struct pbuf *p,
+                         const ip_addr_t *addr, u16_t port) {
+  (void)arg;
+  (void)pcb;
+  (void)addr;
+  (void)port;
+  if (p == NULL) {
+    return;
+  }
+  if (p->len == sizeof(PeerLinkFrame)) {
+    const PeerLinkFrame *frame = (const PeerLinkFrame *)p->payload;
+    if (frame->version == PEER_LINK_VERSION &&
+        frame->statueId < MAX_STATUES &&
+        frame->statueId != (uint8_t)MY_STATUE_INDEX) {
+      if (frame->flags & PEER_FLAG_NACK) {
+        // A resend request; only the statue it names answers.
+        if (frame->linkMask == (uint8_t)MY_STATUE_INDEX) {
+          handleNack(frame->seq);
+        }
+      } else {
+        if (frame->linkMask != peerMasks[frame->statueId]) {
+          Serial.printf("PeerLink: %s mask 0x%02x -> 0x%02x (seq %u)\n",
+                        STATUE_NAMES_LC[frame->statueId],
+                        peerMasks[frame->statueId], frame->linkMask,
+                        frame->seq);
+        }
+        // A sequence gap at arrival needs no NACK on a full-state
+        // channel - this frame already carries the current mask - but
+        // it is the loss signal the counters watch.
+        if (peerHeard[frame->statueId]) {
+          uint16_t gap = (uint16_t)(frame->seq - peerSeq[frame->statueId]);
+          if (gap > 1) {
+            lostFrames += gap - 1;
+          }
+        }
+        peerMasks[frame->statueId] = frame->linkMask;
+        peerSeq[frame->statueId] = frame->seq;
+        peerSeenMs[frame->statueId] = millis();
+        peerHeard[frame->statueId] = true;
+        probeArmed[frame->statueId] = true;
+      }
+    }
+  }
+  pbuf_free(p);
+}
+
+void initPeerLink() {
+  IP_ADDR4(&peerGroupAddr, PEER_LINK_GROUP[0], PEER_LINK_GROUP[1],
+           PEER_LINK_GROUP[2], PEER_LINK_GROUP[3]);
+
+  peerPcb = udp_new();
+  if (peerPcb == NULL || udp_bind(peerPcb, IP_ANY_TYPE, PEER_LINK_PORT) != ERR_OK ||
+      !Ethernet.joinGroup(PEER_LINK_GROUP)) {
+    Serial.println("PeerLink: bind/join failed");
+    if (peerPcb != NULL) {
+      udp_remove(peerPcb);
+      peerPcb = NULL;
+    }
+    return;
+  }
+  udp_recv(peerPcb, peerLinkRecv, NULL);
+
+  peerLinkUp = true;
+  Serial.printf("PeerLink: joined %u.%u.%u.%u:%u as statue %d\n",
+                PEER_LINK_GROUP[0], PEER_LINK_GROUP[1], PEER_LINK_GROUP[2],
+                PEER_LINK_GROUP[3], PEER_LINK_PORT, MY_STATUE_INDEX);
+}
+
+static void sendFrame() {
+  PeerLinkFrame frame;
+  frame.version = PEER_LINK_VERSION;
+  frame.statueId = (uint8_t)MY_STATUE_INDEX;
+  frame.linkMask = latestLinkedMask;
+  frame.flags = 0;
+  frame.seq = txSeq++;
+
+  // Record before the send: a frame that dies in the pool still
+  // occupies its sequence number.
+  SendHistoryEntry &slot = sendHistory[frame.seq % PEER_LINK_HISTORY];
+  slot.seq = frame.seq;
+  slot.mask = frame.linkMask;
+
+  struct pbuf *p = pbuf_alloc(PBUF_TRANSPORT, sizeof(frame), PBUF_RAM);
+  if (p == NULL) {
+    return; // Pool pressure; the next beat retries
+  }
+  memcpy(p->payload, &frame, sizeof(frame));
+  udp_sendto(peerPcb, p, &peerGroupAddr, PEER_LINK_PORT);
+  pbuf_free(p);
+
+  lastSentMask = frame.linkMask;
+  lastSendMs = millis();
+}
+
+// Multicast a resend request naming the silent statue. The target
+// answers; everyone else ignores it.
+static void sendNack(uint8_t targetId, uint16_t lastSeenSeq) {
+  PeerLinkFrame frame;
+  frame.version = PEER_LINK_VERSION;
+  frame.statueId = (uint8_t)MY_STATUE_INDEX;
+  frame.linkMask = targetId;
+  frame.flags = PEER_FLAG_NACK;
+  frame.seq = lastSeenSeq;
+
+  struct pbuf *p = pbuf_alloc(PBUF_TRANSPORT, sizeof(frame), PBUF_RAM);
+  if (p == NULL) {
+    return;
+  }
+  memcpy(p->payload, &frame, sizeof(frame));
+  udp_sendto(peerPcb, p, &peerGroupAddr, PEER_LINK_PORT);
+  pbuf_free(p);
+  nacksSent++;
+}
+
+void peerLinkLoop() {
+  if (!peerLinkUp) {
+    return;
+  }
+  // Receive is callback-driven (peerLinkRecv); only transmit lives here.
+  // Heartbeat at the fixed rate; a mask change goes out immediately so a
+  // peer reacts within one loop pass instead of waiting for the beat.
+  uint8_t mask = latestLinkedMask;
+  unsigned long now = millis();
+  if (mask != lastSentMask || now - lastSendMs >= PEER_LINK_PERIOD_MS) {
+    sendFrame();
+  }
+
+  // Silence probe: a peer we were hearing has missed a few beats. One
+  // NACK per silence episode - either the answer (or any later frame)
+  // re-arms it, or the stale cutoff takes over at 1 s.
+  for (int i = 0; i < MAX_STATUES; i++) {
+    if (i == MY_STATUE_INDEX || !probeArmed[i]) {
+      continue;
+    }
+    if (now - peerSeenMs[i] >= PEER_NACK_PROBE_MS) {
+      probeArmed[i] = false;
+      sendNack((uint8_t)i, peerSeq[i]);
+    }
+  }
+}
+
+uint8_t peerLinkClaimedMask() {
+  uint8_t claimed = 0;
+  for (int i = 0; i < MAX_STATUES; i++) {
+    if (i == MY_STATUE_INDEX) {
+      continue;
+    }
+    if (peerLinkMask(i) & (1u << MY_STATUE_INDEX)) {
+      claimed |= (uint8_t)(1u << i);
+    }
+  }
+  return claimed;
+}
+
+bool peerLinkStatsCollect(char *json, size_t jsonLen) {
+  if (lostFrames == 0 && nacksSent == 0 && nackResends == 0) {
+    return false; // A clean channel adds nothing to the frame
+  }
+  snprintf(json, jsonLen,
+           "{\"lost\":%lu,\"nacks_tx\":%lu,\"resends\":%lu,"
+           "\"missed_changes\":%lu}",
+           (unsigned long)lostFrames, (unsigned long)nacksSent,
+           (unsigned long)nackResends, (unsigned long)nackChangesMissed);
+  return true;
+}
+
+uint8_t peerLinkMask(int statueIndex) {
+  if (!peerLinkUp || statueIndex < 0 || statueIndex >= MAX_STATUES) {
+    return 0;
+  }
+  if (millis() - peerSeenMs[statueIndex] > PEER_LINK_STALE_MS) {
+    return 0; // Peer down or never heard
+  }
+  return peerMasks[statueIndex];
+}
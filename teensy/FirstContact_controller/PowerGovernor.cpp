@@ -0,0 +1,41 @@
+/*
+PowerGovernor.cpp - clock decisions from link state and detector bands.
+
+Ramp-up is edge-triggered and immediate: any linked statue or any
+detector inside its threshold hysteresis band (see the adaptive window
+logic in getStableLinkedMask) forces the active clock on the very next
+governor tick. Ramp-down waits out a hold-off so brushes with the
+band do not thrash the clock. set_arm_clock() reprograms the ARM PLL
+only; the audio chain clocks from PLL4 and never notices.
+*/
+
+#include "PowerGovernor.h"
+
+#include "AudioSense.h"
+#include "Log.h"
+
+extern "C" uint32_t set_arm_clock(uint32_t frequency);
+extern volatile StatueMask latestLinkedMask; // AudioSense.ino
+
+static uint16_t currentMhz = POWER_ACTIVE_MHZ;
+static elapsedMillis sinceActivity;
+
+void powerGovernorLoop() {
+  bool active = latestLinkedMask != 0 || audioSenseTransitionActive();
+  if (active) {
+    sinceActivity = 0;
+  }
+
+  if (active && currentMhz != POWER_ACTIVE_MHZ) {
+    set_arm_clock(POWER_ACTIVE_MHZ * 1000000u);
+    currentMhz = POWER_ACTIVE_MHZ;
+    LOG_INFO("clock up: %d MHz (activity)", POWER_ACTIVE_MHZ);
+  } else if (!active && currentMhz != POWER_IDLE_MHZ &&
+             sinceActivity >= POWER_IDLE_HOLDOFF_MS) {
+    set_arm_clock(POWER_IDLE_MHZ * 1000000u);
+    currentMhz = POWER_IDLE_MHZ;
+    LOG_INFO("clock down: %d MHz (dormant)", POWER_IDLE_MHZ);
+  }
+}
+
+uint16_t powerCurrentMhz() { return currentMhz; }
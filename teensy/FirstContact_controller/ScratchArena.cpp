@@ -0,0 +1,40 @@
+/*
+ScratchArena.cpp - the arena itself: bump allocation, frame unwind,
+and the high-water mark.
+
+Allocation is a bump of a single offset; a frame records the offset at
+construction and restores it at destruction, so unwinding is free and
+order is enforced by C++ scoping rather than bookkeeping. The region
+lives in DTCM bss like every other working buffer - scratch users are
+parse and protocol code on the CPU, not DMA targets.
+*/
+
+#include "ScratchArena.h"
+
+#include "Log.h"
+
+static uint8_t arena[SCRATCH_ARENA_BYTES];
+static size_t arenaTop = 0;
+static size_t arenaHighWater = 0;
+
+void *scratchAlloc(size_t bytes) {
+  size_t rounded = (bytes + 7u) & ~(size_t)7u;
+  if (rounded == 0 || arenaTop + rounded > SCRATCH_ARENA_BYTES) {
+    LOG_ERROR("ScratchArena: spent (%u used, want %u of %u)",
+              (unsigned)arenaTop, (unsigned)rounded,
+              (unsigned)SCRATCH_ARENA_BYTES);
+    return NULL;
+  }
+  void *p = &arena[arenaTop];
+  arenaTop += rounded;
+  if (arenaTop > arenaHighWater) {
+    arenaHighWater = arenaTop;
+  }
+  return p;
+}
+
+ScratchFrame::ScratchFrame() { mark = arenaTop; }
+
+ScratchFrame::~ScratchFrame() { arenaTop = mark; }
+
+size_t scratchHighWater() { return arenaHighWater; }
@@ -0,0 +1,47 @@
+/*
+ScratchArena: reset-based allocator for short-lived buffers.
+
+Transient buffers kept accreting as permanent statics (a 512-byte DNS
+response buffer parked in RAM forever for an exchange that runs a few
+times per boot) or as oversized stack locals inside deep call chains.
+The arena replaces both: one region serves every short-lived need with
+stack discipline - take a frame, allocate freely, and everything is
+handed back when the frame closes. Nothing is freed piecemeal, so
+there is no fragmentation and no leak, and the lifetime high-water
+mark rides the minute memory telemetry (scratch_hw), so the region is
+sized from measurement.
+
+Loop/scheduler-task context only (callers run one at a time, like
+SdArbiter's); never from ISRs. Allocation failure returns NULL rather
+than asserting - callers on the network path already handle short
+reads and malformed packets, and a NULL just joins those paths.
+*/
+
+#ifndef SCRATCH_ARENA_H
+#define SCRATCH_ARENA_H
+
+#include <Arduino.h>
+
+// Sized for the current largest user (the two 512-byte DNS packet
+// buffers live in one frame) plus headroom; scratch_hw is the check.
+#define SCRATCH_ARENA_BYTES 2048
+
+// Allocate from the current frame, 8-byte aligned. NULL when the
+// arena is spent (logged once per high-water advance, not per call).
+void *scratchAlloc(size_t bytes);
+
+// RAII frame: construction marks the arena, destruction hands back
+// everything allocated since. Frames nest like the call stack does.
+class ScratchFrame {
+public:
+  ScratchFrame();
+  ~ScratchFrame();
+
+private:
+  size_t mark;
+};
+
+// Lifetime high-water mark in bytes, for the memory telemetry.
+size_t scratchHighWater();
+
+#endif // SCRATCH_ARENA_H
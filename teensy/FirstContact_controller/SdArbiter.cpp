@@ -0,0 +1,136 @@
+/*
+SdArbiter.cpp - priority grants and service-time accounting for SD I/O.
+
+All callers run in loop()/scheduler-task context (never the audio
+update), one at a time, so plain statics need no locking.
+*/
+
+#include "SdArbiter.h"
+
+#include "FaultInject.h"
+#include "MonoClock.h"
+
+// Current window: start, card time charged so far, and which classes
+// have work outstanding (set by begin(), cleared by end() or the roll).
+static uint64_t windowStartUs = 0;
+static uint32_t windowSpentUs = 0;
+static uint8_t pendingMask = 0;
+static uint64_t grantStartUs = 0;
+
+// Window counters, reset by the collector.
+static uint32_t grants[SD_IO_CLASS_COUNT];
+static uint32_t denials[SD_IO_CLASS_COUNT];
+static uint32_t budgetDenials = 0;
+static uint8_t maxDepth = 0;
+
+// Consecutive denials per class; the high-water mark is the starvation
+// signal (a class that never gets a turn climbs without bound).
+static uint32_t deniedStreak[SD_IO_CLASS_COUNT];
+static uint32_t maxStreak[SD_IO_CLASS_COUNT];
+
+// Lifetime denial totals - the trend that says a consumer is sized
+// wrong, robust to a missed MQTT publish.
+static uint32_t totalDenials[SD_IO_CLASS_COUNT];
+
+// Replenish the budget and drop stale pending bits once per window.
+// A denied class re-registers on its next begin() attempt, so a bit
+// can be stale for at most one window.
+static void rollWindow(uint64_t nowUs) {
+  if (nowUs - windowStartUs >= SD_IO_WINDOW_US) {
+    windowStartUs = nowUs;
+    windowSpentUs = 0;
+    pendingMask = 0;
+  }
+}
+
+bool sdIoBegin(uint8_t ioClass) {
+  uint64_t nowUs = monoNowUs();
+  rollWindow(nowUs);
+  pendingMask |= (uint8_t)(1u << ioClass);
+  uint8_t depth = (uint8_t)__builtin_popcount((unsigned)pendingMask);
+  if (depth > maxDepth) {
+    maxDepth = depth;
+  }
+
+#if FAULT_INJECT
+  // Injected stall (FaultInject.h): the card "hangs" for every class,
+  // playback included, so the underrun and starvation paths under test
+  // see a real denial, not a simulated flag.
+  if (faultInjectSdStalled()) {
+    faultInjectNoteSdDenied();
+    denials[ioClass]++;
+    totalDenials[ioClass]++;
+    deniedStreak[ioClass]++;
+    if (deniedStreak[ioClass] > maxStreak[ioClass]) {
+      maxStreak[ioClass] = deniedStreak[ioClass];
+    }
+    return false;
+  }
+#endif
+
+  if (ioClass != SD_IO_PLAYBACK) {
+    // A higher class has an unserved request, or the background budget
+    // for this window is gone.
+    bool overBudget = windowSpentUs >= SD_IO_BUDGET_US;
+    if ((pendingMask & (uint8_t)((1u << ioClass) - 1)) != 0 || overBudget) {
+      if (overBudget) {
+        budgetDenials++;
+      }
+      denials[ioClass]++;
+      totalDenials[ioClass]++;
+      deniedStreak[ioClass]++;
+      if (deniedStreak[ioClass] > maxStreak[ioClass]) {
+        maxStreak[ioClass] = deniedStreak[ioClass];
+      }
+      return false;
+    }
+  }
+
+#if FAULT_INJECT
+  faultInjectNoteSdGranted(); // First grant after the stall = recovery
+#endif
+  grantStartUs = nowUs;
+  grants[ioClass]++;
+  deniedStreak[ioClass] = 0;
+  return true;
+}
+
+void sdIoEnd(uint8_t ioClass) {
+  windowSpentUs += (uint32_t)(monoNowUs() - grantStartUs);
+  pendingMask &= (uint8_t)~(1u << ioClass);
+}
+
+bool sdIoStatsCollect(char *json, size_t jsonLen) {
+  uint32_t activity = budgetDenials;
+  for (int i = 0; i < SD_IO_CLASS_COUNT; i++) {
+    activity += grants[i] + denials[i];
+  }
+  if (activity == 0) {
+    return false;
+  }
+
+  // Class order matches SD_IO_*: play, journal, recorder, sync.
+  snprintf(json, jsonLen,
+           "{\"depth_max\":%u,"
+           "\"grants\":[%lu,%lu,%lu,%lu],"
+           "\"denied\":[%lu,%lu,%lu,%lu],"
+           "\"streak_max\":[%lu,%lu,%lu,%lu],"
+           "\"budget_denied\":%lu,"
+           "\"total_denied\":[%lu,%lu,%lu,%lu]}",
+           (unsigned)maxDepth, (unsigned long)grants[0],
+           (unsigned long)grants[1], (unsigned long)grants[2],
+           (unsigned long)grants[3], (unsigned long)denials[0],
+           (unsigned long)denials[1], (unsigned long)denials[2],
+           (unsigned long)denials[3], (unsigned long)maxStreak[0],
+           (unsigned long)maxStreak[1], (unsigned long)maxStreak[2],
+           (unsigned long)maxStreak[3], (unsigned long)budgetDenials,
+           (unsigned long)totalDenials[0], (unsigned long)totalDenials[1],
+           (unsigned long)totalDenials[2], (unsigned long)totalDenials[3]);
+
+  memset(grants, 0, sizeof(grants));
+  memset(denials, 0, sizeof(denials));
+  memset(maxStreak, 0, sizeof(maxStreak));
+  budgetDenials = 0;
+  maxDepth = 0;
+  return true;
+}
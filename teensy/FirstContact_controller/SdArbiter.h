@@ -0,0 +1,60 @@
+/*
+SdArbiter: prioritized access arbitration for the one SD card.
+
+Four services share the card with no coordination beyond convention:
+the music streamer's prefetch (SdStream.cpp), the event journal flush
+(EventJournal.cpp), the flight recorder flush (FlightRecorder.cpp), and
+the song sync service (SongSync.ino). Each grew its own ad-hoc throttle
+- "one chunk per pass while music plays" and the like - and every new
+consumer was a fresh chance to starve the streamer into a dropout.
+
+This module centralizes the rule. A consumer brackets each burst of
+card work with sdIoBegin(class)/sdIoEnd(): begin() grants or denies the
+burst, end() charges its duration against a rolling service window.
+Grants follow fixed priority - playback prefetch above the journal,
+the journal above the recorder, the recorder above sync - and all
+non-playback work together is bounded to SD_IO_BUDGET_US out of every
+SD_IO_WINDOW_US, so the worst case a background consumer can add ahead
+of a prefetch read is one budget's worth of card time. Playback is
+never denied; its card time still charges the window, so a heavy
+prefetch pass automatically squeezes the background classes out.
+
+A denied begin() marks the class pending, which blocks lower classes
+for the rest of the window - priority holds across passes, not just
+within one. Consumers already chunk their bursts (4 KB writes, 32 KB
+reads), so one grant stays bounded on its own.
+
+Queue depth, per-class grant/denial counters, and the longest denial
+streak per class ride out in the missing_link/storage frame, so a
+misbehaving consumer shows up as numbers instead of as audio dropouts.
+*/
+
+#ifndef SD_ARBITER_H
+#define SD_ARBITER_H
+
+#include <Arduino.h>
+
+// Priority classes, highest first. Lower number wins.
+#define SD_IO_PLAYBACK 0 // Streamer prefetch reads (never denied)
+#define SD_IO_JOURNAL 1  // Event journal batch flush
+#define SD_IO_RECORDER 2 // Flight recorder batch flush / replay reads
+#define SD_IO_SYNC 3     // Song sync staging writes
+#define SD_IO_CLASS_COUNT 4
+
+// Rolling service window and the card time within it that all
+// non-playback classes may use between them.
+#define SD_IO_WINDOW_US 10000
+#define SD_IO_BUDGET_US 4000
+
+// Ask to touch the card now. True = go ahead, call sdIoEnd() when the
+// burst is done. False = denied this pass; keep buffering and retry on
+// the next pass (the denial is counted against the class).
+bool sdIoBegin(uint8_t ioClass);
+void sdIoEnd(uint8_t ioClass);
+
+// Summarize the window's arbitration counters into a JSON object and
+// reset them (denial totals are lifetime). Returns false when the
+// window saw no requests and nothing was written.
+bool sdIoStatsCollect(char *json, size_t jsonLen);
+
+#endif // SD_ARBITER_H
@@ -0,0 +1,292 @@
+/*
+SdBench.cpp - measurement loops and the verdict.
+
+All reads go through FsFile on the SdFat layer (the same path the
+streamer's wrapper ultimately takes) and are bracketed with the arbiter
+(SdArbiter.h): the boot check as the playback class - nothing else is
+up yet and its card time should charge the window like a prefetch - and
+the live sweep as the lowest class, so a mid-show run can never delay a
+real prefetch read.
+*/
+
+#include "SdBench.h"
+
+#include <SD.h>
+
+#include "Log.h"
+#include "SdArbiter.h"
+#include "SongManifest.h"
+
+// Largest burst measured; also the bench buffer size. The streamer
+// prefetches 32 KB halves, but 16 KB bursts run at the same per-sector
+// rate and keep the buffer affordable next to the intro preloads.
+#define SD_BENCH_MAX_BLOCK 16384
+
+// Boot check: half a megabyte sequential in max-block bursts, then a
+// handful of scattered small reads for the seek+read latency shape of
+// a resume or loop wrap.
+#define SD_BENCH_BOOT_SEQ_BYTES (512UL * 1024)
+#define SD_BENCH_BOOT_RANDOM_READS 16
+
+// Full sweep: per block size, this much sequential data and this many
+// random reads.
+#define SD_BENCH_SWEEP_SEQ_BYTES (1024UL * 1024)
+#define SD_BENCH_SWEEP_RANDOM_READS 64
+
+static const uint32_t SWEEP_BLOCKS[] = {4096, 8192, 16384};
+#define SWEEP_BLOCK_COUNT ((int)(sizeof(SWEEP_BLOCKS) / sizeof(SWEEP_BLOCKS[0])))
+
+DMAMEM static uint8_t benchBuf[SD_BENCH_MAX_BLOCK];
+
+// Most recent finished report, for publishSdBenchReport() (Messaging).
+static char reportJson[320];
+static bool reportPending = false;
+
+// Sweep state machine, advanced one burst per sdBenchLoop() pass.
+static bool sweepRunning = false;
+static FsFile sweepFile;
+static uint32_t sweepDataOffset = 0;
+static uint32_t sweepDataLength = 0;
+static int sweepBlockIndex = 0;
+static bool sweepRandomPhase = false;
+static uint32_t sweepSeqTarget = 0;
+static uint32_t sweepBytesDone = 0;
+static uint32_t sweepReadsDone = 0;
+static uint64_t sweepSeqUs = 0;
+static uint32_t sweepMaxBurstUs = 0;
+static uint32_t sweepSeqKbps[SWEEP_BLOCK_COUNT];
+static uint32_t sweepRandMaxMs[SWEEP_BLOCK_COUNT];
+
+static uint32_t benchSeed = 0x9E3779B9u;
+
+// The biggest song on the card: enough span for the random reads and
+// the file most representative of show traffic.
+static const SongInfo *largestSong() {
+  const SongInfo *best = nullptr;
+  for (int i = 0; i < activeSongCount(); i++) {
+    const SongInfo *s = activeSong(i);
+    if (best == nullptr || s->dataLength > best->dataLength) {
+      best = s;
+    }
+  }
+  for (int i = 0; i < idleSongCount(); i++) {
+    const SongInfo *s = idleSong(i);
+    if (best == nullptr || s->dataLength > best->dataLength) {
+      best = s;
+    }
+  }
+  return best;
+}
+
+// Sector-aligned pseudo-random offset within the data chunk.
+static uint32_t randomOffset(uint32_t block) {
+  benchSeed = benchSeed * 1664525u + 1013904223u;
+  uint32_t span = sweepDataLength > block ? sweepDataLength - block : 1;
+  return sweepDataOffset + ((benchSeed % span) & ~(uint32_t)511);
+}
+
+// One timed seek+read. Returns elapsed microseconds, 0 on failure.
+static uint32_t timedRead(FsFile &f, uint32_t offset, uint32_t len) {
+  uint32_t start = micros();
+  if (!f.seekSet(offset) || f.read(benchBuf, len) != (int)len) {
+    return 0;
+  }
+  return micros() - start;
+}
+
+void sdBenchBootCheck() {
+  const SongInfo *song = largestSong();
+  if (song == nullptr || song->dataLength < 4 * SD_BENCH_MAX_BLOCK) {
+    LOG_WARN("sdbench: no target file; card unverified");
+    return;
+  }
+  FsFile f = SD.sdfs.open(song->filename, O_RDONLY);
+  if (!f.isOpen()) {
+    LOG_WARN("sdbench: cannot open %s", song->filename);
+    return;
+  }
+  sweepDataOffset = song->dataOffset;
+  sweepDataLength = song->dataLength;
+
+  uint32_t seqTarget = SD_BENCH_BOOT_SEQ_BYTES;
+  if (seqTarget > song->dataLength) {
+    seqTarget = song->dataLength - (song->dataLength % SD_BENCH_MAX_BLOCK);
+  }
+
+  // Sequential max-block bursts from the start of the data chunk - the
+  // same shape as the streamer's prefetch.
+  uint64_t seqUs = 0;
+  uint32_t maxBurstUs = 0;
+  uint32_t done = 0;
+  sdIoBegin(SD_IO_PLAYBACK);
+  while (done < seqTarget) {
+    uint32_t us = timedRead(f, song->dataOffset + done, SD_BENCH_MAX_BLOCK);
+    if (us == 0) {
+      break;
+    }
+    seqUs += us;
+    if (us > maxBurstUs) {
+      maxBurstUs = us;
+    }
+    done += SD_BENCH_MAX_BLOCK;
+  }
+  // Scattered small reads - the resume/loop-seek shape.
+  for (int i = 0; i < SD_BENCH_BOOT_RANDOM_READS; i++) {
+    uint32_t us = timedRead(f, randomOffset(4096), 4096);
+    if (us == 0) {
+      break;
+    }
+    if (us > maxBurstUs) {
+      maxBurstUs = us;
+    }
+  }
+  sdIoEnd(SD_IO_PLAYBACK);
+  f.close();
+
+  uint32_t seqKbps =
+      seqUs > 0 ? (uint32_t)(((uint64_t)done * 1000000) / seqUs / 1024) : 0;
+  uint32_t burstMaxMs = maxBurstUs / 1000;
+  bool pass =
+      seqKbps >= SD_BENCH_MIN_SEQ_KBPS && burstMaxMs <= SD_BENCH_MAX_BURST_MS;
+  if (pass) {
+    LOG_INFO("sdbench: PASS %lu KB/s seq, %lu ms worst burst",
+             (unsigned long)seqKbps, (unsigned long)burstMaxMs);
+  } else {
+    LOG_WARN("sdbench: FAIL %lu KB/s seq, %lu ms worst burst "
+             "(need >=%d KB/s and <=%d ms) - replace this card",
+             (unsigned long)seqKbps, (unsigned long)burstMaxMs,
+             SD_BENCH_MIN_SEQ_KBPS, SD_BENCH_MAX_BURST_MS);
+  }
+  snprintf(reportJson, sizeof(reportJson),
+           "{\"phase\":\"boot\",\"pass\":%s,\"seq_kbps\":%lu,"
+           "\"burst_max_ms\":%lu}",
+           pass ? "true" : "false", (unsigned long)seqKbps,
+           (unsigned long)burstMaxMs);
+  reportPending = true;
+}
+
+void sdBenchStart() {
+  if (sweepRunning) {
+    return;
+  }
+  const SongInfo *song = largestSong();
+  if (song == nullptr || song->dataLength < 4 * SD_BENCH_MAX_BLOCK) {
+    LOG_WARN("sdbench: no target file for sweep");
+    return;
+  }
+  sweepFile = SD.sdfs.open(song->filename, O_RDONLY);
+  if (!sweepFile.isOpen()) {
+    LOG_WARN("sdbench: cannot open %s", song->filename);
+    return;
+  }
+  sweepDataOffset = song->dataOffset;
+  sweepDataLength = song->dataLength;
+  sweepBlockIndex = 0;
+  sweepRandomPhase = false;
+  sweepBytesDone = 0;
+  sweepReadsDone = 0;
+  sweepSeqUs = 0;
+  sweepMaxBurstUs = 0;
+  sweepSeqTarget = SD_BENCH_SWEEP_SEQ_BYTES;
+  if (sweepSeqTarget > song->dataLength) {
+    sweepSeqTarget = song->dataLength - (song->dataLength % SD_BENCH_MAX_BLOCK);
+  }
+  sweepRunning = true;
+  LOG_INFO("sdbench: sweep started (%s)", song->filename);
+}
+
+// Finish the current block size; advance or wrap up the sweep.
+static void sweepNextBlock() {
+  sweepBlockIndex++;
+  sweepRandomPhase = false;
+  sweepBytesDone = 0;
+  sweepReadsDone = 0;
+  sweepSeqUs = 0;
+  if (sweepBlockIndex < SWEEP_BLOCK_COUNT) {
+    return;
+  }
+
+  sweepFile.close();
+  sweepRunning = false;
+
+  // The verdict reads off the largest block (the prefetch shape) and
+  // the worst burst seen anywhere in the sweep.
+  uint32_t worstMs = sweepMaxBurstUs / 1000;
+  bool pass = sweepSeqKbps[SWEEP_BLOCK_COUNT - 1] >= SD_BENCH_MIN_SEQ_KBPS &&
+              worstMs <= SD_BENCH_MAX_BURST_MS;
+  LOG_INFO("sdbench: sweep %s, seq %lu/%lu/%lu KB/s, worst burst %lu ms",
+           pass ? "PASS" : "FAIL", (unsigned long)sweepSeqKbps[0],
+           (unsigned long)sweepSeqKbps[1], (unsigned long)sweepSeqKbps[2],
+           (unsigned long)worstMs);
+  snprintf(reportJson, sizeof(reportJson),
+           "{\"phase\":\"sweep\",\"pass\":%s,\"block\":[4096,8192,16384],"
+           "\"seq_kbps\":[%lu,%lu,%lu],\"rand_max_ms\":[%lu,%lu,%lu],"
+           "\"burst_max_ms\":%lu}",
+           pass ? "true" : "false", (unsigned long)sweepSeqKbps[0],
+           (unsigned long)sweepSeqKbps[1], (unsigned long)sweepSeqKbps[2],
+           (unsigned long)sweepRandMaxMs[0], (unsigned long)sweepRandMaxMs[1],
+           (unsigned long)sweepRandMaxMs[2], (unsigned long)worstMs);
+  reportPending = true;
+}
+
+void sdBenchLoop() {
+  if (!sweepRunning) {
+    return;
+  }
+  // Lowest priority: a denied pass just slows the sweep down.
+  if (!sdIoBegin(SD_IO_SYNC)) {
+    return;
+  }
+  uint32_t block = SWEEP_BLOCKS[sweepBlockIndex];
+  if (!sweepRandomPhase) {
+    uint32_t us =
+        timedRead(sweepFile, sweepDataOffset + (sweepBytesDone % sweepSeqTarget),
+                  block);
+    sdIoEnd(SD_IO_SYNC);
+    if (us == 0) {
+      LOG_WARN("sdbench: read failed; sweep aborted");
+      sweepFile.close();
+      sweepRunning = false;
+      return;
+    }
+    sweepSeqUs += us;
+    if (us > sweepMaxBurstUs) {
+      sweepMaxBurstUs = us;
+    }
+    sweepBytesDone += block;
+    if (sweepBytesDone >= sweepSeqTarget) {
+      sweepSeqKbps[sweepBlockIndex] =
+          (uint32_t)(((uint64_t)sweepBytesDone * 1000000) / sweepSeqUs / 1024);
+      sweepRandomPhase = true;
+      sweepRandMaxMs[sweepBlockIndex] = 0;
+    }
+    return;
+  }
+
+  uint32_t us = timedRead(sweepFile, randomOffset(block), block);
+  sdIoEnd(SD_IO_SYNC);
+  if (us == 0) {
+    LOG_WARN("sdbench: read failed; sweep aborted");
+    sweepFile.close();
+    sweepRunning = false;
+    return;
+  }
+  if (us / 1000 > sweepRandMaxMs[sweepBlockIndex]) {
+    sweepRandMaxMs[sweepBlockIndex] = us / 1000;
+  }
+  if (us > sweepMaxBurstUs) {
+    sweepMaxBurstUs = us;
+  }
+  if (++sweepReadsDone >= SD_BENCH_SWEEP_RANDOM_READS) {
+    sweepNextBlock();
+  }
+}
+
+bool sdBenchCollect(char *json, size_t jsonLen) {
+  if (!reportPending) {
+    return false;
+  }
+  snprintf(json, jsonLen, "%s", reportJson);
+  reportPending = false;
+  return true;
+}
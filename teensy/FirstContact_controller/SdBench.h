@@ -0,0 +1,58 @@
+/*
+SdBench: on-device SD throughput benchmark and boot-time card verdict.
+
+The statues play whatever card a volunteer donates, and card quality
+varies wildly - a slow card has always been discovered as Saturday-night
+dropouts instead of at setup. This module measures the card where it
+matters, on the statue's own SDIO interface, and compares the numbers
+against the music pipeline's worst-case demand.
+
+Demand math: one 44.1 kHz stereo 16-bit stream is ~176 KB/s; a gapless
+song boundary briefly doubles it while both files prefetch, and the
+background classes (journal, recorder, sync) may take their arbiter
+budget - SD_IO_BUDGET_US of every window - on top. Stems play from the
+PSRAM cache and cost no steady SD bandwidth. The other axis is latency:
+a prefetch burst must complete well inside the streamer's ~186 ms of
+half-buffer slack. Hence the two-sided pass bar below.
+
+Two modes:
+ - Boot check (sdBenchBootCheck, run from musicMountLoop): a short
+   sequential run plus a handful of random reads against the largest
+   manifest song, with a PASS/FAIL verdict in the boot log. Costs tens
+   of milliseconds on a healthy card.
+ - Full sweep (missing_link/bench/cmd {"run":true}): sequential and
+   random reads across block sizes, advanced one burst per scheduler
+   pass at the arbiter's lowest priority, so it can run during a show
+   without touching playback.
+
+Either way the numbers publish once on missing_link/bench when MQTT is
+up, so the Pi keeps a per-card record.
+*/
+
+#ifndef SD_BENCH_H
+#define SD_BENCH_H
+
+#include <Arduino.h>
+
+// Pass bar, derived from the demand math above with ~5x margin on
+// throughput. Burst latency must leave slack under the streamer's
+// ~186 ms half buffer.
+#define SD_BENCH_MIN_SEQ_KBPS 1024
+#define SD_BENCH_MAX_BURST_MS 150
+
+// Quick verdict against the largest manifest song; logs PASS/FAIL and
+// queues the numbers for publish. Called once after the manifest scan.
+void sdBenchBootCheck();
+
+// Start the full block-size sweep (no-op if one is already running or
+// the card is not mounted).
+void sdBenchStart();
+
+// Scheduler task: advance a running sweep by one burst.
+void sdBenchLoop();
+
+// One-shot: copy the most recent finished report into `json` and clear
+// the pending flag. False when nothing new is waiting.
+bool sdBenchCollect(char *json, size_t jsonLen);
+
+#endif // SD_BENCH_H
@@ -0,0 +1,629 @@
+/*
+SdStream.cpp - Double-buffered SD streaming WAV player implementation.
+
+Handoff protocol between fillLoop() (main loop) and update() (audio ISR):
+  - update() owns the active half; when it drains it, it clears that half's
+    bufferReady flag and switches to the other half if ready.
+  - fillLoop() owns any half whose bufferReady flag is clear; it refills it
+    and sets the flag. The flags are single bytes, atomic on the Cortex-M7,
+    and each side only writes the flags it owns, so no lock is needed.
+*/
+
+#include "ImaAdpcm.h"
+#include "SdArbiter.h"
+#include "SdStream.h"
+#include "SongCache.h"
+#include "StorageStats.h"
+
+// The double buffer lives in DMAMEM (RAM2) so the SDIO DMA engine writes it
+// directly and the 512 KB of RAM1 stays free for code and audio blocks.
+DMAMEM uint8_t AudioPlaySdStream::buffers[2][SD_STREAM_BUFFER_SIZE];
+
+// ADPCM staging: one decoded source block, consumed across audio updates.
+int16_t AudioPlaySdStream::stagedLeft[2 * SONG_MAX_BLOCK_ALIGN];
+int16_t AudioPlaySdStream::stagedRight[2 * SONG_MAX_BLOCK_ALIGN];
+
+bool AudioPlaySdStream::play(const char *filename) {
+  stop();
+
+  file = SD.open(filename);
+  if (!file) {
+    storageRecordOpenError();
+    return false;
+  }
+  SongInfo header;
+  if (!parseWavHeader(file, header)) {
+    Serial.printf("SdStream: unsupported WAV: %s\n", filename);
+    file.close();
+    return false;
+  }
+  channels = header.channels;
+  codec = header.codec;
+  blockAlign = header.blockAlign;
+  samplesPerBlock = header.samplesPerBlock;
+  sampleRate = header.sampleRate;
+  dataRemaining = header.dataLength;
+  songDataLength = header.dataLength;
+  loopStart = 0; // smpl loops come from the manifest path only
+  loopEnd = 0;
+
+  // Prime both halves synchronously so playback starts with a full ~370 ms
+  // of slack; this is the only SD access on the start path.
+  bufferReady[0] = bufferReady[1] = false;
+  fillBuffer(0);
+  fillBuffer(1);
+  activeBuffer = 0;
+  bufferPos = 0;
+  playing = true;
+  return true;
+}
+
+bool AudioPlaySdStream::play(const SongInfo &song) {
+  stop();
+
+  // Fully cached in PSRAM: play the whole song from memory through the RAM
+  // source path, never touching the SD card.
+  const uint8_t *cached = songCacheLookup(song);
+  if (cached != nullptr) {
+    introPtr = cached;
+    introLen = song.dataLength;
+    introPos = 0;
+    introChannels = song.channels;
+    introCodec = song.codec;
+    introBlockAlign = song.blockAlign;
+    introRate = song.sampleRate;
+    channels = song.channels;
+    codec = song.codec;
+    blockAlign = song.blockAlign;
+    samplesPerBlock = song.samplesPerBlock;
+    sampleRate = song.sampleRate;
+    dataRemaining = 0;
+    songDataLength = song.dataLength;
+    loopStart = song.loopStartBytes;
+    loopEnd = song.loopEndBytes;
+    bufferReady[0] = bufferReady[1] = false;
+    bufferLen[0] = bufferLen[1] = 0;
+    activeBuffer = 0;
+    bufferPos = 0;
+    playing = true;
+    return true;
+  }
+
+  file = SD.open(song.filename);
+  if (!file) {
+    storageRecordOpenError();
+    return false;
+  }
+  // Header metadata comes from the boot-time manifest: seek straight to
+  // the first sample instead of re-walking the RIFF chunks.
+  channels = song.channels;
+  codec = song.codec;
+  blockAlign = song.blockAlign;
+  samplesPerBlock = song.samplesPerBlock;
+  sampleRate = song.sampleRate;
+  songDataLength = song.dataLength;
+  loopStart = song.loopStartBytes;
+  loopEnd = song.loopEndBytes;
+
+  if (song.intro != nullptr && song.introBytes > 0) {
+    // Instant start: the next audio update consumes the RAM intro while
+    // fillLoop() catches up from SD behind it. No SD read on this path.
+    introPtr = song.intro;
+    introLen = song.introBytes;
+    introPos = 0;
+    introChannels = song.channels;
+    introCodec = song.codec;
+    introBlockAlign = song.blockAlign;
+    introRate = song.sampleRate;
+    file.seek(song.dataOffset + song.introBytes);
+    dataRemaining = song.dataLength - song.introBytes;
+    bufferReady[0] = bufferReady[1] = false;
+    bufferLen[0] = bufferLen[1] = 0;
+    activeBuffer = 0;
+    bufferPos = 0;
+    playing = true;
+    return true;
+  }
+
+  file.seek(song.dataOffset);
+  dataRemaining = song.dataLength;
+
+  bufferReady[0] = bufferReady[1] = false;
+  fillBuffer(0);
+  fillBuffer(1);
+  activeBuffer = 0;
+  bufferPos = 0;
+  playing = true;
+  return true;
+}
+
+bool AudioPlaySdStream::play(const SongInfo &song, uint32_t resumeOffset) {
+  // Offsets come from position(), but align defensively - a mid-block seek
+  // would desynchronize the ADPCM predictor (and PCM frame phase).
+  resumeOffset -= resumeOffset % song.blockAlign;
+  if (resumeOffset == 0 || resumeOffset >= song.dataLength) {
+    return play(song);
+  }
+  stop();
+
+  // Fully cached: resume from the PSRAM copy through the RAM source path.
+  const uint8_t *cached = songCacheLookup(song);
+  if (cached != nullptr) {
+    introPtr = cached + resumeOffset;
+    introLen = song.dataLength - resumeOffset;
+    introPos = 0;
+    introChannels = song.channels;
+    introCodec = song.codec;
+    introBlockAlign = song.blockAlign;
+    introRate = song.sampleRate;
+    channels = song.channels;
+    codec = song.codec;
+    blockAlign = song.blockAlign;
+    samplesPerBlock = song.samplesPerBlock;
+    sampleRate = song.sampleRate;
+    dataRemaining = 0;
+    songDataLength = song.dataLength;
+    loopStart = song.loopStartBytes;
+    loopEnd = song.loopEndBytes;
+    bufferReady[0] = bufferReady[1] = false;
+    bufferLen[0] = bufferLen[1] = 0;
+    activeBuffer = 0;
+    bufferPos = 0;
+    playing = true;
+    return true;
+  }
+
+  file = SD.open(song.filename);
+  if (!file) {
+    storageRecordOpenError();
+    return false;
+  }
+  // Seek straight into the data chunk; the RAM intro only covers the first
+  // INTRO_PRELOAD_MS of the song, so a resume always streams from SD.
+  channels = song.channels;
+  codec = song.codec;
+  blockAlign = song.blockAlign;
+  samplesPerBlock = song.samplesPerBlock;
+  sampleRate = song.sampleRate;
+  songDataLength = song.dataLength;
+  loopStart = song.loopStartBytes;
+  loopEnd = song.loopEndBytes;
+  file.seek(song.dataOffset + resumeOffset);
+  dataRemaining = song.dataLength - resumeOffset;
+
+  bufferReady[0] = bufferReady[1] = false;
+  fillBuffer(0);
+  fillBuffer(1);
+  activeBuffer = 0;
+  bufferPos = 0;
+  playing = true;
+  return true;
+}
+
+uint32_t AudioPlaySdStream::position() {
+  if (!playing) {
+    return 0;
+  }
+  // Everything not yet played: unread file bytes, filled-but-unconsumed
+  // buffer halves, and the unconsumed tail of a RAM intro/cache source.
+  // Consistent snapshot versus the audio update.
+  __disable_irq();
+  uint32_t unplayed = dataRemaining;
+  for (uint8_t i = 0; i < 2; i++) {
+    if (bufferReady[i]) {
+      unplayed += bufferLen[i] - (i == activeBuffer ? bufferPos : 0);
+    }
+  }
+  if (introPos < introLen) {
+    unplayed += introLen - introPos;
+  }
+  __enable_irq();
+  if (unplayed >= songDataLength) {
+    return 0;
+  }
+  return songDataLength - unplayed;
+}
+
+void AudioPlaySdStream::stop() {
+  if (playing) {
+    __disable_irq();
+    playing = false;
+    __enable_irq();
+  }
+  if (file) {
+    file.close();
+  }
+  bufferReady[0] = bufferReady[1] = false;
+  dataRemaining = 0;
+  introPtr = nullptr;
+  introPos = 0;
+  introLen = 0;
+  stagedCount = 0;
+  stagedPos = 0;
+  looping = false;
+  resetResampler();
+
+  // A preload is tied to the playlist position at the time it was made;
+  // a stop invalidates it (the state machine re-decides what plays next).
+  if (nextFile) {
+    nextFile.close();
+  }
+  nextLoaded = false;
+  advanced = false;
+}
+
+bool AudioPlaySdStream::preload(const char *filename) {
+  if (nextFile) {
+    nextFile.close();
+    nextLoaded = false;
+  }
+  nextFile = SD.open(filename);
+  if (!nextFile) {
+    storageRecordOpenError();
+    return false;
+  }
+  SongInfo header;
+  if (!parseWavHeader(nextFile, header)) {
+    nextFile.close();
+    return false;
+  }
+  nextChannels = header.channels;
+  nextCodec = header.codec;
+  nextBlockAlign = header.blockAlign;
+  nextSamplesPerBlock = header.samplesPerBlock;
+  nextRate = header.sampleRate;
+  nextDataRemaining = header.dataLength;
+  nextLoaded = true;
+  return true;
+}
+
+bool AudioPlaySdStream::preload(const SongInfo &song) {
+  if (nextFile) {
+    nextFile.close();
+    nextLoaded = false;
+  }
+  nextFile = SD.open(song.filename);
+  if (!nextFile) {
+    storageRecordOpenError();
+    return false;
+  }
+  nextFile.seek(song.dataOffset);
+  nextChannels = song.channels;
+  nextCodec = song.codec;
+  nextBlockAlign = song.blockAlign;
+  nextSamplesPerBlock = song.samplesPerBlock;
+  nextRate = song.sampleRate;
+  nextDataRemaining = song.dataLength;
+  nextLoaded = true;
+  return true;
+}
+
+bool AudioPlaySdStream::consumedPreload() {
+  if (!advanced) {
+    return false;
+  }
+  advanced = false;
+  return true;
+}
+
+void AudioPlaySdStream::fillBuffer(uint8_t index) {
+  // Current file exhausted: chain into the preloaded next song so the
+  // buffer sequence crosses the song boundary without a gap. When the
+  // current song plays from RAM (cache hit), wait until the RAM copy is
+  // consumed before chaining, or the successor would start early.
+  if (dataRemaining == 0 && nextLoaded && introPos >= introLen) {
+    file.close();
+    file = nextFile;
+    nextFile = File();
+    channels = nextChannels;
+    codec = nextCodec;
+    blockAlign = nextBlockAlign;
+    samplesPerBlock = nextSamplesPerBlock;
+    sampleRate = nextRate;
+    dataRemaining = nextDataRemaining;
+    songDataLength = nextDataRemaining;
+    nextLoaded = false;
+    advanced = true;
+  }
+
+  // Armed loop: wrap the fill position back to the loop start when it
+  // reaches the loop end. The buffer chain crosses the wrap like any
+  // other half boundary, so the audio side never notices, and the seek
+  // stays inside the open file - no directory I/O in steady state.
+  if (looping && file) {
+    uint32_t fillPos = songDataLength - dataRemaining;
+    if (fillPos + blockAlign > loopEnd) {
+      file.seek(file.position() - (fillPos - loopStart));
+      dataRemaining = songDataLength - loopStart;
+    }
+  }
+
+  uint32_t toRead = dataRemaining;
+  if (toRead > SD_STREAM_BUFFER_SIZE) {
+    toRead = SD_STREAM_BUFFER_SIZE;
+  }
+  if (looping) {
+    // Never read past the loop end; the next fill wraps.
+    uint32_t untilWrap = loopEnd - (songDataLength - dataRemaining);
+    if (toRead > untilWrap) {
+      toRead = untilWrap;
+    }
+  }
+  // Whole source blocks only, so a decode never straddles a half boundary.
+  toRead -= toRead % blockAlign;
+  if (toRead == 0) {
+    return;
+  }
+  // Time the read for the SD health telemetry (StorageStats.h).
+  uint32_t started = micros();
+  int got = file.read(buffers[index], toRead);
+  storageRecordRead(micros() - started, got, toRead);
+  if (got <= 0) {
+    dataRemaining = 0;
+    return;
+  }
+  dataRemaining -= got;
+  bufferLen[index] = got;
+  bufferChannels[index] = channels;
+  bufferCodec[index] = codec;
+  bufferBlockAlign[index] = blockAlign;
+  bufferRate[index] = sampleRate;
+  bufferReady[index] = true;
+}
+
+void AudioPlaySdStream::fillLoop() {
+  if (!playing || (dataRemaining == 0 && !nextLoaded)) {
+    return;
+  }
+  for (uint8_t i = 0; i < 2; i++) {
+    if (!bufferReady[i] && i != activeBuffer) {
+      // Prefetch is the top-priority card user (SdArbiter.h): bracketing
+      // the read charges its time to the service window so background
+      // consumers yield for the rest of it. The grant only fails under
+      // an injected SD stall (FaultInject.h), which is exactly when the
+      // read must be skipped for the underrun path to be exercised.
+      if (sdIoBegin(SD_IO_PLAYBACK)) {
+        fillBuffer(i);
+        sdIoEnd(SD_IO_PLAYBACK);
+      }
+    }
+  }
+}
+
+// One sample to the graph's 16-bit format. 24/32-bit sources keep the top
+// 16 bits after adding TPDF dither (difference of two uniform randoms, one
+// target LSB peak-to-peak) from a 32-bit LCG, so quantization of quiet
+// material turns into a noise floor ~96 dB down instead of correlated
+// stepping. PCM16 is a straight assemble.
+static inline int16_t convertSample(const uint8_t *p, uint8_t codec,
+                                    uint32_t &seed) {
+  if (codec == SONG_CODEC_PCM16) {
+    return (int16_t)(p[0] | (p[1] << 8));
+  }
+  // Sign-extended sample scaled to 24 bits.
+  int32_t s;
+  if (codec == SONG_CODEC_PCM24) {
+    s = (int32_t)((uint32_t)p[0] << 8 | (uint32_t)p[1] << 16 |
+                  (uint32_t)p[2] << 24) >> 8;
+  } else {
+    s = (int32_t)((uint32_t)p[0] | (uint32_t)p[1] << 8 |
+                  (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24) >> 8;
+  }
+  seed = seed * 1664525u + 1013904223u;
+  s += (int32_t)(seed & 0xFF) - (int32_t)((seed >> 8) & 0xFF);
+  s >>= 8;
+  if (s > 32767) {
+    s = 32767;
+  } else if (s < -32768) {
+    s = -32768;
+  }
+  return (int16_t)s;
+}
+
+// Pull one frame (a sample per channel) at the source rate: decoded ADPCM
+// staging first, then the RAM intro, then the double buffer.
+AudioPlaySdStream::SourceStatus AudioPlaySdStream::sourceFrame(int16_t *l,
+                                                               int16_t *r) {
+  while (true) {
+    // Decoded ADPCM samples waiting in staging are consumed first.
+    if (stagedPos < stagedCount) {
+      int16_t sampleLeft = stagedLeft[stagedPos];
+      *l = sampleLeft;
+      *r = stagedMono ? sampleLeft : stagedRight[stagedPos];
+      stagedPos++;
+      return FRAME_OK;
+    }
+
+    // Cold start: consume the RAM intro before touching the double buffer.
+    if (introPos < introLen) {
+      // Armed loop on a fully cached song (introLen spans the whole data
+      // chunk): the wrap is just a cursor jump in RAM.
+      if (looping && introLen == songDataLength && introPos >= loopEnd) {
+        introPos = loopStart;
+      }
+      if (introCodec == SONG_CODEC_IMA_ADPCM) {
+        stagedCount = imaAdpcmDecodeBlock(introPtr + introPos, introBlockAlign,
+                                          introChannels, stagedLeft,
+                                          stagedRight);
+        stagedPos = 0;
+        stagedMono = (introChannels == 1);
+        stagedRate = introRate;
+        introPos += introBlockAlign;
+        continue; // Served from staging on the next pass.
+      }
+      const uint8_t *frame = introPtr + introPos;
+      uint8_t width = introBlockAlign / introChannels;
+      int16_t sampleLeft = convertSample(frame, introCodec, ditherSeed);
+      *l = sampleLeft;
+      *r = (introChannels == 2)
+               ? convertSample(frame + width, introCodec, ditherSeed)
+               : sampleLeft;
+      introPos += introBlockAlign;
+      return FRAME_OK;
+    }
+
+    if (bufferPos >= bufferLen[activeBuffer]) {
+      // Active half drained: release it to fillLoop() and switch.
+      bufferReady[activeBuffer] = false;
+      activeBuffer ^= 1;
+      bufferPos = 0;
+      if (!bufferReady[activeBuffer]) {
+        // Nothing to switch to: end of song if there is no more data and
+        // no preloaded successor, otherwise an underrun.
+        return (dataRemaining == 0 && !nextLoaded) ? FRAME_END
+                                                   : FRAME_STARVED;
+      }
+    }
+
+    // The source format can change at a half boundary when the buffer
+    // chain crosses into a preloaded song, so it is per-half state.
+    uint8_t frameChannels = bufferChannels[activeBuffer];
+    if (bufferCodec[activeBuffer] == SONG_CODEC_IMA_ADPCM) {
+      stagedCount = imaAdpcmDecodeBlock(&buffers[activeBuffer][bufferPos],
+                                        bufferBlockAlign[activeBuffer],
+                                        frameChannels, stagedLeft,
+                                        stagedRight);
+      stagedPos = 0;
+      stagedMono = (frameChannels == 1);
+      stagedRate = bufferRate[activeBuffer];
+      bufferPos += bufferBlockAlign[activeBuffer];
+      continue; // Served from staging on the next pass.
+    }
+    const uint8_t *frame = &buffers[activeBuffer][bufferPos];
+    uint8_t codecHere = bufferCodec[activeBuffer];
+    uint8_t width = bufferBlockAlign[activeBuffer] / frameChannels;
+    int16_t sampleLeft = convertSample(frame, codecHere, ditherSeed);
+    *l = sampleLeft;
+    *r = (frameChannels == 2)
+             ? convertSample(frame + width, codecHere, ditherSeed)
+             : sampleLeft;
+    bufferPos += bufferBlockAlign[activeBuffer];
+    return FRAME_OK;
+  }
+}
+
+// Sample rate of the next frame sourceFrame() will deliver.
+uint32_t AudioPlaySdStream::pendingRate() {
+  if (stagedPos < stagedCount) {
+    return stagedRate;
+  }
+  if (introPos < introLen) {
+    return introRate;
+  }
+  return bufferRate[activeBuffer];
+}
+
+void AudioPlaySdStream::resetResampler() {
+  rsAcc = 0;
+  rsPending = FRAME_OK;
+  for (int i = 0; i < RESAMPLE_TAPS; i++) {
+    rsHistL[i] = rsHistR[i] = 0;
+  }
+}
+
+// One 44.1 kHz output sample from a 48 kHz source: evaluate the filter
+// phase at the current inter-frame position, then advance 160/147 of a
+// source period and pull the frames the position crossed (one, sometimes
+// two). The ratio is exact, so there is no drift term.
+AudioPlaySdStream::SourceStatus AudioPlaySdStream::resampleFrame(int16_t *l,
+                                                                 int16_t *r) {
+  // END/STARVED found while pulling ahead applies to this output sample.
+  if (rsPending != FRAME_OK) {
+    SourceStatus st = (SourceStatus)rsPending;
+    if (st == FRAME_STARVED) {
+      rsPending = FRAME_OK; // A starved stream can refill and resume.
+    }
+    return st;
+  }
+
+  const int16_t *h = RESAMPLE_BANK.h[rsAcc];
+  int32_t accL = 0;
+  int32_t accR = 0;
+  for (int k = 0; k < RESAMPLE_TAPS; k++) {
+    accL += (int32_t)h[k] * rsHistL[k];
+    accR += (int32_t)h[k] * rsHistR[k];
+  }
+  accL >>= 15;
+  accR >>= 15;
+  if (accL > 32767) {
+    accL = 32767;
+  } else if (accL < -32768) {
+    accL = -32768;
+  }
+  if (accR > 32767) {
+    accR = 32767;
+  } else if (accR < -32768) {
+    accR = -32768;
+  }
+  *l = (int16_t)accL;
+  *r = (int16_t)accR;
+
+  rsAcc += RESAMPLE_M;
+  while (rsAcc >= RESAMPLE_L) {
+    rsAcc -= RESAMPLE_L;
+    int16_t sl, sr;
+    SourceStatus st = sourceFrame(&sl, &sr);
+    if (st != FRAME_OK) {
+      rsPending = st;
+      break;
+    }
+    for (int k = 0; k < RESAMPLE_TAPS - 1; k++) {
+      rsHistL[k] = rsHistL[k + 1];
+      rsHistR[k] = rsHistR[k + 1];
+    }
+    rsHistL[RESAMPLE_TAPS - 1] = sl;
+    rsHistR[RESAMPLE_TAPS - 1] = sr;
+  }
+  return FRAME_OK;
+}
+
+void AudioPlaySdStream::update(void) {
+  if (!playing) {
+    return;
+  }
+
+  audio_block_t *left = allocate();
+  if (!left) {
+    return;
+  }
+  audio_block_t *right = allocate();
+  if (!right) {
+    release(left);
+    return;
+  }
+
+  bool starved = false;
+
+  for (int i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+    int16_t l, r;
+    // 48 kHz sources run through the polyphase stage; native-rate
+    // sources copy straight through.
+    SourceStatus st = (pendingRate() == RESAMPLE_SRC_RATE)
+                          ? resampleFrame(&l, &r)
+                          : sourceFrame(&l, &r);
+    if (st != FRAME_OK) {
+      // End of song, or an underrun: pad with silence and keep going.
+      if (st == FRAME_END) {
+        playing = false;
+      } else {
+        starved = true;
+      }
+      for (; i < AUDIO_BLOCK_SAMPLES; i++) {
+        left->data[i] = 0;
+        right->data[i] = 0;
+      }
+      break;
+    }
+    left->data[i] = l;
+    right->data[i] = r;
+  }
+
+  if (starved) {
+    underruns++;
+  }
+
+  transmit(left, 0);
+  transmit(right, 1);
+  release(left);
+  release(right);
+}
@@ -0,0 +1,227 @@
+/*
+SdStream: Double-buffered SD streaming WAV player.
+
+AudioPlaySdWav reads the SD card from inside the audio update cycle, so an
+MQTT burst or a long OLED I2C transfer that delays its turn starves the read
+and drops audio. This player decouples the two: fillLoop() (called from the
+main loop) prefetches 32 KB chunks into a double buffer in DMAMEM - the SDIO
+driver moves the data by DMA - and the audio update only consumes samples
+already in RAM. A stall anywhere in loop() now has a full buffer (~180 ms of
+stereo audio) of slack before it can be heard.
+
+Supports 16-bit PCM WAV (the original production format) and 4-bit IMA
+ADPCM WAV (format tag 0x11), which cuts SD bandwidth ~4x; ADPCM blocks
+are decoded into a PCM staging buffer inside the audio update - a few
+integer ops per sample, cheap on the M7 while the SD bus is the scarce
+resource. 24- and 32-bit PCM masters also play directly: samples convert
+to the graph's 16 bits on the fly with TPDF dither at the target LSB, so
+quiet fades decorrelate instead of hard-stepping and no transcode pass
+is needed before deployment. Mono or stereo; outputs are (left, right)
+like AudioPlaySdWav and mono files play on both.
+
+48 kHz sources play at pitch through a fixed-point polyphase resampler
+(ResampleTables.h): the audio update pulls source frames as the output
+position crosses them - 160 frames per 147 outputs, exact by construction
+- and evaluates one precomputed filter phase per output sample. The rate
+rides with the data like the codec does, so a buffer chain can cross from
+a 44.1 kHz song into a 48 kHz one (or back) at a half boundary.
+
+Seamless looping: setLooping() arms the manifest's smpl-chunk loop points
+for the playing song. The wrap happens on the fill side - when the fill
+position reaches the loop end it seeks back to the loop start, and the
+buffer chain crosses the wrap like any other half boundary - or, for a
+PSRAM-cached song, as a cursor jump in the RAM source. Either way the
+audio side never notices and there is no steady-state directory I/O: the
+dormant tracks can hold one loop all night.
+
+Gapless transitions: preload() opens and parses the next song while the
+current one plays. When the current file is exhausted, fillLoop() keeps
+filling freed buffer halves from the preloaded file, so the buffer chain
+crosses the song boundary and playback never stops - no file-open, header
+parse, or first-buffer-fill gap. consumedPreload() reports the handover
+once so the song index bookkeeping in MusicPlayer.ino can advance.
+*/
+
+#ifndef SD_STREAM_H
+#define SD_STREAM_H
+
+#include "ResampleTables.h"
+#include "SongManifest.h"
+
+#include <Audio.h>
+#include <SD.h>
+
+// Each half of the double buffer. 32 KB holds ~186 ms of stereo 44.1 kHz
+// audio, and SDIO reads of this size run at the card's full sequential rate.
+#define SD_STREAM_BUFFER_SIZE 32768
+
+class AudioPlaySdStream : public AudioStream {
+public:
+  AudioPlaySdStream() : AudioStream(0, NULL) {
+    playing = false;
+    activeBuffer = 0;
+    bufferPos = 0;
+    bufferLen[0] = bufferLen[1] = 0;
+    bufferReady[0] = bufferReady[1] = false;
+    dataRemaining = 0;
+    songDataLength = 0;
+    channels = 2;
+    codec = SONG_CODEC_PCM16;
+    blockAlign = 4;
+    samplesPerBlock = 1;
+    bufferChannels[0] = bufferChannels[1] = 2;
+    bufferCodec[0] = bufferCodec[1] = SONG_CODEC_PCM16;
+    bufferBlockAlign[0] = bufferBlockAlign[1] = 4;
+    underruns = 0;
+    nextLoaded = false;
+    nextChannels = 2;
+    nextCodec = SONG_CODEC_PCM16;
+    nextBlockAlign = 4;
+    nextSamplesPerBlock = 1;
+    nextDataRemaining = 0;
+    advanced = false;
+    introPtr = NULL;
+    introPos = 0;
+    introLen = 0;
+    introChannels = 2;
+    introCodec = SONG_CODEC_PCM16;
+    introBlockAlign = 4;
+    stagedCount = 0;
+    stagedPos = 0;
+    stagedMono = false;
+    sampleRate = 44100;
+    introRate = 44100;
+    nextRate = 44100;
+    stagedRate = 44100;
+    bufferRate[0] = bufferRate[1] = 44100;
+    rsAcc = 0;
+    rsPending = 0;
+    ditherSeed = 0x2545F491u;
+    loopStart = 0;
+    loopEnd = 0;
+    looping = false;
+    for (int i = 0; i < RESAMPLE_TAPS; i++) {
+      rsHistL[i] = rsHistR[i] = 0;
+    }
+  }
+
+  // Open, parse the header, prime both buffers, and start. Returns false if
+  // the file is missing or not a supported format (see parseWavHeader()).
+  bool play(const char *filename);
+
+  // Manifest variant: the header was parsed at boot, so this seeks straight
+  // to the cached data offset - no chunk walk on the start path. If the
+  // song has a RAM intro, playback starts from it on the next audio update
+  // with no SD access at all; the streamer seeks past the intro and the
+  // double buffer splices in seamlessly behind it.
+  bool play(const SongInfo &song);
+
+  // Resume variant: start `resumeOffset` bytes into the data chunk (as
+  // previously reported by position()), skipping the intro path.
+  bool play(const SongInfo &song, uint32_t resumeOffset);
+  void stop();
+
+  // Byte offset within the data chunk of the sample about to play next
+  // (approximate to within the staging granularity). Recorded at fade-out
+  // so a quick re-link can resume where the song stopped.
+  uint32_t position();
+  bool isPlaying() { return playing; }
+
+  // Hold the current song's smpl loop instead of playing to the end.
+  // A no-op for songs without loop metadata; cleared by stop()/play().
+  void setLooping(bool enable) { looping = enable && loopEnd > loopStart; }
+  bool isLooping() { return looping; }
+
+  // Refill any consumed buffer half from the SD card; called from the main
+  // loop, never from the audio update.
+  void fillLoop();
+
+  // Open and parse the next song while the current one plays. Replaces any
+  // previous preload. Returns false if the file is missing or unsupported.
+  bool preload(const char *filename);
+  bool preload(const SongInfo &song);
+  bool hasPreload() { return nextLoaded; }
+
+  // True exactly once after the stream hands over to the preloaded song.
+  bool consumedPreload();
+
+  virtual void update(void);
+
+private:
+  // What one pull from the source chain (staging -> intro -> buffer) got.
+  enum SourceStatus { FRAME_OK, FRAME_END, FRAME_STARVED };
+
+  void fillBuffer(uint8_t index);
+  SourceStatus sourceFrame(int16_t *l, int16_t *r);
+  SourceStatus resampleFrame(int16_t *l, int16_t *r);
+  uint32_t pendingRate();
+  void resetResampler();
+
+  File file;
+  volatile bool playing;
+  uint8_t channels;
+  uint8_t codec;            // SONG_CODEC_* of the file being read
+  uint16_t blockAlign;      // Source bytes per frame (PCM) or block (ADPCM)
+  uint16_t samplesPerBlock;
+  uint32_t sampleRate;      // Source rate of the file being read
+  uint32_t dataRemaining; // Unread bytes left in the data chunk
+  uint32_t songDataLength; // Data chunk length of the current song
+
+  // Loop points of the current song (byte offsets into the data chunk;
+  // loopEnd 0 = none) and whether the loop is armed.
+  uint32_t loopStart;
+  uint32_t loopEnd;
+  volatile bool looping;
+
+  // Decoded-PCM staging for ADPCM sources: one source block decoded at a
+  // time, consumed sample-by-sample by update(). Empty for PCM sources.
+  static int16_t stagedLeft[2 * SONG_MAX_BLOCK_ALIGN];
+  static int16_t stagedRight[2 * SONG_MAX_BLOCK_ALIGN];
+  volatile uint16_t stagedCount;
+  volatile uint16_t stagedPos;
+  bool stagedMono;
+  uint32_t stagedRate; // Source rate of the block staging was decoded from
+
+  // RAM intro being consumed before the double buffer (cold starts only;
+  // gapless chains read the whole successor from SD).
+  const uint8_t *introPtr;
+  volatile uint32_t introPos;
+  uint32_t introLen;
+  uint8_t introChannels;
+  uint8_t introCodec;
+  uint16_t introBlockAlign;
+  uint32_t introRate;
+
+  File nextFile; // Preloaded next song (already past its header)
+  uint8_t nextChannels;
+  uint8_t nextCodec;
+  uint16_t nextBlockAlign;
+  uint16_t nextSamplesPerBlock;
+  uint32_t nextDataRemaining;
+  uint32_t nextRate;
+  bool nextLoaded;
+  bool advanced; // Set when fillLoop() chains into the preload
+
+  static uint8_t buffers[2][SD_STREAM_BUFFER_SIZE];
+  volatile uint32_t bufferLen[2]; // Valid bytes in each half
+  volatile bool bufferReady[2];   // Half is filled and unconsumed
+  // Source format of the data in each half (it can change at a half
+  // boundary when the buffer chain crosses into a preloaded song).
+  uint8_t bufferChannels[2];
+  uint8_t bufferCodec[2];
+  uint16_t bufferBlockAlign[2];
+  uint32_t bufferRate[2];
+  volatile uint8_t activeBuffer;  // Half the audio update is consuming
+  volatile uint32_t bufferPos;    // Consume offset within the active half
+  uint32_t underruns;             // Blocks of silence emitted while starved
+
+  // Polyphase resampler state for 48 kHz sources (ResampleTables.h).
+  int16_t rsHistL[RESAMPLE_TAPS]; // Most recent source frames, newest last
+  int16_t rsHistR[RESAMPLE_TAPS];
+  uint16_t rsAcc;    // Output position between source frames, in 1/147ths
+  uint8_t rsPending; // END/STARVED found while pulling ahead (SourceStatus)
+
+  uint32_t ditherSeed; // LCG state for the 24/32-bit TPDF dither
+};
+
+#endif // SD_STREAM_H
@@ -0,0 +1,117 @@
+/*
+SelfTest.cpp - codec readback and tone loopback. See SelfTest.h.
+
+Runs once at boot, so all FLASHMEM (placement notes in MemMonitor.h).
+*/
+
+#include "SelfTest.h"
+
+#include <Wire.h>
+
+#include "AudioSense.h"
+#include "Log.h"
+#include "StatueConfig.h"
+
+// SGTL5000 on the audio shield: I2C address with CTRL_ADR0_CS low, and
+// the CHIP_ID register (upper byte 0xA0, lower byte the revision).
+#define SGTL5000_I2C_ADDR 0x0A
+#define SGTL5000_CHIP_ID_REG 0x0000
+#define SGTL5000_CHIP_ID_PART 0xA0
+
+// Long enough for the probe detector's window to fill plus input-chain
+// settling; short enough not to bother the boot budget.
+#define SELFTEST_DWELL_MS 150
+
+// Minimum probe magnitude that counts as a live loopback path. The
+// output-to-input coupling through the statue wiring sits well above
+// this at full amplitude on every statue measured; a dead codec or
+// unseated shield reads essentially zero.
+#define SELFTEST_LOOPBACK_MIN 0.002f
+
+// Keep the probe at least this far from every active statue bin so the
+// test tone cannot brush a real detector (or its guards).
+#define SELFTEST_PROBE_CLEARANCE_HZ 500
+
+static bool ran = false;
+static bool codecOk = false;
+static bool loopbackOk = false;
+static uint16_t chipId = 0;
+static float loopbackMag = 0.0f;
+static int probeFreq = 0;
+
+// Read the codec's CHIP_ID over I2C. The register address is 16-bit.
+FLASHMEM static bool readCodecId(uint16_t *id) {
+  Wire.beginTransmission(SGTL5000_I2C_ADDR);
+  Wire.write((uint8_t)(SGTL5000_CHIP_ID_REG >> 8));
+  Wire.write((uint8_t)(SGTL5000_CHIP_ID_REG & 0xFF));
+  if (Wire.endTransmission(false) != 0) {
+    return false;
+  }
+  if (Wire.requestFrom(SGTL5000_I2C_ADDR, 2) != 2) {
+    return false;
+  }
+  *id = ((uint16_t)Wire.read() << 8) | (uint16_t)Wire.read();
+  return true;
+}
+
+// First candidate frequency clear of every active statue bin.
+FLASHMEM static int pickProbeFreq() {
+  static const int candidates[] = {6150, 7350, 8550, 11250, 15750};
+  for (size_t c = 0; c < sizeof(candidates) / sizeof(candidates[0]); c++) {
+    bool clear = true;
+    for (int i = 0; i < NUM_STATUES; i++) {
+      if (abs(candidates[c] - STATUE_FREQUENCIES[i]) <
+          SELFTEST_PROBE_CLEARANCE_HZ) {
+        clear = false;
+        break;
+      }
+    }
+    if (clear) {
+      return candidates[c];
+    }
+  }
+  return candidates[0];
+}
+
+FLASHMEM bool selfTestRun() {
+  codecOk = readCodecId(&chipId) &&
+            ((chipId >> 8) == SGTL5000_CHIP_ID_PART);
+
+  // Park the tone and the sweep probe on the same clear frequency, let
+  // the window fill, and read what came back through the wiring.
+  probeFreq = pickProbeFreq();
+  setSenseToneFrequency(probeFreq);
+  tuneSweepProbe(probeFreq);
+  delay(SELFTEST_DWELL_MS);
+  loopbackMag = readSweepProbe();
+  loopbackOk = loopbackMag >= SELFTEST_LOOPBACK_MIN;
+
+  // Put the TX tone and detector 0 back the way configureDetectors
+  // wants them.
+  retuneAudioSense();
+
+  ran = true;
+  if (codecOk && loopbackOk) {
+    Serial.printf("  Self-test OK: codec 0x%04X, loopback %.4f @ %d Hz\n",
+                  chipId, (double)loopbackMag, probeFreq);
+  } else {
+    LOG_ERROR("self-test FAIL: codec %s (0x%04X) loopback %s (%.4f)",
+              codecOk ? "ok" : "DEAD", chipId, loopbackOk ? "ok" : "SILENT",
+              (double)loopbackMag);
+  }
+  return codecOk && loopbackOk;
+}
+
+FLASHMEM bool selfTestCollect(char *json, size_t jsonLen) {
+  if (!ran) {
+    return false;
+  }
+  int len = snprintf(json, jsonLen,
+                     "{\"pass\":%s,\"codec\":%s,\"chip\":\"0x%04X\","
+                     "\"loopback\":%s,\"mag\":%.4f,\"probe\":%d}",
+                     (codecOk && loopbackOk) ? "true" : "false",
+                     codecOk ? "true" : "false", chipId,
+                     loopbackOk ? "true" : "false", (double)loopbackMag,
+                     probeFreq);
+  return len > 0 && (size_t)len < jsonLen;
+}
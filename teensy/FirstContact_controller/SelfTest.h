@@ -0,0 +1,33 @@
+/*
+SelfTest: boot-time audio loopback and codec check.
+
+A dead SGTL5000 or an unseated audio shield used to present as "statue
+never links" and cost an hour of cable-wiggling before anyone suspected
+the board. Boot now proves the whole analog path in ~200 ms: the codec
+answers on I2C with its chip id, then the sense tone is parked on a
+probe frequency clear of every statue bin and the sweep probe detector
+listens for it - the output-to-input coupling through the statue wiring
+makes the tone measurable on audioIn whenever the codec, the shield
+seating, and the input chain are alive. The result (pass/fail plus the
+measured level) rides the missing_link/boot report and the serial log,
+so a silent hardware failure is a two-second diagnosis.
+
+Runs inside audioSenseSetup(), after the tone and detectors are
+configured but before the open-circuit calibration window starts, so
+the probe tone never trains the noise floors.
+*/
+
+#ifndef SELF_TEST_H
+#define SELF_TEST_H
+
+#include <Arduino.h>
+
+// Run the codec + loopback check (blocking, ~200 ms). Returns overall
+// pass; details are kept for the boot report.
+bool selfTestRun();
+
+// Fill `json` with the result object for the boot report. Returns false
+// before selfTestRun() has run or on overflow.
+bool selfTestCollect(char *json, size_t jsonLen);
+
+#endif // SELF_TEST_H
@@ -0,0 +1,48 @@
+/*
+SignalSnapshot.cpp - Versioned double-buffered snapshot implementation
+*/
+
+#include "SignalSnapshot.h"
+
+#include <stdio.h>
+
+// Double buffer plus a version counter. The writer fills the inactive
+// buffer, then bumps the version; even versions mean buffer 0 is active,
+// odd versions mean buffer 1. A reader that observes the version change
+// across its copy simply retries - the writer runs at most every few ms,
+// so a second pass always succeeds in practice.
+static SignalSnapshot buffers[2];
+static volatile uint32_t version = 0;
+
+void updateSignalSnapshot(const SignalSnapshot &snapshot) {
+  uint32_t v = version;
+  SignalSnapshot &inactive = buffers[(v + 1) & 1];
+  inactive = snapshot;
+  version = v + 1;
+}
+
+void readSignalSnapshot(SignalSnapshot &out) {
+  while (true) {
+    uint32_t before = version;
+    out = buffers[before & 1];
+    if (version == before) {
+      return;
+    }
+  }
+}
+
+void formatSignalCompact(char *buf, size_t buflen, float value,
+                         float threshold) {
+  // Precision follows the threshold: 3 decimals if its third decimal is
+  // non-zero, else 2. This matches the historical OLED formatting.
+  int value_3dec = (int)(threshold * 1000 + 0.5);
+  int precision = (value_3dec % 10 != 0) ? 3 : 2;
+  int multiplier = (precision == 2) ? 100 : 1000;
+
+  int value_int = (int)(value * multiplier + 0.5); // Round to nearest
+  if (precision == 2) {
+    snprintf(buf, buflen, ".%02d", value_int);
+  } else {
+    snprintf(buf, buflen, ".%03d", value_int);
+  }
+}
@@ -0,0 +1,46 @@
+/*
+SignalSnapshot: Lock-free hand-off of per-detector signal data.
+
+detectorSignals[] and friends are written from the sense timer context and
+read concurrently by displaySignals() (Display.ino) and publishSignals()
+(Messaging.ino). Readers used to pull the live arrays with no
+synchronization and could see torn, mid-update sets. The writer now
+publishes a versioned double-buffered snapshot with a seqlock-style version
+counter; readers copy the active buffer and retry if the version moved
+underneath them.
+
+The compact fixed-point formatter the OLED uses also lives here so Display
+and Messaging share one float-to-string implementation instead of two.
+*/
+
+#ifndef SIGNAL_SNAPSHOT_H
+#define SIGNAL_SNAPSHOT_H
+
+#include <Arduino.h>
+
+#include "StatueConfig.h"
+
+struct SignalSnapshot {
+  float signals[MAX_STATUES - 1];    // Raw magnitudes (max across channels)
+  float floors[MAX_STATUES - 1];     // Adaptive noise floors
+  float snrs[MAX_STATUES - 1];       // Tone power / residual power
+  float thresholds[MAX_STATUES - 1]; // Effective (adaptive) thresholds
+  // Per-channel magnitudes behind the max; channels 2/3 are zero unless
+  // the quad sense input is fitted (QUAD_SENSE_INPUT).
+  float channelMags[MAX_STATUES - 1][4];
+};
+
+// Writer side: publish a new snapshot. Called from the sense timer context
+// after each detector pass.
+void updateSignalSnapshot(const SignalSnapshot &snapshot);
+
+// Reader side: copy the latest consistent snapshot. Retries internally if
+// the writer swapped mid-copy.
+void readSignalSnapshot(SignalSnapshot &out);
+
+// Shared compact formatter: ".XX" or ".XXX" (no leading zero), with the
+// precision chosen from the threshold the same way the OLED lines do.
+void formatSignalCompact(char *buf, size_t buflen, float value,
+                         float threshold);
+
+#endif // SIGNAL_SNAPSHOT_H
@@ -0,0 +1,178 @@
+/*
+SongCache.cpp - PSRAM song cache implementation.
+*/
+
+#include "SongCache.h"
+
+#include <SD.h>
+#include <string.h>
+
+extern "C" uint8_t external_psram_size;
+extern "C" void *extmem_malloc(size_t size);
+extern "C" void extmem_free(void *ptr);
+
+struct CacheEntry {
+  const SongInfo *song; // Manifest entry (stable for the life of the boot)
+  uint8_t *data;        // PSRAM buffer of song->dataLength bytes
+  uint32_t bytesLoaded; // Promotion progress
+  bool complete;
+  bool pinned;          // Dormant songs are never evicted
+  uint32_t lastPlayed;  // millis() of the most recent touch
+};
+
+static CacheEntry entries[SONG_CACHE_MAX_ENTRIES];
+static int numEntries = 0;
+
+// The entry currently being promoted, with its open file handle.
+static int promoIndex = -1;
+static File promoFile;
+
+static int findEntry(const SongInfo &song) {
+  for (int i = 0; i < numEntries; i++) {
+    if (entries[i].song == &song) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+// Allocate PSRAM for a song, evicting the least recently played unpinned
+// entry if the first attempt fails. Returns null when it simply cannot fit.
+static uint8_t *allocWithEviction(uint32_t size) {
+  uint8_t *p = (uint8_t *)extmem_malloc(size);
+  if (p != nullptr) {
+    return p;
+  }
+
+  int victim = -1;
+  for (int i = 0; i < numEntries; i++) {
+    if (entries[i].pinned || i == promoIndex) {
+      continue;
+    }
+    if (victim < 0 || entries[i].lastPlayed < entries[victim].lastPlayed) {
+      victim = i;
+    }
+  }
+  if (victim < 0) {
+    return nullptr;
+  }
+
+  Serial.printf("Song cache: evicting %s\n", entries[victim].song->filename);
+  extmem_free(entries[victim].data);
+  // Compact the array; fix up promoIndex if it moved.
+  for (int i = victim; i < numEntries - 1; i++) {
+    entries[i] = entries[i + 1];
+  }
+  numEntries--;
+  if (promoIndex > victim) {
+    promoIndex--;
+  }
+  return (uint8_t *)extmem_malloc(size);
+}
+
+static void addEntry(const SongInfo &song, bool pinned) {
+  if (external_psram_size == 0 || numEntries >= SONG_CACHE_MAX_ENTRIES ||
+      findEntry(song) >= 0) {
+    return;
+  }
+  // Never try to cache a song bigger than the whole chip.
+  if (song.dataLength > (uint32_t)external_psram_size * 1024 * 1024) {
+    return;
+  }
+
+  uint8_t *data = allocWithEviction(song.dataLength);
+  if (data == nullptr) {
+    return;
+  }
+
+  CacheEntry &e = entries[numEntries++];
+  e.song = &song;
+  e.data = data;
+  e.bytesLoaded = 0;
+  e.complete = false;
+  e.pinned = pinned;
+  e.lastPlayed = millis();
+  Serial.printf("Song cache: promoting %s (%lu KB)\n", song.filename,
+                (unsigned long)(song.dataLength / 1024));
+}
+
+void songCacheInit() {
+  if (external_psram_size == 0) {
+    Serial.println("Song cache: no PSRAM fitted, cache disabled");
+    return;
+  }
+  Serial.printf("Song cache: %u MB PSRAM available\n", external_psram_size);
+
+  // The dormant tracks loop all day: promote and pin them first.
+  for (int i = 0; i < idleSongCount(); i++) {
+    addEntry(*idleSong(i), true);
+  }
+}
+
+void songCacheLoop() {
+  if (external_psram_size == 0) {
+    return;
+  }
+
+  // Pick up the next incomplete entry when idle.
+  if (promoIndex < 0) {
+    for (int i = 0; i < numEntries; i++) {
+      if (!entries[i].complete) {
+        promoFile = SD.open(entries[i].song->filename);
+        if (!promoFile) {
+          // Unreadable: drop the entry rather than retrying forever.
+          extmem_free(entries[i].data);
+          for (int j = i; j < numEntries - 1; j++) {
+            entries[j] = entries[j + 1];
+          }
+          numEntries--;
+          return;
+        }
+        promoFile.seek(entries[i].song->dataOffset);
+        promoIndex = i;
+        break;
+      }
+    }
+    if (promoIndex < 0) {
+      return;
+    }
+  }
+
+  // Copy one slice per pass so promotion never stalls the loop for long.
+  CacheEntry &e = entries[promoIndex];
+  uint32_t remaining = e.song->dataLength - e.bytesLoaded;
+  uint32_t toRead = remaining;
+  if (toRead > SONG_CACHE_SLICE_BYTES) {
+    toRead = SONG_CACHE_SLICE_BYTES;
+  }
+  int got = promoFile.read(e.data + e.bytesLoaded, toRead);
+  if (got > 0) {
+    e.bytesLoaded += got;
+  }
+  if (got <= 0 || e.bytesLoaded >= e.song->dataLength) {
+    promoFile.close();
+    e.complete = (e.bytesLoaded >= e.song->dataLength);
+    if (e.complete) {
+      Serial.printf("Song cache: %s cached\n", e.song->filename);
+    }
+    promoIndex = -1;
+  }
+}
+
+const uint8_t *songCacheLookup(const SongInfo &song) {
+  int i = findEntry(song);
+  if (i < 0 || !entries[i].complete) {
+    return nullptr;
+  }
+  entries[i].lastPlayed = millis();
+  return entries[i].data;
+}
+
+void songCacheTouch(const SongInfo &song) {
+  int i = findEntry(song);
+  if (i >= 0) {
+    entries[i].lastPlayed = millis();
+    return;
+  }
+  addEntry(song, false);
+}
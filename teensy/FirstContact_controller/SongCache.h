@@ -0,0 +1,45 @@
+/*
+SongCache: PSRAM song cache under the music player.
+
+The boards have the Teensy 4.1 PSRAM pads populated but the firmware never
+touched the chip. This cache promotes songs into PSRAM in the background -
+the two dormant tracks first (they loop all day), then the most recently
+played active songs - and the streamer serves a cached song entirely from
+memory, with SD as the miss path. That removes the constant SD traffic of
+the dormant loop and frees the card for the active-song streamer's
+prefetch.
+
+Promotion copies one slice per main-loop pass so it never competes with a
+running prefetch for long. When PSRAM fills, the least recently played
+active entry is evicted; dormant entries are pinned. Without a PSRAM chip
+(external_psram_size == 0) the whole layer is inert.
+*/
+
+#ifndef SONG_CACHE_H
+#define SONG_CACHE_H
+
+#include "SongManifest.h"
+
+#include <Arduino.h>
+
+// Tracked cache entries (2 dormant + recently played actives).
+#define SONG_CACHE_MAX_ENTRIES 8
+
+// Bytes copied from SD to PSRAM per songCacheLoop() call.
+#define SONG_CACHE_SLICE_BYTES 16384
+
+// Queue the dormant songs for promotion; called from musicPlayerSetup()
+// after the manifest is built.
+void songCacheInit();
+
+// Advance background promotion by one slice; called from playMusic().
+void songCacheLoop();
+
+// Full sample data for a song, or null if it is not (yet) fully cached.
+const uint8_t *songCacheLookup(const SongInfo &song);
+
+// Note that a song just started playing: refreshes recency and queues it
+// for promotion if space allows.
+void songCacheTouch(const SongInfo &song);
+
+#endif // SONG_CACHE_H
@@ -0,0 +1,597 @@
+/*
+SongManifest.cpp - Boot-time SD song scan and metadata cache.
+*/
+
+#include "ImaAdpcm.h"
+#include "SongManifest.h"
+
+#include <Audio.h>
+#include <string.h>
+
+// Teensy 4.1 PSRAM support from the core (0 when no chip is soldered).
+extern "C" uint8_t external_psram_size;
+extern "C" void *extmem_malloc(size_t size);
+
+static SongInfo activeSongs[MANIFEST_MAX_SONGS];
+static SongInfo idleSongs[MANIFEST_MAX_SONGS];
+static SongInfo stemSongs[MANIFEST_MAX_SONGS];
+static int numActiveSongs = 0;
+static int numIdleSongs = 0;
+static int numStemSongs = 0;
+
+int activeSongCount() { return numActiveSongs; }
+int idleSongCount() { return numIdleSongs; }
+int stemSongCount() { return numStemSongs; }
+
+const SongInfo *activeSong(int index) {
+  if (numActiveSongs == 0) {
+    return nullptr;
+  }
+  return &activeSongs[index % numActiveSongs];
+}
+
+const SongInfo *idleSong(int index) {
+  if (numIdleSongs == 0) {
+    return nullptr;
+  }
+  return &idleSongs[index % numIdleSongs];
+}
+
+// Case-insensitive substring search (no strcasestr in this toolchain).
+static bool containsIgnoreCase(const char *haystack, const char *needle) {
+  size_t needleLen = strlen(needle);
+  for (const char *p = haystack; *p; p++) {
+    if (strncasecmp(p, needle, needleLen) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Sort key: the first number in the filename ("active 1" ... "active 12"),
+// so track order on the card matches the old hardcoded array order. Files
+// without a number (the dormant songs) sort after numbered ones, by name.
+static int trackNumber(const char *name) {
+  for (const char *p = name; *p; p++) {
+    if (*p >= '0' && *p <= '9') {
+      return atoi(p);
+    }
+  }
+  return 10000;
+}
+
+// Layer number of a stem file: the first number after the "stem" keyword
+// ("active 1 stem 2.wav" -> 2). 0 when none follows.
+static int stemLayer(const char *name) {
+  for (const char *p = name; *p; p++) {
+    if (strncasecmp(p, "stem", 4) == 0) {
+      p += 4;
+      while (*p == ' ' || *p == '_' || *p == '-') {
+        p++;
+      }
+      return (*p >= '0' && *p <= '9') ? atoi(p) : 0;
+    }
+  }
+  return 0;
+}
+
+const SongInfo *stemForSong(const SongInfo &song, int layer) {
+  int track = trackNumber(song.filename);
+  if (track >= 10000) {
+    // No track number (the dormant songs); nothing can match it.
+    return nullptr;
+  }
+  for (int i = 0; i < numStemSongs; i++) {
+    if (trackNumber(stemSongs[i].filename) == track &&
+        stemLayer(stemSongs[i].filename) == layer) {
+      return &stemSongs[i];
+    }
+  }
+  return nullptr;
+}
+
+static void insertSong(SongInfo *list, int &count, const SongInfo &song) {
+  if (count >= MANIFEST_MAX_SONGS) {
+    Serial.printf("Manifest full, skipping: %s\n", song.filename);
+    return;
+  }
+  int pos = count;
+  int key = trackNumber(song.filename);
+  while (pos > 0) {
+    int prevKey = trackNumber(list[pos - 1].filename);
+    if (prevKey < key ||
+        (prevKey == key && strcmp(list[pos - 1].filename, song.filename) < 0)) {
+      break;
+    }
+    list[pos] = list[pos - 1];
+    pos--;
+  }
+  list[pos] = song;
+  count++;
+}
+
+bool parseWavHeader(File &f, SongInfo &info) {
+  uint8_t chunk[12];
+  if (f.read(chunk, 12) != 12 || memcmp(chunk, "RIFF", 4) != 0 ||
+      memcmp(chunk + 8, "WAVE", 4) != 0) {
+    return false;
+  }
+
+  uint16_t audioFormat = 0;
+  uint8_t fileChannels = 0;
+  uint16_t bitsPerSample = 0;
+  uint16_t blockAlign = 0;
+  uint16_t samplesPerBlock = 0;
+  uint32_t sampleRate = 0;
+  while (f.read(chunk, 8) == 8) {
+    uint32_t chunkSize = chunk[4] | (chunk[5] << 8) | ((uint32_t)chunk[6] << 16) |
+                         ((uint32_t)chunk[7] << 24);
+    if (memcmp(chunk, "fmt ", 4) == 0) {
+      uint8_t fmt[20];
+      if (chunkSize < 16 || f.read(fmt, 16) != 16) {
+        return false;
+      }
+      audioFormat = fmt[0] | (fmt[1] << 8);
+      fileChannels = fmt[2];
+      sampleRate = fmt[4] | (fmt[5] << 8) | ((uint32_t)fmt[6] << 16) |
+                   ((uint32_t)fmt[7] << 24);
+      blockAlign = fmt[12] | (fmt[13] << 8);
+      bitsPerSample = fmt[14] | (fmt[15] << 8);
+      uint32_t extraRead = 16;
+      if (audioFormat == 0x11 && chunkSize >= 20) {
+        // IMA ADPCM extension: cbSize then samplesPerBlock.
+        if (f.read(fmt + 16, 4) != 4) {
+          return false;
+        }
+        samplesPerBlock = fmt[18] | (fmt[19] << 8);
+        extraRead = 20;
+      }
+      if (chunkSize > extraRead) {
+        f.seek(f.position() + (chunkSize - extraRead));
+      }
+    } else if (memcmp(chunk, "data", 4) == 0) {
+      if (fileChannels < 1 || fileChannels > 2) {
+        return false;
+      }
+      // Graph rate, or 48 kHz via the streamer's polyphase resampler
+      // (ResampleTables.h). Anything else would pitch-shift.
+      if (sampleRate != 44100 && sampleRate != 48000) {
+        return false;
+      }
+      if (audioFormat == 0x01 && bitsPerSample == 16) {
+        info.codec = SONG_CODEC_PCM16;
+        info.blockAlign = fileChannels * 2;
+        info.samplesPerBlock = 1;
+      } else if (audioFormat == 0x01 &&
+                 (bitsPerSample == 24 || bitsPerSample == 32)) {
+        // Artist masters; the streamer converts to 16-bit on the fly.
+        info.codec =
+            (bitsPerSample == 24) ? SONG_CODEC_PCM24 : SONG_CODEC_PCM32;
+        info.blockAlign = fileChannels * (bitsPerSample / 8);
+        info.samplesPerBlock = 1;
+      } else if (audioFormat == 0x11 && bitsPerSample == 4 &&
+                 blockAlign > 4u * fileChannels &&
+                 blockAlign <= SONG_MAX_BLOCK_ALIGN) {
+        info.codec = SONG_CODEC_IMA_ADPCM;
+        info.blockAlign = blockAlign;
+        info.samplesPerBlock =
+            samplesPerBlock > 0
+                ? samplesPerBlock
+                : imaAdpcmSamplesPerBlock(blockAlign, fileChannels);
+      } else {
+        return false;
+      }
+      // Truncate to whole blocks so buffer fills never split one.
+      info.sampleRate = sampleRate;
+      info.channels = fileChannels;
+      info.dataOffset = f.position();
+      info.dataLength = chunkSize - (chunkSize % info.blockAlign);
+      info.loopStartBytes = 0;
+      info.loopEndBytes = 0;
+      return true;
+    } else {
+      f.seek(f.position() + chunkSize + (chunkSize & 1));
+    }
+  }
+  return false;
+}
+
+// Loop metadata from a standard sampler ("smpl") chunk. Editors usually
+// write it after the data chunk, and parseWavHeader() stops there so the
+// streamer gets the file positioned at the first sample - so this is a
+// separate walk from the top, done once per file at boot. The first loop
+// entry's frame range is converted to block-aligned byte offsets into the
+// data chunk; a missing or malformed chunk leaves the song loop-free.
+static void parseSmplLoop(File &f, SongInfo &info) {
+  f.seek(12);
+  uint8_t chunk[8];
+  while (f.read(chunk, 8) == 8) {
+    uint32_t chunkSize = chunk[4] | (chunk[5] << 8) |
+                         ((uint32_t)chunk[6] << 16) |
+                         ((uint32_t)chunk[7] << 24);
+    if (memcmp(chunk, "smpl", 4) == 0) {
+      // 36-byte header (loop count at offset 28), then 24-byte loops.
+      uint8_t hdr[36];
+      if (chunkSize < 60 || f.read(hdr, 36) != 36) {
+        return;
+      }
+      uint32_t numLoops = hdr[28] | (hdr[29] << 8) |
+                          ((uint32_t)hdr[30] << 16) |
+                          ((uint32_t)hdr[31] << 24);
+      uint8_t lp[24];
+      if (numLoops < 1 || f.read(lp, 24) != 24) {
+        return;
+      }
+      uint32_t startFrame = lp[8] | (lp[9] << 8) | ((uint32_t)lp[10] << 16) |
+                            ((uint32_t)lp[11] << 24);
+      uint32_t endFrame = lp[12] | (lp[13] << 8) | ((uint32_t)lp[14] << 16) |
+                          ((uint32_t)lp[15] << 24);
+      // Frames to bytes (end is inclusive), aligned down to whole source
+      // blocks so an ADPCM wrap lands on a predictor reset.
+      uint32_t startB = (uint32_t)((uint64_t)startFrame * info.blockAlign /
+                                   info.samplesPerBlock);
+      startB -= startB % info.blockAlign;
+      uint32_t endB = (uint32_t)((uint64_t)(endFrame + 1) * info.blockAlign /
+                                 info.samplesPerBlock);
+      endB -= endB % info.blockAlign;
+      if (endB > info.dataLength) {
+        endB = info.dataLength;
+      }
+      if (endB > startB) {
+        info.loopStartBytes = startB;
+        info.loopEndBytes = endB;
+      }
+      return;
+    }
+    f.seek(f.position() + chunkSize + (chunkSize & 1));
+  }
+}
+
+// True when the file sits in one contiguous sector run. Asked of the
+// SdFat layer under the SD wrapper (SD.sdfs); exFAT marks such files
+// "no FAT chain" and every seek into them is arithmetic. The answer is
+// cached in the manifest so the seek-heavy paths can be judged at boot
+// instead of showing up as mysterious latency spikes mid-show.
+static bool fileIsContiguous(const char *name) {
+  FsFile f = SD.sdfs.open(name, O_RDONLY);
+  if (!f.isOpen()) {
+    return false;
+  }
+  uint32_t bgnSector, endSector;
+  bool contiguous = f.contiguousRange(&bgnSector, &endSector);
+  f.close();
+  return contiguous;
+}
+
+void buildSongManifest() {
+  numActiveSongs = 0;
+  numIdleSongs = 0;
+  numStemSongs = 0;
+
+  File root = SD.open("/");
+  if (!root) {
+    Serial.println("Manifest: cannot open SD root directory");
+    return;
+  }
+
+  while (true) {
+    File entry = root.openNextFile();
+    if (!entry) {
+      break;
+    }
+    if (!entry.isDirectory()) {
+      const char *name = entry.name();
+      size_t len = strlen(name);
+      if (len >= 4 && len < SONG_NAME_MAX &&
+          strcasecmp(name + len - 4, ".wav") == 0) {
+        SongInfo song;
+        strcpy(song.filename, name);
+        song.intro = nullptr;
+        song.introBytes = 0;
+        song.gain = 1.0f;
+        if (parseWavHeader(entry, song)) {
+          parseSmplLoop(entry, song);
+          song.contiguous = fileIsContiguous(name);
+          // Stems first: their names also carry the "active" keyword.
+          if (containsIgnoreCase(name, "stem")) {
+            insertSong(stemSongs, numStemSongs, song);
+          } else if (containsIgnoreCase(name, "active")) {
+            insertSong(activeSongs, numActiveSongs, song);
+          } else if (containsIgnoreCase(name, "dormant")) {
+            insertSong(idleSongs, numIdleSongs, song);
+          }
+        } else {
+          Serial.printf("Manifest: skipping unsupported WAV: %s\n", name);
+        }
+      }
+    }
+    entry.close();
+  }
+  root.close();
+
+  Serial.printf("Song manifest: %d active, %d dormant, %d stems\n",
+                numActiveSongs, numIdleSongs, numStemSongs);
+  int fragmented = 0;
+  for (int i = 0; i < numActiveSongs; i++) {
+    Serial.printf("  active %d: %s%s\n", i, activeSongs[i].filename,
+                  activeSongs[i].contiguous ? "" : " (fragmented)");
+    fragmented += activeSongs[i].contiguous ? 0 : 1;
+  }
+  for (int i = 0; i < numIdleSongs; i++) {
+    Serial.printf("  dormant %d: %s%s\n", i, idleSongs[i].filename,
+                  idleSongs[i].contiguous ? "" : " (fragmented)");
+    fragmented += idleSongs[i].contiguous ? 0 : 1;
+  }
+  for (int i = 0; i < numStemSongs; i++) {
+    Serial.printf("  stem %d: %s%s\n", i, stemSongs[i].filename,
+                  stemSongs[i].contiguous ? "" : " (fragmented)");
+    fragmented += stemSongs[i].contiguous ? 0 : 1;
+  }
+  if (fragmented > 0) {
+    // Seeks into these walk the cluster chain; a fresh copy onto the
+    // card (or an exFAT reformat) restores arithmetic seeks.
+    Serial.printf("Manifest: %d fragmented file(s); reseeks will be slow\n",
+                  fragmented);
+  }
+
+  loadSongIntros();
+  loadLoudnessTable();
+}
+
+// --- Loudness normalization ---
+
+// Scratch buffers for the one-time loudness scan (boot only, reused for
+// every song; static to stay off the setup() stack).
+static uint8_t scanBuffer[16384];
+static int16_t scanPcm[2][2 * SONG_MAX_BLOCK_ALIGN];
+
+// Measure a song's peak and RMS and derive its normalization gain.
+static float measureSongGain(const SongInfo &song) {
+  File f = SD.open(song.filename);
+  if (!f) {
+    return 1.0f;
+  }
+  f.seek(song.dataOffset);
+
+  uint32_t peak = 0;
+  uint64_t sumSquares = 0;
+  uint64_t sampleCount = 0;
+  uint32_t remaining = song.dataLength;
+
+  while (remaining > 0) {
+    uint32_t toRead = remaining;
+    if (toRead > sizeof(scanBuffer)) {
+      toRead = sizeof(scanBuffer);
+    }
+    toRead -= toRead % song.blockAlign;
+    if (toRead == 0) {
+      break;
+    }
+    int got = f.read(scanBuffer, toRead);
+    if (got <= 0) {
+      break;
+    }
+    remaining -= got;
+
+    if (song.codec == SONG_CODEC_IMA_ADPCM) {
+      for (int off = 0; off + song.blockAlign <= got;
+           off += song.blockAlign) {
+        uint16_t samples =
+            imaAdpcmDecodeBlock(scanBuffer + off, song.blockAlign,
+                                song.channels, scanPcm[0], scanPcm[1]);
+        for (uint8_t c = 0; c < song.channels; c++) {
+          for (uint16_t s = 0; s < samples; s++) {
+            int32_t v = scanPcm[c][s];
+            uint32_t mag = (v < 0) ? -v : v;
+            if (mag > peak) {
+              peak = mag;
+            }
+            sumSquares += (uint64_t)((int64_t)v * v);
+          }
+        }
+        sampleCount += (uint64_t)samples * song.channels;
+      }
+    } else if (song.codec == SONG_CODEC_PCM16) {
+      int16_t *samples = (int16_t *)scanBuffer;
+      int count = got / 2;
+      for (int s = 0; s < count; s++) {
+        int32_t v = samples[s];
+        uint32_t mag = (v < 0) ? -v : v;
+        if (mag > peak) {
+          peak = mag;
+        }
+        sumSquares += (uint64_t)((int64_t)v * v);
+      }
+      sampleCount += count;
+    } else {
+      // 24/32-bit PCM: measure on the top 16 bits, which is what the
+      // streamer's conversion will actually play.
+      int step = (song.codec == SONG_CODEC_PCM24) ? 3 : 4;
+      for (int off = 0; off + step <= got; off += step) {
+        const uint8_t *p = scanBuffer + off;
+        int32_t v;
+        if (step == 3) {
+          v = (int32_t)((uint32_t)p[0] << 8 | (uint32_t)p[1] << 16 |
+                        (uint32_t)p[2] << 24) >> 16;
+        } else {
+          v = (int32_t)((uint32_t)p[0] | (uint32_t)p[1] << 8 |
+                        (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24) >> 16;
+        }
+        uint32_t mag = (v < 0) ? -v : v;
+        if (mag > peak) {
+          peak = mag;
+        }
+        sumSquares += (uint64_t)((int64_t)v * v);
+      }
+      sampleCount += got / step;
+    }
+  }
+  f.close();
+
+  if (sampleCount == 0 || peak == 0) {
+    return 1.0f;
+  }
+
+  float rms = sqrtf((float)(sumSquares / sampleCount)) / 32768.0f;
+  float peakNorm = (float)peak / 32768.0f;
+
+  // Hit the target RMS, but never let the normalized peak clip.
+  float gain = LOUDNESS_TARGET_RMS / rms;
+  if (gain * peakNorm > 0.95f) {
+    gain = 0.95f / peakNorm;
+  }
+  gain = constrain(gain, LOUDNESS_MIN_GAIN, LOUDNESS_MAX_GAIN);
+  return gain;
+}
+
+// Look up a song in the table file contents ("<gain>|<filename>" lines).
+static bool lookupStoredGain(const char *table, const char *filename,
+                             float &outGain) {
+  const char *line = table;
+  while (*line) {
+    const char *sep = strchr(line, '|');
+    const char *end = strchr(line, '\n');
+    if (end == nullptr) {
+      end = line + strlen(line);
+    }
+    if (sep != nullptr && sep < end) {
+      size_t nameLen = end - (sep + 1);
+      if (nameLen == strlen(filename) &&
+          strncmp(sep + 1, filename, nameLen) == 0) {
+        outGain = atof(line);
+        return true;
+      }
+    }
+    line = (*end) ? end + 1 : end;
+  }
+  return false;
+}
+
+void loadLoudnessTable() {
+  // Read the whole (small) table into RAM for lookups.
+  static char table[2048];
+  table[0] = '\0';
+  File f = SD.open(LOUDNESS_TABLE_FILE);
+  if (f) {
+    int got = f.read(table, sizeof(table) - 1);
+    if (got > 0) {
+      table[got] = '\0';
+    }
+    f.close();
+  }
+
+  SongInfo *lists[2] = {activeSongs, idleSongs};
+  int counts[2] = {numActiveSongs, numIdleSongs};
+  bool measuredAny = false;
+
+  for (int l = 0; l < 2; l++) {
+    for (int i = 0; i < counts[l]; i++) {
+      SongInfo &song = lists[l][i];
+      if (lookupStoredGain(table, song.filename, song.gain)) {
+        continue;
+      }
+      Serial.printf("Measuring loudness: %s\n", song.filename);
+      song.gain = measureSongGain(song);
+      Serial.printf("  gain %.3f\n", song.gain);
+      measuredAny = true;
+    }
+  }
+
+  // Persist the full table whenever something new was measured, so the
+  // scan happens once per file per card.
+  if (measuredAny) {
+    SD.remove(LOUDNESS_TABLE_FILE);
+    File out = SD.open(LOUDNESS_TABLE_FILE, FILE_WRITE);
+    if (!out) {
+      Serial.println("Loudness: cannot write table file");
+      return;
+    }
+    for (int l = 0; l < 2; l++) {
+      for (int i = 0; i < counts[l]; i++) {
+        out.printf("%.3f|%s\n", lists[l][i].gain, lists[l][i].filename);
+      }
+    }
+    out.close();
+    Serial.println("Loudness table saved");
+  }
+}
+
+// Prefer PSRAM for the intro copies; without it, fall back to the RAM2
+// heap under a fixed budget shared across all songs.
+static uint8_t *allocIntro(size_t size) {
+  if (external_psram_size > 0) {
+    uint8_t *p = (uint8_t *)extmem_malloc(size);
+    if (p != nullptr) {
+      return p;
+    }
+  }
+  return (uint8_t *)malloc(size);
+}
+
+static void loadIntroFor(SongInfo &song, uint32_t capBytes) {
+  // Source bytes per second: blockAlign bytes carry samplesPerBlock
+  // frames (1 for PCM of any width) at the file's own rate.
+  float bytesPerSample = (float)song.blockAlign / song.samplesPerBlock;
+  uint32_t want = (uint32_t)(INTRO_PRELOAD_MS * (song.sampleRate / 1000.0f) *
+                             bytesPerSample);
+  if (want > capBytes) {
+    want = capBytes;
+  }
+  if (want > song.dataLength) {
+    want = song.dataLength;
+  }
+  want -= want % song.blockAlign;
+  if (want == 0) {
+    return;
+  }
+
+  uint8_t *buffer = allocIntro(want);
+  if (buffer == nullptr) {
+    Serial.printf("Intro alloc failed (%lu bytes): %s\n", (unsigned long)want,
+                  song.filename);
+    return;
+  }
+
+  File f = SD.open(song.filename);
+  if (!f) {
+    free(buffer);
+    return;
+  }
+  f.seek(song.dataOffset);
+  int got = f.read(buffer, want);
+  f.close();
+  if (got != (int)want) {
+    free(buffer);
+    return;
+  }
+
+  song.intro = buffer;
+  song.introBytes = want;
+}
+
+void loadSongIntros() {
+  int totalSongs = numActiveSongs + numIdleSongs;
+  if (totalSongs == 0) {
+    return;
+  }
+
+  // With PSRAM every song gets the full 500 ms; the heap fallback splits a
+  // fixed budget evenly so RAM2 stays available for the audio library.
+  uint32_t capBytes = 0xFFFFFFFF;
+  if (external_psram_size == 0) {
+    capBytes = INTRO_HEAP_BUDGET_BYTES / totalSongs;
+  }
+
+  uint32_t totalBytes = 0;
+  for (int i = 0; i < numActiveSongs; i++) {
+    loadIntroFor(activeSongs[i], capBytes);
+    totalBytes += activeSongs[i].introBytes;
+  }
+  for (int i = 0; i < numIdleSongs; i++) {
+    loadIntroFor(idleSongs[i], capBytes);
+    totalBytes += idleSongs[i].introBytes;
+  }
+  Serial.printf("Song intros preloaded: %lu KB in %s\n",
+                (unsigned long)(totalBytes / 1024),
+                external_psram_size > 0 ? "PSRAM" : "RAM2 heap");
+}
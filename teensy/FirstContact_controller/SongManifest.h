@@ -0,0 +1,119 @@
+/*
+SongManifest: Boot-time scan of the SD card's songs.
+
+The playlists used to be hardcoded filename arrays, and every play() call
+walked the FAT directory and re-parsed the WAV header before any audio
+flowed. buildSongManifest() scans the card root once in musicPlayerSetup(),
+classifies files by the "active"/"dormant" keywords in their names (the
+same convention the audio_files/ directory has always used), and caches the
+per-file channel layout, data offset, and data length in RAM. Starting a
+song then seeks straight to the cached data offset with no header parse,
+and new WAVs dropped on the card appear in the playlists without a
+firmware rebuild.
+
+Active songs sort by the first number in their filename ("active 1" ...
+"active 12"), so track order on the card matches the old array order.
+*/
+
+#ifndef SONG_MANIFEST_H
+#define SONG_MANIFEST_H
+
+#include <Arduino.h>
+#include <SD.h>
+
+// Longest production filename is ~55 characters.
+#define SONG_NAME_MAX 80
+
+// Per-category playlist capacity.
+#define MANIFEST_MAX_SONGS 16
+
+// Intro preload target. With PSRAM fitted every song gets the full 500 ms;
+// without it the intros shrink to share a fixed heap budget (RAM2) so the
+// music start is still instant, just with a shorter RAM head start.
+#define INTRO_PRELOAD_MS 500
+#define INTRO_HEAP_BUDGET_BYTES (320 * 1024)
+
+// Codecs the playback pipeline understands. 24- and 32-bit PCM convert
+// to the graph's 16-bit format inside the streamer, with TPDF dither at
+// the target LSB (see SdStream.cpp), so artist masters play untouched.
+#define SONG_CODEC_PCM16 0
+#define SONG_CODEC_IMA_ADPCM 1
+#define SONG_CODEC_PCM24 2
+#define SONG_CODEC_PCM32 3
+
+// Largest accepted ADPCM block (bounds the decoder's staging buffers).
+#define SONG_MAX_BLOCK_ALIGN 2048
+
+struct SongInfo {
+  char filename[SONG_NAME_MAX];
+  uint8_t channels;
+  uint8_t codec;            // SONG_CODEC_*
+  uint16_t blockAlign;      // Source bytes per frame (PCM) or block (ADPCM)
+  uint16_t samplesPerBlock; // Samples per channel per block (1 for PCM)
+  uint32_t sampleRate;      // Source rate in Hz: 44100 plays straight,
+                            // 48000 goes through the streamer's resampler
+  uint32_t dataOffset; // Byte offset of the first sample in the file
+  uint32_t dataLength; // Block-aligned byte length of the data chunk
+
+  // True when the file occupies one contiguous sector run on the card
+  // (checked once at scan via the SdFat layer under the SD wrapper).
+  // Mid-file seeks - resume-from-offset, loop wraps, ensemble reseeks -
+  // are O(1) arithmetic inside SdFat for contiguous files and cluster-
+  // chain walks otherwise, so the scan flags fragmented songs.
+  bool contiguous;
+
+  // First chunk of the song preloaded into RAM at boot (null if the
+  // allocation failed). Playback starts from this copy the instant hands
+  // touch while the SD streamer seeks past it and splices in.
+  const uint8_t *intro;
+  uint32_t introBytes;
+
+  // Loop points from the file's sampler ("smpl") chunk, as block-aligned
+  // byte offsets into the data chunk. loopEndBytes == 0 means the file
+  // carries no loop metadata. Dormant tracks with loop points hold one
+  // seamless loop all night instead of restarting (see SdStream.h).
+  uint32_t loopStartBytes;
+  uint32_t loopEndBytes;
+
+  // Loudness normalization gain (1.0 = as mastered). Measured once on
+  // first boot and persisted in LOUDNESS_TABLE_FILE on the card.
+  float gain;
+};
+
+// Scan the card root and build both playlists. Called once from
+// musicPlayerSetup() after SD.begin().
+void buildSongManifest();
+
+// Preload song intros into RAM (called at the end of buildSongManifest()).
+void loadSongIntros();
+
+// Loudness normalization. The tracks were mastered at wildly different
+// levels; each song's RMS and peak are measured once (first boot only),
+// converted to a gain that hits LOUDNESS_TARGET_RMS without clipping, and
+// persisted on the card so later boots just read the table back.
+#define LOUDNESS_TABLE_FILE "loudness.cfg"
+#define LOUDNESS_TARGET_RMS 0.18f
+#define LOUDNESS_MAX_GAIN 4.0f
+#define LOUDNESS_MIN_GAIN 0.25f
+void loadLoudnessTable();
+
+int activeSongCount();
+const SongInfo *activeSong(int index);
+int idleSongCount();
+const SongInfo *idleSong(int index);
+
+// Stem layers. Files with "stem" in the name are kept out of both
+// playlists and matched to the active song sharing their track number:
+// "active 1 stem 2.wav" is layer 2 of track 1 (see StemMix.h for who
+// plays them). Stems skip intro preload and loudness measurement - they
+// fade in under an already-playing song and are mastered against it.
+int stemSongCount();
+const SongInfo *stemForSong(const SongInfo &song, int layer);
+
+// Shared RIFF header walk (also used by AudioPlaySdStream for files that
+// are not in the manifest). Fills the format fields of `info` (filename is
+// untouched) and leaves the file positioned at the first sample. Accepts
+// 16-bit PCM and 4-bit IMA ADPCM (format tag 0x11).
+bool parseWavHeader(File &f, SongInfo &info);
+
+#endif // SONG_MANIFEST_H
@@ -0,0 +1,17 @@
+/*
+SongSync: network push of WAV files onto the statue's SD card.
+*/
+
+#ifndef SONG_SYNC_H
+#define SONG_SYNC_H
+
+#include <Arduino.h>
+
+// Start listening for song uploads. Call once the network is up.
+void initSongSync();
+
+// Service an in-progress upload and any deferred manifest refresh; call
+// from loop() while the network is ready.
+void songSyncLoop();
+
+#endif // SONG_SYNC_H
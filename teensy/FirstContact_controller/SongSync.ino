@@ -0,0 +1,304 @@
+/*
+  SongSync: WAV file sync onto the SD card over Ethernet.
+
+  Updating the music set used to mean pulling five SD cards from five
+  sealed enclosures. This module listens on a TCP port for a file pushed
+  by the Pi, streams it into a staging file on the card, verifies it
+  against the CRC32 in the upload header, and only then renames it over
+  the destination name - so a dropped connection or a corrupted transfer
+  never leaves a half-written WAV where the playlists can find it. After
+  a verified swap the song manifest is rebuilt, so the new track appears
+  in the playlists without a reboot.
+
+  Upload protocol (one TCP connection from the Pi, modeled on OTA):
+    16-byte header: magic "MLSW", file length, CRC32 of the file, and
+    the filename length - all little-endian - followed by the filename
+    bytes (card root only, no paths), then the raw file bytes.
+  The statue answers "OK\n" after the rename or "ERR\n" on any failure.
+  Uploads are only accepted from the Pi's address.
+
+  Card writes go out one 4 KB buffer at a time, sized so the SDIO
+  driver issues each one as a single multi-sector DMA burst. Each burst
+  is granted by the SD arbiter (SdArbiter.h), where sync is the lowest
+  priority class: the streamer's prefetch reads and the journal and
+  recorder flushes go first, and the arbiter's window budget bounds how
+  much card time a transfer can take per pass. With the card otherwise
+  idle the transfer drains the socket as fast as it fills.
+*/
+
+#include <SD.h>
+
+#include "Log.h"
+#include "MusicPlayer.h"
+#include "Networking.h"
+#include "SdArbiter.h"
+#include "SongCache.h"
+#include "SongManifest.h"
+#include "SongSync.h"
+
+#define SYNC_PORT 5811
+#define SYNC_MAGIC 0x57534C4Du // "MLSW" - Missing Link Song Wav
+#define SYNC_STALL_TIMEOUT_MS 10000
+#define SYNC_STAGE_FILE "sync.tmp"
+// One buffer = one multi-sector SD burst; also the per-pass write quota
+// while music is playing.
+#define SYNC_CHUNK_BYTES 4096
+// Write quota per pass with playback idle.
+#define SYNC_IDLE_CHUNKS 8
+// Refuse files the card cannot plausibly hold (longest song is ~60 MB).
+#define SYNC_MAX_FILE (256UL * 1024 * 1024)
+
+struct __attribute__((packed)) SyncHeader {
+  uint32_t magic;
+  uint32_t length;
+  uint32_t crc;
+  uint32_t nameLength;
+};
+
+static EthernetServer syncServer(SYNC_PORT);
+static EthernetClient syncClient;
+static bool syncStarted = false;
+static bool uploadActive = false;
+static SyncHeader header;
+static uint32_t headerReceived = 0;
+static char targetName[SONG_NAME_MAX];
+static uint32_t nameReceived = 0;
+static uint32_t fileReceived = 0;
+static uint32_t runningCrc = 0;
+static unsigned long lastDataMs = 0;
+
+static FsFile stageFile;
+static uint8_t chunkBuf[SYNC_CHUNK_BYTES];
+static uint32_t chunkFill = 0;
+
+// A verified swap while music is playing defers the manifest rebuild:
+// the playlists hold pointers into the manifest arrays, so rebuilding
+// mid-song would yank the SongInfo out from under the streamer.
+static bool manifestRefreshPending = false;
+
+// Same reflected CRC32 as OTA, but streamed: feed chunks as they arrive
+// and finalize with ~crc at the end.
+static uint32_t syncCrc32Update(uint32_t crc, const uint8_t *data,
+                                size_t length) {
+  for (size_t i = 0; i < length; i++) {
+    crc ^= data[i];
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+    }
+  }
+  return crc;
+}
+
+void initSongSync() {
+  syncServer.begin();
+  syncStarted = true;
+  Serial.printf("SongSync: listening on port %d\n", SYNC_PORT);
+}
+
+static void abortUpload(const char *why) {
+  Serial.printf("SongSync: aborted (%s) after %lu bytes\n", why,
+                (unsigned long)fileReceived);
+  if (stageFile.isOpen()) {
+    stageFile.close();
+    SD.remove(SYNC_STAGE_FILE);
+  }
+  if (syncClient) {
+    syncClient.print("ERR\n");
+    syncClient.stop();
+  }
+  uploadActive = false;
+}
+
+static void refreshManifest() {
+  // Rescan the card and re-queue dormant tracks for PSRAM promotion, the
+  // same sequence musicMountLoop() runs after SD.begin().
+  buildSongManifest();
+  songCacheInit();
+  manifestRefreshPending = false;
+  LOG_INFO("SongSync: manifest refreshed");
+}
+
+static void finishUpload() {
+  if (chunkFill > 0) {
+    stageFile.write(chunkBuf, chunkFill);
+    chunkFill = 0;
+  }
+  stageFile.sync();
+  stageFile.close();
+
+  if (~runningCrc != header.crc) {
+    Serial.printf("SongSync: CRC mismatch (got %08lx, want %08lx)\n",
+                  (unsigned long)~runningCrc, (unsigned long)header.crc);
+    abortUpload("bad CRC");
+    return;
+  }
+
+  // The rename is the commit point: until here the destination name
+  // still holds the old file (or nothing), and the staging name is
+  // invisible to the manifest scan.
+  SD.remove(targetName);
+  if (!SD.rename(SYNC_STAGE_FILE, targetName)) {
+    abortUpload("rename failed");
+    return;
+  }
+
+  Serial.printf("SongSync: %s verified and swapped in (%lu bytes)\n",
+                targetName, (unsigned long)header.length);
+  syncClient.print("OK\n");
+  syncClient.stop();
+  uploadActive = false;
+
+  if (musicPlaying()) {
+    manifestRefreshPending = true;
+    LOG_INFO("SongSync: manifest refresh deferred until playback stops");
+  } else {
+    refreshManifest();
+  }
+}
+
+void songSyncLoop() {
+  if (!syncStarted) {
+    return;
+  }
+
+  if (manifestRefreshPending && !musicPlaying()) {
+    refreshManifest();
+  }
+
+  if (!uploadActive) {
+    EthernetClient incoming = syncServer.accept();
+    if (!incoming) {
+      return;
+    }
+    if (incoming.remoteIP() != getServer()) {
+      // Songs only come from the Pi.
+      Serial.print("SongSync: rejected upload from ");
+      Serial.println(incoming.remoteIP());
+      incoming.stop();
+      return;
+    }
+    if (!musicReady()) {
+      Serial.println("SongSync: rejected upload, SD not mounted");
+      incoming.print("ERR\n");
+      incoming.stop();
+      return;
+    }
+    syncClient = incoming;
+    uploadActive = true;
+    headerReceived = 0;
+    nameReceived = 0;
+    fileReceived = 0;
+    chunkFill = 0;
+    runningCrc = 0xFFFFFFFF;
+    lastDataMs = millis();
+    Serial.println("SongSync: upload started");
+    return;
+  }
+
+  if (!syncClient.connected()) {
+    abortUpload("connection dropped");
+    return;
+  }
+
+  if (syncClient.available() <= 0) {
+    if (millis() - lastDataMs > SYNC_STALL_TIMEOUT_MS) {
+      abortUpload("stalled");
+    }
+    return;
+  }
+  lastDataMs = millis();
+
+  // Header first.
+  if (headerReceived < sizeof(header)) {
+    uint8_t *dst = (uint8_t *)&header;
+    int got = syncClient.read(dst + headerReceived,
+                              sizeof(header) - headerReceived);
+    if (got <= 0) {
+      return;
+    }
+    headerReceived += got;
+    if (headerReceived < sizeof(header)) {
+      return;
+    }
+    if (header.magic != SYNC_MAGIC || header.length == 0 ||
+        header.length > SYNC_MAX_FILE || header.nameLength == 0 ||
+        header.nameLength >= SONG_NAME_MAX) {
+      abortUpload("bad header");
+      return;
+    }
+    return;
+  }
+
+  // Then the filename.
+  if (nameReceived < header.nameLength) {
+    int got = syncClient.read((uint8_t *)targetName + nameReceived,
+                              header.nameLength - nameReceived);
+    if (got <= 0) {
+      return;
+    }
+    nameReceived += got;
+    if (nameReceived < header.nameLength) {
+      return;
+    }
+    targetName[header.nameLength] = '\0';
+    // Card root only: the staging name must never be reachable, and the
+    // manifest only scans the root anyway.
+    if (strchr(targetName, '/') != NULL ||
+        strcmp(targetName, SYNC_STAGE_FILE) == 0) {
+      abortUpload("bad filename");
+      return;
+    }
+    SD.remove(SYNC_STAGE_FILE);
+    // Open through the SdFat layer so the staging file can be
+    // preallocated to the announced length in one contiguous run:
+    // every synced song lands with arithmetic seeks by construction
+    // (the manifest scan flags fragmented files at boot). A failed
+    // preallocation (card nearly full) just falls back to chained
+    // allocation; the transfer itself is unaffected.
+    stageFile = SD.sdfs.open(SYNC_STAGE_FILE, O_RDWR | O_CREAT | O_TRUNC);
+    if (!stageFile.isOpen()) {
+      abortUpload("cannot open staging file");
+      return;
+    }
+    if (!stageFile.preAllocate(header.length)) {
+      LOG_WARN("SongSync: preallocation failed; file may fragment");
+    }
+    Serial.printf("SongSync: receiving %s (%lu bytes)\n", targetName,
+                  (unsigned long)header.length);
+    return;
+  }
+
+  // Then file bytes: each full chunk is one write burst, and each burst
+  // asks the arbiter first. A denied grant leaves the chunk buffered and
+  // lets TCP backpressure hold the rest until a later pass.
+  int chunksWritten = 0;
+  while (syncClient.available() > 0 && fileReceived < header.length &&
+         chunksWritten < SYNC_IDLE_CHUNKS) {
+    if (chunkFill == SYNC_CHUNK_BYTES) {
+      if (!sdIoBegin(SD_IO_SYNC)) {
+        break;
+      }
+      stageFile.write(chunkBuf, chunkFill);
+      sdIoEnd(SD_IO_SYNC);
+      chunkFill = 0;
+      chunksWritten++;
+      continue;
+    }
+    int want = SYNC_CHUNK_BYTES - chunkFill;
+    uint32_t remaining = header.length - fileReceived;
+    if ((uint32_t)want > remaining) {
+      want = remaining;
+    }
+    int got = syncClient.read(chunkBuf + chunkFill, want);
+    if (got <= 0) {
+      break;
+    }
+    runningCrc = syncCrc32Update(runningCrc, chunkBuf + chunkFill, got);
+    chunkFill += got;
+    fileReceived += got;
+  }
+
+  if (fileReceived >= header.length) {
+    finishUpload();
+  }
+}
@@ -2,66 +2,211 @@
 StatueConfig.cpp - Implementation of dynamic statue configuration
 */
 
+#include "ConfigStore.h"
 #include "StatueConfig.h"
-#include "Display.h"
+#include "EventBus.h"
+#include "FixedString.h"
 #include "Networking.h"
 #include <ArduinoJson.h>
 
+// Canonical statue registry: the single source for names and defaults.
+// Adding statue #6 means adding one row here (and bumping MAX_STATUES);
+// the runtime arrays, the lowercase copies, and the name lookup all
+// derive from this table.
+struct StatueDefault {
+  char name[10]; // Canonical uppercase name, as used in config JSON keys
+  int frequency; // Default emit frequency in Hz
+  float threshold; // Default detection threshold
+};
+
+static constexpr StatueDefault kStatueDefaults[MAX_STATUES] = {
+    {"EROS", 10077, 0.01f},    {"ELEKTRA", 12274, 0.01f},
+    {"ARIEL", 14643, 0.01f},   {"SOPHIA", 17227, 0.01f},
+    {"ULTIMO", 19467, 0.01f},
+};
+
 // Variable definitions - these replace the former #define constants
 char THIS_STATUE_ID = 'A'; // Default to 'A', will be set dynamically
 int MY_STATUE_INDEX = 0;   // Default to 0, will be set dynamically
-int MY_TX_FREQ = 10077;    // Default frequency, will be set dynamically
-const char *MY_STATUE_NAME = "EROS"; // Default name, will be set dynamically
-
-// Arrays to hold all statue configurations
-int STATUE_FREQUENCIES[MAX_STATUES] = {10077, 12274, 14643, 17227,
-                                       19467}; // Defaults
-char STATUE_NAMES[MAX_STATUES][10] = {"EROS", "ELEKTRA", "ARIEL", "SOPHIA",
-                                      "ULTIMO"}; // Defaults
-float STATUE_THRESHOLDS[MAX_STATUES] = {0.01, 0.01, 0.01, 0.01,
-                                        0.01}; // Defaults
-
-// External reference to detector thresholds array in AudioSense.ino
+int MY_RING_ID = 1;        // Ring 1 = the original missing_link topic root
+int MY_TX_FREQ = kStatueDefaults[0].frequency; // Set dynamically
+const char *MY_STATUE_NAME = kStatueDefaults[0].name; // Set dynamically
+
+// Runtime copies, seeded from kStatueDefaults before setup() runs (see
+// seedStatueDefaults) and overwritten by config parsing.
+int STATUE_FREQUENCIES[MAX_STATUES];
+char STATUE_NAMES[MAX_STATUES][10];
+float STATUE_THRESHOLDS[MAX_STATUES];
+
+// Pair overrides, [detecting][target]. 0 means "no override"; filled
+// only from config (the EEPROM cache keeps the scalars, so a cached boot
+// runs on scalars until the retained config replays the matrix).
+float STATUE_PAIR_THRESHOLDS[MAX_STATUES][MAX_STATUES];
+
+// Hysteresis release ratios, per target statue (see StatueConfig.h).
+// Seeded to the default; config may tighten or loosen per statue. Not
+// cached in EEPROM (same treatment as the pair matrix): a cached boot
+// runs on the default until the retained config replays.
+float STATUE_UNLINK_RATIOS[MAX_STATUES];
+
+// Lowercase copies for MQTT payloads (see rebuildLowercaseStatueNames())
+char STATUE_NAMES_LC[MAX_STATUES][10];
+const char *MY_STATUE_NAME_LC = STATUE_NAMES_LC[0];
+
+// Fill the runtime tables from the constexpr registry. Runs as a static
+// constructor, before setup() or any other sketch code touches them.
+__attribute__((constructor)) static void seedStatueDefaults() {
+  for (int i = 0; i < MAX_STATUES; i++) {
+    strncpy(STATUE_NAMES[i], kStatueDefaults[i].name, 9);
+    STATUE_NAMES[i][9] = '\0';
+    STATUE_FREQUENCIES[i] = kStatueDefaults[i].frequency;
+    STATUE_THRESHOLDS[i] = kStatueDefaults[i].threshold;
+    STATUE_UNLINK_RATIOS[i] = UNLINK_RATIO_DEFAULT;
+  }
+  rebuildLowercaseStatueNames();
+}
+
+// External references to detector-side arrays in AudioSense.ino
 extern float detectorThresholds[MAX_STATUES - 1];
+extern float detectorUnlinkRatios[MAX_STATUES - 1];
+
+void rebuildLowercaseStatueNames() {
+  for (int i = 0; i < MAX_STATUES; i++) {
+    for (int j = 0; j < 10; j++) {
+      STATUE_NAMES_LC[i][j] = (char)tolower((unsigned char)STATUE_NAMES[i][j]);
+    }
+    STATUE_NAMES_LC[i][9] = '\0';
+  }
+  MY_STATUE_NAME_LC = STATUE_NAMES_LC[MY_STATUE_INDEX];
+}
+
+// Name lookup dispatch: (length, first letter) is unique across the
+// registry, so a small compile-time table maps that pair straight to an
+// index and one case-insensitive compare confirms the match. No String
+// allocation, no if/else chain, and the table rebuilds itself when a
+// statue is added.
+static constexpr size_t nameLen(const char *s) {
+  size_t n = 0;
+  while (s[n] != '\0') {
+    n++;
+  }
+  return n;
+}
+
+static constexpr int dispatchKey(size_t len, char first) {
+  return (int)((len & 15u) * 26u) + (first - 'A');
+}
+
+struct NameDispatch {
+  int8_t index[16 * 26];
+};
+
+static constexpr NameDispatch buildNameDispatch() {
+  NameDispatch d{};
+  for (int k = 0; k < 16 * 26; k++) {
+    d.index[k] = -1;
+  }
+  for (int i = 0; i < MAX_STATUES; i++) {
+    const char *name = kStatueDefaults[i].name;
+    d.index[dispatchKey(nameLen(name), name[0])] = (int8_t)i;
+  }
+  return d;
+}
+
+static constexpr bool dispatchKeysUnique() {
+  for (int i = 0; i < MAX_STATUES; i++) {
+    for (int j = i + 1; j < MAX_STATUES; j++) {
+      const char *a = kStatueDefaults[i].name;
+      const char *b = kStatueDefaults[j].name;
+      if (dispatchKey(nameLen(a), a[0]) == dispatchKey(nameLen(b), b[0])) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
 
-// Helper function to map statue name to index
+static_assert(dispatchKeysUnique(),
+              "statue names collide in length+first-letter dispatch");
+
+static constexpr NameDispatch kNameDispatch = buildNameDispatch();
+
+// Map a statue name (any case) to its registry index, or -1 if unknown.
+// Called per JSON key during config parsing, so it does no allocation:
+// one table read plus one bounded compare.
 int getStatueIndex(const char *name) {
-  String nameUpper = String(name);
-  nameUpper.toUpperCase();
-
-  if (nameUpper == "EROS")
-    return 0;
-  else if (nameUpper == "ELEKTRA")
-    return 1;
-  else if (nameUpper == "ARIEL")
-    return 2;
-  else if (nameUpper == "SOPHIA")
-    return 3;
-  else if (nameUpper == "ULTIMO")
-    return 4;
-  else
-    return -1; // Unknown statue
+  if (name == NULL || name[0] == '\0') {
+    return -1;
+  }
+  size_t len = strlen(name);
+  int first = toupper((unsigned char)name[0]);
+  if (len > 9 || first < 'A' || first > 'Z') {
+    return -1;
+  }
+  int idx = kNameDispatch.index[dispatchKey(len, (char)first)];
+  if (idx < 0) {
+    return -1;
+  }
+  // The dispatch only narrows; confirm the full name, case-insensitive.
+  const char *want = kStatueDefaults[idx].name;
+  for (size_t i = 0; i < len; i++) {
+    if (toupper((unsigned char)name[i]) != want[i]) {
+      return -1;
+    }
+  }
+  return idx;
 }
 
 // Initialize the statue configuration based on hostname
 bool initStatueConfig() {
   // Get the hostname from reverse DNS
-  String myHostname = String(getHostname());
+  const char *myHostname = getHostname();
   Serial.println("=== Initializing Statue Configuration ===");
   Serial.print("My hostname: ");
   Serial.println(myHostname);
 
-  // Copy JSON from PROGMEM to RAM for parsing
-  size_t len = strlen_P(DEFAULT_CONFIG_JSON);
-  char *jsonBuffer = new char[len + 1];
-  strcpy_P(jsonBuffer, DEFAULT_CONFIG_JSON);
-
-  // Parse the JSON
-  StaticJsonDocument<2048> doc;
-  DeserializationError error = deserializeJson(doc, jsonBuffer, len);
+  // Fast path: a valid EEPROM cache fills the arrays with no parsing or
+  // allocation (see ConfigStore.h). Identity still comes from the
+  // hostname so a cached board can move between statues.
+  if (configStoreLoad()) {
+    int idx = -1;
+    for (int i = 0; i < MAX_STATUES; i++) {
+      if (strEqualsIgnoreCase(myHostname, STATUE_NAMES[i])) {
+        idx = i;
+        break;
+      }
+    }
+    if (idx >= 0) {
+      MY_STATUE_INDEX = idx;
+      THIS_STATUE_ID = 'A' + idx;
+      MY_TX_FREQ = STATUE_FREQUENCIES[idx];
+      MY_STATUE_NAME = STATUE_NAMES[idx];
+      rebuildLowercaseStatueNames();
+      updateDetectorThresholds();
+      Serial.printf("Identified as: %s (Statue %c, Index %d), TX %d Hz\n",
+                    MY_STATUE_NAME, THIS_STATUE_ID, idx, MY_TX_FREQ);
+      return true;
+    }
+    Serial.println("Hostname not in cached config; reparsing defaults");
+  }
 
-  // Clean up buffer
-  delete[] jsonBuffer;
+  // Filtered parse of the identity fields only: the per-statue scalars
+  // this pass consumes survive into the document, everything else
+  // (detect lists, future keys) is skipped at tokenizer level. Flash is
+  // memory-mapped on the Teensy 4, so the PROGMEM string parses in
+  // place - no heap copy, and the transient working set stays bounded
+  // as statues are added.
+  StaticJsonDocument<128> filter;
+  JsonObject perStatue = filter.createNestedObject("*");
+  perStatue["emit"] = true;
+  perStatue["threshold"] = true;
+  perStatue["unlink_ratio"] = true;
+  perStatue["ring"] = true;
+
+  StaticJsonDocument<1024> doc;
+  DeserializationError error =
+      deserializeJson(doc, DEFAULT_CONFIG_JSON, strlen_P(DEFAULT_CONFIG_JSON),
+                      DeserializationOption::Filter(filter));
 
   if (error) {
     Serial.print("Failed to parse statue config JSON: ");
@@ -71,33 +216,34 @@ bool initStatueConfig() {
 
   // Variables to track if we found our configuration
   bool configFound = false;
-  String matchedStatueName = "";
 
   // First pass: Find which statue we are based on hostname
   for (JsonPair kv : doc.as<JsonObject>()) {
-    String statueName = kv.key().c_str();
+    const char *statueName = kv.key().c_str();
     JsonObject statueConfig = kv.value();
 
     // Match statue name (JSON key) against hostname (case-insensitive)
-    if (statueName.equalsIgnoreCase(myHostname)) {
-      matchedStatueName = statueName;
+    if (strEqualsIgnoreCase(statueName, myHostname)) {
       configFound = true;
 
       // Set our identity
-      MY_STATUE_INDEX = getStatueIndex(statueName.c_str());
+      MY_STATUE_INDEX = getStatueIndex(statueName);
       THIS_STATUE_ID = 'A' + MY_STATUE_INDEX; // A=0, B=1, C=2, D=3, E=4
 
       if (statueConfig.containsKey("emit")) {
         MY_TX_FREQ = statueConfig["emit"].as<int>();
       }
 
-      // Store the name in uppercase
-      matchedStatueName.toUpperCase();
+      // Ring membership for multi-installation sites (see StatueConfig.h).
+      if (statueConfig.containsKey("ring")) {
+        MY_RING_ID = constrain(statueConfig["ring"].as<int>(), 1, 9);
+      }
+
       MY_STATUE_NAME =
           STATUE_NAMES[MY_STATUE_INDEX]; // Will be set properly below
 
       Serial.print("Identified as: ");
-      Serial.print(matchedStatueName);
+      Serial.print(statueName);
       Serial.print(" (Statue ");
       Serial.print(THIS_STATUE_ID);
       Serial.print(", Index ");
@@ -113,10 +259,10 @@ bool initStatueConfig() {
 
   // Second pass: Populate all statue frequencies, names, and thresholds arrays
   for (JsonPair kv : doc.as<JsonObject>()) {
-    String statueName = kv.key().c_str();
+    const char *statueName = kv.key().c_str();
     JsonObject statueConfig = kv.value();
 
-    int idx = getStatueIndex(statueName.c_str());
+    int idx = getStatueIndex(statueName);
     if (idx >= 0 && idx < MAX_STATUES) {
       // Get the emit frequency
       if (statueConfig.containsKey("emit")) {
@@ -128,10 +274,18 @@ bool initStatueConfig() {
         STATUE_THRESHOLDS[idx] = statueConfig["threshold"].as<float>();
       }
 
+      // Optional hysteresis release ratio for this statue
+      if (statueConfig.containsKey("unlink_ratio")) {
+        STATUE_UNLINK_RATIOS[idx] =
+            constrain(statueConfig["unlink_ratio"].as<float>(), 0.3f, 1.0f);
+      }
+
       // Store the name in uppercase
-      statueName.toUpperCase();
-      strncpy(STATUE_NAMES[idx], statueName.c_str(), 9);
-      STATUE_NAMES[idx][9] = '\0'; // Ensure null termination
+      size_t n = 0;
+      for (; statueName[n] && n < 9; n++) {
+        STATUE_NAMES[idx][n] = toupper((unsigned char)statueName[n]);
+      }
+      STATUE_NAMES[idx][n] = '\0'; // Ensure null termination
     }
   }
 
@@ -140,6 +294,9 @@ bool initStatueConfig() {
     MY_STATUE_NAME = STATUE_NAMES[MY_STATUE_INDEX];
   }
 
+  // Refresh the lowercase copies the MQTT publishers use.
+  rebuildLowercaseStatueNames();
+
   // Update detector thresholds based on parsed statue thresholds
   updateDetectorThresholds();
 
@@ -167,10 +324,18 @@ bool initStatueConfig() {
     return false;
   }
 
+  // Cache the parsed result so the next boot skips the JSON entirely.
+  configStoreSave();
+
   return true;
 }
 
-// Update detector thresholds based on current STATUE_THRESHOLDS array
+float pairThreshold(int detecting, int target) {
+  float pair = STATUE_PAIR_THRESHOLDS[detecting][target];
+  return (pair > 0.0f) ? pair : STATUE_THRESHOLDS[target];
+}
+
+// Update detector thresholds based on the current threshold tables
 // TODO: consolidate detector thresholds <-> statue thresholds
 void updateDetectorThresholds() {
   int detectorIndex = 0;
@@ -179,9 +344,9 @@ void updateDetectorThresholds() {
   for (int statue_idx = 0; statue_idx < NUM_STATUES; statue_idx++) {
     if (statue_idx != MY_STATUE_INDEX) {
       float oldThreshold = detectorThresholds[detectorIndex];
-      float newThreshold = STATUE_THRESHOLDS[statue_idx];
+      float newThreshold = pairThreshold(MY_STATUE_INDEX, statue_idx);
 
-      // Use the TARGET statue's threshold for detecting it
+      // Pair override first, else the TARGET statue's scalar
       if (oldThreshold != newThreshold) {
         if (!anyChanged) {
           Serial.println("\nUpdating detector thresholds:");
@@ -200,6 +365,9 @@ void updateDetectorThresholds() {
         Serial.println(newThreshold, 4);
       }
 
+      // Hysteresis release ratio rides along with the threshold refresh
+      detectorUnlinkRatios[detectorIndex] = STATUE_UNLINK_RATIOS[statue_idx];
+
       detectorIndex++;
     }
   }
@@ -208,6 +376,9 @@ void updateDetectorThresholds() {
     Serial.println("Detector thresholds unchanged");
   }
 
-  // Update the display to show the new threshold values
-  displayThresholds();
+  // Announce on the bus; the display (and any future consumer) repaints
+  // from the events task instead of being called into from here.
+  Event ev;
+  ev.type = EVENT_CONFIG_APPLIED;
+  eventBusPublish(ev);
 }
@@ -12,10 +12,25 @@ configuration, eliminating the need for compile-time statue identification.
 
 #include <Arduino.h>
 
-// Total number of statues (don't change this)
+// Total number of statues. The detector bank, buffering arrays, and link
+// masks all size themselves from this; scaling the installation is this
+// constant (plus a registry row in StatueConfig.cpp). This is capacity,
+// not topology: which peers actually get detector slots - and at which
+// frequencies - is decided at runtime from the retained presence
+// announcements (see handlePeerPresence in Messaging.ino), so within
+// this capacity a statue joins by powering on.
 #define MAX_STATUES 5
 #define NUM_STATUES 5
 
+// Link bitmask type, one bit per statue. Widens automatically when
+// MAX_STATUES grows past 8 so nothing downstream caps the statue count.
+#if MAX_STATUES <= 8
+typedef uint8_t StatueMask;
+#else
+typedef uint16_t StatueMask;
+#endif
+static_assert(MAX_STATUES <= 16, "StatueMask needs widening past 16 statues");
+
 // These are now dynamic variables, not compile-time constants
 // They are set at runtime based on IP address matching
 extern char THIS_STATUE_ID;        // 'A' through 'E' based on statue index
@@ -23,11 +38,50 @@ extern int MY_STATUE_INDEX;        // 0-4 based on which statue we are
 extern int MY_TX_FREQ;             // This statue's transmit frequency
 extern const char *MY_STATUE_NAME; // This statue's name
 
+// Which statue ring this board belongs to, for sites running two
+// installations on one Pi and broker. Ring 1 keeps today's missing_link
+// topic root on the wire; ring N >= 2 moves every topic under
+// missing_linkN (see ringTopic in Messaging.h), so the rings' traffic -
+// and each Teensy's subscription load - never interleave. Set with a
+// "ring" key on this statue's entry in the config JSON; cached in
+// EEPROM alongside the rest of the config.
+extern int MY_RING_ID;
+
 // Arrays populated from configuration
 extern int STATUE_FREQUENCIES[MAX_STATUES];  // All statue frequencies
 extern char STATUE_NAMES[MAX_STATUES][10];   // All statue names
 extern float STATUE_THRESHOLDS[MAX_STATUES]; // All statue thresholds
 
+// Per-pair threshold overrides: [detecting][target], 0 = unset. Cable
+// attenuation is pair-specific (a 200 ft run needs a looser threshold
+// than a 30 ft one), so a pair entry beats the target statue's scalar.
+extern float STATUE_PAIR_THRESHOLDS[MAX_STATUES][MAX_STATUES];
+
+// Threshold statue `detecting` should use for statue `target`: the pair
+// override when set, the target's scalar otherwise.
+float pairThreshold(int detecting, int target);
+
+// Schmitt-trigger hysteresis: once a statue is linked, the detector
+// releases at threshold * ratio instead of the threshold itself, so the
+// debounce window no longer has to paper over magnitude jitter around a
+// single trip point. Per target statue, configurable via "unlink_ratio"
+// in the config JSON.
+#define UNLINK_RATIO_DEFAULT 0.7f
+extern float STATUE_UNLINK_RATIOS[MAX_STATUES];
+
+// Lowercase statue names for MQTT payloads, derived once from STATUE_NAMES
+// so the publishers never build String temporaries per message.
+extern char STATUE_NAMES_LC[MAX_STATUES][10];
+extern const char *MY_STATUE_NAME_LC;
+
+// Rebuild STATUE_NAMES_LC / MY_STATUE_NAME_LC from the current
+// STATUE_NAMES. Called whenever the name table changes.
+void rebuildLowercaseStatueNames();
+
+// Map a statue name (any case) to its registry index, or -1 if unknown.
+// Allocation-free O(1) lookup; safe to call per JSON key.
+int getStatueIndex(const char *name);
+
 // Initialize the statue configuration based on IP address
 // Must be called after Ethernet initialization but before audioSenseSetup()
 // Returns true if successful, false if no matching IP found
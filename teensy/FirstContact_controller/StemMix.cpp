@@ -0,0 +1,160 @@
+/*
+StemMix.cpp - see StemMix.h for the design.
+
+Loop-side calls (setSong, syncTo, refreshCache) hand state to the audio
+update under a short IRQ lock; inside update() everything is plain RAM
+reads, so the node adds no SD or cache-scan work to the audio path.
+*/
+
+#include "StemMix.h"
+
+#include "SongCache.h"
+
+void AudioPlayStemSet::setSong(const SongInfo *base) {
+  if (base == baseSong) {
+    return;
+  }
+  __disable_irq();
+  baseSong = base;
+  for (int i = 0; i < STEM_MAX_LAYERS; i++) {
+    stems[i].info = nullptr;
+    stems[i].data = nullptr;
+    stems[i].frames = 0;
+    stems[i].frame = 0;
+    stems[i].gain = 0.0f;
+  }
+  __enable_irq();
+  if (base == nullptr) {
+    return;
+  }
+  for (int i = 0; i < STEM_MAX_LAYERS; i++) {
+    const SongInfo *stem = stemForSong(*base, i + 2);
+    if (stem == nullptr) {
+      continue;
+    }
+    if (stem->codec != SONG_CODEC_PCM16 || stem->sampleRate != 44100) {
+      // The mix loop indexes frames directly; no decoder or resampler on
+      // this path.
+      Serial.printf("StemMix: %s is not 16-bit 44.1 kHz PCM, skipping\n",
+                    stem->filename);
+      continue;
+    }
+    stems[i].info = stem;
+    // Queue for PSRAM promotion; refreshCache() picks the copy up once
+    // the background promotion finishes.
+    songCacheTouch(*stem);
+  }
+  refreshCache();
+}
+
+void AudioPlayStemSet::setChainSize(int statues) {
+  for (int i = 0; i < STEM_MAX_LAYERS; i++) {
+    stems[i].target = (statues >= i + 2) ? 1.0f : 0.0f;
+  }
+}
+
+void AudioPlayStemSet::syncTo(uint32_t baseByteOffset) {
+  if (baseSong == nullptr || baseSong->blockAlign == 0) {
+    return;
+  }
+  // Frames the base song has played; its byte position advances one
+  // blockAlign per samplesPerBlock frames (1:1 for PCM).
+  uint32_t baseFrame = (uint32_t)((uint64_t)baseByteOffset /
+                                  baseSong->blockAlign *
+                                  baseSong->samplesPerBlock);
+  __disable_irq();
+  for (int i = 0; i < STEM_MAX_LAYERS; i++) {
+    Stem &s = stems[i];
+    if (s.info == nullptr) {
+      continue;
+    }
+    uint32_t aligned = (baseFrame < s.frames) ? baseFrame : s.frames;
+    int32_t drift = (int32_t)(s.frame - aligned);
+    if (drift > STEM_RESYNC_FRAMES || drift < -STEM_RESYNC_FRAMES) {
+      s.frame = aligned;
+    }
+  }
+  __enable_irq();
+}
+
+void AudioPlayStemSet::refreshCache() {
+  for (int i = 0; i < STEM_MAX_LAYERS; i++) {
+    Stem &s = stems[i];
+    if (s.info == nullptr) {
+      continue;
+    }
+    const uint8_t *data = songCacheLookup(*s.info);
+    if (data == s.data) {
+      continue;
+    }
+    // Promotion finished (or the entry was evicted): swap the pointer
+    // under the lock with the bounds it describes.
+    __disable_irq();
+    s.data = nullptr;
+    s.stride = s.info->channels;
+    s.frames = s.info->dataLength / s.info->blockAlign;
+    if (s.frame > s.frames) {
+      s.frame = s.frames;
+    }
+    s.data = data;
+    __enable_irq();
+  }
+}
+
+void AudioPlayStemSet::update(void) {
+  const float step =
+      1000.0f / (STEM_FADE_MS * AUDIO_SAMPLE_RATE_EXACT);
+  int32_t acc[AUDIO_BLOCK_SAMPLES];
+  bool mixed = false;
+  for (int i = 0; i < STEM_MAX_LAYERS; i++) {
+    Stem &s = stems[i];
+    // Uncached or fully silent layers cost nothing; their cursors are
+    // realigned by syncTo() before they can become audible.
+    if (s.data == nullptr || (s.gain <= 0.0f && s.target <= 0.0f) ||
+        s.frame >= s.frames) {
+      continue;
+    }
+    if (!mixed) {
+      memset(acc, 0, sizeof(acc));
+      mixed = true;
+    }
+    const int16_t *src = (const int16_t *)s.data;
+    float g = s.gain;
+    uint32_t f = s.frame;
+    for (int n = 0; n < AUDIO_BLOCK_SAMPLES && f < s.frames; n++, f++) {
+      if (g < s.target) {
+        g += step;
+        if (g > s.target) {
+          g = s.target;
+        }
+      } else if (g > s.target) {
+        g -= step;
+        if (g < s.target) {
+          g = s.target;
+        }
+      }
+      // Left channel of stereo stems, matching the mono music path.
+      acc[n] += (int32_t)(g * (float)src[f * s.stride]);
+    }
+    s.gain = g;
+    s.frame = f;
+  }
+  if (!mixed) {
+    return;
+  }
+  audio_block_t *block = allocate();
+  if (block == NULL) {
+    return;
+  }
+  for (int n = 0; n < AUDIO_BLOCK_SAMPLES; n++) {
+    int32_t v = acc[n];
+    if (v > 32767) {
+      v = 32767;
+    } else if (v < -32768) {
+      v = -32768;
+    }
+    block->data[n] = (int16_t)v;
+  }
+  transmit(block);
+  release(block);
+}
@@ -0,0 +1,81 @@
+/*
+StemMix: stem layers over the active song, driven by chain size.
+
+The active songs play the same mix whether two people bridge one pair or a
+crowd chains all five statues. This node layers extra stems - files on the
+card named with the "stem" keyword and the base song's track number
+("active 1 stem 2.wav" is layer 2 of track 1) - over the streamed song,
+fading each layer in as the local chain estimate (direct links + us)
+reaches its number and back out as the chain shrinks.
+
+The SD streamer cannot be duplicated (AudioPlaySdStream's double buffer is
+a single static allocation, sized for one stream), so stems play from the
+PSRAM song cache instead: setSong() queues them for promotion and the node
+reads the finished copies straight from memory, costing zero SD bandwidth.
+Until a stem's promotion completes - or on boards without the PSRAM chip -
+that layer simply stays silent; the base song is never affected.
+
+Alignment is one-time, not continuous: playMusic() passes the streamer's
+byte position to syncTo() every pass, and the cursors free-run between
+checks since the same audio update clocks both paths. Stems are 16-bit PCM
+only and play at the base song's loudness gain (they are mastered against
+it; see setMusicVolume()).
+*/
+
+#ifndef STEM_MIX_H
+#define STEM_MIX_H
+
+#include "SongManifest.h"
+
+#include <Arduino.h>
+#include <Audio.h>
+
+// Layers 2..(STEM_MAX_LAYERS + 1): stem N becomes audible once the chain
+// estimate reaches N statues. 4 covers the full five-statue chain.
+#define STEM_MAX_LAYERS 4
+
+// Gain ramp when a layer turns on or off. Long enough to read as a
+// musical swell rather than a channel click.
+#define STEM_FADE_MS 400
+
+// Drift past this many frames against the base song triggers a cursor
+// jump in syncTo(); below it the free-running cursors are left alone.
+#define STEM_RESYNC_FRAMES 128
+
+class AudioPlayStemSet : public AudioStream {
+public:
+  AudioPlayStemSet() : AudioStream(0, NULL) {}
+
+  // Bind the layers to a base song (resolves its stems from the manifest
+  // and queues them for PSRAM promotion). Null or a song with no stems
+  // clears all layers. Loop context only.
+  void setSong(const SongInfo *base);
+
+  // Chain-size estimate; layer N ramps in while statues >= N.
+  void setChainSize(int statues);
+
+  // Align the stem cursors to the base song's byte position. Only jumps
+  // when the drift exceeds STEM_RESYNC_FRAMES.
+  void syncTo(uint32_t baseByteOffset);
+
+  // Pick up stem promotions the cache has finished since the last call;
+  // called from playMusic() alongside songCacheLoop().
+  void refreshCache();
+
+  virtual void update(void);
+
+private:
+  struct Stem {
+    const SongInfo *info = nullptr; // Manifest entry, null = layer unused
+    const uint8_t *data = nullptr;  // Full data chunk in PSRAM, or null
+    uint32_t frames = 0;            // Total frames in the stem
+    uint32_t frame = 0;             // Playback cursor
+    uint8_t stride = 1;             // Samples per frame (left taken)
+    float gain = 0.0f;              // Current ramped gain
+    float target = 0.0f;            // Where the ramp is headed
+  };
+  Stem stems[STEM_MAX_LAYERS];
+  const SongInfo *baseSong = nullptr;
+};
+
+#endif // STEM_MIX_H
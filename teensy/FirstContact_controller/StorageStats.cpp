@@ -0,0 +1,95 @@
+/*
+StorageStats.cpp - SD read-latency histogram and error counters.
+*/
+
+#include "StorageStats.h"
+
+// Bucket upper bounds in microseconds (log-scale). The last bucket is
+// open-ended; anything over 200 ms lands there.
+static const uint32_t BUCKET_LIMITS_US[STORAGE_BUCKET_COUNT] = {
+    500,   1000,  2000,   5000,   10000,  20000,
+    50000, 75000, 100000, 150000, 200000, 0xFFFFFFFF};
+
+// Current one-minute window. Only fillLoop() context writes these, and the
+// collector runs in the same loop() context, so no locking is needed.
+static uint32_t buckets[STORAGE_BUCKET_COUNT];
+static uint32_t readCount = 0;
+static uint32_t maxLatencyUs = 0;
+static uint32_t readErrors = 0;  // file.read() returned <= 0 mid-song
+static uint32_t shortReads = 0;  // file.read() returned less than asked
+static uint32_t openErrors = 0;  // SD.open() failed on a playback path
+
+// Lifetime error totals (not reset per window) - the interesting trend for
+// a degrading card is cumulative, and a missed MQTT publish loses nothing.
+static uint32_t totalReadErrors = 0;
+static uint32_t totalOpenErrors = 0;
+
+void storageRecordRead(uint32_t elapsedMicros, int got, uint32_t requested) {
+  readCount++;
+  if (elapsedMicros > maxLatencyUs) {
+    maxLatencyUs = elapsedMicros;
+  }
+  for (int i = 0; i < STORAGE_BUCKET_COUNT; i++) {
+    if (elapsedMicros <= BUCKET_LIMITS_US[i]) {
+      buckets[i]++;
+      break;
+    }
+  }
+  if (got <= 0) {
+    readErrors++;
+    totalReadErrors++;
+  } else if ((uint32_t)got < requested) {
+    shortReads++;
+  }
+}
+
+void storageRecordOpenError() {
+  openErrors++;
+  totalOpenErrors++;
+}
+
+// Smallest bucket upper bound that covers `rank` reads - the histogram
+// approximation of a percentile (resolution is the bucket width).
+static uint32_t bucketPercentile(uint32_t rank) {
+  uint32_t cumulative = 0;
+  for (int i = 0; i < STORAGE_BUCKET_COUNT; i++) {
+    cumulative += buckets[i];
+    if (cumulative >= rank) {
+      return BUCKET_LIMITS_US[i];
+    }
+  }
+  return maxLatencyUs;
+}
+
+void storageStatsBrief(char *out, size_t outLen) {
+  snprintf(out, outLen, "R:%lu mx:%lums E:%lu/%lu", (unsigned long)readCount,
+           (unsigned long)(maxLatencyUs / 1000),
+           (unsigned long)totalReadErrors, (unsigned long)totalOpenErrors);
+}
+
+bool storageStatsCollect(char *json, size_t jsonLen) {
+  if (readCount == 0 && readErrors == 0 && openErrors == 0) {
+    return false;
+  }
+
+  uint32_t p50 = bucketPercentile((readCount + 1) / 2);
+  uint32_t p95 = bucketPercentile((readCount * 95 + 99) / 100);
+
+  snprintf(json, jsonLen,
+           "{\"reads\":%lu,\"p50_us\":%lu,\"p95_us\":%lu,\"max_us\":%lu,"
+           "\"read_errors\":%lu,\"short_reads\":%lu,\"open_errors\":%lu,"
+           "\"total_read_errors\":%lu,\"total_open_errors\":%lu}",
+           (unsigned long)readCount, (unsigned long)p50, (unsigned long)p95,
+           (unsigned long)maxLatencyUs, (unsigned long)readErrors,
+           (unsigned long)shortReads, (unsigned long)openErrors,
+           (unsigned long)totalReadErrors, (unsigned long)totalOpenErrors);
+
+  // Reset the window; lifetime totals carry over.
+  memset(buckets, 0, sizeof(buckets));
+  readCount = 0;
+  maxLatencyUs = 0;
+  readErrors = 0;
+  shortReads = 0;
+  openErrors = 0;
+  return true;
+}
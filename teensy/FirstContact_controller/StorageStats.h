@@ -0,0 +1,41 @@
+/*
+StorageStats: SD card health and read-latency telemetry.
+
+Two on-site failures were dying SD cards that showed up as intermittent
+audio dropouts and were only diagnosed by swapping hardware. Every SD read
+the streamer makes (SdStream.cpp) is now timed into a log-scale latency
+histogram, and errors (failed opens, failed or short reads) are counted.
+Once a minute the window is summarized - p50/p95/max latency plus the
+error counters - and published on missing_link/storage (Messaging.ino), so
+a card can be watched degrading days before it dies.
+
+Recording is a few instructions (one bucket increment); it runs in
+fillLoop() context, never in the audio update.
+*/
+
+#ifndef STORAGE_STATS_H
+#define STORAGE_STATS_H
+
+#include <Arduino.h>
+
+// Log-scale bucket upper bounds in microseconds. A healthy card reads a
+// 32 KB chunk in ~2-4 ms; a dying one wanders into the 100 ms+ buckets.
+#define STORAGE_BUCKET_COUNT 12
+
+// Record one SD read: how long it took and how it ended.
+// `got` is the file.read() return value, `requested` the bytes asked for.
+void storageRecordRead(uint32_t elapsedMicros, int got, uint32_t requested);
+
+// Record a failed SD.open() on a playback path.
+void storageRecordOpenError();
+
+// Summarize the current window into a JSON object (p50/p95/max in
+// microseconds, read/error counters) and reset it. Returns false when the
+// window saw no reads and nothing was written.
+bool storageStatsCollect(char *json, size_t jsonLen);
+
+// One-line summary of the current window (reads, max latency, lifetime
+// errors) for the on-screen diagnostics page. Does not reset anything.
+void storageStatsBrief(char *out, size_t outLen);
+
+#endif // STORAGE_STATS_H
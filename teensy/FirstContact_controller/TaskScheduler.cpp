@@ -0,0 +1,185 @@
+/*
+TaskScheduler.cpp - cooperative task table with DWT cycle-counter timing.
+
+Run times come from the Cortex-M7 DWT cycle counter (the Teensy 4 core
+enables it at startup), so a measurement costs two register reads
+instead of a micros() call and resolves single cycles. Each task keeps a
+log2 histogram of run times; the minute summary reports p50/p95/max per
+task, which is what actually shows a stage going bimodal - an average
+hides the one slow run in a thousand that eats the sensing cadence.
+*/
+
+#include "TaskScheduler.h"
+
+#include "Watchdog.h"
+
+#include <stdio.h>
+
+struct Task {
+  const char *name;
+  TaskFn fn;
+  uint32_t periodMs; // 0 = every pass
+  uint32_t budgetUs;
+  uint32_t lastRunMs;
+  // Stats window, reset by schedulerStatsCollect().
+  uint32_t runs;
+  uint32_t overruns;
+  uint32_t maxUs;
+  uint32_t hist[SCHED_HIST_BUCKETS]; // Bucket n: run <= 2^n us
+};
+
+static Task tasks[SCHED_MAX_TASKS];
+static int taskCount = 0;
+
+// Idle accounting for the stats window. Busy time is the sum of the
+// task-body run times already measured below; everything else in the
+// window counts as idle. That charges the dispatch loop to idle, but
+// once WFI caps the pass rate at the interrupt rate the dispatch
+// overhead is noise. Measured this way because the DWT cycle counter
+// is clock-gated inside WFI and cannot time the sleep directly.
+static uint32_t busyUs = 0;
+static uint32_t sleepCount = 0;
+static uint32_t windowStartMs = 0;
+
+void schedulerAddTask(const char *name, TaskFn fn, uint32_t periodMs,
+                      uint32_t budgetUs) {
+  if (taskCount >= SCHED_MAX_TASKS) {
+    Serial.printf("Scheduler: task table full, dropping %s\n", name);
+    return;
+  }
+  Task &t = tasks[taskCount++];
+  t.name = name;
+  t.fn = fn;
+  t.periodMs = periodMs;
+  t.budgetUs = budgetUs;
+  t.lastRunMs = millis();
+  t.runs = 0;
+  t.overruns = 0;
+  t.maxUs = 0;
+  memset(t.hist, 0, sizeof(t.hist));
+}
+
+void schedulerRun() {
+  // DWT cycles per microsecond at the current core clock.
+  const uint32_t cyclesPerUs = F_CPU_ACTUAL / 1000000;
+
+  // One feed per pass: a single task hanging starves the feed and the
+  // watchdog resets us with that task's id still in the stage marker.
+  watchdogFeed();
+
+  for (int i = 0; i < taskCount; i++) {
+    Task &t = tasks[i];
+    uint32_t now = millis();
+    if (t.periodMs != 0 && (now - t.lastRunMs) < t.periodMs) {
+      continue;
+    }
+    t.lastRunMs = now;
+
+    watchdogNoteStage((uint8_t)i);
+    uint32_t startCycles = ARM_DWT_CYCCNT;
+    t.fn();
+    uint32_t elapsed = (ARM_DWT_CYCCNT - startCycles) / cyclesPerUs;
+    watchdogNoteStage(WATCHDOG_STAGE_IDLE);
+
+    t.runs++;
+    busyUs += elapsed;
+    if (elapsed > t.maxUs) {
+      t.maxUs = elapsed;
+    }
+    if (t.budgetUs != 0 && elapsed > t.budgetUs) {
+      t.overruns++;
+    }
+    int bucket = 0;
+    while ((1UL << bucket) < elapsed && bucket < SCHED_HIST_BUCKETS - 1) {
+      bucket++;
+    }
+    t.hist[bucket]++;
+  }
+
+  // Park until the next interrupt. CCM_CLPCR stays in RUN mode, so this
+  // only gates the ARM core clock - peripherals, DMA, and the audio PLL
+  // keep running and wake-up is a few cycles. A pending interrupt makes
+  // WFI fall straight through, and systick bounds the sleep at 1 ms, so
+  // no poll-style task waits longer than that.
+  sleepCount++;
+  asm volatile("wfi");
+}
+
+// Smallest bucket bound covering `rank` runs of task `t`.
+static uint32_t taskPercentile(const Task &t, uint32_t rank) {
+  uint32_t cumulative = 0;
+  for (int i = 0; i < SCHED_HIST_BUCKETS; i++) {
+    cumulative += t.hist[i];
+    if (cumulative >= rank) {
+      return 1UL << i;
+    }
+  }
+  return t.maxUs;
+}
+
+bool schedulerStatsCollect(char *json, size_t jsonLen) {
+  size_t pos = 0;
+  bool any = false;
+
+  pos += snprintf(json + pos, jsonLen - pos, "{");
+  for (int i = 0; i < taskCount && pos < jsonLen; i++) {
+    Task &t = tasks[i];
+    if (t.runs == 0) {
+      continue;
+    }
+    any = true;
+    pos += snprintf(json + pos, jsonLen - pos,
+                    "%s\"%s\":{\"runs\":%lu,\"over\":%lu,\"p50_us\":%lu,"
+                    "\"p95_us\":%lu,\"max_us\":%lu}",
+                    (pos > 1) ? "," : "", t.name, (unsigned long)t.runs,
+                    (unsigned long)t.overruns,
+                    (unsigned long)taskPercentile(t, (t.runs + 1) / 2),
+                    (unsigned long)taskPercentile(t, (t.runs * 95 + 99) / 100),
+                    (unsigned long)t.maxUs);
+    t.runs = 0;
+    t.overruns = 0;
+    t.maxUs = 0;
+    memset(t.hist, 0, sizeof(t.hist));
+  }
+
+  // Idle share of the window: wall time minus summed task-body time.
+  uint32_t now = millis();
+  uint64_t windowUs = (uint64_t)(now - windowStartMs) * 1000;
+  uint32_t idlePct = 0;
+  if (windowUs > busyUs) {
+    idlePct = (uint32_t)((windowUs - busyUs) * 100 / windowUs);
+  }
+  if (any && pos < jsonLen) {
+    pos += snprintf(json + pos, jsonLen - pos,
+                    ",\"idle\":{\"pct\":%lu,\"sleeps\":%lu}",
+                    (unsigned long)idlePct, (unsigned long)sleepCount);
+  }
+  busyUs = 0;
+  sleepCount = 0;
+  windowStartMs = now;
+
+  if (pos < jsonLen) {
+    pos += snprintf(json + pos, jsonLen - pos, "}");
+  }
+  return any && pos < jsonLen;
+}
+
+int schedulerTaskCount() { return taskCount; }
+
+const char *schedulerTaskName(int idx) {
+  if (idx < 0 || idx >= taskCount) {
+    return NULL;
+  }
+  return tasks[idx].name;
+}
+
+bool schedulerTaskBrief(int idx, char *out, size_t outLen) {
+  if (idx < 0 || idx >= taskCount) {
+    return false;
+  }
+  const Task &t = tasks[idx];
+  snprintf(out, outLen, "%-6.6s %lu/%lu/%lu", t.name,
+           (unsigned long)taskPercentile(t, (t.runs + 1) / 2),
+           (unsigned long)t.maxUs, (unsigned long)t.overruns);
+  return true;
+}
@@ -0,0 +1,59 @@
+/*
+TaskScheduler: cooperative task scheduler for the main loop.
+
+loop() used to run every subsystem serially on every pass - any one of
+them stalling stalled all of them, and nothing measured who was slow.
+Subsystems now register as tasks with a period (0 = every pass) and a
+time budget; schedulerRun() steps the due tasks, times each run, and
+counts budget overruns per task. The touch-sensing task gets a
+guaranteed cadence regardless of what messaging or display are doing,
+and the overrun counters point straight at whichever task is eating the
+loop when latency drifts.
+
+Tasks are plain functions and run to completion - this is cooperative
+scheduling, not preemption; the budget is a tripwire, not an enforcer.
+
+Between passes the scheduler executes WFI instead of spinning: every
+piece of real work here is started by an interrupt we already take
+(audio block ready, systick, Ethernet RX, USB), so parking the core
+until the next one costs at most one systick (1 ms) of poll latency
+and stops 600 MHz of busy-waiting from heating the box and coupling
+into the analog front end. The stats summary reports the idle
+percentage so the saving is visible, not assumed.
+*/
+
+#ifndef TASK_SCHEDULER_H
+#define TASK_SCHEDULER_H
+
+#include <Arduino.h>
+
+#define SCHED_MAX_TASKS 16
+
+// Log2 run-time histogram per task: bucket n covers runs <= 2^n us.
+#define SCHED_HIST_BUCKETS 20
+
+typedef void (*TaskFn)();
+
+// Register a task. `periodMs` 0 runs it every pass; `budgetUs` is the
+// per-run time above which the run counts as an overrun.
+void schedulerAddTask(const char *name, TaskFn fn, uint32_t periodMs,
+                      uint32_t budgetUs);
+
+// One scheduler pass: run every task whose period has elapsed, then
+// park the core in WFI until the next interrupt.
+void schedulerRun();
+
+// Summarize per-task runs/overruns and run-time percentiles (us) into a
+// JSON object and reset the window. Returns false when nothing ran.
+bool schedulerStatsCollect(char *json, size_t jsonLen);
+
+// Number of registered tasks, and a one-line non-destructive summary of
+// task `idx` ("name p50/max/over") for the on-screen diagnostics page.
+int schedulerTaskCount();
+bool schedulerTaskBrief(int idx, char *out, size_t outLen);
+
+// Name of task `idx`, or NULL out of range. Used by the watchdog report
+// to turn a persisted stage id back into a task name.
+const char *schedulerTaskName(int idx);
+
+#endif // TASK_SCHEDULER_H
@@ -0,0 +1,35 @@
+/*
+TdmSchedule: Optional time-division tone scheduling.
+
+With five statues transmitting continuously at 10-19.5 kHz, intermodulation
+through linked human chains produces ghost detections. In TDM mode each
+statue transmits only in its assigned slot and each detector integrates
+only while its target statue's slot is active, which rejects everything the
+target is not actually transmitting.
+
+The slot map rides in the existing missing_link/config/response JSON:
+  "tdm": {"enabled": true, "slot_ms": 50, "slots": {"eros": 0, ...}}
+Slot boundaries are aligned to a sync beacon the Pi publishes on
+missing_link/tdm/sync; each statue latches millis() on receipt, so the
+statues only need to agree to within a few ms over the LAN.
+*/
+
+#ifndef TDM_SCHEDULE_H
+#define TDM_SCHEDULE_H
+
+#include <Arduino.h>
+
+// Configure (or disable) TDM from a parsed config push.
+void tdmConfigure(bool enabled, int slotMs, const int *slotOfStatue,
+                  int numSlots);
+
+// A sync beacon arrived: align the slot epoch to now.
+void tdmSyncBeacon();
+
+// Advance the slot state machine; called from the sense timer tick so the
+// gates switch with timer (not loop) jitter.
+void tdmTick();
+
+bool isTdmEnabled();
+
+#endif // TDM_SCHEDULE_H
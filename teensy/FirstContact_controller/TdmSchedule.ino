@@ -0,0 +1,82 @@
+/*
+TdmSchedule: Time-division tone scheduling state machine.
+*/
+
+#include "AudioSense.h"
+#include "StatueConfig.h"
+#include "TdmSchedule.h"
+
+static bool tdmEnabled = false;
+static int tdmSlotMs = 50;
+static int tdmNumSlots = MAX_STATUES;
+static int tdmSlotOfStatue[MAX_STATUES] = {0, 1, 2, 3, 4};
+static unsigned long tdmEpochMs = 0;
+static int tdmCurrentSlot = -1;
+
+bool isTdmEnabled() { return tdmEnabled; }
+
+void tdmConfigure(bool enabled, int slotMs, const int *slotOfStatue,
+                  int numSlots) {
+  bool wasEnabled = tdmEnabled;
+
+  tdmEnabled = enabled;
+  if (slotMs > 0) {
+    tdmSlotMs = slotMs;
+  }
+  if (numSlots > 0 && numSlots <= MAX_STATUES) {
+    tdmNumSlots = numSlots;
+  }
+  if (slotOfStatue != nullptr) {
+    for (int i = 0; i < MAX_STATUES; i++) {
+      tdmSlotOfStatue[i] = slotOfStatue[i];
+    }
+  }
+
+  if (enabled && !wasEnabled) {
+    tdmEpochMs = millis();
+    tdmCurrentSlot = -1;
+    Serial.printf("TDM enabled: slot %d ms, %d slots, my slot %d\n",
+                  tdmSlotMs, tdmNumSlots, tdmSlotOfStatue[MY_STATUE_INDEX]);
+  } else if (!enabled && wasEnabled) {
+    // Reopen everything: continuous transmission, all detectors integrating.
+    setToneGate(true);
+    int detectorIndex = 0;
+    for (int statue_idx = 0; statue_idx < NUM_STATUES; statue_idx++) {
+      if (statue_idx != MY_STATUE_INDEX) {
+        setDetectorGate(detectorIndex, false);
+        detectorIndex++;
+      }
+    }
+    Serial.println("TDM disabled: continuous transmission restored");
+  }
+}
+
+void tdmSyncBeacon() {
+  // Align the slot epoch; MQTT delivery jitter over the LAN is a few ms,
+  // small against the 50 ms slots.
+  tdmEpochMs = millis();
+}
+
+void tdmTick() {
+  if (!tdmEnabled) {
+    return;
+  }
+
+  int slot = (int)(((millis() - tdmEpochMs) / tdmSlotMs) % tdmNumSlots);
+  if (slot == tdmCurrentSlot) {
+    return;
+  }
+  tdmCurrentSlot = slot;
+
+  // Transmit only in our own slot.
+  setToneGate(slot == tdmSlotOfStatue[MY_STATUE_INDEX]);
+
+  // Each detector integrates only while its target statue transmits.
+  int detectorIndex = 0;
+  for (int statue_idx = 0; statue_idx < NUM_STATUES; statue_idx++) {
+    if (statue_idx != MY_STATUE_INDEX) {
+      setDetectorGate(detectorIndex, slot != tdmSlotOfStatue[statue_idx]);
+      detectorIndex++;
+    }
+  }
+}
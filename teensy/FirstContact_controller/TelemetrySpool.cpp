@@ -0,0 +1,149 @@
+/*
+TelemetrySpool.cpp - the spool file and its two cursors.
+
+Single-threaded like the journal: appends come from the publishers and
+peeks/pops from drainPublishQueue(), all in loop context, so two plain
+offsets are enough. The file is opened lazily once the card mounts
+(O_TRUNC - the spool does not survive reboot by design) and rewound to
+zero whenever the drain catches up, so a quiet show never grows it.
+*/
+
+#include "TelemetrySpool.h"
+
+#include <SD.h>
+
+#include "Log.h"
+#include "MusicPlayer.h"
+#include "SdArbiter.h"
+
+#define SPOOL_FILE "SPOOL.BIN"
+// Cap at roughly half an hour of outage (signals at the spool rate plus
+// a busy night of contact events). Past this, newest frames drop.
+#define SPOOL_MAX_BYTES (512UL * 1024)
+
+struct __attribute__((packed)) SpoolHeader {
+  uint16_t topicLen;   // Including the NUL
+  uint16_t payloadLen; // Including the NUL
+};
+
+static FsFile spoolFile;
+static bool spoolIsOpen = false;
+static uint32_t writeOffset = 0;
+static uint32_t readOffset = 0;
+static uint32_t droppedFrames = 0;
+
+// spoolPeek() cache: the record is read off the card once and served
+// from RAM until spoolPop(), so a publish retry costs no card time.
+static bool peekValid = false;
+static char peekTopic[SPOOL_TOPIC_MAX];
+static char peekPayload[SPOOL_PAYLOAD_MAX];
+static uint32_t peekRecordBytes = 0;
+
+static bool ensureOpen() {
+  if (spoolIsOpen) {
+    return true;
+  }
+  if (!musicReady()) {
+    return false;
+  }
+  spoolFile = SD.sdfs.open(SPOOL_FILE, O_RDWR | O_CREAT | O_TRUNC);
+  if (!spoolFile.isOpen()) {
+    return false;
+  }
+  spoolIsOpen = true;
+  writeOffset = 0;
+  readOffset = 0;
+  LOG_INFO("spool: ready");
+  return true;
+}
+
+bool spoolAppend(const char *topic, const char *payload) {
+  if (!ensureOpen()) {
+    droppedFrames++;
+    return false;
+  }
+  SpoolHeader header;
+  header.topicLen = (uint16_t)(strlen(topic) + 1);
+  header.payloadLen = (uint16_t)(strlen(payload) + 1);
+  if (header.topicLen > SPOOL_TOPIC_MAX ||
+      header.payloadLen > SPOOL_PAYLOAD_MAX) {
+    droppedFrames++;
+    return false;
+  }
+  uint32_t recordBytes = sizeof(header) + header.topicLen + header.payloadLen;
+  if (writeOffset + recordBytes > SPOOL_MAX_BYTES) {
+    droppedFrames++;
+    return false;
+  }
+  if (!sdIoBegin(SD_IO_JOURNAL)) {
+    // Denied pass: the caller keeps its drop-oldest fallback rather
+    // than stalling a publisher on the card.
+    droppedFrames++;
+    return false;
+  }
+  bool ok = spoolFile.seekSet(writeOffset) &&
+            spoolFile.write(&header, sizeof(header)) == sizeof(header) &&
+            spoolFile.write(topic, header.topicLen) == header.topicLen &&
+            spoolFile.write(payload, header.payloadLen) == header.payloadLen;
+  sdIoEnd(SD_IO_JOURNAL);
+  if (!ok) {
+    droppedFrames++;
+    return false;
+  }
+  writeOffset += recordBytes;
+  return true;
+}
+
+bool spoolEmpty() { return !spoolIsOpen || readOffset >= writeOffset; }
+
+bool spoolPeek(char *topic, size_t topicLen, char *payload,
+               size_t payloadLen) {
+  if (spoolEmpty()) {
+    return false;
+  }
+  if (!peekValid) {
+    if (!sdIoBegin(SD_IO_JOURNAL)) {
+      return false;
+    }
+    SpoolHeader header;
+    bool ok = spoolFile.seekSet(readOffset) &&
+              spoolFile.read(&header, sizeof(header)) == sizeof(header) &&
+              header.topicLen > 0 && header.topicLen <= SPOOL_TOPIC_MAX &&
+              header.payloadLen > 0 && header.payloadLen <= SPOOL_PAYLOAD_MAX &&
+              spoolFile.read(peekTopic, header.topicLen) == header.topicLen &&
+              spoolFile.read(peekPayload, header.payloadLen) ==
+                  header.payloadLen;
+    sdIoEnd(SD_IO_JOURNAL);
+    if (!ok) {
+      // A mangled record poisons everything behind it; abandon the
+      // backlog rather than replay garbage.
+      LOG_WARN("spool: corrupt record at %lu; backlog abandoned",
+               (unsigned long)readOffset);
+      readOffset = writeOffset;
+      return false;
+    }
+    peekTopic[header.topicLen - 1] = '\0';
+    peekPayload[header.payloadLen - 1] = '\0';
+    peekRecordBytes = sizeof(header) + header.topicLen + header.payloadLen;
+    peekValid = true;
+  }
+  snprintf(topic, topicLen, "%s", peekTopic);
+  snprintf(payload, payloadLen, "%s", peekPayload);
+  return true;
+}
+
+void spoolPop() {
+  if (!peekValid) {
+    return;
+  }
+  readOffset += peekRecordBytes;
+  peekValid = false;
+  if (readOffset >= writeOffset) {
+    // Fully drained: rewind so the next outage starts from zero.
+    spoolFile.truncate(0);
+    writeOffset = 0;
+    readOffset = 0;
+  }
+}
+
+uint32_t spoolDropped() { return droppedFrames; }
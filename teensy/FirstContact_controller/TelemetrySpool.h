@@ -0,0 +1,53 @@
+/*
+TelemetrySpool: SD-backed store-and-forward for outbound MQTT frames.
+
+The outbound queue in Messaging.ino rides out socket backpressure, but
+its RAM ring holds eight events: when the Pi reboots (it does, every
+event) anything past that was dropped, and the minutes most worth
+analyzing afterward were exactly the ones with holes. The spool is the
+overflow tier: when the ring is full, the oldest frame spills into a
+spool file on the SD card instead of being dropped, and slow-scanned
+signal frames are spooled directly during an outage. On reconnect the
+drain replays the spool in arrival order, oldest first, before the RAM
+ring - and every frame already carries its shared-clock "ts", so the
+Pi reconstructs the true timeline regardless of when the frames land.
+
+The spool is an outage buffer, not an archive: it is truncated at boot
+(durable link history is EventJournal's job) and appends are not
+synced - a power cut loses only frames the broker was going to miss
+anyway. Record format: a packed (topicLen, payloadLen) header followed
+by both NUL-terminated strings. Card access goes through the arbiter
+at journal priority; a denied grant just defers the spill or the
+replay by a pass.
+*/
+
+#ifndef TELEMETRY_SPOOL_H
+#define TELEMETRY_SPOOL_H
+
+#include <Arduino.h>
+
+// Longest frame the spool accepts (the signals frame is the biggest).
+#define SPOOL_TOPIC_MAX 48
+#define SPOOL_PAYLOAD_MAX 768
+
+// Append one frame behind everything already spooled. False when the
+// card is not mounted, the spool is at its size cap, or the arbiter
+// denied the pass - the caller falls back to its drop-oldest behavior.
+bool spoolAppend(const char *topic, const char *payload);
+
+// Copy the oldest unsent frame out without consuming it; the same frame
+// is returned again until spoolPop(). False when empty or the card is
+// busy this pass.
+bool spoolPeek(char *topic, size_t topicLen, char *payload,
+               size_t payloadLen);
+
+// Consume the frame last returned by spoolPeek(). Rewinds and reuses
+// the file once fully drained.
+void spoolPop();
+
+bool spoolEmpty();
+
+// Frames lost because the spool could not take them (lifetime).
+uint32_t spoolDropped();
+
+#endif // TELEMETRY_SPOOL_H
@@ -0,0 +1,39 @@
+/*
+TxLevel: closed-loop transmit amplitude control.
+
+Every statue used to transmit at amplitude 1.0 at all times, which
+maximizes crosstalk between adjacent cable runs and forces conservative
+thresholds installation-wide. The peers' missing_link/signals frames
+already report, at 10 Hz, the magnitude each statue receives on every
+bin - including this statue's tone. This module subscribes to that
+topic and closes a slow loop around it: while a peer is linked to us,
+its reported through-body magnitude over its detection threshold is the
+margin our tone actually has, and the amplitude steps down a few percent
+a second toward the minimum that keeps the worst such margin above
+target, stepping back up faster when it erodes.
+
+Unlinked peers only ever see crosstalk, so they carry no information
+about the link path and never drive the loop. When a contact is forming
+or breaking anywhere locally (the threshold hysteresis band, same signal
+the power governor uses), the amplitude snaps straight back to full and
+holds there, so a new link is always acquired at full strength and the
+optimization only shaves the steady state. No fresh peer reports, a
+running frequency sweep, or a dead broker all park the level at full.
+*/
+
+#ifndef TX_LEVEL_H
+#define TX_LEVEL_H
+
+#include <Arduino.h>
+
+// MQTT handler for missing_link/signals (peers' receive reports).
+void handleSignalsReport(const char *payload, unsigned int length);
+
+// Drive the control loop; scheduled at 100 ms so the full-power snap on
+// a forming contact is prompt (the trim steps run on a 1 s cadence).
+void txLevelLoop();
+
+// The amplitude currently applied, for telemetry.
+float txLevelAmplitude();
+
+#endif // TX_LEVEL_H
@@ -0,0 +1,149 @@
+/*
+  TxLevel implementation. See TxLevel.h for the control story.
+*/
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+#include "AudioSense.h"
+#include "FreqSweep.h"
+#include "Log.h"
+#include "Networking.h"
+#include "StatueConfig.h"
+#include "TxLevel.h"
+
+// Never trim below this: an established link must survive the worst cable
+// pair in the installation even if the margin estimate is off.
+#define TX_AMP_MIN 0.3f
+#define TX_AMP_MAX 1.0f
+
+// Trim band for the worst linked peer's magnitude-over-threshold ratio.
+// Below TARGET the level steps up fast; above RELAX it trims down a few
+// percent per second; between the two it holds (deadband, so the loop
+// does not hunt on grip jitter).
+#define TX_MARGIN_TARGET 6.0f
+#define TX_MARGIN_RELAX 9.0f
+#define TX_STEP_UP 1.10f
+#define TX_STEP_DOWN 0.97f
+#define TX_TRIM_PERIOD_MS 1000
+
+// Mirrors NOISE_FLOOR_MARGIN in AudioSense.ino: the peer's effective
+// threshold is its reported floor times this, capped by the config pair
+// ceiling.
+#define TX_PEER_FLOOR_MARGIN 4.0f
+
+// Reports older than this no longer vouch for the link path.
+#define TX_REPORT_STALE_MS 3000
+
+// How long after a contact transition the level holds at full.
+#define TX_BOOST_HOLD_MS 10000
+
+extern volatile StatueMask latestLinkedMask; // AudioSense.ino
+
+// Last receive report per peer: what that statue sees on OUR bin.
+static float peerMag[MAX_STATUES];
+static float peerFloor[MAX_STATUES];
+static unsigned long peerAtMs[MAX_STATUES];
+
+static float txAmp = TX_AMP_MAX;
+static unsigned long lastTrimMs = 0;
+static unsigned long boostUntilMs = 0;
+
+void handleSignalsReport(const char *payload, unsigned int length) {
+  // The frame carries every bin for every peer at 10 Hz; filter it down
+  // to the sender and the two numbers about our own tone.
+  StaticJsonDocument<96> filter;
+  filter["detector"] = true;
+  filter["signals"][MY_STATUE_NAME_LC] = true;
+  filter["floors"][MY_STATUE_NAME_LC] = true;
+  StaticJsonDocument<192> doc;
+  if (deserializeJson(doc, payload, length,
+                      DeserializationOption::Filter(filter)) !=
+      DeserializationError::Ok) {
+    return;
+  }
+  int idx = getStatueIndex(doc["detector"] | "");
+  if (idx < 0 || idx == MY_STATUE_INDEX) {
+    return; // Unknown sender, or the broker echoing our own report
+  }
+  peerMag[idx] = doc["signals"][MY_STATUE_NAME_LC] | 0.0f;
+  peerFloor[idx] = doc["floors"][MY_STATUE_NAME_LC] | 0.0f;
+  peerAtMs[idx] = millis();
+}
+
+static void applyAmp(float amp) {
+  txAmp = amp;
+  audioSenseSetTxAmplitude(amp);
+}
+
+void txLevelLoop() {
+  unsigned long now = millis();
+
+  // Full power whenever the loop has no solid footing: a contact forming
+  // or breaking (acquire at full strength), a sweep borrowing the tone,
+  // or no broker to carry the peer reports.
+  if (audioSenseTransitionActive()) {
+    boostUntilMs = now + TX_BOOST_HOLD_MS;
+  }
+  if (!networkReady() || isSweepActive() || (long)(boostUntilMs - now) > 0) {
+    if (txAmp < TX_AMP_MAX) {
+      applyAmp(TX_AMP_MAX);
+      LOG_INFO("tx level: full (boost)");
+    }
+    lastTrimMs = now;
+    return;
+  }
+
+  if (now - lastTrimMs < TX_TRIM_PERIOD_MS) {
+    return;
+  }
+  lastTrimMs = now;
+
+  // Worst margin across peers currently linked to us with a fresh
+  // report. Unlinked peers only see crosstalk and never drive the loop.
+  StatueMask mask = latestLinkedMask;
+  float worst = -1.0f;
+  for (int i = 0; i < NUM_STATUES; i++) {
+    if (i == MY_STATUE_INDEX || !(mask & (1 << i))) {
+      continue;
+    }
+    if (peerAtMs[i] == 0 || now - peerAtMs[i] > TX_REPORT_STALE_MS) {
+      continue;
+    }
+    float eff = peerFloor[i] * TX_PEER_FLOOR_MARGIN;
+    float ceiling = pairThreshold(i, MY_STATUE_INDEX);
+    if (eff > ceiling) {
+      eff = ceiling;
+    }
+    if (eff < 0.001f) {
+      eff = 0.001f;
+    }
+    float margin = peerMag[i] / eff;
+    if (worst < 0.0f || margin < worst) {
+      worst = margin;
+    }
+  }
+
+  if (worst < 0.0f) {
+    return; // No linked peer reporting: hold the learned level
+  }
+
+  float amp = txAmp;
+  if (worst < TX_MARGIN_TARGET) {
+    amp *= TX_STEP_UP;
+  } else if (worst > TX_MARGIN_RELAX) {
+    amp *= TX_STEP_DOWN;
+  }
+  amp = constrain(amp, TX_AMP_MIN, TX_AMP_MAX);
+  if (amp != txAmp) {
+    static float lastLogged = TX_AMP_MAX;
+    applyAmp(amp);
+    if (fabsf(amp - lastLogged) >= 0.1f) {
+      LOG_INFO("tx level: %.2f (worst margin %.1f)", (double)amp,
+               (double)worst);
+      lastLogged = amp;
+    }
+  }
+}
+
+float txLevelAmplitude() { return txAmp; }
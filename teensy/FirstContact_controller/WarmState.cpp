@@ -0,0 +1,96 @@
+/*
+WarmState.cpp - the DMAMEM record and its sampling/validation.
+
+The record is written whole once a second with the CRC last, so a reset
+landing mid-write leaves a bad CRC and the snapshot is simply not
+restored - one stale second of state is the worst case either way.
+*/
+
+#include "WarmState.h"
+
+#include "SdStream.h"
+
+// Live state sampled from the sketch translation unit.
+extern unsigned int currentSongIndex;          // MusicPlayer.ino
+extern unsigned int currentIdleSongIndex;      // MusicPlayer.ino
+extern unsigned long int contactCount;         // Display.ino
+extern volatile StatueMask latestLinkedMask;   // AudioSense.ino
+extern AudioPlaySdStream playSdWav1;           // MusicPlayer.ino
+
+#define WARM_STATE_MAGIC 0x4D4C5753 // "MLWS" - Missing Link Warm State
+#define WARM_STATE_VERSION 1
+
+struct WarmRecord {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t reserved;
+  WarmState state;
+  uint32_t crc;
+};
+
+// DMAMEM (OCRAM) is not cleared or initialized at startup, so the record
+// rides through a watchdog or software reset untouched.
+DMAMEM static WarmRecord warmRecord;
+
+static WarmState restored;
+static bool restoredValid = false;
+
+// Standard CRC32 (reflected, poly 0xEDB88320), bitwise - a few dozen
+// bytes once a second.
+static uint32_t crc32(const uint8_t *data, size_t length) {
+  uint32_t crc = 0xFFFFFFFF;
+  for (size_t i = 0; i < length; i++) {
+    crc ^= data[i];
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+    }
+  }
+  return ~crc;
+}
+
+// Boot-only: FLASHMEM (placement notes in MemMonitor.h).
+FLASHMEM void warmStateSetup() {
+  if (warmRecord.magic == WARM_STATE_MAGIC &&
+      warmRecord.version == WARM_STATE_VERSION &&
+      warmRecord.crc == crc32((const uint8_t *)&warmRecord,
+                              sizeof(warmRecord) - sizeof(warmRecord.crc))) {
+    restored = warmRecord.state;
+    restoredValid = true;
+    // The display counter can come back right away; music waits for the
+    // SD manifest.
+    contactCount = restored.contactCount;
+    Serial.printf(
+        "WarmState: restored (songs %lu/%lu, offset %lu, contacts %lu)\n",
+        (unsigned long)restored.songIndex,
+        (unsigned long)restored.idleSongIndex,
+        (unsigned long)restored.playbackOffset,
+        (unsigned long)restored.contactCount);
+  } else {
+    Serial.println("WarmState: cold boot, no snapshot");
+  }
+  // Invalidate until the first sample so a reset during setup does not
+  // restore half-baked state next time.
+  warmRecord.magic = 0;
+}
+
+bool warmStateGet(WarmState *out) {
+  if (!restoredValid) {
+    return false;
+  }
+  *out = restored;
+  return true;
+}
+
+void warmStateLoop() {
+  warmRecord.version = WARM_STATE_VERSION;
+  warmRecord.reserved = 0;
+  warmRecord.state.songIndex = currentSongIndex;
+  warmRecord.state.idleSongIndex = currentIdleSongIndex;
+  warmRecord.state.playbackOffset =
+      playSdWav1.isPlaying() ? playSdWav1.position() : 0;
+  warmRecord.state.contactCount = contactCount;
+  warmRecord.state.linkMask = latestLinkedMask;
+  warmRecord.magic = WARM_STATE_MAGIC;
+  warmRecord.crc = crc32((const uint8_t *)&warmRecord,
+                         sizeof(warmRecord) - sizeof(warmRecord.crc));
+}
@@ -0,0 +1,42 @@
+/*
+WarmState: CRC-guarded state snapshot surviving warm resets.
+
+A watchdog recovery mid-event used to be a full reset of the
+experience: playlist back to track one, contact counter to zero. The
+snapshot below lives in DMAMEM (OCRAM), which the Teensy 4 startup
+deliberately leaves uninitialized, so it survives any warm reset; a
+magic and CRC reject cold-boot garbage. A 1 Hz scheduler task samples
+the song indices, the playback byte offset, the contact counter, and
+the last link mask into the record; at the next boot the counter is
+restored immediately and the music state is handed back to the player
+once the SD manifest is up (see applyWarmMusicState in
+MusicPlayer.ino). The link mask is recorded for the report only - the
+physical link re-detects within milliseconds and is never replayed.
+*/
+
+#ifndef WARM_STATE_H
+#define WARM_STATE_H
+
+#include <Arduino.h>
+
+struct WarmState {
+  uint32_t songIndex;      // currentSongIndex (active playlist)
+  uint32_t idleSongIndex;  // currentIdleSongIndex (dormant playlist)
+  uint32_t playbackOffset; // Byte offset in the playing song's data chunk
+  uint32_t contactCount;   // Lifetime contact counter (display)
+  uint8_t linkMask;        // Stable link bitmask at snapshot time
+};
+
+// Validate any surviving snapshot and restore the contact counter.
+// Call once in setup(), before the scheduler starts.
+void warmStateSetup();
+
+// Copy of the restored snapshot; false when the last boot was cold or
+// the record failed validation.
+bool warmStateGet(WarmState *out);
+
+// Sample the live state into the survivable record. Registered as the
+// 1 Hz "warm" scheduler task.
+void warmStateLoop();
+
+#endif // WARM_STATE_H
@@ -0,0 +1,77 @@
+/*
+Watchdog.cpp - WDOG1 bring-up, feeding, and post-reset stage readback.
+
+WDOG1 counts in 0.5 s units and, once enabled, runs until the next
+reset - there is no way to turn it off, which is the point. The stage
+marker lives in SNVS_LPGPR because the SNVS low-power domain is not
+touched by a watchdog (or any warm) reset; a magic value in the high
+bits distinguishes a marker we wrote from whatever an unrelated sketch
+left there.
+*/
+
+#include "Watchdog.h"
+
+// Stage marker layout in SNVS_LPGPR: magic in the high 24 bits, stage id
+// in the low 8.
+#define WATCHDOG_MARK_MAGIC 0x57D06A00u
+#define WATCHDOG_MARK_MASK 0xFFFFFF00u
+
+static int resetStage = -1;
+static void (*warningHandler)(void) = nullptr;
+
+// WDOG1 warning interrupt: the reload window is almost gone, so the
+// board resets in WATCHDOG_WARNING_S seconds no matter what happens
+// here. Clear the status (write-one) and give the registered handler
+// its last chance to persist.
+static void watchdogWarningIsr() {
+  WDOG1_WICR |= WDOG_WICR_WTIS;
+  if (warningHandler != nullptr) {
+    warningHandler();
+  }
+}
+
+void watchdogSetWarningHandler(void (*fn)(void)) { warningHandler = fn; }
+
+// Boot-only: FLASHMEM (placement notes in MemMonitor.h).
+FLASHMEM void watchdogSetup() {
+  // SRC_SRSR latches the cause of the last reset; bit 4 is wdog_rst_b.
+  // Write-one-to-clear so the next boot sees only its own cause.
+  bool wdogReset = (SRC_SRSR & (1u << 4)) != 0;
+  if (wdogReset) {
+    uint32_t mark = SNVS_LPGPR;
+    if ((mark & WATCHDOG_MARK_MASK) == WATCHDOG_MARK_MAGIC) {
+      resetStage = (int)(mark & 0xFF);
+    }
+    SRC_SRSR = (1u << 4);
+    Serial.printf("Watchdog: reset last boot, stage %d\n", resetStage);
+  }
+
+  watchdogNoteStage(WATCHDOG_STAGE_SETUP);
+
+  // Arm WDOG1: WT in 0.5 s units ((n+1)*0.5 s), suspend while debugging
+  // (WDBG) and in low-power stop (WDZST), keep the WDOG_B/reset outputs
+  // deasserted (SRS, WDA high). WDE latches on - no disarm until reset.
+  WDOG1_WCR = WDOG_WCR_WT(WATCHDOG_TIMEOUT_S * 2 - 1) | WDOG_WCR_WDE |
+              WDOG_WCR_WDBG | WDOG_WCR_WDZST | WDOG_WCR_SRS | WDOG_WCR_WDA;
+  // Pre-reset warning: WICT counts down in 0.5 s units before the
+  // timeout. Low urgency in the priority map (IsrTrace.cpp) - it only
+  // fires when the system is already doomed.
+  WDOG1_WICR = WDOG_WICR_WICT(WATCHDOG_WARNING_S * 2) | WDOG_WICR_WIE;
+  attachInterruptVector(IRQ_WDOG1, watchdogWarningIsr);
+  NVIC_SET_PRIORITY(IRQ_WDOG1, 240);
+  NVIC_ENABLE_IRQ(IRQ_WDOG1);
+  watchdogFeed();
+  Serial.printf("Watchdog: armed, %d s timeout\n", WATCHDOG_TIMEOUT_S);
+}
+
+void watchdogFeed() {
+  // The reload sequence is fixed by the hardware.
+  WDOG1_WSR = 0x5555;
+  WDOG1_WSR = 0xAAAA;
+}
+
+void watchdogNoteStage(uint8_t stage) {
+  SNVS_LPGPR = WATCHDOG_MARK_MAGIC | stage;
+}
+
+int watchdogResetStage() { return resetStage; }
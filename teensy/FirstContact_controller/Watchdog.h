@@ -0,0 +1,55 @@
+/*
+Watchdog: i.MX RT WDOG1 supervision with task-hang attribution.
+
+A wedged statue used to stay wedged until someone power-cycled it. The
+hardware watchdog now resets the board after WATCHDOG_TIMEOUT_S seconds
+without a feed, and the scheduler feeds it once per pass - so any single
+task that hangs (reconnect() wedging on a dead socket, SD retry loops)
+trips the reset instead of wedging the statue.
+
+Attribution: the id of the stage currently running is kept in the SNVS
+general-purpose register, which survives a watchdog reset. After the
+reboot, watchdogSetup() reads back which stage was live when the timer
+expired and the report goes out on missing_link/watchdog at the next
+MQTT connect (see publishWatchdogReport in Messaging.ino).
+*/
+
+#ifndef WATCHDOG_H
+#define WATCHDOG_H
+
+#include <Arduino.h>
+
+// WDOG1 timeout. Generous on purpose: the slowest legitimate stage is
+// display bring-up plus SD mount, and a feed happens every scheduler
+// pass, so only a genuine hang gets anywhere near this.
+#define WATCHDOG_TIMEOUT_S 8
+
+// Lead time of the pre-reset warning interrupt (0.5 s granularity).
+#define WATCHDOG_WARNING_S 2
+
+// Stage ids 0..(SCHED_MAX_TASKS-1) are scheduler task indices; these two
+// cover the time before and between task runs.
+#define WATCHDOG_STAGE_SETUP 62
+#define WATCHDOG_STAGE_IDLE 63
+
+// Read the reset cause, capture the stage that hung (if any), and arm
+// WDOG1. Call first thing in setup(); WDOG1 cannot be disarmed after.
+void watchdogSetup();
+
+// Service the watchdog. Called once per scheduler pass.
+void watchdogFeed();
+
+// Record the stage about to run, so a reset mid-run names its culprit.
+void watchdogNoteStage(uint8_t stage);
+
+// Stage that was running when the previous boot's watchdog fired, or -1
+// when the previous boot ended normally.
+int watchdogResetStage();
+
+// Register the single pre-reset warning handler. WDOG1 raises an
+// interrupt WATCHDOG_WARNING_S seconds before the timeout expires;
+// last-chance persistence (CounterStore) hangs off it. The reset still
+// happens - the handler just gets to save state first.
+void watchdogSetWarningHandler(void (*fn)(void));
+
+#endif // WATCHDOG_H
@@ -0,0 +1,127 @@
+/*
+Micro-benchmark for the link debounce core (LinkDebounce.h).
+
+LinkDebounce::update() runs per detector inside the 5 ms sense timer
+ISR, so its cost is a direct tax on the tightest loop in the firmware.
+This drives the state machine with a synthetic flickering signal trace
+(worst case: every statue sitting in its unlink buffer) and reports
+updates/sec and nanoseconds per update, so optimization work on the
+sense path lands with numbers instead of vibes.
+
+Usage, from tests/:
+
+    make bench                  # build and print current numbers
+    bin/bench > before.txt      # save a baseline
+    ... modify ../LinkDebounce.h ...
+    make bench BENCH_ARGS=before.txt   # or: bin/bench before.txt
+
+With a baseline argument each row also prints the percent change.
+*/
+
+#include "LinkDebounce.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+// Measurement window per scenario.
+#define BENCH_WINDOW_MS 500
+#define BENCH_STATUES 4
+#define UNLINK_BUFFER_MS 100
+
+struct BenchRow {
+  const char *name;
+  double updatesPerSec;
+  double nsPerUpdate;
+};
+
+// Drive `detected` from the scenario: steady keeps every statue linked,
+// flicker re-enters the unlink buffer constantly (the worst case: every
+// update arms or re-checks the buffered transition).
+static BenchRow runScenario(const char *name, bool flicker) {
+  LinkDebounce d;
+  uint64_t nowMs = 1000;
+  for (int i = 0; i < BENCH_STATUES; i++) {
+    d.update(i, true, nowMs, UNLINK_BUFFER_MS);
+  }
+
+  unsigned long long updates = 0;
+  // Fold every result into a live sink so the optimizer cannot elide
+  // the state machine.
+  volatile unsigned long long eventSink = 0;
+  auto start = std::chrono::steady_clock::now();
+  auto deadline = start + std::chrono::milliseconds(BENCH_WINDOW_MS);
+  while (std::chrono::steady_clock::now() < deadline) {
+    // A batch between clock reads so the timer call does not dominate.
+    for (int rep = 0; rep < 100; rep++) {
+      nowMs += 6; // Sense cadence
+      for (int i = 0; i < BENCH_STATUES; i++) {
+        bool detected = flicker ? ((updates + i) & 1) != 0 : true;
+        eventSink += (unsigned long long)d.update(i, detected, nowMs,
+                                                  UNLINK_BUFFER_MS);
+        updates++;
+      }
+    }
+  }
+  auto elapsed = std::chrono::duration<double>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+
+  BenchRow row;
+  row.name = name;
+  row.updatesPerSec = (double)updates / elapsed;
+  row.nsPerUpdate = elapsed * 1e9 / (double)updates;
+  return row;
+}
+
+// Baseline file: the saved stdout of a previous run; rows are matched by
+// scenario name.
+static bool loadBaseline(const char *path, const char *name,
+                         double *updatesPerSec) {
+  FILE *f = fopen(path, "r");
+  if (f == NULL) {
+    return false;
+  }
+  char line[256];
+  bool found = false;
+  while (fgets(line, sizeof(line), f) != NULL) {
+    char parsedName[64];
+    double ups, ns;
+    if (sscanf(line, "scenario=%63s updates_per_sec=%lf ns_per_update=%lf",
+               parsedName, &ups, &ns) == 3 &&
+        strcmp(parsedName, name) == 0) {
+      *updatesPerSec = ups;
+      found = true;
+      break;
+    }
+  }
+  fclose(f);
+  return found;
+}
+
+int main(int argc, char **argv) {
+  const char *baselinePath = (argc > 1) ? argv[1] : NULL;
+
+  const struct {
+    const char *name;
+    bool flicker;
+  } scenarios[] = {
+      {"steady_linked", false},
+      {"flicker_buffering", true},
+  };
+
+  for (unsigned int i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]);
+       i++) {
+    BenchRow row = runScenario(scenarios[i].name, scenarios[i].flicker);
+    printf("scenario=%s updates_per_sec=%.0f ns_per_update=%.1f",
+           row.name, row.updatesPerSec, row.nsPerUpdate);
+    double baseUps;
+    if (baselinePath != NULL &&
+        loadBaseline(baselinePath, row.name, &baseUps)) {
+      printf(" vs_baseline=%+.1f%%",
+             (row.updatesPerSec - baseUps) / baseUps * 100.0);
+    }
+    printf("\n");
+  }
+  return 0;
+}
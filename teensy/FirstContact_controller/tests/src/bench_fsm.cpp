@@ -0,0 +1,134 @@
+/*
+Micro-benchmark for the music lifecycle FSM (MusicFsm.h).
+
+musicFsmStep() runs on the sense-pass cadence, so its cost is small in
+absolute terms - the point of this bench is to keep the table scan
+honest as rows accumulate. It drives the machine with a looping session
+trace (link, micro-break, real break, fade, idle-out) plus the stale
+events the table is expected to drop, and reports events/sec and
+nanoseconds per event.
+
+Usage, from tests/:
+
+    make bench-fsm                  # build and print current numbers
+    bin/bench_fsm > before.txt      # save a baseline
+    ... modify ../MusicFsm.h ...
+    make bench-fsm BENCH_ARGS=before.txt
+
+With a baseline argument each row also prints the percent change.
+*/
+
+#include "MusicFsm.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+// Measurement window per scenario.
+#define BENCH_WINDOW_MS 500
+
+struct BenchRow {
+  const char *name;
+  double eventsPerSec;
+  double nsPerEvent;
+};
+
+// One full session, looped: every state is visited and both guard
+// polarities fire. The no-op scenario replays the events the table
+// drops (worst case: the scan runs the whole table and matches nothing).
+static const MusicFsmEvent SESSION_TRACE[] = {
+    MF_EV_LINK,         MF_EV_UNLINK,       MF_EV_LINK,
+    MF_EV_UNLINK,       MF_EV_GRACE_TIMEOUT, MF_EV_LINK,
+    MF_EV_UNLINK,       MF_EV_GRACE_TIMEOUT, MF_EV_FADE_TIMEOUT,
+    MF_EV_IDLE_OUT,     MF_EV_SONG_END,
+};
+
+static BenchRow runScenario(const char *name, bool noOps) {
+  uint8_t state = MF_DORMANT;
+  const int traceLen =
+      (int)(sizeof(SESSION_TRACE) / sizeof(SESSION_TRACE[0]));
+
+  unsigned long long events = 0;
+  // Fold every action mask into a live sink so the optimizer cannot
+  // elide the table scan.
+  volatile unsigned long long actionSink = 0;
+  auto start = std::chrono::steady_clock::now();
+  auto deadline = start + std::chrono::milliseconds(BENCH_WINDOW_MS);
+  while (std::chrono::steady_clock::now() < deadline) {
+    // A batch between clock reads so the timer call does not dominate.
+    for (int rep = 0; rep < 100; rep++) {
+      for (int i = 0; i < traceLen; i++) {
+        MusicFsmEvent ev = SESSION_TRACE[i];
+        if (noOps) {
+          // Pin the machine in MF_LINKED and feed it the fade/idle
+          // events it must drop.
+          state = MF_LINKED;
+          ev = ((events + i) & 1) ? MF_EV_FADE_TIMEOUT : MF_EV_IDLE_OUT;
+        }
+        actionSink += musicFsmStep(state, ev, (events & 1) != 0);
+        events++;
+      }
+    }
+  }
+  auto elapsed = std::chrono::duration<double>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+
+  BenchRow row;
+  row.name = name;
+  row.eventsPerSec = (double)events / elapsed;
+  row.nsPerEvent = elapsed * 1e9 / (double)events;
+  return row;
+}
+
+// Baseline file: the saved stdout of a previous run; rows are matched by
+// scenario name.
+static bool loadBaseline(const char *path, const char *name,
+                         double *eventsPerSec) {
+  FILE *f = fopen(path, "r");
+  if (f == NULL) {
+    return false;
+  }
+  char line[256];
+  bool found = false;
+  while (fgets(line, sizeof(line), f) != NULL) {
+    char parsedName[64];
+    double eps, ns;
+    if (sscanf(line, "scenario=%63s events_per_sec=%lf ns_per_event=%lf",
+               parsedName, &eps, &ns) == 3 &&
+        strcmp(parsedName, name) == 0) {
+      *eventsPerSec = eps;
+      found = true;
+      break;
+    }
+  }
+  fclose(f);
+  return found;
+}
+
+int main(int argc, char **argv) {
+  const char *baselinePath = (argc > 1) ? argv[1] : NULL;
+
+  const struct {
+    const char *name;
+    bool noOps;
+  } scenarios[] = {
+      {"session_trace", false},
+      {"dropped_events", true},
+  };
+
+  for (unsigned int i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]);
+       i++) {
+    BenchRow row = runScenario(scenarios[i].name, scenarios[i].noOps);
+    printf("scenario=%s events_per_sec=%.0f ns_per_event=%.1f",
+           row.name, row.eventsPerSec, row.nsPerEvent);
+    double baseEps;
+    if (baselinePath != NULL &&
+        loadBaseline(baselinePath, row.name, &baseEps)) {
+      printf(" vs_baseline=%+.1f%%",
+             (row.eventsPerSec - baseEps) / baseEps * 100.0);
+    }
+    printf("\n");
+  }
+  return 0;
+}
@@ -0,0 +1,95 @@
+/*
+Host-build spec for the link debounce state machine (LinkDebounce.h).
+
+Feeds scripted signal traces through the same logic the sense tick runs
+on hardware, with a simulated clock - a 2 AM glitch becomes a trace in
+this file. Build and run with `make && make test` (see ../Makefile; the
+harness mirrors teensy/libraries/PubSubClient/tests).
+*/
+
+#include "LinkDebounce.h"
+#include "BDDTest.h"
+#include "trace.h"
+
+#define UNLINK_BUFFER_MS 100
+
+int test_links_immediately() {
+  IT("links on the first detection, with no debounce delay");
+  LinkDebounce d;
+  IS_EQUAL(d.update(1, true, 1000, UNLINK_BUFFER_MS), LINK_ESTABLISHED);
+  IS_TRUE(d.isLinked(1));
+  END_IT
+}
+
+int test_unlinks_only_after_buffer() {
+  IT("holds the link until a dropout persists for the buffer window");
+  LinkDebounce d;
+  d.update(1, true, 1000, UNLINK_BUFFER_MS);
+  // Dropout begins: still linked while the buffer runs.
+  IS_EQUAL(d.update(1, false, 1050, UNLINK_BUFFER_MS), LINK_NO_CHANGE);
+  IS_TRUE(d.isLinked(1));
+  IS_EQUAL(d.update(1, false, 1149, UNLINK_BUFFER_MS), LINK_NO_CHANGE);
+  IS_TRUE(d.isLinked(1));
+  // Buffer expired: unlink fires.
+  IS_EQUAL(d.update(1, false, 1150, UNLINK_BUFFER_MS), LINK_LOST);
+  IS_FALSE(d.isLinked(1));
+  END_IT
+}
+
+int test_bounce_shorter_than_buffer_keeps_link() {
+  IT("ignores a dropout shorter than the buffer window");
+  LinkDebounce d;
+  d.update(1, true, 1000, UNLINK_BUFFER_MS);
+  d.update(1, false, 1050, UNLINK_BUFFER_MS);
+  // Grip recovers before the buffer expires: no unlink, no re-link event.
+  IS_EQUAL(d.update(1, true, 1120, UNLINK_BUFFER_MS), LINK_NO_CHANGE);
+  IS_TRUE(d.isLinked(1));
+  // A fresh dropout restarts the buffer from scratch.
+  IS_EQUAL(d.update(1, false, 1200, UNLINK_BUFFER_MS), LINK_NO_CHANGE);
+  IS_EQUAL(d.update(1, false, 1299, UNLINK_BUFFER_MS), LINK_NO_CHANGE);
+  IS_EQUAL(d.update(1, false, 1300, UNLINK_BUFFER_MS), LINK_LOST);
+  END_IT
+}
+
+int test_statues_debounce_independently() {
+  IT("tracks each statue's buffer independently");
+  LinkDebounce d;
+  d.update(0, true, 1000, UNLINK_BUFFER_MS);
+  d.update(3, true, 1000, UNLINK_BUFFER_MS);
+  // Statue 0 drops out; statue 3 holds.
+  d.update(0, false, 1010, UNLINK_BUFFER_MS);
+  d.update(3, true, 1010, UNLINK_BUFFER_MS);
+  IS_EQUAL(d.update(0, false, 1110, UNLINK_BUFFER_MS), LINK_LOST);
+  IS_FALSE(d.isLinked(0));
+  IS_TRUE(d.isLinked(3));
+  END_IT
+}
+
+int test_flicker_trace_never_unlinks() {
+  IT("rides out a noisy trace with sub-buffer dropouts");
+  LinkDebounce d;
+  // A hand chain with a flaky grip: 20 ms good / 60 ms bad, repeating.
+  // Every dropout is shorter than the buffer, so the link must hold.
+  unsigned long now = 1000;
+  d.update(2, true, now, UNLINK_BUFFER_MS);
+  for (int cycle = 0; cycle < 50; cycle++) {
+    now += 20;
+    IS_NOT_EQUAL(d.update(2, true, now, UNLINK_BUFFER_MS), LINK_LOST);
+    for (int t = 0; t < 3; t++) {
+      now += 20;
+      IS_NOT_EQUAL(d.update(2, false, now, UNLINK_BUFFER_MS), LINK_LOST);
+    }
+  }
+  IS_TRUE(d.isLinked(2));
+  END_IT
+}
+
+int main() {
+  SUITE("Link debounce");
+  test_links_immediately();
+  test_unlinks_only_after_buffer();
+  test_bounce_shorter_than_buffer_keeps_link();
+  test_statues_debounce_independently();
+  test_flicker_trace_never_unlinks();
+  FINISH
+}
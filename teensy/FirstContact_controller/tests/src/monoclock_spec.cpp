@@ -0,0 +1,86 @@
+/*
+Host-build spec for the monotonic clock core (MonoClock.h).
+
+The 32-to-64-bit extension and the Stopwatch/Deadline helpers are pure
+arithmetic, so the one bug class they exist to kill - counter wrap
+mid-interval - can be scripted here instead of waiting 49.7 days on
+hardware. Build and run with `make && make test` (see ../Makefile).
+*/
+
+#include "MonoClock.h"
+#include "BDDTest.h"
+#include "trace.h"
+
+int test_extend_is_identity_before_wrap() {
+  IT("passes the raw counter through until the first wrap");
+  MonoClock64 c;
+  IS_EQUAL(c.extend(0u), 0ull);
+  IS_EQUAL(c.extend(1000u), 1000ull);
+  IS_EQUAL(c.extend(0xFFFFFFFFu), 0xFFFFFFFFull);
+  END_IT
+}
+
+int test_extend_carries_across_wrap() {
+  IT("stays monotonic when the 32-bit source wraps");
+  MonoClock64 c;
+  uint64_t before = c.extend(0xFFFFFF00u);
+  uint64_t after = c.extend(0x00000010u); // Source wrapped
+  IS_TRUE(after > before);
+  IS_EQUAL(after - before, (uint64_t)0x110);
+  END_IT
+}
+
+int test_extend_survives_many_wraps() {
+  IT("accumulates high bits over repeated wraps");
+  MonoClock64 c;
+  uint64_t last = 0;
+  for (int wrap = 0; wrap < 5; wrap++) {
+    uint64_t now = c.extend(0x80000000u);
+    IS_TRUE(now >= last);
+    last = now;
+    now = c.extend(0x00000000u); // Wrap each iteration
+    IS_TRUE(now > last);
+    last = now;
+  }
+  IS_EQUAL(last, 5ull << 32);
+  END_IT
+}
+
+int test_stopwatch_elapsed_across_wrap() {
+  IT("measures an interval spanning a source wrap correctly");
+  MonoClock64 c;
+  MonoStopwatch w;
+  w.start(c.extend(0xFFFFFFF0u)); // 16 ticks before the wrap
+  uint64_t elapsed = w.elapsedUs(c.extend(0x00000010u));
+  IS_EQUAL(elapsed, (uint64_t)0x20);
+  END_IT
+}
+
+int test_stopwatch_elapsed_ms() {
+  IT("converts elapsed microseconds to milliseconds");
+  MonoStopwatch w;
+  w.start(1000000);
+  IS_EQUAL(w.elapsedMs(3500000), (uint64_t)2500);
+  END_IT
+}
+
+int test_deadline_expiry() {
+  IT("reports a deadline unexpired before and expired at its due time");
+  MonoDeadline d;
+  d.set(1000000, 500000);
+  IS_FALSE(d.expired(1499999));
+  IS_TRUE(d.expired(1500000));
+  IS_TRUE(d.expired(2000000));
+  END_IT
+}
+
+int main() {
+  SUITE("MonoClock");
+  test_extend_is_identity_before_wrap();
+  test_extend_carries_across_wrap();
+  test_extend_survives_many_wraps();
+  test_stopwatch_elapsed_across_wrap();
+  test_stopwatch_elapsed_ms();
+  test_deadline_expiry();
+  FINISH
+}
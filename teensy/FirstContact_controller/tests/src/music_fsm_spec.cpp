@@ -0,0 +1,128 @@
+/*
+Host-build spec for the table-driven music lifecycle FSM (MusicFsm.h).
+Each test scripts an event trace through musicFsmStep() and checks the
+states visited and the action masks returned - the corner cases that
+used to hide in playMusic()'s flag ladder, pinned down off-hardware.
+*/
+
+#include "MusicFsm.h"
+#include "BDDTest.h"
+#include "trace.h"
+
+int test_link_from_dormant() {
+  IT("chimes and stops the idle song when a chain forms");
+  uint8_t s = MF_DORMANT;
+  uint8_t acts = musicFsmStep(s, MF_EV_LINK, false);
+  IS_EQUAL(s, MF_LINKED);
+  IS_EQUAL(acts, MF_ACT_CHIME | MF_ACT_STOP);
+  END_IT
+}
+
+int test_grace_absorbs_micro_break() {
+  IT("absorbs a micro-break without chime, resume, or fade");
+  uint8_t s = MF_LINKED;
+  uint8_t acts = musicFsmStep(s, MF_EV_UNLINK, true);
+  IS_EQUAL(s, MF_GRACE);
+  IS_EQUAL(acts, MF_ACT_ARM_GRACE);
+  // Relink inside the window: back to linked, playback untouched.
+  acts = musicFsmStep(s, MF_EV_LINK, false);
+  IS_EQUAL(s, MF_LINKED);
+  IS_EQUAL(acts, 0);
+  END_IT
+}
+
+int test_grace_expiry_fades() {
+  IT("fades out when the grace window expires, immediately if disabled");
+  uint8_t s = MF_GRACE;
+  uint8_t acts = musicFsmStep(s, MF_EV_GRACE_TIMEOUT, false);
+  IS_EQUAL(s, MF_FADING);
+  IS_EQUAL(acts, MF_ACT_FADE_OUT);
+  // With grace unavailable the unlink fades straight away.
+  s = MF_LINKED;
+  acts = musicFsmStep(s, MF_EV_UNLINK, false);
+  IS_EQUAL(s, MF_FADING);
+  IS_EQUAL(acts, MF_ACT_FADE_OUT);
+  END_IT
+}
+
+int test_relink_during_fade_resumes() {
+  IT("rescues a fading song with a chime and a resume");
+  uint8_t s = MF_FADING;
+  uint8_t acts = musicFsmStep(s, MF_EV_LINK, false);
+  IS_EQUAL(s, MF_LINKED);
+  IS_EQUAL(acts, MF_ACT_CHIME | MF_ACT_RESUME);
+  END_IT
+}
+
+int test_fade_outcomes() {
+  IT("switches to dormant on fade timeout, also queuing on song end");
+  uint8_t s = MF_FADING;
+  uint8_t acts = musicFsmStep(s, MF_EV_FADE_TIMEOUT, false);
+  IS_EQUAL(s, MF_DORMANT);
+  IS_EQUAL(acts, MF_ACT_SWITCH_DORMANT);
+  s = MF_FADING;
+  acts = musicFsmStep(s, MF_EV_FADE_FINISHED, false);
+  IS_EQUAL(s, MF_DORMANT);
+  IS_EQUAL(acts, MF_ACT_SWITCH_DORMANT | MF_ACT_QUEUE_ACTIVE);
+  END_IT
+}
+
+int test_song_end_queues_by_state() {
+  IT("advances the playlist matching the state when a song runs out");
+  uint8_t s = MF_LINKED;
+  IS_EQUAL(musicFsmStep(s, MF_EV_SONG_END, false), MF_ACT_QUEUE_ACTIVE);
+  IS_EQUAL(s, MF_LINKED);
+  s = MF_DORMANT;
+  IS_EQUAL(musicFsmStep(s, MF_EV_SONG_END, false), MF_ACT_QUEUE_IDLE);
+  IS_EQUAL(s, MF_DORMANT);
+  // During grace there is no playback left to protect: collapse to
+  // dormant so a later relink stops the idle song properly.
+  s = MF_GRACE;
+  IS_EQUAL(musicFsmStep(s, MF_EV_SONG_END, false), MF_ACT_QUEUE_IDLE);
+  IS_EQUAL(s, MF_DORMANT);
+  END_IT
+}
+
+int test_stale_events_dropped() {
+  IT("drops timer events that lost a race with a relink");
+  // A fade timeout landing after a relink already pulled the machine
+  // back to linked must not switch to dormant.
+  uint8_t s = MF_LINKED;
+  IS_EQUAL(musicFsmStep(s, MF_EV_FADE_TIMEOUT, false), 0);
+  IS_EQUAL(s, MF_LINKED);
+  // Likewise an idle-out that fires after the chain re-formed.
+  IS_EQUAL(musicFsmStep(s, MF_EV_IDLE_OUT, false), 0);
+  IS_EQUAL(s, MF_LINKED);
+  END_IT
+}
+
+int test_full_session_trace() {
+  IT("follows a whole session: link, micro-break, real break, idle-out");
+  uint8_t s = MF_DORMANT;
+  musicFsmStep(s, MF_EV_LINK, false);        // Chain forms
+  musicFsmStep(s, MF_EV_UNLINK, true);       // Sweaty-hand blip
+  musicFsmStep(s, MF_EV_LINK, false);        // ...comes right back
+  IS_EQUAL(s, MF_LINKED);
+  musicFsmStep(s, MF_EV_UNLINK, true);       // Chain breaks for real
+  musicFsmStep(s, MF_EV_GRACE_TIMEOUT, false);
+  IS_EQUAL(s, MF_FADING);
+  musicFsmStep(s, MF_EV_FADE_TIMEOUT, false);
+  IS_EQUAL(s, MF_DORMANT);
+  uint8_t acts = musicFsmStep(s, MF_EV_IDLE_OUT, false);
+  IS_EQUAL(acts, MF_ACT_QUEUE_ACTIVE);
+  IS_EQUAL(s, MF_DORMANT);
+  END_IT
+}
+
+int main() {
+  SUITE("Music lifecycle FSM");
+  test_link_from_dormant();
+  test_grace_absorbs_micro_break();
+  test_grace_expiry_fades();
+  test_relink_during_fade_resumes();
+  test_fade_outcomes();
+  test_song_end_queues_by_state();
+  test_stale_events_dropped();
+  test_full_session_trace();
+  FINISH
+}
@@ -0,0 +1,108 @@
+/*
+Host-build spec for the music playback state decision
+(MusicStateMachine.h). The fade window and idle-out timing run against a
+simulated clock instead of a stopwatch and a ladder.
+*/
+
+#include "MusicStateMachine.h"
+#include "BDDTest.h"
+#include "trace.h"
+
+#define PAUSE_TIMEOUT_MS 2000
+#define IDLE_OUT_TIMEOUT_MS 10000
+
+// A baseline snapshot: initialized, playing, no fade in progress.
+static MusicStateInputs playingAt(unsigned long nowMs) {
+  MusicStateInputs in;
+  in.initialized = true;
+  in.fading = false;
+  in.playing = true;
+  in.idleOutTimerStarted = false;
+  in.nowMs = nowMs;
+  in.fadeStartMs = 0;
+  in.idleOutStartMs = 0;
+  in.pauseTimeoutMs = PAUSE_TIMEOUT_MS;
+  in.idleOutTimeoutMs = IDLE_OUT_TIMEOUT_MS;
+  return in;
+}
+
+int test_not_started_until_initialized() {
+  IT("reports NOT_STARTED before the first contact state update");
+  MusicStateInputs in = playingAt(1000);
+  in.initialized = false;
+  IS_EQUAL(evalMusicState(in).state, MUSIC_STATE_NOT_STARTED);
+  END_IT
+}
+
+int test_playing_and_finished() {
+  IT("distinguishes playing from a song that ran out");
+  MusicStateInputs in = playingAt(1000);
+  IS_EQUAL(evalMusicState(in).state, MUSIC_STATE_PLAYING);
+  in.playing = false;
+  IS_EQUAL(evalMusicState(in).state, MUSIC_STATE_FINISHED);
+  END_IT
+}
+
+int test_fade_window() {
+  IT("reports FADING inside the window and FADE_FINISHED if playback stops");
+  MusicStateInputs in = playingAt(5000);
+  in.fading = true;
+  in.fadeStartMs = 4000;
+  IS_EQUAL(evalMusicState(in).state, MUSIC_STATE_FADING);
+  in.playing = false;
+  IS_EQUAL(evalMusicState(in).state, MUSIC_STATE_FADE_FINISHED);
+  END_IT
+}
+
+int test_fade_timeout_starts_idle_out_timer() {
+  IT("times out the fade and asks for the idle-out timer exactly once");
+  MusicStateInputs in = playingAt(7000);
+  in.fading = true;
+  in.fadeStartMs = 4000; // 3 s ago, past the 2 s window
+  MusicStateDecision d = evalMusicState(in);
+  IS_EQUAL(d.state, MUSIC_STATE_FADE_TIMEOUT);
+  IS_TRUE(d.startIdleOutTimer);
+  // Once the caller applied it, the decision must not re-arm the timer.
+  in.idleOutTimerStarted = true;
+  in.idleOutStartMs = 7000;
+  d = evalMusicState(in);
+  IS_EQUAL(d.state, MUSIC_STATE_FADE_TIMEOUT);
+  IS_FALSE(d.startIdleOutTimer);
+  END_IT
+}
+
+int test_idle_out_fires_once_after_timeout() {
+  IT("enters idle-out after the idle window and resets the timer");
+  MusicStateInputs in = playingAt(17000);
+  in.idleOutTimerStarted = true;
+  in.idleOutStartMs = 7000; // 10 s ago
+  MusicStateDecision d = evalMusicState(in);
+  IS_EQUAL(d.state, MUSIC_STATE_RECENT_CONNECTION_IDLE_OUT);
+  IS_TRUE(d.stopIdleOutTimer);
+  // After the caller clears the timer, back to plain playing.
+  in.idleOutTimerStarted = false;
+  IS_EQUAL(evalMusicState(in).state, MUSIC_STATE_PLAYING);
+  END_IT
+}
+
+int test_idle_out_waits_for_full_window() {
+  IT("stays in normal playback while the idle-out timer runs");
+  MusicStateInputs in = playingAt(16999);
+  in.idleOutTimerStarted = true;
+  in.idleOutStartMs = 7000; // 9.999 s ago
+  MusicStateDecision d = evalMusicState(in);
+  IS_EQUAL(d.state, MUSIC_STATE_PLAYING);
+  IS_FALSE(d.stopIdleOutTimer);
+  END_IT
+}
+
+int main() {
+  SUITE("Music state machine");
+  test_not_started_until_initialized();
+  test_playing_and_finished();
+  test_fade_window();
+  test_fade_timeout_starts_idle_out_timer();
+  test_idle_out_fires_once_after_timeout();
+  test_idle_out_waits_for_full_window();
+  FINISH
+}
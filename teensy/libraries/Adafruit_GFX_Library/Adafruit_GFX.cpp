@@ -1117,6 +1117,34 @@ void Adafruit_GFX::drawChar(int16_t x, int16_t y, unsigned char c,
   drawChar(x, y, c, color, bg, size, size);
 }
 
+/**************************************************************************/
+/*!
+   @brief   Glyph blit hook for the 'classic' built-in font. Subclasses
+            whose framebuffer shares the font's vertical column-byte
+            layout (e.g. SSD1306 page buffers) can override this to copy
+            the five glyph columns directly instead of plotting up to 48
+            pixels through writePixel().
+    @param    x   Top left corner x coordinate
+    @param    y   Top left corner y coordinate
+    @param    glyph  The five font column bytes, bit 0 = top row
+    @param    color 16-bit 5-6-5 Color to draw character with
+    @param    bg 16-bit 5-6-5 Color to fill background with (if same as color,
+   no background)
+    @return  true if the glyph was drawn, false to fall back to the
+            generic pixel-by-pixel path
+*/
+/**************************************************************************/
+bool Adafruit_GFX::blitGlyphColumns(int16_t x, int16_t y,
+                                    const uint8_t glyph[5], uint16_t color,
+                                    uint16_t bg) {
+  (void)x;
+  (void)y;
+  (void)glyph;
+  (void)color;
+  (void)bg;
+  return false; // Generic displays take the drawPixel path
+}
+
 // Draw a character
 /**************************************************************************/
 /*!
@@ -1146,6 +1174,17 @@ void Adafruit_GFX::drawChar(int16_t x, int16_t y, unsigned char c,
     if (!_cp437 && (c >= 176))
       c++; // Handle 'classic' charset behavior
 
+    // Unmagnified glyphs on displays whose buffer matches the font's
+    // column-byte layout can be blitted whole instead of plotted
+    // pixel-by-pixel; let the subclass try first.
+    if (size_x == 1 && size_y == 1) {
+      uint8_t glyph[5];
+      for (int8_t i = 0; i < 5; i++)
+        glyph[i] = pgm_read_byte(&font[c * 5 + i]);
+      if (blitGlyphColumns(x, y, glyph, color, bg))
+        return;
+    }
+
     startWrite();
     for (int8_t i = 0; i < 5; i++) { // Char bitmap = 5 columns
       uint8_t line = pgm_read_byte(&font[c * 5 + i]);
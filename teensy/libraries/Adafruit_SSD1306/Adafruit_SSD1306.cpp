@@ -343,6 +343,10 @@ Adafruit_SSD1306::~Adafruit_SSD1306(void) {
     free(buffer);
     buffer = NULL;
   }
+  if (shadow) {
+    free(shadow);
+    shadow = NULL;
+  }
 }
 
 // LOW-LEVEL UTILS ---------------------------------------------------------
@@ -397,7 +401,9 @@ void Adafruit_SSD1306::ssd1306_command1(uint8_t c) {
     wire->beginTransmission(i2caddr);
     WIRE_WRITE((uint8_t)0x00); // Co = 0, D/C = 0
     WIRE_WRITE(c);
-    wire->endTransmission();
+    uint8_t st = wire->endTransmission();
+    if (st)
+      wireStatus = st;
   } else { // SPI (hw or soft) -- transaction started in calling function
     SSD1306_MODE_COMMAND
     SPIwrite(c);
@@ -421,9 +427,12 @@ void Adafruit_SSD1306::ssd1306_commandList(const uint8_t *c, uint8_t n) {
     wire->beginTransmission(i2caddr);
     WIRE_WRITE((uint8_t)0x00); // Co = 0, D/C = 0
     uint16_t bytesOut = 1;
+    uint8_t st;
     while (n--) {
       if (bytesOut >= WIRE_MAX) {
-        wire->endTransmission();
+        st = wire->endTransmission();
+        if (st)
+          wireStatus = st;
         wire->beginTransmission(i2caddr);
         WIRE_WRITE((uint8_t)0x00); // Co = 0, D/C = 0
         bytesOut = 1;
@@ -431,7 +440,9 @@ void Adafruit_SSD1306::ssd1306_commandList(const uint8_t *c, uint8_t n) {
       WIRE_WRITE(pgm_read_byte(c++));
       bytesOut++;
     }
-    wire->endTransmission();
+    st = wire->endTransmission();
+    if (st)
+      wireStatus = st;
   } else { // SPI -- transaction started in calling function
     SSD1306_MODE_COMMAND
     while (n--)
@@ -498,6 +509,13 @@ bool Adafruit_SSD1306::begin(uint8_t vcs, uint8_t addr, bool reset,
   if ((!buffer) && !(buffer = (uint8_t *)malloc(WIDTH * ((HEIGHT + 7) / 8))))
     return false;
 
+  // Mirror of the panel RAM, used to diff transmits and to stream async
+  // transfers from; if this allocation fails those paths just fall back
+  // to sending everything synchronously.
+  if (!shadow)
+    shadow = (uint8_t *)malloc(WIDTH * ((HEIGHT + 7) / 8));
+  shadowValid = false; // Panel RAM is undefined until the first full push
+
   clearDisplay();
 
 #ifndef SSD1306_NO_SPLASH
@@ -625,6 +643,99 @@ bool Adafruit_SSD1306::begin(uint8_t vcs, uint8_t addr, bool reset,
 
 // DRAWING FUNCTIONS -------------------------------------------------------
 
+/*!
+    @brief  Grow the dirty window to cover a modified region of the buffer.
+            Coordinates are in native (unrotated) buffer space; pages are the
+            8-row bands the SSD1306 RAM is organized in.
+    @param  xMin
+            Leftmost modified column.
+    @param  xMax
+            Rightmost modified column.
+    @param  pageMin
+            First modified page (row / 8).
+    @param  pageMax
+            Last modified page (row / 8).
+    @return None (void).
+*/
+void Adafruit_SSD1306::markDirty(int16_t xMin, int16_t xMax, uint8_t pageMin,
+                                 uint8_t pageMax) {
+  if (xMin < dirtyXMin)
+    dirtyXMin = xMin;
+  if (xMax > dirtyXMax)
+    dirtyXMax = xMax;
+  if (pageMin < dirtyPageMin)
+    dirtyPageMin = pageMin;
+  if (pageMax > dirtyPageMax)
+    dirtyPageMax = pageMax;
+}
+
+/*!
+    @brief  Reset the dirty window to empty, typically after a refresh.
+    @return None (void).
+*/
+void Adafruit_SSD1306::clearDirty(void) {
+  dirtyXMin = 0x7FFF;
+  dirtyXMax = -1;
+  dirtyPageMin = 0xFF;
+  dirtyPageMax = 0;
+}
+
+/*!
+    @brief  Blit a GFXcanvas1 into the display buffer. The canvas packs
+            pixels horizontally (MSB first) while SSD1306 RAM packs them
+            vertically in 8-row pages; for page-aligned placements this
+            transposes 8x8 tiles byte-at-a-time instead of going
+            pixel-by-pixel through drawPixel, which is what makes
+            offscreen-composed row strips cheap enough to repaint freely.
+            Unaligned or clipped placements, and rotated displays, fall
+            back to the generic drawBitmap() path.
+    @param  x
+            Leftmost destination column.
+    @param  y
+            Topmost destination row; a multiple of 8 for the fast path.
+    @param  canvas
+            The 1-bpp canvas to copy in; set bits draw white, clear bits
+            black. Height a multiple of 8 for the fast path.
+    @return None (void).
+*/
+void Adafruit_SSD1306::drawCanvas1(int16_t x, int16_t y,
+                                   const GFXcanvas1 &canvas) {
+  const int16_t w = canvas.width();
+  const int16_t h = canvas.height();
+  const uint8_t *src = canvas.getBuffer();
+
+  if ((y & 7) || (h & 7) || x < 0 || y < 0 || x + w > WIDTH || y + h > HEIGHT ||
+      getRotation() != 0) {
+    drawBitmap(x, y, canvas.getBuffer(), w, h, SSD1306_WHITE, SSD1306_BLACK);
+    return;
+  }
+
+  const int16_t srcStride = (w + 7) / 8;
+  for (int16_t py = 0; py < h; py += 8) {
+    uint8_t *dst = buffer + (uint16_t)((y + py) / 8) * WIDTH + x;
+    for (int16_t px = 0; px < w; px += 8) {
+      // 8x8 tile: eight horizontally-packed source rows become up to
+      // eight vertically-packed display columns.
+      uint8_t rows[8];
+      const uint8_t *srcCol = src + (uint16_t)py * srcStride + (px >> 3);
+      for (uint8_t r = 0; r < 8; r++) {
+        rows[r] = srcCol[(uint16_t)r * srcStride];
+      }
+      int16_t n = (w - px < 8) ? (w - px) : 8;
+      for (int16_t c = 0; c < n; c++) {
+        uint8_t mask = 0x80 >> c;
+        uint8_t out = 0;
+        for (uint8_t r = 0; r < 8; r++) {
+          if (rows[r] & mask)
+            out |= (uint8_t)(1 << r);
+        }
+        dst[px + c] = out;
+      }
+    }
+  }
+  markDirty(x, x + w - 1, y / 8, (y + h - 1) / 8);
+}
+
 /*!
     @brief  Set/clear/invert a single pixel. This is also invoked by the
             Adafruit_GFX library in generating many higher-level graphics
@@ -669,7 +780,62 @@ void Adafruit_SSD1306::drawPixel(int16_t x, int16_t y, uint16_t color) {
       buffer[x + (y / 8) * WIDTH] ^= (1 << (y & 7));
       break;
     }
+    markDirty(x, x, y / 8, y / 8);
+  }
+}
+
+/*!
+    @brief  Fast path for 'classic' 5x7 font rendering: when a glyph's
+            8-row span lands exactly on one page in the native orientation,
+            the font column bytes share the buffer's bit layout and can be
+            blitted directly -- five byte stores instead of up to 48
+            virtual drawPixel calls. Invoked by Adafruit_GFX::drawChar()
+            for unmagnified text.
+    @param  x
+            Top left corner x coordinate.
+    @param  y
+            Top left corner y coordinate.
+    @param  glyph
+            The five font column bytes, bit 0 = top row.
+    @param  color
+            Text color; SSD1306_INVERSE falls back to the generic path.
+    @param  bg
+            Background color; when equal to color the glyph is drawn
+            transparently (set bits merged only).
+    @return true if the glyph was blitted, false to use the generic
+            pixel-by-pixel path.
+*/
+bool Adafruit_SSD1306::blitGlyphColumns(int16_t x, int16_t y,
+                                        const uint8_t glyph[5], uint16_t color,
+                                        uint16_t bg) {
+  // Only the native orientation with the glyph landing on one page; the
+  // 6th column below is the inter-character gap, hence x + 6.
+  if (rotation != 0 || (y & 7) || (y < 0) || (y + 8 > HEIGHT) || (x < 0) ||
+      (x + 6 > WIDTH) || (color == SSD1306_INVERSE) ||
+      (bg == SSD1306_INVERSE)) {
+    return false;
+  }
+
+  uint8_t *pBuf = &buffer[(y / 8) * WIDTH + x];
+  if (bg != color) {
+    // Opaque: glyph columns replace the bytes outright, plus the gap column.
+    for (int8_t i = 0; i < 5; i++) {
+      pBuf[i] = (color == SSD1306_WHITE) ? glyph[i] : (uint8_t)~glyph[i];
+    }
+    pBuf[5] = (bg == SSD1306_WHITE) ? 0xFF : 0x00;
+  } else if (color == SSD1306_WHITE) {
+    // Transparent: merge set bits only. This is the common case here --
+    // the status-line widgets erase their row with fillRect first.
+    for (int8_t i = 0; i < 5; i++) {
+      pBuf[i] |= glyph[i];
+    }
+  } else {
+    for (int8_t i = 0; i < 5; i++) {
+      pBuf[i] &= (uint8_t)~glyph[i];
+    }
   }
+  markDirty(x, x + 5, y / 8, y / 8);
+  return true;
 }
 
 /*!
@@ -681,6 +847,7 @@ void Adafruit_SSD1306::drawPixel(int16_t x, int16_t y, uint16_t color) {
 */
 void Adafruit_SSD1306::clearDisplay(void) {
   memset(buffer, 0, WIDTH * ((HEIGHT + 7) / 8));
+  markDirty(0, WIDTH - 1, 0, ((HEIGHT + 7) / 8) - 1);
 }
 
 /*!
@@ -760,6 +927,7 @@ void Adafruit_SSD1306::drawFastHLineInternal(int16_t x, int16_t y, int16_t w,
       w = (WIDTH - x);
     }
     if (w > 0) { // Proceed only if width is positive
+      int16_t wSaved = w; // The loops below consume w
       uint8_t *pBuf = &buffer[(y / 8) * WIDTH + x], mask = 1 << (y & 7);
       switch (color) {
       case SSD1306_WHITE:
@@ -779,6 +947,7 @@ void Adafruit_SSD1306::drawFastHLineInternal(int16_t x, int16_t y, int16_t w,
         };
         break;
       }
+      markDirty(x, x + wSaved - 1, y / 8, y / 8);
     }
   }
 }
@@ -863,6 +1032,7 @@ void Adafruit_SSD1306::drawFastVLineInternal(int16_t x, int16_t __y,
       // use local byte registers for faster juggling
       uint8_t y = __y, h = __h;
       uint8_t *pBuf = &buffer[(y / 8) * WIDTH + x];
+      markDirty(x, x, y / 8, (__y + __h - 1) / 8);
 
       // do the first partial byte, if necessary - this requires some masking
       uint8_t mod = (y & 7);
@@ -993,15 +1163,135 @@ uint8_t *Adafruit_SSD1306::getBuffer(void) { return buffer; }
             of graphics commands, as best needed by one's own application.
 */
 void Adafruit_SSD1306::display(void) {
-  TRANSACTION_START
-  static const uint8_t PROGMEM dlist1[] = {
-      SSD1306_PAGEADDR,
-      0,                      // Page start address
-      0xFF,                   // Page end (not really, but works here)
-      SSD1306_COLUMNADDR, 0}; // Column start address
-  ssd1306_commandList(dlist1, sizeof(dlist1));
-  ssd1306_command1(WIDTH - 1); // Column end address
+  transmitWindow(0, ((HEIGHT + 7) / 8) - 1, 0, WIDTH - 1);
+  clearDirty();
+}
+
+/*!
+    @brief  Set the bus clock used during transfers. For I2C this takes
+            effect at the next transaction; panels that support
+            fast-mode-plus run at 1 MHz. Pair with invalidateShadow() and
+            display() to measure whether the bus actually sustains a rate.
+    @param  duringHz
+            Clock in Hz applied for the duration of each transfer.
+    @return None (void).
+*/
+void Adafruit_SSD1306::setBusClock(uint32_t duringHz) {
+#if ARDUINO >= 157
+  wireClk = duringHz;
+#else
+  (void)duringHz;
+#endif
+}
+
+/*!
+    @brief  Forget what the panel is believed to hold, forcing the next
+            transmit to push every byte in its window. Use after events
+            that may have disturbed panel RAM, or to time a full-frame
+            transfer.
+    @return None (void).
+*/
+void Adafruit_SSD1306::invalidateShadow(void) { shadowValid = false; }
 
+/*!
+    @brief  Payload bytes pushed by the most recent synchronous transmit.
+    @return Byte count; 0 when the shadow diff skipped the bus entirely.
+*/
+uint16_t Adafruit_SSD1306::lastTransferBytes(void) { return xferBytes; }
+
+/*!
+    @brief  Wall-clock duration of the most recent synchronous transmit,
+            including addressing commands. With lastTransferBytes() this
+            gives the effective bus throughput; a shortfall against the
+            programmed clock indicates clock stretching or a marginal bus.
+    @return Duration in microseconds.
+*/
+uint32_t Adafruit_SSD1306::lastTransferMicros(void) { return xferMicros; }
+
+/*!
+    @brief  Push only the buffer region modified since the last refresh to
+            the SSD1306. Drawing calls (drawPixel, lines, fills, text) track
+            the bounding window they touch; this transmits just those page
+            rows and columns, which is far cheaper over I2C than a full
+            1 KB frame when a single widget line changed. A no-op when
+            nothing has been drawn since the last display()/displayRegion().
+    @return None (void).
+*/
+void Adafruit_SSD1306::displayRegion(void) {
+  if (dirtyXMax < dirtyXMin) {
+    return; // Nothing drawn since the last refresh
+  }
+  transmitWindow(dirtyPageMin, dirtyPageMax, (uint8_t)dirtyXMin,
+                 (uint8_t)dirtyXMax);
+  clearDirty();
+}
+
+// Trims [colStart, colEnd] to the span where buf differs from shad.
+// Returns false when the whole span is identical.
+static bool diffSpan(const uint8_t *buf, const uint8_t *shad, uint8_t colStart,
+                     uint8_t colEnd, uint8_t *first, uint8_t *last) {
+  int16_t f = colStart, l = colEnd;
+  while (f <= l && buf[f] == shad[f])
+    f++;
+  if (f > l)
+    return false;
+  while (buf[l] == shad[l])
+    l--;
+  *first = (uint8_t)f;
+  *last = (uint8_t)l;
+  return true;
+}
+
+/*!
+    @brief  Transmit a page/column window of the buffer to the display.
+            Each page is first diffed against the shadow of what the panel
+            already holds and trimmed to the span that really changed, so
+            redraw-happy code that reprints identical pixels costs no bus
+            traffic at all. Runs of changed pages share one address setup
+            (horizontal addressing wraps from the end of each column range
+            to the start of the next page). Diffing is off until a full
+            frame has been pushed, since the panel powers up with
+            undefined RAM.
+    @param  pageStart
+            First 8-row page to send.
+    @param  pageEnd
+            Last 8-row page to send.
+    @param  colStart
+            First column to send.
+    @param  colEnd
+            Last column to send.
+    @return None (void).
+*/
+void Adafruit_SSD1306::transmitWindow(uint8_t pageStart, uint8_t pageEnd,
+                                      uint8_t colStart, uint8_t colEnd) {
+  // Never interleave with an in-flight chunked transfer; its addressing
+  // window is still programmed into the controller.
+  while (asyncActive)
+    displayPump();
+
+  // Per-page changed spans; an SSD1306 has at most 8 pages.
+  const bool diff = (shadow != NULL) && shadowValid;
+  const uint8_t numPages = pageEnd - pageStart + 1;
+  uint8_t firstCol[8], lastCol[8];
+  bool send[8];
+  for (uint8_t i = 0; i < numPages; i++) {
+    uint16_t base = (uint16_t)(pageStart + i) * WIDTH;
+    if (diff) {
+      send[i] = diffSpan(buffer + base, shadow + base, colStart, colEnd,
+                         &firstCol[i], &lastCol[i]);
+    } else {
+      send[i] = true;
+      firstCol[i] = colStart;
+      lastCol[i] = colEnd;
+    }
+  }
+
+  // Timed so the effective bus throughput can be read back afterwards
+  // (see lastTransferBytes()/lastTransferMicros()).
+  uint32_t t0 = micros();
+  uint16_t bytesSent = 0;
+
+  TRANSACTION_START
 #if defined(ESP8266)
   // ESP8266 needs a periodic yield() call to avoid watchdog reset.
   // With the limited size of SSD1306 displays, and the fast bitrate
@@ -1011,34 +1301,202 @@ void Adafruit_SSD1306::display(void) {
   // 32-byte transfer condition below.
   yield();
 #endif
-  uint16_t count = WIDTH * ((HEIGHT + 7) / 8);
-  uint8_t *ptr = buffer;
-  if (wire) { // I2C
-    wire->beginTransmission(i2caddr);
-    WIRE_WRITE((uint8_t)0x40);
-    uint16_t bytesOut = 1;
-    while (count--) {
-      if (bytesOut >= WIRE_MAX) {
-        wire->endTransmission();
-        wire->beginTransmission(i2caddr);
-        WIRE_WRITE((uint8_t)0x40);
-        bytesOut = 1;
+  uint8_t i = 0;
+  while (i < numPages) {
+    if (!send[i]) {
+      i++;
+      continue; // Page matches the panel; no bus traffic
+    }
+    // Extend the run through consecutive changed pages, taking the union
+    // of their column spans so one address setup covers the run.
+    uint8_t j = i;
+    uint8_t f = firstCol[i], l = lastCol[i];
+    while (j + 1 < numPages && send[j + 1]) {
+      j++;
+      if (firstCol[j] < f)
+        f = firstCol[j];
+      if (lastCol[j] > l)
+        l = lastCol[j];
+    }
+    ssd1306_command1(SSD1306_PAGEADDR);
+    ssd1306_command1((uint8_t)(pageStart + i));
+    ssd1306_command1((uint8_t)(pageStart + j));
+    ssd1306_command1(SSD1306_COLUMNADDR);
+    ssd1306_command1(f);
+    ssd1306_command1(l);
+
+    uint16_t cols = l - f + 1;
+    if (wire) { // I2C
+      wire->beginTransmission(i2caddr);
+      WIRE_WRITE((uint8_t)0x40);
+      uint16_t bytesOut = 1;
+      uint8_t st;
+      for (uint8_t page = pageStart + i; page <= pageStart + j; page++) {
+        uint8_t *ptr = buffer + (uint16_t)page * WIDTH + f;
+        uint16_t count = cols;
+        while (count--) {
+          if (bytesOut >= WIRE_MAX) {
+            st = wire->endTransmission();
+            if (st)
+              wireStatus = st;
+            wire->beginTransmission(i2caddr);
+            WIRE_WRITE((uint8_t)0x40);
+            bytesOut = 1;
+          }
+          WIRE_WRITE(*ptr++);
+          bytesOut++;
+        }
+      }
+      st = wire->endTransmission();
+      if (st)
+        wireStatus = st;
+    } else { // SPI
+      SSD1306_MODE_DATA
+      for (uint8_t page = pageStart + i; page <= pageStart + j; page++) {
+        uint8_t *ptr = buffer + (uint16_t)page * WIDTH + f;
+        uint16_t count = cols;
+        while (count--)
+          SPIwrite(*ptr++);
       }
-      WIRE_WRITE(*ptr++);
-      bytesOut++;
     }
-    wire->endTransmission();
-  } else { // SPI
-    SSD1306_MODE_DATA
-    while (count--)
-      SPIwrite(*ptr++);
+    if (shadow) {
+      for (uint8_t page = pageStart + i; page <= pageStart + j; page++) {
+        uint16_t offset = (uint16_t)page * WIDTH + f;
+        memcpy(shadow + offset, buffer + offset, cols);
+      }
+    }
+    bytesSent += cols * (uint16_t)(j - i + 1);
+    i = j + 1;
   }
   TRANSACTION_END
+  xferMicros = micros() - t0;
+  xferBytes = bytesSent;
 #if defined(ESP8266)
   yield();
 #endif
+
+  // A full-frame push leaves the shadow mirroring the whole panel; diffing
+  // is safe from here on.
+  if (shadow && pageStart == 0 && pageEnd == ((HEIGHT + 7) / 8) - 1 &&
+      colStart == 0 && colEnd == WIDTH - 1) {
+    shadowValid = true;
+  }
 }
 
+/*!
+    @brief  Start a non-blocking refresh of the dirty window. The window is
+            snapshotted and the controller's addressing is programmed here
+            (a handful of command bytes); the pixel data then goes out one
+            small I2C chunk per displayPump() call, so the caller's loop is
+            never blocked for a full-window transfer.
+    @return true if a transfer was started (or nothing needed sending),
+            false if a previous transfer is still draining -- the dirty
+            window is kept, so a later call picks the changes up.
+*/
+bool Adafruit_SSD1306::displayRegionAsync(void) {
+  if (asyncActive) {
+    return false;
+  }
+  if (dirtyXMax < dirtyXMin) {
+    return true; // Nothing drawn since the last refresh
+  }
+  if (!wire || !shadow) {
+    // SPI path, or no snapshot buffer: synchronous is the only option.
+    displayRegion();
+    return true;
+  }
+
+  // Snapshot the window so drawing can continue into buffer mid-transfer
+  // without tearing what reaches the glass.
+  for (uint8_t page = dirtyPageMin; page <= dirtyPageMax; page++) {
+    uint16_t offset = (uint16_t)page * WIDTH + dirtyXMin;
+    memcpy(shadow + offset, buffer + offset, dirtyXMax - dirtyXMin + 1);
+  }
+
+  TRANSACTION_START
+  ssd1306_command1(SSD1306_PAGEADDR);
+  ssd1306_command1(dirtyPageMin);
+  ssd1306_command1(dirtyPageMax);
+  ssd1306_command1(SSD1306_COLUMNADDR);
+  ssd1306_command1((uint8_t)dirtyXMin);
+  ssd1306_command1((uint8_t)dirtyXMax);
+  TRANSACTION_END
+
+  asyncPage = dirtyPageMin;
+  asyncPageEnd = dirtyPageMax;
+  asyncColStart = (uint8_t)dirtyXMin;
+  asyncColEnd = (uint8_t)dirtyXMax;
+  asyncCol = asyncColStart;
+  asyncActive = true;
+  clearDirty();
+  return true;
+}
+
+/*!
+    @brief  Send the next chunk of an in-flight displayRegionAsync()
+            transfer: at most one Wire-buffer-sized I2C transmission, then
+            return. Call frequently (e.g. once per main loop pass); a no-op
+            when no transfer is active.
+    @return None (void).
+*/
+void Adafruit_SSD1306::displayPump(void) {
+  if (!asyncActive) {
+    return;
+  }
+
+  TRANSACTION_START
+  wire->beginTransmission(i2caddr);
+  WIRE_WRITE((uint8_t)0x40);
+  uint16_t bytesOut = 1;
+  while (bytesOut < WIRE_MAX) {
+    WIRE_WRITE(shadow[(uint16_t)asyncPage * WIDTH + asyncCol]);
+    bytesOut++;
+    if (asyncCol == asyncColEnd) {
+      asyncCol = asyncColStart;
+      if (asyncPage == asyncPageEnd) {
+        asyncActive = false;
+        break;
+      }
+      asyncPage++;
+    } else {
+      asyncCol++;
+    }
+  }
+  uint8_t st = wire->endTransmission();
+  if (st)
+    wireStatus = st;
+  TRANSACTION_END
+}
+
+/*!
+    @brief  Report whether a displayRegionAsync() transfer is in flight.
+    @return true while chunks remain to be pumped, false when idle.
+*/
+bool Adafruit_SSD1306::displayBusy(void) { return asyncActive; }
+
+/*!
+    @brief  Sticky I2C error report: the last nonzero endTransmission()
+            status recorded since the previous call. Reading clears it,
+            so callers can poll for error streaks without double counting.
+    @return 0 when every transmission since the last call succeeded,
+            else the Wire status code (2 = address NACK, 3 = data NACK,
+            4 = other error, 5 = timeout).
+*/
+uint8_t Adafruit_SSD1306::lastWireStatus(void) {
+  uint8_t st = wireStatus;
+  wireStatus = 0;
+  return st;
+}
+
+/*!
+    @brief  Drop an in-flight displayRegionAsync() transfer without
+            sending the remaining chunks. For bus fault recovery: the
+            panel's addressing state is unknown afterwards, so the caller
+            is expected to reinitialize and repaint from scratch.
+    @return None (void).
+*/
+void Adafruit_SSD1306::displayAbort(void) { asyncActive = false; }
+
 // SCROLLING FUNCTIONS -----------------------------------------------------
 
 /*!
@@ -1149,6 +1607,76 @@ void Adafruit_SSD1306::stopscroll(void) {
   TRANSACTION_END
 }
 
+/*!
+    @brief  Start the controller's autonomous horizontal scroll over a band
+            of pages, leaving the rest of the panel static. Once running the
+            panel animates with zero bus traffic. The scroll shifts the
+            controller's RAM, so the band's content diverges from the local
+            buffer (and its shadow) while active: do not draw into the band
+            until stopScrollRegion() has been called -- it marks the band
+            dirty so the next refresh repaints it from the buffer.
+    @param  firstPage
+            First 8-row page of the scroll band.
+    @param  lastPage
+            Last 8-row page of the scroll band.
+    @param  leftward
+            Scroll direction; false scrolls rightward.
+    @param  frameInterval
+            Step interval code per the datasheet's 3-bit field (0 = every
+            5 frames, ... 7 = every 2 frames).
+    @return None (void).
+*/
+void Adafruit_SSD1306::startScrollRegion(uint8_t firstPage, uint8_t lastPage,
+                                         bool leftward,
+                                         uint8_t frameInterval) {
+  TRANSACTION_START
+  // The datasheet requires scroll deactivated before reprogramming it.
+  ssd1306_command1(SSD1306_DEACTIVATE_SCROLL);
+  ssd1306_command1(leftward ? SSD1306_LEFT_HORIZONTAL_SCROLL
+                            : SSD1306_RIGHT_HORIZONTAL_SCROLL);
+  ssd1306_command1(0X00);
+  ssd1306_command1(firstPage);
+  ssd1306_command1(frameInterval & 0x07);
+  ssd1306_command1(lastPage);
+  ssd1306_command1(0X00);
+  ssd1306_command1(0XFF);
+  ssd1306_command1(SSD1306_ACTIVATE_SCROLL);
+  TRANSACTION_END
+  scrollFirstPage = firstPage;
+  scrollLastPage = lastPage;
+  scrollRegionActive = true;
+}
+
+/*!
+    @brief  Stop a startScrollRegion() scroll and queue the band for repair.
+            The scroll has shifted the panel's RAM out from under the local
+            mirror, so the whole band is marked dirty; the next refresh
+            repaints it from the buffer and re-syncs the shadow.
+    @return None (void).
+*/
+void Adafruit_SSD1306::stopScrollRegion(void) {
+  if (!scrollRegionActive) {
+    return;
+  }
+  TRANSACTION_START
+  ssd1306_command1(SSD1306_DEACTIVATE_SCROLL);
+  TRANSACTION_END
+  scrollRegionActive = false;
+  markDirty(0, WIDTH - 1, scrollFirstPage, scrollLastPage);
+}
+
+/*!
+    @brief  Report whether everything drawn has reached the glass: no
+            chunked transfer in flight and nothing in the dirty window.
+            Callers sequencing against the panel's RAM (e.g. seeding a
+            scroll band before starting it) wait on this.
+    @return true when the panel matches the buffer, false while a refresh
+            is pending or draining.
+*/
+bool Adafruit_SSD1306::displayIdle(void) {
+  return !asyncActive && dirtyXMax < dirtyXMin;
+}
+
 // OTHER HARDWARE SETTINGS -------------------------------------------------
 
 /*!
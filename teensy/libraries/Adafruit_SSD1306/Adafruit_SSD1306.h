@@ -150,10 +150,15 @@ public:
   bool begin(uint8_t switchvcc = SSD1306_SWITCHCAPVCC, uint8_t i2caddr = 0,
              bool reset = true, bool periphBegin = true);
   void display(void);
+  void displayRegion(void);
+  bool displayRegionAsync(void);
+  void displayPump(void);
+  bool displayBusy(void);
   void clearDisplay(void);
   void invertDisplay(bool i);
   void dim(bool dim);
   void drawPixel(int16_t x, int16_t y, uint16_t color);
+  void drawCanvas1(int16_t x, int16_t y, const GFXcanvas1 &canvas);
   virtual void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
   virtual void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
   void startscrollright(uint8_t start, uint8_t stop);
@@ -161,14 +166,30 @@ public:
   void startscrolldiagright(uint8_t start, uint8_t stop);
   void startscrolldiagleft(uint8_t start, uint8_t stop);
   void stopscroll(void);
+  void startScrollRegion(uint8_t firstPage, uint8_t lastPage, bool leftward,
+                         uint8_t frameInterval);
+  void stopScrollRegion(void);
+  bool displayIdle(void);
   void ssd1306_command(uint8_t c);
   bool getPixel(int16_t x, int16_t y);
   uint8_t *getBuffer(void);
+  void setBusClock(uint32_t duringHz);
+  void invalidateShadow(void);
+  uint16_t lastTransferBytes(void);
+  uint32_t lastTransferMicros(void);
+  uint8_t lastWireStatus(void);
+  void displayAbort(void);
 
 protected:
   inline void SPIwrite(uint8_t d) __attribute__((always_inline));
   void drawFastHLineInternal(int16_t x, int16_t y, int16_t w, uint16_t color);
   void drawFastVLineInternal(int16_t x, int16_t y, int16_t h, uint16_t color);
+  virtual bool blitGlyphColumns(int16_t x, int16_t y, const uint8_t glyph[5],
+                                uint16_t color, uint16_t bg);
+  void markDirty(int16_t xMin, int16_t xMax, uint8_t pageMin, uint8_t pageMax);
+  void clearDirty(void);
+  void transmitWindow(uint8_t pageStart, uint8_t pageEnd, uint8_t colStart,
+                      uint8_t colEnd);
   void ssd1306_command1(uint8_t c);
   void ssd1306_commandList(const uint8_t *c, uint8_t n);
 
@@ -198,6 +219,29 @@ protected:
   uint32_t restoreClk; ///< Wire speed following SSD1306 transfers
 #endif
   uint8_t contrast; ///< normal contrast setting for this device
+  int16_t dirtyXMin = 0x7FFF; ///< Leftmost modified column since last refresh
+  int16_t dirtyXMax = -1;     ///< Rightmost modified column since last refresh
+  uint8_t dirtyPageMin = 0xFF; ///< First modified 8-row page
+  uint8_t dirtyPageMax = 0;    ///< Last modified 8-row page
+  uint8_t *shadow = NULL; ///< Mirror of the panel's RAM: transmits diff
+                          ///< against it, and async transfers stream from it
+                          ///< so later drawing into buffer cannot tear a frame
+  bool shadowValid = false; ///< Shadow mirrors the whole panel (set after the
+                            ///< first full-frame transmit); diffing is off
+                            ///< until then since panel RAM powers up undefined
+  uint16_t xferBytes = 0; ///< Payload bytes sent by the last transmitWindow()
+  uint32_t xferMicros = 0; ///< Wall time of the last transmitWindow()
+  bool scrollRegionActive = false; ///< Hardware scroll band running
+  uint8_t scrollFirstPage = 0;     ///< First page of the scroll band
+  uint8_t scrollLastPage = 0;      ///< Last page of the scroll band
+  bool asyncActive = false;  ///< A chunked window transfer is in flight
+  uint8_t asyncPageEnd = 0;  ///< Last page of the in-flight window
+  uint8_t asyncColStart = 0; ///< First column of the in-flight window
+  uint8_t asyncColEnd = 0;   ///< Last column of the in-flight window
+  uint8_t asyncPage = 0;     ///< Next page to transmit
+  uint8_t asyncCol = 0;      ///< Next column within asyncPage
+  uint8_t wireStatus = 0;    ///< Last nonzero endTransmission() status;
+                             ///< cleared by lastWireStatus()
 #if defined(SPI_HAS_TRANSACTION)
 protected:
   // Allow sub-class to change
@@ -180,108 +180,177 @@ boolean PubSubClient::connect(const char *id, const char *user, const char *pass
 
 boolean PubSubClient::connect(const char *id, const char *user, const char *pass, const char* willTopic, uint8_t willQos, boolean willRetain, const char* willMessage, boolean cleanSession) {
     if (!connected()) {
-        int result = 0;
-
+        if (!sendConnectPacket(id,user,pass,willTopic,willQos,willRetain,willMessage,cleanSession)) {
+            return false;
+        }
 
-        if(_client->connected()) {
-            result = 1;
-        } else {
-            if (domain != NULL) {
-                result = _client->connect(this->domain, this->port);
+        while (!_client->available()) {
+            unsigned long t = millis();
+            if (t-lastInActivity >= ((int32_t) this->socketTimeout*1000UL)) {
+                _state = MQTT_CONNECTION_TIMEOUT;
+                _client->stop();
+                return false;
+            }
+        }
+        uint8_t llen;
+        uint32_t len = readPacket(&llen);
+
+        if (len == 4) {
+            if (buffer[3] == 0) {
+                lastInActivity = millis();
+                pingOutstanding = false;
+                _state = MQTT_CONNECTED;
+                return true;
             } else {
-                result = _client->connect(this->ip, this->port);
+                _state = buffer[3];
             }
         }
+        _client->stop();
+        return false;
+    }
+    return true;
+}
 
-        if (result == 1) {
-            nextMsgId = 1;
-            // Leave room in the buffer for header and variable length field
-            uint16_t length = MQTT_MAX_HEADER_SIZE;
-            unsigned int j;
+boolean PubSubClient::sendConnectPacket(const char *id, const char *user, const char *pass, const char* willTopic, uint8_t willQos, boolean willRetain, const char* willMessage, boolean cleanSession) {
+    int result = 0;
+
+
+    if(_client->connected()) {
+        result = 1;
+    } else {
+        if (domain != NULL) {
+            result = _client->connect(this->domain, this->port);
+        } else {
+            result = _client->connect(this->ip, this->port);
+        }
+    }
+
+    if (result == 1) {
+        nextMsgId = 1;
+        // Leave room in the buffer for header and variable length field
+        uint16_t length = MQTT_MAX_HEADER_SIZE;
+        unsigned int j;
 
 #if MQTT_VERSION == MQTT_VERSION_3_1
-            uint8_t d[9] = {0x00,0x06,'M','Q','I','s','d','p', MQTT_VERSION};
+        uint8_t d[9] = {0x00,0x06,'M','Q','I','s','d','p', MQTT_VERSION};
 #define MQTT_HEADER_VERSION_LENGTH 9
 #elif MQTT_VERSION == MQTT_VERSION_3_1_1
-            uint8_t d[7] = {0x00,0x04,'M','Q','T','T',MQTT_VERSION};
+        uint8_t d[7] = {0x00,0x04,'M','Q','T','T',MQTT_VERSION};
 #define MQTT_HEADER_VERSION_LENGTH 7
 #endif
-            for (j = 0;j<MQTT_HEADER_VERSION_LENGTH;j++) {
-                this->buffer[length++] = d[j];
-            }
+        for (j = 0;j<MQTT_HEADER_VERSION_LENGTH;j++) {
+            this->buffer[length++] = d[j];
+        }
 
-            uint8_t v;
-            if (willTopic) {
-                v = 0x04|(willQos<<3)|(willRetain<<5);
-            } else {
-                v = 0x00;
-            }
-            if (cleanSession) {
-                v = v|0x02;
-            }
+        uint8_t v;
+        if (willTopic) {
+            v = 0x04|(willQos<<3)|(willRetain<<5);
+        } else {
+            v = 0x00;
+        }
+        if (cleanSession) {
+            v = v|0x02;
+        }
 
-            if(user != NULL) {
-                v = v|0x80;
+        if(user != NULL) {
+            v = v|0x80;
 
-                if(pass != NULL) {
-                    v = v|(0x80>>1);
-                }
-            }
-            this->buffer[length++] = v;
-
-            this->buffer[length++] = ((this->keepAlive) >> 8);
-            this->buffer[length++] = ((this->keepAlive) & 0xFF);
-
-            CHECK_STRING_LENGTH(length,id)
-            length = writeString(id,this->buffer,length);
-            if (willTopic) {
-                CHECK_STRING_LENGTH(length,willTopic)
-                length = writeString(willTopic,this->buffer,length);
-                CHECK_STRING_LENGTH(length,willMessage)
-                length = writeString(willMessage,this->buffer,length);
+            if(pass != NULL) {
+                v = v|(0x80>>1);
             }
+        }
+        this->buffer[length++] = v;
+
+        this->buffer[length++] = ((this->keepAlive) >> 8);
+        this->buffer[length++] = ((this->keepAlive) & 0xFF);
+
+        CHECK_STRING_LENGTH(length,id)
+        length = writeString(id,this->buffer,length);
+        if (willTopic) {
+            CHECK_STRING_LENGTH(length,willTopic)
+            length = writeString(willTopic,this->buffer,length);
+            CHECK_STRING_LENGTH(length,willMessage)
+            length = writeString(willMessage,this->buffer,length);
+        }
 
-            if(user != NULL) {
-                CHECK_STRING_LENGTH(length,user)
-                length = writeString(user,this->buffer,length);
-                if(pass != NULL) {
-                    CHECK_STRING_LENGTH(length,pass)
-                    length = writeString(pass,this->buffer,length);
-                }
+        if(user != NULL) {
+            CHECK_STRING_LENGTH(length,user)
+            length = writeString(user,this->buffer,length);
+            if(pass != NULL) {
+                CHECK_STRING_LENGTH(length,pass)
+                length = writeString(pass,this->buffer,length);
             }
+        }
 
-            write(MQTTCONNECT,this->buffer,length-MQTT_MAX_HEADER_SIZE);
+        write(MQTTCONNECT,this->buffer,length-MQTT_MAX_HEADER_SIZE);
 
-            lastInActivity = lastOutActivity = millis();
+        lastInActivity = lastOutActivity = millis();
+        return true;
+    } else {
+        _state = MQTT_CONNECT_FAILED;
+    }
+    return false;
+}
 
-            while (!_client->available()) {
-                unsigned long t = millis();
-                if (t-lastInActivity >= ((int32_t) this->socketTimeout*1000UL)) {
-                    _state = MQTT_CONNECTION_TIMEOUT;
-                    _client->stop();
-                    return false;
-                }
-            }
-            uint8_t llen;
-            uint32_t len = readPacket(&llen);
+boolean PubSubClient::connectAsync(const char *id) {
+    return connectAsync(id,NULL,NULL);
+}
 
-            if (len == 4) {
-                if (buffer[3] == 0) {
-                    lastInActivity = millis();
-                    pingOutstanding = false;
-                    _state = MQTT_CONNECTED;
-                    return true;
-                } else {
-                    _state = buffer[3];
-                }
-            }
+boolean PubSubClient::connectAsync(const char *id, const char *user, const char *pass) {
+    return connectAsync(id,user,pass,0,0,0,0);
+}
+
+boolean PubSubClient::connectAsync(const char *id, const char* willTopic, uint8_t willQos, boolean willRetain, const char* willMessage) {
+    return connectAsync(id,NULL,NULL,willTopic,willQos,willRetain,willMessage);
+}
+
+boolean PubSubClient::connectAsync(const char *id, const char *user, const char *pass, const char* willTopic, uint8_t willQos, boolean willRetain, const char* willMessage) {
+    if (connected()) {
+        return true;
+    }
+    if (!sendConnectPacket(id,user,pass,willTopic,willQos,willRetain,willMessage,1)) {
+        return false;
+    }
+    _state = MQTT_CONNECT_IN_PROGRESS;
+    return true;
+}
+
+boolean PubSubClient::connectAsyncPoll() {
+    if (_state == MQTT_CONNECTED) {
+        return true;
+    }
+    if (_state != MQTT_CONNECT_IN_PROGRESS) {
+        return false;
+    }
+    if (!(int)_client->connected()) {
+        _state = MQTT_CONNECTION_LOST;
+        _client->stop();
+        return false;
+    }
+    if (_client->available() < 4) {
+        // CONNACK is 4 bytes; wait until all of it has arrived so the
+        // readPacket below never blocks on a partial packet.
+        if (millis()-lastInActivity >= ((int32_t) this->socketTimeout*1000UL)) {
+            _state = MQTT_CONNECTION_TIMEOUT;
             _client->stop();
-        } else {
-            _state = MQTT_CONNECT_FAILED;
         }
         return false;
     }
-    return true;
+    uint8_t llen;
+    uint32_t len = readPacket(&llen);
+    if (len == 4) {
+        if (buffer[3] == 0) {
+            lastInActivity = millis();
+            pingOutstanding = false;
+            _state = MQTT_CONNECTED;
+            return true;
+        }
+        _state = buffer[3];
+    } else {
+        _state = MQTT_CONNECT_FAILED;
+    }
+    _client->stop();
+    return false;
 }
 
 // reads a byte into result
@@ -393,7 +462,7 @@ boolean PubSubClient::loop() {
                 lastInActivity = t;
                 uint8_t type = this->buffer[0]&0xF0;
                 if (type == MQTTPUBLISH) {
-                    if (callback) {
+                    if (callback || sliceCallback) {
                         uint16_t tl = (this->buffer[llen+1]<<8)+this->buffer[llen+2]; /* topic length in bytes */
                         memmove(this->buffer+llen+2,this->buffer+llen+3,tl); /* move topic inside buffer 1 byte to front */
                         this->buffer[llen+2+tl] = 0; /* end the topic as a 'C' string with \x00 */
@@ -402,7 +471,7 @@ boolean PubSubClient::loop() {
                         if ((this->buffer[0]&0x06) == MQTTQOS1) {
                             msgId = (this->buffer[llen+3+tl]<<8)+this->buffer[llen+3+tl+1];
                             payload = this->buffer+llen+3+tl+2;
-                            callback(topic,payload,len-llen-3-tl-2);
+                            dispatchPublish(topic,payload,len-llen-3-tl-2);
 
                             this->buffer[0] = MQTTPUBACK;
                             this->buffer[1] = 2;
@@ -413,7 +482,7 @@ boolean PubSubClient::loop() {
 
                         } else {
                             payload = this->buffer+llen+3+tl;
-                            callback(topic,payload,len-llen-3-tl);
+                            dispatchPublish(topic,payload,len-llen-3-tl);
                         }
                     }
                 } else if (type == MQTTPINGREQ) {
@@ -510,10 +579,28 @@ boolean PubSubClient::publish_P(const char* topic, const uint8_t* payload, unsig
 
     pos = writeString(topic,this->buffer,pos);
 
-    rc += _client->write(this->buffer,pos);
-
-    for (i=0;i<plength;i++) {
-        rc += _client->write((char)pgm_read_byte_near(payload + i));
+    // Assemble the PROGMEM payload into the packet buffer behind the
+    // header and write in bufferSize chunks - one memcpy_P (a plain
+    // memcpy on memory-mapped-flash targets) and one socket call per
+    // chunk instead of a pgm_read per payload byte. Payloads larger
+    // than the buffer stream through chunk by chunk, so a flash payload
+    // is not bounded by bufferSize the way publish() is.
+    i = 0;
+    while (i < plength) {
+        unsigned int chunk = this->bufferSize - pos;
+        if (chunk > plength - i) {
+            chunk = plength - i;
+        }
+        memcpy_P(this->buffer + pos, payload + i, chunk);
+        pos += chunk;
+        i += chunk;
+        if (pos == this->bufferSize) {
+            rc += _client->write(this->buffer,pos);
+            pos = 0;
+        }
+    }
+    if (pos > 0) {
+        rc += _client->write(this->buffer,pos);
     }
 
     lastOutActivity = millis();
@@ -525,7 +612,12 @@ boolean PubSubClient::publish_P(const char* topic, const uint8_t* payload, unsig
 
 boolean PubSubClient::beginPublish(const char* topic, unsigned int plength, boolean retained) {
     if (connected()) {
-        // Send the header and variable length field
+        // Build the header and variable length field, then hold the whole
+        // packet in the buffer: payload writes are appended behind the
+        // header and the packet goes out in as few socket calls as the
+        // buffer allows (one, when it fits). Note: loop() and the other
+        // publish methods share this buffer, so nothing else may run
+        // between beginPublish() and endPublish().
         uint16_t length = MQTT_MAX_HEADER_SIZE;
         length = writeString(topic,this->buffer,length);
         uint8_t header = MQTTPUBLISH;
@@ -533,25 +625,68 @@ boolean PubSubClient::beginPublish(const char* topic, unsigned int plength, bool
             header |= 1;
         }
         size_t hlen = buildHeader(header, this->buffer, plength+length-MQTT_MAX_HEADER_SIZE);
-        uint16_t rc = _client->write(this->buffer+(MQTT_MAX_HEADER_SIZE-hlen),length-(MQTT_MAX_HEADER_SIZE-hlen));
-        lastOutActivity = millis();
-        return (rc == (length-(MQTT_MAX_HEADER_SIZE-hlen)));
+        outAssembling = true;
+        outStart = MQTT_MAX_HEADER_SIZE-hlen;
+        outPos = length;
+        return true;
     }
     return false;
 }
 
 int PubSubClient::endPublish() {
- return 1;
+    if (!outAssembling) {
+        return 1;
+    }
+    boolean ok = true;
+    if (outPos > outStart) {
+        uint16_t rc = _client->write(this->buffer+outStart,outPos-outStart);
+        ok = (rc == outPos-outStart);
+    }
+    outAssembling = false;
+    outStart = 0;
+    outPos = 0;
+    lastOutActivity = millis();
+    return ok ? 1 : 0;
+}
+
+void PubSubClient::flushOutgoing() {
+    if (_client != NULL) {
+        _client->flush();
+    }
 }
 
 size_t PubSubClient::write(uint8_t data) {
-    lastOutActivity = millis();
-    return _client->write(data);
+    return write(&data,1);
 }
 
 size_t PubSubClient::write(const uint8_t *buffer, size_t size) {
+    if (!outAssembling) {
+        lastOutActivity = millis();
+        return _client->write(buffer,size);
+    }
+    // Gather into the packet buffer; flush a full buffer and keep going so
+    // payloads larger than the buffer still stream through.
+    size_t written = 0;
+    while (written < size) {
+        if (outPos == this->bufferSize) {
+            uint16_t rc = _client->write(this->buffer+outStart,outPos-outStart);
+            if (rc != outPos-outStart) {
+                return written;
+            }
+            outStart = 0;
+            outPos = 0;
+        }
+        uint16_t space = this->bufferSize - outPos;
+        size_t chunk = size - written;
+        if (chunk > space) {
+            chunk = space;
+        }
+        memcpy(this->buffer+outPos,buffer+written,chunk);
+        outPos += chunk;
+        written += chunk;
+    }
     lastOutActivity = millis();
-    return _client->write(buffer,size);
+    return written;
 }
 
 size_t PubSubClient::buildHeader(uint8_t header, uint8_t* buf, uint16_t length) {
@@ -723,6 +858,27 @@ PubSubClient& PubSubClient::setCallback(MQTT_CALLBACK_SIGNATURE) {
     return *this;
 }
 
+PubSubClient& PubSubClient::setSliceCallback(MqttTopicResolver resolver, MqttSliceCallback cb) {
+    this->topicResolver = resolver;
+    this->sliceCallback = cb;
+    return *this;
+}
+
+void PubSubClient::dispatchPublish(char* topic, uint8_t* payload, uint16_t plength) {
+    if (sliceCallback) {
+        // NUL-terminate in place so slice users get a C string without
+        // copying. There is a spare byte unless the packet exactly fills
+        // the buffer; in that corner case the view is length-only.
+        if (payload + plength < this->buffer + this->bufferSize) {
+            payload[plength] = 0;
+        }
+        uint16_t topicId = topicResolver ? topicResolver(topic) : MQTT_TOPIC_ID_NONE;
+        sliceCallback(topicId, (const char*)payload, plength);
+    } else if (callback) {
+        callback(topic, payload, plength);
+    }
+}
+
 PubSubClient& PubSubClient::setClient(Client& client){
     this->_client = &client;
     return *this;
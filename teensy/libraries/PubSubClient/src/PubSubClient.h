@@ -42,6 +42,7 @@
 //#define MQTT_MAX_TRANSFER_SIZE 80
 
 // Possible values for client.state()
+#define MQTT_CONNECT_IN_PROGRESS    -5
 #define MQTT_CONNECTION_TIMEOUT     -4
 #define MQTT_CONNECTION_LOST        -3
 #define MQTT_CONNECT_FAILED         -2
@@ -83,6 +84,18 @@
 #define MQTT_CALLBACK_SIGNATURE void (*callback)(char*, uint8_t*, unsigned int)
 #endif
 
+// Zero-copy receive path. The classic callback hands out the raw payload
+// bytes, so users typically copy them again just to get a NUL-terminated
+// string. As an alternative the application can register a topic resolver
+// plus a slice callback: on each inbound PUBLISH the library NUL-terminates
+// the payload in place, asks the resolver to map the topic string to an
+// application-defined id, and invokes the slice callback with a read-only
+// view straight into the receive buffer. The view is only valid for the
+// duration of the callback.
+#define MQTT_TOPIC_ID_NONE 0xFFFFu
+typedef uint16_t (*MqttTopicResolver)(const char* topic);
+typedef void (*MqttSliceCallback)(uint16_t topicId, const char* payload, uint16_t length);
+
 #define CHECK_STRING_LENGTH(l,s) if (l+2+strnlen(s, this->bufferSize) > this->bufferSize) {_client->stop();return false;}
 
 class PubSubClient : public Print {
@@ -97,10 +110,25 @@ private:
    unsigned long lastInActivity;
    bool pingOutstanding;
    MQTT_CALLBACK_SIGNATURE;
+   MqttTopicResolver topicResolver = NULL;
+   MqttSliceCallback sliceCallback = NULL;
+   // beginPublish()/endPublish() packet assembly state. Payload bytes
+   // written between the two calls are gathered in the packet buffer and
+   // flushed in bufferSize chunks, instead of one socket write per call
+   // (each of which the network stack may turn into its own TCP segment).
+   boolean outAssembling = false;
+   uint16_t outStart = 0;
+   uint16_t outPos = 0;
+   // Route an inbound PUBLISH to the slice callback (zero-copy) when one
+   // is registered, otherwise to the classic callback.
+   void dispatchPublish(char* topic, uint8_t* payload, uint16_t plength);
    uint32_t readPacket(uint8_t*);
    boolean readByte(uint8_t * result);
    boolean readByte(uint8_t * result, uint16_t * index);
    boolean write(uint8_t header, uint8_t* buf, uint16_t length);
+   // Open the transport if needed and send the CONNECT packet (shared by
+   // the blocking and async connect paths). Does not wait for CONNACK.
+   boolean sendConnectPacket(const char* id, const char* user, const char* pass, const char* willTopic, uint8_t willQos, boolean willRetain, const char* willMessage, boolean cleanSession);
    uint16_t writeString(const char* string, uint8_t* buf, uint16_t pos);
    // Build up the header ready to send
    // Returns the size of the header
@@ -134,6 +162,7 @@ public:
    PubSubClient& setServer(uint8_t * ip, uint16_t port);
    PubSubClient& setServer(const char * domain, uint16_t port);
    PubSubClient& setCallback(MQTT_CALLBACK_SIGNATURE);
+   PubSubClient& setSliceCallback(MqttTopicResolver resolver, MqttSliceCallback cb);
    PubSubClient& setClient(Client& client);
    PubSubClient& setStream(Stream& stream);
    PubSubClient& setKeepAlive(uint16_t keepAlive);
@@ -147,6 +176,24 @@ public:
    boolean connect(const char* id, const char* willTopic, uint8_t willQos, boolean willRetain, const char* willMessage);
    boolean connect(const char* id, const char* user, const char* pass, const char* willTopic, uint8_t willQos, boolean willRetain, const char* willMessage);
    boolean connect(const char* id, const char* user, const char* pass, const char* willTopic, uint8_t willQos, boolean willRetain, const char* willMessage, boolean cleanSession);
+   // Non-blocking connect. Sends the CONNECT packet and returns immediately
+   // instead of waiting up to the socket timeout for CONNACK; while the
+   // handshake is pending state() reports MQTT_CONNECT_IN_PROGRESS. Call
+   // connectAsyncPoll() from the application loop to complete it.
+   boolean connectAsync(const char* id);
+   boolean connectAsync(const char* id, const char* user, const char* pass);
+   // Async connect with a last-will registration, for broker-side offline
+   // detection within the keepalive window.
+   boolean connectAsync(const char* id, const char* willTopic, uint8_t willQos,
+                        boolean willRetain, const char* willMessage);
+   boolean connectAsync(const char* id, const char* user, const char* pass,
+                        const char* willTopic, uint8_t willQos,
+                        boolean willRetain, const char* willMessage);
+   // Advance a pending async connect. Returns true once the broker has
+   // accepted the connection. Never blocks: it waits until the whole 4-byte
+   // CONNACK has arrived before reading. On refusal or timeout the socket
+   // is closed and state() holds the reason.
+   boolean connectAsyncPoll();
    void disconnect();
    boolean publish(const char* topic, const char* payload);
    boolean publish(const char* topic, const char* payload, boolean retained);
@@ -166,6 +213,10 @@ public:
    // Finish off this publish message (started with beginPublish)
    // Returns 1 if the packet was sent successfully, 0 if there was an error
    int endPublish();
+   // Flush the underlying transport's outgoing buffer, forcing any queued
+   // bytes onto the wire immediately. Useful after a latency-critical
+   // publish when the transport coalesces writes.
+   void flushOutgoing();
    // Write a single byte of payload (only to be used with beginPublish/endPublish)
    virtual size_t write(uint8_t);
    // Write size bytes from buffer into the payload (only to be used with beginPublish/endPublish)
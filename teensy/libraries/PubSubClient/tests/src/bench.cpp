@@ -0,0 +1,192 @@
+/*
+Throughput benchmark for the vendored PubSubClient.
+
+Measures publishes/sec and bytes pushed through the Client write path
+across payload sizes from 16 B up to the 1024-byte buffer the firmware
+configures in initMqtt(). The client is a counting sink (no per-byte
+expect matching like ShimClient), so the numbers reflect PubSubClient's
+own packet assembly and write batching, not the harness.
+
+Usage, from tests/:
+
+    make bench                  # build and print current numbers
+    bin/bench > before.txt      # save a baseline
+    ... modify ../src/PubSubClient.cpp ...
+    make bench BENCH_ARGS=before.txt   # or: bin/bench before.txt
+
+With a baseline argument each row also prints the percent change, so
+every library modification lands with numbers.
+*/
+
+#include "PubSubClient.h"
+#include "Client.h"
+#include "IPAddress.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+// The buffer size initMqtt() configures on the statues.
+#define BENCH_BUFFER_SIZE 1024
+
+// Measurement window per payload size.
+#define BENCH_WINDOW_MS 500
+
+static const unsigned int payloadSizes[] = {16, 64, 256, 512, 1000};
+#define BENCH_NUM_SIZES (sizeof(payloadSizes) / sizeof(payloadSizes[0]))
+
+// A connected sink that counts write-path traffic and discards it.
+// Serves one canned CONNACK so PubSubClient::connect() succeeds.
+class BenchClient : public Client {
+public:
+    unsigned long writeCalls;
+    unsigned long singleByteCalls;
+    unsigned long bytesWritten;
+
+    BenchClient() { reset(); connackRemaining = 0; isConnected = false; }
+
+    void reset() {
+        writeCalls = 0;
+        singleByteCalls = 0;
+        bytesWritten = 0;
+    }
+
+    virtual int connect(IPAddress, uint16_t) {
+        isConnected = true;
+        connackRemaining = 4;
+        return 1;
+    }
+    virtual int connect(const char*, uint16_t) {
+        isConnected = true;
+        connackRemaining = 4;
+        return 1;
+    }
+    virtual size_t write(uint8_t) {
+        writeCalls++;
+        singleByteCalls++;
+        bytesWritten++;
+        return 1;
+    }
+    virtual size_t write(const uint8_t*, size_t size) {
+        writeCalls++;
+        bytesWritten += size;
+        return size;
+    }
+    virtual int available() { return connackRemaining; }
+    virtual int read() {
+        static const uint8_t connack[] = {0x20, 0x02, 0x00, 0x00};
+        if (connackRemaining == 0) {
+            return -1;
+        }
+        return connack[4 - connackRemaining--];
+    }
+    virtual int read(uint8_t* buf, size_t size) {
+        for (size_t i = 0; i < size; i++) {
+            buf[i] = read();
+        }
+        return size;
+    }
+    virtual int peek() { return 0; }
+    virtual void flush() {}
+    virtual void stop() { isConnected = false; }
+    virtual uint8_t connected() { return isConnected; }
+    virtual operator bool() { return true; }
+
+private:
+    int connackRemaining;
+    bool isConnected;
+};
+
+struct BenchRow {
+    unsigned int size;
+    double msgsPerSec;
+    double mbPerSec;
+    double writeCallsPerMsg;
+};
+
+static void callback(char*, uint8_t*, unsigned int) {}
+
+static BenchRow runSize(unsigned int size) {
+    uint8_t server[] = {172, 16, 0, 2};
+    BenchClient net;
+    PubSubClient client(server, 1883, callback, net);
+    client.setBufferSize(BENCH_BUFFER_SIZE);
+    client.connect((char*)"bench");
+
+    static uint8_t payload[BENCH_BUFFER_SIZE];
+    memset(payload, 'x', size);
+
+    net.reset();
+    unsigned long msgs = 0;
+    using clock = std::chrono::steady_clock;
+    clock::time_point start = clock::now();
+    clock::time_point deadline =
+        start + std::chrono::milliseconds(BENCH_WINDOW_MS);
+    clock::time_point now;
+    do {
+        client.publish((char*)"bench/throughput", payload, size);
+        msgs++;
+        now = clock::now();
+    } while (now < deadline);
+
+    double seconds = std::chrono::duration<double>(now - start).count();
+    BenchRow row;
+    row.size = size;
+    row.msgsPerSec = msgs / seconds;
+    row.mbPerSec = net.bytesWritten / seconds / (1024.0 * 1024.0);
+    row.writeCallsPerMsg = (double)net.writeCalls / msgs;
+    return row;
+}
+
+// Baseline files are the program's own stdout, one row per line.
+static int loadBaseline(const char* path, BenchRow* rows, int maxRows) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "bench: cannot open baseline %s\n", path);
+        return 0;
+    }
+    int count = 0;
+    char line[256];
+    while (count < maxRows && fgets(line, sizeof(line), f)) {
+        BenchRow& row = rows[count];
+        if (sscanf(line,
+                   "size=%u msgs_per_sec=%lf mb_per_sec=%lf "
+                   "write_calls_per_msg=%lf",
+                   &row.size, &row.msgsPerSec, &row.mbPerSec,
+                   &row.writeCallsPerMsg) == 4) {
+            count++;
+        }
+    }
+    fclose(f);
+    return count;
+}
+
+static double pctChange(double before, double after) {
+    return (after - before) / before * 100.0;
+}
+
+int main(int argc, char** argv) {
+    BenchRow baseline[BENCH_NUM_SIZES];
+    int baselineCount = 0;
+    if (argc > 1) {
+        baselineCount = loadBaseline(argv[1], baseline, BENCH_NUM_SIZES);
+    }
+
+    for (unsigned int i = 0; i < BENCH_NUM_SIZES; i++) {
+        BenchRow row = runSize(payloadSizes[i]);
+        printf("size=%u msgs_per_sec=%.0f mb_per_sec=%.2f "
+               "write_calls_per_msg=%.1f",
+               row.size, row.msgsPerSec, row.mbPerSec, row.writeCallsPerMsg);
+        for (int b = 0; b < baselineCount; b++) {
+            if (baseline[b].size == row.size) {
+                printf("  # msgs %+.1f%%, MB/s %+.1f%%, calls %+.1f%%",
+                       pctChange(baseline[b].msgsPerSec, row.msgsPerSec),
+                       pctChange(baseline[b].mbPerSec, row.mbPerSec),
+                       pctChange(baseline[b].writeCallsPerMsg,
+                                 row.writeCallsPerMsg));
+            }
+        }
+        printf("\n");
+    }
+    return 0;
+}
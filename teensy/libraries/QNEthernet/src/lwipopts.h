@@ -347,7 +347,7 @@ void qnethernet_hal_check_core_locking(const char *file, int line,
 
 // Statistics options
 #ifndef LWIP_STATS
-#define LWIP_STATS         0  /* 1 */
+#define LWIP_STATS         1  /* 0; enabled for network health telemetry */
 #endif  // !LWIP_STATS
 #ifndef LWIP_STATS_LARGE
 // #define LWIP_STATS_LARGE   0
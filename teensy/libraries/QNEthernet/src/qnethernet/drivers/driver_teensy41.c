@@ -286,6 +286,13 @@ static volatile enetbufferdesc_t *s_pTxBD = &s_txRing[0];
 static atomic_flag s_rxNotAvail       = ATOMIC_FLAG_INIT;
 static enet_init_states_t s_initState = kInitStateStart;
 
+// Driver-level statistics; see driver_get_stats(). Each is written from a
+// single context (ISR or input/output path) and read with single-word loads.
+static volatile uint32_t s_statsIrqCount        = 0;
+static volatile uint32_t s_statsRxDropped       = 0;
+static volatile uint32_t s_statsTxStalls        = 0;
+static volatile uint32_t s_statsRxRingHighWater = 0;
+
 // PHY status, polled
 static int s_checkLinkStatusState = 0;
 static bool s_linkSpeed10Not100 = false;
@@ -619,6 +626,7 @@ static struct pbuf *low_level_input(volatile enetbufferdesc_t *const pBD) {
     }
     LINK_STATS_INC(link.drop);
 #endif  // LINK_STATS
+    s_statsRxDropped++;
   } else {
     LINK_STATS_INC(link.recv);
     p = pbuf_alloc(PBUF_RAW, pBD->length, PBUF_POOL);
@@ -630,6 +638,7 @@ static struct pbuf *low_level_input(volatile enetbufferdesc_t *const pBD) {
     } else {
       LINK_STATS_INC(link.drop);
       LINK_STATS_INC(link.memerr);
+      s_statsRxDropped++;
     }
   }
 
@@ -698,6 +707,7 @@ static inline volatile enetbufferdesc_t *rxbd_next(void) {
 
 // The Ethernet ISR.
 static void enet_isr(void) {
+  s_statsIrqCount++;
   if ((ENET_EIR & ENET_EIR_RXF) != 0) {
     ENET_EIR = ENET_EIR_RXF;
     atomic_flag_clear(&s_rxNotAvail);
@@ -1018,6 +1028,17 @@ struct pbuf *driver_proc_input(struct netif *const netif, const int counter) {
     if (atomic_flag_test_and_set(&s_rxNotAvail)) {
       return NULL;
     }
+    // Sample ring occupancy at the start of each drain burst; the maximum
+    // tells us how close the RX ring gets to overflow between polls.
+    uint32_t occupied = 0;
+    for (int i = 0; i < RX_SIZE; i++) {
+      if ((s_rxRing[i].status & kEnetRxBdEmpty) == 0) {
+        occupied++;
+      }
+    }
+    if (occupied > s_statsRxRingHighWater) {
+      s_statsRxRingHighWater = occupied;
+    }
   } else if (counter >= RX_SIZE * 2) {
     return NULL;
   }
@@ -1034,6 +1055,13 @@ void driver_poll(struct netif *const netif) {
   s_checkLinkStatusState = check_link_status(netif, s_checkLinkStatusState);
 }
 
+void driver_get_stats(struct DriverStats *const stats) {
+  stats->irqCount        = s_statsIrqCount;
+  stats->rxDropped       = s_statsRxDropped;
+  stats->txStalls        = s_statsTxStalls;
+  stats->rxRingHighWater = s_statsRxRingHighWater;
+}
+
 int driver_link_speed(void) {
   return s_linkSpeed10Not100 ? 10 : 100;
 }
@@ -1063,6 +1091,7 @@ err_t driver_output(struct pbuf *const p) {
   if (pBD == NULL) {
     LINK_STATS_INC(link.memerr);
     LINK_STATS_INC(link.drop);
+    s_statsTxStalls++;
     return ERR_WOULDBLOCK;  // Could also use ERR_MEM, but this lets things like
                             // UDP senders know to retry
   }
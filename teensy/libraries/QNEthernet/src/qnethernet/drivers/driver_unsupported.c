@@ -72,6 +72,13 @@ void driver_poll(struct netif *const netif) {
   LWIP_UNUSED_ARG(netif);
 }
 
+void driver_get_stats(struct DriverStats *const stats) {
+  stats->irqCount        = 0;
+  stats->rxDropped       = 0;
+  stats->txStalls        = 0;
+  stats->rxRingHighWater = 0;
+}
+
 int driver_link_speed(void) {
   return 0;
 }
@@ -662,6 +662,14 @@ void driver_poll(struct netif *const netif) {
   check_link_status(netif);
 }
 
+void driver_get_stats(struct DriverStats *const stats) {
+  // This driver doesn't keep statistics.
+  stats->irqCount        = 0;
+  stats->rxDropped       = 0;
+  stats->txStalls        = 0;
+  stats->rxRingHighWater = 0;
+}
+
 int driver_link_speed(void) {
   return s_linkSpeed10Not100 ? 10 : 100;
 }
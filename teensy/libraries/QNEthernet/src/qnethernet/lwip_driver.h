@@ -182,6 +182,20 @@ bool driver_link_is_crossover(void);
 // Note that the data will already contain any extra ETH_PAD_SIZE bytes.
 err_t driver_output(struct pbuf *p);
 
+// Driver-level statistics. These sit below lwIP's LINK_STATS counters and
+// describe pressure at the MAC/DMA layer. All values are lifetime totals
+// except rxRingHighWater, which is a maximum.
+struct DriverStats {
+  uint32_t irqCount;         // Ethernet ISR invocations
+  uint32_t rxDropped;        // Frames discarded in the receive path
+  uint32_t txStalls;         // Output attempts that found no free descriptor
+  uint32_t rxRingHighWater;  // Most RX descriptors seen occupied at once
+};
+
+// Fills in the driver-level statistics. Drivers that don't keep counters
+// fill in zeros.
+void driver_get_stats(struct DriverStats *stats);
+
 #if QNETHERNET_ENABLE_RAW_FRAME_SUPPORT
 // Outputs a raw Ethernet frame and returns whether successful.
 //
@@ -0,0 +1,340 @@
+/*
+Kernel_Bench: on-device microbenchmarks for the hot kernels.
+
+Peer to MQTT_Test: where that sketch measures the network leg, this one
+measures the CPU kernels that optimization work keeps touching - the
+Goertzel detector bank, the JSON serializers, the display render and
+flush paths, the IMA ADPCM fixed-point decode, and raw memory moves
+across the RT1062's memory regions. Until now the only way to judge a
+kernel change was flashing production firmware and squinting at the
+aggregate CPU%; this harness runs the actual production sources
+(textually included below, so there is no copy to drift) over canned
+inputs with DWT cycle counts.
+
+Runs once after boot and prints one JSON object per line on USB
+serial, so a script can diff runs before and after a change:
+
+  {"bench":"goertzel","variant":"rect","bins":12,"cyc_update":9856,...}
+  {"bench":"json","writer":"jsonwriter","cyc_frame":4210,"bytes":188}
+  {"bench":"adpcm","block":1024,"cyc_sample":18}
+  {"bench":"memcpy","region":"dtcm-dtcm","bytes":4096,"bpc":7.4}
+  {"bench":"done"}
+
+Deterministic kernels report the minimum over several repetitions (the
+stable number to diff); the Goertzel bank runs in the live audio graph
+and reports the core's own per-update cycle counter, since its cost
+only exists inside the update chain.
+
+No hardware beyond the bare Teensy 4.1 is required. With an audio
+shield attached the I2S output clocks the graph as in production;
+with an SSD1306 on Wire2 the flush benches also time real transfers.
+*/
+
+#include <Audio.h>
+#include <Wire.h>
+
+// Production sources, included textually so the benchmarks always run
+// the code that ships. Their own headers resolve relative to them.
+#include "../../FirstContact_controller/GoertzelBank.cpp"
+#include "../../FirstContact_controller/ImaAdpcm.cpp"
+#include "../../FirstContact_controller/JsonWriter.cpp"
+
+#include <Adafruit_GFX.h>
+#include <Adafruit_SSD1306.h>
+
+// ---------------------------------------------------------------- DWT --
+
+// Sink for results the optimizer must not delete.
+volatile uint32_t benchSink = 0;
+
+// Minimum cycles per iteration over `reps` timed runs of `iters`
+// iterations each. Minimum, not mean: interrupts only ever add time,
+// so the floor is the kernel and the stable number to diff.
+static uint32_t benchCycles(void (*fn)(void), uint32_t iters,
+                            uint32_t reps = 5) {
+  uint32_t best = 0xFFFFFFFF;
+  for (uint32_t r = 0; r < reps; r++) {
+    uint32_t start = ARM_DWT_CYCCNT;
+    for (uint32_t i = 0; i < iters; i++) {
+      fn();
+    }
+    uint32_t total = ARM_DWT_CYCCNT - start;
+    uint32_t per = total / iters;
+    if (per < best) {
+      best = per;
+    }
+  }
+  return best;
+}
+
+// -------------------------------------------------- Goertzel (live) --
+
+// The bank's kernel runs inside the audio update chain, so it is
+// benchmarked in a live graph: sine into both sense channels, output
+// object present to clock the updates. The Audio core counts DWT
+// cycles per node update (cpu_cycles, in units of 64 cycles).
+AudioSynthWaveformSine benchSine;
+AudioAnalyzeGoertzelBank benchBank;
+AudioOutputI2S benchOut; // Clocks update_all(); needs no connections
+AudioConnection patchL(benchSine, 0, benchBank, 0);
+AudioConnection patchR(benchSine, 0, benchBank, 1);
+
+// Production-shaped tuning: four primaries on the statue grid plus
+// their intermod guard bins.
+static const float BENCH_PRIMARIES[4] = {17000, 9500, 13500, 19500};
+#define BENCH_TONE_CYCLES 510 // ~30 ms window, as in production
+
+static void benchGoertzelConfig(bool hann, bool lowBand) {
+  for (uint8_t det = 0; det < 4; det++) {
+    float f = lowBand ? BENCH_PRIMARIES[det] / 4 : BENCH_PRIMARIES[det];
+    benchBank.frequency(det, f, (uint16_t)(BENCH_TONE_CYCLES * f / 17000));
+    benchBank.setHannWindow(det, hann);
+    for (uint8_t g = 0; g < GOERTZEL_GUARDS_PER_DET; g++) {
+      uint8_t bin = goertzelGuardBin(det, g);
+      benchBank.frequency(bin, f + (g ? -2000 : 2000) * (lowBand ? 0.2f : 1),
+                          BENCH_TONE_CYCLES / 2);
+      benchBank.setHannWindow(bin, hann);
+    }
+  }
+}
+
+static void benchGoertzelReport(const char *variant) {
+  // Let the window fill and the per-update cost settle.
+  benchBank.cpu_cycles_max = 0;
+  delay(400);
+  uint32_t cyc = (uint32_t)benchBank.cpu_cycles << 6;
+  uint32_t cycMax = (uint32_t)benchBank.cpu_cycles_max << 6;
+  // One update covers 128 samples at 44.1 kHz.
+  float pct = 100.0f * cyc / ((float)F_CPU_ACTUAL * 128 / 44100);
+  Serial.printf("{\"bench\":\"goertzel\",\"variant\":\"%s\",\"bins\":%d,"
+                "\"cyc_update\":%lu,\"cyc_max\":%lu,\"pct\":%.2f}\n",
+                variant, GOERTZEL_NUM_BINS, (unsigned long)cyc,
+                (unsigned long)cycMax, (double)pct);
+}
+
+static void benchGoertzel() {
+  benchSine.frequency(17000);
+  benchSine.amplitude(0.8f);
+
+  benchGoertzelConfig(false, false);
+  benchGoertzelReport("rect");
+  benchGoertzelConfig(true, false);
+  benchGoertzelReport("hann");
+  // Low-band tuning exercises the decimate-by-2 front end.
+  benchGoertzelConfig(true, true);
+  benchGoertzelReport("low");
+}
+
+// ------------------------------------------------------------- JSON --
+
+static char jsonBuf[512];
+
+// A representative signals frame: statue id, timestamp, four levels,
+// four thresholds - the 10 Hz payload from publishSignals().
+static void jsonWriterFrame() {
+  JsonWriter json(jsonBuf, sizeof(jsonBuf));
+  json.beginObject();
+  json.kv("statue", "elektra");
+  json.kv("ts", (uint32_t)123456789);
+  json.key("levels");
+  json.beginArray();
+  for (int i = 0; i < 4; i++) {
+    json.add(0.123456f + i, 4);
+  }
+  json.endArray();
+  json.key("thresholds");
+  json.beginArray();
+  for (int i = 0; i < 4; i++) {
+    json.add(0.1f * i, 2);
+  }
+  json.endArray();
+  json.endObject();
+  benchSink += jsonBuf[1];
+}
+
+static void jsonSnprintfFrame() {
+  snprintf(jsonBuf, sizeof(jsonBuf),
+           "{\"statue\":\"elektra\",\"ts\":%lu,"
+           "\"levels\":[%.4f,%.4f,%.4f,%.4f],"
+           "\"thresholds\":[%.2f,%.2f,%.2f,%.2f]}",
+           123456789UL, 0.1234, 1.1234, 2.1234, 3.1234, 0.0, 0.1, 0.2, 0.3);
+  benchSink += jsonBuf[1];
+}
+
+static void benchJson() {
+  uint32_t cyc = benchCycles(jsonWriterFrame, 500);
+  jsonWriterFrame();
+  Serial.printf("{\"bench\":\"json\",\"writer\":\"jsonwriter\","
+                "\"cyc_frame\":%lu,\"bytes\":%u}\n",
+                (unsigned long)cyc, (unsigned)strlen(jsonBuf));
+  cyc = benchCycles(jsonSnprintfFrame, 500);
+  jsonSnprintfFrame();
+  Serial.printf("{\"bench\":\"json\",\"writer\":\"snprintf\","
+                "\"cyc_frame\":%lu,\"bytes\":%u}\n",
+                (unsigned long)cyc, (unsigned)strlen(jsonBuf));
+}
+
+// ---------------------------------------------------------- Display --
+
+Adafruit_SSD1306 benchDisplay(128, 64, &Wire2, -1);
+static GFXcanvas1 benchStrip(128, 8);
+static uint8_t benchPhase = 0;
+
+// One status line through the cell-diff path's primitives.
+static void displayLineOp() {
+  benchPhase++;
+  for (int i = 0; i < 21; i++) {
+    int16_t x = i * 6;
+    benchDisplay.fillRect(x, 16, 6, 8, SSD1306_BLACK);
+    benchDisplay.drawChar(x, 16, (char)('0' + ((benchPhase + i) % 10)),
+                          SSD1306_WHITE, SSD1306_WHITE, 1);
+  }
+}
+
+// One row composed offscreen and blitted, the rowStrip pattern.
+static void displayCanvasOp() {
+  benchPhase++;
+  benchStrip.fillScreen(0);
+  benchStrip.setCursor(0, 0);
+  benchStrip.print("SIG 0.12 0.34 0.56 0.");
+  benchStrip.print(benchPhase % 10);
+  benchDisplay.drawCanvas1(0, 24, benchStrip);
+}
+
+static void benchDisplay_() {
+  Wire2.begin();
+  bool panel = benchDisplay.begin(SSD1306_SWITCHCAPVCC, 0xBC, true, false) &&
+               benchDisplay.lastWireStatus() == 0;
+
+  // Buffer-side render paths need no panel.
+  uint32_t cyc = benchCycles(displayLineOp, 50);
+  Serial.printf("{\"bench\":\"display\",\"op\":\"linediff\",\"cyc\":%lu}\n",
+                (unsigned long)cyc);
+  cyc = benchCycles(displayCanvasOp, 50);
+  Serial.printf("{\"bench\":\"display\",\"op\":\"canvas\",\"cyc\":%lu}\n",
+                (unsigned long)cyc);
+
+  if (!panel) {
+    Serial.println("{\"bench\":\"display\",\"op\":\"flush\",\"skip\":"
+                   "\"no panel\"}");
+    return;
+  }
+  // Full-frame and dirty-window flushes over real I2C, driver-timed.
+  benchDisplay.invalidateShadow();
+  benchDisplay.display();
+  Serial.printf("{\"bench\":\"display\",\"op\":\"fullframe\",\"bytes\":%u,"
+                "\"us\":%lu}\n",
+                benchDisplay.lastTransferBytes(),
+                (unsigned long)benchDisplay.lastTransferMicros());
+  displayLineOp();
+  benchDisplay.displayRegion();
+  Serial.printf("{\"bench\":\"display\",\"op\":\"window\",\"bytes\":%u,"
+                "\"us\":%lu}\n",
+                benchDisplay.lastTransferBytes(),
+                (unsigned long)benchDisplay.lastTransferMicros());
+}
+
+// -------------------------------------------------------- IMA ADPCM --
+
+#define ADPCM_BLOCK_ALIGN 1024
+static uint8_t adpcmSrc[ADPCM_BLOCK_ALIGN];
+static int16_t adpcmL[1024], adpcmR[1024];
+
+static void adpcmOp() {
+  benchSink += imaAdpcmDecodeBlock(adpcmSrc, ADPCM_BLOCK_ALIGN, 2, adpcmL,
+                                   adpcmR);
+}
+
+static void benchAdpcm() {
+  // Canned block: plausible headers, pseudo-random nibble data.
+  uint32_t seed = 0x4D4C0001;
+  for (size_t i = 8; i < sizeof(adpcmSrc); i++) {
+    seed = seed * 1664525 + 1013904223;
+    adpcmSrc[i] = (uint8_t)(seed >> 24);
+  }
+  memset(adpcmSrc, 0, 8); // predictor 0, step index 0, both channels
+  uint16_t samples = imaAdpcmSamplesPerBlock(ADPCM_BLOCK_ALIGN, 2);
+  uint32_t cyc = benchCycles(adpcmOp, 20);
+  Serial.printf("{\"bench\":\"adpcm\",\"block\":%d,\"samples\":%u,"
+                "\"cyc_block\":%lu,\"cyc_sample\":%lu}\n",
+                ADPCM_BLOCK_ALIGN, samples, (unsigned long)cyc,
+                (unsigned long)(cyc / samples));
+}
+
+// ----------------------------------------------------- memcpy/memset --
+
+#define MOVE_MAX 4096
+static uint8_t dtcmA[MOVE_MAX], dtcmB[MOVE_MAX];
+DMAMEM static uint8_t ocramA[MOVE_MAX];
+static size_t moveBytes = 0;
+static uint8_t *moveDst = NULL;
+static const uint8_t *moveSrc = NULL;
+
+static void moveOp() {
+  memcpy(moveDst, moveSrc, moveBytes);
+  benchSink += moveDst[0];
+}
+
+static void setOp() {
+  memset(moveDst, (int)benchSink, moveBytes);
+  benchSink += moveDst[0];
+}
+
+static void benchMoves() {
+  static const size_t sizes[] = {128, 1024, 4096};
+  struct {
+    const char *name;
+    uint8_t *dst;
+    const uint8_t *src;
+  } routes[] = {
+      {"dtcm-dtcm", dtcmB, dtcmA},
+      {"ocram-dtcm", dtcmB, ocramA},
+      {"dtcm-ocram", ocramA, dtcmA},
+  };
+  for (size_t r = 0; r < sizeof(routes) / sizeof(routes[0]); r++) {
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+      moveDst = routes[r].dst;
+      moveSrc = routes[r].src;
+      moveBytes = sizes[s];
+      uint32_t cyc = benchCycles(moveOp, 200);
+      Serial.printf("{\"bench\":\"memcpy\",\"region\":\"%s\",\"bytes\":%u,"
+                    "\"cyc\":%lu,\"bpc\":%.1f}\n",
+                    routes[r].name, (unsigned)sizes[s], (unsigned long)cyc,
+                    (double)sizes[s] / (cyc ? cyc : 1));
+    }
+  }
+  moveDst = dtcmB;
+  moveBytes = MOVE_MAX;
+  uint32_t cyc = benchCycles(setOp, 200);
+  Serial.printf("{\"bench\":\"memset\",\"bytes\":%d,\"cyc\":%lu,"
+                "\"bpc\":%.1f}\n",
+                MOVE_MAX, (unsigned long)cyc,
+                (double)MOVE_MAX / (cyc ? cyc : 1));
+}
+
+// ------------------------------------------------------------- main --
+
+void setup() {
+  Serial.begin(115200);
+  unsigned long start = millis();
+  while (!Serial && millis() - start < 4000) {
+    // Wait briefly for the host so the report is not lost; the bench
+    // runs headless either way.
+  }
+
+  AudioMemory(12);
+  Serial.printf("{\"bench\":\"start\",\"f_cpu\":%lu,\"build\":\"%s %s\"}\n",
+                (unsigned long)F_CPU_ACTUAL, __DATE__, __TIME__);
+
+  benchGoertzel();
+  benchJson();
+  benchDisplay_();
+  benchAdpcm();
+  benchMoves();
+
+  Serial.println("{\"bench\":\"done\"}");
+}
+
+void loop() {
+  // One-shot harness; reset to rerun.
+}
@@ -1,250 +1,215 @@
-
 /*
-  ArduinoMqttClient - WiFi Simple Sender
+MQTT_Test: network soak-test firmware for the Missing Link broker leg.
+
+Grown from the original connect-and-publish demo into a load tester for
+validating broker, switch, and PubSubClient changes (buffer sizes,
+no-delay, write batching) with numbers instead of vibes. Uses the same
+stack as the production firmware: QNEthernet with DHCP from the Pi and
+the vendored PubSubClient with the production 1024-byte buffer.
+
+Runs a fixed sequence automatically after boot:
+
+  1. Publish throughput sweep - flat-out publishing for a timed window
+     at each payload size from 16 B up to the 1024 B buffer.
+  2. Subscribe echo latency - timestamped messages looped back by the
+     broker to our own subscription, RTT summarized as p50/p99/max.
+  3. Reconnect storm - repeated disconnect/reconnect cycles, timing
+     each broker handshake.
+
+Results print on USB serial as one JSON object per line, so a script
+can diff runs before and after a change:
+
+  {"test":"throughput","size":256,"msgs":4813,"fail":0,"kbps":962.6}
+  {"test":"latency","count":250,"p50_us":1024,"p99_us":8192,"max_us":9120}
+  {"test":"reconnect","cycles":20,"min_ms":3,"avg_ms":5,"max_ms":14}
+  {"test":"done"}
+*/
 
-  This example connects to a MQTT broker and publishes a message to
-  a topic once a second.
+#include <PubSubClient.h>
+#include <QNEthernet.h>
 
-  The circuit:
-  - Arduino MKR 1000, MKR 1010 or Uno WiFi Rev2 board
+using namespace qindesign::network;
 
-  This example code is in the public domain.
-*/
-#include <Audio.h>
-#include <Wire.h>
-#include <SPI.h>
-#include <SD.h>
-#include <SerialFlash.h>
-
-// Begin Ethernet Requirements
-#include "defines.h" 
-  
-#include <SD.h> 
-#include <SPI.h> 
-#include <QNEthernet.h>
-#include <WiFi.h>
-
-#define PASV_RESPONSE_STYLE_NEW       true 
-#define FTP_FILESYST                  FTP_SDFAT2 
-
-// Default 2048 
-#define FTP_BUF_SIZE                  8192 
-
-#define FTP_USER_NAME_LEN             64        // Max permissible and default are 64 
-#define FTP_USER_PWD_LEN             128        // Max permissible and default are 128 
-
-byte mac[] = {
-  0x92, 0xAD, 0xBE, 0xEF, 0xFE, 0xED };
-IPAddress NETWORK_IP      (192,168,1,48); //static IP
-IPAddress NETWORK_MASK    (255,255,255,0);
-IPAddress NETWORK_GATEWAY (192,168,1,20);
-IPAddress NETWORK_DNS     (192,168,1,20);
-IPAddress UDP_LOG_PC_IP   (192,168,1,50);
-// End  Ethernet Requirements
-#include <ArduinoMqttClient.h>
-#if defined(ARDUINO_SAMD_MKRWIFI1010) || defined(ARDUINO_SAMD_NANO_33_IOT) || defined(ARDUINO_AVR_UNO_WIFI_REV2)
-  #include <WiFiNINA.h>
-#elif defined(ARDUINO_SAMD_MKR1000)
-  #include <WiFi101.h>
-#elif defined(ARDUINO_ARCH_ESP8266)
-  #include <ESP8266WiFi.h>
-#elif defined(ARDUINO_PORTENTA_H7_M7) || defined(ARDUINO_NICLA_VISION) || defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_GIGA) || defined(ARDUINO_OPTA)
-  #include <WiFi.h>
-#elif defined(ARDUINO_PORTENTA_C33)
-  #include <WiFiC3.h>
-#elif defined(ARDUINO_UNOR4_WIFI)
-  #include <WiFiS3.h>
-#endif
-
-#include "arduino_secrets.h"
-///////please enter your sensitive data in the Secret tab/arduino_secrets.h
-char ssid[] = SECRET_SSID;    // your network SSID (name)
-char pass[] = SECRET_PASS;    // your network password (use for WPA, or use as key for WEP)
-
-// To connect with SSL/TLS:
-// 1) Change WiFiClient to WiFiSSLClient.
-// 2) Change port value from 1883 to 8883.
-// 3) Change broker value to a server with a known SSL/TLS root certificate 
-//    flashed in the WiFi module.
-
-WiFiClient wifiClient;
-MqttClient mqttClient(wifiClient);
-
-const char broker[] = "test.mosquitto.org";
-int        port     = 1883;
-const char topic[]  = "arduino/simple";
-
-const long interval = 1000;
-unsigned long previousMillis = 0;
-
-int count = 0;
-void initEthernet() 
- { 
- #if USE_QN_ETHERNET 
-   Serial.println(F("=========== USE_QN_ETHERNET ===========")); 
- #elif USE_NATIVE_ETHERNET 
-   Serial.println(F("======== USE_NATIVE_ETHERNET ========")); 
- #elif USE_ETHERNET_GENERIC 
-   Serial.println(F("======== USE_ETHERNET_GENERIC ========")); 
- #else 
-   Serial.println(F("=======================================")); 
- #endif 
-  
- #if USE_NATIVE_ETHERNET 
-  
-   // start the ethernet connection and the server: 
-   // Use DHCP dynamic IP and random mac 
-   uint16_t index = millis() % NUMBER_OF_MAC; 
-   // Use Static IP 
-   //Ethernet.begin(mac[index], ip); 
-   Ethernet.begin(mac[index]); 
-  
-   Serial.print(F("Using mac index = ")); 
-   Serial.println(index); 
-  
-   Serial.print(F("Connected! IP address: ")); 
-   Serial.println(Ethernet.localIP()); 
-  
- #elif USE_QN_ETHERNET 
-
-
-
- #if USING_DHCP 
-
-   // Start the Ethernet connection, using DHCP 
-   Serial.print("Initialize Ethernet using DHCP => "); 
-   Ethernet.begin(); 
-   // give the Ethernet shield minimum 1 sec for DHCP and 2 secs for staticP to initialize: 
-   delay(1000); 
- #else 
-   // Start the Ethernet connection, using static IP 
-   Serial.print("Initialize Ethernet using STATIC IP => "); 
-   Ethernet.begin(NETWORK_IP, NETWORK_MASK, NETWORK_GATEWAY, NETWORK_DNS);  
- #endif 
-  
-   if (!Ethernet.waitForLocalIP(5000)) 
-   { 
-     Serial.println("Failed to configure Ethernet"); 
-  
-     if (!Ethernet.linkStatus()) 
-     { 
-       Serial.println("Ethernet cable is not connected."); 
-     } 
-  
-     // Stay here forever 
-     while (true) 
-     { 
-       delay(1); 
-     } 
-   } 
-   else 
-   { 
-     Serial.print("IP Address = "); 
-     Serial.println(Ethernet.localIP()); 
-   } 
-  
-   // give the Ethernet shield minimum 1 sec for DHCP and 2 secs for staticP to initialize: 
-   //delay(2000); 
-  
- #else 
-  
-   FTP_LOGWARN(F("Default SPI pinout:")); 
-   FTP_LOGWARN1(F("MOSI:"), MOSI); 
-   FTP_LOGWARN1(F("MISO:"), MISO); 
-   FTP_LOGWARN1(F("SCK:"),  SCK); 
-   FTP_LOGWARN1(F("SS:"),   SS); 
-   FTP_LOGWARN(F("=========================")); 
-    
-   // unknown board, do nothing, use default SS = 10 
-   #ifndef USE_THIS_SS_PIN 
-     #define USE_THIS_SS_PIN   10    // For other boards 
-   #endif 
-  
-   #if defined(BOARD_NAME) 
-     FTP_LOGWARN3(F("Board :"), BOARD_NAME, F(", setCsPin:"), USE_THIS_SS_PIN); 
-   #else 
-     FTP_LOGWARN1(F("Unknown board setCsPin:"), USE_THIS_SS_PIN); 
-   #endif 
-  
-   // For other boards, to change if necessary  
-   Ethernet.init (USE_THIS_SS_PIN); 
-  
-   // start the ethernet connection and the server: 
-   // Use DHCP dynamic IP and random mac 
-   uint16_t index = millis() % NUMBER_OF_MAC; 
-   // Use Static IP 
-   //Ethernet.begin(mac[index], ip); 
-   Ethernet.begin(mac[index]); 
-   Ethernet.macAddress(mac);
-   Serial.print("IP Address = "); 
-   Serial.println(Ethernet.localIP()); 
-    
- #endif 
- } 
-
-// End Ethernet Setup
+// The production broker (the Pi). Override for bench setups.
+IPAddress broker(192, 168, 4, 1);
+#define BROKER_PORT 1883
 
-void setup() {
-  //Initialize serial and wait for port to open:
-  Serial.begin(9600);
-  while (!Serial) {
-    ; // wait for serial port to connect. Needed for native USB port only
-  }
+#define TOPIC_LOAD "loadtest/pub"
+#define TOPIC_ECHO "loadtest/echo"
 
-  initEthernet();
+// Sweep parameters.
+static const uint16_t payloadSizes[] = {16, 64, 256, 512, 1024};
+#define THROUGHPUT_WINDOW_MS 5000
+#define LATENCY_COUNT 250
+#define LATENCY_SEND_INTERVAL_MS 20
+#define RECONNECT_CYCLES 20
 
+EthernetClient ethClient;
+PubSubClient client(ethClient);
+
+// Echo latency bookkeeping: RTTs land in a log2 histogram (bucket n
+// covers up to 2^n us), the same summary the production firmware uses.
+#define LATENCY_BUCKETS 24
+static uint32_t latencyBuckets[LATENCY_BUCKETS];
+static uint32_t latencyReceived = 0;
+static uint32_t latencyMaxUs = 0;
+
+static char payload[1100];
+
+static void onMessage(char *topic, byte *data, unsigned int length) {
+  if (strcmp(topic, TOPIC_ECHO) != 0 || length < 8) {
+    return;
+  }
+  // Payload starts with the send micros() as text.
+  uint32_t sentUs = strtoul((const char *)data, NULL, 10);
+  uint32_t rtt = micros() - sentUs;
+  if (rtt > latencyMaxUs) {
+    latencyMaxUs = rtt;
+  }
+  int bucket = 0;
+  while ((1UL << bucket) < rtt && bucket < LATENCY_BUCKETS - 1) {
+    bucket++;
+  }
+  latencyBuckets[bucket]++;
+  latencyReceived++;
+}
 
+static uint32_t bucketPercentile(uint32_t rank) {
+  uint32_t seen = 0;
+  for (int i = 0; i < LATENCY_BUCKETS; i++) {
+    seen += latencyBuckets[i];
+    if (seen >= rank) {
+      return 1UL << i;
+    }
+  }
+  return latencyMaxUs;
+}
 
-  Serial.println("You're connected to the network");
-  Serial.println();
+static bool connectBroker() {
+  while (!client.connected()) {
+    if (!client.connect("loadtest")) {
+      delay(250);
+    }
+  }
+  return true;
+}
 
-  // You can provide a unique client ID, if not set the library uses Arduino-millis()
-  // Each client must have a unique client ID
-  // mqttClient.setId("clientId");
+// Phase 1: publish as fast as the stack accepts for a timed window.
+static void runThroughput() {
+  for (unsigned i = 0; i < sizeof(payloadSizes) / sizeof(payloadSizes[0]);
+       i++) {
+    uint16_t size = payloadSizes[i];
+    memset(payload, 'x', size);
+    payload[size] = '\0';
+
+    uint32_t ok = 0, fail = 0;
+    unsigned long start = millis();
+    while (millis() - start < THROUGHPUT_WINDOW_MS) {
+      if (client.publish(TOPIC_LOAD, payload)) {
+        ok++;
+      } else {
+        fail++;
+        connectBroker();
+      }
+      client.loop();
+    }
+    unsigned long elapsed = millis() - start;
+    float kbps = (ok * (float)size) / elapsed; // bytes/ms == KB/s
+    Serial.printf(
+        "{\"test\":\"throughput\",\"size\":%u,\"msgs\":%lu,\"fail\":%lu,"
+        "\"ms\":%lu,\"kbps\":%.1f}\n",
+        size, (unsigned long)ok, (unsigned long)fail, elapsed, (double)kbps);
+  }
+}
 
-  // You can provide a username and password for authentication
-  // mqttClient.setUsernamePassword("username", "password");
+// Phase 2: RTT through the broker to our own subscription.
+static void runLatency() {
+  memset(latencyBuckets, 0, sizeof(latencyBuckets));
+  latencyReceived = 0;
+  latencyMaxUs = 0;
+  client.subscribe(TOPIC_ECHO);
+
+  uint32_t sent = 0;
+  unsigned long lastSend = 0;
+  unsigned long deadline = millis() + LATENCY_COUNT * LATENCY_SEND_INTERVAL_MS
+                           + 2000;
+  while (millis() < deadline &&
+         (sent < LATENCY_COUNT || latencyReceived < sent)) {
+    if (sent < LATENCY_COUNT &&
+        millis() - lastSend >= LATENCY_SEND_INTERVAL_MS) {
+      snprintf(payload, sizeof(payload), "%lu loadtest",
+               (unsigned long)micros());
+      client.publish(TOPIC_ECHO, payload);
+      lastSend = millis();
+      sent++;
+    }
+    client.loop();
+  }
+  client.unsubscribe(TOPIC_ECHO);
+
+  Serial.printf(
+      "{\"test\":\"latency\",\"count\":%lu,\"lost\":%lu,\"p50_us\":%lu,"
+      "\"p99_us\":%lu,\"max_us\":%lu}\n",
+      (unsigned long)latencyReceived, (unsigned long)(sent - latencyReceived),
+      (unsigned long)bucketPercentile((latencyReceived + 1) / 2),
+      (unsigned long)bucketPercentile((latencyReceived * 99 + 99) / 100),
+      (unsigned long)latencyMaxUs);
+}
 
-  Serial.print("Attempting to connect to the MQTT broker: ");
-  Serial.println(broker);
+// Phase 3: hammer the broker handshake.
+static void runReconnectStorm() {
+  uint32_t minMs = UINT32_MAX, maxMs = 0, totalMs = 0;
+  for (int i = 0; i < RECONNECT_CYCLES; i++) {
+    client.disconnect();
+    unsigned long start = millis();
+    connectBroker();
+    uint32_t took = millis() - start;
+    if (took < minMs) {
+      minMs = took;
+    }
+    if (took > maxMs) {
+      maxMs = took;
+    }
+    totalMs += took;
+    delay(50);
+  }
+  Serial.printf(
+      "{\"test\":\"reconnect\",\"cycles\":%d,\"min_ms\":%lu,\"avg_ms\":%lu,"
+      "\"max_ms\":%lu}\n",
+      RECONNECT_CYCLES, (unsigned long)minMs,
+      (unsigned long)(totalMs / RECONNECT_CYCLES), (unsigned long)maxMs);
+}
 
-  if (!mqttClient.connect(broker, port)) {
-    Serial.print("MQTT connection failed! Error code = ");
-    Serial.println(mqttClient.connectError());
+void setup() {
+  Serial.begin(115200);
+  while (!Serial && millis() < 4000) {
+    // Wait briefly for the USB host; run headless otherwise.
+  }
 
-    while (1);
+  Serial.println("{\"test\":\"start\"}");
+  Ethernet.begin(); // DHCP from the Pi
+  if (!Ethernet.waitForLocalIP(15000)) {
+    Serial.println("{\"test\":\"error\",\"msg\":\"no DHCP lease\"}");
+    while (true) {
+      delay(1000);
+    }
   }
 
-  Serial.println("You're connected to the MQTT broker!");
-  Serial.println();
+  // Match the production client configuration (see initMqtt()).
+  client.setServer(broker, BROKER_PORT);
+  client.setBufferSize(1024);
+  client.setCallback(onMessage);
+  connectBroker();
+
+  runThroughput();
+  runLatency();
+  runReconnectStorm();
+  Serial.println("{\"test\":\"done\"}");
 }
 
 void loop() {
-  // call poll() regularly to allow the library to send MQTT keep alives which
-  // avoids being disconnected by the broker
-  mqttClient.poll();
-
-  // to avoid having delays in loop, we'll use the strategy from BlinkWithoutDelay
-  // see: File -> Examples -> 02.Digital -> BlinkWithoutDelay for more info
-  unsigned long currentMillis = millis();
-  
-  if (currentMillis - previousMillis >= interval) {
-    // save the last time a message was sent
-    previousMillis = currentMillis;
-
-    Serial.print("Sending message to topic: ");
-    Serial.println(topic);
-    Serial.print("hello ");
-    Serial.println(count);
-
-    // send message, the Print interface can be used to set the message contents
-    mqttClient.beginMessage(topic);
-    mqttClient.print("hello ");
-    mqttClient.print(count);
-    mqttClient.endMessage();
-
-    Serial.println();
-
-    count++;
-  }
+  // Keep the connection alive so the broker side can be inspected after
+  // a run; the tests themselves run once from setup().
+  client.loop();
+  delay(100);
 }
@@ -1,2 +0,0 @@
-#define SECRET_SSID ""
-#define SECRET_PASS ""